@@ -128,6 +128,46 @@ namespace CodeGen
             output.Unindent();
 
             output.WriteLine("};");
+
+            OutputEffectBoundsRules(effectsByVersion, output);
+        }
+
+        private static void OutputEffectBoundsRules(IEnumerable<IGrouping<string, Effects.Effect>> effectsByVersion, Formatter output)
+        {
+            var rulesByVersion = from versionGroup in effectsByVersion
+                                 let effectsWithRules = versionGroup.Where(effect => effect.Overrides != null && !string.IsNullOrEmpty(effect.Overrides.BoundsRule)).ToList()
+                                 where effectsWithRules.Count > 0
+                                 select new { WinVer = versionGroup.Key, Effects = effectsWithRules };
+
+            output.WriteLine();
+            output.WriteLine();
+            output.WriteLine("std::pair<IID, EffectBoundsRule> CanvasEffect::m_boundsRules[] =");
+            output.WriteLine("{");
+
+            int longestName = rulesByVersion.SelectMany(group => group.Effects).Select(effect => effect.ClassName.Length).Max();
+
+            foreach (var versionGroup in rulesByVersion)
+            {
+                OutputVersionConditional(versionGroup.WinVer, output);
+                output.Indent();
+
+                foreach (var effect in versionGroup.Effects)
+                {
+                    string padding = new string(' ', longestName - effect.ClassName.Length);
+
+                    output.WriteLine("{ " + effect.ClassName + "::EffectId(), " + padding + "EffectBoundsRule::" + effect.Overrides.BoundsRule + " },");
+                }
+
+                output.Unindent();
+                EndVersionConditional(versionGroup.WinVer, output);
+                output.WriteLine();
+            }
+
+            output.Indent();
+            output.WriteLine("{ GUID_NULL, EffectBoundsRule::Unknown }");
+            output.Unindent();
+
+            output.WriteLine("};");
         }
 
         public static void OutputEffectIdl(Effects.Effect effect, Formatter output)
@@ -133,6 +133,9 @@ namespace CodeGen
                 [XmlAttributeAttribute]
                 public string IsSupportedCheck;
 
+                [XmlAttributeAttribute]
+                public string BoundsRule;
+
                 [XmlElement("Input")]
                 public List<EffectProperty> Inputs { get; set; }
 
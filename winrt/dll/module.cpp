@@ -10,10 +10,32 @@
 #include <win2d.etw.h>
 #pragma warning(pop)
 
+#include "../inc/AllocationTracking.h"
 #include "../inc/LifespanTracker.h"
 #include "../inc/MicrosoftTelemetry.h"
 #include "../inc/Win2DTelemetry.h"
 
+#if WIN2D_ALLOCATION_TRACKING
+
+// Replacing operator new for the DLL lets every allocation made by Win2D be
+// attributed to the API call that is in progress.  See AllocationTracking.h.
+void* operator new(size_t size)
+{
+    AllocationTracker::RecordAllocation(size);
+
+    if (auto p = malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+#endif
+
 STDAPI_(BOOL)
 DllMain(
     _In_     HINSTANCE inst,
@@ -40,6 +62,10 @@ DllMain(
 
         LifespanInfo::ReportLiveObjectsNoLock();
 
+#if WIN2D_ALLOCATION_TRACKING
+        AllocationTracker::LogSnapshotNoLock();
+#endif
+
         EventUnregisterWin2D();
         UnregisterTraceLogging();
         break;
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//
+// Optional instrumentation that attributes heap allocations to the public
+// API call that caused them.
+//
+// This is only compiled in when building with
+// /p:EnableWin2DAllocationTracking=true, which defines
+// WIN2D_ALLOCATION_TRACKING=1 for winrt.lib, winrt.dll and the internal
+// tests.  In that configuration:
+//
+//  - every ExceptionBoundary opens an AllocationTracker::Scope named after
+//    the method it guards.  Scopes nest, but only the outermost one counts,
+//    so an API that calls other APIs internally is charged for all of them.
+//
+//  - the DLL replaces operator new, and reports each allocation to the
+//    scope that is active on the calling thread.  Allocations made outside
+//    of any API call (eg. on worker threads) are reported as unattributed.
+//
+//  - memory that other components allocate for Win2D doesn't go through
+//    operator new, so it is reported with RecordExternalAllocation: the
+//    CoTaskMemAlloc'd buffers behind ComArray and ComArrayBuilder, and the
+//    IPropertyValues that effects box their properties into.
+//
+//  - when the outermost scope ends its totals are merged into a process-wide
+//    table.  GetSnapshot reads that table back; LogSnapshot writes it out as
+//    AllocationTracking_ApiTotals ETW events.  When the DLL is unloaded
+//    LogSnapshotNoLock writes the raw table out instead, since DllMain must
+//    not take locks or allocate.
+//
+// In normal builds nothing calls into the tracker, so it costs nothing.
+//
+
+#ifndef WIN2D_ALLOCATION_TRACKING
+#define WIN2D_ALLOCATION_TRACKING 0
+#endif
+
+class AllocationTracker
+{
+public:
+    struct Totals
+    {
+        std::string ApiName;
+        uint64_t CallCount;
+        uint64_t AllocationCount;
+        uint64_t ByteCount;
+    };
+
+    static char const* const UnattributedName;
+
+    class Scope
+    {
+        char const* m_apiName;
+        bool m_isOutermost;
+        uint64_t m_allocationCount;
+        uint64_t m_byteCount;
+
+    public:
+        // apiName must outlive the process, eg. a string literal.
+        explicit Scope(char const* apiName);
+        ~Scope();
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        // Allocations charged to this scope so far.  Always zero for a scope
+        // that is nested inside another one.
+        uint64_t GetAllocationCount() const { return m_allocationCount; }
+
+    private:
+        friend class AllocationTracker;
+    };
+
+    static void RecordAllocation(size_t size);
+
+    // For memory allocated on Win2D's behalf without going through operator
+    // new.  Compiles away unless tracking is enabled.
+    static void RecordExternalAllocation(size_t size)
+    {
+#if WIN2D_ALLOCATION_TRACKING
+        RecordAllocation(size);
+#else
+        (void)size;
+#endif
+    }
+
+    // Sorted by allocation count, most allocations first.  Scopes that share
+    // a name are combined.
+    static std::vector<Totals> GetSnapshot();
+
+    static void LogSnapshot();
+
+    // Like LogSnapshot, but without taking the usual lock or allocating, for
+    // use during DLL unload.  Entries are written as they are stored, so
+    // scopes sharing a name may appear more than once, and are not sorted.
+    static void LogSnapshotNoLock();
+
+    static void Reset();
+
+private:
+    static void Merge(Scope const& scope);
+};
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <algorithm>
+#include "AllocationTracking.h"
 #include "Utilities.h"
 #include "WinStringWrapper.h"
 
@@ -122,6 +123,7 @@ public:
         assert(size <= UINT_MAX);
         if (!m_data)
             ThrowHR(E_OUTOFMEMORY);
+        AllocationTracker::RecordExternalAllocation(size * sizeof(T));
         Traits::InitializeElements(m_data, m_size);
     }
 
@@ -193,6 +195,16 @@ public:
         m_data = nullptr;
     }
 
+    // Takes ownership of data, which must have been allocated with
+    // CoTaskMemAlloc and already hold size initialized elements.
+    void Attach(uint32_t size, T* data)
+    {
+        Release();
+
+        m_size = size;
+        m_data = data;
+    }
+
 private:
     void Release()
     {
@@ -241,3 +253,101 @@ inline ComArray<T, Base> TransformToComArray(ITERATOR first, ITERATOR last, FN f
 
     return array;
 }
+
+
+//
+// Accumulates plain-old-data directly into CoTaskMemAlloc'd memory, for
+// producers that don't know how many elements there will be until they
+// are done (eg. ID2D1TessellationSink).  The allocation grows
+// geometrically, and Complete() hands it over as a ComArray without
+// copying the elements.
+//
+template<typename T, typename Base=EmptyComArrayBase>
+class ComArrayBuilder : public Base
+{
+    static_assert(std::is_pod<T>::value && !std::is_pointer<T>::value, "T must be plain-old non-pointer data");
+
+    T* m_data;
+    uint32_t m_size;
+    uint32_t m_capacity;
+
+public:
+    ComArrayBuilder(ComArrayBuilder const&) = delete;
+    ComArrayBuilder& operator=(ComArrayBuilder const&) = delete;
+
+    explicit ComArrayBuilder(size_t initialCapacity = 0)
+        : m_data(nullptr)
+        , m_size(0)
+        , m_capacity(0)
+    {
+        Reserve(initialCapacity);
+    }
+
+    ~ComArrayBuilder()
+    {
+        CoTaskMemFree(m_data);
+    }
+
+    uint32_t GetSize() const
+    {
+        return m_size;
+    }
+
+    uint32_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+
+        if (capacity > UINT_MAX / sizeof(T))
+            ThrowHR(E_OUTOFMEMORY);
+
+        auto newData = static_cast<T*>(CoTaskMemRealloc(m_data, capacity * sizeof(T)));
+        if (!newData)
+            ThrowHR(E_OUTOFMEMORY);
+        AllocationTracker::RecordExternalAllocation(capacity * sizeof(T));
+
+        m_data = newData;
+        m_capacity = static_cast<uint32_t>(capacity);
+    }
+
+    void Append(T const* elements, size_t count)
+    {
+        if (count > UINT_MAX - m_size)
+            ThrowHR(E_OUTOFMEMORY);
+
+        size_t requiredCapacity = m_size + count;
+
+        if (requiredCapacity > m_capacity)
+            Reserve(std::max<size_t>(requiredCapacity, static_cast<size_t>(m_capacity) * 2));
+
+        std::copy(elements, elements + count, stdext::make_checked_array_iterator(m_data + m_size, count));
+        m_size += static_cast<uint32_t>(count);
+    }
+
+    ComArray<T, Base> Complete()
+    {
+        if (!m_data)
+            return ComArray<T, Base>(size_t(0));
+
+        // Give back any significant slack; shrinking is normally done in place.
+        if (m_size < m_capacity - m_capacity / 4)
+        {
+            if (auto shrunk = static_cast<T*>(CoTaskMemRealloc(m_data, std::max<size_t>(m_size, 1) * sizeof(T))))
+                m_data = shrunk;
+        }
+
+        ComArray<T, Base> array;
+        array.Attach(m_size, m_data);
+
+        m_data = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+
+        return array;
+    }
+};
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "AllocationTracking.h"
+
 //
 // Helpers for error handling.  General strategy is that errors are always
 // reported as exceptions (so we don't need to special case any STL usage).
@@ -216,6 +218,13 @@ inline HRESULT ThrownExceptionToHResult()
 template<typename CALLABLE>
 HRESULT ExceptionBoundary(CALLABLE&& fn)
 {
+#if WIN2D_ALLOCATION_TRACKING
+    // Each method's lambda is a distinct type, and MSVC includes the
+    // enclosing method's signature in its name, so __FUNCSIG__ here
+    // identifies the API being called.
+    AllocationTracker::Scope allocationScope(__FUNCSIG__);
+#endif
+
     try
     {
         fn();
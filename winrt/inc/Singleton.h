@@ -30,6 +30,16 @@ public:
     }
 
 
+    // Returns the existing singleton instance, or null if there isn't one.
+    // Unlike GetInstance, this never creates a new instance.
+    static std::shared_ptr<T> TryGetInstance()
+    {
+        std::lock_guard<std::mutex> lock(Mutex());
+
+        return CurrentInstance().lock();
+    }
+
+
     // Explicitly specifies the active instance, overriding the normal demand-create behavior.
     // This is used by unit tests to inject custom adapters.
     static void SetInstance(std::shared_ptr<T> const& instance)
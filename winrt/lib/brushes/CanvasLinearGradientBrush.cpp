@@ -29,6 +29,35 @@ ComPtr<CanvasLinearGradientBrush> CanvasLinearGradientBrush::CreateNew(
         d2dBrush.Get());
     CheckMakeResult(canvasLinearGradientBrush);
 
+    // The brush is rebuilt from the old D2D brush, which keeps its
+    // properties after device loss, so no extra copy is needed.
+    if (auto registry = deviceInternal->GetResourceRecreationRegistry())
+    {
+        registry->Register(
+            As<ICanvasLinearGradientBrush>(canvasLinearGradientBrush).Get(),
+            0,
+            [] (IUnknown* wrapper, ICanvasDevice* newDevice) -> ComPtr<IUnknown>
+            {
+                auto oldBrush = GetWrappedResource<ID2D1LinearGradientBrush>(wrapper);
+
+                ComPtr<ID2D1GradientStopCollection> oldStopCollection;
+                oldBrush->GetGradientStopCollection(&oldStopCollection);
+
+                auto newStopCollection = CopyGradientStopCollection(newDevice, oldStopCollection.Get());
+                auto newBrush = As<ICanvasDeviceInternal>(newDevice)->CreateLinearGradientBrush(newStopCollection.Get());
+
+                newBrush->SetStartPoint(oldBrush->GetStartPoint());
+                newBrush->SetEndPoint(oldBrush->GetEndPoint());
+
+                D2D1_MATRIX_3X2_F transform;
+                oldBrush->GetTransform(&transform);
+                newBrush->SetTransform(&transform);
+                newBrush->SetOpacity(oldBrush->GetOpacity());
+
+                return newBrush;
+            });
+    }
+
     return canvasLinearGradientBrush;
 }
 
@@ -268,6 +297,19 @@ IFACEMETHODIMP CanvasLinearGradientBrush::Close()
     return ResourceWrapper::Close();
 }
 
+bool CanvasLinearGradientBrush::IsRecreatable()
+{
+    return HasResource();
+}
+
+ComPtr<IUnknown> CanvasLinearGradientBrush::SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource)
+{
+    auto d2dBrush = As<ID2D1LinearGradientBrush>(newResource);
+
+    m_device = newDevice;
+    return ExchangeResource(d2dBrush.Get());
+}
+
 ComPtr<ID2D1Brush> CanvasLinearGradientBrush::GetD2DBrush(ID2D1DeviceContext*, GetBrushFlags)
 {
     return GetResource();
@@ -29,6 +29,37 @@ ComPtr<CanvasRadialGradientBrush> CanvasRadialGradientBrush::CreateNew(
         d2dBrush.Get());
     CheckMakeResult(canvasRadialGradientBrush);
 
+    // The brush is rebuilt from the old D2D brush, which keeps its
+    // properties after device loss, so no extra copy is needed.
+    if (auto registry = deviceInternal->GetResourceRecreationRegistry())
+    {
+        registry->Register(
+            As<ICanvasRadialGradientBrush>(canvasRadialGradientBrush).Get(),
+            0,
+            [] (IUnknown* wrapper, ICanvasDevice* newDevice) -> ComPtr<IUnknown>
+            {
+                auto oldBrush = GetWrappedResource<ID2D1RadialGradientBrush>(wrapper);
+
+                ComPtr<ID2D1GradientStopCollection> oldStopCollection;
+                oldBrush->GetGradientStopCollection(&oldStopCollection);
+
+                auto newStopCollection = CopyGradientStopCollection(newDevice, oldStopCollection.Get());
+                auto newBrush = As<ICanvasDeviceInternal>(newDevice)->CreateRadialGradientBrush(newStopCollection.Get());
+
+                newBrush->SetCenter(oldBrush->GetCenter());
+                newBrush->SetGradientOriginOffset(oldBrush->GetGradientOriginOffset());
+                newBrush->SetRadiusX(oldBrush->GetRadiusX());
+                newBrush->SetRadiusY(oldBrush->GetRadiusY());
+
+                D2D1_MATRIX_3X2_F transform;
+                oldBrush->GetTransform(&transform);
+                newBrush->SetTransform(&transform);
+                newBrush->SetOpacity(oldBrush->GetOpacity());
+
+                return newBrush;
+            });
+    }
+
     return canvasRadialGradientBrush;
 }
 
@@ -305,6 +336,19 @@ IFACEMETHODIMP CanvasRadialGradientBrush::Close()
     return ResourceWrapper::Close();
 }
 
+bool CanvasRadialGradientBrush::IsRecreatable()
+{
+    return HasResource();
+}
+
+ComPtr<IUnknown> CanvasRadialGradientBrush::SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource)
+{
+    auto d2dBrush = As<ID2D1RadialGradientBrush>(newResource);
+
+    m_device = newDevice;
+    return ExchangeResource(d2dBrush.Get());
+}
+
 ComPtr<ID2D1Brush> CanvasRadialGradientBrush::GetD2DBrush(ID2D1DeviceContext*, GetBrushFlags)
 {
     return GetResource();
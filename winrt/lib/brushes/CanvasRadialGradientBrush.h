@@ -13,6 +13,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ID2D1RadialGradientBrush,
         CanvasRadialGradientBrush,
         ICanvasRadialGradientBrush,
+        CloakedIid<ICanvasResourceRecreatable>,
         MixIn<CanvasRadialGradientBrush, CanvasBrush>),
         public CanvasBrush
     {
@@ -63,6 +64,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         // ICanvasBrushInternal
         virtual ComPtr<ID2D1Brush> GetD2DBrush(ID2D1DeviceContext* deviceContext, GetBrushFlags flags) override;
 
+        // ICanvasResourceRecreatable
+        virtual bool IsRecreatable() override;
+        virtual ComPtr<IUnknown> SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource) override;
+
     private:
         ComPtr<ID2D1GradientStopCollection1> GetGradientStopCollection();
     };
@@ -50,6 +50,26 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             CanvasAlphaMode::Premultiplied);
     }
 
+    ComPtr<ID2D1GradientStopCollection1> CopyGradientStopCollection(
+        ICanvasDevice* canvasDevice,
+        ID2D1GradientStopCollection* source)
+    {
+        auto source1 = As<ID2D1GradientStopCollection1>(source);
+
+        auto stopCount = source1->GetGradientStopCount();
+
+        std::vector<D2D1_GRADIENT_STOP> d2dStops(stopCount);
+        source1->GetGradientStops1(d2dStops.data(), stopCount);
+
+        return As<ICanvasDeviceInternal>(canvasDevice)->CreateGradientStopCollection(
+            std::move(d2dStops),
+            source1->GetPreInterpolationSpace(),
+            source1->GetPostInterpolationSpace(),
+            source1->GetBufferPrecision(),
+            source1->GetExtendMode(),
+            source1->GetColorInterpolationMode());
+    }
+
     uint8_t DesaturateChannel(uint8_t channel, float amount)
     {
         amount = Saturate(amount); // performs clamping
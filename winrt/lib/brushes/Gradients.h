@@ -13,6 +13,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     ComPtr<ID2D1GradientStopCollection1> CreateRainbowGradientStopCollection(
         ICanvasDevice* canvasDevice,
         float eldritchness);
+
+    // Creates a stop collection on canvasDevice with the same stops and
+    // options as one from another (possibly lost) device.
+    ComPtr<ID2D1GradientStopCollection1> CopyGradientStopCollection(
+        ICanvasDevice* canvasDevice,
+        ID2D1GradientStopCollection* source);
     
     template<typename STOP>
     inline ComPtr<ID2D1GradientStopCollection1> CreateGradientStopCollection(
@@ -5,6 +5,9 @@
 #include "pch.h"
 
 #include "CanvasLock.h"
+#include "text/CanvasTextLayoutCache.h"
+#include "CanvasDeviceWarmUpResult.h"
+#include "ResourceRecreationRegistry.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
@@ -391,6 +394,74 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+    IFACEMETHODIMP CanvasDeviceFactory::WarmUpSharedDeviceAsync(
+        IAsyncOperation<CanvasDeviceWarmUpResult*>** operation)
+    {
+        return WarmUpSharedDeviceWithShadersAsync(FALSE, nullptr, operation);
+    }
+
+    IFACEMETHODIMP CanvasDeviceFactory::WarmUpSharedDeviceWithShadersAsync(
+        boolean forceSoftwareRenderer,
+        IIterable<IBuffer*>* shaders,
+        IAsyncOperation<CanvasDeviceWarmUpResult*>** operation)
+    {
+        using ::Windows::Storage::Streams::IBufferByteAccess;
+
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(operation);
+
+                // Copy the shader code now, as the app may change its buffers
+                // while the warm-up is running.
+                std::vector<std::vector<BYTE>> shaderCode;
+
+                if (shaders)
+                {
+                    ComPtr<IIterator<IBuffer*>> iterator;
+                    ThrowIfFailed(shaders->First(&iterator));
+
+                    boolean hasCurrent;
+                    ThrowIfFailed(iterator->get_HasCurrent(&hasCurrent));
+
+                    while (hasCurrent)
+                    {
+                        ComPtr<IBuffer> buffer;
+                        ThrowIfFailed(iterator->get_Current(&buffer));
+                        CheckInPointer(buffer.Get());
+
+                        uint32_t byteCount;
+                        uint8_t* bytes;
+
+                        ThrowIfFailed(buffer->get_Length(&byteCount));
+                        ThrowIfFailed(As<IBufferByteAccess>(buffer)->Buffer(&bytes));
+
+                        shaderCode.emplace_back(bytes, bytes + byteCount);
+
+                        ThrowIfFailed(iterator->MoveNext(&hasCurrent));
+                    }
+                }
+
+                bool forceSoftware = !!forceSoftwareRenderer;
+
+                //
+                // The shared device, and the singletons warmed up alongside
+                // it, only stay alive while something is holding on to them.
+                // That's left to the app, through the result, so that a lost
+                // shared device isn't kept alive by Win2D.
+                //
+                auto asyncOperation = Make<AsyncOperation<CanvasDeviceWarmUpResult>>(
+                    [=]
+                    {
+                        return CanvasDeviceWarmUpResult::WarmUp(
+                            [=] { return SharedDeviceState::GetInstance()->GetSharedDevice(forceSoftware); },
+                            shaderCode);
+                    });
+                CheckMakeResult(asyncOperation);
+                ThrowIfFailed(asyncOperation.CopyTo(operation));
+            });
+    }
+
 
     //
     // ICanvasFactoryNative.
@@ -524,8 +595,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         , m_forceSoftwareRenderer(forceSoftwareRenderer)
         , m_dxgiDevice(dxgiDevice)
         , m_sharedState(SharedDeviceState::GetInstance())
-        , m_deviceContextPool(d2dDevice)
+        , m_deviceContextPool(d2dDevice, false, static_cast<ICanvasDevice*>(this))
+        , m_drawingSessionContextPool(d2dDevice, true, static_cast<ICanvasDevice*>(this))
         , m_spriteBatchQuirk(SpriteBatchQuirk::NeedsCheck)
+        , m_textLayoutCache(std::make_shared<Text::CanvasTextLayoutCache>())
     {
         if (!dxgiDevice)
         {
@@ -854,12 +927,82 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+    IFACEMETHODIMP CanvasDevice::get_IsResourceRecreationEnabled(boolean* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+
+                *value = GetResourceRecreationRegistry() != nullptr;
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::put_IsResourceRecreationEnabled(boolean value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                Lock lock(m_recreationRegistryMutex);
+
+                if (!value)
+                    m_recreationRegistry.reset();
+                else if (!m_recreationRegistry)
+                    m_recreationRegistry = std::make_shared<ResourceRecreationRegistry>();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::get_ResourceRecreationMemoryUsage(UINT64* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+
+                auto registry = GetResourceRecreationRegistry();
+
+                *value = registry ? registry->GetBackingMemorySize() : 0;
+            });
+    }
+
+    IFACEMETHODIMP CanvasDevice::RecreateResourcesAsync(ICanvasDevice* lostDevice, IAsyncAction** action)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(lostDevice);
+                CheckAndClearOutPointer(action);
+
+                if (IsSameInstance(static_cast<ICanvasDevice*>(this), lostDevice))
+                    ThrowHR(E_INVALIDARG);
+
+                ThrowIfFailed(put_IsResourceRecreationEnabled(true));
+
+                auto lostRegistry = As<ICanvasDeviceInternal>(lostDevice)->GetResourceRecreationRegistry();
+                auto newRegistry = GetResourceRecreationRegistry();
+                ComPtr<ICanvasDevice> newDevice(this);
+
+                ComPtr<ICanvasDevice> lostDeviceRef(lostDevice);
+
+                auto asyncAction = Make<AsyncAction>(
+                    [lostRegistry, newRegistry, lostDeviceRef, newDevice]
+                    {
+                        if (lostRegistry && newRegistry)
+                            lostRegistry->RecreateResources(lostDeviceRef.Get(), newDevice.Get(), newRegistry.get());
+                    });
+
+                CheckMakeResult(asyncAction);
+                ThrowIfFailed(asyncAction.CopyTo(action));
+            });
+    }
+
     IFACEMETHODIMP CanvasDevice::Close()
     {
         return ExceptionBoundary(
             [&]
             {
                 m_deviceContextPool.Close();
+                m_drawingSessionContextPool.Close();
                 ThrowIfFailed(this->ResourceWrapper::Close()); // 'this->' is workaround for VS2013 calling with bad 'this' pointer
 
                 m_dxgiDevice.Close();
@@ -867,6 +1010,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 m_sharedState.reset();
                 m_histogramEffect.Reset();
                 m_atlasEffect.Reset();
+                m_textLayoutCache->Clear();
         });
     }
 
@@ -882,6 +1026,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return dc;
     }
 
+    DeviceContextLease CanvasDevice::LeaseDeviceContextForDrawingSession()
+    {
+        return m_drawingSessionContextPool.TakeLease();
+    }
+
     ComPtr<ID2D1SolidColorBrush> CanvasDevice::CreateSolidColorBrush(D2D1_COLOR_F const& color)
     {
         auto deviceContext = GetResourceCreationDeviceContext();
@@ -1276,6 +1425,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         DirectXPixelFormat format,
         int32_t bufferCount,
         CanvasAlphaMode alphaMode,
+        CanvasSwapChainOptions options,
         FN&& createFn)
     {
         auto& d2dDevice = GetResource();
@@ -1305,6 +1455,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
         swapChainDesc.AlphaMode = ToDxgiAlphaMode(alphaMode);
 
+        if ((options & CanvasSwapChainOptions::LowLatency) != CanvasSwapChainOptions::None)
+        {
+            swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+            swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        }
+
+        // Tearing is quietly dropped where it isn't supported, so that apps
+        // don't need to check for support before asking for it.
+        if ((options & CanvasSwapChainOptions::AllowTearing) != CanvasSwapChainOptions::None &&
+            IsTearingSupported(dxgiFactory.Get()))
+        {
+            swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        }
+
         ComPtr<IDXGISwapChain1> swapChain;
         ThrowIfCreateSurfaceFailed(
             createFn(dxgiFactory.Get(), dxgiDevice.Get(), &swapChainDesc, &swapChain),
@@ -1314,15 +1478,29 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return swapChain;
     }
 
+    bool CanvasDevice::IsTearingSupported(IDXGIFactory2* dxgiFactory)
+    {
+        auto dxgiFactory5 = MaybeAs<IDXGIFactory5>(dxgiFactory);
+        if (!dxgiFactory5)
+            return false;
+
+        BOOL allowTearing = FALSE;
+        if (FAILED(dxgiFactory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+            return false;
+
+        return allowTearing != FALSE;
+    }
+
 
     ComPtr<IDXGISwapChain1> CanvasDevice::CreateSwapChainForComposition(
         int32_t widthInPixels,
         int32_t heightInPixels,
         DirectXPixelFormat format,
         int32_t bufferCount,
-        CanvasAlphaMode alphaMode)
+        CanvasAlphaMode alphaMode,
+        CanvasSwapChainOptions options)
     {
-        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode,
+        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode, options,
             [] (IDXGIFactory2* factory, IDXGIDevice3* device, DXGI_SWAP_CHAIN_DESC1* desc, IDXGISwapChain1** swapChain)
             {
                 return factory->CreateSwapChainForComposition(
@@ -1341,7 +1519,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         int32_t bufferCount,
         CanvasAlphaMode alphaMode)
     {
-        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode,
+        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode, CanvasSwapChainOptions::None,
             [coreWindow] (IDXGIFactory2* factory, IDXGIDevice3* device, DXGI_SWAP_CHAIN_DESC1* desc, IDXGISwapChain1** swapChain)
             {
                 return factory->CreateSwapChainForCoreWindow(
@@ -1361,7 +1539,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         int32_t bufferCount,
         CanvasAlphaMode alphaMode)
     {
-        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode,
+        return CreateSwapChain(widthInPixels, heightInPixels, format, bufferCount, alphaMode, CanvasSwapChainOptions::None,
             [hwnd](IDXGIFactory2* factory, IDXGIDevice3* device, DXGI_SWAP_CHAIN_DESC1* desc, IDXGISwapChain1** swapChain)
             {
                 return factory->CreateSwapChainForHwnd(
@@ -1449,6 +1627,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return m_deviceContextPool.TakeLease();
     }
 
+    DeviceContextPoolStatistics CanvasDevice::GetDrawingSessionContextPoolStatistics()
+    {
+        return m_drawingSessionContextPool.GetStatistics();
+    }
+
     void CanvasDevice::InitializePrimaryOutput(IDXGIDevice3* dxgiDevice)
     {
         D2DResourceLock lock(GetResource().Get());
@@ -1637,6 +1820,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return d2dSvgDocument;
     }
 
+    std::shared_ptr<Text::CanvasTextLayoutCache> CanvasDevice::GetTextLayoutCache()
+    {
+        return m_textLayoutCache;
+    }
+
+    std::shared_ptr<ResourceRecreationRegistry> CanvasDevice::GetResourceRecreationRegistry()
+    {
+        Lock lock(m_recreationRegistryMutex);
+
+        return m_recreationRegistry;
+    }
+
     HRESULT CanvasDevice::GetDeviceRemovedErrorCode()
     {
         auto& dxgiDevice = m_dxgiDevice.EnsureNotClosed();
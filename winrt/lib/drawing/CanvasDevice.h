@@ -12,10 +12,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     using namespace WinRTDirectX;
     using namespace ABI::Windows::UI::Core;
     using namespace ABI::Windows::ApplicationModel::Core;
+    using namespace ABI::Windows::Foundation::Collections;
+    using namespace ABI::Windows::Storage::Streams;
 
     class CanvasDevice;
     class SharedDeviceState;
     class DefaultDeviceAdapter;
+    class ResourceRecreationRegistry;
+
+    namespace Text
+    {
+        class CanvasTextLayoutCache;
+    }
 
 
     //
@@ -78,6 +86,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual ComPtr<ID2D1DeviceContext1> CreateDeviceContextForDrawingSession() = 0;
 
+        // Returns a pooled device context, whose state is reset when the lease is returned.
+        virtual DeviceContextLease LeaseDeviceContextForDrawingSession() = 0;
+
         virtual ComPtr<ID2D1SolidColorBrush> CreateSolidColorBrush(D2D1_COLOR_F const& color) = 0;
 
         virtual ComPtr<ID2D1Bitmap1> CreateBitmapFromWicResource(
@@ -129,7 +140,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             int32_t heightInPixels,
             DirectXPixelFormat format,
             int32_t bufferCount,
-            CanvasAlphaMode alphaMode) = 0;
+            CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options) = 0;
 
         virtual ComPtr<IDXGISwapChain1> CreateSwapChainForCoreWindow(
             ICoreWindow* coreWindow,
@@ -178,6 +190,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         virtual bool IsSpriteBatchQuirkRequired() = 0;
 
         virtual ComPtr<ID2D1SvgDocument> CreateSvgDocument(IStream* inputXmlStream) = 0;
+
+        virtual std::shared_ptr<Text::CanvasTextLayoutCache> GetTextLayoutCache() = 0;
+
+        // Null unless resource recreation has been enabled on this device.
+        virtual std::shared_ptr<ResourceRecreationRegistry> GetResourceRecreationRegistry() = 0;
     };
 
 
@@ -214,6 +231,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         std::shared_ptr<SharedDeviceState> m_sharedState;
 
         DeviceContextPool m_deviceContextPool;
+        DeviceContextPool m_drawingSessionContextPool;
 
         ComPtr<ID2D1Effect> m_histogramEffect;
         ComPtr<ID2D1Effect> m_atlasEffect;
@@ -229,6 +247,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         SpriteBatchQuirk m_spriteBatchQuirk;
 
+        std::shared_ptr<Text::CanvasTextLayoutCache> m_textLayoutCache;
+
+        std::mutex m_recreationRegistryMutex;
+        std::shared_ptr<ResourceRecreationRegistry> m_recreationRegistry;
+
     public:
         static ComPtr<CanvasDevice> CreateNew(bool forceSoftwareRenderer);
         static ComPtr<CanvasDevice> CreateNew(IDirect3DDevice* direct3DDevice);
@@ -269,6 +292,13 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         IFACEMETHOD(Lock)(ICanvasLock** value) override;
 
+        IFACEMETHOD(get_IsResourceRecreationEnabled)(boolean* value) override;
+        IFACEMETHOD(put_IsResourceRecreationEnabled)(boolean value) override;
+
+        IFACEMETHOD(get_ResourceRecreationMemoryUsage)(UINT64* value) override;
+
+        IFACEMETHOD(RecreateResourcesAsync)(ICanvasDevice* lostDevice, IAsyncAction** action) override;
+
         //
         // ICanvasResourceCreator
         //
@@ -289,6 +319,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual ComPtr<ID2D1DeviceContext1> CreateDeviceContextForDrawingSession() override;
 
+        virtual DeviceContextLease LeaseDeviceContextForDrawingSession() override;
+
         virtual ComPtr<ID2D1SolidColorBrush> CreateSolidColorBrush(D2D1_COLOR_F const& color) override;
 
         virtual ComPtr<ID2D1Bitmap1> CreateBitmapFromWicResource(
@@ -340,7 +372,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             int32_t heightInPixels,
             DirectXPixelFormat format,
             int32_t bufferCount,
-            CanvasAlphaMode alphaMode) override;
+            CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options) override;
 
         virtual ComPtr<IDXGISwapChain1> CreateSwapChainForCoreWindow(
             ICoreWindow* coreWindow,
@@ -386,6 +419,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual ComPtr<ID2D1SvgDocument> CreateSvgDocument(IStream* inputXmlStream) override;
 
+        virtual std::shared_ptr<Text::CanvasTextLayoutCache> GetTextLayoutCache() override;
+
+        virtual std::shared_ptr<ResourceRecreationRegistry> GetResourceRecreationRegistry() override;
+
         //
         // IDirect3DDevice
         //
@@ -408,6 +445,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         //
         HRESULT GetDeviceRemovedErrorCode();
 
+        DeviceContextPoolStatistics GetDrawingSessionContextPoolStatistics();
+
     private:
         static ComPtr<ID3D11Device> MakeD3D11Device(CanvasDeviceAdapter* adapter, bool forceSoftwareRenderer, bool useDebugD3DDevice);
 
@@ -418,8 +457,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             DirectXPixelFormat format,
             int32_t bufferCount,
             CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options,
             FN&& createFn);
 
+        bool IsTearingSupported(IDXGIFactory2* dxgiFactory);
+
         ComPtr<ID2D1Factory2> GetD2DFactory();
 
         void InitializePrimaryOutput(IDXGIDevice3* dxgiDevice);
@@ -544,6 +586,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHOD(put_DebugLevel)(CanvasDebugLevel debugLevel);
         IFACEMETHOD(get_DebugLevel)(CanvasDebugLevel* debugLevel);
 
+        IFACEMETHOD(WarmUpSharedDeviceAsync)(
+            IAsyncOperation<CanvasDeviceWarmUpResult*>** operation);
+
+        IFACEMETHOD(WarmUpSharedDeviceWithShadersAsync)(
+            boolean forceSoftwareRenderer,
+            IIterable<IBuffer*>* shaders,
+            IAsyncOperation<CanvasDeviceWarmUpResult*>** operation);
+
         //
         // ICanvasFactoryNative
         //
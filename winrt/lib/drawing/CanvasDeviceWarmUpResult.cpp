@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasDeviceWarmUpResult.h"
+#include "effects/shader/PixelShaderEffectImpl.h"
+#include "effects/shader/SharedShaderState.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ABI::Microsoft::Graphics::Canvas::Effects;
+    using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+    static int64_t GetPerformanceCounter()
+    {
+        LARGE_INTEGER counter;
+        if (QueryPerformanceCounter(&counter) == 0)
+        {
+            ThrowHR(E_FAIL);
+        }
+        return counter.QuadPart;
+    }
+
+
+    static int64_t GetPerformanceFrequency()
+    {
+        LARGE_INTEGER frequency;
+        if (QueryPerformanceFrequency(&frequency) == 0)
+        {
+            ThrowHR(E_FAIL);
+        }
+        return frequency.QuadPart;
+    }
+
+
+    // Runs one warm-up stage, returning how long it took.
+    template<typename TStage>
+    static TimeSpan TimeStage(TStage&& stage)
+    {
+        auto start = GetPerformanceCounter();
+
+        stage();
+
+        auto elapsed = GetPerformanceCounter() - start;
+
+        // TimeSpan is measured in 100ns ticks.
+        return TimeSpan{ elapsed * 10000000 / GetPerformanceFrequency() };
+    }
+
+
+    ComPtr<CanvasDeviceWarmUpResult> CanvasDeviceWarmUpResult::WarmUp(
+        std::function<ComPtr<ICanvasDevice>()> const& getDevice,
+        std::vector<std::vector<BYTE>> const& shaders)
+    {
+        auto result = Make<CanvasDeviceWarmUpResult>();
+        CheckMakeResult(result);
+
+        result->m_deviceCreationTime = TimeStage(
+            [&]
+            {
+                result->m_device = getDevice();
+            });
+
+        auto deviceInternal = As<ICanvasDeviceInternal>(result->m_device);
+
+        result->m_effectRegistrationTime = TimeStage(
+            [&]
+            {
+                ComPtr<ID2D1Factory> factory;
+                deviceInternal->GetD2DDevice()->GetFactory(&factory);
+
+                PixelShaderEffectImpl::Register(As<ID2D1Factory1>(factory).Get());
+            });
+
+        result->m_textFactoryCreationTime = TimeStage(
+            [&]
+            {
+                result->m_customFontManager = CustomFontManager::GetInstance();
+
+                result->m_customFontManager->GetSharedFactory();
+                result->m_customFontManager->GetTextAnalyzer();
+                result->m_customFontManager->GetSystemFontFallback();
+            });
+
+        result->m_imagingFactoryCreationTime = TimeStage(
+            [&]
+            {
+                result->m_wicAdapter = WicAdapter::GetInstance();
+                result->m_wicAdapter->GetFactory();
+            });
+
+        result->m_histogramEffectCreationTime = TimeStage(
+            [&]
+            {
+                // The device keeps these effects around for the next ComputeHistogram call.
+                auto deviceContext = deviceInternal->GetResourceCreationDeviceContext();
+                auto effects = deviceInternal->LeaseHistogramEffect(deviceContext.Get());
+                deviceInternal->ReleaseHistogramEffect(std::move(effects));
+            });
+
+        result->m_shaderPreloadTime = TimeStage(
+            [&]
+            {
+                result->m_preloadedShaders = PreloadedShaderCache::GetInstance();
+
+                for (auto& shader : shaders)
+                {
+                    auto sharedState = Make<SharedShaderState>(const_cast<BYTE*>(shader.data()), static_cast<uint32_t>(shader.size()));
+                    CheckMakeResult(sharedState);
+
+                    result->m_preloadedShaders->Add(sharedState.Get());
+                }
+            });
+
+        return result;
+    }
+
+
+    CanvasDeviceWarmUpResult::CanvasDeviceWarmUpResult()
+        : m_deviceCreationTime{}
+        , m_effectRegistrationTime{}
+        , m_textFactoryCreationTime{}
+        , m_imagingFactoryCreationTime{}
+        , m_histogramEffectCreationTime{}
+        , m_shaderPreloadTime{}
+    {
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_Device(ICanvasDevice** value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(value);
+                ThrowIfFailed(m_device.CopyTo(value));
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_DeviceCreationTime(TimeSpan* value)
+    {
+        return GetTime(m_deviceCreationTime, value);
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_EffectRegistrationTime(TimeSpan* value)
+    {
+        return GetTime(m_effectRegistrationTime, value);
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_TextFactoryCreationTime(TimeSpan* value)
+    {
+        return GetTime(m_textFactoryCreationTime, value);
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_ImagingFactoryCreationTime(TimeSpan* value)
+    {
+        return GetTime(m_imagingFactoryCreationTime, value);
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_HistogramEffectCreationTime(TimeSpan* value)
+    {
+        return GetTime(m_histogramEffectCreationTime, value);
+    }
+
+
+    IFACEMETHODIMP CanvasDeviceWarmUpResult::get_ShaderPreloadTime(TimeSpan* value)
+    {
+        return GetTime(m_shaderPreloadTime, value);
+    }
+
+
+    HRESULT CanvasDeviceWarmUpResult::GetTime(TimeSpan const& time, TimeSpan* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                *value = time;
+            });
+    }
+}}}}
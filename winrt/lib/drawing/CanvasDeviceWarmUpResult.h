@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+    using ABI::Windows::Foundation::TimeSpan;
+
+    namespace Effects
+    {
+        class PreloadedShaderCache;
+    }
+
+
+    //
+    // Result of CanvasDevice.WarmUpSharedDeviceAsync.  As well as reporting
+    // how long each stage took, this holds on to the objects that were
+    // warmed up, since several of them are singletons that would otherwise
+    // be released again as soon as the warm-up finished.
+    //
+    class CanvasDeviceWarmUpResult : public RuntimeClass<ICanvasDeviceWarmUpResult>
+                                   , private LifespanTracker<CanvasDeviceWarmUpResult>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasDeviceWarmUpResult, BaseTrust);
+
+        ComPtr<ICanvasDevice> m_device;
+        std::shared_ptr<Text::CustomFontManager> m_customFontManager;
+        std::shared_ptr<WicAdapter> m_wicAdapter;
+        std::shared_ptr<Effects::PreloadedShaderCache> m_preloadedShaders;
+
+        TimeSpan m_deviceCreationTime;
+        TimeSpan m_effectRegistrationTime;
+        TimeSpan m_textFactoryCreationTime;
+        TimeSpan m_imagingFactoryCreationTime;
+        TimeSpan m_histogramEffectCreationTime;
+        TimeSpan m_shaderPreloadTime;
+
+    public:
+        // Runs each stage in turn on the calling thread.  The first stage
+        // calls getDevice to get hold of the device to warm up.
+        static ComPtr<CanvasDeviceWarmUpResult> WarmUp(
+            std::function<ComPtr<ICanvasDevice>()> const& getDevice,
+            std::vector<std::vector<BYTE>> const& shaders);
+
+        CanvasDeviceWarmUpResult();
+
+        IFACEMETHOD(get_Device)(ICanvasDevice** value) override;
+
+        IFACEMETHOD(get_DeviceCreationTime)(TimeSpan* value) override;
+        IFACEMETHOD(get_EffectRegistrationTime)(TimeSpan* value) override;
+        IFACEMETHOD(get_TextFactoryCreationTime)(TimeSpan* value) override;
+        IFACEMETHOD(get_ImagingFactoryCreationTime)(TimeSpan* value) override;
+        IFACEMETHOD(get_HistogramEffectCreationTime)(TimeSpan* value) override;
+        IFACEMETHOD(get_ShaderPreloadTime)(TimeSpan* value) override;
+
+    private:
+        static HRESULT GetTime(TimeSpan const& time, TimeSpan* value);
+    };
+}}}}
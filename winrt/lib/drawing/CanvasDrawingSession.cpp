@@ -8,6 +8,8 @@
 #include "CanvasSpriteBatch.h"
 #include "text/CanvasTextFormat.h"
 #include "text/CanvasTextRenderingParameters.h"
+#include "text/CanvasTextCache.h"
+#include "text/CanvasTextLayout.h"
 #include "text/CanvasFontFace.h"
 #include "utils/TemporaryTransform.h"
 #include "text/TextUtilities.h"
@@ -137,6 +139,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         , m_targetHasActiveDrawingSession(std::move(targetHasActiveDrawingSession))
         , m_offset(offset)
         , m_nextLayerId(0)
+        , m_layerStatistics{}
+        , m_hasTargetBounds(false)
+        , m_targetBoundsInPixels{}
         , m_owner(owner)
     {
         if (m_targetHasActiveDrawingSession)
@@ -151,16 +156,72 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    ComPtr<ID2D1DeviceContext1> const& CanvasDrawingSession::GetResource()
+    {
+        FlushTextCacheBatch();
+
+        return ResourceWrapper::GetResource();
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::GetNativeResource(ICanvasDevice* device, float dpi, REFIID iid, void** resource)
+    {
+        // The app may draw directly to the device context once it has it.
+        HRESULT hr = ExceptionBoundary(
+            [&]
+            {
+                FlushTextCacheBatch();
+            });
+
+        if (FAILED(hr))
+            return hr;
+
+        return ResourceWrapper::GetNativeResource(device, dpi, iid, resource);
+    }
+
+
+    void CanvasDrawingSession::WriteLayerStatistics()
+    {
+        auto& statistics = m_layerStatistics;
+
+        if (statistics.FullLayers ||
+            statistics.AxisAlignedClips ||
+            statistics.RectangleGeometryClips ||
+            statistics.BoundedRoundedRectangleLayers ||
+            statistics.ElidedClips ||
+            statistics.SkippedLayers)
+        {
+            EventWrite_CanvasDrawingSession_LayerStatistics(
+                statistics.FullLayers,
+                statistics.AxisAlignedClips,
+                statistics.RectangleGeometryClips,
+                statistics.BoundedRoundedRectangleLayers,
+                statistics.ElidedClips,
+                statistics.SkippedLayers);
+
+            statistics = LayerStatistics{};
+        }
+    }
+
+
     IFACEMETHODIMP CanvasDrawingSession::Close()
     {
         return ExceptionBoundary(
             [&]
             {
                 auto deviceContext = MaybeGetResource();
+
+                // Cached text must be drawn before EndDraw, but failing to
+                // draw it mustn't stop the session from ending.
+                HRESULT flushResult = deviceContext
+                    ? ExceptionBoundary([&] { FlushTextCacheBatch(); })
+                    : S_OK;
         
                 ReleaseResource();
 
-                if (!m_activeLayerIds.empty())
+                WriteLayerStatistics();
+
+                if (!m_activeLayers.empty())
                     ThrowHR(E_FAIL, Strings::DidNotPopLayer);
 
                 if (m_targetHasActiveDrawingSession)
@@ -185,6 +246,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 m_inkD2DRenderer.Reset();
                 m_inkStateBlock.Reset();
 #endif
+
+                ThrowIfFailed(flushResult);
             });
     }
 
@@ -2498,14 +2561,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1Brush* brush,
         ICanvasTextFormat* format)
     {
+        // The default format never changes, so all default formats share
+        // generation 0 as far as the text cache is concerned.
+        bool isDefaultFormat = !format;
+
         if (!format)
             format = GetDefaultTextFormat();
 
         auto formatInternal = As<ICanvasTextFormatInternal>(format);
         auto realizedFormat = formatInternal->GetRealizedTextFormat();
         auto drawTextOptions = formatInternal->GetDrawTextOptions();
+        auto formatGeneration = isDefaultFormat ? 0 : formatInternal->GetGeneration();
         
-        DrawTextImpl(text, rect, brush, realizedFormat.Get(), drawTextOptions);
+        DrawTextImpl(text, rect, brush, realizedFormat.Get(), formatGeneration, drawTextOptions);
     }
 
 
@@ -2515,6 +2583,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ID2D1Brush* brush,
         ICanvasTextFormat* format)
     {
+        bool isDefaultFormat = !format;
+
         if (!format)
         {
             format = GetDefaultTextFormat();
@@ -2526,6 +2596,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         auto formatInternal = As<ICanvasTextFormatInternal>(format);
         auto drawTextOptions = formatInternal->GetDrawTextOptions();
+        auto formatGeneration = isDefaultFormat ? 0 : formatInternal->GetGeneration();
 
         ComPtr<IDWriteTextFormat> realizedTextFormat;
         
@@ -2549,7 +2620,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             realizedTextFormat = formatInternal->GetRealizedTextFormatClone(CanvasWordWrapping::NoWrap);
         }
 
-        DrawTextImpl(text, rect, brush, realizedTextFormat.Get(), drawTextOptions);
+        DrawTextImpl(text, rect, brush, realizedTextFormat.Get(), formatGeneration, drawTextOptions);
     }
 
 
@@ -2558,9 +2629,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         Rect const& rect,
         ID2D1Brush* brush,
         IDWriteTextFormat* realizedFormat,
+        uint64_t formatGeneration,
         D2D1_DRAW_TEXT_OPTIONS drawTextOptions)
     {
-        auto& deviceContext = GetResource();
+        // Consecutive cached draws share a sprite batch, so this mustn't
+        // flush it.
+        auto& deviceContext = ResourceWrapper::GetResource();
         CheckInPointer(brush);
 
         uint32_t textLength;
@@ -2569,10 +2643,34 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         auto d2dRect = ToD2DRect(rect);
 
+        if (m_textCache)
+        {
+            auto textCache = As<ICanvasTextCacheInternal>(m_textCache);
+
+            if (!m_textCacheBatch)
+                m_textCacheBatch = std::make_unique<CanvasTextCacheBatch>(CanvasTextCacheBatch{});
+
+            if (textCache->TryDrawText(m_textCacheBatch.get(), deviceContext.Get(), textBuffer, textLength, d2dRect, brush, realizedFormat, formatGeneration, drawTextOptions))
+                return;
+        }
+
+        FlushTextCacheBatch();
+
         deviceContext->DrawText(textBuffer, textLength, realizedFormat, &d2dRect, brush, drawTextOptions);
     }
 
 
+    void CanvasDrawingSession::FlushTextCacheBatch()
+    {
+        if (!m_textCacheBatch || !m_textCacheBatch->SpriteBatch)
+            return;
+
+        // put_TextCache flushes before changing the cache, so this is the
+        // cache that the batch came from.
+        As<ICanvasTextCacheInternal>(m_textCache)->FlushBatch(m_textCacheBatch.get());
+    }
+
+
     ICanvasTextFormat* CanvasDrawingSession::GetDefaultTextFormat()
     {
         if (!m_defaultTextFormat)
@@ -2620,7 +2718,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
                 deviceContext->DrawTextLayout(
                     D2D1_POINT_2F{ x, y },
-                    GetWrappedResource<IDWriteTextLayout>(textLayout).Get(),
+                    As<ICanvasTextLayoutInternal>(textLayout)->GetReadOnlyResource().Get(),
                     ToD2DBrush(brush).Get(),
                     StaticCastAs<D2D1_DRAW_TEXT_OPTIONS>(drawTextOptions));
             });
@@ -2657,7 +2755,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
                 deviceContext->DrawTextLayout(
                     D2D1_POINT_2F{ x, y },
-                    GetWrappedResource<IDWriteTextLayout>(textLayout).Get(),
+                    As<ICanvasTextLayoutInternal>(textLayout)->GetReadOnlyResource().Get(),
                     GetColorBrush(color),
                     StaticCastAs<D2D1_DRAW_TEXT_OPTIONS>(drawTextOptions));
             });
@@ -3386,7 +3484,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         }
         else
         {
-            auto& deviceContext = GetResource();
+            // Creating a brush doesn't draw, so there's no need to flush
+            // cached text first.
+            auto& deviceContext = ResourceWrapper::GetResource();
             ThrowIfFailed(deviceContext->CreateSolidColorBrush(ToD2DColor(color), &m_solidColorBrush));
         }
 
@@ -3399,7 +3499,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         if (!brush)
             return nullptr;
 
-        auto& deviceContext = GetResource();
+        auto& deviceContext = ResourceWrapper::GetResource();
 
         return As<ICanvasBrushInternal>(brush)->GetD2DBrush(deviceContext.Get(), GetBrushFlags::None);
     }
@@ -3512,6 +3612,39 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+    IFACEMETHODIMP CanvasDrawingSession::get_TextCache(ICanvasTextCache** value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetResource();
+                CheckAndClearOutPointer(value);
+
+                ThrowIfFailed(m_textCache.CopyTo(value));
+            });
+    }
+
+    IFACEMETHODIMP CanvasDrawingSession::put_TextCache(ICanvasTextCache* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& deviceContext = GetResource();
+
+                if (value)
+                {
+                    // The cache's pages can only be drawn on the device that created them.
+                    ComPtr<ID2D1Device> d2dDevice;
+                    deviceContext->GetDevice(&d2dDevice);
+
+                    if (!IsSameInstance(As<ICanvasTextCacheInternal>(value)->GetD2DDevice().Get(), d2dDevice.Get()))
+                        ThrowHR(E_INVALIDARG, Strings::TextCacheDeviceMismatch);
+                }
+
+                m_textCache = value;
+            });
+    }
+
 
     //
     // Converts the given offset from DIPs to the appropriate unit
@@ -3963,17 +4096,155 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
-    // Returns true if the current transform matrix contains only scaling and translation, but no rotation or skew.
-    static bool TransformIsAxisPreserving(ID2D1DeviceContext* deviceContext)
+    // Implementation of the public DrawGlyphRunForICanvasDrawingSession export,
+    // for native callers whose glyphs are already in DWrite's layout.
+
+#if defined(ARCH_X86)
+#pragma comment(linker, "/export:DrawGlyphRunForICanvasDrawingSession=_DrawGlyphRunForICanvasDrawingSession@52")
+#endif
+    WIN2DAPI DrawGlyphRunForICanvasDrawingSession(
+        ICanvasDrawingSession* drawingSession,
+        Vector2 point,
+        ICanvasFontFace* fontFace,
+        float fontSize,
+        uint32_t glyphCount,
+        uint16_t const* glyphIndices,
+        float const* glyphAdvances,
+        DWRITE_GLYPH_OFFSET const* glyphOffsets,
+        BOOL isSideways,
+        uint32_t bidiLevel,
+        ICanvasBrush* brush,
+        DWRITE_MEASURING_MODE measuringMode) noexcept
     {
-        D2D1_MATRIX_3X2_F transform;
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(drawingSession);
+                CheckInPointer(fontFace);
+                CheckInPointer(brush);
 
-        deviceContext->GetTransform(&transform);
+                if (glyphCount > 0)
+                    CheckInPointer(glyphIndices);
+
+                auto deviceContext = GetWrappedResource<ID2D1DeviceContext>(drawingSession);
+
+                DrawGlyphRunHelper helper(
+                    fontFace,
+                    fontSize,
+                    glyphCount,
+                    glyphIndices,
+                    glyphAdvances,
+                    glyphOffsets,
+                    static_cast<boolean>(isSideways),
+                    bidiLevel,
+                    brush,
+                    measuringMode,
+                    deviceContext);
+
+                auto d2dBrush = MaybeAs<ID2D1Brush>(helper.ClientDrawingEffect);
 
+                deviceContext->DrawGlyphRun(
+                    ToD2DPoint(point),
+                    &helper.DWriteGlyphRun,
+                    nullptr,
+                    d2dBrush.Get(),
+                    helper.MeasuringMode);
+            });
+    }
+
+    static bool IsAxisPreserving(D2D1_MATRIX_3X2_F const& transform)
+    {
         return transform._12 == 0.0f &&
                transform._21 == 0.0f;
     }
 
+    //
+    // Rectangle and rounded rectangle clip geometries don't need the
+    // general geometric mask machinery.  If clipGeometry is one of these,
+    // and stays axis aligned after geometryTransform, this returns the
+    // rectangle it covers (in the same space as the layer's content bounds).
+    //
+    enum class ClipGeometryShape
+    {
+        Other,
+        Rectangle,
+        RoundedRectangle
+    };
+
+    static ClipGeometryShape GetClipGeometryShape(
+        ID2D1Geometry* clipGeometry,
+        D2D1_MATRIX_3X2_F const& geometryTransform,
+        D2D1_RECT_F* bounds)
+    {
+        if (!IsAxisPreserving(geometryTransform))
+            return ClipGeometryShape::Other;
+
+        if (auto rectangleGeometry = MaybeAs<ID2D1RectangleGeometry>(clipGeometry))
+        {
+            D2D1_RECT_F rect;
+            rectangleGeometry->GetRect(&rect);
+
+            *bounds = TransformRectangle(rect, geometryTransform);
+            return ClipGeometryShape::Rectangle;
+        }
+
+        if (auto roundedRectangleGeometry = MaybeAs<ID2D1RoundedRectangleGeometry>(clipGeometry))
+        {
+            D2D1_ROUNDED_RECT roundedRect;
+            roundedRectangleGeometry->GetRoundedRect(&roundedRect);
+
+            *bounds = TransformRectangle(roundedRect.rect, geometryTransform);
+
+            if (roundedRect.radiusX <= 0 || roundedRect.radiusY <= 0)
+                return ClipGeometryShape::Rectangle;
+
+            return ClipGeometryShape::RoundedRectangle;
+        }
+
+        return ClipGeometryShape::Other;
+    }
+
+    D2D1_RECT_F CanvasDrawingSession::GetTargetBounds(ID2D1DeviceContext* deviceContext, D2D1_UNIT_MODE unitMode)
+    {
+        if (!m_hasTargetBounds)
+        {
+            // Command lists (and interop sessions with no target) are unbounded.
+            m_targetBoundsInPixels = D2D1::InfiniteRect();
+
+            ComPtr<ID2D1Image> target;
+            deviceContext->GetTarget(&target);
+
+            if (auto targetBitmap = MaybeAs<ID2D1Bitmap>(target))
+            {
+                auto size = targetBitmap->GetPixelSize();
+
+                m_targetBoundsInPixels = D2D1_RECT_F
+                {
+                    0,
+                    0,
+                    static_cast<float>(size.width),
+                    static_cast<float>(size.height)
+                };
+            }
+
+            m_hasTargetBounds = true;
+        }
+
+        if (unitMode == D2D1_UNIT_MODE_PIXELS || IsInfiniteRectangle(m_targetBoundsInPixels))
+            return m_targetBoundsInPixels;
+
+        // The world transform maps into DIPs, so compare in DIPs.
+        auto dpi = GetDpi(deviceContext);
+
+        return D2D1_RECT_F
+        {
+            0,
+            0,
+            PixelsToDips(static_cast<int>(m_targetBoundsInPixels.right), dpi),
+            PixelsToDips(static_cast<int>(m_targetBoundsInPixels.bottom), dpi)
+        };
+    }
+
     HRESULT CanvasDrawingSession::CreateLayerImpl(
         float opacity,
         ICanvasBrush* opacityBrush,
@@ -3997,13 +4268,108 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto d2dMatrix = geometryTransform ? *ReinterpretAs<D2D1_MATRIX_3X2_F const*>(geometryTransform) : D2D1::Matrix3x2F::Identity();
                 auto d2dAntialiasMode = deviceContext->GetAntialiasMode();
 
-                // Simple cases can be optimized to use PushAxisAlignedClip instead of PushLayer.
-                bool isAxisAlignedClip = clipRectangle &&
-                                         !d2dBrush &&
-                                         !d2dGeometry &&
-                                         opacity == 1.0f &&
-                                         options == CanvasLayerOptions::None &&
-                                         TransformIsAxisPreserving(deviceContext.Get());
+                // Layers that only clip, without changing opacity or
+                // requesting special options, are candidates for
+                // PushAxisAlignedClip instead of PushLayer.
+                bool isClipOnly = !d2dBrush &&
+                                  opacity == 1.0f &&
+                                  options == CanvasLayerOptions::None;
+
+                bool isRectangleGeometryClip = false;
+                bool isBoundedRoundedRectangle = false;
+
+                if (d2dGeometry)
+                {
+                    D2D1_RECT_F geometryBounds;
+
+                    switch (GetClipGeometryShape(d2dGeometry.Get(), d2dMatrix, &geometryBounds))
+                    {
+                    case ClipGeometryShape::Rectangle:
+                        if (isClipOnly)
+                        {
+                            // The geometry adds nothing that the content bounds can't express.
+                            d2dRect = RectangleIntersection(d2dRect, geometryBounds);
+                            d2dGeometry.Reset();
+                            isRectangleGeometryClip = true;
+                        }
+                        break;
+
+                    case ClipGeometryShape::RoundedRectangle:
+                        // The mask is still needed for the corners, but the
+                        // layer only needs to be as large as the geometry.
+                        if (!RectangleContains(geometryBounds, d2dRect))
+                        {
+                            d2dRect = RectangleIntersection(d2dRect, geometryBounds);
+                            isBoundedRoundedRectangle = true;
+                        }
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+
+                //
+                // Work out how much of the target this layer can affect.
+                // This is only worth doing (and only needs the world
+                // transform) when the layer has bounds of its own;
+                // otherwise it inherits the bounds of its parent.
+                //
+                auto unitMode = deviceContext->GetUnitMode();
+
+                // Bounds recorded under a different unit mode are in a
+                // different space, so they can't be used to cull this layer.
+                auto visibleBounds = (m_activeLayers.empty() || m_activeLayers.back().UnitMode != unitMode)
+                    ? D2D1::InfiniteRect()
+                    : m_activeLayers.back().VisibleBounds;
+
+                auto kind = LayerKind::Layer;
+
+                if (!IsInfiniteRectangle(d2dRect))
+                {
+                    D2D1_MATRIX_3X2_F worldTransform;
+                    deviceContext->GetTransform(&worldTransform);
+
+                    auto parentBounds = RectangleIntersection(visibleBounds, GetTargetBounds(deviceContext.Get(), unitMode));
+                    auto layerBounds = TransformRectangle(d2dRect, worldTransform);
+
+                    visibleBounds = RectangleIntersection(parentBounds, layerBounds);
+
+                    if (IsEmptyRectangle(visibleBounds))
+                    {
+                        // Nothing drawn inside this layer can be seen.  An
+                        // empty clip makes D2D discard it cheaply.
+                        kind = LayerKind::AxisAlignedClip;
+                        d2dRect = D2D1_RECT_F{ 0, 0, 0, 0 };
+                        visibleBounds = d2dRect;
+                        m_layerStatistics.SkippedLayers++;
+                    }
+                    else if (isClipOnly && !d2dGeometry && IsAxisPreserving(worldTransform))
+                    {
+                        if (RectangleContains(layerBounds, parentBounds))
+                        {
+                            kind = LayerKind::Elided;
+                            m_layerStatistics.ElidedClips++;
+                        }
+                        else
+                        {
+                            kind = LayerKind::AxisAlignedClip;
+
+                            if (isRectangleGeometryClip)
+                                m_layerStatistics.RectangleGeometryClips++;
+                            else
+                                m_layerStatistics.AxisAlignedClips++;
+                        }
+                    }
+                }
+
+                if (kind == LayerKind::Layer)
+                {
+                    if (isBoundedRoundedRectangle)
+                        m_layerStatistics.BoundedRoundedRectangleLayers++;
+                    else
+                        m_layerStatistics.FullLayers++;
+                }
 
                 // Store a unique ID, used for validation in PopLayer. This extra state 
                 // is needed because the D2D PopLayer method always just pops the topmost 
@@ -4019,67 +4385,82 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
                 int layerId = ++m_nextLayerId;
 
-                m_activeLayerIds.push_back(layerId);
+                m_activeLayers.push_back(ActiveLayer{ layerId, kind, visibleBounds, unitMode });
 
                 // Construct a scope object that will pop the layer when its Close method is called.
                 WeakRef weakSelf = AsWeak(this);
 
                 auto activeLayer = Make<CanvasActiveLayer>(
-                    [weakSelf, layerId, isAxisAlignedClip]() mutable
+                    [weakSelf, layerId, kind]() mutable
                     {
                         auto strongSelf = LockWeakRef<ICanvasDrawingSession>(weakSelf);
                         auto self = static_cast<CanvasDrawingSession*>(strongSelf.Get());
 
                         if (self)
-                            self->PopLayer(layerId, isAxisAlignedClip);
+                            self->PopLayer(layerId, kind);
                     });
 
                 CheckMakeResult(activeLayer);
 
-                if (isAxisAlignedClip)
+                switch (kind)
                 {
+                case LayerKind::AxisAlignedClip:
                     // Tell D2D to push an axis aligned clip region.
                     deviceContext->PushAxisAlignedClip(&d2dRect, d2dAntialiasMode);
-                }
-                else
-                {
-                    // Tell D2D to push the layer.
-                    D2D1_LAYER_PARAMETERS1 parameters =
+                    break;
+
+                case LayerKind::Elided:
+                    break;
+
+                default:
                     {
-                        d2dRect,
-                        d2dGeometry.Get(),
-                        d2dAntialiasMode,
-                        d2dMatrix,
-                        opacity,
-                        d2dBrush.Get(),
-                        static_cast<D2D1_LAYER_OPTIONS1>(options)
-                    };
-
-                    deviceContext->PushLayer(&parameters, nullptr);
+                        // Tell D2D to push the layer.
+                        D2D1_LAYER_PARAMETERS1 parameters =
+                        {
+                            d2dRect,
+                            d2dGeometry.Get(),
+                            d2dAntialiasMode,
+                            d2dMatrix,
+                            opacity,
+                            d2dBrush.Get(),
+                            static_cast<D2D1_LAYER_OPTIONS1>(options)
+                        };
+
+                        deviceContext->PushLayer(&parameters, nullptr);
+                    }
+                    break;
                 }
 
                 ThrowIfFailed(activeLayer.CopyTo(layer));
             });
     }
 
-    void CanvasDrawingSession::PopLayer(int layerId, bool isAxisAlignedClip)
+    void CanvasDrawingSession::PopLayer(int layerId, LayerKind kind)
     {
         auto& deviceContext = GetResource();
 
-        assert(!m_activeLayerIds.empty());
+        assert(!m_activeLayers.empty());
 
-        if (m_activeLayerIds.back() != layerId)
+        if (m_activeLayers.back().Id != layerId)
             ThrowHR(E_FAIL, Strings::PoppedWrongLayer);
 
-        m_activeLayerIds.pop_back();
+        m_activeLayers.pop_back();
 
-        if (isAxisAlignedClip)
+        if (m_activeLayers.empty())
+            m_hasTargetBounds = false;
+
+        switch (kind)
         {
+        case LayerKind::AxisAlignedClip:
             deviceContext->PopAxisAlignedClip();
-        }
-        else
-        {
+            break;
+
+        case LayerKind::Elided:
+            break;
+
+        default:
             deviceContext->PopLayer();
+            break;
         }
     }
 
@@ -29,6 +29,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     class DefaultInkAdapter;
 
+    namespace Text
+    {
+        struct CanvasTextCacheBatch;
+    }
+
     class InkAdapter : public Singleton<InkAdapter, DefaultInkAdapter>
     {
     public:
@@ -62,9 +67,64 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         
         ComPtr<ID2D1SolidColorBrush> m_solidColorBrush;
         ComPtr<ICanvasTextFormat> m_defaultTextFormat;
+        ComPtr<ICanvasTextCache> m_textCache;
+
+        // Text drawn from m_textCache that hasn't been submitted to the
+        // device context yet.  See FlushTextCacheBatch.
+        std::unique_ptr<Text::CanvasTextCacheBatch> m_textCacheBatch;
+
+        //
+        // Layers are implemented in one of three ways, cheapest first:
+        //
+        //  - Elided: a clip that cannot remove anything, because the layer
+        //    it is nested in (or the target) is already smaller.  Nothing is
+        //    pushed to D2D.
+        //
+        //  - AxisAlignedClip: clip-only layers whose clip is a rectangle in
+        //    device space.  Layers that are entirely clipped away are also
+        //    pushed as an empty clip, so that D2D discards their drawing
+        //    without allocating a layer surface.
+        //
+        //  - Layer: everything else, using PushLayer.
+        //
+        enum class LayerKind
+        {
+            Layer,
+            AxisAlignedClip,
+            Elided
+        };
 
-        std::vector<int> m_activeLayerIds;
+        struct ActiveLayer
+        {
+            int Id;
+            LayerKind Kind;
+
+            // Conservative bounds of the area that drawing can still reach
+            // while this layer is active, in the units given by UnitMode (ie.
+            // after the world transform has been applied).
+            D2D1_RECT_F VisibleBounds;
+            D2D1_UNIT_MODE UnitMode;
+        };
+
+        // How many layers took each path; reported through ETW when the
+        // drawing session is closed.
+        struct LayerStatistics
+        {
+            uint32_t FullLayers;
+            uint32_t AxisAlignedClips;
+            uint32_t RectangleGeometryClips;
+            uint32_t BoundedRoundedRectangleLayers;
+            uint32_t ElidedClips;
+            uint32_t SkippedLayers;
+        };
+
+        std::vector<ActiveLayer> m_activeLayers;
         int m_nextLayerId;
+        LayerStatistics m_layerStatistics;
+
+        // Cached for the duration of the outermost layer, in pixels.
+        bool m_hasTargetBounds;
+        D2D1_RECT_F m_targetBoundsInPixels;
 
         //
         // Contract:
@@ -102,6 +162,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual ~CanvasDrawingSession();
 
+        // Hides ResourceWrapper::GetResource, so that any pending cached text
+        // is drawn before the device context is used for anything else.
+        ComPtr<ID2D1DeviceContext1> const& GetResource();
+
+        // ICanvasResourceWrapperNative
+
+        IFACEMETHOD(GetNativeResource)(ICanvasDevice* device, float dpi, REFIID iid, void** resource) override;
+
         // IClosable
 
         IFACEMETHOD(Close)() override;
@@ -1204,6 +1272,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHOD(get_TextRenderingParameters)(ICanvasTextRenderingParameters** value) override;
         IFACEMETHOD(put_TextRenderingParameters)(ICanvasTextRenderingParameters* value) override;
 
+        IFACEMETHOD(get_TextCache)(ICanvasTextCache** value) override;
+        IFACEMETHOD(put_TextCache)(ICanvasTextCache* value) override;
+
         IFACEMETHOD(get_Transform)(ABI::Microsoft::Graphics::Canvas::Numerics::Matrix3x2* value) override;
         IFACEMETHOD(put_Transform)(ABI::Microsoft::Graphics::Canvas::Numerics::Matrix3x2 value) override;
 
@@ -1402,15 +1473,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ID2D1Brush* brush,
             ICanvasTextFormat* format);
 
+        // formatGeneration is only used to look up m_textCache.
         void DrawTextImpl(
             HSTRING text,
             Rect const& rect,
             ID2D1Brush* brush,
             IDWriteTextFormat* format,
+            uint64_t formatGeneration,
             D2D1_DRAW_TEXT_OPTIONS options);
 
         ICanvasTextFormat* GetDefaultTextFormat();
 
+        void FlushTextCacheBatch();
+
         void DrawGeometryImpl(
             ICanvasGeometry* geometry,
             ID2D1Brush* brush,
@@ -1456,7 +1531,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasLayerOptions options,
             ICanvasActiveLayer** layer);
 
-        void PopLayer(int layerId, bool isAxisAlignedClip);
+        void PopLayer(int layerId, LayerKind kind);
+
+        D2D1_RECT_F GetTargetBounds(ID2D1DeviceContext* deviceContext, D2D1_UNIT_MODE unitMode);
+
+        void WriteLayerStatistics();
 
 #ifdef WINUI3_SUPPORTS_INKING
         void DrawInkImpl(IIterable<InkStroke*>* inkStrokeCollection, bool highContrast);
@@ -1486,4 +1565,41 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowIfFailed(d2dDeviceContext->EndDraw());
         }
     };
+
+
+    //
+    // A SimpleCanvasDrawingSessionAdapter that owns a device context leased
+    // from CanvasDevice's drawing session pool.  The context is returned to
+    // the pool once the drawing session has ended.
+    //
+    class PooledCanvasDrawingSessionAdapter : public SimpleCanvasDrawingSessionAdapter
+    {
+        DeviceContextLease m_deviceContext;
+
+    public:
+        PooledCanvasDrawingSessionAdapter(DeviceContextLease&& deviceContext)
+            : SimpleCanvasDrawingSessionAdapter(deviceContext.Get())
+            , m_deviceContext(std::move(deviceContext))
+        {
+        }
+
+        virtual ~PooledCanvasDrawingSessionAdapter()
+        {
+            //
+            // If the drawing session was never created (or never closed)
+            // make sure the context isn't returned to the pool in the
+            // middle of a BeginDraw/EndDraw pair.
+            //
+            if (m_deviceContext.Get())
+                (void)m_deviceContext->EndDraw();
+        }
+
+        virtual void EndDraw(ID2D1DeviceContext1* d2dDeviceContext) override
+        {
+            // Moving the lease out ensures it is returned even if EndDraw throws.
+            auto lease = std::move(m_deviceContext);
+
+            SimpleCanvasDrawingSessionAdapter::EndDraw(d2dDeviceContext);
+        }
+    };
 }}}}
@@ -5,6 +5,7 @@
 #include "pch.h"
 
 #include "CanvasGradientMesh.h"
+#include "utils/LockUtilities.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
 using namespace ABI::Microsoft::Graphics::Canvas;
@@ -302,8 +303,154 @@ IFACEMETHODIMP CanvasGradientMesh::GetBoundsWithTransform(
 }
 
 
+IFACEMETHODIMP CanvasGradientMesh::ComputeBounds(
+    Rect* bounds)
+{
+    return ComputeBoundsWithTransform(Identity3x2(), bounds);
+}
+
+IFACEMETHODIMP CanvasGradientMesh::ComputeBoundsWithTransform(
+    Numerics::Matrix3x2 transform,
+    Rect* bounds)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(bounds);
+
+            auto evaluator = GetEvaluator();
+
+            auto d2dTransform = ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform);
+
+            D2D1_RECT_F d2dBounds = D2D1::Matrix3x2F::ReinterpretBaseType(d2dTransform)->IsIdentity()
+                ? evaluator->GetBounds()
+                : evaluator->GetBounds(*d2dTransform);
+
+            *bounds = FromD2DRect(d2dBounds);
+        });
+}
+
+IFACEMETHODIMP CanvasGradientMesh::HitTest(
+    Vector2 point,
+    int32_t* patchIndex,
+    Vector2* patchCoordinates,
+    boolean* isHit)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(patchIndex);
+            CheckInPointer(patchCoordinates);
+            CheckInPointer(isHit);
+
+            auto evaluator = GetEvaluator();
+            auto tessellation = GetTessellation(D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+            uint32_t hitPatchIndex;
+            Vector2 hitPatchCoordinates;
+
+            if (evaluator->HitTest(*tessellation, point, &hitPatchIndex, &hitPatchCoordinates))
+            {
+                *patchIndex = static_cast<int32_t>(hitPatchIndex);
+                *patchCoordinates = hitPatchCoordinates;
+                *isHit = true;
+            }
+            else
+            {
+                *patchIndex = -1;
+                *patchCoordinates = Vector2{};
+                *isHit = false;
+            }
+        });
+}
+
+IFACEMETHODIMP CanvasGradientMesh::Tessellate(
+    uint32_t* vertexCount,
+    CanvasGradientMeshVertex** vertices)
+{
+    return TessellateWithFlatteningTolerance(D2D1_DEFAULT_FLATTENING_TOLERANCE, vertexCount, vertices);
+}
+
+IFACEMETHODIMP CanvasGradientMesh::TessellateWithFlatteningTolerance(
+    float flatteningTolerance,
+    uint32_t* vertexCount,
+    CanvasGradientMeshVertex** vertices)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(vertexCount);
+            CheckAndClearOutPointer(vertices);
+
+            if (!(flatteningTolerance > 0))
+                ThrowHR(E_INVALIDARG);
+
+            auto tessellation = GetTessellation(flatteningTolerance);
+
+            ComArray<CanvasGradientMeshVertex> array(tessellation->Vertices.begin(), tessellation->Vertices.end());
+            array.Detach(vertexCount, vertices);
+        });
+}
+
+std::shared_ptr<GradientMeshEvaluator const> CanvasGradientMesh::GetEvaluator()
+{
+    auto& resource = GetResource();
+
+    Lock lock(m_mutex);
+
+    if (!m_evaluator)
+    {
+        uint32_t patchCount = resource->GetPatchCount();
+
+        std::vector<D2D1_GRADIENT_MESH_PATCH> d2dPatches(patchCount);
+
+        if (patchCount > 0)
+        {
+            ThrowIfFailed(resource->GetPatches(0, &d2dPatches[0], patchCount));
+        }
+
+        m_evaluator = std::make_shared<GradientMeshEvaluator>(d2dPatches);
+    }
+
+    return m_evaluator;
+}
+
+std::shared_ptr<GradientMeshEvaluator::Tessellation const> CanvasGradientMesh::GetTessellation(float flatteningTolerance)
+{
+    auto evaluator = GetEvaluator();
+
+    bool isDefault = (flatteningTolerance == D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+    {
+        Lock lock(m_mutex);
+
+        auto& cached = isDefault ? m_defaultTessellation : m_lastTessellation;
+
+        if (cached && cached->FlatteningTolerance == flatteningTolerance)
+            return cached;
+    }
+
+    // Tessellating can take a while for large meshes, so this is done
+    // without holding the lock.  Racing threads compute the same result.
+    std::shared_ptr<GradientMeshEvaluator::Tessellation const> tessellation = evaluator->Tessellate(flatteningTolerance);
+
+    Lock lock(m_mutex);
+
+    (isDefault ? m_defaultTessellation : m_lastTessellation) = tessellation;
+
+    return tessellation;
+}
+
 IFACEMETHODIMP CanvasGradientMesh::Close()
 {
+    {
+        Lock lock(m_mutex);
+
+        m_evaluator.reset();
+        m_defaultTessellation.reset();
+        m_lastTessellation.reset();
+    }
+
     m_canvasDevice.Close();
     return ResourceWrapper::Close();
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "GradientMeshEvaluator.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
 {
     using namespace Numerics;
@@ -18,6 +20,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ClosablePtr<ICanvasDevice> m_canvasDevice;
 
+        // The patches are read back from the D2D resource the first time
+        // they are needed on the CPU, and then kept along with the most
+        // recently used tessellations.  The default tolerance has its own slot
+        // since HitTest relies on it.
+        std::mutex m_mutex;
+        std::shared_ptr<GradientMeshEvaluator const> m_evaluator;
+        std::shared_ptr<GradientMeshEvaluator::Tessellation const> m_defaultTessellation;
+        std::shared_ptr<GradientMeshEvaluator::Tessellation const> m_lastTessellation;
+
     public:
         static ComPtr<CanvasGradientMesh> CreateNew(
             ICanvasResourceCreator* resourceCreator,
@@ -41,9 +52,35 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             Numerics::Matrix3x2 transform,
             Rect* bounds) override;
 
+        IFACEMETHOD(ComputeBounds)(
+            Rect* bounds) override;
+
+        IFACEMETHOD(ComputeBoundsWithTransform)(
+            Numerics::Matrix3x2 transform,
+            Rect* bounds) override;
+
+        IFACEMETHOD(HitTest)(
+            Vector2 point,
+            int32_t* patchIndex,
+            Vector2* patchCoordinates,
+            boolean* isHit) override;
+
+        IFACEMETHOD(Tessellate)(
+            uint32_t* vertexCount,
+            CanvasGradientMeshVertex** vertices) override;
+
+        IFACEMETHOD(TessellateWithFlatteningTolerance)(
+            float flatteningTolerance,
+            uint32_t* vertexCount,
+            CanvasGradientMeshVertex** vertices) override;
+
         IFACEMETHOD(Close)() override;
 
         IFACEMETHOD(get_Device)(ICanvasDevice** device) override;
+
+    private:
+        std::shared_ptr<GradientMeshEvaluator const> GetEvaluator();
+        std::shared_ptr<GradientMeshEvaluator::Tessellation const> GetTessellation(float flatteningTolerance);
     };
 
     class CanvasGradientMeshFactory
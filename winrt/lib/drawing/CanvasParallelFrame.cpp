@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasParallelFrame.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // CanvasParallelFrameFactory
+    //
+
+
+    IFACEMETHODIMP CanvasParallelFrameFactory::Create(
+        ICanvasResourceCreator* resourceCreator,
+        int32_t partCount,
+        ICanvasParallelFrame** parallelFrame)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckAndClearOutPointer(parallelFrame);
+
+                if (partCount <= 0)
+                    ThrowHR(E_INVALIDARG);
+
+                ComPtr<ICanvasDevice> device;
+                ThrowIfFailed(resourceCreator->get_Device(&device));
+
+                auto frame = Make<CanvasParallelFrame>(device.Get(), static_cast<uint32_t>(partCount));
+                CheckMakeResult(frame);
+
+                ThrowIfFailed(frame.CopyTo(parallelFrame));
+            });
+    }
+
+
+    //
+    // CanvasParallelFrame
+    //
+
+
+    CanvasParallelFrame::CanvasParallelFrame(ICanvasDevice* device, uint32_t partCount)
+        : m_frame(std::make_shared<ParallelFrame>(device, partCount))
+    {
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::get_PartCount(int32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+
+                *value = static_cast<int32_t>(GetFrame()->GetPartCount());
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::GetDrawingSession(
+        int32_t partIndex,
+        ICanvasDrawingSession** drawingSession)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(drawingSession);
+
+                if (partIndex < 0)
+                    ThrowHR(E_BOUNDS);
+
+                ComPtr<ICanvasDrawingSession> result = GetFrame()->GetDrawingSession(static_cast<uint32_t>(partIndex));
+                ThrowIfFailed(result.CopyTo(drawingSession));
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::RecordLayers(
+        ICanvasParallelFrameLayerHandler* drawLayer)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(drawLayer);
+
+                GetFrame()->RecordLayers(
+                    [=] (ICanvasDrawingSession* drawingSession, uint32_t layerIndex)
+                    {
+                        ThrowIfFailed(drawLayer->Invoke(drawingSession, static_cast<int32_t>(layerIndex)));
+                    });
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::RecordTiles(
+        Rect bounds,
+        Size tileSize,
+        ICanvasParallelFrameTileHandler* drawTile)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(drawTile);
+
+                GetFrame()->RecordTiles(bounds, tileSize,
+                    [=] (ICanvasDrawingSession* drawingSession, Rect const& tile)
+                    {
+                        ThrowIfFailed(drawTile->Invoke(drawingSession, tile));
+                    });
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::Composite(
+        ICanvasDrawingSession* target)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                GetFrame()->Composite(target);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasParallelFrame::Close()
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                std::shared_ptr<ParallelFrame> frame;
+
+                {
+                    Lock lock(m_mutex);
+                    std::swap(frame, m_frame);
+                }
+
+                // Calls still in progress on other threads keep the frame
+                // alive until they're done with it.
+                frame.reset();
+            });
+    }
+
+
+    std::shared_ptr<ParallelFrame> CanvasParallelFrame::GetFrame()
+    {
+        Lock lock(m_mutex);
+
+        if (!m_frame)
+            ThrowHR(RO_E_CLOSED);
+
+        return m_frame;
+    }
+
+
+    ActivatableClassWithFactory(CanvasParallelFrame, CanvasParallelFrameFactory);
+}}}}
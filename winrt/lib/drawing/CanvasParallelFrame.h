@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "ParallelFrame.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    class CanvasParallelFrame : public RuntimeClass<ICanvasParallelFrame, IClosable>,
+                                private LifespanTracker<CanvasParallelFrame>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasParallelFrame, BaseTrust);
+
+        //
+        // Close may race with calls on other threads.  The mutex only
+        // guards m_frame itself: each call takes its own reference to the
+        // frame and doesn't hold the lock while drawing, since the handlers
+        // passed to RecordLayers and RecordTiles may call back into this
+        // object from worker threads.
+        //
+        std::mutex m_mutex;
+        std::shared_ptr<ParallelFrame> m_frame;
+
+    public:
+        CanvasParallelFrame(ICanvasDevice* device, uint32_t partCount);
+
+        // ICanvasParallelFrame
+
+        IFACEMETHOD(get_PartCount)(int32_t* value) override;
+
+        IFACEMETHOD(GetDrawingSession)(
+            int32_t partIndex,
+            ICanvasDrawingSession** drawingSession) override;
+
+        IFACEMETHOD(RecordLayers)(
+            ICanvasParallelFrameLayerHandler* drawLayer) override;
+
+        IFACEMETHOD(RecordTiles)(
+            Rect bounds,
+            Size tileSize,
+            ICanvasParallelFrameTileHandler* drawTile) override;
+
+        IFACEMETHOD(Composite)(
+            ICanvasDrawingSession* target) override;
+
+        // IClosable
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        std::shared_ptr<ParallelFrame> GetFrame();
+    };
+
+
+    class CanvasParallelFrameFactory
+        : public AgileActivationFactory<ICanvasParallelFrameFactory>
+        , private LifespanTracker<CanvasParallelFrameFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_CanvasParallelFrame, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasResourceCreator* resourceCreator,
+            int32_t partCount,
+            ICanvasParallelFrame** parallelFrame) override;
+    };
+}}}}
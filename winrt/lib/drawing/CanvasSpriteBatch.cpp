@@ -669,6 +669,22 @@ IFACEMETHODIMP CanvasSpriteBatch::ConvertDipsToPixels(
 }
 
 
+void CanvasSpriteBatch::DrawD2DBitmap(
+    ComPtr<ID2D1Bitmap> bitmap,
+    D2D1_RECT_F const& destRect,
+    D2D1_RECT_U const& sourceRect,
+    Vector4 const& tint)
+{
+    EnsureNotClosed();
+
+    m_sprites.emplace_back(
+        std::move(bitmap),
+        destRect,
+        sourceRect,
+        tint);
+}
+
+
 void CanvasSpriteBatch::EnsureNotClosed()
 {
     m_deviceContext.EnsureNotClosed();
@@ -212,6 +212,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasDpiRounding dpiRounding,
             int32_t* pixels) override;
 
+        //
+        // Internal: adds a sprite for a bitmap that has no CanvasBitmap
+        // wrapper, eg. a CanvasTextCache page.
+        //
+
+        void DrawD2DBitmap(
+            ComPtr<ID2D1Bitmap> bitmap,
+            D2D1_RECT_F const& destRect,
+            D2D1_RECT_U const& sourceRect,
+            Vector4 const& tint);
+
     private:
         void EnsureNotClosed();
     };
@@ -80,6 +80,29 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         int32_t bufferCount,
         CanvasAlphaMode alphaMode,
         ICanvasSwapChain** swapChain)
+    {
+        return CreateWithOptions(
+            resourceCreator,
+            width,
+            height,
+            dpi,
+            format,
+            bufferCount,
+            alphaMode,
+            CanvasSwapChainOptions::None,
+            swapChain);
+    }
+
+    IFACEMETHODIMP CanvasSwapChainFactory::CreateWithOptions(
+        ICanvasResourceCreator* resourceCreator,
+        float width,
+        float height,
+        float dpi,
+        DirectXPixelFormat format,
+        int32_t bufferCount,
+        CanvasAlphaMode alphaMode,
+        CanvasSwapChainOptions options,
+        ICanvasSwapChain** swapChain)
     {
         return ExceptionBoundary(
             [&]
@@ -97,7 +120,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                     dpi,
                     format,
                     bufferCount,
-                    alphaMode);
+                    alphaMode,
+                    options);
 
                 ThrowIfFailed(newCanvasSwapChain.CopyTo(swapChain));
             });
@@ -268,6 +292,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         , m_dpi(dpi)
         , m_adapter(CanvasSwapChainAdapter::GetInstance())
         , m_hasActiveDrawingSession(std::make_shared<bool>())
+        , m_hasFetchedFrameLatencyWaitableObject(false)
     {
     }
 
@@ -553,8 +578,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto lock = GetResourceLock();
                 auto& resource = GetResource();
 
+                // Tearing is only allowed when not waiting for the vertical
+                // blank, so the swap chain's flags only need looking at then.
+                UINT presentFlags = 0;
+                if (syncInterval == 0 && (GetSwapChainDesc(lock).Flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING))
+                    presentFlags |= DXGI_PRESENT_ALLOW_TEARING;
+
                 DXGI_PRESENT_PARAMETERS presentParameters = { 0 };
-                ThrowIfFailed(resource->Present1(syncInterval, 0, &presentParameters));
+                ThrowIfFailed(resource->Present1(syncInterval, presentFlags, &presentParameters));
             });
     }
 
@@ -582,7 +613,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                     newHeight,
                     m_dpi,
                     static_cast<DirectXPixelFormat>(desc.Format),
-                    desc.BufferCount);
+                    desc.BufferCount,
+                    desc.Flags);
             });
     }
 
@@ -603,7 +635,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                     newHeight,
                     newDpi,
                     static_cast<DirectXPixelFormat>(desc.Format),
-                    desc.BufferCount);
+                    desc.BufferCount,
+                    desc.Flags);
             });
     }
 
@@ -618,13 +651,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             [&]
             {
                 auto lock = GetResourceLock();
+                auto desc = GetSwapChainDesc(lock);
+
                 ResizeBuffersImpl(
                     lock,
                     newWidth,
                     newHeight,
                     newDpi,
                     newFormat,
-                    bufferCount);
+                    bufferCount,
+                    desc.Flags);
             });
     }
     
@@ -634,7 +670,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float newHeight,
         float newDpi,
         DirectXPixelFormat newFormat,
-        int32_t bufferCount)
+        int32_t bufferCount,
+        UINT swapChainFlags)
     {            
         auto swapChain = As<IDXGISwapChain2>(GetResource());
 
@@ -645,12 +682,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ThrowIfNegative(widthInPixels);
         ThrowIfNegative(heightInPixels);
 
+        // DXGI can't resize the buffers while anything still refers to them.
+        m_targetBitmap.Reset();
+
         ThrowIfFailed(swapChain->ResizeBuffers(
             bufferCount, 
             widthInPixels,
             heightInPixels,
             static_cast<DXGI_FORMAT>(newFormat), 
-            0));
+            swapChainFlags));
 
         if (!m_isTransformMatrixSupported)
         {
@@ -674,6 +714,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         if (FAILED(hr))
             return hr;
 
+        m_targetBitmap.Reset();
+        m_drawingSessionDeviceContext.Reset();
+        std::atomic_store(&m_frameLatencyWaitableObject, std::shared_ptr<Wrappers::Event>());
         m_device.Close();
         return S_OK;
     }
@@ -703,48 +746,71 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         auto& resource = GetResource();
 
-        DXGI_SWAP_CHAIN_DESC1 swapChainDesc;
+        DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
         ThrowIfFailed(resource->GetDesc1(&swapChainDesc));
 
         return swapChainDesc;
     }
 
+    ComPtr<ID2D1DeviceContext1> CanvasSwapChain::GetDrawingSessionDeviceContext(
+        D2DResourceLock const&,
+        ICanvasDevice* device)
+    {
+        if (!m_drawingSessionDeviceContext)
+        {
+            m_drawingSessionDeviceContext = As<ICanvasDeviceInternal>(device)->CreateDeviceContextForDrawingSession();
+        }
+        else
+        {
+            // Don't let state set by the previous drawing session leak into
+            // this one.
+            DeviceContextPool::ResetDeviceContextState(m_drawingSessionDeviceContext.Get());
+        }
+
+        return m_drawingSessionDeviceContext;
+    }
+
+    ComPtr<ID2D1Bitmap1> CanvasSwapChain::GetTargetBitmap(
+        D2DResourceLock const& lock,
+        ID2D1DeviceContext1* deviceContext)
+    {
+        if (m_targetBitmap)
+            return m_targetBitmap;
+
+        auto swapChainDescription = GetSwapChainDesc(lock);
+
+        ComPtr<IDXGISurface2> backBufferSurface;
+        ThrowIfFailed(GetResource()->GetBuffer(0, IID_PPV_ARGS(&backBufferSurface)));
+
+        ComPtr<ID2D1Bitmap1> d2dTargetBitmap;
+        D2D1_BITMAP_PROPERTIES1 bitmapProperties = D2D1::BitmapProperties1();
+        bitmapProperties.bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW;
+        bitmapProperties.pixelFormat.format = swapChainDescription.Format;
+        bitmapProperties.pixelFormat.alphaMode = ConvertDxgiAlphaModeToD2DAlphaMode(swapChainDescription.AlphaMode);
+        ThrowIfFailed(deviceContext->CreateBitmapFromDxgiSurface(backBufferSurface.Get(), &bitmapProperties, &d2dTargetBitmap));
+
+        m_targetBitmap = d2dTargetBitmap;
+        return d2dTargetBitmap;
+    }
+
     class CanvasSwapChainDrawingSessionAdapter : public ICanvasDrawingSessionAdapter,
                                                  private LifespanTracker<CanvasSwapChainDrawingSessionAdapter>
     {
     public:
         static std::shared_ptr<CanvasSwapChainDrawingSessionAdapter> Create(
-            ICanvasDevice* owner,
-            IDXGISwapChain1* swapChainResource,
+            ID2D1DeviceContext1* deviceContext,
+            ID2D1Bitmap1* targetBitmap,
             D2D1_COLOR_F const& clearColor,
-            float dpi,
-            ID2D1DeviceContext1** outDeviceContext)
+            float dpi)
         {
-            auto deviceContext = As<ICanvasDeviceInternal>(owner)->CreateDeviceContextForDrawingSession();
-
-            DXGI_SWAP_CHAIN_DESC1 swapChainDescription;
-            ThrowIfFailed(swapChainResource->GetDesc1(&swapChainDescription));
-
-            ComPtr<IDXGISurface2> backBufferSurface;
-            ThrowIfFailed(swapChainResource->GetBuffer(0, IID_PPV_ARGS(&backBufferSurface)));
-
-            ComPtr<ID2D1Bitmap1> d2dTargetBitmap;
-            D2D1_BITMAP_PROPERTIES1 bitmapProperties = D2D1::BitmapProperties1();
-            bitmapProperties.bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW;
-            bitmapProperties.pixelFormat.format = swapChainDescription.Format;
-            bitmapProperties.pixelFormat.alphaMode = ConvertDxgiAlphaModeToD2DAlphaMode(swapChainDescription.AlphaMode);
-            ThrowIfFailed(deviceContext->CreateBitmapFromDxgiSurface(backBufferSurface.Get(), &bitmapProperties, &d2dTargetBitmap));
-
-            deviceContext->SetTarget(d2dTargetBitmap.Get());
+            deviceContext->SetTarget(targetBitmap);
 
             deviceContext->BeginDraw();
 
             //
             // If this function fails then we need to call EndDraw
             //
-            auto endDrawWarden = MakeScopeWarden([&] { ThrowIfFailed(deviceContext->EndDraw()); });
-
-            ThrowIfFailed(deviceContext.CopyTo(outDeviceContext));
+            auto endDrawWarden = MakeScopeWarden([&] { EndDrawAndReleaseTarget(deviceContext); });
 
             auto adapter = std::make_shared<CanvasSwapChainDrawingSessionAdapter>();
 
@@ -766,6 +832,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual void EndDraw(ID2D1DeviceContext1* deviceContext) override
         {
+            EndDrawAndReleaseTarget(deviceContext);
+        }
+
+    private:
+        //
+        // The swap chain holds on to the device context between drawing
+        // sessions.  Clearing its target leaves the swap chain's own target
+        // bitmap as the only reference to the back buffer, which
+        // ResizeBuffers releases before resizing.
+        //
+        static void EndDrawAndReleaseTarget(ID2D1DeviceContext1* deviceContext)
+        {
+            auto releaseTargetWarden = MakeScopeWarden([&] { deviceContext->SetTarget(nullptr); });
             ThrowIfFailed(deviceContext->EndDraw());
         }
     };
@@ -778,7 +857,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             [&]
             {            
                 CheckAndClearOutPointer(drawingSession);
-                auto& dxgiSwapChain = GetResource();
+                GetResource();  // this ensures that Close() hasn't been called
                 auto& device = m_device.EnsureNotClosed();
 
                 if (*m_hasActiveDrawingSession)
@@ -787,13 +866,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto d2dDevice = As<ICanvasDeviceInternal>(device)->GetD2DDevice();
                 D2DResourceLock lock(d2dDevice.Get());
 
-                ComPtr<ID2D1DeviceContext1> deviceContext;
+                auto deviceContext = GetDrawingSessionDeviceContext(lock, device.Get());
+                auto targetBitmap = GetTargetBitmap(lock, deviceContext.Get());
+
                 auto adapter = CanvasSwapChainDrawingSessionAdapter::Create(
-                    device.Get(),
-                    dxgiSwapChain.Get(),
+                    deviceContext.Get(),
+                    targetBitmap.Get(),
                     ToD2DColor(clearColor),
-                    m_dpi,
-                    &deviceContext);
+                    m_dpi);
                 
                 auto newDrawingSession = CanvasDrawingSession::CreateNew(deviceContext.Get(), adapter, device.Get(), m_hasActiveDrawingSession);
 
@@ -829,6 +909,110 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             });
     }
 
+    IFACEMETHODIMP CanvasSwapChain::get_Options(CanvasSwapChainOptions* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+
+                auto lock = GetResourceLock();
+                auto desc = GetSwapChainDesc(lock);
+
+                auto options = CanvasSwapChainOptions::None;
+
+                if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT)
+                    options |= CanvasSwapChainOptions::LowLatency;
+
+                if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING)
+                    options |= CanvasSwapChainOptions::AllowTearing;
+
+                *value = options;
+            });
+    }
+
+    IFACEMETHODIMP CanvasSwapChain::get_MaximumFrameLatency(int32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+
+                auto lock = GetResourceLock();
+                auto swapChain = As<IDXGISwapChain2>(GetResource());
+
+                UINT maximumFrameLatency;
+                ThrowIfFailed(swapChain->GetMaximumFrameLatency(&maximumFrameLatency));
+
+                *value = static_cast<int32_t>(maximumFrameLatency);
+            });
+    }
+
+    IFACEMETHODIMP CanvasSwapChain::put_MaximumFrameLatency(int32_t value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                if (value < 1 || value > DXGI_MAX_SWAP_CHAIN_BUFFERS)
+                    ThrowHR(E_INVALIDARG);
+
+                auto lock = GetResourceLock();
+                auto swapChain = As<IDXGISwapChain2>(GetResource());
+
+                ThrowIfFailed(swapChain->SetMaximumFrameLatency(static_cast<UINT>(value)));
+            });
+    }
+
+    IFACEMETHODIMP CanvasSwapChain::WaitForNextFrame()
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                std::shared_ptr<Wrappers::Event> waitableObject;
+                {
+                    auto lock = GetResourceLock();
+                    waitableObject = GetFrameLatencyWaitableObject(lock);
+                }
+
+                if (!waitableObject)
+                {
+                    ThrowIfFailed(WaitForVerticalBlank());
+                    return;
+                }
+
+                // The lock isn't held while waiting, since other threads may
+                // need it to finish the frame being waited for; holding our
+                // own reference keeps the handle open if they Close us.
+                // Timing out just means that the frame is late, so isn't an
+                // error.
+                if (m_adapter->WaitForSingleObject(waitableObject->Get(), FrameLatencyWaitTimeoutInMs) == WAIT_FAILED)
+                    ThrowHR(HRESULT_FROM_WIN32(GetLastError()));
+            });
+    }
+
+    bool CanvasSwapChain::HasFrameLatencyWaitableObject()
+    {
+        auto lock = GetResourceLock();
+        return GetFrameLatencyWaitableObject(lock) != nullptr;
+    }
+
+    std::shared_ptr<Wrappers::Event> CanvasSwapChain::GetFrameLatencyWaitableObject(D2DResourceLock const&)
+    {
+        if (!m_hasFetchedFrameLatencyWaitableObject)
+        {
+            auto swapChain = MaybeAs<IDXGISwapChain2>(GetResource());
+            if (swapChain)
+            {
+                if (auto handle = swapChain->GetFrameLatencyWaitableObject())
+                    std::atomic_store(&m_frameLatencyWaitableObject, std::make_shared<Wrappers::Event>(handle));
+            }
+
+            m_hasFetchedFrameLatencyWaitableObject = true;
+        }
+
+        return std::atomic_load(&m_frameLatencyWaitableObject);
+    }
+
     ComPtr<CanvasSwapChain> CanvasSwapChain::CreateNew(
         ICanvasDevice* device,
         float width,
@@ -836,7 +1020,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float dpi,
         DirectXPixelFormat format,
         int32_t bufferCount,
-        CanvasAlphaMode alphaMode)
+        CanvasAlphaMode alphaMode,
+        CanvasSwapChainOptions options)
     {
         auto deviceInternal = As<ICanvasDeviceInternal>(device);
 
@@ -848,7 +1033,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             heightInPixels,
             format,
             bufferCount,
-            alphaMode);
+            alphaMode,
+            options);
 
         auto canvasSwapChain = Make<CanvasSwapChain>(
             device,
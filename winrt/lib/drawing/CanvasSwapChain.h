@@ -52,6 +52,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             CanvasAlphaMode alphaMode,
             ICanvasSwapChain** swapChain) override;
 
+        IFACEMETHOD(CreateWithOptions)(
+            ICanvasResourceCreator* resourceCreator,
+            float width,
+            float height,
+            float dpi,
+            DirectXPixelFormat format,
+            int32_t bufferCount,
+            CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options,
+            ICanvasSwapChain** swapChain) override;
+
         //
         // ICanvasSwapChainStatics
         //
@@ -113,6 +124,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         virtual ~CanvasSwapChainAdapter() = default;
 
         virtual void Sleep(DWORD timeInMs) = 0;
+
+        virtual DWORD WaitForSingleObject(HANDLE handle, DWORD timeoutInMs) = 0;
     };
 
     class DefaultCanvasSwapChainAdapter : public CanvasSwapChainAdapter
@@ -122,6 +135,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         {
             ::Sleep(timeInMs);
         }
+
+        virtual DWORD WaitForSingleObject(HANDLE handle, DWORD timeoutInMs) override
+        {
+            return ::WaitForSingleObjectEx(handle, timeoutInMs, TRUE);
+        }
     };
 
 
@@ -146,12 +164,35 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         std::shared_ptr<CanvasSwapChainAdapter> m_adapter;
         std::shared_ptr<bool> m_hasActiveDrawingSession;
 
+        // Drawing sessions reuse the same device context, and the same
+        // bitmap wrapping buffer 0, from one frame to the next.  Buffer 0
+        // is always the current back buffer, so the bitmap stays valid
+        // until the buffers are resized.  The context's target is cleared
+        // when each session ends; the bitmap is released by ResizeBuffers
+        // and Close.
+        ComPtr<ID2D1DeviceContext1> m_drawingSessionDeviceContext;
+        ComPtr<ID2D1Bitmap1> m_targetBitmap;
+
+        // The frame latency waitable object is fetched from the DXGI swap
+        // chain the first time it is needed, and is null for swap chains
+        // that weren't created with DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT.
+        // It is shared, and only read and written with the std::atomic_*
+        // functions, so that Close can't close the handle while
+        // WaitForNextFrame is waiting on it.
+        bool m_hasFetchedFrameLatencyWaitableObject;
+        std::shared_ptr<Wrappers::Event> m_frameLatencyWaitableObject;
+
     public:
         static DirectXPixelFormat const DefaultPixelFormat = PIXEL_FORMAT(B8G8R8A8UIntNormalized);
         static int32_t const DefaultBufferCount = 2;
         static CanvasAlphaMode const DefaultCompositionAlphaMode = CanvasAlphaMode::Premultiplied;
         static CanvasAlphaMode const DefaultCoreWindowAlphaMode = CanvasAlphaMode::Ignore;
 
+        // Bounds how long WaitForNextFrame blocks, so that a swap chain that
+        // stops presenting (eg. because it was removed from the visual tree)
+        // can't hang the caller.
+        static DWORD const FrameLatencyWaitTimeoutInMs = 1000;
+
         static ComPtr<CanvasSwapChain> CreateNew(
             ICanvasDevice* device,
             float width,
@@ -159,7 +200,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             float dpi,
             DirectXPixelFormat format,
             int32_t bufferCount,
-            CanvasAlphaMode alphaMode);
+            CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options = CanvasSwapChainOptions::None);
 
         static ComPtr<CanvasSwapChain> CreateNew(
             ICanvasDevice* device,
@@ -244,6 +286,17 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         IFACEMETHOD(WaitForVerticalBlank)() override;
 
+        IFACEMETHOD(get_Options)(CanvasSwapChainOptions* value) override;
+
+        IFACEMETHOD(get_MaximumFrameLatency)(int32_t* value) override;
+        IFACEMETHOD(put_MaximumFrameLatency)(int32_t value) override;
+
+        IFACEMETHOD(WaitForNextFrame)() override;
+
+        // True if WaitForNextFrame waits on a frame latency waitable object,
+        // rather than for the vertical blank.
+        bool HasFrameLatencyWaitableObject();
+
         // IClosable
         IFACEMETHOD(Close)() override;
 
@@ -261,13 +314,24 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ComPtr<IDXGISwapChain2> const& resource, 
             DXGI_MATRIX_3X2_F* transform);
 
+        ComPtr<ID2D1DeviceContext1> GetDrawingSessionDeviceContext(
+            D2DResourceLock const& lock,
+            ICanvasDevice* device);
+
+        ComPtr<ID2D1Bitmap1> GetTargetBitmap(
+            D2DResourceLock const& lock,
+            ID2D1DeviceContext1* deviceContext);
+
+        std::shared_ptr<Wrappers::Event> GetFrameLatencyWaitableObject(D2DResourceLock const& lock);
+
         void ResizeBuffersImpl(
             D2DResourceLock const& lock,
             float newWidth,
             float newHeight,
             float newDpi,
             DirectXPixelFormat newFormat,
-            int32_t bufferCount);
+            int32_t bufferCount,
+            UINT swapChainFlags);
     };
 
 }}}}
@@ -12,8 +12,11 @@
 //
 
 
-DeviceContextPool::DeviceContextPool(ID2D1Device1* d2dDevice)
+DeviceContextPool::DeviceContextPool(ID2D1Device1* d2dDevice, bool resetStateOnReturn, IUnknown* container)
     : m_d2dDevice(d2dDevice)
+    , m_resetStateOnReturn(resetStateOnReturn)
+    , m_container(container)
+    , m_statistics{}
 {
 }
 
@@ -24,6 +27,8 @@ DeviceContextLease DeviceContextPool::TakeLease()
 
     if (!m_d2dDevice)
         ThrowHR(RO_E_CLOSED);
+
+    m_statistics.LeasesTaken++;
     
     if (m_deviceContexts.empty())
     {
@@ -31,6 +36,7 @@ DeviceContextLease DeviceContextPool::TakeLease()
         ThrowIfFailed(m_d2dDevice->CreateDeviceContext(
             D2D1_DEVICE_CONTEXT_OPTIONS_NONE,
             &deviceContext));
+        m_statistics.ContextsCreated++;
         return DeviceContextLease(this, std::move(deviceContext));
     }
     else
@@ -46,6 +52,13 @@ void DeviceContextPool::ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext)
 {
     if (!deviceContext)
         return;
+
+    //
+    // Resetting is done outside the lock, since the context is not visible
+    // to any other thread until it has been added back to the pool.
+    //
+    if (m_resetStateOnReturn)
+        ResetDeviceContextState(deviceContext.Get());
         
     Lock lock(m_mutex);
 
@@ -69,6 +82,34 @@ void DeviceContextPool::ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext)
 
     if (m_deviceContexts.size() < maxPoolSize)
         m_deviceContexts.emplace_back(std::move(deviceContext));
+    else
+        m_statistics.ContextsDiscarded++;
+}
+
+
+void DeviceContextPool::ResetDeviceContextState(ID2D1DeviceContext1* deviceContext)
+{
+    //
+    // Restore everything that CanvasDrawingSession, or an app using interop
+    // on the drawing session's context, may have changed back to the values
+    // a newly created ID2D1DeviceContext would have.
+    //
+    deviceContext->SetTarget(nullptr);
+    deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+    deviceContext->SetUnitMode(D2D1_UNIT_MODE_DIPS);
+    deviceContext->SetDpi(DEFAULT_DPI, DEFAULT_DPI);
+    deviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
+    deviceContext->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_DEFAULT);
+    deviceContext->SetPrimitiveBlend(D2D1_PRIMITIVE_BLEND_SOURCE_OVER);
+    deviceContext->SetTextRenderingParams(nullptr);
+}
+
+
+DeviceContextPoolStatistics DeviceContextPool::GetStatistics()
+{
+    Lock lock(m_mutex);
+
+    return m_statistics;
 }
 
 
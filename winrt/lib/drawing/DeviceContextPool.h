@@ -11,15 +11,40 @@ using namespace ABI::Microsoft::Graphics::Canvas;
 
 class DeviceContextLease;
 
+//
+// Counters describing how effective a DeviceContextPool is at avoiding
+// device context creation.  The reuse rate is
+// (LeasesTaken - ContextsCreated) / LeasesTaken.
+//
+struct DeviceContextPoolStatistics
+{
+    uint64_t LeasesTaken;
+    uint64_t ContextsCreated;
+    uint64_t ContextsDiscarded;
+};
+
 class DeviceContextPool
 {
     ID2D1Device1* m_d2dDevice;
+    bool const m_resetStateOnReturn;
+    IUnknown* const m_container;
 
     std::mutex m_mutex;
     std::vector<ComPtr<ID2D1DeviceContext1>> m_deviceContexts;
+    DeviceContextPoolStatistics m_statistics;
     
 public:
-    DeviceContextPool(ID2D1Device1* d2dDevice);
+    //
+    // Pools used for resource creation hand out contexts as-is.  Pools used
+    // for drawing sessions set resetStateOnReturn, so that any target,
+    // transform or rendering state set by the previous drawing session does
+    // not leak into the next one.
+    //
+    // container is the object that owns the pool, if any.  Each lease holds
+    // a reference to it, so that the pool is still there when the lease is
+    // returned, however long the lease is kept.
+    //
+    DeviceContextPool(ID2D1Device1* d2dDevice, bool resetStateOnReturn = false, IUnknown* container = nullptr);
 
     DeviceContextPool(DeviceContextPool const&) = delete;
     DeviceContextPool& operator=(DeviceContextPool const&) = delete;
@@ -28,6 +53,10 @@ public:
 
     void Close();
 
+    DeviceContextPoolStatistics GetStatistics();
+
+    static void ResetDeviceContextState(ID2D1DeviceContext1* deviceContext);
+
 private:
     void ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext);
 
@@ -38,6 +67,7 @@ private:
 class DeviceContextLease
 {
     DeviceContextPool* m_owner;
+    ComPtr<IUnknown> m_ownerContainer;
     ComPtr<ID2D1DeviceContext1> m_deviceContext;
     
 public:
@@ -54,15 +84,19 @@ public:
 
     DeviceContextLease(DeviceContextLease&& other)
         : m_owner(other.m_owner)
+        , m_ownerContainer(std::move(other.m_ownerContainer))
         , m_deviceContext(std::move(other.m_deviceContext))
     {
+        other.m_owner = nullptr;
     }
     
     DeviceContextLease& operator=(DeviceContextLease&& other)
     {
         ReturnLease();
         m_owner = other.m_owner;
+        m_ownerContainer = std::move(other.m_ownerContainer);
         m_deviceContext = std::move(other.m_deviceContext);
+        other.m_owner = nullptr;
         return *this;
     }
 
@@ -87,6 +121,7 @@ public:
 private:
     DeviceContextLease(DeviceContextPool* owner, ComPtr<ID2D1DeviceContext1>&& deviceContext)
         : m_owner(owner)
+        , m_ownerContainer(owner->m_container)
         , m_deviceContext(std::move(deviceContext))
     {
         assert(m_owner);
@@ -98,6 +133,9 @@ private:
         {
             m_owner->ReturnLease(std::move(m_deviceContext));
             m_owner = nullptr;
+
+            // Only now may the pool be destroyed.
+            m_ownerContainer.Reset();
         }
         else
         {
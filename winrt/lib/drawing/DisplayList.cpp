@@ -0,0 +1,1379 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "DisplayList.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // DisplayListArena
+    //
+
+    DisplayListArena::DisplayListArena()
+        : m_blockOffset(BlockSize)
+        , m_bytesAllocated(0)
+    {
+    }
+
+
+    void* DisplayListArena::Allocate(size_t size, size_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        m_bytesAllocated += size;
+
+        //
+        // Large allocations (eg. long glyph runs) get a block of their own.
+        // This is inserted before the current block so that any space left
+        // in that block can still be used.
+        //
+        if (size > BlockSize / 4)
+        {
+            auto block = std::make_unique<uint8_t[]>(size);
+            auto result = block.get();
+
+            auto insertAt = m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1;
+            m_blocks.insert(insertAt, std::move(block));
+
+            return result;
+        }
+
+        auto offset = (m_blockOffset + alignment - 1) & ~(alignment - 1);
+
+        if (offset + size > BlockSize)
+        {
+            m_blocks.push_back(std::make_unique<uint8_t[]>(BlockSize));
+            offset = 0;
+        }
+
+        m_blockOffset = offset + size;
+
+        return m_blocks.back().get() + offset;
+    }
+
+
+    //
+    // DisplayListState
+    //
+
+    DisplayListState DisplayListState::Default()
+    {
+        return DisplayListState
+        {
+            D2D1::Matrix3x2F::Identity(),
+            D2D1_ANTIALIAS_MODE_PER_PRIMITIVE,
+            D2D1_TEXT_ANTIALIAS_MODE_DEFAULT,
+            D2D1_PRIMITIVE_BLEND_SOURCE_OVER,
+            D2D1_UNIT_MODE_DIPS,
+            0
+        };
+    }
+
+
+    static bool IsSameTransform(D2D1_MATRIX_3X2_F const& a, D2D1_MATRIX_3X2_F const& b)
+    {
+        return a._11 == b._11 && a._12 == b._12 &&
+               a._21 == b._21 && a._22 == b._22 &&
+               a._31 == b._31 && a._32 == b._32;
+    }
+
+
+    bool DisplayListState::operator==(DisplayListState const& other) const
+    {
+        return IsSameTransform(Transform, other.Transform) &&
+               AntialiasMode == other.AntialiasMode &&
+               TextAntialiasMode == other.TextAntialiasMode &&
+               PrimitiveBlend == other.PrimitiveBlend &&
+               UnitMode == other.UnitMode &&
+               TextRenderingParams == other.TextRenderingParams;
+    }
+
+
+    //
+    // DisplayList
+    //
+
+    DisplayList::DisplayList()
+    {
+        m_resources.emplace_back();
+        m_resourceIids.emplace_back(IID_IUnknown);
+    }
+
+
+    std::shared_ptr<DisplayList> DisplayList::Record(
+        ID2D1CommandList* commandList,
+        ID2D1DeviceContext* boundsDeviceContext)
+    {
+        auto recorder = Make<DisplayListRecorder>(boundsDeviceContext);
+        CheckMakeResult(recorder);
+
+        ThrowIfFailed(commandList->Stream(recorder.Get()));
+
+        return recorder->Close();
+    }
+
+
+    uint32_t DisplayList::AddResource(IUnknown* resource, IID const& iid)
+    {
+        if (!resource)
+            return 0;
+
+        auto it = m_resourceIndices.find(resource);
+
+        if (it != m_resourceIndices.end() && m_resourceIids[it->second] == iid)
+            return it->second;
+
+        auto index = static_cast<uint32_t>(m_resources.size());
+
+        m_resources.emplace_back(resource);
+        m_resourceIids.emplace_back(iid);
+        m_resourceIndices[resource] = index;
+
+        return index;
+    }
+
+
+    static bool IsPush(DisplayListCommandType type)
+    {
+        return type == DisplayListCommandType::PushAxisAlignedClip ||
+               type == DisplayListCommandType::PushLayer;
+    }
+
+
+    static bool IsPop(DisplayListCommandType type)
+    {
+        return type == DisplayListCommandType::PopAxisAlignedClip ||
+               type == DisplayListCommandType::PopLayer;
+    }
+
+
+    D2D1_RECT_F DisplayList::GetBounds() const
+    {
+        bool hasBounds = false;
+        D2D1_RECT_F bounds{};
+
+        for (auto& command : m_commands)
+        {
+            if (IsPush(command.Type) || IsPop(command.Type))
+                continue;
+
+            bounds = hasBounds ? RectangleUnion(bounds, command.Bounds) : command.Bounds;
+            hasBounds = true;
+        }
+
+        return bounds;
+    }
+
+
+    size_t DisplayList::GetMemoryUsage() const
+    {
+        return m_arena.GetBytesAllocated() +
+               m_commands.capacity() * sizeof(DisplayListCommand) +
+               m_states.capacity() * sizeof(DisplayListState) +
+               m_resources.capacity() * (sizeof(ComPtr<IUnknown>) + sizeof(IID));
+    }
+
+
+    DisplayListReplayStatistics DisplayList::Replay(
+        ID2D1DeviceContext1* deviceContext,
+        D2D1_MATRIX_3X2_F const& transform,
+        D2D1_RECT_F const* viewport) const
+    {
+        DisplayListReplayStatistics statistics{};
+
+        //
+        // Replaying changes the device context's state, so capture what it
+        // was and put it back afterwards.
+        //
+        D2D1_MATRIX_3X2_F previousTransform;
+        deviceContext->GetTransform(&previousTransform);
+
+        auto previousAntialiasMode = deviceContext->GetAntialiasMode();
+        auto previousTextAntialiasMode = deviceContext->GetTextAntialiasMode();
+        auto previousPrimitiveBlend = deviceContext->GetPrimitiveBlend();
+        auto previousUnitMode = deviceContext->GetUnitMode();
+
+        ComPtr<IDWriteRenderingParams> previousTextRenderingParams;
+        deviceContext->GetTextRenderingParams(&previousTextRenderingParams);
+
+        auto restoreState = MakeScopeWarden(
+            [&]
+            {
+                deviceContext->SetTransform(&previousTransform);
+                deviceContext->SetAntialiasMode(previousAntialiasMode);
+                deviceContext->SetTextAntialiasMode(previousTextAntialiasMode);
+                deviceContext->SetPrimitiveBlend(previousPrimitiveBlend);
+                deviceContext->SetUnitMode(previousUnitMode);
+                deviceContext->SetTextRenderingParams(previousTextRenderingParams.Get());
+            });
+
+        DisplayListState const* appliedState = nullptr;
+        uint32_t appliedStateIndex = 0;
+
+        // Non-zero while skipping a clip or layer scope that is entirely outside the viewport.
+        int culledScopeDepth = 0;
+
+        for (auto& command : m_commands)
+        {
+            bool isPush = IsPush(command.Type);
+            bool isPop = IsPop(command.Type);
+
+            if (culledScopeDepth > 0)
+            {
+                if (isPush)
+                    culledScopeDepth++;
+                else if (isPop)
+                    culledScopeDepth--;
+
+                statistics.CommandsCulled++;
+                continue;
+            }
+
+            if (viewport && !isPop && !IsInfiniteRectangle(command.Bounds))
+            {
+                auto bounds = TransformRectangle(command.Bounds, transform);
+
+                if (!RectanglesIntersect(bounds, *viewport))
+                {
+                    if (isPush)
+                        culledScopeDepth = 1;
+
+                    statistics.CommandsCulled++;
+                    continue;
+                }
+            }
+
+            //
+            // State is only applied when a command that depends on it is
+            // actually replayed.  State changes for culled commands therefore
+            // never reach the device context.
+            //
+            if (!isPop && (!appliedState || command.StateIndex != appliedStateIndex))
+            {
+                auto& state = m_states[command.StateIndex];
+
+                ApplyState(deviceContext, state, appliedState, transform);
+
+                appliedState = &state;
+                appliedStateIndex = command.StateIndex;
+                statistics.StateChanges++;
+            }
+
+            ReplayCommand(deviceContext, command);
+            statistics.CommandsReplayed++;
+        }
+
+        return statistics;
+    }
+
+
+    void DisplayList::ApplyState(
+        ID2D1DeviceContext1* deviceContext,
+        DisplayListState const& state,
+        DisplayListState const* previousState,
+        D2D1_MATRIX_3X2_F const& transform) const
+    {
+        if (!previousState || !IsSameTransform(state.Transform, previousState->Transform))
+        {
+            auto combinedTransform =
+                *D2D1::Matrix3x2F::ReinterpretBaseType(&state.Transform) *
+                *D2D1::Matrix3x2F::ReinterpretBaseType(&transform);
+
+            deviceContext->SetTransform(&combinedTransform);
+        }
+
+        if (!previousState || state.AntialiasMode != previousState->AntialiasMode)
+            deviceContext->SetAntialiasMode(state.AntialiasMode);
+
+        if (!previousState || state.TextAntialiasMode != previousState->TextAntialiasMode)
+            deviceContext->SetTextAntialiasMode(state.TextAntialiasMode);
+
+        if (!previousState || state.PrimitiveBlend != previousState->PrimitiveBlend)
+            deviceContext->SetPrimitiveBlend(state.PrimitiveBlend);
+
+        if (!previousState || state.UnitMode != previousState->UnitMode)
+            deviceContext->SetUnitMode(state.UnitMode);
+
+        if (!previousState || state.TextRenderingParams != previousState->TextRenderingParams)
+            deviceContext->SetTextRenderingParams(GetResourceAs<IDWriteRenderingParams>(state.TextRenderingParams));
+    }
+
+
+    template<typename TPayload>
+    static TPayload const& PayloadAs(DisplayListCommand const& command)
+    {
+        return *static_cast<TPayload const*>(command.Payload);
+    }
+
+
+    void DisplayList::ReplayCommand(ID2D1DeviceContext1* deviceContext, DisplayListCommand const& command) const
+    {
+        using namespace DisplayListPayloads;
+
+        switch (command.Type)
+        {
+        case DisplayListCommandType::Clear:
+            deviceContext->Clear(PayloadAs<Clear>(command).Color);
+            break;
+
+        case DisplayListCommandType::DrawGlyphRun:
+            {
+                auto& payload = PayloadAs<DrawGlyphRun>(command);
+
+                DWRITE_GLYPH_RUN glyphRun
+                {
+                    GetResourceAs<IDWriteFontFace>(payload.FontFace),
+                    payload.FontEmSize,
+                    payload.GlyphCount,
+                    payload.GlyphIndices,
+                    payload.GlyphAdvances,
+                    payload.GlyphOffsets,
+                    payload.IsSideways,
+                    payload.BidiLevel
+                };
+
+                DWRITE_GLYPH_RUN_DESCRIPTION description
+                {
+                    payload.LocaleName,
+                    payload.String,
+                    payload.StringLength,
+                    payload.ClusterMap,
+                    payload.TextPosition
+                };
+
+                deviceContext->DrawGlyphRun(
+                    payload.BaselineOrigin,
+                    &glyphRun,
+                    payload.HasDescription ? &description : nullptr,
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    payload.MeasuringMode);
+            }
+            break;
+
+        case DisplayListCommandType::DrawLine:
+            {
+                auto& payload = PayloadAs<DrawLine>(command);
+                deviceContext->DrawLine(
+                    payload.Point0,
+                    payload.Point1,
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    payload.StrokeWidth,
+                    GetResourceAs<ID2D1StrokeStyle>(payload.StrokeStyle));
+            }
+            break;
+
+        case DisplayListCommandType::DrawGeometry:
+            {
+                auto& payload = PayloadAs<DrawGeometry>(command);
+                deviceContext->DrawGeometry(
+                    GetResourceAs<ID2D1Geometry>(payload.Geometry),
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    payload.StrokeWidth,
+                    GetResourceAs<ID2D1StrokeStyle>(payload.StrokeStyle));
+            }
+            break;
+
+        case DisplayListCommandType::DrawRectangle:
+            {
+                auto& payload = PayloadAs<DrawRectangle>(command);
+                deviceContext->DrawRectangle(
+                    &payload.Rect,
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    payload.StrokeWidth,
+                    GetResourceAs<ID2D1StrokeStyle>(payload.StrokeStyle));
+            }
+            break;
+
+        case DisplayListCommandType::DrawBitmap:
+            {
+                auto& payload = PayloadAs<DrawBitmap>(command);
+                deviceContext->DrawBitmap(
+                    GetResourceAs<ID2D1Bitmap>(payload.Bitmap),
+                    payload.DestinationRectangle,
+                    payload.Opacity,
+                    payload.InterpolationMode,
+                    payload.SourceRectangle,
+                    payload.PerspectiveTransform);
+            }
+            break;
+
+        case DisplayListCommandType::DrawImage:
+            {
+                auto& payload = PayloadAs<DrawImage>(command);
+                deviceContext->DrawImage(
+                    GetResourceAs<ID2D1Image>(payload.Image),
+                    payload.TargetOffset,
+                    payload.ImageRectangle,
+                    payload.InterpolationMode,
+                    payload.CompositeMode);
+            }
+            break;
+
+        case DisplayListCommandType::DrawGdiMetafile:
+            {
+                auto& payload = PayloadAs<DrawGdiMetafile>(command);
+                deviceContext->DrawGdiMetafile(
+                    GetResourceAs<ID2D1GdiMetafile>(payload.Metafile),
+                    payload.TargetOffset);
+            }
+            break;
+
+        case DisplayListCommandType::DrawGdiMetafileWithRectangles:
+            {
+                auto& payload = PayloadAs<DrawGdiMetafile>(command);
+                As<ID2D1DeviceContext2>(deviceContext)->DrawGdiMetafile(
+                    GetResourceAs<ID2D1GdiMetafile>(payload.Metafile),
+                    payload.DestinationRectangle,
+                    payload.SourceRectangle);
+            }
+            break;
+
+        case DisplayListCommandType::FillMesh:
+            {
+                auto& payload = PayloadAs<FillMesh>(command);
+                deviceContext->FillMesh(
+                    GetResourceAs<ID2D1Mesh>(payload.Mesh),
+                    GetResourceAs<ID2D1Brush>(payload.Brush));
+            }
+            break;
+
+        case DisplayListCommandType::FillOpacityMask:
+            {
+                auto& payload = PayloadAs<FillOpacityMask>(command);
+                deviceContext->FillOpacityMask(
+                    GetResourceAs<ID2D1Bitmap>(payload.OpacityMask),
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    payload.DestinationRectangle,
+                    payload.SourceRectangle);
+            }
+            break;
+
+        case DisplayListCommandType::FillGeometry:
+            {
+                auto& payload = PayloadAs<FillGeometry>(command);
+                deviceContext->FillGeometry(
+                    GetResourceAs<ID2D1Geometry>(payload.Geometry),
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    GetResourceAs<ID2D1Brush>(payload.OpacityBrush));
+            }
+            break;
+
+        case DisplayListCommandType::FillRectangle:
+            {
+                auto& payload = PayloadAs<FillRectangle>(command);
+                deviceContext->FillRectangle(
+                    &payload.Rect,
+                    GetResourceAs<ID2D1Brush>(payload.Brush));
+            }
+            break;
+
+        case DisplayListCommandType::PushAxisAlignedClip:
+            {
+                auto& payload = PayloadAs<PushAxisAlignedClip>(command);
+                deviceContext->PushAxisAlignedClip(&payload.ClipRect, payload.AntialiasMode);
+            }
+            break;
+
+        case DisplayListCommandType::PushLayer:
+            {
+                auto& payload = PayloadAs<PushLayer>(command);
+
+                D2D1_LAYER_PARAMETERS1 parameters
+                {
+                    payload.ContentBounds,
+                    GetResourceAs<ID2D1Geometry>(payload.GeometricMask),
+                    payload.MaskAntialiasMode,
+                    payload.MaskTransform,
+                    payload.Opacity,
+                    GetResourceAs<ID2D1Brush>(payload.OpacityBrush),
+                    payload.LayerOptions
+                };
+
+                deviceContext->PushLayer(&parameters, GetResourceAs<ID2D1Layer>(payload.Layer));
+            }
+            break;
+
+        case DisplayListCommandType::PopAxisAlignedClip:
+            deviceContext->PopAxisAlignedClip();
+            break;
+
+        case DisplayListCommandType::PopLayer:
+            deviceContext->PopLayer();
+            break;
+
+        case DisplayListCommandType::DrawInk:
+            {
+                auto& payload = PayloadAs<DrawInk>(command);
+                As<ID2D1DeviceContext2>(deviceContext)->DrawInk(
+                    GetResourceAs<ID2D1Ink>(payload.Ink),
+                    GetResourceAs<ID2D1Brush>(payload.Brush),
+                    GetResourceAs<ID2D1InkStyle>(payload.InkStyle));
+            }
+            break;
+
+        case DisplayListCommandType::DrawGradientMesh:
+            {
+                auto& payload = PayloadAs<DrawGradientMesh>(command);
+                As<ID2D1DeviceContext2>(deviceContext)->DrawGradientMesh(
+                    GetResourceAs<ID2D1GradientMesh>(payload.GradientMesh));
+            }
+            break;
+
+        case DisplayListCommandType::DrawSpriteBatch:
+            {
+                auto& payload = PayloadAs<DrawSpriteBatch>(command);
+                As<ID2D1DeviceContext3>(deviceContext)->DrawSpriteBatch(
+                    GetResourceAs<ID2D1SpriteBatch>(payload.SpriteBatch),
+                    payload.StartIndex,
+                    payload.SpriteCount,
+                    GetResourceAs<ID2D1Bitmap>(payload.Bitmap),
+                    payload.InterpolationMode,
+                    payload.SpriteOptions);
+            }
+            break;
+
+        default:
+            assert(false);
+            ThrowHR(E_UNEXPECTED);
+        }
+    }
+
+
+    void DisplayList::Retarget(
+        ID2D1DeviceContext* newDeviceContext,
+        DisplayListResourceMapper const& mapper)
+    {
+        //
+        // Build the new resource table separately so that the display list is
+        // left untouched if anything fails part way through.
+        //
+        std::vector<ComPtr<IUnknown>> newResources;
+        newResources.reserve(m_resources.size());
+
+        for (size_t i = 0; i < m_resources.size(); ++i)
+        {
+            auto& resource = m_resources[i];
+            auto& iid = m_resourceIids[i];
+
+            ComPtr<ID2D1Resource> d2dResource;
+
+            // DirectWrite objects such as font faces are device independent.
+            if (!resource || FAILED(resource.As(&d2dResource)))
+            {
+                newResources.push_back(resource);
+                continue;
+            }
+
+            ComPtr<IUnknown> replacement;
+
+            ComPtr<ID2D1SolidColorBrush> solidColorBrush;
+            if (SUCCEEDED(resource.As(&solidColorBrush)))
+            {
+                D2D1_MATRIX_3X2_F brushTransform;
+                solidColorBrush->GetTransform(&brushTransform);
+
+                ComPtr<ID2D1SolidColorBrush> newBrush;
+                ThrowIfFailed(newDeviceContext->CreateSolidColorBrush(
+                    solidColorBrush->GetColor(),
+                    D2D1::BrushProperties(solidColorBrush->GetOpacity(), brushTransform),
+                    &newBrush));
+
+                replacement = newBrush;
+            }
+            else if (mapper)
+            {
+                replacement = mapper(resource.Get());
+            }
+
+            if (!replacement)
+            {
+                newResources.push_back(resource);
+                continue;
+            }
+
+            // Store the replacement as the same interface the original was recorded as.
+            ComPtr<IUnknown> typedReplacement;
+            ThrowIfFailed(replacement->QueryInterface(iid, reinterpret_cast<void**>(typedReplacement.GetAddressOf())));
+
+            newResources.push_back(std::move(typedReplacement));
+        }
+
+        m_resources.swap(newResources);
+
+        m_resourceIndices.clear();
+        for (uint32_t i = 1; i < m_resources.size(); ++i)
+        {
+            m_resourceIndices[m_resources[i].Get()] = i;
+        }
+    }
+
+
+    //
+    // DisplayListRecorder
+    //
+
+    DisplayListRecorder::DisplayListRecorder(ID2D1DeviceContext* boundsDeviceContext)
+        : m_displayList(std::make_shared<DisplayList>())
+        , m_boundsDeviceContext(boundsDeviceContext)
+        , m_currentState(DisplayListState::Default())
+    {
+    }
+
+
+    std::shared_ptr<DisplayList> DisplayListRecorder::Close()
+    {
+        if (!m_displayList)
+            ThrowHR(RO_E_CLOSED);
+
+        return std::move(m_displayList);
+    }
+
+
+    DisplayList& DisplayListRecorder::GetDisplayList()
+    {
+        if (!m_displayList)
+            ThrowHR(RO_E_CLOSED);
+
+        return *m_displayList;
+    }
+
+
+    void DisplayListRecorder::AddCommand(DisplayListCommandType type, D2D1_RECT_F const& bounds, void const* payload)
+    {
+        auto& displayList = GetDisplayList();
+        auto& states = displayList.m_states;
+
+        if (states.empty() || states.back() != m_currentState)
+            states.push_back(m_currentState);
+
+        displayList.m_commands.push_back(DisplayListCommand
+            {
+                type,
+                static_cast<uint32_t>(states.size() - 1),
+                bounds,
+                payload
+            });
+    }
+
+
+    D2D1_RECT_F DisplayListRecorder::ToWorld(D2D1_RECT_F const& localBounds) const
+    {
+        return TransformRectangle(localBounds, m_currentState.Transform);
+    }
+
+
+    D2D1_RECT_F DisplayListRecorder::GetBitmapBounds(
+        ID2D1Bitmap* bitmap,
+        D2D1_RECT_F const* destinationRectangle,
+        D2D1_RECT_F const* sourceRectangle) const
+    {
+        if (destinationRectangle)
+            return ToWorld(*destinationRectangle);
+
+        if (sourceRectangle)
+            return ToWorld(D2D1_RECT_F{ 0, 0, sourceRectangle->right - sourceRectangle->left, sourceRectangle->bottom - sourceRectangle->top });
+
+        D2D1_SIZE_F size;
+
+        if (m_currentState.UnitMode == D2D1_UNIT_MODE_PIXELS)
+        {
+            auto pixelSize = bitmap->GetPixelSize();
+            size = D2D1_SIZE_F{ static_cast<float>(pixelSize.width), static_cast<float>(pixelSize.height) };
+        }
+        else
+        {
+            size = bitmap->GetSize();
+        }
+
+        return ToWorld(D2D1_RECT_F{ 0, 0, size.width, size.height });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::BeginDraw()
+    {
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::EndDraw()
+    {
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetAntialiasMode(D2D1_ANTIALIAS_MODE antialiasMode)
+    {
+        m_currentState.AntialiasMode = antialiasMode;
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetTags(D2D1_TAG, D2D1_TAG)
+    {
+        // Tags are a debugging aid that has no effect on rendering, so are not recorded.
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode)
+    {
+        m_currentState.TextAntialiasMode = textAntialiasMode;
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetTextRenderingParams(IDWriteRenderingParams* textRenderingParams)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                m_currentState.TextRenderingParams = GetDisplayList().AddResource(textRenderingParams);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetTransform(D2D1_MATRIX_3X2_F const* transform)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(transform);
+                m_currentState.Transform = *transform;
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetPrimitiveBlend(D2D1_PRIMITIVE_BLEND primitiveBlend)
+    {
+        m_currentState.PrimitiveBlend = primitiveBlend;
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetPrimitiveBlend1(D2D1_PRIMITIVE_BLEND primitiveBlend)
+    {
+        m_currentState.PrimitiveBlend = primitiveBlend;
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::SetUnitMode(D2D1_UNIT_MODE unitMode)
+    {
+        m_currentState.UnitMode = unitMode;
+        return S_OK;
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::Clear(D2D1_COLOR_F const* color)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& arena = GetDisplayList().m_arena;
+
+                AddCommand(DisplayListCommandType::Clear, D2D1::InfiniteRect(), DisplayListPayloads::Clear{ arena.CopyOptional(color) });
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawGlyphRun(
+        D2D1_POINT_2F baselineOrigin,
+        DWRITE_GLYPH_RUN const* glyphRun,
+        DWRITE_GLYPH_RUN_DESCRIPTION const* glyphRunDescription,
+        ID2D1Brush* foregroundBrush,
+        DWRITE_MEASURING_MODE measuringMode)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(glyphRun);
+
+                auto& displayList = GetDisplayList();
+                auto& arena = displayList.m_arena;
+
+                DisplayListPayloads::DrawGlyphRun payload{};
+
+                payload.BaselineOrigin = baselineOrigin;
+                payload.FontFace = displayList.AddResource(glyphRun->fontFace);
+                payload.FontEmSize = glyphRun->fontEmSize;
+                payload.GlyphCount = glyphRun->glyphCount;
+                payload.GlyphIndices = arena.CopyArray(glyphRun->glyphIndices, glyphRun->glyphCount);
+                payload.GlyphAdvances = arena.CopyArray(glyphRun->glyphAdvances, glyphRun->glyphCount);
+                payload.GlyphOffsets = arena.CopyArray(glyphRun->glyphOffsets, glyphRun->glyphCount);
+                payload.IsSideways = glyphRun->isSideways;
+                payload.BidiLevel = glyphRun->bidiLevel;
+                payload.Brush = displayList.AddResource(foregroundBrush);
+                payload.MeasuringMode = measuringMode;
+
+                if (glyphRunDescription)
+                {
+                    payload.HasDescription = true;
+
+                    if (glyphRunDescription->localeName)
+                        payload.LocaleName = arena.CopyArray(glyphRunDescription->localeName, static_cast<uint32_t>(wcslen(glyphRunDescription->localeName) + 1));
+
+                    payload.String = arena.CopyArray(glyphRunDescription->string, glyphRunDescription->stringLength);
+                    payload.StringLength = glyphRunDescription->stringLength;
+                    payload.ClusterMap = arena.CopyArray(glyphRunDescription->clusterMap, glyphRunDescription->stringLength);
+                    payload.TextPosition = glyphRunDescription->textPosition;
+                }
+
+                //
+                // Estimate the bounds from the font's ascent and descent and
+                // the total advance.  This is inflated by the em size to allow
+                // for glyph offsets and overhangs.  Sideways runs, or runs
+                // without advances, are left unbounded.
+                //
+                auto bounds = D2D1::InfiniteRect();
+
+                if (glyphRun->fontFace && glyphRun->glyphAdvances && !glyphRun->isSideways)
+                {
+                    DWRITE_FONT_METRICS metrics;
+                    glyphRun->fontFace->GetMetrics(&metrics);
+
+                    float scale = glyphRun->fontEmSize / std::max<float>(metrics.designUnitsPerEm, 1);
+
+                    float totalAdvance = 0;
+                    for (uint32_t i = 0; i < glyphRun->glyphCount; ++i)
+                        totalAdvance += glyphRun->glyphAdvances[i];
+
+                    bool isRightToLeft = (glyphRun->bidiLevel & 1) != 0;
+
+                    D2D1_RECT_F localBounds
+                    {
+                        isRightToLeft ? baselineOrigin.x - totalAdvance : baselineOrigin.x,
+                        baselineOrigin.y - metrics.ascent * scale,
+                        isRightToLeft ? baselineOrigin.x : baselineOrigin.x + totalAdvance,
+                        baselineOrigin.y + metrics.descent * scale,
+                    };
+
+                    bounds = ToWorld(InflateRectangle(localBounds, glyphRun->fontEmSize));
+                }
+
+                AddCommand(DisplayListCommandType::DrawGlyphRun, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawLine(
+        D2D1_POINT_2F point0,
+        D2D1_POINT_2F point1,
+        ID2D1Brush* brush,
+        float strokeWidth,
+        ID2D1StrokeStyle* strokeStyle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawLine payload
+                {
+                    point0,
+                    point1,
+                    displayList.AddResource(brush),
+                    strokeWidth,
+                    displayList.AddResource(strokeStyle)
+                };
+
+                D2D1_RECT_F localBounds
+                {
+                    std::min(point0.x, point1.x),
+                    std::min(point0.y, point1.y),
+                    std::max(point0.x, point1.x),
+                    std::max(point0.y, point1.y),
+                };
+
+                // Inflating by the full stroke width allows for square caps and miters.
+                AddCommand(DisplayListCommandType::DrawLine, ToWorld(InflateRectangle(localBounds, strokeWidth)), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawGeometry(
+        ID2D1Geometry* geometry,
+        ID2D1Brush* brush,
+        float strokeWidth,
+        ID2D1StrokeStyle* strokeStyle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(geometry);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawGeometry payload
+                {
+                    displayList.AddResource(geometry),
+                    displayList.AddResource(brush),
+                    strokeWidth,
+                    displayList.AddResource(strokeStyle)
+                };
+
+                D2D1_RECT_F bounds;
+                ThrowIfFailed(geometry->GetWidenedBounds(strokeWidth, strokeStyle, &m_currentState.Transform, D2D1_DEFAULT_FLATTENING_TOLERANCE, &bounds));
+
+                AddCommand(DisplayListCommandType::DrawGeometry, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawRectangle(
+        D2D1_RECT_F const* rect,
+        ID2D1Brush* brush,
+        float strokeWidth,
+        ID2D1StrokeStyle* strokeStyle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(rect);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawRectangle payload
+                {
+                    *rect,
+                    displayList.AddResource(brush),
+                    strokeWidth,
+                    displayList.AddResource(strokeStyle)
+                };
+
+                AddCommand(DisplayListCommandType::DrawRectangle, ToWorld(InflateRectangle(*rect, strokeWidth)), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawBitmap(
+        ID2D1Bitmap* bitmap,
+        D2D1_RECT_F const* destinationRectangle,
+        float opacity,
+        D2D1_INTERPOLATION_MODE interpolationMode,
+        D2D1_RECT_F const* sourceRectangle,
+        D2D1_MATRIX_4X4_F const* perspectiveTransform)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(bitmap);
+
+                auto& displayList = GetDisplayList();
+                auto& arena = displayList.m_arena;
+
+                DisplayListPayloads::DrawBitmap payload
+                {
+                    displayList.AddResource(bitmap),
+                    arena.CopyOptional(destinationRectangle),
+                    opacity,
+                    interpolationMode,
+                    arena.CopyOptional(sourceRectangle),
+                    arena.CopyOptional(perspectiveTransform)
+                };
+
+                auto bounds = perspectiveTransform ? D2D1::InfiniteRect()
+                                                   : GetBitmapBounds(bitmap, destinationRectangle, sourceRectangle);
+
+                AddCommand(DisplayListCommandType::DrawBitmap, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawImage(
+        ID2D1Image* image,
+        D2D1_POINT_2F const* targetOffset,
+        D2D1_RECT_F const* imageRectangle,
+        D2D1_INTERPOLATION_MODE interpolationMode,
+        D2D1_COMPOSITE_MODE compositeMode)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(image);
+
+                auto& displayList = GetDisplayList();
+                auto& arena = displayList.m_arena;
+
+                DisplayListPayloads::DrawImage payload
+                {
+                    displayList.AddResource(image),
+                    arena.CopyOptional(targetOffset),
+                    arena.CopyOptional(imageRectangle),
+                    interpolationMode,
+                    compositeMode
+                };
+
+                //
+                // The image's own bounds can only be found with a device
+                // context.  Without one, we can still bound the image if the
+                // caller specified which part of it to draw.
+                //
+                auto bounds = D2D1::InfiniteRect();
+                bool hasBounds = false;
+
+                if (m_boundsDeviceContext)
+                {
+                    ThrowIfFailed(m_boundsDeviceContext->GetImageLocalBounds(image, &bounds));
+                    hasBounds = true;
+
+                    if (imageRectangle)
+                        bounds = RectangleIntersection(bounds, *imageRectangle);
+                }
+                else if (imageRectangle)
+                {
+                    bounds = *imageRectangle;
+                    hasBounds = true;
+                }
+
+                if (hasBounds)
+                {
+                    auto offset = targetOffset ? *targetOffset : D2D1_POINT_2F{ 0, 0 };
+
+                    //
+                    // When an image rectangle is specified, its top left
+                    // corner is what gets placed at the target offset.
+                    //
+                    if (imageRectangle)
+                    {
+                        offset.x -= imageRectangle->left;
+                        offset.y -= imageRectangle->top;
+                    }
+
+                    bounds = ToWorld(D2D1_RECT_F{ bounds.left + offset.x, bounds.top + offset.y, bounds.right + offset.x, bounds.bottom + offset.y });
+                }
+
+                AddCommand(DisplayListCommandType::DrawImage, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawGdiMetafile(
+        ID2D1GdiMetafile* gdiMetafile,
+        D2D1_POINT_2F const* targetOffset)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(gdiMetafile);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawGdiMetafile payload
+                {
+                    displayList.AddResource(gdiMetafile),
+                    displayList.m_arena.CopyOptional(targetOffset),
+                    nullptr,
+                    nullptr
+                };
+
+                D2D1_RECT_F bounds;
+                ThrowIfFailed(gdiMetafile->GetBounds(&bounds));
+
+                if (targetOffset)
+                {
+                    bounds.left += targetOffset->x;
+                    bounds.right += targetOffset->x;
+                    bounds.top += targetOffset->y;
+                    bounds.bottom += targetOffset->y;
+                }
+
+                AddCommand(DisplayListCommandType::DrawGdiMetafile, ToWorld(bounds), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawGdiMetafile(
+        ID2D1GdiMetafile* gdiMetafile,
+        D2D1_RECT_F const* destinationRectangle,
+        D2D1_RECT_F const* sourceRectangle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(gdiMetafile);
+
+                auto& displayList = GetDisplayList();
+                auto& arena = displayList.m_arena;
+
+                DisplayListPayloads::DrawGdiMetafile payload
+                {
+                    displayList.AddResource(gdiMetafile),
+                    nullptr,
+                    arena.CopyOptional(destinationRectangle),
+                    arena.CopyOptional(sourceRectangle)
+                };
+
+                D2D1_RECT_F bounds;
+
+                if (destinationRectangle)
+                    bounds = *destinationRectangle;
+                else
+                    ThrowIfFailed(gdiMetafile->GetBounds(&bounds));
+
+                AddCommand(DisplayListCommandType::DrawGdiMetafileWithRectangles, ToWorld(bounds), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::FillMesh(
+        ID2D1Mesh* mesh,
+        ID2D1Brush* brush)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::FillMesh payload
+                {
+                    displayList.AddResource(mesh),
+                    displayList.AddResource(brush)
+                };
+
+                // ID2D1Mesh doesn't expose its bounds.
+                AddCommand(DisplayListCommandType::FillMesh, D2D1::InfiniteRect(), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::FillOpacityMask(
+        ID2D1Bitmap* opacityMask,
+        ID2D1Brush* brush,
+        D2D1_RECT_F const* destinationRectangle,
+        D2D1_RECT_F const* sourceRectangle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(opacityMask);
+
+                auto& displayList = GetDisplayList();
+                auto& arena = displayList.m_arena;
+
+                DisplayListPayloads::FillOpacityMask payload
+                {
+                    displayList.AddResource(opacityMask),
+                    displayList.AddResource(brush),
+                    arena.CopyOptional(destinationRectangle),
+                    arena.CopyOptional(sourceRectangle)
+                };
+
+                AddCommand(DisplayListCommandType::FillOpacityMask, GetBitmapBounds(opacityMask, destinationRectangle, sourceRectangle), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::FillGeometry(
+        ID2D1Geometry* geometry,
+        ID2D1Brush* brush,
+        ID2D1Brush* opacityBrush)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(geometry);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::FillGeometry payload
+                {
+                    displayList.AddResource(geometry),
+                    displayList.AddResource(brush),
+                    displayList.AddResource(opacityBrush)
+                };
+
+                D2D1_RECT_F bounds;
+                ThrowIfFailed(geometry->GetBounds(&m_currentState.Transform, &bounds));
+
+                AddCommand(DisplayListCommandType::FillGeometry, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::FillRectangle(
+        D2D1_RECT_F const* rect,
+        ID2D1Brush* brush)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(rect);
+
+                DisplayListPayloads::FillRectangle payload
+                {
+                    *rect,
+                    GetDisplayList().AddResource(brush)
+                };
+
+                AddCommand(DisplayListCommandType::FillRectangle, ToWorld(*rect), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::PushAxisAlignedClip(
+        D2D1_RECT_F const* clipRect,
+        D2D1_ANTIALIAS_MODE antialiasMode)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(clipRect);
+
+                DisplayListPayloads::PushAxisAlignedClip payload
+                {
+                    *clipRect,
+                    antialiasMode
+                };
+
+                AddCommand(DisplayListCommandType::PushAxisAlignedClip, ToWorld(*clipRect), payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::PushLayer(
+        D2D1_LAYER_PARAMETERS1 const* layerParameters,
+        ID2D1Layer* layer)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(layerParameters);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::PushLayer payload
+                {
+                    layerParameters->contentBounds,
+                    displayList.AddResource(layerParameters->geometricMask),
+                    layerParameters->maskAntialiasMode,
+                    layerParameters->maskTransform,
+                    layerParameters->opacity,
+                    displayList.AddResource(layerParameters->opacityBrush),
+                    layerParameters->layerOptions,
+                    displayList.AddResource(layer)
+                };
+
+                auto bounds = ToWorld(layerParameters->contentBounds);
+
+                if (layerParameters->geometricMask)
+                {
+                    auto maskTransform =
+                        *D2D1::Matrix3x2F::ReinterpretBaseType(&layerParameters->maskTransform) *
+                        *D2D1::Matrix3x2F::ReinterpretBaseType(&m_currentState.Transform);
+
+                    D2D1_RECT_F maskBounds;
+                    ThrowIfFailed(layerParameters->geometricMask->GetBounds(&maskTransform, &maskBounds));
+
+                    bounds = IsInfiniteRectangle(bounds) ? maskBounds : RectangleIntersection(bounds, maskBounds);
+                }
+
+                AddCommand(DisplayListCommandType::PushLayer, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::PopAxisAlignedClip()
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                AddCommand(DisplayListCommandType::PopAxisAlignedClip, D2D1::InfiniteRect(), static_cast<void const*>(nullptr));
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::PopLayer()
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                AddCommand(DisplayListCommandType::PopLayer, D2D1::InfiniteRect(), static_cast<void const*>(nullptr));
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawInk(
+        ID2D1Ink* ink,
+        ID2D1Brush* brush,
+        ID2D1InkStyle* inkStyle)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(ink);
+
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawInk payload
+                {
+                    displayList.AddResource(ink),
+                    displayList.AddResource(brush),
+                    displayList.AddResource(inkStyle)
+                };
+
+                D2D1_RECT_F bounds;
+                ThrowIfFailed(ink->GetBounds(inkStyle, &m_currentState.Transform, &bounds));
+
+                AddCommand(DisplayListCommandType::DrawInk, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawGradientMesh(
+        ID2D1GradientMesh* gradientMesh)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(gradientMesh);
+
+                DisplayListPayloads::DrawGradientMesh payload
+                {
+                    GetDisplayList().AddResource(gradientMesh)
+                };
+
+                auto bounds = D2D1::InfiniteRect();
+
+                if (m_boundsDeviceContext)
+                {
+                    ThrowIfFailed(As<ID2D1DeviceContext2>(m_boundsDeviceContext)->GetGradientMeshWorldBounds(gradientMesh, &bounds));
+                    bounds = ToWorld(bounds);
+                }
+
+                AddCommand(DisplayListCommandType::DrawGradientMesh, bounds, payload);
+            });
+    }
+
+
+    IFACEMETHODIMP DisplayListRecorder::DrawSpriteBatch(
+        ID2D1SpriteBatch* spriteBatch,
+        UINT32 startIndex,
+        UINT32 spriteCount,
+        ID2D1Bitmap* bitmap,
+        D2D1_BITMAP_INTERPOLATION_MODE interpolationMode,
+        D2D1_SPRITE_OPTIONS spriteOptions)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& displayList = GetDisplayList();
+
+                DisplayListPayloads::DrawSpriteBatch payload
+                {
+                    displayList.AddResource(spriteBatch),
+                    startIndex,
+                    spriteCount,
+                    displayList.AddResource(bitmap),
+                    interpolationMode,
+                    spriteOptions
+                };
+
+                // Sprites can be transformed arbitrarily, so these are never culled.
+                AddCommand(DisplayListCommandType::DrawSpriteBatch, D2D1::InfiniteRect(), payload);
+            });
+    }
+
+}}}}
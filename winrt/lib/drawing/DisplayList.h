@@ -0,0 +1,469 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Bump allocator backing the command payloads of a DisplayList.  Memory
+    // is handed out from fixed size blocks and is only released when the
+    // arena is destroyed, which keeps recording cheap and keeps commands that
+    // were recorded together close together in memory.
+    //
+    class DisplayListArena
+    {
+        static size_t const BlockSize = 16 * 1024;
+
+        std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+        size_t m_blockOffset;
+        size_t m_bytesAllocated;
+
+    public:
+        DisplayListArena();
+
+        DisplayListArena(DisplayListArena const&) = delete;
+        DisplayListArena& operator=(DisplayListArena const&) = delete;
+
+        void* Allocate(size_t size, size_t alignment);
+
+        template<typename T>
+        T* New(T const& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "arena values must be trivially copyable");
+            auto result = static_cast<T*>(Allocate(sizeof(T), alignof(T)));
+            *result = value;
+            return result;
+        }
+
+        template<typename T>
+        T const* CopyArray(T const* source, uint32_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "arena values must be trivially copyable");
+
+            if (!source || count == 0)
+                return nullptr;
+
+            auto result = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+            std::copy(source, source + count, result);
+            return result;
+        }
+
+        template<typename T>
+        T const* CopyOptional(T const* source)
+        {
+            return source ? New(*source) : nullptr;
+        }
+
+        size_t GetBytesAllocated() const { return m_bytesAllocated; }
+    };
+
+
+    enum class DisplayListCommandType : uint8_t
+    {
+        Clear,
+        DrawGlyphRun,
+        DrawLine,
+        DrawGeometry,
+        DrawRectangle,
+        DrawBitmap,
+        DrawImage,
+        DrawGdiMetafile,
+        FillMesh,
+        FillOpacityMask,
+        FillGeometry,
+        FillRectangle,
+        PushAxisAlignedClip,
+        PushLayer,
+        PopAxisAlignedClip,
+        PopLayer,
+        DrawInk,
+        DrawGradientMesh,
+        DrawGdiMetafileWithRectangles,
+        DrawSpriteBatch,
+    };
+
+
+    //
+    // Rendering state that applies to a command.  Consecutive commands
+    // recorded with the same state share a single entry, so runs of redundant
+    // state changes in the source command list collapse into one.
+    //
+    struct DisplayListState
+    {
+        D2D1_MATRIX_3X2_F Transform;
+        D2D1_ANTIALIAS_MODE AntialiasMode;
+        D2D1_TEXT_ANTIALIAS_MODE TextAntialiasMode;
+        D2D1_PRIMITIVE_BLEND PrimitiveBlend;
+        D2D1_UNIT_MODE UnitMode;
+        uint32_t TextRenderingParams;   // resource index
+
+        static DisplayListState Default();
+
+        bool operator==(DisplayListState const& other) const;
+        bool operator!=(DisplayListState const& other) const { return !(*this == other); }
+    };
+
+
+    //
+    // Commands are a fixed size header followed by an arena allocated,
+    // type-specific payload.  Bounds are in the coordinate space of the
+    // recording's target, ie. with the command's transform already applied.
+    // Commands whose bounds can't be computed cheaply use D2D1::InfiniteRect
+    // and so are never culled.
+    //
+    struct DisplayListCommand
+    {
+        DisplayListCommandType Type;
+        uint32_t StateIndex;
+        D2D1_RECT_F Bounds;
+        void const* Payload;
+    };
+
+
+    struct DisplayListReplayStatistics
+    {
+        uint32_t CommandsReplayed;
+        uint32_t CommandsCulled;
+        uint32_t StateChanges;
+    };
+
+
+    //
+    // Used when retargeting a display list to a new device.  Called for each
+    // device dependent resource that Win2D does not know how to recreate
+    // itself.  Returning null leaves the original resource in place.
+    //
+    typedef std::function<ComPtr<IUnknown>(IUnknown* resource)> DisplayListResourceMapper;
+
+
+    //
+    // A Win2D-side retained display list.  Unlike ID2D1CommandList this can
+    // be inspected, replayed against a viewport with commands that fall
+    // entirely outside it culled, and moved to a different device after
+    // device loss.
+    //
+    // Display lists are recorded by streaming a closed ID2D1CommandList (for
+    // example, one that a CanvasCommandList's drawing session has drawn to)
+    // through a DisplayListRecorder.
+    //
+    class DisplayList
+    {
+        DisplayListArena m_arena;
+        std::vector<DisplayListCommand> m_commands;
+        std::vector<DisplayListState> m_states;
+        // Resources are stored as the interface type they were recorded with,
+        // which is tracked in m_resourceIids.  Index 0 is always null.
+        std::vector<ComPtr<IUnknown>> m_resources;
+        std::vector<IID> m_resourceIids;
+        std::unordered_map<IUnknown*, uint32_t> m_resourceIndices;
+
+        friend class DisplayListRecorder;
+
+    public:
+        DisplayList();
+
+        DisplayList(DisplayList const&) = delete;
+        DisplayList& operator=(DisplayList const&) = delete;
+
+        //
+        // Records the contents of a closed D2D command list.  If
+        // boundsDeviceContext is provided it is used to compute the bounds of
+        // images and gradient meshes; otherwise those commands are given
+        // infinite bounds.
+        //
+        static std::shared_ptr<DisplayList> Record(
+            ID2D1CommandList* commandList,
+            ID2D1DeviceContext* boundsDeviceContext = nullptr);
+
+        std::vector<DisplayListCommand> const& GetCommands() const { return m_commands; }
+        std::vector<DisplayListState> const& GetStates() const { return m_states; }
+
+        IUnknown* GetResource(uint32_t index) const { return m_resources[index].Get(); }
+
+        D2D1_RECT_F GetBounds() const;
+
+        size_t GetMemoryUsage() const;
+
+        //
+        // Replays the display list into a device context that has already had
+        // BeginDraw called on it.  The recorded transforms are multiplied by
+        // 'transform'.  If viewport is non-null, commands whose transformed
+        // bounds don't intersect it are skipped, as are whole clip and layer
+        // scopes whose clip is outside the viewport.
+        //
+        // The device context's state is restored before this returns.
+        //
+        DisplayListReplayStatistics Replay(
+            ID2D1DeviceContext1* deviceContext,
+            D2D1_MATRIX_3X2_F const& transform,
+            D2D1_RECT_F const* viewport) const;
+
+        //
+        // Moves the display list's device dependent resources to the device
+        // that owns newDeviceContext.  Solid color brushes are recreated
+        // automatically; everything else is passed to the mapper.
+        //
+        void Retarget(
+            ID2D1DeviceContext* newDeviceContext,
+            DisplayListResourceMapper const& mapper);
+
+    private:
+        template<typename T>
+        uint32_t AddResource(T* resource)
+        {
+            return AddResource(resource, __uuidof(T));
+        }
+
+        uint32_t AddResource(IUnknown* resource, IID const& iid);
+
+        template<typename T>
+        T* GetResourceAs(uint32_t index) const
+        {
+            assert(index == 0 || m_resourceIids[index] == __uuidof(T));
+            return static_cast<T*>(m_resources[index].Get());
+        }
+
+        void ApplyState(
+            ID2D1DeviceContext1* deviceContext,
+            DisplayListState const& state,
+            DisplayListState const* previousState,
+            D2D1_MATRIX_3X2_F const& transform) const;
+
+        void ReplayCommand(ID2D1DeviceContext1* deviceContext, DisplayListCommand const& command) const;
+    };
+
+
+    //
+    // ID2D1CommandSink that records into a DisplayList.
+    //
+    class DisplayListRecorder : public RuntimeClass<
+        RuntimeClassFlags<ClassicCom>,
+        ChainInterfaces<ID2D1CommandSink3, ID2D1CommandSink2, ID2D1CommandSink1, ID2D1CommandSink>>,
+        private LifespanTracker<DisplayListRecorder>
+    {
+        std::shared_ptr<DisplayList> m_displayList;
+        ComPtr<ID2D1DeviceContext> m_boundsDeviceContext;
+
+        DisplayListState m_currentState;
+
+    public:
+        DisplayListRecorder(ID2D1DeviceContext* boundsDeviceContext = nullptr);
+
+        std::shared_ptr<DisplayList> Close();
+
+        // ID2D1CommandSink
+
+        IFACEMETHOD(BeginDraw)() override;
+        IFACEMETHOD(EndDraw)() override;
+        IFACEMETHOD(SetAntialiasMode)(D2D1_ANTIALIAS_MODE antialiasMode) override;
+        IFACEMETHOD(SetTags)(D2D1_TAG tag1, D2D1_TAG tag2) override;
+        IFACEMETHOD(SetTextAntialiasMode)(D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode) override;
+        IFACEMETHOD(SetTextRenderingParams)(IDWriteRenderingParams* textRenderingParams) override;
+        IFACEMETHOD(SetTransform)(D2D1_MATRIX_3X2_F const* transform) override;
+        IFACEMETHOD(SetPrimitiveBlend)(D2D1_PRIMITIVE_BLEND primitiveBlend) override;
+        IFACEMETHOD(SetUnitMode)(D2D1_UNIT_MODE unitMode) override;
+        IFACEMETHOD(Clear)(D2D1_COLOR_F const* color) override;
+        IFACEMETHOD(DrawGlyphRun)(D2D1_POINT_2F baselineOrigin, DWRITE_GLYPH_RUN const* glyphRun, DWRITE_GLYPH_RUN_DESCRIPTION const* glyphRunDescription, ID2D1Brush* foregroundBrush, DWRITE_MEASURING_MODE measuringMode) override;
+        IFACEMETHOD(DrawLine)(D2D1_POINT_2F point0, D2D1_POINT_2F point1, ID2D1Brush* brush, float strokeWidth, ID2D1StrokeStyle* strokeStyle) override;
+        IFACEMETHOD(DrawGeometry)(ID2D1Geometry* geometry, ID2D1Brush* brush, float strokeWidth, ID2D1StrokeStyle* strokeStyle) override;
+        IFACEMETHOD(DrawRectangle)(D2D1_RECT_F const* rect, ID2D1Brush* brush, float strokeWidth, ID2D1StrokeStyle* strokeStyle) override;
+        IFACEMETHOD(DrawBitmap)(ID2D1Bitmap* bitmap, D2D1_RECT_F const* destinationRectangle, float opacity, D2D1_INTERPOLATION_MODE interpolationMode, D2D1_RECT_F const* sourceRectangle, D2D1_MATRIX_4X4_F const* perspectiveTransform) override;
+        IFACEMETHOD(DrawImage)(ID2D1Image* image, D2D1_POINT_2F const* targetOffset, D2D1_RECT_F const* imageRectangle, D2D1_INTERPOLATION_MODE interpolationMode, D2D1_COMPOSITE_MODE compositeMode) override;
+        IFACEMETHOD(DrawGdiMetafile)(ID2D1GdiMetafile* gdiMetafile, D2D1_POINT_2F const* targetOffset) override;
+        IFACEMETHOD(FillMesh)(ID2D1Mesh* mesh, ID2D1Brush* brush) override;
+        IFACEMETHOD(FillOpacityMask)(ID2D1Bitmap* opacityMask, ID2D1Brush* brush, D2D1_RECT_F const* destinationRectangle, D2D1_RECT_F const* sourceRectangle) override;
+        IFACEMETHOD(FillGeometry)(ID2D1Geometry* geometry, ID2D1Brush* brush, ID2D1Brush* opacityBrush) override;
+        IFACEMETHOD(FillRectangle)(D2D1_RECT_F const* rect, ID2D1Brush* brush) override;
+        IFACEMETHOD(PushAxisAlignedClip)(D2D1_RECT_F const* clipRect, D2D1_ANTIALIAS_MODE antialiasMode) override;
+        IFACEMETHOD(PushLayer)(D2D1_LAYER_PARAMETERS1 const* layerParameters1, ID2D1Layer* layer) override;
+        IFACEMETHOD(PopAxisAlignedClip)() override;
+        IFACEMETHOD(PopLayer)() override;
+
+        // ID2D1CommandSink1
+
+        IFACEMETHOD(SetPrimitiveBlend1)(D2D1_PRIMITIVE_BLEND primitiveBlend) override;
+
+        // ID2D1CommandSink2
+
+        IFACEMETHOD(DrawInk)(ID2D1Ink* ink, ID2D1Brush* brush, ID2D1InkStyle* inkStyle) override;
+        IFACEMETHOD(DrawGradientMesh)(ID2D1GradientMesh* gradientMesh) override;
+        IFACEMETHOD(DrawGdiMetafile)(ID2D1GdiMetafile* gdiMetafile, D2D1_RECT_F const* destinationRectangle, D2D1_RECT_F const* sourceRectangle) override;
+
+        // ID2D1CommandSink3
+
+        IFACEMETHOD(DrawSpriteBatch)(ID2D1SpriteBatch* spriteBatch, UINT32 startIndex, UINT32 spriteCount, ID2D1Bitmap* bitmap, D2D1_BITMAP_INTERPOLATION_MODE interpolationMode, D2D1_SPRITE_OPTIONS spriteOptions) override;
+
+    private:
+        DisplayList& GetDisplayList();
+
+        template<typename TPayload>
+        void AddCommand(DisplayListCommandType type, D2D1_RECT_F const& bounds, TPayload const& payload)
+        {
+            AddCommand(type, bounds, GetDisplayList().m_arena.New(payload));
+        }
+
+        void AddCommand(DisplayListCommandType type, D2D1_RECT_F const& bounds, void const* payload);
+
+        D2D1_RECT_F ToWorld(D2D1_RECT_F const& localBounds) const;
+
+        D2D1_RECT_F GetBitmapBounds(ID2D1Bitmap* bitmap, D2D1_RECT_F const* destinationRectangle, D2D1_RECT_F const* sourceRectangle) const;
+    };
+
+
+    //
+    // Command payloads.  Resources are stored as indices into the display
+    // list's resource table; optional values are arena pointers that are
+    // null when not specified.
+    //
+    namespace DisplayListPayloads
+    {
+        struct Clear
+        {
+            D2D1_COLOR_F const* Color;
+        };
+
+        struct DrawGlyphRun
+        {
+            D2D1_POINT_2F BaselineOrigin;
+            uint32_t FontFace;
+            float FontEmSize;
+            uint32_t GlyphCount;
+            UINT16 const* GlyphIndices;
+            float const* GlyphAdvances;
+            DWRITE_GLYPH_OFFSET const* GlyphOffsets;
+            BOOL IsSideways;
+            UINT32 BidiLevel;
+            bool HasDescription;
+            wchar_t const* LocaleName;
+            wchar_t const* String;
+            UINT32 StringLength;
+            UINT16 const* ClusterMap;
+            UINT32 TextPosition;
+            uint32_t Brush;
+            DWRITE_MEASURING_MODE MeasuringMode;
+        };
+
+        struct DrawLine
+        {
+            D2D1_POINT_2F Point0;
+            D2D1_POINT_2F Point1;
+            uint32_t Brush;
+            float StrokeWidth;
+            uint32_t StrokeStyle;
+        };
+
+        struct DrawGeometry
+        {
+            uint32_t Geometry;
+            uint32_t Brush;
+            float StrokeWidth;
+            uint32_t StrokeStyle;
+        };
+
+        struct DrawRectangle
+        {
+            D2D1_RECT_F Rect;
+            uint32_t Brush;
+            float StrokeWidth;
+            uint32_t StrokeStyle;
+        };
+
+        struct DrawBitmap
+        {
+            uint32_t Bitmap;
+            D2D1_RECT_F const* DestinationRectangle;
+            float Opacity;
+            D2D1_INTERPOLATION_MODE InterpolationMode;
+            D2D1_RECT_F const* SourceRectangle;
+            D2D1_MATRIX_4X4_F const* PerspectiveTransform;
+        };
+
+        struct DrawImage
+        {
+            uint32_t Image;
+            D2D1_POINT_2F const* TargetOffset;
+            D2D1_RECT_F const* ImageRectangle;
+            D2D1_INTERPOLATION_MODE InterpolationMode;
+            D2D1_COMPOSITE_MODE CompositeMode;
+        };
+
+        struct DrawGdiMetafile
+        {
+            uint32_t Metafile;
+            D2D1_POINT_2F const* TargetOffset;
+            D2D1_RECT_F const* DestinationRectangle;
+            D2D1_RECT_F const* SourceRectangle;
+        };
+
+        struct FillMesh
+        {
+            uint32_t Mesh;
+            uint32_t Brush;
+        };
+
+        struct FillOpacityMask
+        {
+            uint32_t OpacityMask;
+            uint32_t Brush;
+            D2D1_RECT_F const* DestinationRectangle;
+            D2D1_RECT_F const* SourceRectangle;
+        };
+
+        struct FillGeometry
+        {
+            uint32_t Geometry;
+            uint32_t Brush;
+            uint32_t OpacityBrush;
+        };
+
+        struct FillRectangle
+        {
+            D2D1_RECT_F Rect;
+            uint32_t Brush;
+        };
+
+        struct PushAxisAlignedClip
+        {
+            D2D1_RECT_F ClipRect;
+            D2D1_ANTIALIAS_MODE AntialiasMode;
+        };
+
+        struct PushLayer
+        {
+            D2D1_RECT_F ContentBounds;
+            uint32_t GeometricMask;
+            D2D1_ANTIALIAS_MODE MaskAntialiasMode;
+            D2D1_MATRIX_3X2_F MaskTransform;
+            float Opacity;
+            uint32_t OpacityBrush;
+            D2D1_LAYER_OPTIONS1 LayerOptions;
+            uint32_t Layer;
+        };
+
+        struct DrawInk
+        {
+            uint32_t Ink;
+            uint32_t Brush;
+            uint32_t InkStyle;
+        };
+
+        struct DrawGradientMesh
+        {
+            uint32_t GradientMesh;
+        };
+
+        struct DrawSpriteBatch
+        {
+            uint32_t SpriteBatch;
+            UINT32 StartIndex;
+            UINT32 SpriteCount;
+            uint32_t Bitmap;
+            D2D1_BITMAP_INTERPOLATION_MODE InterpolationMode;
+            D2D1_SPRITE_OPTIONS SpriteOptions;
+        };
+    }
+}}}}
@@ -0,0 +1,549 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "GradientMeshEvaluator.h"
+#include "utils/ScratchBuffer.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace DirectX;
+
+static XMVECTOR XM_CALLCONV BernsteinWeights(float t)
+{
+    float s = 1 - t;
+    return XMVectorSet(s * s * s, 3 * s * s * t, 3 * s * t * t, t * t * t);
+}
+
+static XMVECTOR XM_CALLCONV BernsteinDerivativeWeights(float t)
+{
+    float s = 1 - t;
+    return XMVectorSet(-3 * s * s, 3 * s * s - 6 * s * t, 6 * s * t - 3 * t * t, 3 * t * t);
+}
+
+static float XM_CALLCONV HorizontalMin(FXMVECTOR value)
+{
+    XMFLOAT4 f;
+    XMStoreFloat4(&f, value);
+    return std::min(std::min(f.x, f.y), std::min(f.z, f.w));
+}
+
+static float XM_CALLCONV HorizontalMax(FXMVECTOR value)
+{
+    XMFLOAT4 f;
+    XMStoreFloat4(&f, value);
+    return std::max(std::max(f.x, f.y), std::max(f.z, f.w));
+}
+
+static D2D1_RECT_F XM_CALLCONV MakeBounds(FXMVECTOR minX, FXMVECTOR minY, FXMVECTOR maxX, GXMVECTOR maxY)
+{
+    return D2D1_RECT_F{ HorizontalMin(minX), HorizontalMin(minY), HorizontalMax(maxX), HorizontalMax(maxY) };
+}
+
+static bool RectContainsPoint(D2D1_RECT_F const& rect, Vector2 point)
+{
+    return point.X >= rect.left && point.X <= rect.right &&
+           point.Y >= rect.top && point.Y <= rect.bottom;
+}
+
+static float Length(float x, float y)
+{
+    return sqrtf(x * x + y * y);
+}
+
+static float Clamp01(float value)
+{
+    return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+//
+// The control points are stored by row, so the x coordinate of the point in
+// row r and column c is patch.X[r] component c.
+//
+
+static float GetComponent(XMFLOAT4 const& row, int column)
+{
+    return (&row.x)[column];
+}
+
+//
+// Weighting the rows by the Bernstein polynomials for v gives the four
+// control points of the cubic in u at that v.
+//
+
+template<typename PATCH>
+static void XM_CALLCONV CollapseRows(PATCH const& patch, FXMVECTOR vWeights, XMVECTOR* x, XMVECTOR* y)
+{
+    XMVECTOR w0 = XMVectorSplatX(vWeights);
+    XMVECTOR w1 = XMVectorSplatY(vWeights);
+    XMVECTOR w2 = XMVectorSplatZ(vWeights);
+    XMVECTOR w3 = XMVectorSplatW(vWeights);
+
+    XMVECTOR rx = XMVectorMultiply(XMLoadFloat4(&patch.X[0]), w0);
+    rx = XMVectorMultiplyAdd(XMLoadFloat4(&patch.X[1]), w1, rx);
+    rx = XMVectorMultiplyAdd(XMLoadFloat4(&patch.X[2]), w2, rx);
+    rx = XMVectorMultiplyAdd(XMLoadFloat4(&patch.X[3]), w3, rx);
+
+    XMVECTOR ry = XMVectorMultiply(XMLoadFloat4(&patch.Y[0]), w0);
+    ry = XMVectorMultiplyAdd(XMLoadFloat4(&patch.Y[1]), w1, ry);
+    ry = XMVectorMultiplyAdd(XMLoadFloat4(&patch.Y[2]), w2, ry);
+    ry = XMVectorMultiplyAdd(XMLoadFloat4(&patch.Y[3]), w3, ry);
+
+    *x = rx;
+    *y = ry;
+}
+
+template<typename PATCH>
+static Vector2 XM_CALLCONV Evaluate(PATCH const& patch, FXMVECTOR vWeights, FXMVECTOR uWeights)
+{
+    XMVECTOR x, y;
+    CollapseRows(patch, vWeights, &x, &y);
+
+    return Vector2{ XMVectorGetX(XMVector4Dot(x, uWeights)), XMVectorGetX(XMVector4Dot(y, uWeights)) };
+}
+
+
+GradientMeshEvaluator::GradientMeshEvaluator(std::vector<D2D1_GRADIENT_MESH_PATCH> const& patches)
+    : m_bounds{}
+{
+    m_patches.reserve(patches.size());
+
+    XMVECTOR meshMinX = g_XMInfinity;
+    XMVECTOR meshMinY = g_XMInfinity;
+    XMVECTOR meshMaxX = g_XMNegInfinity;
+    XMVECTOR meshMaxY = g_XMNegInfinity;
+
+    for (auto& d2dPatch : patches)
+    {
+        Patch patch;
+
+        D2D1_POINT_2F const* rows[4][4] =
+        {
+            { &d2dPatch.point00, &d2dPatch.point01, &d2dPatch.point02, &d2dPatch.point03 },
+            { &d2dPatch.point10, &d2dPatch.point11, &d2dPatch.point12, &d2dPatch.point13 },
+            { &d2dPatch.point20, &d2dPatch.point21, &d2dPatch.point22, &d2dPatch.point23 },
+            { &d2dPatch.point30, &d2dPatch.point31, &d2dPatch.point32, &d2dPatch.point33 },
+        };
+
+        for (int r = 0; r < 4; ++r)
+        {
+            patch.X[r] = XMFLOAT4(rows[r][0]->x, rows[r][1]->x, rows[r][2]->x, rows[r][3]->x);
+            patch.Y[r] = XMFLOAT4(rows[r][0]->y, rows[r][1]->y, rows[r][2]->y, rows[r][3]->y);
+        }
+
+        patch.Color00 = *ReinterpretAs<XMFLOAT4 const*>(&d2dPatch.color00);
+        patch.Color03 = *ReinterpretAs<XMFLOAT4 const*>(&d2dPatch.color03);
+        patch.Color30 = *ReinterpretAs<XMFLOAT4 const*>(&d2dPatch.color30);
+        patch.Color33 = *ReinterpretAs<XMFLOAT4 const*>(&d2dPatch.color33);
+
+        XMVECTOR minX = XMLoadFloat4(&patch.X[0]);
+        XMVECTOR minY = XMLoadFloat4(&patch.Y[0]);
+        XMVECTOR maxX = minX;
+        XMVECTOR maxY = minY;
+
+        for (int r = 1; r < 4; ++r)
+        {
+            XMVECTOR x = XMLoadFloat4(&patch.X[r]);
+            XMVECTOR y = XMLoadFloat4(&patch.Y[r]);
+
+            minX = XMVectorMin(minX, x);
+            minY = XMVectorMin(minY, y);
+            maxX = XMVectorMax(maxX, x);
+            maxY = XMVectorMax(maxY, y);
+        }
+
+        patch.Bounds = MakeBounds(minX, minY, maxX, maxY);
+
+        meshMinX = XMVectorMin(meshMinX, minX);
+        meshMinY = XMVectorMin(meshMinY, minY);
+        meshMaxX = XMVectorMax(meshMaxX, maxX);
+        meshMaxY = XMVectorMax(meshMaxY, maxY);
+
+        m_patches.push_back(patch);
+    }
+
+    if (!m_patches.empty())
+    {
+        m_bounds = MakeBounds(meshMinX, meshMinY, meshMaxX, meshMaxY);
+    }
+}
+
+uint32_t GradientMeshEvaluator::GetPatchCount() const
+{
+    return static_cast<uint32_t>(m_patches.size());
+}
+
+GradientMeshEvaluator::Patch const& GradientMeshEvaluator::GetPatch(uint32_t patchIndex) const
+{
+    assert(patchIndex < m_patches.size());
+    return m_patches[patchIndex];
+}
+
+D2D1_RECT_F GradientMeshEvaluator::GetBounds() const
+{
+    return m_bounds;
+}
+
+D2D1_RECT_F GradientMeshEvaluator::GetBounds(D2D1_MATRIX_3X2_F const& transform) const
+{
+    if (m_patches.empty())
+        return m_bounds;
+
+    // Bezier surfaces are affine invariant, so the transformed control
+    // points bound the transformed mesh.
+    XMVECTOR m11 = XMVectorReplicate(transform._11);
+    XMVECTOR m12 = XMVectorReplicate(transform._12);
+    XMVECTOR m21 = XMVectorReplicate(transform._21);
+    XMVECTOR m22 = XMVectorReplicate(transform._22);
+    XMVECTOR dx = XMVectorReplicate(transform._31);
+    XMVECTOR dy = XMVectorReplicate(transform._32);
+
+    XMVECTOR minX = g_XMInfinity;
+    XMVECTOR minY = g_XMInfinity;
+    XMVECTOR maxX = g_XMNegInfinity;
+    XMVECTOR maxY = g_XMNegInfinity;
+
+    for (auto& patch : m_patches)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            XMVECTOR x = XMLoadFloat4(&patch.X[r]);
+            XMVECTOR y = XMLoadFloat4(&patch.Y[r]);
+
+            XMVECTOR tx = XMVectorMultiplyAdd(x, m11, XMVectorMultiplyAdd(y, m21, dx));
+            XMVECTOR ty = XMVectorMultiplyAdd(x, m12, XMVectorMultiplyAdd(y, m22, dy));
+
+            minX = XMVectorMin(minX, tx);
+            minY = XMVectorMin(minY, ty);
+            maxX = XMVectorMax(maxX, tx);
+            maxY = XMVectorMax(maxY, ty);
+        }
+    }
+
+    return MakeBounds(minX, minY, maxX, maxY);
+}
+
+Vector2 GradientMeshEvaluator::EvaluatePosition(uint32_t patchIndex, float u, float v) const
+{
+    return Evaluate(GetPatch(patchIndex), BernsteinWeights(v), BernsteinWeights(u));
+}
+
+Vector4 GradientMeshEvaluator::EvaluateColor(uint32_t patchIndex, float u, float v) const
+{
+    auto& patch = GetPatch(patchIndex);
+
+    XMVECTOR top = XMVectorLerp(XMLoadFloat4(&patch.Color00), XMLoadFloat4(&patch.Color03), u);
+    XMVECTOR bottom = XMVectorLerp(XMLoadFloat4(&patch.Color30), XMLoadFloat4(&patch.Color33), u);
+
+    Vector4 color;
+    XMStoreFloat4(ReinterpretAs<XMFLOAT4*>(&color), XMVectorLerp(top, bottom, v));
+    return color;
+}
+
+void GradientMeshEvaluator::EvaluateRow(uint32_t patchIndex, float v, float const* u, uint32_t count, Vector2* positions) const
+{
+    XMVECTOR cx, cy;
+    CollapseRows(GetPatch(patchIndex), BernsteinWeights(v), &cx, &cy);
+
+    XMVECTOR x0 = XMVectorSplatX(cx);
+    XMVECTOR x1 = XMVectorSplatY(cx);
+    XMVECTOR x2 = XMVectorSplatZ(cx);
+    XMVECTOR x3 = XMVectorSplatW(cx);
+
+    XMVECTOR y0 = XMVectorSplatX(cy);
+    XMVECTOR y1 = XMVectorSplatY(cy);
+    XMVECTOR y2 = XMVectorSplatZ(cy);
+    XMVECTOR y3 = XMVectorSplatW(cy);
+
+    XMVECTOR three = XMVectorReplicate(3.0f);
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        uint32_t batchSize = std::min(count - i, 4u);
+
+        // Pad a partial batch by repeating its last value.
+        XMFLOAT4 batch;
+        for (uint32_t j = 0; j < 4; ++j)
+            (&batch.x)[j] = u[i + std::min(j, batchSize - 1)];
+
+        XMVECTOR t = XMLoadFloat4(&batch);
+        XMVECTOR s = XMVectorSubtract(g_XMOne, t);
+        XMVECTOR t2 = XMVectorMultiply(t, t);
+        XMVECTOR s2 = XMVectorMultiply(s, s);
+
+        XMVECTOR b0 = XMVectorMultiply(s2, s);
+        XMVECTOR b1 = XMVectorMultiply(XMVectorMultiply(s2, t), three);
+        XMVECTOR b2 = XMVectorMultiply(XMVectorMultiply(s, t2), three);
+        XMVECTOR b3 = XMVectorMultiply(t2, t);
+
+        XMVECTOR x = XMVectorMultiply(b0, x0);
+        x = XMVectorMultiplyAdd(b1, x1, x);
+        x = XMVectorMultiplyAdd(b2, x2, x);
+        x = XMVectorMultiplyAdd(b3, x3, x);
+
+        XMVECTOR y = XMVectorMultiply(b0, y0);
+        y = XMVectorMultiplyAdd(b1, y1, y);
+        y = XMVectorMultiplyAdd(b2, y2, y);
+        y = XMVectorMultiplyAdd(b3, y3, y);
+
+        XMFLOAT4 xs, ys;
+        XMStoreFloat4(&xs, x);
+        XMStoreFloat4(&ys, y);
+
+        for (uint32_t j = 0; j < batchSize; ++j)
+        {
+            positions[i + j] = Vector2{ (&xs.x)[j], (&ys.x)[j] };
+        }
+    }
+}
+
+//
+// Uses Wang's formula: a cubic is within tolerance of its n-segment
+// flattening when n >= sqrt(3 / 4 * L / tolerance), where L is the largest
+// second difference of its control points.  Each direction of the patch is
+// considered separately, taking the largest second difference over all of
+// its rows (for u) or columns (for v).
+//
+
+void GradientMeshEvaluator::GetSegmentCounts(uint32_t patchIndex, float flatteningTolerance, uint32_t* uSegments, uint32_t* vSegments) const
+{
+    assert(flatteningTolerance > 0);
+
+    auto& patch = GetPatch(patchIndex);
+
+    float maxU = 0;
+    float maxV = 0;
+
+    for (int a = 0; a < 4; ++a)
+    {
+        for (int b = 0; b < 2; ++b)
+        {
+            // Along row a.
+            maxU = std::max(maxU, Length(
+                GetComponent(patch.X[a], b) - 2 * GetComponent(patch.X[a], b + 1) + GetComponent(patch.X[a], b + 2),
+                GetComponent(patch.Y[a], b) - 2 * GetComponent(patch.Y[a], b + 1) + GetComponent(patch.Y[a], b + 2)));
+
+            // Down column a.
+            maxV = std::max(maxV, Length(
+                GetComponent(patch.X[b], a) - 2 * GetComponent(patch.X[b + 1], a) + GetComponent(patch.X[b + 2], a),
+                GetComponent(patch.Y[b], a) - 2 * GetComponent(patch.Y[b + 1], a) + GetComponent(patch.Y[b + 2], a)));
+        }
+    }
+
+    auto segmentCount = [&](float maxSecondDifference)
+    {
+        float n = ceilf(sqrtf(0.75f * maxSecondDifference / flatteningTolerance));
+
+        if (!(n < MaxSegmentsPerPatch))     // Also catches NaN from non-finite control points
+            return MaxSegmentsPerPatch;
+
+        return std::max(static_cast<uint32_t>(n), 1u);
+    };
+
+    *uSegments = segmentCount(maxU);
+    *vSegments = segmentCount(maxV);
+}
+
+std::shared_ptr<GradientMeshEvaluator::Tessellation> GradientMeshEvaluator::Tessellate(float flatteningTolerance) const
+{
+    auto tessellation = std::make_shared<Tessellation>();
+
+    tessellation->FlatteningTolerance = flatteningTolerance;
+    tessellation->PatchOffsets.reserve(m_patches.size() + 1);
+
+    auto& vertices = tessellation->Vertices;
+
+    for (uint32_t patchIndex = 0; patchIndex < m_patches.size(); ++patchIndex)
+    {
+        tessellation->PatchOffsets.push_back(static_cast<uint32_t>(vertices.size()));
+
+        uint32_t uSegments, vSegments;
+        GetSegmentCounts(patchIndex, flatteningTolerance, &uSegments, &vSegments);
+
+        uint32_t columns = uSegments + 1;
+        uint32_t rows = vSegments + 1;
+
+        ScratchBuffer<float> us(columns);
+        for (uint32_t c = 0; c < columns; ++c)
+            us[c] = static_cast<float>(c) / uSegments;
+
+        ScratchBuffer<Vector2> positions(columns);
+        ScratchBuffer<CanvasGradientMeshVertex> grid(columns * rows);
+
+        auto& patch = m_patches[patchIndex];
+
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            float v = static_cast<float>(r) / vSegments;
+
+            EvaluateRow(patchIndex, v, us.GetData(), columns, positions.GetData());
+
+            XMVECTOR left = XMVectorLerp(XMLoadFloat4(&patch.Color00), XMLoadFloat4(&patch.Color30), v);
+            XMVECTOR right = XMVectorLerp(XMLoadFloat4(&patch.Color03), XMLoadFloat4(&patch.Color33), v);
+
+            for (uint32_t c = 0; c < columns; ++c)
+            {
+                auto& vertex = grid[r * columns + c];
+
+                vertex.Position = positions[c];
+                XMStoreFloat4(ReinterpretAs<XMFLOAT4*>(&vertex.Color), XMVectorLerp(left, right, us[c]));
+                vertex.PatchCoordinates = Vector2{ us[c], v };
+            }
+        }
+
+        vertices.reserve(vertices.size() + uSegments * vSegments * 6);
+
+        for (uint32_t r = 0; r < vSegments; ++r)
+        {
+            for (uint32_t c = 0; c < uSegments; ++c)
+            {
+                auto& topLeft = grid[r * columns + c];
+                auto& topRight = grid[r * columns + c + 1];
+                auto& bottomLeft = grid[(r + 1) * columns + c];
+                auto& bottomRight = grid[(r + 1) * columns + c + 1];
+
+                vertices.push_back(topLeft);
+                vertices.push_back(topRight);
+                vertices.push_back(bottomRight);
+
+                vertices.push_back(topLeft);
+                vertices.push_back(bottomRight);
+                vertices.push_back(bottomLeft);
+            }
+        }
+    }
+
+    tessellation->PatchOffsets.push_back(static_cast<uint32_t>(vertices.size()));
+
+    return tessellation;
+}
+
+// On success, returns the patch coordinates of point interpolated from the
+// triangle's vertices.  Either winding is accepted.
+static bool TriangleContainsPoint(CanvasGradientMeshVertex const* triangle, Vector2 point, Vector2* patchCoordinates)
+{
+    auto& a = triangle[0].Position;
+    auto& b = triangle[1].Position;
+    auto& c = triangle[2].Position;
+
+    float determinant = (b.Y - c.Y) * (a.X - c.X) + (c.X - b.X) * (a.Y - c.Y);
+
+    if (determinant == 0)
+        return false;
+
+    float l1 = ((b.Y - c.Y) * (point.X - c.X) + (c.X - b.X) * (point.Y - c.Y)) / determinant;
+    float l2 = ((c.Y - a.Y) * (point.X - c.X) + (a.X - c.X) * (point.Y - c.Y)) / determinant;
+    float l3 = 1 - l1 - l2;
+
+    // Allow a little slack so that points on shared edges aren't missed.
+    float const epsilon = 1e-5f;
+
+    if (l1 < -epsilon || l2 < -epsilon || l3 < -epsilon)
+        return false;
+
+    auto& uv1 = triangle[0].PatchCoordinates;
+    auto& uv2 = triangle[1].PatchCoordinates;
+    auto& uv3 = triangle[2].PatchCoordinates;
+
+    *patchCoordinates = Vector2{
+        Clamp01(l1 * uv1.X + l2 * uv2.X + l3 * uv3.X),
+        Clamp01(l1 * uv1.Y + l2 * uv2.Y + l3 * uv3.Y) };
+
+    return true;
+}
+
+bool GradientMeshEvaluator::HitTest(
+    Tessellation const& tessellation,
+    Vector2 point,
+    uint32_t* patchIndex,
+    Vector2* patchCoordinates) const
+{
+    assert(tessellation.PatchOffsets.size() == m_patches.size() + 1);
+
+    auto& vertices = tessellation.Vertices;
+    auto& offsets = tessellation.PatchOffsets;
+
+    // Later patches are drawn over earlier ones, so search from the last.
+    for (uint32_t i = GetPatchCount(); i-- > 0; )
+    {
+        auto& patch = m_patches[i];
+
+        // The tessellation lies within the control point bounds.
+        if (!RectContainsPoint(patch.Bounds, point))
+            continue;
+
+        for (uint32_t j = offsets[i]; j < offsets[i + 1]; j += 3)
+        {
+            Vector2 estimate;
+
+            if (TriangleContainsPoint(&vertices[j], point, &estimate))
+            {
+                *patchIndex = i;
+                *patchCoordinates = RefinePatchCoordinates(patch, point, estimate);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//
+// A few Newton iterations on S(u, v) - point = 0 turn the piecewise-linear
+// estimate into coordinates on the surface itself.  The estimate is kept if
+// the iterations don't improve on it (eg. near folds in the patch).
+//
+
+Vector2 GradientMeshEvaluator::RefinePatchCoordinates(Patch const& patch, Vector2 point, Vector2 estimate) const
+{
+    auto residual = [&](Vector2 uv)
+    {
+        auto position = Evaluate(patch, BernsteinWeights(uv.Y), BernsteinWeights(uv.X));
+        return Length(position.X - point.X, position.Y - point.Y);
+    };
+
+    Vector2 best = estimate;
+    float bestResidual = residual(estimate);
+
+    float u = estimate.X;
+    float v = estimate.Y;
+
+    for (int iteration = 0; iteration < 4 && bestResidual > 0; ++iteration)
+    {
+        XMVECTOR uWeights = BernsteinWeights(u);
+        XMVECTOR vWeights = BernsteinWeights(v);
+
+        auto s = Evaluate(patch, vWeights, uWeights);
+        auto su = Evaluate(patch, vWeights, BernsteinDerivativeWeights(u));
+        auto sv = Evaluate(patch, BernsteinDerivativeWeights(v), uWeights);
+
+        float rx = s.X - point.X;
+        float ry = s.Y - point.Y;
+
+        float determinant = su.X * sv.Y - su.Y * sv.X;
+
+        if (fabsf(determinant) < 1e-12f)
+            break;
+
+        float du = (rx * sv.Y - ry * sv.X) / determinant;
+        float dv = (su.X * ry - su.Y * rx) / determinant;
+
+        u = Clamp01(u - du);
+        v = Clamp01(v - dv);
+
+        float r = residual(Vector2{ u, v });
+
+        if (r < bestResidual)
+        {
+            best = Vector2{ u, v };
+            bestResidual = r;
+        }
+
+        if (fabsf(du) + fabsf(dv) < 1e-6f)
+            break;
+    }
+
+    return best;
+}
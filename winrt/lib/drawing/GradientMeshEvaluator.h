@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    using namespace Numerics;
+
+    //
+    // CPU-side evaluation of the patches that make up a gradient mesh, so that
+    // bounds, hit-testing and tessellation can be answered without going
+    // through a device context.
+    //
+    // Each patch is a bicubic Bezier surface S(u, v), where u runs from the
+    // PointX0 column to the PointX3 column and v runs from the Point0X row to
+    // the Point3X row.  Colors are interpolated bilinearly in (u, v) from the
+    // four corner colors.
+    //
+    // Control points are stored as rows of four floats so that they can be
+    // processed with DirectXMath, which evaluates four samples at a time.
+    //
+    // Instances are immutable once constructed, and so may be shared between
+    // threads.
+    //
+    class GradientMeshEvaluator
+    {
+    public:
+        struct Tessellation
+        {
+            float FlatteningTolerance;
+
+            // A triangle list: each three vertices form a triangle.
+            std::vector<CanvasGradientMeshVertex> Vertices;
+
+            // The vertices generated for patch i are in the range
+            // [PatchOffsets[i], PatchOffsets[i + 1]).
+            std::vector<uint32_t> PatchOffsets;
+        };
+
+        // Limits the work done for very small tolerances or very large patches.
+        static uint32_t const MaxSegmentsPerPatch = 64;
+
+        explicit GradientMeshEvaluator(std::vector<D2D1_GRADIENT_MESH_PATCH> const& patches);
+
+        uint32_t GetPatchCount() const;
+
+        // The bounds of the control points.  Since each patch lies within the
+        // convex hull of its control points these always contain the mesh,
+        // and are exact for meshes whose edges are straight lines.  A mesh
+        // with no patches has empty bounds at the origin.
+        D2D1_RECT_F GetBounds() const;
+        D2D1_RECT_F GetBounds(D2D1_MATRIX_3X2_F const& transform) const;
+
+        Vector2 EvaluatePosition(uint32_t patchIndex, float u, float v) const;
+        Vector4 EvaluateColor(uint32_t patchIndex, float u, float v) const;
+
+        // Evaluates positions for count values of u along the same v.
+        void EvaluateRow(uint32_t patchIndex, float v, float const* u, uint32_t count, Vector2* positions) const;
+
+        // Number of segments needed in each direction for the flattened patch
+        // to be within flatteningTolerance of the surface.
+        void GetSegmentCounts(uint32_t patchIndex, float flatteningTolerance, uint32_t* uSegments, uint32_t* vSegments) const;
+
+        std::shared_ptr<Tessellation> Tessellate(float flatteningTolerance) const;
+
+        // Finds the topmost patch containing point, using the tessellation
+        // for the initial estimate and refining (u, v) against the surface.
+        bool HitTest(
+            Tessellation const& tessellation,
+            Vector2 point,
+            uint32_t* patchIndex,
+            Vector2* patchCoordinates) const;
+
+    private:
+        struct Patch
+        {
+            DirectX::XMFLOAT4 X[4];
+            DirectX::XMFLOAT4 Y[4];
+
+            DirectX::XMFLOAT4 Color00;
+            DirectX::XMFLOAT4 Color03;
+            DirectX::XMFLOAT4 Color30;
+            DirectX::XMFLOAT4 Color33;
+
+            D2D1_RECT_F Bounds;
+        };
+
+        std::vector<Patch> m_patches;
+        D2D1_RECT_F m_bounds;
+
+        Patch const& GetPatch(uint32_t patchIndex) const;
+
+        Vector2 RefinePatchCoordinates(Patch const& patch, Vector2 point, Vector2 estimate) const;
+    };
+}}}}}
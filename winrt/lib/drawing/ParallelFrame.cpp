@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "ParallelFrame.h"
+#include "images/CanvasCommandList.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // WorkStealingJobQueue
+    //
+
+    WorkStealingJobQueue::WorkStealingJobQueue(uint32_t workerCount, uint32_t jobCount)
+    {
+        assert(workerCount > 0);
+
+        m_ranges.reserve(workerCount);
+
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            auto range = std::make_unique<WorkerRange>();
+
+            range->Begin = static_cast<uint32_t>(static_cast<uint64_t>(jobCount) * i / workerCount);
+            range->End = static_cast<uint32_t>(static_cast<uint64_t>(jobCount) * (i + 1) / workerCount);
+
+            m_ranges.push_back(std::move(range));
+        }
+    }
+
+
+    bool WorkStealingJobQueue::TryTakeJob(uint32_t workerIndex, uint32_t* jobIndex)
+    {
+        auto& range = *m_ranges[workerIndex];
+
+        for (;;)
+        {
+            {
+                Lock lock(range.Mutex);
+
+                if (range.Begin < range.End)
+                {
+                    *jobIndex = range.Begin++;
+                    return true;
+                }
+            }
+
+            if (!TrySteal(workerIndex))
+                return false;
+        }
+    }
+
+
+    bool WorkStealingJobQueue::TrySteal(uint32_t workerIndex)
+    {
+        auto workerCount = GetWorkerCount();
+
+        for (uint32_t i = 1; i < workerCount; ++i)
+        {
+            auto& victim = *m_ranges[(workerIndex + i) % workerCount];
+
+            uint32_t stolenBegin;
+            uint32_t stolenEnd;
+
+            {
+                Lock lock(victim.Mutex);
+
+                auto remaining = victim.End - victim.Begin;
+
+                if (remaining == 0)
+                    continue;
+
+                // Take the half furthest away from where the victim is working.
+                auto count = (remaining + 1) / 2;
+
+                stolenEnd = victim.End;
+                stolenBegin = victim.End - count;
+                victim.End = stolenBegin;
+            }
+
+            auto& range = *m_ranges[workerIndex];
+
+            Lock lock(range.Mutex);
+            range.Begin = stolenBegin;
+            range.End = stolenEnd;
+
+            return true;
+        }
+
+        return false;
+    }
+
+
+    void RunWorkStealingJobs(
+        uint32_t workerCount,
+        uint32_t jobCount,
+        std::function<void(uint32_t workerIndex, uint32_t jobIndex)> const& runJob)
+    {
+        if (jobCount == 0)
+            return;
+
+        workerCount = std::max(1u, std::min(workerCount, jobCount));
+
+        WorkStealingJobQueue queue(workerCount, jobCount);
+
+        std::atomic<bool> failed(false);
+        std::mutex exceptionMutex;
+        std::exception_ptr firstException;
+
+        auto runWorker = [&] (uint32_t workerIndex)
+        {
+            try
+            {
+                uint32_t jobIndex;
+
+                while (!failed && queue.TryTakeJob(workerIndex, &jobIndex))
+                {
+                    runJob(workerIndex, jobIndex);
+                }
+            }
+            catch (...)
+            {
+                Lock lock(exceptionMutex);
+
+                if (!firstException)
+                    firstException = std::current_exception();
+
+                failed = true;
+            }
+        };
+
+        if (workerCount > 1)
+        {
+            //
+            // The other workers run on the process thread pool, which keeps
+            // its threads around from one frame to the next.  Each callback
+            // picks the next worker index.  If the pool is slow to start some
+            // of them, the workers that are running steal their jobs, so the
+            // callbacks that start late simply find nothing left to do.
+            //
+            std::atomic<uint32_t> nextWorkerIndex(1);
+
+            auto startWorker = [&] { runWorker(nextWorkerIndex++); };
+            typedef decltype(startWorker) StartWorker;
+
+            auto work = CreateThreadpoolWork(
+                [] (PTP_CALLBACK_INSTANCE, void* context, PTP_WORK)
+                {
+                    (*static_cast<StartWorker*>(context))();
+                },
+                &startWorker,
+                nullptr);
+
+            if (!work)
+                ThrowHR(HRESULT_FROM_WIN32(GetLastError()));
+
+            // Make sure every callback has finished before the state they
+            // refer to goes out of scope.
+            auto closeWork = MakeScopeWarden(
+                [&]
+                {
+                    WaitForThreadpoolWorkCallbacks(work, FALSE);
+                    CloseThreadpoolWork(work);
+                });
+
+            for (uint32_t i = 1; i < workerCount; ++i)
+            {
+                SubmitThreadpoolWork(work);
+            }
+
+            runWorker(0);
+        }
+        else
+        {
+            runWorker(0);
+        }
+
+        if (firstException)
+            std::rethrow_exception(firstException);
+    }
+
+
+    uint32_t GetDefaultParallelWorkerCount(uint32_t jobCount)
+    {
+        auto processorCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+        return std::max(1u, std::min(processorCount, jobCount));
+    }
+
+
+    //
+    // ParallelFrame
+    //
+
+    ParallelFrame::ParallelFrame(ICanvasDevice* device, uint32_t partCount)
+    {
+        CheckInPointer(device);
+
+        if (partCount == 0)
+            ThrowHR(E_INVALIDARG);
+
+        m_commandLists.reserve(partCount);
+        m_drawingSessions.reserve(partCount);
+
+        //
+        // Each drawing session leases its own device context from the
+        // device, which is what allows the parts to be recorded concurrently.
+        //
+        for (uint32_t i = 0; i < partCount; ++i)
+        {
+            auto commandList = CanvasCommandList::CreateNew(device);
+
+            ComPtr<ICanvasDrawingSession> drawingSession;
+            ThrowIfFailed(commandList->CreateDrawingSession(&drawingSession));
+
+            m_commandLists.push_back(std::move(commandList));
+            m_drawingSessions.push_back(std::move(drawingSession));
+        }
+    }
+
+
+    ParallelFrame::~ParallelFrame()
+    {
+        // Errors from ending the drawing sessions can't be reported from a destructor.
+        for (auto& drawingSession : m_drawingSessions)
+        {
+            if (drawingSession)
+                As<IClosable>(drawingSession)->Close();
+        }
+    }
+
+
+    ICanvasDrawingSession* ParallelFrame::GetDrawingSession(uint32_t partIndex) const
+    {
+        if (partIndex >= GetPartCount())
+            ThrowHR(E_BOUNDS);
+
+        if (m_drawingSessions.empty())
+            ThrowHR(RO_E_CLOSED);
+
+        return m_drawingSessions[partIndex].Get();
+    }
+
+
+    void ParallelFrame::RecordLayers(
+        std::function<void(ICanvasDrawingSession* drawingSession, uint32_t layerIndex)> const& drawLayer,
+        uint32_t workerCount)
+    {
+        auto partCount = GetPartCount();
+
+        if (workerCount == 0)
+            workerCount = GetDefaultParallelWorkerCount(partCount);
+
+        RunWorkStealingJobs(workerCount, partCount,
+            [&] (uint32_t, uint32_t layerIndex)
+            {
+                drawLayer(GetDrawingSession(layerIndex), layerIndex);
+            });
+    }
+
+
+    void ParallelFrame::RecordTiles(
+        Rect const& bounds,
+        Size const& tileSize,
+        std::function<void(ICanvasDrawingSession* drawingSession, Rect const& tile)> const& drawTile)
+    {
+        if (!(tileSize.Width > 0) || !(tileSize.Height > 0))
+            ThrowHR(E_INVALIDARG);
+
+        if (!std::isfinite(bounds.X) || !std::isfinite(bounds.Y) || !std::isfinite(bounds.Width) || !std::isfinite(bounds.Height))
+            ThrowHR(E_INVALIDARG);
+
+        if (!(bounds.Width > 0) || !(bounds.Height > 0))
+            return;
+
+        // An infinite tile size gives a single tile in that direction.
+        auto columns = std::max(1.0, std::ceil(static_cast<double>(bounds.Width) / tileSize.Width));
+        auto rows = std::max(1.0, std::ceil(static_cast<double>(bounds.Height) / tileSize.Height));
+
+        if (columns * rows > MaxTileCount)
+            ThrowHR(E_INVALIDARG);
+
+        auto columnCount = static_cast<uint32_t>(columns);
+        auto rowCount = static_cast<uint32_t>(rows);
+
+        RunWorkStealingJobs(GetPartCount(), columnCount * rowCount,
+            [&] (uint32_t workerIndex, uint32_t tileIndex)
+            {
+                auto column = tileIndex % columnCount;
+                auto row = tileIndex / columnCount;
+
+                // The first tile in each direction starts at the edge of
+                // bounds, which also avoids 0 * infinity for infinite tiles.
+                auto left = column ? bounds.X + column * tileSize.Width : bounds.X;
+                auto top = row ? bounds.Y + row * tileSize.Height : bounds.Y;
+
+                Rect tile
+                {
+                    left,
+                    top,
+                    std::min(tileSize.Width, bounds.X + bounds.Width - left),
+                    std::min(tileSize.Height, bounds.Y + bounds.Height - top)
+                };
+
+                auto drawingSession = GetDrawingSession(workerIndex);
+
+                //
+                // The clip is aliased so that it snaps to whole pixels.
+                // Neighbouring tiles then cover each pixel along their shared
+                // edge exactly once, where antialiased clips would each
+                // partially cover it and leave a visible seam.
+                //
+                auto deviceContext = GetWrappedResource<ID2D1DeviceContext1>(drawingSession);
+                auto clipRect = ToD2DRect(tile);
+
+                deviceContext->PushAxisAlignedClip(&clipRect, D2D1_ANTIALIAS_MODE_ALIASED);
+
+                auto popClip = MakeScopeWarden([&] { deviceContext->PopAxisAlignedClip(); });
+
+                drawTile(drawingSession, tile);
+            });
+    }
+
+
+    void ParallelFrame::Composite(ICanvasDrawingSession* target)
+    {
+        CheckInPointer(target);
+
+        if (m_drawingSessions.empty())
+            ThrowHR(RO_E_CLOSED);
+
+        CloseDrawingSessions();
+
+        for (auto& commandList : m_commandLists)
+        {
+            ThrowIfFailed(target->DrawImageAtOrigin(As<ICanvasImage>(commandList).Get()));
+        }
+    }
+
+
+    void ParallelFrame::CloseDrawingSessions()
+    {
+        auto drawingSessions = std::move(m_drawingSessions);
+        m_drawingSessions.clear();
+
+        for (auto& drawingSession : drawingSessions)
+        {
+            ThrowIfFailed(As<IClosable>(drawingSession)->Close());
+        }
+    }
+}}}}
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+    using namespace ABI::Windows::Foundation;
+
+    class CanvasCommandList;
+
+    //
+    // Hands out job indices to a fixed number of workers.  Each worker starts
+    // with a contiguous range of jobs (so that neighbouring tiles tend to be
+    // processed by the same worker) and, once that is exhausted, steals half
+    // of the remaining jobs from the end of another worker's range.
+    //
+    class WorkStealingJobQueue
+    {
+        struct WorkerRange
+        {
+            std::mutex Mutex;
+            uint32_t Begin;
+            uint32_t End;
+        };
+
+        std::vector<std::unique_ptr<WorkerRange>> m_ranges;
+
+    public:
+        WorkStealingJobQueue(uint32_t workerCount, uint32_t jobCount);
+
+        WorkStealingJobQueue(WorkStealingJobQueue const&) = delete;
+        WorkStealingJobQueue& operator=(WorkStealingJobQueue const&) = delete;
+
+        uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_ranges.size()); }
+
+        bool TryTakeJob(uint32_t workerIndex, uint32_t* jobIndex);
+
+    private:
+        bool TrySteal(uint32_t workerIndex);
+    };
+
+
+    //
+    // Runs jobCount jobs across workerCount workers.  One worker is the
+    // calling thread and the rest run on the thread pool.  If any job throws,
+    // workers stop taking new jobs and the first exception is rethrown once
+    // all workers have finished.
+    //
+    void RunWorkStealingJobs(
+        uint32_t workerCount,
+        uint32_t jobCount,
+        std::function<void(uint32_t workerIndex, uint32_t jobIndex)> const& runJob);
+
+    uint32_t GetDefaultParallelWorkerCount(uint32_t jobCount);
+
+
+    //
+    // Records a single frame on several threads at once.  Each part of the
+    // frame is a CanvasCommandList with its own drawing session, and so its
+    // own device context, which lets worker threads submit drawing commands
+    // concurrently.  Composite then draws the parts into the real target in
+    // part index order.
+    //
+    // A drawing session must only be used by one thread at a time.
+    // RecordLayers and RecordTiles take care of that: layers map one-to-one
+    // onto parts, while tiles are drawn into the part belonging to whichever
+    // worker picked them up.  Each tile is clipped to its own rectangle,
+    // snapped to whole pixels, so tiles never overlap and the order in which
+    // they are composited does not affect the result.
+    //
+    class ParallelFrame
+    {
+        std::vector<ComPtr<CanvasCommandList>> m_commandLists;
+        std::vector<ComPtr<ICanvasDrawingSession>> m_drawingSessions;
+
+    public:
+        ParallelFrame(ICanvasDevice* device, uint32_t partCount);
+        ~ParallelFrame();
+
+        ParallelFrame(ParallelFrame const&) = delete;
+        ParallelFrame& operator=(ParallelFrame const&) = delete;
+
+        uint32_t GetPartCount() const { return static_cast<uint32_t>(m_commandLists.size()); }
+
+        ICanvasDrawingSession* GetDrawingSession(uint32_t partIndex) const;
+
+        //
+        // Calls drawLayer once for each part, on up to workerCount threads
+        // (0 picks a count based on the number of processors).
+        //
+        void RecordLayers(
+            std::function<void(ICanvasDrawingSession* drawingSession, uint32_t layerIndex)> const& drawLayer,
+            uint32_t workerCount = 0);
+
+        // Each tile is a separate layer, so there is no point having more
+        // tiles than could sensibly be drawn in one frame.
+        static uint32_t const MaxTileCount = 65536;
+
+        //
+        // Splits bounds into tiles of tileSize and calls drawTile for each of
+        // them, with one worker per part.  Fails if bounds is not finite or
+        // would be split into more than MaxTileCount tiles.
+        //
+        void RecordTiles(
+            Rect const& bounds,
+            Size const& tileSize,
+            std::function<void(ICanvasDrawingSession* drawingSession, Rect const& tile)> const& drawTile);
+
+        //
+        // Ends all of the part drawing sessions and draws the parts, in
+        // order, into target.  The frame cannot be drawn to afterwards.
+        //
+        void Composite(ICanvasDrawingSession* target);
+
+    private:
+        void CloseDrawingSessions();
+    };
+}}}}
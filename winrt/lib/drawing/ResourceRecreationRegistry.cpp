@@ -0,0 +1,203 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "ResourceRecreationRegistry.h"
+#include "ParallelFrame.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    static size_t const MinimumPruneThreshold = 64;
+
+
+    ResourceRecreationRegistry::ResourceRecreationRegistry()
+        : m_backingMemorySize(0)
+        , m_pruneThreshold(MinimumPruneThreshold)
+    {
+    }
+
+
+    void ResourceRecreationRegistry::Register(IUnknown* wrapper, uint64_t backingSize, CreateFunction&& create)
+    {
+        AddEntry(Entry{ AsWeak(wrapper), backingSize, std::move(create) });
+    }
+
+
+    void ResourceRecreationRegistry::AddEntry(Entry&& entry)
+    {
+        Lock lock(m_mutex);
+
+        if (m_entries.size() >= m_pruneThreshold)
+        {
+            RemoveDeadEntries();
+            m_pruneThreshold = std::max(MinimumPruneThreshold, m_entries.size() * 2);
+        }
+
+        m_backingMemorySize += entry.BackingSize;
+        m_entries.push_back(std::move(entry));
+    }
+
+
+    uint64_t ResourceRecreationRegistry::GetBackingMemorySize()
+    {
+        Lock lock(m_mutex);
+
+        RemoveDeadEntries();
+
+        return m_backingMemorySize;
+    }
+
+
+    uint32_t ResourceRecreationRegistry::GetResourceCount()
+    {
+        Lock lock(m_mutex);
+
+        RemoveDeadEntries();
+
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+
+    static bool IsAlive(WeakRef& weakRef)
+    {
+        ComPtr<IInspectable> wrapper;
+        return SUCCEEDED(weakRef.As(&wrapper)) && wrapper;
+    }
+
+
+    void ResourceRecreationRegistry::RemoveDeadEntries()
+    {
+        auto firstDead = std::partition(m_entries.begin(), m_entries.end(),
+            [] (Entry& entry)
+            {
+                return IsAlive(entry.Wrapper);
+            });
+
+        for (auto it = firstDead; it != m_entries.end(); ++it)
+        {
+            m_backingMemorySize -= it->BackingSize;
+        }
+
+        m_entries.erase(firstDead, m_entries.end());
+    }
+
+
+    static ComPtr<ICanvasLock> LockDevice(ICanvasDevice* device)
+    {
+        ComPtr<ICanvasLock> lock;
+        auto hr = device->Lock(&lock);
+
+        // Nothing can be using the resources of a device that was closed.
+        if (hr != RO_E_CLOSED)
+            ThrowIfFailed(hr);
+
+        return lock;
+    }
+
+
+    template<typename JOBS>
+    static void SwitchResourcesToDevice(ICanvasDevice* lostDevice, ICanvasDevice* newDevice, JOBS& jobs)
+    {
+        auto lostDeviceLock = LockDevice(lostDevice);
+        auto newDeviceLock = LockDevice(newDevice);
+
+        // The old resources are released once every wrapper has switched
+        // over, while the locks are still held.
+        std::vector<ComPtr<IUnknown>> oldResources;
+        oldResources.reserve(jobs.size());
+
+        for (auto& job : jobs)
+        {
+            if (!job.NewResource)
+                continue;
+
+            oldResources.push_back(job.Recreatable->SwitchToDevice(newDevice, job.NewResource.Get()));
+            job.Switched = true;
+        }
+    }
+
+
+    void ResourceRecreationRegistry::RecreateResources(ICanvasDevice* lostDevice, ICanvasDevice* newDevice, ResourceRecreationRegistry* newRegistry)
+    {
+        std::vector<Entry> entries;
+
+        {
+            Lock lock(m_mutex);
+            entries.swap(m_entries);
+            m_backingMemorySize = 0;
+        }
+
+        struct Job
+        {
+            Entry* Source;
+            ComPtr<IInspectable> Wrapper;
+            ComPtr<ICanvasResourceRecreatable> Recreatable;
+            ComPtr<IUnknown> NewResource;
+            bool Switched;
+        };
+
+        // Entries for wrappers that have been released or closed are dropped.
+        std::vector<Job> jobs;
+        jobs.reserve(entries.size());
+
+        for (auto& entry : entries)
+        {
+            ComPtr<IInspectable> wrapper;
+
+            if (FAILED(entry.Wrapper.As(&wrapper)) || !wrapper)
+                continue;
+
+            auto recreatable = As<ICanvasResourceRecreatable>(wrapper);
+
+            if (!recreatable->IsRecreatable())
+                continue;
+
+            jobs.push_back(Job{ &entry, wrapper, recreatable, nullptr, false });
+        }
+
+        auto jobCount = static_cast<uint32_t>(jobs.size());
+
+        std::exception_ptr error;
+
+        try
+        {
+            // D2D resources can be created from any thread on a multithreaded
+            // factory.  The workers leave the wrappers alone.
+            RunWorkStealingJobs(
+                GetDefaultParallelWorkerCount(jobCount),
+                jobCount,
+                [&] (uint32_t, uint32_t jobIndex)
+                {
+                    auto& job = jobs[jobIndex];
+
+                    job.NewResource = job.Source->Create(job.Wrapper.Get(), newDevice);
+                });
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        try
+        {
+            SwitchResourcesToDevice(lostDevice, newDevice, jobs);
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+
+        for (auto& job : jobs)
+        {
+            auto registry = job.Switched ? newRegistry : this;
+            registry->AddEntry(std::move(*job.Source));
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+}}}}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Implemented by resource wrappers that can be moved onto a new device
+    // after device loss.
+    //
+    class __declspec(uuid("96AA1FB8-D093-4719-9DC0-FBFAC574AADF"))
+    ICanvasResourceRecreatable : public IUnknown
+    {
+    public:
+        // False once the wrapper has been closed.
+        virtual bool IsRecreatable() = 0;
+
+        // Switches the wrapper over to newResource, which is the same type
+        // of D2D resource as the one it wraps now, created on newDevice, and
+        // returns the old resource.  The resource is swapped in one step (see
+        // ResourceWrapper::ExchangeResource).  The caller holds the lock of
+        // both devices, and keeps the old device and resource alive until it
+        // has released them.
+        virtual ComPtr<IUnknown> SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource) = 0;
+    };
+
+
+    //
+    // Opt-in list of the resources created on a device that can be rebuilt
+    // on a new device after device loss, without the app having to recreate
+    // them itself.
+    //
+    // Each entry holds a weak reference to a resource wrapper, along with a
+    // function that creates a replacement D2D resource on a given device.
+    // Resources created from in-memory data keep a CPU-side copy of that data
+    // in their function; BackingSize records how much memory it uses.
+    // Entries whose wrappers have been released are dropped lazily.
+    //
+    class ResourceRecreationRegistry
+    {
+    public:
+        typedef std::function<ComPtr<IUnknown>(IUnknown* wrapper, ICanvasDevice* newDevice)> CreateFunction;
+
+    private:
+        struct Entry
+        {
+            WeakRef Wrapper;
+            uint64_t BackingSize;
+            CreateFunction Create;
+        };
+
+        std::mutex m_mutex;
+        std::vector<Entry> m_entries;
+        uint64_t m_backingMemorySize;
+
+        // Dead entries are pruned whenever the list has doubled in size since
+        // the last time, so registration stays amortized O(1).
+        size_t m_pruneThreshold;
+
+    public:
+        ResourceRecreationRegistry();
+
+        ResourceRecreationRegistry(ResourceRecreationRegistry const&) = delete;
+        ResourceRecreationRegistry& operator=(ResourceRecreationRegistry const&) = delete;
+
+        void Register(IUnknown* wrapper, uint64_t backingSize, CreateFunction&& create);
+
+        // Total size of the CPU-side copies held for live resources.
+        uint64_t GetBackingMemorySize();
+
+        uint32_t GetResourceCount();
+
+        //
+        // Rebuilds every live, open resource on newDevice, and moves their
+        // entries into newRegistry so that they can be recovered again if
+        // newDevice is lost in turn.
+        //
+        // The new D2D resources are created in parallel, but are only
+        // swapped into their wrappers afterwards, on the calling thread,
+        // while holding the lock of both lostDevice and newDevice.  Threads
+        // that use the wrappers under CanvasDevice.Lock therefore never see
+        // a resource change underneath them.
+        //
+        // If any resource fails to rebuild, the ones that weren't moved stay
+        // registered here and the first error is rethrown.
+        //
+        void RecreateResources(ICanvasDevice* lostDevice, ICanvasDevice* newDevice, ResourceRecreationRegistry* newRegistry);
+
+    private:
+        void AddEntry(Entry&& entry);
+        void RemoveDeadEntries();
+    };
+}}}}
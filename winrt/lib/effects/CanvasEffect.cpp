@@ -8,6 +8,9 @@
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Effects 
 {
+    std::atomic<uint64_t> CanvasEffect::s_nextBoundsGeneration(0);
+
+
     CanvasEffect::CanvasEffect(IID const& effectId, unsigned int propertiesSize, unsigned int sourcesSize, bool isSourcesSizeFixed, ICanvasDevice* device, ID2D1Effect* effect, IInspectable* outerInspectable)
         : ResourceWrapper(effect, outerInspectable)
         , m_closed(false)
@@ -17,6 +20,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         , m_sources(sourcesSize)
         , m_cacheOutput(false)
         , m_bufferPrecision(D2D1_BUFFER_PRECISION_UNKNOWN)
+        , m_boundsGeneration(++s_nextBoundsGeneration)
+        , m_insideGetBoundsGeneration(false)
     {
         // If this effect has a variable number of inputs, expose them as an IVector<>.
         if (!isSourcesSizeFixed)
@@ -146,6 +151,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         return IsEqualGUID(effectId, CLSID_PixelShaderEffect);
     }
 
+    EffectBoundsRule CanvasEffect::GetBoundsRule(REFIID effectId)
+    {
+        for (auto boundsRule = m_boundsRules; !IsEqualGUID(boundsRule->first, GUID_NULL); boundsRule++)
+        {
+            if (IsEqualGUID(boundsRule->first, effectId))
+            {
+                return boundsRule->second;
+            }
+        }
+
+        return EffectBoundsRule::Unknown;
+    }
+
 
     //
     // ICanvasImage
@@ -271,6 +289,60 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     }
 
 
+    uint64_t CanvasEffect::GetBoundsGeneration()
+    {
+        if (m_closed)
+            return 0;
+
+        //
+        // A cyclic graph has no meaningful bounds; let GetD2DImage report the
+        // error.  This also returns 0 if another thread is walking the graph
+        // at the same time, which just means the bounds won't be cached.
+        //
+        if (m_insideGetBoundsGeneration.exchange(true))
+            return 0;
+
+        auto clearFlagWarden = MakeScopeWarden([&] { m_insideGetBoundsGeneration = false; });
+
+        uint64_t generation = m_boundsGeneration;
+
+        auto sourceCount = GetSourceCount();
+
+        for (unsigned int i = 0; i < sourceCount; ++i)
+        {
+            auto source = GetSource(i);
+
+            if (!source)
+                continue;
+
+            //
+            // Sources that aren't Win2D images (eg. custom ICanvasImageInterop
+            // implementations) can change without us knowing, so any graph
+            // containing one is never cached.
+            //
+            auto sourceInternal = MaybeAs<ICanvasImageInternal>(source);
+
+            if (!sourceInternal)
+                return 0;
+
+            auto sourceGeneration = sourceInternal->GetBoundsGeneration();
+
+            if (!sourceGeneration)
+                return 0;
+
+            generation = std::max(generation, sourceGeneration);
+        }
+
+        return generation;
+    }
+
+
+    void CanvasEffect::IncrementBoundsGeneration()
+    {
+        m_boundsGeneration = ++s_nextBoundsGeneration;
+    }
+
+
     //
     // ICanvasResourceWrapperNative
     //
@@ -948,6 +1020,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     {
         auto lock = Lock(m_mutex);
 
+        IncrementBoundsGeneration();
+
         auto& d2dEffect = MaybeGetResource();
 
         if (d2dEffect)
@@ -972,6 +1046,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     void CanvasEffect::InsertSource(unsigned int index, IGraphicsEffectSource* source)
     {
         auto lock = Lock(m_mutex);
+
+        IncrementBoundsGeneration();
         
         auto& d2dEffect = MaybeGetResource();
 
@@ -1012,6 +1088,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     void CanvasEffect::RemoveSource(unsigned int index)
     {
         auto lock = Lock(m_mutex);
+
+        IncrementBoundsGeneration();
         
         auto& d2dEffect = MaybeGetResource();
 
@@ -1059,6 +1137,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     void CanvasEffect::AppendSource(IGraphicsEffectSource* source)
     {
         auto lock = Lock(m_mutex);
+
+        IncrementBoundsGeneration();
         
         auto& d2dEffect = MaybeGetResource();
 
@@ -1082,6 +1162,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     void CanvasEffect::ClearSources()
     {
         auto lock = Lock(m_mutex);
+
+        IncrementBoundsGeneration();
         
         // Effects with variable number of inputs don't allow zero of them,
         // so we must unrealize before we can clear the collection.
@@ -1405,6 +1487,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     {
         auto lock = Lock(m_mutex);
 
+        IncrementBoundsGeneration();
+
         assert(index < m_properties.size());
 
         auto& d2dEffect = MaybeGetResource();
@@ -29,6 +29,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     };
 
 
+    // Metadata created by codegen, describing how an effect's output bounds
+    // can be derived from its sources and properties without involving D2D.
+    // Used by EffectBoundsEvaluator.
+    enum class EffectBoundsRule
+    {
+        Unknown,        // Bounds can only be computed by realizing the effect.
+        PassThrough,    // Same as the bounds of the first source.
+        Infinite,       // Output extends forever (eg. Border, ColorSource, Tile).
+        Transform2D,    // Source bounds transformed by the effect matrix.
+        Crop,           // Source bounds intersected with the crop rectangle.
+        GaussianBlur,   // Source bounds inflated by three standard deviations.
+        Atlas,          // Source bounds intersected with the source rectangle.
+        Union,          // Union of the bounds of all sources.
+    };
+
+
     class CanvasEffect
         : public Implements<
             RuntimeClassFlags<WinRtClassicComMix>,
@@ -65,6 +81,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         // Workaround Windows bug 6146411 (crash when reading back DESTINATION_COLOR_CONTEXT from a CLSID_D2D1ColorManagement effect).
         ComPtr<IUnknown> m_workaround6146411;
 
+        // Changes whenever a property or source that could affect our bounds
+        // is modified.  Values are taken from a global counter, so the most
+        // recently modified effect in a graph always has the largest value.
+        std::atomic<uint64_t> m_boundsGeneration;
+        std::atomic<bool> m_insideGetBoundsGeneration;
+        ImageBoundsCache m_boundsCache;
+
+        static std::atomic<uint64_t> s_nextBoundsGeneration;
+
 
         // State tracking the effect source images. This data is authoritative when
         // the effect is not realized - otherwise just a cache to speed reverse lookups.
@@ -124,6 +149,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         static std::pair<IID, MakeEffectFunction> m_effectMakers[];
 
+        // Generated table of bounds rules, terminated by GUID_NULL.
+        static std::pair<IID, EffectBoundsRule> m_boundsRules[];
+
 
     protected:
         // Constructor.
@@ -144,6 +172,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         // Used by ResourceManager (in GetOrCreate and to register effect factories).
         static bool TryCreateEffect(ICanvasDevice* device, IUnknown* resource, float dpi, ComPtr<IInspectable>* result);
         static bool IsWin2DEffectId(REFIID effectId);
+
+        // Used by EffectBoundsEvaluator.
+        static EffectBoundsRule GetBoundsRule(REFIID effectId);
             
         //
         // ICanvasImage
@@ -163,6 +194,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         //
 
         virtual ComPtr<ID2D1Image> GetD2DImage(ICanvasDevice* device, ID2D1DeviceContext* deviceContext, WIN2D_GET_D2D_IMAGE_FLAGS flags, float targetDpi, float* realizedDpi = nullptr) override;
+        virtual uint64_t GetBoundsGeneration() override;
+        virtual ImageBoundsCache* GetBoundsCache() override { return &m_boundsCache; }
 
         //
         // ICanvasResourceWrapperNative
@@ -276,6 +309,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         void ClearSources();
 
 
+        // Called by subclasses that store bounds-affecting state outside of m_properties.
+        void IncrementBoundsGeneration();
+
+        void ThrowIfClosed();
+
+
         // On-demand creation of the underlying D2D image effect.
         virtual bool Realize(WIN2D_GET_D2D_IMAGE_FLAGS flags, float targetDpi, ID2D1DeviceContext* deviceContext);
         virtual void Unrealize(unsigned int skipSourceIndex = UINT_MAX, bool skipAllSources = false);
@@ -294,8 +333,6 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<IPropertyValue> GetProperty(unsigned int index);
         ComPtr<IPropertyValue> GetD2DProperty(ID2D1Effect* d2dEffect, unsigned int index);
 
-        void ThrowIfClosed();
-
 
         // Used by EffectMakers.cpp to populate the m_effectMakers table.
         template<typename T>
@@ -509,6 +546,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         //
         // Wrap the IPropertyValue accessors (which use different method names for each type) with
         // overloaded C++ versions that can be used by generic PropertyTypeConverter implementations.
+        // The boxed values are allocated by the property value factory rather than Win2D, so their
+        // payloads are reported to the allocation tracker here.
         //
 
 #define PROPERTY_TYPE_ACCESSOR(TYPE, WINRT_NAME)                                                        \
@@ -516,6 +555,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         {                                                                                               \
             ComPtr<IPropertyValue> propertyValue;                                                       \
             ThrowIfFailed(factory->Create##WINRT_NAME(value, &propertyValue));                          \
+            AllocationTracker::RecordExternalAllocation(sizeof(TYPE));                                  \
             return propertyValue;                                                                       \
         }                                                                                               \
                                                                                                         \
@@ -529,6 +569,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         {                                                                                                                       \
             ComPtr<IPropertyValue> propertyValue;                                                                               \
             ThrowIfFailed(factory->Create##WINRT_NAME##Array(valueCount, const_cast<TYPE*>(value), &propertyValue));            \
+            AllocationTracker::RecordExternalAllocation(valueCount * sizeof(TYPE));                                             \
             return propertyValue;                                                                                               \
         }                                                                                                                       \
                                                                                                                                 \
@@ -554,6 +595,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         {
             ComPtr<IPropertyValue> propertyValue;
             ThrowIfFailed(factory->CreateInspectableArray(1, &value, &propertyValue));
+            AllocationTracker::RecordExternalAllocation(sizeof(value));
             return propertyValue;
         }
 
@@ -0,0 +1,285 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "EffectBoundsEvaluator.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Effects
+{
+    static ComPtr<IPropertyValue> GetEffectProperty(IGraphicsEffectD2D1Interop* effect, UINT index)
+    {
+        ComPtr<IPropertyValue> value;
+        ThrowIfFailed(effect->GetProperty(index, &value));
+
+        if (!value)
+            ThrowHR(E_UNEXPECTED);
+
+        return value;
+    }
+
+
+    static float GetFloatProperty(IGraphicsEffectD2D1Interop* effect, UINT index)
+    {
+        float value;
+        ThrowIfFailed(GetEffectProperty(effect, index)->GetSingle(&value));
+        return value;
+    }
+
+
+    static uint32_t GetUInt32Property(IGraphicsEffectD2D1Interop* effect, UINT index)
+    {
+        uint32_t value;
+        ThrowIfFailed(GetEffectProperty(effect, index)->GetUInt32(&value));
+        return value;
+    }
+
+
+    template<typename T>
+    static T GetFloatArrayProperty(IGraphicsEffectD2D1Interop* effect, UINT index)
+    {
+        ComArray<float> value;
+        ThrowIfFailed(GetEffectProperty(effect, index)->GetSingleArray(value.GetAddressOfSize(), value.GetAddressOfData()));
+
+        if (value.GetSize() * sizeof(float) != sizeof(T))
+            ThrowHR(E_BOUNDS);
+
+        return *reinterpret_cast<T*>(value.GetData());
+    }
+
+
+    EffectBoundsEvaluator::EffectBoundsEvaluator(FallbackFunction fallback)
+        : m_fallback(std::move(fallback))
+        , m_statistics{}
+    {
+    }
+
+
+    bool EffectBoundsEvaluator::TryGetBounds(IGraphicsEffectSource* source, D2D1_RECT_F* bounds)
+    {
+        CheckInPointer(source);
+        CheckInPointer(bounds);
+
+        return TryEvaluate(source, bounds);
+    }
+
+
+    bool EffectBoundsEvaluator::TryEvaluate(IGraphicsEffectSource* source, D2D1_RECT_F* bounds)
+    {
+        if (!source)
+            return false;
+
+        auto identity = AsUnknown(source);
+
+        auto it = m_results.find(identity.Get());
+
+        if (it != m_results.end())
+        {
+            *bounds = it->second.Bounds;
+            return it->second.Succeeded;
+        }
+
+        // A graph containing a cycle cannot be drawn, so has no bounds.
+        if (!m_nodesBeingEvaluated.insert(identity.Get()).second)
+            return false;
+
+        auto endEvaluation = MakeScopeWarden([&] { m_nodesBeingEvaluated.erase(identity.Get()); });
+
+        m_statistics.NodesEvaluated++;
+
+        D2D1_RECT_F result{};
+        bool succeeded;
+
+        if (auto effect = MaybeAs<IGraphicsEffectD2D1Interop>(source))
+        {
+            IID effectId;
+            ThrowIfFailed(effect->GetEffectId(&effectId));
+
+            auto rule = CanvasEffect::GetBoundsRule(effectId);
+
+            if (rule != EffectBoundsRule::Unknown)
+                succeeded = TryEvaluateEffect(effect.Get(), rule, &result);
+            else
+                succeeded = TryFallback(source, &result);
+        }
+        else if (auto bitmap = MaybeAs<ICanvasBitmap>(source))
+        {
+            Rect bitmapBounds;
+            ThrowIfFailed(bitmap->get_Bounds(&bitmapBounds));
+
+            result = ToD2DRect(bitmapBounds);
+            succeeded = true;
+        }
+        else
+        {
+            succeeded = TryFallback(source, &result);
+        }
+
+        m_results[identity.Get()] = Result{ identity, succeeded, result };
+
+        *bounds = result;
+        return succeeded;
+    }
+
+
+    bool EffectBoundsEvaluator::TryEvaluateEffect(IGraphicsEffectD2D1Interop* effect, EffectBoundsRule rule, D2D1_RECT_F* bounds)
+    {
+        switch (rule)
+        {
+        case EffectBoundsRule::Infinite:
+            *bounds = D2D1::InfiniteRect();
+            return true;
+
+        case EffectBoundsRule::PassThrough:
+            return TryGetSourceBounds(effect, 0, bounds);
+
+        case EffectBoundsRule::Transform2D:
+            {
+                D2D1_RECT_F sourceBounds;
+
+                if (!TryGetSourceBounds(effect, 0, &sourceBounds))
+                    return false;
+
+                auto transform = GetFloatArrayProperty<D2D1_MATRIX_3X2_F>(effect, D2D1_2DAFFINETRANSFORM_PROP_TRANSFORM_MATRIX);
+
+                *bounds = TransformRectangle(sourceBounds, transform);
+                return true;
+            }
+
+        case EffectBoundsRule::Crop:
+        case EffectBoundsRule::Atlas:
+            {
+                static_assert(D2D1_CROP_PROP_RECT == D2D1_ATLAS_PROP_INPUT_RECT, "Crop and atlas rectangles should share an index");
+
+                D2D1_RECT_F sourceBounds;
+
+                if (!TryGetSourceBounds(effect, 0, &sourceBounds))
+                    return false;
+
+                auto rect = GetFloatArrayProperty<D2D1_RECT_F>(effect, D2D1_CROP_PROP_RECT);
+
+                *bounds = RectangleIntersection(sourceBounds, rect);
+
+                if (IsEmptyRectangle(*bounds))
+                    *bounds = D2D1_RECT_F{};
+
+                return true;
+            }
+
+        case EffectBoundsRule::GaussianBlur:
+            {
+                D2D1_RECT_F sourceBounds;
+
+                if (!TryGetSourceBounds(effect, 0, &sourceBounds))
+                    return false;
+
+                // With a hard border, the blur is clipped to its input.
+                if (GetUInt32Property(effect, D2D1_GAUSSIANBLUR_PROP_BORDER_MODE) == D2D1_BORDER_MODE_HARD)
+                {
+                    *bounds = sourceBounds;
+                    return true;
+                }
+
+                auto standardDeviation = GetFloatProperty(effect, D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION);
+
+                *bounds = InflateRectangle(sourceBounds, 3 * std::max(standardDeviation, 0.0f));
+                return true;
+            }
+
+        case EffectBoundsRule::Union:
+            {
+                UINT sourceCount;
+                ThrowIfFailed(effect->GetSourceCount(&sourceCount));
+
+                D2D1_RECT_F result{};
+                bool isFirst = true;
+
+                for (UINT i = 0; i < sourceCount; i++)
+                {
+                    D2D1_RECT_F sourceBounds;
+
+                    if (!TryGetSourceBounds(effect, i, &sourceBounds))
+                        return false;
+
+                    if (IsEmptyRectangle(sourceBounds))
+                        continue;
+
+                    result = isFirst ? sourceBounds : RectangleUnion(result, sourceBounds);
+                    isFirst = false;
+                }
+
+                *bounds = result;
+                return true;
+            }
+
+        default:
+            assert(false);
+            return false;
+        }
+    }
+
+
+    bool EffectBoundsEvaluator::TryGetSourceBounds(IGraphicsEffectD2D1Interop* effect, uint32_t index, D2D1_RECT_F* bounds)
+    {
+        ComPtr<IGraphicsEffectSource> source;
+        ThrowIfFailed(effect->GetSource(index, &source));
+
+        return TryEvaluate(source.Get(), bounds);
+    }
+
+
+    bool EffectBoundsEvaluator::TryFallback(IGraphicsEffectSource* source, D2D1_RECT_F* bounds)
+    {
+        if (!m_fallback)
+            return false;
+
+        m_statistics.FallbackCount++;
+
+        return m_fallback(source, bounds);
+    }
+
+
+    bool TryGetEffectGraphBounds(
+        ICanvasResourceCreator* resourceCreator,
+        IGraphicsEffectSource* source,
+        Numerics::Matrix3x2 const& transform,
+        Rect* bounds)
+    {
+        // The CPU rules work in DIPs, as do bitmap bounds.
+        if (auto drawingSession = MaybeAs<ICanvasDrawingSession>(resourceCreator))
+        {
+            CanvasUnits units;
+            ThrowIfFailed(drawingSession->get_Units(&units));
+
+            if (units != CanvasUnits::Dips)
+                return false;
+        }
+
+        EffectBoundsEvaluator evaluator(
+            [=] (IGraphicsEffectSource* node, D2D1_RECT_F* nodeBounds)
+            {
+                Rect d2dBounds;
+
+                // Measure just this node, rather than going back through
+                // GetBounds, which would evaluate it on the CPU again.
+                if (auto imageInternal = MaybeAs<ICanvasImageInternal>(node))
+                    ThrowIfFailed(GetImageBoundsImpl(imageInternal.Get(), resourceCreator, nullptr, &d2dBounds));
+                else if (auto imageInterop = MaybeAs<ICanvasImageInterop>(node))
+                    ThrowIfFailed(GetBoundsForICanvasImageInterop(resourceCreator, imageInterop.Get(), nullptr, &d2dBounds));
+                else
+                    return false;
+
+                *nodeBounds = ToD2DRect(d2dBounds);
+                return true;
+            });
+
+        D2D1_RECT_F graphBounds;
+
+        if (!evaluator.TryGetBounds(source, &graphBounds))
+            return false;
+
+        *bounds = FromD2DRect(TransformRectangle(graphBounds, *ReinterpretAs<D2D1_MATRIX_3X2_F const*>(&transform)));
+        return true;
+    }
+}}}}}
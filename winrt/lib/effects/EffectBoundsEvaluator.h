@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Effects
+{
+    using namespace ::Microsoft::WRL;
+    using namespace ABI::Windows::Foundation;
+
+    //
+    // Computes the output bounds of an effect graph on the CPU, by walking
+    // the graph through IGraphicsEffectD2D1Interop and applying the bounds
+    // rule that codegen generated for each effect (see EffectBoundsRule).
+    // Bitmaps report their own size.  Anything else - effects without a
+    // rule, command lists, custom interop images - is handed to the
+    // fallback, which would typically measure that one node using D2D.
+    //
+    // Bounds are in the coordinate space of the graph, ie. DIPs.  Results
+    // are remembered for the lifetime of the evaluator, so nodes shared
+    // between several branches of a graph are only evaluated once.
+    //
+    class EffectBoundsEvaluator
+    {
+    public:
+        typedef std::function<bool(IGraphicsEffectSource* source, D2D1_RECT_F* bounds)> FallbackFunction;
+
+        struct Statistics
+        {
+            uint32_t NodesEvaluated;
+            uint32_t FallbackCount;
+        };
+
+    private:
+        struct Result
+        {
+            ComPtr<IUnknown> Node;  // keeps the map key alive
+            bool Succeeded;
+            D2D1_RECT_F Bounds;
+        };
+
+        FallbackFunction m_fallback;
+        std::unordered_map<IUnknown*, Result> m_results;
+        std::set<IUnknown*> m_nodesBeingEvaluated;
+        Statistics m_statistics;
+
+    public:
+        explicit EffectBoundsEvaluator(FallbackFunction fallback = nullptr);
+
+        // Returns false if the bounds of source, or of something it depends
+        // on, could not be determined.
+        bool TryGetBounds(IGraphicsEffectSource* source, D2D1_RECT_F* bounds);
+
+        Statistics const& GetStatistics() const { return m_statistics; }
+
+    private:
+        bool TryEvaluate(IGraphicsEffectSource* source, D2D1_RECT_F* bounds);
+        bool TryEvaluateEffect(IGraphicsEffectD2D1Interop* effect, EffectBoundsRule rule, D2D1_RECT_F* bounds);
+        bool TryGetSourceBounds(IGraphicsEffectD2D1Interop* effect, uint32_t index, D2D1_RECT_F* bounds);
+        bool TryFallback(IGraphicsEffectSource* source, D2D1_RECT_F* bounds);
+    };
+
+
+    //
+    // Evaluates the bounds of an effect graph for CanvasImage.EstimateBounds,
+    // using the CPU rules where possible and measuring nodes that have none
+    // with D2D.  The rules approximate D2D rather than matching it exactly
+    // (eg. Transform2D ignores the padding added by interpolation), so this
+    // must not be used where GetBounds is expected.  Returns false if the whole graph must be measured with D2D
+    // instead, eg. because resourceCreator is a drawing session that uses
+    // pixel units, or because part of the graph is missing.
+    //
+    bool TryGetEffectGraphBounds(
+        ICanvasResourceCreator* resourceCreator,
+        IGraphicsEffectSource* source,
+        Numerics::Matrix3x2 const& transform,
+        Rect* bounds);
+}}}}}
@@ -103,6 +103,34 @@ ComPtr<EffectTransferTable3D> EffectTransferTable3D::CreateNew(
     auto transferTable = Make<EffectTransferTable3D>(device.Get(), lookupTable.Get());
     CheckMakeResult(transferTable);
 
+    // If the device wants to be able to rebuild the table after device loss,
+    // give it a copy of the data.
+    auto registry = As<ICanvasDeviceInternal>(device)->GetResourceRecreationRegistry();
+
+    if (registry)
+    {
+        auto tableBytes = std::make_shared<std::vector<BYTE>>(bytes, bytes + bytesNeeded);
+
+        registry->Register(
+            As<IEffectTransferTable3D>(transferTable).Get(),
+            bytesNeeded,
+            [=] (IUnknown*, ICanvasDevice* newDevice) -> ComPtr<IUnknown>
+            {
+                auto newLease = As<ICanvasDeviceInternal>(newDevice)->GetResourceCreationDeviceContext();
+
+                ComPtr<ID2D1LookupTable3D> newLookupTable;
+                ThrowIfFailed(As<ID2D1DeviceContext2>(newLease.Get())->CreateLookupTable3D(
+                    precision,
+                    extents,
+                    tableBytes->data(),
+                    static_cast<uint32_t>(tableBytes->size()),
+                    strides,
+                    &newLookupTable));
+
+                return newLookupTable;
+            });
+    }
+
     return transferTable;
 }
 
@@ -133,6 +161,21 @@ IFACEMETHODIMP EffectTransferTable3D::get_Device(ICanvasDevice** device)
 }
 
 
+bool EffectTransferTable3D::IsRecreatable()
+{
+    return HasResource();
+}
+
+
+ComPtr<IUnknown> EffectTransferTable3D::SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource)
+{
+    auto lookupTable = As<ID2D1LookupTable3D>(newResource);
+
+    m_device = newDevice;
+    return ExchangeResource(lookupTable.Get());
+}
+
+
 IFACEMETHODIMP EffectTransferTable3DFactory::CreateFromColors(
     ICanvasResourceCreator* resourceCreator,
     uint32_t colorCount,
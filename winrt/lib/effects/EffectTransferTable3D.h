@@ -10,7 +10,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ID2D1LookupTable3D,
         EffectTransferTable3D,
         IEffectTransferTable3D,
-        CloakedIid<ICanvasResourceWrapperWithDevice>)
+        CloakedIid<ICanvasResourceWrapperWithDevice>,
+        CloakedIid<ICanvasResourceRecreatable>)
     {
         InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Effects_EffectTransferTable3D, BaseTrust);
 
@@ -39,6 +40,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         IFACEMETHOD(Close)() override;
 
         IFACEMETHOD(get_Device)(ICanvasDevice** device) override;
+
+        // ICanvasResourceRecreatable
+        virtual bool IsRecreatable() override;
+        virtual ComPtr<IUnknown> SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource) override;
     };
 
 
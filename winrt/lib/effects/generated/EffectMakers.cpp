@@ -131,3 +131,25 @@ std::pair<IID, CanvasEffect::MakeEffectFunction> CanvasEffect::m_effectMakers[]
 
     { GUID_NULL, nullptr }
 };
+
+
+std::pair<IID, EffectBoundsRule> CanvasEffect::m_boundsRules[] =
+{
+    { AtlasEffect::EffectId(),         EffectBoundsRule::Atlas },
+    { BorderEffect::EffectId(),        EffectBoundsRule::Infinite },
+    { ColorSourceEffect::EffectId(),   EffectBoundsRule::Infinite },
+    { CompositeEffect::EffectId(),     EffectBoundsRule::Union },
+    { CropEffect::EffectId(),          EffectBoundsRule::Crop },
+    { GaussianBlurEffect::EffectId(),  EffectBoundsRule::GaussianBlur },
+    { HueRotationEffect::EffectId(),   EffectBoundsRule::PassThrough },
+    { PremultiplyEffect::EffectId(),   EffectBoundsRule::PassThrough },
+    { SaturationEffect::EffectId(),    EffectBoundsRule::PassThrough },
+    { TileEffect::EffectId(),          EffectBoundsRule::Infinite },
+    { Transform2DEffect::EffectId(),   EffectBoundsRule::Transform2D },
+    { UnPremultiplyEffect::EffectId(), EffectBoundsRule::PassThrough },
+    { GrayscaleEffect::EffectId(),     EffectBoundsRule::PassThrough },
+    { InvertEffect::EffectId(),        EffectBoundsRule::PassThrough },
+    { OpacityEffect::EffectId(),       EffectBoundsRule::PassThrough },
+
+    { GUID_NULL, EffectBoundsRule::Unknown }
+};
@@ -19,9 +19,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             CheckInPointer(shaderCode);
             CheckAndClearOutPointer(effect);
 
-            // Create a shared state object using the specified shader code.
-            auto sharedState = Make<SharedShaderState>(shaderCode, shaderCodeCount);
-            CheckMakeResult(sharedState);
+            // Create a shared state object using the specified shader code,
+            // starting from a preloaded copy if there is one.  The cache only
+            // exists if something was preloaded, so don't create it here.
+            ComPtr<ISharedShaderState> sharedState;
+
+            if (auto preloadedShaders = PreloadedShaderCache::TryGetInstance())
+                sharedState = preloadedShaders->TryClone(shaderCode, shaderCodeCount);
+
+            if (!sharedState)
+            {
+                auto newSharedState = Make<SharedShaderState>(shaderCode, shaderCodeCount);
+                CheckMakeResult(newSharedState);
+
+                sharedState = newSharedState;
+            }
 
             // Create the WinRT effect instance.
             auto newEffect = Make<PixelShaderEffect>(nullptr, nullptr, sharedState.Get());
@@ -83,6 +95,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     PixelShaderEffect::PixelShaderEffect(ICanvasDevice* device, ID2D1Effect* effect, ISharedShaderState* sharedState)
         : CanvasEffect(CLSID_PixelShaderEffect, 0, sharedState->Shader().InputCount, true, device, effect, static_cast<IPixelShaderEffect*>(this))
         , m_sharedState(sharedState)
+        , m_propertyUpdateDepth(0)
+        , m_hasPendingConstants(false)
     {
         m_propertyMap = Make<PropertyMap>(true, this);
         CheckMakeResult(m_propertyMap);
@@ -306,7 +320,87 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         m_sharedState->SetProperty(name, boxedValue);
 
         // If we are realized, pass the updated constant buffer on to Direct2D.
-        SetD2DConstants();
+        OnConstantsChanged();
+    }
+
+
+    IFACEMETHODIMP PixelShaderEffect::GetPropertyHandle(HSTRING name, int* handle)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckInPointer(handle);
+            ThrowIfClosed();
+
+            *handle = static_cast<int>(m_sharedState->GetPropertyIndex(name));
+        });
+    }
+
+
+    template<typename T>
+    HRESULT PixelShaderEffect::SetPropertyByHandle(int handle, T value)
+    {
+        return ExceptionBoundary([&]
+        {
+            ThrowIfClosed();
+
+            auto lock = Lock(m_mutex);
+
+            // Handles are indices into the shader variable list, which
+            // SharedShaderState range checks along with the value type.
+            m_sharedState->SetProperty(static_cast<unsigned>(handle), value);
+
+            OnConstantsChanged();
+        });
+    }
+
+
+    IFACEMETHODIMP PixelShaderEffect::SetFloatProperty(int handle, float value)         { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetIntProperty(int handle, int value)             { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetBoolProperty(int handle, boolean value)        { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetVector2Property(int handle, Vector2 value)     { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetVector3Property(int handle, Vector3 value)     { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetVector4Property(int handle, Vector4 value)     { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetMatrix3x2Property(int handle, Matrix3x2 value) { return SetPropertyByHandle(handle, value); }
+    IFACEMETHODIMP PixelShaderEffect::SetMatrix4x4Property(int handle, Matrix4x4 value) { return SetPropertyByHandle(handle, value); }
+
+
+    IFACEMETHODIMP PixelShaderEffect::BeginPropertyUpdates(IPixelShaderEffectPropertyUpdateScope** scope)
+    {
+        return ExceptionBoundary([&]
+        {
+            CheckAndClearOutPointer(scope);
+            ThrowIfClosed();
+
+            ComPtr<PixelShaderEffect> self = this;
+
+            auto updateScope = Make<PixelShaderEffectPropertyUpdateScope>(
+                [self]
+                {
+                    self->EndPropertyUpdates();
+                });
+            CheckMakeResult(updateScope);
+
+            {
+                auto lock = Lock(m_mutex);
+                ++m_propertyUpdateDepth;
+            }
+
+            ThrowIfFailed(updateScope.CopyTo(scope));
+        });
+    }
+
+
+    void PixelShaderEffect::EndPropertyUpdates()
+    {
+        auto lock = Lock(m_mutex);
+
+        assert(m_propertyUpdateDepth > 0);
+
+        if (--m_propertyUpdateDepth == 0 && m_hasPendingConstants)
+        {
+            m_hasPendingConstants = false;
+            SetD2DConstants();
+        }
     }
 
 
@@ -334,6 +428,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             // Store the new value into our shared state object.
             m_sharedState->CoordinateMapping().Mapping[index] = value;
 
+            IncrementBoundsGeneration();
+
             // If we are realized, pass the updated mapping state on to Direct2D.
             SetD2DCoordinateMapping();
         });
@@ -364,6 +460,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             // Store the new value into our shared state object.
             m_sharedState->CoordinateMapping().BorderMode[index] = value;
 
+            IncrementBoundsGeneration();
+
             // If we are realized, pass the updated mapping state on to Direct2D.
             SetD2DCoordinateMapping();
         });
@@ -390,6 +488,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             // Store the new value into our shared state object.
             m_sharedState->CoordinateMapping().MaxOffset = value;
 
+            IncrementBoundsGeneration();
+
             // If we are realized, pass the updated mapping state on to Direct2D.
             SetD2DCoordinateMapping();
         });
@@ -432,6 +532,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     }
 
 
+    void PixelShaderEffect::OnConstantsChanged()
+    {
+        if (m_propertyUpdateDepth > 0)
+        {
+            // Inside a BeginPropertyUpdates scope, so wait until it closes.
+            m_hasPendingConstants = true;
+        }
+        else
+        {
+            SetD2DConstants();
+        }
+    }
+
+
     void PixelShaderEffect::SetD2DConstants()
     {
         auto& d2dEffect = MaybeGetResource();
@@ -22,6 +22,44 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     };
 
 
+    // Returned by PixelShaderEffect.BeginPropertyUpdates. Closing it ends the update scope.
+    // Scopes that are released without being closed end when they are destroyed, so that
+    // the effect doesn't hold back its constants forever.
+    class PixelShaderEffectPropertyUpdateScope : public RuntimeClass<IPixelShaderEffectPropertyUpdateScope, IClosable>
+                                               , private LifespanTracker<PixelShaderEffectPropertyUpdateScope>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Effects_PixelShaderEffectPropertyUpdateScope, BaseTrust);
+
+        std::function<void()> m_closeAction;
+
+    public:
+        PixelShaderEffectPropertyUpdateScope(std::function<void()>&& closeAction)
+            : m_closeAction(std::move(closeAction))
+        {
+        }
+
+        ~PixelShaderEffectPropertyUpdateScope()
+        {
+            // Ignore any errors when closing during destruction
+            (void)Close();
+        }
+
+        IFACEMETHODIMP Close()
+        {
+            return ExceptionBoundary(
+                [&]
+                {
+                    if (m_closeAction)
+                    {
+                        auto closeAction = std::move(m_closeAction);
+                        m_closeAction = nullptr;
+                        closeAction();
+                    }
+                });
+        }
+    };
+
+
     // Public Win2D API surface for using custom effects.
     class PixelShaderEffect : public RuntimeClass<IPixelShaderEffect, MixIn<PixelShaderEffect, CanvasEffect>>
                             , public CanvasEffect
@@ -35,6 +73,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         typedef Map<HSTRING, IInspectable*, PixelShaderEffectPropertyMapTraits> PropertyMap;
         ComPtr<PropertyMap> m_propertyMap;
 
+        // While BeginPropertyUpdates scopes are open, constant buffer changes
+        // are held back and passed to D2D when the outermost scope closes.
+        unsigned m_propertyUpdateDepth;
+        bool m_hasPendingConstants;
+
     public:
         PixelShaderEffect(ICanvasDevice* device, ID2D1Effect* effect);
         PixelShaderEffect(ICanvasDevice* device, ID2D1Effect* effect, ISharedShaderState* sharedState);
@@ -85,6 +128,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         IFACEMETHOD(IsSupported)(ICanvasDevice* device, boolean* result) override;
 
+        IFACEMETHOD(GetPropertyHandle)(HSTRING name, int* handle) override;
+
+        IFACEMETHOD(SetFloatProperty)(int handle, float value) override;
+        IFACEMETHOD(SetIntProperty)(int handle, int value) override;
+        IFACEMETHOD(SetBoolProperty)(int handle, boolean value) override;
+        IFACEMETHOD(SetVector2Property)(int handle, Numerics::Vector2 value) override;
+        IFACEMETHOD(SetVector3Property)(int handle, Numerics::Vector3 value) override;
+        IFACEMETHOD(SetVector4Property)(int handle, Numerics::Vector4 value) override;
+        IFACEMETHOD(SetMatrix3x2Property)(int handle, Numerics::Matrix3x2 value) override;
+        IFACEMETHOD(SetMatrix4x4Property)(int handle, Numerics::Matrix4x4 value) override;
+
+        IFACEMETHOD(BeginPropertyUpdates)(IPixelShaderEffectPropertyUpdateScope** scope) override;
+
     protected:
         bool IsSupported(ICanvasDevice* device);
 
@@ -96,6 +152,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         void SetProperty(HSTRING name, IInspectable* boxedValue);
 
+        template<typename T>
+        HRESULT SetPropertyByHandle(int handle, T value);
+
+        void EndPropertyUpdates();
+
         HRESULT GetCoordinateMapping(unsigned index, SamplerCoordinateMapping* value);
         HRESULT SetCoordinateMapping(unsigned index, SamplerCoordinateMapping value);
 
@@ -105,6 +166,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         HRESULT GetSourceInterpolation(unsigned index, CanvasImageInterpolation* value);
         HRESULT SetSourceInterpolation(unsigned index, CanvasImageInterpolation value);
 
+        void OnConstantsChanged();
         void SetD2DConstants();
         void SetD2DCoordinateMapping();
         void SetD2DSourceInterpolation();
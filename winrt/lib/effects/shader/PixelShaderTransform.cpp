@@ -11,6 +11,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     PixelShaderTransform::PixelShaderTransform(ISharedShaderState* sharedState, std::shared_ptr<CoordinateMappingState> const& coordinateMapping)
         : m_sharedState(sharedState)
         , m_coordinateMapping(coordinateMapping)
+        , m_hasUploadedConstants(false)
+        , m_constantUploadCount(0)
+        , m_skippedConstantUploadCount(0)
     { }
 
 
@@ -81,6 +84,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     {
         return ExceptionBoundary([&]
         {
+            // A different draw info has not been given our constants yet.
+            if (drawInfo != m_drawInfo.Get())
+            {
+                m_hasUploadedConstants = false;
+            }
+
             m_drawInfo = drawInfo;
 
             // Tell D2D to use our pixel shader.
@@ -95,7 +104,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
     void PixelShaderTransform::SetConstants(std::vector<BYTE> const& constants)
     {
+        // Setting a property to the value it already had, or changing a
+        // property and then changing it back, leaves the buffer unchanged.
+        if (m_hasUploadedConstants && constants == m_uploadedConstants)
+        {
+            m_skippedConstantUploadCount++;
+            return;
+        }
+
         ThrowIfFailed(m_drawInfo->SetPixelShaderConstantBuffer(constants.data(), static_cast<UINT32>(constants.size())));
+
+        m_uploadedConstants = constants;
+        m_hasUploadedConstants = true;
+        m_constantUploadCount++;
     }
 
 
@@ -19,6 +19,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         std::shared_ptr<CoordinateMappingState> m_coordinateMapping;
         ComPtr<ID2D1DrawInfo> m_drawInfo;
 
+        // Copy of the constant buffer last passed to m_drawInfo, so that
+        // unchanged constants are not passed to D2D again.
+        std::vector<BYTE> m_uploadedConstants;
+        bool m_hasUploadedConstants;
+
+        unsigned m_constantUploadCount;
+        unsigned m_skippedConstantUploadCount;
+
     public:
         PixelShaderTransform(ISharedShaderState* sharedState, std::shared_ptr<CoordinateMappingState> const& coordinateMapping);
 
@@ -32,6 +40,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         void SetConstants(std::vector<BYTE> const& constants);
         void SetSourceInterpolation(SourceInterpolationState const* sourceInterpolation);
+
+        // How many SetConstants calls passed the buffer to D2D, and how
+        // many were skipped because it matched what D2D already had.
+        unsigned GetConstantUploadCount() const { return m_constantUploadCount; }
+        unsigned GetSkippedConstantUploadCount() const { return m_skippedConstantUploadCount; }
     };
 
 }}}}}
@@ -239,6 +239,25 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     }
 
 
+    unsigned SharedShaderState::GetPropertyIndex(HSTRING name)
+    {
+        auto& variable = FindVariable(name);
+
+        return static_cast<unsigned>(&variable - m_shader.Variables.data());
+    }
+
+
+    ShaderVariable const& SharedShaderState::GetVariable(unsigned index)
+    {
+        if (index >= m_shader.Variables.size())
+        {
+            ThrowHR(E_INVALIDARG, Strings::CustomEffectInvalidPropertyHandle);
+        }
+
+        return m_shader.Variables[index];
+    }
+
+
     // For formatting error message strings.
     template<typename T> wchar_t const* PropertyTypeName() { static_assert(false, "missing specialization"); }
 
@@ -350,6 +369,48 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     }
 
 
+    // Which of the typed setters can write a variable. These accept the same
+    // single (non-array) values that SetProperty would unbox for it.
+    template<typename TBoxed> bool IsSettableAs(ShaderVariable const& variable) { static_assert(false, "missing specialization"); }
+
+    template<> bool IsSettableAs<float>(ShaderVariable const& v)     { return v.Type == D3D_SVT_FLOAT && v.ComponentCount() == 1 && !v.Elements; }
+    template<> bool IsSettableAs<int>(ShaderVariable const& v)       { return v.Type == D3D_SVT_INT   && v.ComponentCount() == 1 && !v.Elements; }
+    template<> bool IsSettableAs<bool>(ShaderVariable const& v)      { return v.Type == D3D_SVT_BOOL  && v.ComponentCount() == 1 && !v.Elements; }
+    template<> bool IsSettableAs<Vector2>(ShaderVariable const& v)   { return v.Type == D3D_SVT_FLOAT && v.IsVector(2) && !v.Elements; }
+    template<> bool IsSettableAs<Vector3>(ShaderVariable const& v)   { return v.Type == D3D_SVT_FLOAT && v.IsVector(3) && !v.Elements; }
+    template<> bool IsSettableAs<Vector4>(ShaderVariable const& v)   { return v.Type == D3D_SVT_FLOAT && v.IsVector(4) && !v.Elements; }
+    template<> bool IsSettableAs<Matrix3x2>(ShaderVariable const& v) { return v.Type == D3D_SVT_FLOAT && v.IsMatrix(3, 2) && !v.Elements; }
+    template<> bool IsSettableAs<Matrix4x4>(ShaderVariable const& v) { return v.Type == D3D_SVT_FLOAT && v.IsMatrix(4, 4) && !v.Elements; }
+
+
+    // Transfers an already unboxed value to constant buffer format, skipping
+    // the name lookup and IInspectable unboxing done by SetProperty(HSTRING).
+    template<typename TBoxed, typename TComponent, typename TValue>
+    void SharedShaderState::SetTypedProperty(unsigned index, TValue value)
+    {
+        auto& variable = GetVariable(index);
+
+        if (!IsSettableAs<TBoxed>(variable))
+        {
+            WinStringBuilder message;
+            message.Format(Strings::CustomEffectWrongPropertyHandleType, static_cast<wchar_t const*>(variable.Name), PropertyTypeName<TBoxed>());
+            ThrowHR(E_INVALIDARG, message.Get());
+        }
+
+        CopyConstantData<CopyDirection::Write>(variable, reinterpret_cast<TComponent*>(&value));
+    }
+
+
+    void SharedShaderState::SetProperty(unsigned index, float value)     { SetTypedProperty<float, float>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, int value)       { SetTypedProperty<int, int>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, boolean value)   { SetTypedProperty<bool, boolean>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, Vector2 value)   { SetTypedProperty<Vector2, float>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, Vector3 value)   { SetTypedProperty<Vector3, float>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, Vector4 value)   { SetTypedProperty<Vector4, float>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, Matrix3x2 value) { SetTypedProperty<Matrix3x2, float>(index, value); }
+    void SharedShaderState::SetProperty(unsigned index, Matrix4x4 value) { SetTypedProperty<Matrix4x4, float>(index, value); }
+
+
     // Templated helper responsible for transfering a single component value to or from the constant buffer.
     template<CopyDirection Direction, typename T>
     struct TransferValue
@@ -717,4 +778,42 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         }
     }
 
+
+    bool PreloadedShaderCache::Add(ISharedShaderState* sharedState)
+    {
+        Lock lock(m_mutex);
+
+        auto& code = sharedState->Shader().Code;
+
+        if (Find(lock, code.data(), static_cast<uint32_t>(code.size())))
+            return false;
+
+        m_sharedStates.push_back(sharedState);
+        return true;
+    }
+
+
+    ComPtr<ISharedShaderState> PreloadedShaderCache::TryClone(BYTE const* shaderCode, uint32_t shaderCodeSize)
+    {
+        Lock lock(m_mutex);
+
+        auto sharedState = Find(lock, shaderCode, shaderCodeSize);
+
+        return sharedState ? sharedState->Clone() : nullptr;
+    }
+
+
+    ISharedShaderState* PreloadedShaderCache::Find(Lock const&, BYTE const* shaderCode, uint32_t shaderCodeSize)
+    {
+        for (auto& sharedState : m_sharedStates)
+        {
+            auto& code = sharedState->Shader().Code;
+
+            if (code.size() == shaderCodeSize && memcmp(code.data(), shaderCode, shaderCodeSize) == 0)
+                return sharedState.Get();
+        }
+
+        return nullptr;
+    }
+
 }}}}}
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ShaderDescription.h"
+#include "utils/LockUtilities.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Effects 
 {
@@ -62,6 +63,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<IInspectable> GetProperty(HSTRING name) = 0;
         virtual void SetProperty(HSTRING name, IInspectable* boxedValue) = 0;
         virtual std::vector<StringObjectPair> EnumerateProperties() = 0;
+
+        // Typed property setters, which address a property by its index in Shader().Variables.
+        // Clone preserves the variable order, so an index stays valid across clones.
+        virtual unsigned GetPropertyIndex(HSTRING name) = 0;
+        virtual void SetProperty(unsigned index, float value) = 0;
+        virtual void SetProperty(unsigned index, int value) = 0;
+        virtual void SetProperty(unsigned index, boolean value) = 0;
+        virtual void SetProperty(unsigned index, Numerics::Vector2 value) = 0;
+        virtual void SetProperty(unsigned index, Numerics::Vector3 value) = 0;
+        virtual void SetProperty(unsigned index, Numerics::Vector4 value) = 0;
+        virtual void SetProperty(unsigned index, Numerics::Matrix3x2 value) = 0;
+        virtual void SetProperty(unsigned index, Numerics::Matrix4x4 value) = 0;
     };
     
 
@@ -91,9 +104,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual void SetProperty(HSTRING name, IInspectable* boxedValue) override;
         virtual std::vector<StringObjectPair> EnumerateProperties() override;
 
+        // Typed property setters.
+        virtual unsigned GetPropertyIndex(HSTRING name) override;
+        virtual void SetProperty(unsigned index, float value) override;
+        virtual void SetProperty(unsigned index, int value) override;
+        virtual void SetProperty(unsigned index, boolean value) override;
+        virtual void SetProperty(unsigned index, Numerics::Vector2 value) override;
+        virtual void SetProperty(unsigned index, Numerics::Vector3 value) override;
+        virtual void SetProperty(unsigned index, Numerics::Vector4 value) override;
+        virtual void SetProperty(unsigned index, Numerics::Matrix3x2 value) override;
+        virtual void SetProperty(unsigned index, Numerics::Matrix4x4 value) override;
+
     private:
         ComPtr<IInspectable> GetProperty(ShaderVariable const& variable);
         ShaderVariable const& FindVariable(HSTRING name);
+        ShaderVariable const& GetVariable(unsigned index);
 
 
         // Transfer property values between constant buffer and boxed IInspectable formats.
@@ -103,6 +128,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         template<typename TBoxed, typename TComponent = TBoxed>
         void Unbox(ShaderVariable const& variable, IInspectable* boxedValue);
 
+        template<typename TBoxed, typename TComponent, typename TValue>
+        void SetTypedProperty(unsigned index, TValue value);
+
         template<CopyDirection Direction, typename TComponent>
         void CopyConstantData(ShaderVariable const& variable, TComponent* values);
 
@@ -115,4 +143,27 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         void ReflectOverShaderLinkingFunction();
     };
 
+
+    //
+    // Shader states that were built ahead of time by CanvasDevice.WarmUpSharedDeviceAsync.
+    // A PixelShaderEffect created from the same shader code starts from a clone of one of
+    // these, rather than reflecting over the shader again.
+    //
+    class PreloadedShaderCache : public Singleton<PreloadedShaderCache>
+    {
+        std::mutex m_mutex;
+        std::vector<ComPtr<ISharedShaderState>> m_sharedStates;
+
+    public:
+        // Returns false, and leaves the cache unchanged, if this shader was
+        // already preloaded.
+        bool Add(ISharedShaderState* sharedState);
+
+        // Returns null if this shader has not been preloaded.
+        ComPtr<ISharedShaderState> TryClone(BYTE const* shaderCode, uint32_t shaderCodeSize);
+
+    private:
+        ISharedShaderState* Find(Lock const& lock, BYTE const* shaderCode, uint32_t shaderCodeSize);
+    };
+
 }}}}}
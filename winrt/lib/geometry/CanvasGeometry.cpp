@@ -10,6 +10,7 @@
 #include "TessellationSink.h"
 #include "../images/CanvasCommandList.h"
 #include "../text/DrawGlyphRunHelper.h"
+#include "../text/CanvasTextLayout.h"
 #include "InkToGeometryCommandSink.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
@@ -1650,7 +1651,7 @@ public:
 ComPtr<CanvasGeometry> CanvasGeometry::CreateNew(
     ICanvasTextLayout* canvasTextLayout)
 {
-    auto dwriteTextLayout = GetWrappedResource<IDWriteTextLayout2>(canvasTextLayout);
+    auto dwriteTextLayout = As<ICanvasTextLayoutInternal>(canvasTextLayout)->GetReadOnlyResource();
 
     ComPtr<ICanvasDevice> canvasDevice;
     ThrowIfFailed(canvasTextLayout->get_Device(&canvasDevice));
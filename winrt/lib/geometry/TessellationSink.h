@@ -9,12 +9,25 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     class TessellationSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1TessellationSink>,
                              private LifespanTracker<TessellationSink>
     {
-        std::vector<CanvasTriangleVertices> m_triangles;
+        //
+        // Triangles are written straight into the memory that is returned to
+        // the caller.  It starts out sized for the previous tessellation on
+        // this thread, since apps tend to tessellate similar geometry
+        // repeatedly.
+        //
+        static uint32_t& LastTriangleCount()
+        {
+            static thread_local uint32_t count;
+            return count;
+        }
+
+        ComArrayBuilder<CanvasTriangleVertices> m_triangles;
         HRESULT m_result;
 
     public:
         TessellationSink()
-            : m_result(S_OK)
+            : m_triangles(LastTriangleCount())
+            , m_result(S_OK)
         { }
 
         IFACEMETHODIMP_(void) AddTriangles(D2D1_TRIANGLE const* triangles, UINT32 trianglesCount)
@@ -26,7 +39,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             {
                 auto canvasTriangles = ReinterpretAs<CanvasTriangleVertices const*>(triangles);
 
-                m_triangles.insert(m_triangles.end(), canvasTriangles, canvasTriangles + trianglesCount);
+                m_triangles.Append(canvasTriangles, trianglesCount);
             });
         }
 
@@ -39,7 +52,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         {
             ThrowIfFailed(m_result);
 
-            return ComArray<CanvasTriangleVertices>(m_triangles.begin(), m_triangles.end());
+            LastTriangleCount() = m_triangles.GetSize();
+
+            return m_triangles.Complete();
         }
     };
 }}}}}
@@ -394,6 +394,48 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    //
+    // When resource recreation is enabled on the device, this keeps a copy of
+    // the pixels a bitmap was created from, so that it can be rebuilt on a
+    // new device after device loss.  Changes made to the bitmap afterwards,
+    // eg. by SetPixelBytes, are not captured.
+    //
+    static void RegisterForRecreation(
+        ICanvasDevice* device,
+        ComPtr<CanvasBitmap> const& bitmap,
+        uint8_t const* bytes,
+        uint32_t byteCount,
+        uint32_t pitch,
+        int32_t widthInPixels,
+        int32_t heightInPixels,
+        float dpi,
+        DirectXPixelFormat format,
+        CanvasAlphaMode alpha)
+    {
+        auto registry = As<ICanvasDeviceInternal>(device)->GetResourceRecreationRegistry();
+
+        if (!registry)
+            return;
+
+        auto pixels = std::make_shared<std::vector<uint8_t>>(bytes, bytes + byteCount);
+
+        registry->Register(
+            As<ICanvasBitmap>(bitmap).Get(),
+            byteCount,
+            [=] (IUnknown*, ICanvasDevice* newDevice) -> ComPtr<IUnknown>
+            {
+                return As<ICanvasDeviceInternal>(newDevice)->CreateBitmapFromBytes(
+                    pixels->empty() ? nullptr : pixels->data(),
+                    pitch,
+                    widthInPixels,
+                    heightInPixels,
+                    dpi,
+                    format,
+                    alpha);
+            });
+    }
+
+
     ComPtr<CanvasBitmap> CanvasBitmap::CreateNew(
         ICanvasDevice* device,
         uint32_t byteCount,
@@ -434,6 +476,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             d2dBitmap.Get());
         CheckMakeResult(bitmap);
 
+        RegisterForRecreation(device, bitmap, bytes, bytesNeeded, pitch, widthInPixels, heightInPixels, dpi, format, alpha);
+
         return bitmap;
     }
 
@@ -541,6 +585,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             d2dBitmap.Get());
         CheckMakeResult(bitmap);
 
+        auto pixelBytes = std::min(
+            static_cast<uint32_t>(bitmapPlaneDescription.Stride) * pixelHeight,
+            bufferSize - static_cast<uint32_t>(bitmapPlaneDescription.StartIndex));
+
+        RegisterForRecreation(
+            device,
+            bitmap,
+            buffer + bitmapPlaneDescription.StartIndex,
+            pixelBytes,
+            bitmapPlaneDescription.Stride,
+            pixelWidth,
+            pixelHeight,
+            static_cast<float>(dpiX),
+            GetFudgedFormat(bitmapPixelFormat),
+            ToCanvasAlphaMode(bitmapAlphaMode));
+
         return bitmap;
     }
 
@@ -1188,29 +1248,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             stdext::make_checked_array_iterator(destination, capacity));
     }
 
-    void GetPixelColorsImpl(
+    static void CopyPixelColors(
         ComPtr<ICanvasDevice> const& device,
         ComPtr<ID2D1Bitmap1> const& d2dBitmap,
         D2D1_RECT_U const& subRectangle,
-        uint32_t* valueCount,
-        Color **valueElements)
+        stdext::checked_array_iterator<Color*> destination)
     {
-        CheckInPointer(valueCount);
-        CheckAndClearOutPointer(valueElements);
-
-        VerifyWellFormedSubrectangle(subRectangle, d2dBitmap->GetPixelSize());
-
-        if (d2dBitmap->GetPixelFormat().format != DXGI_FORMAT_B8G8R8A8_UNORM)
-        {
-            ThrowHR(E_INVALIDARG, Strings::PixelColorsFormatRestriction);
-        }
-
         ScopedBitmapMappedPixelAccess bitmapPixelAccess(device.Get(), d2dBitmap.Get(), &subRectangle);
 
         const unsigned int subRectangleWidth = subRectangle.right - subRectangle.left;
         const unsigned int subRectangleHeight = subRectangle.bottom - subRectangle.top;
-        const unsigned int destSizeInPixels = subRectangleWidth * subRectangleHeight;
-        ComArray<Color> array(destSizeInPixels);
 
         byte* sourceRowStart = bitmapPixelAccess.GetLockedData();
 
@@ -1219,7 +1266,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             for (unsigned int x = 0; x < subRectangleWidth; x++)
             {
                 uint32_t sourcePixel = *(reinterpret_cast<uint32_t*>(&sourceRowStart[x * 4]));
-                Color& destColor = array[y * subRectangleWidth + x];
+                Color& destColor = destination[y * subRectangleWidth + x];
                 destColor.B = (sourcePixel >> 0) & 0xFF;
                 destColor.G = (sourcePixel >> 8) & 0xFF;
                 destColor.R = (sourcePixel >> 16) & 0xFF;
@@ -1227,10 +1274,60 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             }
             sourceRowStart += bitmapPixelAccess.GetStride();
         }
+    }
+
+    static uint32_t GetPixelColorsSize(
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle)
+    {
+        VerifyWellFormedSubrectangle(subRectangle, d2dBitmap->GetPixelSize());
+
+        if (d2dBitmap->GetPixelFormat().format != DXGI_FORMAT_B8G8R8A8_UNORM)
+        {
+            ThrowHR(E_INVALIDARG, Strings::PixelColorsFormatRestriction);
+        }
+
+        return (subRectangle.right - subRectangle.left) * (subRectangle.bottom - subRectangle.top);
+    }
+
+    void GetPixelColorsImpl(
+        ComPtr<ICanvasDevice> const& device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        uint32_t* valueCount,
+        Color **valueElements)
+    {
+        CheckInPointer(valueCount);
+        CheckAndClearOutPointer(valueElements);
+
+        ComArray<Color> array(GetPixelColorsSize(d2dBitmap, subRectangle));
+
+        CopyPixelColors(device, d2dBitmap, subRectangle, begin(array));
 
         array.Detach(valueCount, valueElements);
     }
 
+    void GetPixelColorsImpl(
+        ComPtr<ICanvasDevice> const& device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        uint32_t valueCount,
+        Color* valueElements)
+    {
+        CheckInPointer(valueElements);
+
+        auto size = GetPixelColorsSize(d2dBitmap, subRectangle);
+
+        if (valueCount != size)
+        {
+            WinStringBuilder message;
+            message.Format(Strings::WrongArrayLength, size, valueCount);
+            ThrowHR(E_INVALIDARG, message.Get());
+        }
+
+        CopyPixelColors(device, d2dBitmap, subRectangle, stdext::make_checked_array_iterator(valueElements, valueCount));
+    }
+
     static void SaveBitmap(
         ID2D1Bitmap1* d2dBitmap,
         ID2D1Device* d2dDevice,
@@ -6,6 +6,7 @@
 
 #include "ScopedBitmapMappedPixelAccess.h"
 #include "WicAdapter.h"
+#include "drawing/ResourceRecreationRegistry.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
@@ -273,6 +274,13 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         uint32_t* valueCount,
         Color **valueElements);
 
+    void GetPixelColorsImpl(
+        ComPtr<ICanvasDevice> const& device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        uint32_t valueCount,
+        Color* valueElements);
+
     void SaveBitmapToFileImpl(
         ComPtr<ID2D1Device> const& d2dDevice,
         ComPtr<ID2D1Bitmap1> const& d2dBitmap,
@@ -336,7 +344,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 ChainInterfaces<CloakedIid<ICanvasImageInternal>, CloakedIid<ICanvasImageInterop>>,
                 CloakedIid<ICanvasBitmapInternal>,
                 CloakedIid<IDirect3DDxgiInterfaceAccess>,
-                CloakedIid<ICanvasResourceWrapperWithDevice>>,
+                CloakedIid<ICanvasResourceWrapperWithDevice>,
+                CloakedIid<ICanvasResourceRecreatable>>,
             ChainInterfaces<
                 MixIn<CanvasBitmapImpl<TRAITS>, ResourceWrapper<typename TRAITS::resource_t, typename TRAITS::wrapper_t, typename TRAITS::wrapper_interface_t>>,
                 ABI::Windows::Foundation::IClosable,
@@ -363,6 +372,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             return ResourceWrapper::Close();
         }
 
+        // ICanvasResourceRecreatable
+        virtual bool IsRecreatable() override
+        {
+            return HasResource();
+        }
+
+        virtual ComPtr<IUnknown> SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource) override
+        {
+            auto d2dBitmap = As<ID2D1Bitmap1>(newResource);
+
+            m_device = newDevice;
+            return ExchangeResource(d2dBitmap.Get());
+        }
+
         IFACEMETHODIMP get_SizeInPixels(_Out_ BitmapSize* size) override
         {
             return ExceptionBoundary(
@@ -518,6 +541,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             return GetResource();
         }
 
+        // A bitmap's size is fixed when it is created.
+        virtual uint64_t GetBoundsGeneration() override
+        {
+            return 1;
+        }
+
         // ICanvasBitmapInternal
         virtual ComPtr<ID2D1Bitmap1> const& GetD2DBitmap() override
         {
@@ -732,6 +761,46 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 });
         }
 
+        IFACEMETHODIMP GetPixelColorsWithBuffer(
+            uint32_t valueCount,
+            ABI::Windows::UI::Color* valueElements) override
+        {
+            return ExceptionBoundary(
+                [&]
+                {
+                    auto& d2dBitmap = GetResource();
+
+                    GetPixelColorsImpl(
+                        m_device,
+                        d2dBitmap,
+                        GetResourceBitmapExtents(d2dBitmap),
+                        valueCount,
+                        valueElements);
+                });
+        }
+
+        IFACEMETHODIMP GetPixelColorsWithBufferAndSubrectangle(
+            uint32_t valueCount,
+            ABI::Windows::UI::Color* valueElements,
+            int32_t left,
+            int32_t top,
+            int32_t width,
+            int32_t height) override
+        {
+            return ExceptionBoundary(
+                [&]
+                {
+                    auto& d2dBitmap = GetResource();
+
+                    GetPixelColorsImpl(
+                        m_device,
+                        d2dBitmap,
+                        ToD2DRectU(left, top, width, height),
+                        valueCount,
+                        valueElements);
+                });
+        }
+
         IFACEMETHODIMP SetPixelBytes(
             uint32_t valueCount,
             uint8_t* valueElements) override
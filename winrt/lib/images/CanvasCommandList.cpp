@@ -77,10 +77,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& d2dCommandList = GetResource();
                 auto& device = m_device.EnsureNotClosed();
 
-                auto deviceContext = As<ICanvasDeviceInternal>(device)->CreateDeviceContextForDrawingSession();
+                auto lease = As<ICanvasDeviceInternal>(device)->LeaseDeviceContextForDrawingSession();
+                ComPtr<ID2D1DeviceContext1> deviceContext = lease.Get();
                 deviceContext->SetTarget(d2dCommandList.Get());
 
-                auto adapter = std::make_shared<SimpleCanvasDrawingSessionAdapter>(deviceContext.Get());
+                auto adapter = std::make_shared<PooledCanvasDrawingSessionAdapter>(std::move(lease));
 
                 auto ds = CanvasDrawingSession::CreateNew(deviceContext.Get(), adapter, device.Get(), m_hasActiveDrawingSession);
 
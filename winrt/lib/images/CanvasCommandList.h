@@ -69,6 +69,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             float targetDpi,
             float* realizedDpi) override;
 
+        // Once closed, a command list's contents (and so its bounds) can't change.
+        virtual uint64_t GetBoundsGeneration() override
+        {
+            return m_d2dCommandListIsClosed ? 1 : 0;
+        }
+
         // ResourceWrapper
 
         IFACEMETHOD(GetNativeResource)(ICanvasDevice* device, float dpi, REFIID iid, void** outResource) override;
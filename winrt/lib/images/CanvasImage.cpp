@@ -3,6 +3,7 @@
 // Licensed under the MIT License. See LICENSE.txt in the project root for license information.
 
 #include "pch.h"
+#include "effects/EffectBoundsEvaluator.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
@@ -23,6 +24,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return As<ICanvasDeviceInternal>(device)->GetResourceCreationDeviceContext();
     }
     
+    static Rect GetImageWorldBounds(
+        ID2D1DeviceContext* d2dDeviceContext,
+        ID2D1Image* d2dImage,
+        Numerics::Matrix3x2 const* transform)
+    {
+        d2dDeviceContext->SetTransform(ReinterpretAs<D2D1_MATRIX_3X2_F const*>(transform));
+
+        D2D1_RECT_F d2dBounds;
+        ThrowIfFailed(d2dDeviceContext->GetImageWorldBounds(d2dImage, &d2dBounds));
+
+        return FromD2DRect(d2dBounds);
+    }
+
     template <typename T>
     static Rect GetImageBoundsImpl(
         T* image,
@@ -56,12 +70,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         auto restoreTransformWarden = MakeScopeWarden([&] { d2dDeviceContext->SetTransform(previousTransform); });
 
-        d2dDeviceContext->SetTransform(ReinterpretAs<D2D1_MATRIX_3X2_F const*>(transform));
-        
-        D2D1_RECT_F d2dBounds;
-        ThrowIfFailed(d2dDeviceContext->GetImageWorldBounds(d2dImage.Get(), &d2dBounds));
-
-        return FromD2DRect(d2dBounds);
+        return GetImageWorldBounds(d2dDeviceContext.Get(), d2dImage.Get(), transform);
     }
 
     HRESULT GetImageBoundsImpl(
@@ -110,6 +119,133 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    std::vector<Rect> GetImageBoundsBatch(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t imageCount,
+        ICanvasImage** images,
+        Numerics::Matrix3x2 const* transforms)
+    {
+        std::vector<Rect> results(imageCount);
+
+        if (imageCount == 0)
+            return results;
+
+        ComPtr<ICanvasDevice> device;
+        ThrowIfFailed(resourceCreator->get_Device(&device));
+
+        auto d2dDevice = As<ICanvasDeviceInternal>(device)->GetD2DDevice();
+
+        // One device context, and one save/restore of its transform, serves the whole batch.
+        auto d2dDeviceContext = GetDeviceContextForGetBounds(device.Get(), resourceCreator);
+
+        //
+        // A drawing session's device context can have any DPI or unit mode,
+        // neither of which are part of the cache key, so results are only
+        // cached when measuring with the device's own context.
+        //
+        bool canUseCache = !MaybeAs<ICanvasDrawingSession>(resourceCreator);
+
+        D2D1_MATRIX_3X2_F previousTransform;
+        d2dDeviceContext->GetTransform(&previousTransform);
+
+        auto restoreTransformWarden = MakeScopeWarden([&] { d2dDeviceContext->SetTransform(previousTransform); });
+
+        // Each image is realized at most once, even if it appears several times in the batch.
+        std::unordered_map<ICanvasImage*, ComPtr<ID2D1Image>> realizedImages;
+
+        for (uint32_t i = 0; i < imageCount; ++i)
+        {
+            auto image = images[i];
+            CheckInPointer(image);
+
+            auto transform = transforms ? &transforms[i] : &Identity3x2();
+
+            auto imageInternal = MaybeAs<ICanvasImageInternal>(image);
+
+            ImageBoundsCache* cache = nullptr;
+            uint64_t generation = 0;
+
+            if (canUseCache && imageInternal)
+            {
+                cache = imageInternal->GetBoundsCache();
+
+                if (cache)
+                {
+                    generation = imageInternal->GetBoundsGeneration();
+
+                    if (generation && cache->TryGetBounds(generation, d2dDevice.Get(), *transform, &results[i]))
+                        continue;
+                }
+            }
+
+            auto& d2dImage = realizedImages[image];
+
+            if (!d2dImage)
+            {
+                if (imageInternal)
+                    d2dImage = imageInternal->GetD2DImage(device.Get(), d2dDeviceContext.Get());
+                else
+                    d2dImage = ICanvasImageInternal::GetD2DImageFromInternalOrInteropSource(image, device.Get(), d2dDeviceContext.Get());
+            }
+
+            results[i] = GetImageWorldBounds(d2dDeviceContext.Get(), d2dImage.Get(), transform);
+
+            if (cache && generation)
+                cache->StoreBounds(generation, d2dDevice.Get(), *transform, results[i]);
+        }
+
+        return results;
+    }
+
+
+    //
+    // ImageBoundsCache
+    //
+
+    static bool IsSameTransform(Numerics::Matrix3x2 const& a, Numerics::Matrix3x2 const& b)
+    {
+        return a.M11 == b.M11 && a.M12 == b.M12 &&
+               a.M21 == b.M21 && a.M22 == b.M22 &&
+               a.M31 == b.M31 && a.M32 == b.M32;
+    }
+
+
+    bool ImageBoundsCache::TryGetBounds(uint64_t generation, ID2D1Device* device, Numerics::Matrix3x2 const& transform, Rect* bounds)
+    {
+        Lock lock(m_mutex);
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->Generation == generation && it->Device.Get() == device && IsSameTransform(it->Transform, transform))
+            {
+                *bounds = it->Bounds;
+
+                // Move to the back so that it is the last to be evicted.
+                std::rotate(it, it + 1, m_entries.end());
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    void ImageBoundsCache::StoreBounds(uint64_t generation, ID2D1Device* device, Numerics::Matrix3x2 const& transform, Rect const& bounds)
+    {
+        Lock lock(m_mutex);
+
+        // Entries from older generations can never be hit again.
+        m_entries.erase(
+            std::remove_if(m_entries.begin(), m_entries.end(), [=] (Entry const& entry) { return entry.Generation != generation; }),
+            m_entries.end());
+
+        if (m_entries.size() >= MaxEntries)
+            m_entries.erase(m_entries.begin());
+
+        m_entries.push_back(Entry{ generation, device, transform, bounds });
+    }
+
+
     //
     // CanvasImageFactory
     //
@@ -376,6 +512,61 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    IFACEMETHODIMP CanvasImageFactory::GetBoundsForImages(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t imageCount,
+        ICanvasImage** images,
+        uint32_t transformCount,
+        Numerics::Matrix3x2* transforms,
+        uint32_t* valueCount,
+        Rect** valueElements)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(valueCount);
+                CheckAndClearOutPointer(valueElements);
+
+                if (imageCount > 0)
+                    CheckInPointer(images);
+
+                if (transformCount != 0 && transformCount != imageCount)
+                    ThrowHR(E_INVALIDARG);
+
+                auto bounds = GetImageBoundsBatch(resourceCreator, imageCount, images, transformCount ? transforms : nullptr);
+
+                ComArray<Rect> array(bounds.begin(), bounds.end());
+                array.Detach(valueCount, valueElements);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasImageFactory::EstimateBounds(
+        ICanvasResourceCreator* resourceCreator,
+        ICanvasImage* image,
+        Numerics::Matrix3x2 transform,
+        Rect* bounds)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(image);
+                CheckInPointer(bounds);
+
+                // Most graphs can be measured without realizing them on a
+                // device context.  Those that can't are measured with D2D.
+                auto source = MaybeAs<IGraphicsEffectSource>(image);
+
+                if (source && Effects::TryGetEffectGraphBounds(resourceCreator, source.Get(), transform, bounds))
+                    return;
+
+                ThrowIfFailed(image->GetBoundsWithTransform(resourceCreator, transform, bounds));
+            });
+    }
+
+
     ComPtr<IAsyncAction> DefaultCanvasImageAdapter::RunAsync(
         std::function<void()>&& fn)
     {
@@ -15,6 +15,36 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     using namespace ABI::Windows::Storage::Streams;
 
 
+    //
+    // Remembers the most recently computed bounds of an image, keyed on the
+    // image's bounds generation (see ICanvasImageInternal::GetBoundsGeneration),
+    // the device it was realized on and the transform.  Entries hold a
+    // reference to their device, so that a new device created at the same
+    // address can't be mistaken for it.  Used by
+    // CanvasImage.GetBoundsForImages to avoid re-realizing effect graphs that
+    // have not changed since they were last measured.
+    //
+    class ImageBoundsCache
+    {
+        static size_t const MaxEntries = 4;
+
+        struct Entry
+        {
+            uint64_t Generation;
+            ComPtr<ID2D1Device> Device;
+            Numerics::Matrix3x2 Transform;
+            Rect Bounds;
+        };
+
+        std::mutex m_mutex;
+        std::vector<Entry> m_entries;    // most recently used last
+
+    public:
+        bool TryGetBounds(uint64_t generation, ID2D1Device* device, Numerics::Matrix3x2 const& transform, Rect* bounds);
+        void StoreBounds(uint64_t generation, ID2D1Device* device, Numerics::Matrix3x2 const& transform, Rect const& bounds);
+    };
+
+
     class __declspec(uuid("2F434224-053C-4978-87C4-CFAAFA2F4FAC"))
     ICanvasImageInternal : public ICanvasImageInterop
     {
@@ -106,6 +136,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
             return d2dImage;
         }
+
+        // Returns a value that changes whenever anything that could affect
+        // the image's bounds changes, or zero if the image cannot tell (in
+        // which case its bounds are never cached).
+        virtual uint64_t GetBoundsGeneration() { return 0; }
+
+        // Images that are expensive to measure return a cache for their bounds.
+        virtual ImageBoundsCache* GetBoundsCache() { return nullptr; }
     };
 
     HRESULT GetImageBoundsImpl(
@@ -116,6 +154,16 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     DeviceContextLease GetDeviceContextForGetBounds(ICanvasDevice* device, ICanvasResourceCreator* resourceCreator);
 
+    //
+    // Measures many images using a single device context.  transforms is
+    // either null or points to one transform per image.
+    //
+    std::vector<Rect> GetImageBoundsBatch(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t imageCount,
+        ICanvasImage** images,
+        Numerics::Matrix3x2 const* transforms);
+
     class DefaultCanvasImageAdapter;
     
     class CanvasImageAdapter : public Singleton<CanvasImageAdapter, DefaultCanvasImageAdapter>
@@ -212,5 +260,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHODIMP IsHistogramSupported(
             ICanvasDevice* device,
             boolean* result) override;
+
+        IFACEMETHODIMP GetBoundsForImages(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t imageCount,
+            ICanvasImage** images,
+            uint32_t transformCount,
+            Numerics::Matrix3x2* transforms,
+            uint32_t* valueCount,
+            Rect** valueElements) override;
+
+        IFACEMETHODIMP EstimateBounds(
+            ICanvasResourceCreator* resourceCreator,
+            ICanvasImage* image,
+            Numerics::Matrix3x2 transform,
+            Rect* bounds) override;
     };
 }}}}
@@ -168,9 +168,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         assert(targetBitmap != nullptr);
 
         //
-        // Create a new ID2D1DeviceContext
+        // Lease an ID2D1DeviceContext from the device's drawing session pool
         //
-        auto deviceContext = As<ICanvasDeviceInternal>(owner)->CreateDeviceContextForDrawingSession();
+        auto lease = As<ICanvasDeviceInternal>(owner)->LeaseDeviceContextForDrawingSession();
+        ComPtr<ID2D1DeviceContext1> deviceContext = lease.Get();
 
         //
         // Set the target
@@ -184,7 +185,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         targetBitmap->GetDpi(&dpiX, &dpiY);
         deviceContext->SetDpi(dpiX, dpiY);
 
-        auto adapter = std::make_shared<SimpleCanvasDrawingSessionAdapter>(deviceContext.Get());
+        auto adapter = std::make_shared<PooledCanvasDrawingSessionAdapter>(std::move(lease));
 
         return CanvasDrawingSession::CreateNew(deviceContext.Get(), adapter, owner, std::move(hasActiveDrawingSession));
     }
@@ -292,6 +292,7 @@ CanvasVirtualBitmap::CanvasVirtualBitmap(
     , m_imageSourceFromWic(imageSourceFromWic)
     , m_localBounds(localBounds)
     , m_orientation(orientation)
+    , m_prefetchGeneration(0)
 {
 }
 
@@ -469,6 +470,197 @@ IFACEMETHODIMP CanvasVirtualBitmap::get_Bounds(Rect* value)
 }
 
 
+ComPtr<ID2D1ImageSourceFromWic> const& CanvasVirtualBitmap::GetImageSourceFromWic()
+{
+    // Fails with RO_E_CLOSED if we've been closed
+    GetResource();
+
+    if (!m_imageSourceFromWic)
+        ThrowHR(E_FAIL);
+
+    return m_imageSourceFromWic;
+}
+
+
+//
+// ID2D1ImageSourceFromWic::EnsureCached and TrimCache take a rectangle in the
+// pixel space of the WIC source, before any orientation has been applied.
+// The regions passed to us are in the same space as Bounds, so they need to
+// be clipped, rounded out to whole pixels and then mapped back through the
+// orientation.
+//
+D2D1_RECT_U CanvasVirtualBitmap::GetSourceRect(Rect const& region) const
+{
+    auto left   = std::max(region.X, m_localBounds.X);
+    auto top    = std::max(region.Y, m_localBounds.Y);
+    auto right  = std::min(region.X + region.Width, m_localBounds.X + m_localBounds.Width);
+    auto bottom = std::min(region.Y + region.Height, m_localBounds.Y + m_localBounds.Height);
+
+    // Written this way round so that NaNs also give an empty rectangle
+    if (!(left < right && top < bottom))
+        return D2D1_RECT_U{ 0, 0, 0, 0 };
+
+    // CanvasVirtualBitmap is always 96 DPI, so DIPs are pixels.
+    auto displayWidth  = static_cast<uint32_t>(m_localBounds.Width);
+    auto displayHeight = static_cast<uint32_t>(m_localBounds.Height);
+
+    auto x0 = static_cast<uint32_t>(floorf(left - m_localBounds.X));
+    auto y0 = static_cast<uint32_t>(floorf(top - m_localBounds.Y));
+    auto x1 = std::min(static_cast<uint32_t>(ceilf(right - m_localBounds.X)), displayWidth);
+    auto y1 = std::min(static_cast<uint32_t>(ceilf(bottom - m_localBounds.Y)), displayHeight);
+
+    bool isTransposed = m_orientation >= D2D1_ORIENTATION_ROTATE_CLOCKWISE90_FLIP_HORIZONTAL;
+
+    auto w = isTransposed ? displayHeight : displayWidth;
+    auto h = isTransposed ? displayWidth : displayHeight;
+
+    auto toSource = [&] (uint32_t x, uint32_t y)
+    {
+        switch (m_orientation)
+        {
+        case D2D1_ORIENTATION_FLIP_HORIZONTAL:                     return D2D1_POINT_2U{ w - x, y };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE180:                 return D2D1_POINT_2U{ w - x, h - y };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE180_FLIP_HORIZONTAL: return D2D1_POINT_2U{ x, h - y };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE90_FLIP_HORIZONTAL:  return D2D1_POINT_2U{ y, x };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE270:                 return D2D1_POINT_2U{ w - y, x };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE270_FLIP_HORIZONTAL: return D2D1_POINT_2U{ w - y, h - x };
+        case D2D1_ORIENTATION_ROTATE_CLOCKWISE90:                  return D2D1_POINT_2U{ y, h - x };
+        default:                                                   return D2D1_POINT_2U{ x, y };
+        }
+    };
+
+    auto p0 = toSource(x0, y0);
+    auto p1 = toSource(x1, y1);
+
+    return D2D1_RECT_U
+    {
+        std::min(p0.x, p1.x),
+        std::min(p0.y, p1.y),
+        std::max(p0.x, p1.x),
+        std::max(p0.y, p1.y)
+    };
+}
+
+
+static bool IsEmpty(D2D1_RECT_U const& rect)
+{
+    return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+
+static void EnsureCached(ID2D1ImageSourceFromWic* imageSource, D2D1_RECT_U const& rect)
+{
+    if (IsEmpty(rect))
+        return;
+
+    HRESULT hr = imageSource->EnsureCached(&rect);
+
+    // Images that aren't cached on demand were decoded in full when they were
+    // loaded, so there's nothing for us to do.
+    if (hr != D2DERR_UNSUPPORTED_OPERATION)
+        ThrowIfFailed(hr);
+}
+
+
+//
+// EnsureCached doesn't draw, so it doesn't need a device context, and the D2D
+// factory is multithreaded so it is safe to call it from the threadpool while
+// the bitmap is being drawn elsewhere.
+//
+
+IFACEMETHODIMP CanvasVirtualBitmap::EnsureCachedAsync(Rect region, IAsyncAction** action)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(action);
+
+            auto imageSource = GetImageSourceFromWic();
+            auto sourceRect = GetSourceRect(region);
+
+            auto asyncAction = Make<AsyncAction>(
+                [imageSource, sourceRect]
+                {
+                    EnsureCached(imageSource.Get(), sourceRect);
+                });
+
+            CheckMakeResult(asyncAction);
+            ThrowIfFailed(asyncAction.CopyTo(action));
+        });
+}
+
+
+IFACEMETHODIMP CanvasVirtualBitmap::TrimCache(Rect regionToKeep)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            auto& imageSource = GetImageSourceFromWic();
+
+            // An empty rectangle is passed through, since that tells D2D to
+            // trim everything.
+            auto sourceRect = GetSourceRect(regionToKeep);
+
+            HRESULT hr = imageSource->TrimCache(&sourceRect);
+
+            if (hr != D2DERR_UNSUPPORTED_OPERATION)
+                ThrowIfFailed(hr);
+        });
+}
+
+
+IFACEMETHODIMP CanvasVirtualBitmap::PrefetchForPanAsync(
+    Rect visibleRegion,
+    Vector2 panVelocity,
+    float lookAheadSeconds,
+    IAsyncAction** action)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(action);
+
+            if (!(lookAheadSeconds >= 0))
+                ThrowHR(E_INVALIDARG);
+
+            auto imageSource = GetImageSourceFromWic();
+
+            // The region we'll need is everything between where the view is
+            // now and where it is predicted to be.
+            auto dx = panVelocity.X * lookAheadSeconds;
+            auto dy = panVelocity.Y * lookAheadSeconds;
+
+            Rect predictedRegion
+            {
+                visibleRegion.X + std::min(dx, 0.0f),
+                visibleRegion.Y + std::min(dy, 0.0f),
+                visibleRegion.Width + fabsf(dx),
+                visibleRegion.Height + fabsf(dy)
+            };
+
+            auto sourceRect = GetSourceRect(predictedRegion);
+
+            auto generation = ++m_prefetchGeneration;
+            ComPtr<CanvasVirtualBitmap> self(this);
+
+            auto asyncAction = Make<AsyncAction>(
+                [self, imageSource, sourceRect, generation]
+                {
+                    // While panning, prefetches are issued faster than they
+                    // can complete.  Rather than working through the backlog,
+                    // only the most recent one is acted on.
+                    if (self->m_prefetchGeneration != generation)
+                        return;
+
+                    EnsureCached(imageSource.Get(), sourceRect);
+                });
+
+            CheckMakeResult(asyncAction);
+            ThrowIfFailed(asyncAction.CopyTo(action));
+        });
+}
+
+
 IFACEMETHODIMP CanvasVirtualBitmap::GetBounds(ICanvasResourceCreator* rc, Rect* bounds)
 {
     return GetImageBoundsImpl(this, rc, nullptr, bounds);
@@ -92,6 +92,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ComPtr<ID2D1ImageSourceFromWic> m_imageSourceFromWic;
         Rect m_localBounds;
         D2D1_ORIENTATION m_orientation;
+
+        // Incremented by each PrefetchForPanAsync, so that queued prefetches
+        // can tell when they have been superseded.
+        std::atomic<uint64_t> m_prefetchGeneration;
         
     public:
         static ComPtr<CanvasVirtualBitmap> CreateNew(
@@ -121,6 +125,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHODIMP get_Size(Size* value) override;
         IFACEMETHODIMP get_Bounds(Rect* value) override;
 
+        IFACEMETHODIMP EnsureCachedAsync(Rect region, IAsyncAction** action) override;
+        IFACEMETHODIMP TrimCache(Rect regionToKeep) override;
+        IFACEMETHODIMP PrefetchForPanAsync(Rect visibleRegion, Vector2 panVelocity, float lookAheadSeconds, IAsyncAction** action) override;
+
         // ICanvasImage
         IFACEMETHODIMP GetBounds(ICanvasResourceCreator*, Rect*) override;
         IFACEMETHODIMP GetBoundsWithTransform(ICanvasResourceCreator*, Matrix3x2, Rect*) override;
@@ -133,6 +141,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         // ICanvasImageInternal
         ComPtr<ID2D1Image> GetD2DImage(ICanvasDevice* , ID2D1DeviceContext*, WIN2D_GET_D2D_IMAGE_FLAGS, float, float*) override;
+        uint64_t GetBoundsGeneration() override { return 1; }
+
+    private:
+        ComPtr<ID2D1ImageSourceFromWic> const& GetImageSourceFromWic();
+        D2D1_RECT_U GetSourceRect(Rect const& region) const;
     };
 
 }}}}
\ No newline at end of file
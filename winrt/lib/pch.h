@@ -45,6 +45,7 @@
 #include <mutex>
 #include <queue>
 #include <set>
+#include <shared_mutex>
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
@@ -59,6 +60,7 @@
 #include <d3d11.h>
 #include <dwrite_2.h>
 #include <dxgi1_3.h>
+#include <dxgi1_5.h>
 #include <d2d1effectauthor.h>  
 #include <d2d1effecthelpers.h>
 #include <d3dcompiler.h>
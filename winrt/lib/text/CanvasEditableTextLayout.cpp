@@ -0,0 +1,989 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasEditableTextLayout.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+static bool IsParagraphSeparator(wchar_t c)
+{
+    // The characters DWrite starts a new paragraph at.  U+2028 (line
+    // separator) only breaks the line, so it stays inside the paragraph.
+    return c == L'\r'
+        || c == L'\n'
+        || c == 0x0085
+        || c == 0x2029;
+}
+
+
+//
+// Maps a position in text that had [replaceBegin, replaceEnd) replaced with
+// newTextLength characters to the matching position afterwards.  Positions
+// inside the replaced range, and the replace position itself, end up after
+// the new text, so that formatting running up to an edit extends over the
+// inserted characters while formatting starting there doesn't.
+//
+static uint32_t MapPositionThroughReplace(
+    uint32_t position,
+    uint32_t replaceBegin,
+    uint32_t replaceEnd,
+    uint32_t newTextLength)
+{
+    if (position < replaceBegin)
+        return position;
+
+    if (position >= replaceEnd)
+        return position - replaceEnd + replaceBegin + newTextLength;
+
+    return replaceBegin + newTextLength;
+}
+
+
+static CanvasTextLayoutRegion ToEditableTextLayoutRegion(
+    DWRITE_HIT_TEST_METRICS const& hitTestMetrics,
+    EditableTextParagraph const& paragraph)
+{
+    CanvasTextLayoutRegion region;
+    region.CharacterIndex = paragraph.FirstCharacter + hitTestMetrics.textPosition;
+    region.CharacterCount = hitTestMetrics.length;
+    region.LayoutBounds.X = hitTestMetrics.left;
+    region.LayoutBounds.Y = paragraph.GetOriginY() + hitTestMetrics.top;
+    region.LayoutBounds.Width = hitTestMetrics.width;
+    region.LayoutBounds.Height = hitTestMetrics.height;
+    return region;
+}
+
+
+ComPtr<CanvasEditableTextLayout> CanvasEditableTextLayout::CreateNew(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING textString,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth)
+{
+    uint32_t textLength;
+    auto textBuffer = WindowsGetStringRawBuffer(textString, &textLength);
+    ThrowIfNullPointer(textBuffer, E_INVALIDARG);
+
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto editableTextLayout = Make<CanvasEditableTextLayout>(
+        device.Get(),
+        textFormat,
+        requestedWidth,
+        textBuffer,
+        textLength);
+    CheckMakeResult(editableTextLayout);
+
+    return editableTextLayout;
+}
+
+
+CanvasEditableTextLayout::CanvasEditableTextLayout(
+    ICanvasDevice* device,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth,
+    wchar_t const* text,
+    uint32_t textLength)
+    : m_device(device)
+    , m_textFormat(textFormat)
+    , m_requestedWidth(requestedWidth)
+    , m_validPrefixCount(0)
+{
+    m_paragraphs = CreateParagraphs(text, textLength, true, {});
+}
+
+
+std::vector<EditableTextParagraph> CanvasEditableTextLayout::CreateParagraphs(
+    wchar_t const* text,
+    uint32_t textLength,
+    bool includeFinalParagraph,
+    std::vector<EditableTextFormatting> const& formatting)
+{
+    std::vector<EditableTextParagraph> paragraphs;
+
+    auto addParagraph =
+        [&](uint32_t begin, uint32_t end, uint32_t separatorLength)
+        {
+            EditableTextParagraph paragraph{};
+            paragraph.Text.assign(text + begin, text + end);
+            paragraph.SeparatorLength = separatorLength;
+
+            auto contentEnd = end - separatorLength;
+
+            for (auto const& run : formatting)
+            {
+                auto runBegin = std::max(run.Begin, begin);
+                auto runEnd = std::min(run.End, contentEnd);
+
+                if (runBegin < runEnd)
+                    paragraph.Formatting.push_back(EditableTextFormatting{ runBegin - begin, runEnd - begin, run.Apply });
+            }
+
+            LayOutParagraph(&paragraph);
+
+            paragraphs.push_back(std::move(paragraph));
+        };
+
+    uint32_t paragraphStart = 0;
+
+    for (uint32_t i = 0; i < textLength; ++i)
+    {
+        if (!IsParagraphSeparator(text[i]))
+            continue;
+
+        uint32_t separatorLength = 1;
+
+        if (text[i] == L'\r' && i + 1 < textLength && text[i + 1] == L'\n')
+            separatorLength = 2;
+
+        auto paragraphEnd = i + separatorLength;
+        addParagraph(paragraphStart, paragraphEnd, separatorLength);
+
+        paragraphStart = paragraphEnd;
+        i = paragraphEnd - 1;
+    }
+
+    //
+    // Text that doesn't end with a separator is the final paragraph.  Text
+    // that does end with one is followed by an empty final paragraph, just
+    // as a single DWrite layout shows an empty line after a trailing
+    // newline.
+    //
+    assert(includeFinalParagraph || paragraphStart == textLength);
+
+    if (includeFinalParagraph)
+        addParagraph(paragraphStart, textLength, 0);
+
+    return paragraphs;
+}
+
+
+void CanvasEditableTextLayout::LayOutParagraph(EditableTextParagraph* paragraph)
+{
+    //
+    // Paragraphs are laid out without a height limit, since they're stacked
+    // one after another rather than fitted into a box.
+    //
+    paragraph->Layout = CanvasTextLayout::CreateNew(
+        m_device.EnsureNotClosed().Get(),
+        paragraph->Text.c_str(),
+        paragraph->GetContentLength(),
+        m_textFormat.Get(),
+        m_requestedWidth,
+        std::numeric_limits<float>::max());
+
+    for (auto const& run : paragraph->Formatting)
+    {
+        ThrowIfFailed(run.Apply(
+            paragraph->Layout.Get(),
+            static_cast<int32_t>(run.Begin),
+            static_cast<int32_t>(run.End - run.Begin)));
+    }
+
+    MeasureParagraph(paragraph);
+}
+
+
+void CanvasEditableTextLayout::MeasureParagraph(EditableTextParagraph* paragraph)
+{
+    DWRITE_TEXT_METRICS1 metrics;
+    ThrowIfFailed(paragraph->Layout->GetReadOnlyResource()->GetMetrics(&metrics));
+
+    paragraph->MetricsLeft = metrics.left;
+    paragraph->MetricsTop = metrics.top;
+    paragraph->MetricsWidth = metrics.width;
+    paragraph->MetricsHeight = metrics.height;
+    paragraph->LineCount = metrics.lineCount;
+}
+
+
+void CanvasEditableTextLayout::InvalidatePrefixSums(size_t firstParagraph)
+{
+    m_validPrefixCount = std::min(m_validPrefixCount, firstParagraph);
+}
+
+
+void CanvasEditableTextLayout::EnsurePrefixSums()
+{
+    for (auto i = m_validPrefixCount; i < m_paragraphs.size(); ++i)
+    {
+        auto& paragraph = m_paragraphs[i];
+
+        if (i == 0)
+        {
+            paragraph.FirstCharacter = 0;
+            paragraph.FirstLine = 0;
+            paragraph.Top = 0;
+        }
+        else
+        {
+            auto const& previous = m_paragraphs[i - 1];
+
+            paragraph.FirstCharacter = previous.FirstCharacter + static_cast<uint32_t>(previous.Text.size());
+            paragraph.FirstLine = previous.FirstLine + previous.LineCount;
+            paragraph.Top = previous.Top + previous.MetricsHeight;
+        }
+    }
+
+    m_validPrefixCount = m_paragraphs.size();
+}
+
+
+uint32_t CanvasEditableTextLayout::GetTextLength() const
+{
+    assert(m_validPrefixCount == m_paragraphs.size());
+
+    auto const& last = m_paragraphs.back();
+    return last.FirstCharacter + static_cast<uint32_t>(last.Text.size());
+}
+
+
+size_t CanvasEditableTextLayout::FindParagraphByCharacter(uint32_t characterIndex) const
+{
+    assert(m_validPrefixCount == m_paragraphs.size());
+
+    //
+    // The paragraph containing characterIndex is the last one that starts
+    // at or before it.  The index just past the end of the text belongs to
+    // the final paragraph.
+    //
+    auto it = std::upper_bound(
+        m_paragraphs.begin(),
+        m_paragraphs.end(),
+        characterIndex,
+        [](uint32_t index, EditableTextParagraph const& paragraph) { return index < paragraph.FirstCharacter; });
+
+    return static_cast<size_t>(it - m_paragraphs.begin()) - 1;
+}
+
+
+size_t CanvasEditableTextLayout::FindParagraphByY(float y) const
+{
+    assert(m_validPrefixCount == m_paragraphs.size());
+
+    auto it = std::upper_bound(
+        m_paragraphs.begin(),
+        m_paragraphs.end(),
+        y,
+        [](float value, EditableTextParagraph const& paragraph) { return value < paragraph.Top; });
+
+    if (it == m_paragraphs.begin())
+        return 0;
+
+    return static_cast<size_t>(it - m_paragraphs.begin()) - 1;
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_Device(ICanvasDevice** value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(value);
+
+            ThrowIfFailed(m_device.EnsureNotClosed().CopyTo(value));
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_Text(HSTRING* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(value);
+            m_device.EnsureNotClosed();
+
+            std::wstring text;
+
+            for (auto const& paragraph : m_paragraphs)
+            {
+                text += paragraph.Text;
+            }
+
+            WinString(text).CopyTo(value);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_RequestedWidth(float* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+            m_device.EnsureNotClosed();
+
+            *value = m_requestedWidth;
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::put_RequestedWidth(float value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            m_device.EnsureNotClosed();
+
+            m_requestedWidth = value;
+
+            for (auto& paragraph : m_paragraphs)
+            {
+                ThrowIfFailed(paragraph.Layout->put_RequestedSize(Size{ value, std::numeric_limits<float>::max() }));
+                MeasureParagraph(&paragraph);
+            }
+
+            InvalidatePrefixSums(0);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::ReplaceText(
+    int32_t characterIndex,
+    int32_t characterCount,
+    HSTRING newText)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            ThrowIfNegative(characterIndex);
+            ThrowIfNegative(characterCount);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto textLength = GetTextLength();
+            auto replaceBegin = static_cast<uint32_t>(characterIndex);
+            auto replaceCount = static_cast<uint32_t>(characterCount);
+
+            if (replaceBegin > textLength || replaceCount > textLength - replaceBegin)
+                ThrowHR(E_INVALIDARG);
+
+            uint32_t newTextLength;
+            auto newTextBuffer = WindowsGetStringRawBuffer(newText, &newTextLength);
+
+            auto firstParagraph = FindParagraphByCharacter(replaceBegin);
+            auto lastParagraph = FindParagraphByCharacter(replaceBegin + replaceCount);
+
+            //
+            // Everything from the start of the first affected paragraph to
+            // the end of the last one is split again.  Since the last
+            // paragraph's separator is never inside the replaced range, the
+            // text still ends with a separator unless it's the final
+            // paragraph.
+            //
+            std::wstring text;
+
+            for (auto i = firstParagraph; i <= lastParagraph; ++i)
+            {
+                text += m_paragraphs[i].Text;
+            }
+
+            text.replace(
+                replaceBegin - m_paragraphs[firstParagraph].FirstCharacter,
+                replaceCount,
+                newTextBuffer,
+                newTextLength);
+
+            //
+            // A CR ending the previous paragraph and an LF now starting this
+            // one become a single CRLF separator.
+            //
+            if (firstParagraph > 0 && !text.empty() && text.front() == L'\n')
+            {
+                auto const& previous = m_paragraphs[firstParagraph - 1];
+
+                if (previous.SeparatorLength == 1 && previous.Text.back() == L'\r')
+                {
+                    --firstParagraph;
+                    text.insert(0, previous.Text);
+                }
+            }
+
+            //
+            // Formatting on the affected paragraphs is carried over to the
+            // new ones, moved to where its text ended up.
+            //
+            auto textBegin = m_paragraphs[firstParagraph].FirstCharacter;
+            auto localReplaceBegin = replaceBegin - textBegin;
+            auto localReplaceEnd = localReplaceBegin + replaceCount;
+
+            std::vector<EditableTextFormatting> formatting;
+
+            for (auto i = firstParagraph; i <= lastParagraph; ++i)
+            {
+                auto paragraphBegin = m_paragraphs[i].FirstCharacter - textBegin;
+
+                for (auto const& run : m_paragraphs[i].Formatting)
+                {
+                    auto runBegin = MapPositionThroughReplace(paragraphBegin + run.Begin, localReplaceBegin, localReplaceEnd, newTextLength);
+                    auto runEnd = MapPositionThroughReplace(paragraphBegin + run.End, localReplaceBegin, localReplaceEnd, newTextLength);
+
+                    if (runBegin < runEnd)
+                        formatting.push_back(EditableTextFormatting{ runBegin, runEnd, run.Apply });
+                }
+            }
+
+            bool includeFinalParagraph = (lastParagraph == m_paragraphs.size() - 1);
+
+            auto newParagraphs = CreateParagraphs(
+                text.c_str(),
+                static_cast<uint32_t>(text.size()),
+                includeFinalParagraph,
+                formatting);
+
+            for (auto i = firstParagraph; i <= lastParagraph; ++i)
+            {
+                m_paragraphs[i].Layout->Close();
+            }
+
+            m_paragraphs.erase(
+                m_paragraphs.begin() + firstParagraph,
+                m_paragraphs.begin() + lastParagraph + 1);
+
+            m_paragraphs.insert(
+                m_paragraphs.begin() + firstParagraph,
+                std::make_move_iterator(newParagraphs.begin()),
+                std::make_move_iterator(newParagraphs.end()));
+
+            InvalidatePrefixSums(firstParagraph);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_ParagraphCount(int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+            m_device.EnsureNotClosed();
+
+            *value = static_cast<int32_t>(m_paragraphs.size());
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::GetParagraphIndex(
+    int32_t characterIndex,
+    int32_t* paragraphIndex)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(paragraphIndex);
+            ThrowIfNegative(characterIndex);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            if (static_cast<uint32_t>(characterIndex) > GetTextLength())
+                ThrowHR(E_INVALIDARG);
+
+            *paragraphIndex = static_cast<int32_t>(FindParagraphByCharacter(characterIndex));
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::GetParagraphRegion(
+    int32_t paragraphIndex,
+    CanvasTextLayoutRegion* region)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(region);
+            m_device.EnsureNotClosed();
+
+            if (paragraphIndex < 0 || static_cast<size_t>(paragraphIndex) >= m_paragraphs.size())
+                ThrowHR(E_BOUNDS);
+
+            EnsurePrefixSums();
+
+            auto const& paragraph = m_paragraphs[paragraphIndex];
+
+            region->CharacterIndex = paragraph.FirstCharacter;
+            region->CharacterCount = paragraph.GetContentLength();
+            region->LayoutBounds = Rect{ paragraph.MetricsLeft, paragraph.Top, paragraph.MetricsWidth, paragraph.MetricsHeight };
+        });
+}
+
+
+void CanvasEditableTextLayout::SetFormatting(
+    int32_t characterIndex,
+    int32_t characterCount,
+    bool affectsMetrics,
+    EditableTextFormatting::ApplyFunction const& apply)
+{
+    ThrowIfNegative(characterIndex);
+    ThrowIfNegative(characterCount);
+    m_device.EnsureNotClosed();
+
+    EnsurePrefixSums();
+
+    auto textLength = GetTextLength();
+    auto rangeBegin = std::min(static_cast<uint32_t>(characterIndex), textLength);
+    auto rangeEnd = rangeBegin + std::min(static_cast<uint32_t>(characterCount), textLength - rangeBegin);
+
+    auto firstParagraph = FindParagraphByCharacter(rangeBegin);
+
+    for (auto i = firstParagraph; i < m_paragraphs.size() && m_paragraphs[i].FirstCharacter < rangeEnd; ++i)
+    {
+        auto& paragraph = m_paragraphs[i];
+
+        auto localBegin = std::max(rangeBegin, paragraph.FirstCharacter) - paragraph.FirstCharacter;
+        auto localEnd = std::min(rangeEnd - paragraph.FirstCharacter, paragraph.GetContentLength());
+
+        // The range only covers this paragraph's separator.
+        if (localBegin >= localEnd)
+            continue;
+
+        ThrowIfFailed(apply(
+            paragraph.Layout.Get(),
+            static_cast<int32_t>(localBegin),
+            static_cast<int32_t>(localEnd - localBegin)));
+
+        paragraph.Formatting.push_back(EditableTextFormatting{ localBegin, localEnd, apply });
+
+        if (affectsMetrics)
+            MeasureParagraph(&paragraph);
+    }
+
+    if (affectsMetrics)
+        InvalidatePrefixSums(firstParagraph);
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetColor(
+    int32_t characterIndex,
+    int32_t characterCount,
+    Color color)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, false,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetColor(index, count, color); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetBrush(
+    int32_t characterIndex,
+    int32_t characterCount,
+    ICanvasBrush* brush)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            ComPtr<ICanvasBrush> brushReference(brush);
+
+            SetFormatting(characterIndex, characterCount, false,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetBrush(index, count, brushReference.Get()); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetFontFamily(
+    int32_t characterIndex,
+    int32_t characterCount,
+    HSTRING fontFamily)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            WinString fontFamilyCopy(fontFamily);
+
+            SetFormatting(characterIndex, characterCount, true,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetFontFamily(index, count, fontFamilyCopy); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetFontSize(
+    int32_t characterIndex,
+    int32_t characterCount,
+    float fontSize)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, true,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetFontSize(index, count, fontSize); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetFontStyle(
+    int32_t characterIndex,
+    int32_t characterCount,
+    ABI::Windows::UI::Text::FontStyle fontStyle)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, true,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetFontStyle(index, count, fontStyle); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetFontWeight(
+    int32_t characterIndex,
+    int32_t characterCount,
+    ABI::Windows::UI::Text::FontWeight fontWeight)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, true,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetFontWeight(index, count, fontWeight); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetStrikethrough(
+    int32_t characterIndex,
+    int32_t characterCount,
+    boolean hasStrikethrough)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, false,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetStrikethrough(index, count, hasStrikethrough); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::SetUnderline(
+    int32_t characterIndex,
+    int32_t characterCount,
+    boolean hasUnderline)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            SetFormatting(characterIndex, characterCount, false,
+                [=](CanvasTextLayout* layout, int32_t index, int32_t count) { return layout->SetUnderline(index, count, hasUnderline); });
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_LayoutBounds(Rect* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto left = std::numeric_limits<float>::max();
+            auto right = -std::numeric_limits<float>::max();
+
+            for (auto const& paragraph : m_paragraphs)
+            {
+                left = std::min(left, paragraph.MetricsLeft);
+                right = std::max(right, paragraph.MetricsLeft + paragraph.MetricsWidth);
+            }
+
+            auto const& last = m_paragraphs.back();
+
+            *value = Rect{ left, 0, right - left, last.Top + last.MetricsHeight };
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::get_LineCount(int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto const& last = m_paragraphs.back();
+
+            *value = static_cast<int32_t>(last.FirstLine + last.LineCount);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::HitTest(
+    Vector2 point,
+    CanvasTextLayoutRegion* textLayoutRegion,
+    boolean* trailingSideOfCharacter,
+    boolean* isHit)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(textLayoutRegion);
+            CheckInPointer(trailingSideOfCharacter);
+            CheckInPointer(isHit);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto const& paragraph = m_paragraphs[FindParagraphByY(point.Y)];
+
+            BOOL isTrailingHit;
+            BOOL isInside;
+            DWRITE_HIT_TEST_METRICS hitTestMetrics;
+            ThrowIfFailed(paragraph.Layout->GetReadOnlyResource()->HitTestPoint(
+                point.X,
+                point.Y - paragraph.GetOriginY(),
+                &isTrailingHit,
+                &isInside,
+                &hitTestMetrics));
+
+            *textLayoutRegion = ToEditableTextLayoutRegion(hitTestMetrics, paragraph);
+            *trailingSideOfCharacter = !!isTrailingHit;
+            *isHit = !!isInside;
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::GetCaretPosition(
+    int32_t characterIndex,
+    boolean trailingSideOfCharacter,
+    Vector2* location)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(location);
+            ThrowIfNegative(characterIndex);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto index = std::min(static_cast<uint32_t>(characterIndex), GetTextLength());
+            auto paragraphIndex = FindParagraphByCharacter(index);
+            auto localIndex = index - m_paragraphs[paragraphIndex].FirstCharacter;
+
+            //
+            // Separators aren't part of the paragraph layouts.  The leading
+            // side of one is the end of its paragraph, and the trailing side
+            // is the start of the next.
+            //
+            if (localIndex >= m_paragraphs[paragraphIndex].GetContentLength())
+            {
+                if (trailingSideOfCharacter && paragraphIndex + 1 < m_paragraphs.size())
+                {
+                    ++paragraphIndex;
+                    localIndex = 0;
+                }
+                else
+                {
+                    localIndex = m_paragraphs[paragraphIndex].GetContentLength();
+                }
+
+                trailingSideOfCharacter = false;
+            }
+
+            auto const& paragraph = m_paragraphs[paragraphIndex];
+
+            DWRITE_HIT_TEST_METRICS hitTestMetrics;
+            ThrowIfFailed(paragraph.Layout->GetReadOnlyResource()->HitTestTextPosition(
+                localIndex,
+                trailingSideOfCharacter,
+                &location->X,
+                &location->Y,
+                &hitTestMetrics));
+
+            location->Y += paragraph.GetOriginY();
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::GetCharacterRegions(
+    int32_t characterIndex,
+    int32_t characterCount,
+    uint32_t* hitTestDescriptionCount,
+    CanvasTextLayoutRegion** hitTestDescriptions)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(hitTestDescriptionCount);
+            CheckAndClearOutPointer(hitTestDescriptions);
+            ThrowIfNegative(characterIndex);
+            ThrowIfNegative(characterCount);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto textLength = GetTextLength();
+            auto rangeBegin = std::min(static_cast<uint32_t>(characterIndex), textLength);
+            auto rangeEnd = rangeBegin + std::min(static_cast<uint32_t>(characterCount), textLength - rangeBegin);
+
+            std::vector<CanvasTextLayoutRegion> regions;
+            std::vector<DWRITE_HIT_TEST_METRICS> dwriteHitTestMetrics;
+
+            for (auto i = FindParagraphByCharacter(rangeBegin); i < m_paragraphs.size() && m_paragraphs[i].FirstCharacter < rangeEnd; ++i)
+            {
+                auto const& paragraph = m_paragraphs[i];
+
+                auto localBegin = std::max(rangeBegin, paragraph.FirstCharacter) - paragraph.FirstCharacter;
+                auto localEnd = std::min(rangeEnd - paragraph.FirstCharacter, paragraph.GetContentLength());
+
+                if (localBegin >= localEnd)
+                    continue;
+
+                auto resource = paragraph.Layout->GetReadOnlyResource();
+
+                uint32_t hitTestMetricsCount;
+                HRESULT hitTestHr = resource->HitTestTextRange(localBegin, localEnd - localBegin, 0, 0, nullptr, 0, &hitTestMetricsCount);
+                if (hitTestHr != E_NOT_SUFFICIENT_BUFFER)
+                {
+                    assert(hitTestHr != S_OK);
+                    ThrowHR(hitTestHr);
+                }
+
+                dwriteHitTestMetrics.resize(hitTestMetricsCount);
+
+                ThrowIfFailed(resource->HitTestTextRange(
+                    localBegin,
+                    localEnd - localBegin,
+                    0,
+                    0,
+                    &dwriteHitTestMetrics[0],
+                    hitTestMetricsCount,
+                    &hitTestMetricsCount));
+
+                for (uint32_t j = 0; j < hitTestMetricsCount; ++j)
+                {
+                    regions.push_back(ToEditableTextLayoutRegion(dwriteHitTestMetrics[j], paragraph));
+                }
+            }
+
+            ComArray<CanvasTextLayoutRegion> array(regions.begin(), regions.end());
+            array.Detach(hitTestDescriptionCount, hitTestDescriptions);
+        });
+}
+
+
+void CanvasEditableTextLayout::DrawParagraphs(
+    ICanvasDrawingSession* drawingSession,
+    Vector2 point,
+    size_t firstParagraph,
+    size_t endParagraph,
+    Color color)
+{
+    for (auto i = firstParagraph; i < endParagraph; ++i)
+    {
+        auto const& paragraph = m_paragraphs[i];
+
+        ThrowIfFailed(drawingSession->DrawTextLayoutWithColor(
+            paragraph.Layout.Get(),
+            Vector2{ point.X, point.Y + paragraph.GetOriginY() },
+            color));
+    }
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::Draw(
+    ICanvasDrawingSession* drawingSession,
+    Vector2 point,
+    Color color)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(drawingSession);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            DrawParagraphs(drawingSession, point, 0, m_paragraphs.size(), color);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::DrawRegion(
+    ICanvasDrawingSession* drawingSession,
+    Vector2 point,
+    Rect visibleRegion,
+    Color color)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(drawingSession);
+            m_device.EnsureNotClosed();
+
+            EnsurePrefixSums();
+
+            auto visibleTop = visibleRegion.Y - point.Y;
+            auto visibleBottom = visibleTop + visibleRegion.Height;
+
+            auto firstParagraph = FindParagraphByY(visibleTop);
+            auto endParagraph = firstParagraph;
+
+            while (endParagraph < m_paragraphs.size() && m_paragraphs[endParagraph].Top < visibleBottom)
+            {
+                ++endParagraph;
+            }
+
+            DrawParagraphs(drawingSession, point, firstParagraph, endParagraph, color);
+        });
+}
+
+
+IFACEMETHODIMP CanvasEditableTextLayout::Close()
+{
+    for (auto& paragraph : m_paragraphs)
+    {
+        paragraph.Layout->Close();
+    }
+
+    m_paragraphs.clear();
+    m_textFormat.Reset();
+    m_device.Close();
+
+    return S_OK;
+}
+
+
+//
+// CanvasEditableTextLayoutFactory implementation
+//
+
+IFACEMETHODIMP CanvasEditableTextLayoutFactory::Create(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING textString,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth,
+    ICanvasEditableTextLayout** editableTextLayout)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckInPointer(textFormat);
+            CheckAndClearOutPointer(editableTextLayout);
+
+            auto newEditableTextLayout = CanvasEditableTextLayout::CreateNew(
+                resourceCreator,
+                textString,
+                textFormat,
+                requestedWidth);
+
+            ThrowIfFailed(newEditableTextLayout.CopyTo(editableTextLayout));
+        });
+}
+
+
+ActivatableClassWithFactory(CanvasEditableTextLayout, CanvasEditableTextLayoutFactory);
@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "CanvasTextLayout.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    // Formatting set on part of a paragraph.  It's kept so that it can be
+    // set again when an edit lays the paragraph out from scratch.
+    struct EditableTextFormatting
+    {
+        typedef std::function<HRESULT(CanvasTextLayout* layout, int32_t characterIndex, int32_t characterCount)> ApplyFunction;
+
+        uint32_t Begin;
+        uint32_t End;
+        ApplyFunction Apply;
+    };
+
+
+    struct EditableTextParagraph
+    {
+        // Includes the paragraph separator, if there is one.  The last
+        // paragraph never has a separator.
+        std::wstring Text;
+        uint32_t SeparatorLength;
+
+        // Laid out from Text, excluding the separator.
+        ComPtr<CanvasTextLayout> Layout;
+
+        // In the order it was set, with positions relative to the start of
+        // the paragraph.
+        std::vector<EditableTextFormatting> Formatting;
+
+        // Taken from the layout's metrics.
+        float MetricsLeft;
+        float MetricsTop;
+        float MetricsWidth;
+        float MetricsHeight;
+        uint32_t LineCount;
+
+        // Running totals over the paragraphs before this one.  See
+        // CanvasEditableTextLayout::EnsurePrefixSums.
+        uint32_t FirstCharacter;
+        uint32_t FirstLine;
+        float Top;
+
+        uint32_t GetContentLength() const
+        {
+            return static_cast<uint32_t>(Text.size()) - SeparatorLength;
+        }
+
+        // The layout is drawn with its origin here, so that its first line
+        // starts at Top whatever the format's vertical alignment.
+        float GetOriginY() const
+        {
+            return Top - MetricsTop;
+        }
+    };
+
+
+    //
+    // CanvasEditableTextLayout splits its text at paragraph separators and
+    // keeps a CanvasTextLayout for each paragraph.  Editing the text only
+    // lays out the paragraphs that were touched, and formatting set on the
+    // others survives the edit.  Each paragraph also remembers the formatting
+    // set on it, which is moved along with the text and set again on the
+    // paragraphs an edit lays out.
+    //
+    // Paragraphs are stacked vertically.  The character, line and vertical
+    // offsets of each paragraph are prefix sums over the paragraphs before
+    // it; an edit only invalidates the sums from the first paragraph it
+    // touched, and they are brought up to date the next time something
+    // needs them.  Lookups by character index or y coordinate are then
+    // binary searches.
+    //
+    class CanvasEditableTextLayout
+        : public RuntimeClass<
+            ICanvasEditableTextLayout,
+            IClosable>
+        , private LifespanTracker<CanvasEditableTextLayout>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasEditableTextLayout, BaseTrust);
+
+        ClosablePtr<ICanvasDevice> m_device;
+        ComPtr<ICanvasTextFormat> m_textFormat;
+        float m_requestedWidth;
+
+        std::vector<EditableTextParagraph> m_paragraphs;
+
+        // The prefix sums are valid for this many paragraphs.
+        size_t m_validPrefixCount;
+
+    public:
+        static ComPtr<CanvasEditableTextLayout> CreateNew(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING textString,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth);
+
+        CanvasEditableTextLayout(
+            ICanvasDevice* device,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth,
+            wchar_t const* text,
+            uint32_t textLength);
+
+        //
+        // ICanvasEditableTextLayout
+        //
+
+        IFACEMETHOD(get_Device)(ICanvasDevice** value) override;
+
+        IFACEMETHOD(get_Text)(HSTRING* value) override;
+
+        IFACEMETHOD(get_RequestedWidth)(float* value) override;
+        IFACEMETHOD(put_RequestedWidth)(float value) override;
+
+        IFACEMETHOD(ReplaceText)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            HSTRING newText) override;
+
+        IFACEMETHOD(get_ParagraphCount)(int32_t* value) override;
+
+        IFACEMETHOD(GetParagraphIndex)(
+            int32_t characterIndex,
+            int32_t* paragraphIndex) override;
+
+        IFACEMETHOD(GetParagraphRegion)(
+            int32_t paragraphIndex,
+            CanvasTextLayoutRegion* region) override;
+
+        IFACEMETHOD(SetColor)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            Color color) override;
+
+        IFACEMETHOD(SetBrush)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            ICanvasBrush* brush) override;
+
+        IFACEMETHOD(SetFontFamily)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            HSTRING fontFamily) override;
+
+        IFACEMETHOD(SetFontSize)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            float fontSize) override;
+
+        IFACEMETHOD(SetFontStyle)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            ABI::Windows::UI::Text::FontStyle fontStyle) override;
+
+        IFACEMETHOD(SetFontWeight)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            ABI::Windows::UI::Text::FontWeight fontWeight) override;
+
+        IFACEMETHOD(SetStrikethrough)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            boolean hasStrikethrough) override;
+
+        IFACEMETHOD(SetUnderline)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            boolean hasUnderline) override;
+
+        IFACEMETHOD(get_LayoutBounds)(Rect* value) override;
+
+        IFACEMETHOD(get_LineCount)(int32_t* value) override;
+
+        IFACEMETHOD(HitTest)(
+            Vector2 point,
+            CanvasTextLayoutRegion* textLayoutRegion,
+            boolean* trailingSideOfCharacter,
+            boolean* isHit) override;
+
+        IFACEMETHOD(GetCaretPosition)(
+            int32_t characterIndex,
+            boolean trailingSideOfCharacter,
+            Vector2* location) override;
+
+        IFACEMETHOD(GetCharacterRegions)(
+            int32_t characterIndex,
+            int32_t characterCount,
+            uint32_t* hitTestDescriptionCount,
+            CanvasTextLayoutRegion** hitTestDescriptions) override;
+
+        IFACEMETHOD(Draw)(
+            ICanvasDrawingSession* drawingSession,
+            Vector2 point,
+            Color color) override;
+
+        IFACEMETHOD(DrawRegion)(
+            ICanvasDrawingSession* drawingSession,
+            Vector2 point,
+            Rect visibleRegion,
+            Color color) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        std::vector<EditableTextParagraph> CreateParagraphs(
+            wchar_t const* text,
+            uint32_t textLength,
+            bool includeFinalParagraph,
+            std::vector<EditableTextFormatting> const& formatting);
+
+        void LayOutParagraph(EditableTextParagraph* paragraph);
+        static void MeasureParagraph(EditableTextParagraph* paragraph);
+
+        void InvalidatePrefixSums(size_t firstParagraph);
+        void EnsurePrefixSums();
+
+        // These require the prefix sums to be up to date.
+        uint32_t GetTextLength() const;
+        size_t FindParagraphByCharacter(uint32_t characterIndex) const;
+        size_t FindParagraphByY(float y) const;
+
+        void SetFormatting(
+            int32_t characterIndex,
+            int32_t characterCount,
+            bool affectsMetrics,
+            EditableTextFormatting::ApplyFunction const& apply);
+
+        void DrawParagraphs(
+            ICanvasDrawingSession* drawingSession,
+            Vector2 point,
+            size_t firstParagraph,
+            size_t endParagraph,
+            Color color);
+    };
+
+
+    //
+    // CanvasEditableTextLayoutFactory
+    //
+
+    class CanvasEditableTextLayoutFactory
+        : public AgileActivationFactory<ICanvasEditableTextLayoutFactory>
+        , private LifespanTracker<CanvasEditableTextLayoutFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasEditableTextLayout, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING textString,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth,
+            ICanvasEditableTextLayout** editableTextLayout) override;
+    };
+}}}}}
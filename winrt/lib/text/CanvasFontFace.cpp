@@ -8,6 +8,7 @@
 #include "TextUtilities.h"
 #include "effects/shader/PixelShaderEffect.h"
 #include "DrawGlyphRunHelper.h"
+#include "utils/ScratchBuffer.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas;
 using namespace ABI::Microsoft::Graphics::Canvas::Text;
@@ -552,19 +553,18 @@ IFACEMETHODIMP CanvasFontFace::GetVerticalGlyphVariants(
             CheckInPointer(outputCount);
             CheckAndClearOutPointer(outputElements);
 
-            std::vector<unsigned short> nominalGlyphIndices;
-            nominalGlyphIndices.reserve(inputCount);
+            ScratchBuffer<unsigned short> nominalGlyphIndices(inputCount);
             for (uint32_t i = 0; i < inputCount; ++i)
             {
                 if (inputElements[i] < 0 || inputElements[i] > USHORT_MAX)
                     ThrowHR(E_INVALIDARG);
 
-                nominalGlyphIndices.push_back(static_cast<unsigned short>(inputElements[i]));
+                nominalGlyphIndices[i] = static_cast<unsigned short>(inputElements[i]);
             }
 
-            std::vector<unsigned short> verticalGlyphIndices(inputCount);
+            ScratchBuffer<unsigned short> verticalGlyphIndices(inputCount);
 
-            ThrowIfFailed(GetRealizedFontFace()->GetVerticalGlyphVariants(inputCount, nominalGlyphIndices.data(), verticalGlyphIndices.data()));
+            ThrowIfFailed(GetRealizedFontFace()->GetVerticalGlyphVariants(inputCount, nominalGlyphIndices.GetData(), verticalGlyphIndices.GetData()));
 
             ComArray<int> output(inputCount);
 
@@ -649,9 +649,9 @@ IFACEMETHODIMP CanvasFontFace::GetGlyphIndices(
             CheckInPointer(outputCount);
             CheckAndClearOutPointer(outputElements);
 
-            std::vector<unsigned short> glyphIndices(inputCount);
+            ScratchBuffer<unsigned short> glyphIndices(inputCount);
 
-            ThrowIfFailed(GetRealizedFontFace()->GetGlyphIndices(inputElements, inputCount, glyphIndices.data()));
+            ThrowIfFailed(GetRealizedFontFace()->GetGlyphIndices(inputElements, inputCount, glyphIndices.GetData()));
 
             ComArray<int> output(inputCount);
 
@@ -676,18 +676,17 @@ IFACEMETHODIMP CanvasFontFace::GetGlyphMetrics(
             CheckInPointer(outputCount);
             CheckAndClearOutPointer(outputElements);
 
-            std::vector<unsigned short> glyphIndices;
-            glyphIndices.reserve(inputCount);
+            ScratchBuffer<unsigned short> glyphIndices(inputCount);
             for (uint32_t i = 0; i < inputCount; ++i)
             {
                 if (inputElements[i] < 0 || inputElements[i] > USHORT_MAX)
                     ThrowHR(E_INVALIDARG);
 
-                glyphIndices.push_back(static_cast<unsigned short>(inputElements[i]));
+                glyphIndices[i] = static_cast<unsigned short>(inputElements[i]);
             }
 
-            std::vector<DWRITE_GLYPH_METRICS> glyphMetrics(inputCount);
-            ThrowIfFailed(GetRealizedFontFace()->GetDesignGlyphMetrics(glyphIndices.data(), inputCount, glyphMetrics.data(), isSideways));
+            ScratchBuffer<DWRITE_GLYPH_METRICS> glyphMetrics(inputCount);
+            ThrowIfFailed(GetRealizedFontFace()->GetDesignGlyphMetrics(glyphIndices.GetData(), inputCount, glyphMetrics.GetData(), isSideways));
 
             ComArray<CanvasGlyphMetrics> output(inputCount);
 
@@ -740,18 +739,17 @@ IFACEMETHODIMP CanvasFontFace::GetGdiCompatibleGlyphMetrics(
             CheckInPointer(outputCount);
             CheckAndClearOutPointer(outputElements);
 
-            std::vector<unsigned short> glyphIndices;
-            glyphIndices.reserve(inputCount);
+            ScratchBuffer<unsigned short> glyphIndices(inputCount);
             for (uint32_t i = 0; i < inputCount; ++i)
             {
                 if (inputElements[i] < 0 || inputElements[i] > USHORT_MAX)
                     ThrowHR(E_INVALIDARG);
 
-                glyphIndices.push_back(static_cast<unsigned short>(inputElements[i]));
+                glyphIndices[i] = static_cast<unsigned short>(inputElements[i]);
             }
 
-            std::vector<DWRITE_GLYPH_METRICS> glyphMetrics(inputCount);
-            ThrowIfFailed(GetRealizedFontFace()->GetGdiCompatibleGlyphMetrics(fontSize, DpiToPixelsPerDip(dpi), ReinterpretAs<DWRITE_MATRIX*>(&transform), useGdiNatural, glyphIndices.data(), inputCount, glyphMetrics.data(), isSideways));
+            ScratchBuffer<DWRITE_GLYPH_METRICS> glyphMetrics(inputCount);
+            ThrowIfFailed(GetRealizedFontFace()->GetGdiCompatibleGlyphMetrics(fontSize, DpiToPixelsPerDip(dpi), ReinterpretAs<DWRITE_MATRIX*>(&transform), useGdiNatural, glyphIndices.GetData(), inputCount, glyphMetrics.GetData(), isSideways));
 
             ComArray<CanvasGlyphMetrics> output(inputCount);
 
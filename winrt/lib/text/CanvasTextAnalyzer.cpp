@@ -10,6 +10,7 @@
 #include "CanvasFontFace.h"
 #include "CanvasTypography.h"
 #include "CanvasNumberSubstitution.h"
+#include "utils/ScratchBuffer.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas;
 using namespace ABI::Microsoft::Graphics::Canvas::Text;
@@ -214,6 +215,44 @@ static CanvasAnalyzedScript ToCanvasAnalyzedScript(DWRITE_SCRIPT_ANALYSIS const*
     return analyzedScript;
 }
 
+static CanvasAnalyzedBidi ToCanvasAnalyzedBidi(uint8_t explicitLevel, uint8_t resolvedLevel)
+{
+    CanvasAnalyzedBidi analyzedBidi{};
+
+    analyzedBidi.ExplicitLevel = explicitLevel;
+    analyzedBidi.ResolvedLevel = resolvedLevel;
+
+    return analyzedBidi;
+}
+
+static CanvasAnalyzedBreakpoint ToCanvasAnalyzedBreakpoint(DWRITE_LINE_BREAKPOINT const& dwriteLineBreakpoint)
+{
+    CanvasAnalyzedBreakpoint analyzedBreakpoint{};
+
+    analyzedBreakpoint.BreakBefore = ToCanvasLineBreakCondition(dwriteLineBreakpoint.breakConditionBefore);
+    analyzedBreakpoint.BreakAfter = ToCanvasLineBreakCondition(dwriteLineBreakpoint.breakConditionAfter);
+    analyzedBreakpoint.IsWhitespace = dwriteLineBreakpoint.isWhitespace;
+    analyzedBreakpoint.IsSoftHyphen = dwriteLineBreakpoint.isSoftHyphen;
+
+    return analyzedBreakpoint;
+}
+
+static CanvasAnalyzedGlyphOrientation ToCanvasAnalyzedGlyphOrientation(
+    DWRITE_GLYPH_ORIENTATION_ANGLE dwriteGlyphOrientationAngle,
+    uint8_t adjustedBidiLevel,
+    BOOL isSideways,
+    BOOL isRightToLeft)
+{
+    CanvasAnalyzedGlyphOrientation analyzedGlyphOrientation{};
+
+    analyzedGlyphOrientation.GlyphOrientation = ToCanvasGlyphOrientation(dwriteGlyphOrientationAngle);
+    analyzedGlyphOrientation.AdjustedBidiLevel = adjustedBidiLevel;
+    analyzedGlyphOrientation.IsSideways = !!isSideways;
+    analyzedGlyphOrientation.IsRightToLeft = !!isRightToLeft;
+
+    return analyzedGlyphOrientation;
+}
+
 STDMETHODIMP DWriteTextAnalysisSink::SetBidiLevel(
     uint32_t textPosition,
     uint32_t textLength,
@@ -225,9 +264,7 @@ STDMETHODIMP DWriteTextAnalysisSink::SetBidiLevel(
         {
             EnsureAnalyzedBidi();
 
-            CanvasAnalyzedBidi analyzedBidi{};
-            analyzedBidi.ExplicitLevel = explicitLevel;
-            analyzedBidi.ResolvedLevel = resolvedLevel;
+            auto analyzedBidi = ToCanvasAnalyzedBidi(explicitLevel, resolvedLevel);
 
             auto newPair = MakeCharacterRangeKeyValue(textPosition, textLength, analyzedBidi);
 
@@ -247,12 +284,7 @@ STDMETHODIMP DWriteTextAnalysisSink::SetLineBreakpoints(
 
             for (uint32_t i = 0; i < textLength; ++i)
             {
-                auto& b = m_analyzedLineBreakpoints[textPosition + i];
-
-                b.BreakBefore = ToCanvasLineBreakCondition(dwriteLineBreakpoint[i].breakConditionBefore);
-                b.BreakAfter = ToCanvasLineBreakCondition(dwriteLineBreakpoint[i].breakConditionAfter);
-                b.IsWhitespace = dwriteLineBreakpoint[i].isWhitespace;
-                b.IsSoftHyphen = dwriteLineBreakpoint[i].isSoftHyphen;
+                m_analyzedLineBreakpoints[textPosition + i] = ToCanvasAnalyzedBreakpoint(dwriteLineBreakpoint[i]);
             }
         });
 }
@@ -309,11 +341,11 @@ STDMETHODIMP DWriteTextAnalysisSink::SetGlyphOrientation(
         {
             EnsureAnalyzedGlyphOrientation();
 
-            CanvasAnalyzedGlyphOrientation analyzedGlyphOrientation{};
-            analyzedGlyphOrientation.GlyphOrientation = ToCanvasGlyphOrientation(dwriteGlyphOrientationAngle);
-            analyzedGlyphOrientation.AdjustedBidiLevel = adjustedBidiLevel;
-            analyzedGlyphOrientation.IsSideways = !!isSideways;
-            analyzedGlyphOrientation.IsRightToLeft = !!isRightToLeft;
+            auto analyzedGlyphOrientation = ToCanvasAnalyzedGlyphOrientation(
+                dwriteGlyphOrientationAngle,
+                adjustedBidiLevel,
+                isSideways,
+                isRightToLeft);
 
             auto newPair = MakeCharacterRangeKeyValue(textPosition, textLength, analyzedGlyphOrientation);
 
@@ -418,6 +450,239 @@ void DWriteTextAnalysisSink::EnsureAnalyzedGlyphOrientation()
     }
 }
 
+static bool IsSameScript(CanvasAnalyzedScript const& a, CanvasAnalyzedScript const& b)
+{
+    return a.ScriptIdentifier == b.ScriptIdentifier &&
+           a.Shape == b.Shape;
+}
+
+static bool IsSameBidi(CanvasAnalyzedBidi const& a, CanvasAnalyzedBidi const& b)
+{
+    return a.ExplicitLevel == b.ExplicitLevel &&
+           a.ResolvedLevel == b.ResolvedLevel;
+}
+
+static bool IsSameGlyphOrientation(CanvasAnalyzedGlyphOrientation const& a, CanvasAnalyzedGlyphOrientation const& b)
+{
+    return a.GlyphOrientation == b.GlyphOrientation &&
+           a.AdjustedBidiLevel == b.AdjustedBidiLevel &&
+           a.IsSideways == b.IsSideways &&
+           a.IsRightToLeft == b.IsRightToLeft;
+}
+
+DWriteTextAnalysisRunSink::DWriteTextAnalysisRunSink()
+    : m_textLength(0)
+{
+}
+
+void DWriteTextAnalysisRunSink::Reset(uint32_t textLength)
+{
+    m_textLength = textLength;
+
+    m_scriptRuns.clear();
+    m_bidiRuns.clear();
+    m_glyphOrientationRuns.clear();
+    m_breakpoints.clear();
+}
+
+template<typename T>
+void DWriteTextAnalysisRunSink::AddRun(std::vector<Run<T>>& runs, uint32_t textPosition, uint32_t textLength, T const& value)
+{
+    if (textPosition > m_textLength || textLength > m_textLength - textPosition)
+        ThrowHR(E_INVALIDARG);
+
+    if (textLength == 0)
+        return;
+
+    runs.push_back(Run<T>{ textPosition, textPosition + textLength, value });
+}
+
+STDMETHODIMP DWriteTextAnalysisRunSink::SetBidiLevel(
+    uint32_t textPosition,
+    uint32_t textLength,
+    uint8_t explicitLevel,
+    uint8_t resolvedLevel)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            AddRun(m_bidiRuns, textPosition, textLength, ToCanvasAnalyzedBidi(explicitLevel, resolvedLevel));
+        });
+}
+
+STDMETHODIMP DWriteTextAnalysisRunSink::SetLineBreakpoints(
+    uint32_t textPosition,
+    uint32_t textLength,
+    DWRITE_LINE_BREAKPOINT const* dwriteLineBreakpoint)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            if (textPosition > m_textLength || textLength > m_textLength - textPosition)
+                ThrowHR(E_INVALIDARG);
+
+            // Characters DWrite doesn't report on are left zeroed.
+            if (m_breakpoints.empty())
+                m_breakpoints.resize(m_textLength);
+
+            for (uint32_t i = 0; i < textLength; ++i)
+            {
+                m_breakpoints[textPosition + i] = ToCanvasAnalyzedBreakpoint(dwriteLineBreakpoint[i]);
+            }
+        });
+}
+
+STDMETHODIMP DWriteTextAnalysisRunSink::SetNumberSubstitution(
+    uint32_t,
+    uint32_t,
+    IDWriteNumberSubstitution*)
+{
+    //
+    // Number substitutions are objects rather than plain values, so they
+    // aren't part of the merged runs; GetNumberSubstitutions returns them.
+    //
+    return S_OK;
+}
+
+STDMETHODIMP DWriteTextAnalysisRunSink::SetScriptAnalysis(
+    uint32_t textPosition,
+    uint32_t textLength,
+    DWRITE_SCRIPT_ANALYSIS const* scriptAnalysis)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            AddRun(m_scriptRuns, textPosition, textLength, ToCanvasAnalyzedScript(scriptAnalysis));
+        });
+}
+
+STDMETHODIMP DWriteTextAnalysisRunSink::SetGlyphOrientation(
+    uint32_t textPosition,
+    uint32_t textLength,
+    DWRITE_GLYPH_ORIENTATION_ANGLE dwriteGlyphOrientationAngle,
+    uint8_t adjustedBidiLevel,
+    BOOL isSideways,
+    BOOL isRightToLeft)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            auto analyzedGlyphOrientation = ToCanvasAnalyzedGlyphOrientation(
+                dwriteGlyphOrientationAngle,
+                adjustedBidiLevel,
+                isSideways,
+                isRightToLeft);
+
+            AddRun(m_glyphOrientationRuns, textPosition, textLength, analyzedGlyphOrientation);
+        });
+}
+
+ComArray<CanvasAnalyzedBreakpoint> DWriteTextAnalysisRunSink::GetBreakpoints()
+{
+    return ComArray<CanvasAnalyzedBreakpoint>(m_breakpoints.begin(), m_breakpoints.end());
+}
+
+template<typename T>
+void DWriteTextAnalysisRunSink::AddRunBoundaries(std::vector<Run<T>>& runs)
+{
+    //
+    // DWrite reports runs in text order in practice, but doesn't promise
+    // to, so they're sorted here if need be.
+    //
+    auto isBefore = [](Run<T> const& a, Run<T> const& b) { return a.Begin < b.Begin; };
+
+    if (!std::is_sorted(runs.begin(), runs.end(), isBefore))
+        std::stable_sort(runs.begin(), runs.end(), isBefore);
+
+    for (auto const& run : runs)
+    {
+        m_runBoundaries.push_back(run.Begin);
+        m_runBoundaries.push_back(run.End);
+    }
+}
+
+template<typename T>
+T DWriteTextAnalysisRunSink::FindRunValue(std::vector<Run<T>> const& runs, size_t* cursor, uint32_t textPosition)
+{
+    //
+    // Merged runs are visited in text order, so each cursor only ever moves
+    // forward.
+    //
+    while (*cursor < runs.size() && runs[*cursor].End <= textPosition)
+        ++*cursor;
+
+    if (*cursor < runs.size() && runs[*cursor].Begin <= textPosition)
+        return runs[*cursor].Value;
+
+    return T{};
+}
+
+ComArray<CanvasAnalyzedRun> DWriteTextAnalysisRunSink::GetMergedRuns(CanvasTextAnalysisKinds kinds)
+{
+    bool wantScript = (kinds & CanvasTextAnalysisKinds::Script) != CanvasTextAnalysisKinds::None;
+    bool wantBidi = (kinds & CanvasTextAnalysisKinds::Bidi) != CanvasTextAnalysisKinds::None;
+    bool wantGlyphOrientation = (kinds & CanvasTextAnalysisKinds::GlyphOrientation) != CanvasTextAnalysisKinds::None;
+
+    m_runBoundaries.clear();
+    m_runBoundaries.push_back(0);
+    m_runBoundaries.push_back(m_textLength);
+
+    if (wantScript)
+        AddRunBoundaries(m_scriptRuns);
+
+    if (wantBidi)
+        AddRunBoundaries(m_bidiRuns);
+
+    if (wantGlyphOrientation)
+        AddRunBoundaries(m_glyphOrientationRuns);
+
+    std::sort(m_runBoundaries.begin(), m_runBoundaries.end());
+    m_runBoundaries.erase(std::unique(m_runBoundaries.begin(), m_runBoundaries.end()), m_runBoundaries.end());
+
+    m_mergedRuns.clear();
+
+    size_t scriptCursor = 0;
+    size_t bidiCursor = 0;
+    size_t glyphOrientationCursor = 0;
+
+    for (size_t i = 0; i + 1 < m_runBoundaries.size(); ++i)
+    {
+        auto begin = m_runBoundaries[i];
+        auto end = m_runBoundaries[i + 1];
+
+        CanvasAnalyzedRun run{};
+
+        if (wantScript)
+            run.Script = FindRunValue(m_scriptRuns, &scriptCursor, begin);
+
+        if (wantBidi)
+            run.Bidi = FindRunValue(m_bidiRuns, &bidiCursor, begin);
+
+        if (wantGlyphOrientation)
+            run.GlyphOrientation = FindRunValue(m_glyphOrientationRuns, &glyphOrientationCursor, begin);
+
+        if (!m_mergedRuns.empty())
+        {
+            auto& previous = m_mergedRuns.back();
+
+            if (IsSameScript(previous.Script, run.Script) &&
+                IsSameBidi(previous.Bidi, run.Bidi) &&
+                IsSameGlyphOrientation(previous.GlyphOrientation, run.GlyphOrientation))
+            {
+                previous.CharacterRange.CharacterCount += static_cast<int>(end - begin);
+                continue;
+            }
+        }
+
+        run.CharacterRange.CharacterIndex = static_cast<int>(begin);
+        run.CharacterRange.CharacterCount = static_cast<int>(end - begin);
+
+        m_mergedRuns.push_back(run);
+    }
+
+    return ComArray<CanvasAnalyzedRun>(m_mergedRuns.begin(), m_mergedRuns.end());
+}
+
 CanvasTextAnalyzer::CanvasTextAnalyzer(
     HSTRING text,
     CanvasTextDirection textDirection,
@@ -491,7 +756,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetFonts(
             CheckInPointer(textFormat);
             CheckAndClearOutPointer(result);
 
-            auto dwriteTextFormat = GetWrappedResource<IDWriteTextFormat>(textFormat);
+            auto dwriteTextFormat = GetRealizedTextFormat(textFormat);
 
             WinString localeNameString = GetLocaleName(dwriteTextFormat.Get());
 
@@ -697,6 +962,63 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphOrientationsWithLocale(
         });
 }
 
+IFACEMETHODIMP CanvasTextAnalyzer::Analyze(
+    CanvasTextAnalysisKinds kinds,
+    HSTRING locale,
+    uint32_t* breakpointCount,
+    CanvasAnalyzedBreakpoint** breakpointElements,
+    uint32_t* valueCount,
+    CanvasAnalyzedRun** valueElements)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(breakpointCount);
+            CheckAndClearOutPointer(breakpointElements);
+            CheckInPointer(valueCount);
+            CheckAndClearOutPointer(valueElements);
+
+            if ((kinds & ~CanvasTextAnalysisKinds::All) != CanvasTextAnalysisKinds::None)
+                ThrowHR(E_INVALIDARG);
+
+            WinString localeString(locale);
+            m_dwriteTextAnalysisSource->SetLocaleName(localeString);
+
+            uint32_t textLength;
+            WindowsGetStringRawBuffer(m_text, &textLength);
+
+            if (!m_dwriteTextAnalysisRunSink)
+            {
+                m_dwriteTextAnalysisRunSink = Make<DWriteTextAnalysisRunSink>();
+                CheckMakeResult(m_dwriteTextAnalysisRunSink);
+            }
+
+            m_dwriteTextAnalysisRunSink->Reset(textLength);
+
+            auto const& textAnalyzer = m_customFontManager->GetTextAnalyzer();
+            auto source = m_dwriteTextAnalysisSource.Get();
+            auto sink = m_dwriteTextAnalysisRunSink.Get();
+
+            if ((kinds & CanvasTextAnalysisKinds::Script) != CanvasTextAnalysisKinds::None)
+                ThrowIfFailed(textAnalyzer->AnalyzeScript(source, 0, textLength, sink));
+
+            if ((kinds & CanvasTextAnalysisKinds::Bidi) != CanvasTextAnalysisKinds::None)
+                ThrowIfFailed(textAnalyzer->AnalyzeBidi(source, 0, textLength, sink));
+
+            if ((kinds & CanvasTextAnalysisKinds::Breakpoints) != CanvasTextAnalysisKinds::None)
+                ThrowIfFailed(textAnalyzer->AnalyzeLineBreakpoints(source, 0, textLength, sink));
+
+            if ((kinds & CanvasTextAnalysisKinds::GlyphOrientation) != CanvasTextAnalysisKinds::None)
+                ThrowIfFailed(textAnalyzer->AnalyzeVerticalGlyphOrientation(source, 0, textLength, sink));
+
+            auto breakpoints = m_dwriteTextAnalysisRunSink->GetBreakpoints();
+            auto runs = m_dwriteTextAnalysisRunSink->GetMergedRuns(kinds);
+
+            breakpoints.Detach(breakpointCount, breakpointElements);
+            runs.Detach(valueCount, valueElements);
+        });
+}
+
 WinString ToStringIsoCode(uint32_t code)
 {
     WinStringBuilder builder;
@@ -937,11 +1259,9 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
 
             auto dwriteScriptAnalysis = ToDWriteScriptAnalysis(script);
 
-            std::vector<uint16_t> clusterMap;
-            clusterMap.resize(textLength);
+            ScratchBuffer<uint16_t> clusterMap(textLength);
 
-            std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> shapingTextProperties;
-            shapingTextProperties.resize(textLength);
+            ScratchBuffer<DWRITE_SHAPING_TEXT_PROPERTIES> shapingTextProperties(textLength);
 
             auto dwriteFontFace = As<ICanvasFontFaceInternal>(fontFace)->GetRealizedFontFace();
             
@@ -958,18 +1278,18 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
 
             std::vector<DWRITE_TYPOGRAPHIC_FEATURES> featuresPerSpan;
 
-            std::vector<uint16_t> glyphIndices;
+            ScratchBuffer<uint16_t> glyphIndices;
 
-            std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> shapingGlyphProperties;
+            ScratchBuffer<DWRITE_SHAPING_GLYPH_PROPERTIES> shapingGlyphProperties;
 
             uint32_t actualGlyphCount{};    
             RetryWithIncreasingGlyphCount(
                 textLength,
                 [&](uint32_t maxGlyphCount)
                 {
-                    glyphIndices.resize(maxGlyphCount);
+                    glyphIndices.Resize(maxGlyphCount);
 
-                    shapingGlyphProperties.resize(maxGlyphCount);
+                    shapingGlyphProperties.Resize(maxGlyphCount);
 
                     return m_customFontManager->GetTextAnalyzer()->GetGlyphs(
                         text,
@@ -984,26 +1304,24 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
                         typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
                         typographyRangeCount,
                         maxGlyphCount,
-                        clusterMap.data(),
-                        shapingTextProperties.data(),
-                        glyphIndices.data(),
-                        shapingGlyphProperties.data(),
+                        clusterMap.GetData(),
+                        shapingTextProperties.GetData(),
+                        glyphIndices.GetData(),
+                        shapingGlyphProperties.GetData(),
                         &actualGlyphCount);
                 });
 
-            std::vector<float> glyphAdvances;
-            glyphAdvances.resize(actualGlyphCount);
+            ScratchBuffer<float> glyphAdvances(actualGlyphCount);
 
-            std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
-            glyphOffsets.resize(actualGlyphCount);
+            ScratchBuffer<DWRITE_GLYPH_OFFSET> glyphOffsets(actualGlyphCount);
 
             ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->GetGlyphPlacements(
                 text,
-                clusterMap.data(),
-                shapingTextProperties.data(),
+                clusterMap.GetData(),
+                shapingTextProperties.GetData(),
                 textLength,
-                glyphIndices.data(),
-                shapingGlyphProperties.data(),
+                glyphIndices.GetData(),
+                shapingGlyphProperties.GetData(),
                 actualGlyphCount,
                 dwriteFontFace.Get(),
                 fontSize,
@@ -1014,8 +1332,8 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
                 typographyRanges ? dwriteTypographyRangeData.FeatureDataPointers.data() : nullptr,
                 typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
                 typographyRangeCount,
-                glyphAdvances.data(),
-                glyphOffsets.data()));
+                glyphAdvances.GetData(),
+                glyphOffsets.GetData()));
 
             ComArray<CanvasGlyph> glyphs(actualGlyphCount);
             for (uint32_t i = 0; i < actualGlyphCount; ++i)
@@ -1152,8 +1470,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetJustificationOpportunities(
             //
             const uint32_t glyphCount = glyphShapingResultsCount;
 
-            std::vector<DWRITE_JUSTIFICATION_OPPORTUNITY> dwriteJustificationOpportunities;
-            dwriteJustificationOpportunities.resize(glyphCount);
+            ScratchBuffer<DWRITE_JUSTIFICATION_OPPORTUNITY> dwriteJustificationOpportunities(glyphCount);
 
             ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->GetJustificationOpportunities(
                 dwriteFontFace.Get(),
@@ -1164,7 +1481,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetJustificationOpportunities(
                 text,
                 dwriteClusterMap.data(),
                 dwriteShapingGlyphProperties.data(),
-                dwriteJustificationOpportunities.data()));
+                dwriteJustificationOpportunities.GetData()));
 
             auto output = TransformToComArray<CanvasJustificationOpportunity>(dwriteJustificationOpportunities.begin(), dwriteJustificationOpportunities.end(),
                 [](DWRITE_JUSTIFICATION_OPPORTUNITY value)
@@ -1200,8 +1517,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::ApplyJustificationOpportunities(
         {
             const uint32_t glyphCount = sourceGlyphsElementsCount;
 
-            std::vector<DWRITE_JUSTIFICATION_OPPORTUNITY> dwriteJustificationOpportunities;
-            dwriteJustificationOpportunities.resize(justificationOpportunitiesCount);
+            ScratchBuffer<DWRITE_JUSTIFICATION_OPPORTUNITY> dwriteJustificationOpportunities(justificationOpportunitiesCount);
             for (uint32_t i = 0; i < justificationOpportunitiesCount; i++)
             {
                 dwriteJustificationOpportunities[i].allowResidualCompression = justificationOpportunitiesElements[i].AllowResidualCompression;
@@ -1220,19 +1536,17 @@ IFACEMETHODIMP CanvasTextAnalyzer::ApplyJustificationOpportunities(
                 sourceGlyphsElements, 
                 static_cast<int>(DWriteGlyphField::Advances) | static_cast<int>(DWriteGlyphField::Offsets));
 
-            std::vector<float> newDwriteGlyphAdvances;
-            std::vector<DWRITE_GLYPH_OFFSET> newDwriteGlyphOffsets;
-            newDwriteGlyphAdvances.resize(glyphCount);
-            newDwriteGlyphOffsets.resize(glyphCount);
+            ScratchBuffer<float> newDwriteGlyphAdvances(glyphCount);
+            ScratchBuffer<DWRITE_GLYPH_OFFSET> newDwriteGlyphOffsets(glyphCount);
 
             ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->JustifyGlyphAdvances(
                 lineWidth,
                 glyphCount,
-                dwriteJustificationOpportunities.data(),
+                dwriteJustificationOpportunities.GetData(),
                 dwriteGlyphData.Advances.data(),
                 dwriteGlyphData.Offsets.data(),
-                newDwriteGlyphAdvances.data(),
-                newDwriteGlyphOffsets.data()));
+                newDwriteGlyphAdvances.GetData(),
+                newDwriteGlyphOffsets.GetData()));
 
             ComArray<CanvasGlyph> newGlyphs(glyphCount);
             for (uint32_t i = 0; i < glyphCount; ++i)
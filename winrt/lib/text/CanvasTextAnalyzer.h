@@ -131,6 +131,86 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
     };
 
+    //
+    // Collects the results of several analyses in one sink, for
+    // CanvasTextAnalyzer::Analyze.  Runs are kept as plain vectors rather
+    // than WinRT collections, and the sink is reused between calls so that
+    // its storage only grows when a longer text is analyzed.
+    //
+    class DWriteTextAnalysisRunSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IDWriteTextAnalysisSink1>,
+        private LifespanTracker<DWriteTextAnalysisRunSink>
+    {
+        template<typename T>
+        struct Run
+        {
+            uint32_t Begin;
+            uint32_t End;
+            T Value;
+        };
+
+        uint32_t m_textLength;
+
+        std::vector<Run<CanvasAnalyzedScript>> m_scriptRuns;
+        std::vector<Run<CanvasAnalyzedBidi>> m_bidiRuns;
+        std::vector<Run<CanvasAnalyzedGlyphOrientation>> m_glyphOrientationRuns;
+        std::vector<CanvasAnalyzedBreakpoint> m_breakpoints;
+
+        std::vector<uint32_t> m_runBoundaries;
+        std::vector<CanvasAnalyzedRun> m_mergedRuns;
+
+    public:
+        DWriteTextAnalysisRunSink();
+
+        void Reset(uint32_t textLength);
+
+        STDMETHOD(SetBidiLevel)(
+            uint32_t textPosition,
+            uint32_t textLength,
+            uint8_t explicitLevel,
+            uint8_t resolvedLevel) override;
+
+        STDMETHOD(SetLineBreakpoints)(
+            uint32_t textPosition,
+            uint32_t textLength,
+            DWRITE_LINE_BREAKPOINT const* dwriteLineBreakpoint) override;
+
+        STDMETHOD(SetNumberSubstitution)(
+            uint32_t textPosition,
+            uint32_t textLength,
+            IDWriteNumberSubstitution* dwriteNumberSubstitution) override;
+
+        STDMETHOD(SetScriptAnalysis)(
+            uint32_t textPosition,
+            uint32_t textLength,
+            DWRITE_SCRIPT_ANALYSIS const* scriptAnalysis) override;
+
+        IFACEMETHODIMP SetGlyphOrientation(
+            uint32_t textPosition,
+            uint32_t textLength,
+            DWRITE_GLYPH_ORIENTATION_ANGLE dwriteGlyphOrientationAngle,
+            uint8_t adjustedBidiLevel,
+            BOOL isSideways,
+            BOOL isRightToLeft) override;
+
+        ComArray<CanvasAnalyzedBreakpoint> GetBreakpoints();
+
+        //
+        // Splits the text wherever any of the requested analyses change, and
+        // joins neighboring runs where none of them do.
+        //
+        ComArray<CanvasAnalyzedRun> GetMergedRuns(CanvasTextAnalysisKinds kinds);
+
+    private:
+        template<typename T>
+        void AddRun(std::vector<Run<T>>& runs, uint32_t textPosition, uint32_t textLength, T const& value);
+
+        template<typename T>
+        void AddRunBoundaries(std::vector<Run<T>>& runs);
+
+        template<typename T>
+        static T FindRunValue(std::vector<Run<T>> const& runs, size_t* cursor, uint32_t textPosition);
+    };
+
     class CanvasTextAnalyzer : public RuntimeClass<
         RuntimeClassFlags<WinRtClassicComMix>,
         ICanvasTextAnalyzer>,
@@ -149,6 +229,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ComPtr<DWriteTextAnalysisSource> m_dwriteTextAnalysisSource;
         ComPtr<DWriteTextAnalysisSink> m_dwriteTextAnalysisSink;
+        ComPtr<DWriteTextAnalysisRunSink> m_dwriteTextAnalysisRunSink;
 
     public:
         CanvasTextAnalyzer(
@@ -205,6 +286,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             HSTRING locale,
             IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedGlyphOrientation>*>** values) override;
 
+        IFACEMETHOD(Analyze)(
+            CanvasTextAnalysisKinds kinds,
+            HSTRING locale,
+            uint32_t* breakpointCount,
+            CanvasAnalyzedBreakpoint** breakpointElements,
+            uint32_t* valueCount,
+            CanvasAnalyzedRun** valueElements) override;
+
         IFACEMETHOD(GetScriptProperties)(
             CanvasAnalyzedScript analyzedScript,
             CanvasScriptProperties* scriptProperties) override;
@@ -0,0 +1,616 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasTextCache.h"
+#include "CustomFontManager.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+float const CanvasTextCache::MaximumScale = 16.0f;
+
+
+//
+// CanvasTextCacheKey
+//
+
+static bool IsSameColor(D2D1_COLOR_F const& a, D2D1_COLOR_F const& b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+
+bool CanvasTextCacheKey::operator==(CanvasTextCacheKey const& other) const
+{
+    return FormatGeneration == other.FormatGeneration
+        && WordWrapping == other.WordWrapping
+        && LayoutWidth == other.LayoutWidth
+        && LayoutHeight == other.LayoutHeight
+        && Options == other.Options
+        && AntialiasMode == other.AntialiasMode
+        && RenderingParams == other.RenderingParams
+        && RasterScale == other.RasterScale
+        && IsSameColor(Color, other.Color)
+        && Text == other.Text;
+}
+
+
+template<typename T>
+static void HashCombine(size_t* hash, T const& value)
+{
+    *hash ^= std::hash<T>()(value) + 0x9e3779b9 + (*hash << 6) + (*hash >> 2);
+}
+
+
+size_t CanvasTextCacheKeyHash::operator()(CanvasTextCacheKey const& key) const
+{
+    size_t hash = std::hash<std::wstring>()(key.Text);
+
+    HashCombine(&hash, key.FormatGeneration);
+    HashCombine(&hash, key.LayoutWidth);
+    HashCombine(&hash, key.LayoutHeight);
+    HashCombine(&hash, key.RasterScale);
+    HashCombine(&hash, static_cast<uint32_t>(key.Options));
+    HashCombine(&hash, key.Color.r);
+    HashCombine(&hash, key.Color.g);
+    HashCombine(&hash, key.Color.b);
+    HashCombine(&hash, key.Color.a);
+
+    return hash;
+}
+
+
+//
+// CanvasTextCacheFactory
+//
+
+IFACEMETHODIMP CanvasTextCacheFactory::Create(
+    ICanvasResourceCreator* resourceCreator,
+    ICanvasTextCache** textCache)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckAndClearOutPointer(textCache);
+
+            ComPtr<ICanvasDevice> device;
+            ThrowIfFailed(resourceCreator->get_Device(&device));
+
+            auto newTextCache = Make<CanvasTextCache>(device.Get());
+            CheckMakeResult(newTextCache);
+
+            ThrowIfFailed(newTextCache.CopyTo(textCache));
+        });
+}
+
+
+//
+// CanvasTextCache
+//
+
+CanvasTextCache::CanvasTextCache(ICanvasDevice* device)
+    : m_device(device)
+    , m_d2dDevice(As<ICanvasDeviceInternal>(device)->GetD2DDevice())
+    , m_atlas(PageSize, DefaultMaximumPageCount)
+    , m_hitCount(0)
+    , m_missCount(0)
+    , m_evictionCount(0)
+    , m_pinEpoch(0)
+{
+}
+
+
+IFACEMETHODIMP CanvasTextCache::get_MaximumPageCount(int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            Lock lock(m_mutex);
+            m_device.EnsureNotClosed();
+
+            *value = static_cast<int32_t>(m_atlas.GetMaximumPageCount());
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::put_MaximumPageCount(int32_t value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            if (value <= 0)
+                ThrowHR(E_INVALIDARG);
+
+            Lock lock(m_mutex);
+            m_device.EnsureNotClosed();
+
+            if (m_atlas.SetMaximumPageCount(static_cast<uint32_t>(value)))
+            {
+                m_evictionCount += m_entries.size();
+                ClearPages();
+            }
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::get_PageSize(int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            *value = static_cast<int32_t>(PageSize);
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::get_Statistics(CanvasTextCacheStatistics* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            Lock lock(m_mutex);
+            m_device.EnsureNotClosed();
+
+            value->HitCount = m_hitCount;
+            value->MissCount = m_missCount;
+            value->EvictionCount = m_evictionCount;
+            value->EntryCount = static_cast<int32_t>(m_entries.size());
+            value->PageCount = static_cast<int32_t>(m_atlas.GetPageCount());
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::ResetStatistics()
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            Lock lock(m_mutex);
+            m_device.EnsureNotClosed();
+
+            m_hitCount = 0;
+            m_missCount = 0;
+            m_evictionCount = 0;
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::Clear()
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            Lock lock(m_mutex);
+            m_device.EnsureNotClosed();
+
+            ClearPages();
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextCache::Close()
+{
+    Lock lock(m_mutex);
+
+    ClearPages();
+    m_d2dDevice.Reset();
+    m_device.Close();
+
+    return S_OK;
+}
+
+
+IFACEMETHODIMP CanvasTextCache::get_Device(ICanvasDevice** value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(value);
+
+            ThrowIfFailed(m_device.EnsureNotClosed().CopyTo(value));
+        });
+}
+
+
+ComPtr<ID2D1Device1> CanvasTextCache::GetD2DDevice()
+{
+    Lock lock(m_mutex);
+    m_device.EnsureNotClosed();
+
+    return m_d2dDevice;
+}
+
+
+float CanvasTextCache::GetRasterScale(float scale)
+{
+    auto bucket = std::round(std::log2(scale) * 4.0f);
+    return std::exp2(bucket / 4.0f);
+}
+
+
+static bool IsCacheableTransform(D2D1_MATRIX_3X2_F const& transform, float* scale)
+{
+    // Only axis aligned, unflipped, uniform scales are cached.
+    if (transform._12 != 0 || transform._21 != 0)
+        return false;
+
+    if (transform._11 <= 0 || transform._11 != transform._22)
+        return false;
+
+    if (transform._11 > CanvasTextCache::MaximumScale || transform._11 < 1.0f / CanvasTextCache::MaximumScale)
+        return false;
+
+    *scale = transform._11;
+    return true;
+}
+
+
+bool CanvasTextCache::TryDrawText(
+    CanvasTextCacheBatch* batch,
+    ID2D1DeviceContext1* deviceContext,
+    wchar_t const* text,
+    uint32_t textLength,
+    D2D1_RECT_F const& layoutRect,
+    ID2D1Brush* brush,
+    IDWriteTextFormat* realizedFormat,
+    uint64_t formatGeneration,
+    D2D1_DRAW_TEXT_OPTIONS options)
+{
+    Lock lock(m_mutex);
+
+    m_device.EnsureNotClosed();
+
+    //
+    // Work out whether this draw can be cached.
+    //
+
+    auto solidColorBrush = MaybeAs<ID2D1SolidColorBrush>(brush);
+    if (!solidColorBrush)
+        return false;
+
+    auto deviceContext3 = MaybeAs<ID2D1DeviceContext3>(deviceContext);
+    if (!deviceContext3)
+        return false;
+
+    if (textLength == 0)
+        return false;
+
+    // The pages have an alpha channel, so only grayscale and aliased text
+    // can be cached.  DEFAULT is usually ClearType on opaque targets.
+    auto antialiasMode = deviceContext->GetTextAntialiasMode();
+    if (antialiasMode != D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE && antialiasMode != D2D1_TEXT_ANTIALIAS_MODE_ALIASED)
+        return false;
+
+    D2D1_MATRIX_3X2_F transform;
+    deviceContext->GetTransform(&transform);
+
+    float scale;
+    if (!IsCacheableTransform(transform, &scale))
+        return false;
+
+    float layoutWidth = layoutRect.right - layoutRect.left;
+    float layoutHeight = layoutRect.bottom - layoutRect.top;
+
+    if (!(layoutWidth >= 0) || !(layoutHeight >= 0))
+        return false;
+
+    // Pixels per unit: in DIPs mode the DPI scales units into pixels, in
+    // pixels mode units already are pixels.
+    float unitScale = (deviceContext->GetUnitMode() == D2D1_UNIT_MODE_PIXELS) ? 1.0f : GetDpi(deviceContext) / DEFAULT_DPI;
+
+    auto color = solidColorBrush->GetColor();
+    color.a *= solidColorBrush->GetOpacity();
+
+    bool isColor = (options & D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT) != 0;
+
+    CanvasTextCacheKey key;
+    key.Text.assign(text, textLength);
+    key.FormatGeneration = formatGeneration;
+    key.WordWrapping = realizedFormat->GetWordWrapping();
+    key.LayoutWidth = layoutWidth;
+    key.LayoutHeight = layoutHeight;
+    key.Options = options;
+    key.AntialiasMode = antialiasMode;
+    deviceContext->GetTextRenderingParams(&key.RenderingParams);
+    key.RasterScale = GetRasterScale(scale) * unitScale;
+    key.Color = isColor ? color : D2D1_COLOR_F{ 0, 0, 0, 0 };
+
+    //
+    // Find or create the entry.  Pins from before the cache was last cleared
+    // no longer mean anything; the pages they referred to are gone.
+    //
+
+    if (batch->PinEpoch != m_pinEpoch)
+    {
+        batch->PinnedPages.clear();
+        batch->PinEpoch = m_pinEpoch;
+    }
+
+    auto entry = FindOrCreateEntry(std::move(key), realizedFormat);
+    if (!entry)
+        return false;
+
+    //
+    // Draw it.  Unless pixel snapping has been turned off, the layout origin
+    // is snapped to a device pixel in the same way that Direct2D snaps text.
+    //
+
+    float originX = layoutRect.left;
+    float originY = layoutRect.top;
+
+    if ((options & D2D1_DRAW_TEXT_OPTIONS_NO_SNAP) == 0)
+    {
+        originX = (std::round((originX * scale + transform._31) * unitScale) / unitScale - transform._31) / scale;
+        originY = (std::round((originY * scale + transform._32) * unitScale) / unitScale - transform._32) / scale;
+    }
+
+    D2D1_RECT_F destinationRect{
+        originX + entry->Bounds.left,
+        originY + entry->Bounds.top,
+        originX + entry->Bounds.right,
+        originY + entry->Bounds.bottom };
+
+    Vector4 tint = entry->IsColor
+        ? Vector4{ 1, 1, 1, 1 }
+        : Vector4{ color.r, color.g, color.b, color.a };
+
+    if (!batch->SpriteBatch)
+    {
+        auto spriteBatch = Make<CanvasSpriteBatch>(
+            deviceContext3,
+            CanvasSpriteSortMode::None,
+            D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+            D2D1_SPRITE_OPTIONS_CLAMP_TO_SOURCE_RECTANGLE);
+        CheckMakeResult(spriteBatch);
+
+        batch->SpriteBatch = spriteBatch;
+    }
+
+    batch->SpriteBatch->DrawD2DBitmap(m_pages[entry->Page], destinationRect, entry->SourceRect, tint);
+
+    PinPage(batch, entry->Page);
+
+    return true;
+}
+
+
+void CanvasTextCache::FlushBatch(CanvasTextCacheBatch* batch)
+{
+    auto spriteBatch = std::move(batch->SpriteBatch);
+    auto pinnedPages = std::move(batch->PinnedPages);
+    batch->PinnedPages.clear();
+
+    if (!spriteBatch)
+        return;
+
+    // The pages stay pinned until the sprites have been drawn.
+    HRESULT hr = spriteBatch->Close();
+
+    Lock lock(m_mutex);
+
+    if (batch->PinEpoch == m_pinEpoch)
+    {
+        for (auto page : pinnedPages)
+            m_atlas.Unpin(page);
+    }
+
+    ThrowIfFailed(hr);
+}
+
+
+void CanvasTextCache::PinPage(CanvasTextCacheBatch* batch, uint32_t page)
+{
+    auto& pinnedPages = batch->PinnedPages;
+
+    if (std::find(pinnedPages.begin(), pinnedPages.end(), page) != pinnedPages.end())
+        return;
+
+    m_atlas.Pin(page);
+    pinnedPages.push_back(page);
+}
+
+
+void CanvasTextCache::ClearPages()
+{
+    // Batches that are still open keep their own references to the old
+    // pages, so those are never redrawn.
+    m_entries.clear();
+    m_pages.clear();
+    m_atlas.Clear();
+    m_pinEpoch++;
+}
+
+
+CanvasTextCache::Entry const* CanvasTextCache::FindOrCreateEntry(CanvasTextCacheKey&& key, IDWriteTextFormat* realizedFormat)
+{
+    auto it = m_entries.find(key);
+
+    if (it != m_entries.end())
+    {
+        m_atlas.Touch(it->second.Page);
+        m_hitCount++;
+        return &it->second;
+    }
+
+    Entry entry;
+    if (!TryRasterize(key, realizedFormat, &entry))
+        return nullptr;
+
+    m_missCount++;
+
+    return &m_entries.emplace(std::move(key), entry).first->second;
+}
+
+
+bool CanvasTextCache::TryRasterize(CanvasTextCacheKey const& key, IDWriteTextFormat* realizedFormat, Entry* entry)
+{
+    //
+    // Measure the ink, using the same layout Direct2D would build for DrawText.
+    //
+
+    auto dwriteFactory = CustomFontManager::GetInstance()->GetSharedFactory();
+
+    ComPtr<IDWriteTextLayout> textLayout;
+    ThrowIfFailed(dwriteFactory->CreateTextLayout(
+        key.Text.c_str(),
+        static_cast<uint32_t>(key.Text.size()),
+        realizedFormat,
+        key.LayoutWidth,
+        key.LayoutHeight,
+        &textLayout));
+
+    DWRITE_OVERHANG_METRICS overhang;
+    ThrowIfFailed(textLayout->GetOverhangMetrics(&overhang));
+
+    D2D1_RECT_F ink{
+        -overhang.left,
+        -overhang.top,
+        key.LayoutWidth + overhang.right,
+        key.LayoutHeight + overhang.bottom };
+
+    if (key.Options & D2D1_DRAW_TEXT_OPTIONS_CLIP)
+    {
+        ink.left = std::max(ink.left, 0.0f);
+        ink.top = std::max(ink.top, 0.0f);
+        ink.right = std::min(ink.right, key.LayoutWidth);
+        ink.bottom = std::min(ink.bottom, key.LayoutHeight);
+    }
+
+    //
+    // Convert to whole pixels, with a one pixel border so that linear
+    // filtering has transparent pixels to blend with at the edges.
+    //
+
+    auto k = key.RasterScale;
+    auto pageSize = static_cast<float>(PageSize);
+
+    auto left = std::floor(ink.left * k) - 1;
+    auto top = std::floor(ink.top * k) - 1;
+    auto right = std::max(std::ceil(ink.right * k) + 1, left + 2);
+    auto bottom = std::max(std::ceil(ink.bottom * k) + 1, top + 2);
+
+    if (!(right - left <= pageSize) || !(bottom - top <= pageSize))
+        return false;
+
+    auto width = static_cast<uint32_t>(right - left);
+    auto height = static_cast<uint32_t>(bottom - top);
+
+    TextCacheAtlas::Allocation allocation;
+    uint32_t evictedPage;
+
+    if (!m_atlas.Allocate(width, height, &allocation, &evictedPage))
+        return false;
+
+    if (evictedPage != TextCacheAtlas::NoPage)
+        EvictPage(evictedPage);
+
+    //
+    // Render into the page.
+    //
+
+    auto deviceInternal = As<ICanvasDeviceInternal>(m_device.EnsureNotClosed());
+    auto deviceContext = deviceInternal->GetResourceCreationDeviceContext();
+
+    if (allocation.Page == m_pages.size())
+    {
+        auto bitmapProperties = D2D1::BitmapProperties1(
+            D2D1_BITMAP_OPTIONS_TARGET,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+
+        ComPtr<ID2D1Bitmap1> page;
+        ThrowIfFailed(deviceContext->CreateBitmap(D2D1_SIZE_U{ PageSize, PageSize }, nullptr, 0, &bitmapProperties, &page));
+
+        m_pages.push_back(page);
+    }
+
+    auto& page = m_pages[allocation.Page];
+    auto& rect = allocation.Rect;
+
+    ComPtr<ID2D1SolidColorBrush> brush;
+    ThrowIfFailed(deviceContext->CreateSolidColorBrush(
+        (key.Options & D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT) ? key.Color : D2D1_COLOR_F{ 1, 1, 1, 1 },
+        nullptr,
+        &brush));
+
+    //
+    // The resource creation context is shared with the rest of the device,
+    // so put back whatever state we change on it.
+    //
+
+    D2D1_MATRIX_3X2_F previousTransform;
+    deviceContext->GetTransform(&previousTransform);
+    auto previousTextAntialiasMode = deviceContext->GetTextAntialiasMode();
+    ComPtr<IDWriteRenderingParams> previousTextRenderingParams;
+    deviceContext->GetTextRenderingParams(&previousTextRenderingParams);
+
+    auto restoreStateWarden = MakeScopeWarden(
+        [&]
+        {
+            deviceContext->SetTransform(&previousTransform);
+            deviceContext->SetTextAntialiasMode(previousTextAntialiasMode);
+            deviceContext->SetTextRenderingParams(previousTextRenderingParams.Get());
+        });
+
+    deviceContext->SetTarget(page.Get());
+    auto clearTargetWarden = MakeScopeWarden([&] { deviceContext->SetTarget(nullptr); });
+
+    deviceContext->BeginDraw();
+
+    deviceContext->PushAxisAlignedClip(
+        D2D1_RECT_F{ static_cast<float>(rect.left), static_cast<float>(rect.top), static_cast<float>(rect.right), static_cast<float>(rect.bottom) },
+        D2D1_ANTIALIAS_MODE_ALIASED);
+    deviceContext->Clear(D2D1_COLOR_F{ 0, 0, 0, 0 });
+
+    deviceContext->SetTransform(
+        D2D1::Matrix3x2F::Scale(k, k) *
+        D2D1::Matrix3x2F::Translation(rect.left - left, rect.top - top));
+
+    // The page has an alpha channel, so ClearType isn't available.
+    deviceContext->SetTextAntialiasMode(
+        key.AntialiasMode == D2D1_TEXT_ANTIALIAS_MODE_ALIASED ? D2D1_TEXT_ANTIALIAS_MODE_ALIASED : D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    deviceContext->SetTextRenderingParams(key.RenderingParams.Get());
+
+    deviceContext->DrawTextLayout(D2D1_POINT_2F{ 0, 0 }, textLayout.Get(), brush.Get(), key.Options);
+
+    deviceContext->PopAxisAlignedClip();
+
+    ThrowIfFailed(deviceContext->EndDraw());
+
+    entry->Page = allocation.Page;
+    entry->SourceRect = rect;
+    entry->Bounds = D2D1_RECT_F{ left / k, top / k, right / k, bottom / k };
+    entry->IsColor = (key.Options & D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT) != 0;
+
+    return true;
+}
+
+
+void CanvasTextCache::EvictPage(uint32_t page)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (it->second.Page == page)
+        {
+            it = m_entries.erase(it);
+            m_evictionCount++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+ActivatableClassWithFactory(CanvasTextCache, CanvasTextCacheFactory);
@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "TextCacheAtlas.h"
+#include "drawing/CanvasSpriteBatch.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // Cached text that has been drawn, but not yet submitted to the device
+    // context.  CanvasDrawingSession keeps one of these open across
+    // consecutive cached DrawText calls, so that they are drawn with a single
+    // sprite batch, and flushes it before anything else uses the device
+    // context.
+    //
+    struct CanvasTextCacheBatch
+    {
+        ComPtr<CanvasSpriteBatch> SpriteBatch;
+
+        // Pages that SpriteBatch samples from.  They are pinned so that the
+        // cache doesn't evict and redraw them until the batch has been drawn.
+        std::vector<uint32_t> PinnedPages;
+
+        // The cache's pin epoch when the pages were pinned; pins from an
+        // earlier epoch were dropped when the cache was cleared.
+        uint64_t PinEpoch;
+    };
+
+
+    //
+    // ICanvasTextCacheInternal
+    //
+
+    class __declspec(uuid("28FD2FFE-C96C-4998-AD83-6015BB8F9A19"))
+    ICanvasTextCacheInternal : public IUnknown
+    {
+    public:
+        virtual ComPtr<ID2D1Device1> GetD2DDevice() = 0;
+
+        //
+        // Adds text from the cache to batch, rasterizing it into the cache
+        // first if necessary.  Returns false if this draw can't be cached (eg.
+        // the brush isn't a solid color, or the transform rotates), in which
+        // case nothing has been added and the caller should flush the batch
+        // and draw the text normally.
+        //
+        // The batch must be flushed before the device context is used for
+        // anything else, since its sprites are drawn with the device
+        // context's state at the time it is flushed.
+        //
+        // formatGeneration identifies the format and its current state (see
+        // ICanvasTextFormatInternal::GetGeneration); 0 is reserved for the
+        // drawing session's default format.
+        //
+        virtual bool TryDrawText(
+            CanvasTextCacheBatch* batch,
+            ID2D1DeviceContext1* deviceContext,
+            wchar_t const* text,
+            uint32_t textLength,
+            D2D1_RECT_F const& layoutRect,
+            ID2D1Brush* brush,
+            IDWriteTextFormat* realizedFormat,
+            uint64_t formatGeneration,
+            D2D1_DRAW_TEXT_OPTIONS options) = 0;
+
+        // Draws the batch's sprites and unpins its pages.  This is allowed
+        // after the cache has been closed.
+        virtual void FlushBatch(CanvasTextCacheBatch* batch) = 0;
+    };
+
+
+    //
+    // Everything that affects the pixels produced for a cached string.
+    //
+    struct CanvasTextCacheKey
+    {
+        std::wstring Text;
+        uint64_t FormatGeneration;
+        DWRITE_WORD_WRAPPING WordWrapping;
+        float LayoutWidth;
+        float LayoutHeight;
+        D2D1_DRAW_TEXT_OPTIONS Options;
+        D2D1_TEXT_ANTIALIAS_MODE AntialiasMode;
+        ComPtr<IDWriteRenderingParams> RenderingParams;
+
+        // Pixels per unit that the text was rasterized at.
+        float RasterScale;
+
+        // Color glyphs are rendered in their own colors, so text drawn with
+        // EnableColorFont is rasterized in the final color.  Everything else
+        // is rasterized in white and tinted when drawn, so Color is left
+        // transparent black to let all colors share the entry.
+        D2D1_COLOR_F Color;
+
+        bool operator==(CanvasTextCacheKey const& other) const;
+    };
+
+    struct CanvasTextCacheKeyHash
+    {
+        size_t operator()(CanvasTextCacheKey const& key) const;
+    };
+
+
+    //
+    // CanvasTextCache keeps rasterized copies of strings drawn through
+    // CanvasDrawingSession.DrawText, packed into atlas bitmaps, and draws
+    // them back as sprites.  This avoids text layout and glyph rasterization
+    // for labels that are drawn unchanged frame after frame.
+    //
+    // Strings are rasterized at a scale taken from the drawing session's DPI
+    // and transform, rounded to quarter powers of two, so that zooming
+    // doesn't create a new entry for every frame.  Entries are evicted a page
+    // at a time, least recently used first.
+    //
+    class CanvasTextCache
+        : public RuntimeClass<
+            ICanvasTextCache,
+            IClosable,
+            ICanvasResourceCreator,
+            CloakedIid<ICanvasTextCacheInternal>>
+        , private LifespanTracker<CanvasTextCache>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasTextCache, BaseTrust);
+
+        struct Entry
+        {
+            uint32_t Page;
+            D2D1_RECT_U SourceRect;
+
+            // Position and size of the rasterized pixels, in the units of the
+            // drawing session, relative to the layout origin.
+            D2D1_RECT_F Bounds;
+
+            bool IsColor;
+        };
+
+        std::mutex m_mutex;
+
+        ClosablePtr<ICanvasDevice> m_device;
+        ComPtr<ID2D1Device1> m_d2dDevice;
+
+        TextCacheAtlas m_atlas;
+        std::vector<ComPtr<ID2D1Bitmap1>> m_pages;
+        std::unordered_map<CanvasTextCacheKey, Entry, CanvasTextCacheKeyHash> m_entries;
+
+        int64_t m_hitCount;
+        int64_t m_missCount;
+        int64_t m_evictionCount;
+
+        // Bumped whenever the atlas drops its pages, and with them any pins.
+        uint64_t m_pinEpoch;
+
+    public:
+        static uint32_t const PageSize = 1024;
+        static uint32_t const DefaultMaximumPageCount = 4;
+
+        // Transforms that scale by more than this (or less than its inverse)
+        // are drawn normally, since the cached bitmaps would be too large or
+        // too blurry to be useful.
+        static float const MaximumScale;
+
+        CanvasTextCache(ICanvasDevice* device);
+
+        //
+        // ICanvasTextCache
+        //
+
+        IFACEMETHOD(get_MaximumPageCount)(int32_t* value) override;
+        IFACEMETHOD(put_MaximumPageCount)(int32_t value) override;
+
+        IFACEMETHOD(get_PageSize)(int32_t* value) override;
+
+        IFACEMETHOD(get_Statistics)(CanvasTextCacheStatistics* value) override;
+
+        IFACEMETHOD(ResetStatistics)() override;
+
+        IFACEMETHOD(Clear)() override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+        //
+        // ICanvasResourceCreator
+        //
+
+        IFACEMETHOD(get_Device)(ICanvasDevice** value) override;
+
+        //
+        // ICanvasTextCacheInternal
+        //
+
+        virtual ComPtr<ID2D1Device1> GetD2DDevice() override;
+
+        virtual bool TryDrawText(
+            CanvasTextCacheBatch* batch,
+            ID2D1DeviceContext1* deviceContext,
+            wchar_t const* text,
+            uint32_t textLength,
+            D2D1_RECT_F const& layoutRect,
+            ID2D1Brush* brush,
+            IDWriteTextFormat* realizedFormat,
+            uint64_t formatGeneration,
+            D2D1_DRAW_TEXT_OPTIONS options) override;
+
+        virtual void FlushBatch(CanvasTextCacheBatch* batch) override;
+
+        // Rounds scale to the nearest quarter power of two.
+        static float GetRasterScale(float scale);
+
+    private:
+        Entry const* FindOrCreateEntry(CanvasTextCacheKey&& key, IDWriteTextFormat* realizedFormat);
+
+        bool TryRasterize(CanvasTextCacheKey const& key, IDWriteTextFormat* realizedFormat, Entry* entry);
+
+        void EvictPage(uint32_t page);
+
+        void PinPage(CanvasTextCacheBatch* batch, uint32_t page);
+
+        void ClearPages();
+    };
+
+
+    //
+    // CanvasTextCacheFactory
+    //
+
+    class CanvasTextCacheFactory
+        : public AgileActivationFactory<ICanvasTextCacheFactory>
+        , private LifespanTracker<CanvasTextCacheFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasTextCache, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasResourceCreator* resourceCreator,
+            ICanvasTextCache** textCache) override;
+    };
+}}}}}
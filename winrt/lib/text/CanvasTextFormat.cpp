@@ -11,6 +11,9 @@ using namespace ABI::Microsoft::Graphics::Canvas::Text;
 using namespace ABI::Windows::Storage;
 
 
+std::atomic<uint64_t> CanvasTextFormat::s_nextGeneration(0);
+
+
 //
 // Parameter validation functions
 //
@@ -108,6 +111,7 @@ CanvasTextFormat::CanvasTextFormat()
     , m_fontWeight(ToWindowsFontWeight(DWRITE_FONT_WEIGHT_NORMAL))
     , m_incrementalTabStop(-1.0f)
     , m_lineSpacingMode(CanvasLineSpacingMode::Default)
+    , m_generation(++s_nextGeneration)
     , m_lineSpacing(-1.0f)
     , m_lineSpacingBaseline(1.0f)
     , m_verticalAlignment(CanvasVerticalAlignment::Top)
@@ -129,6 +133,7 @@ CanvasTextFormat::CanvasTextFormat(IDWriteTextFormat1* format)
     , m_closed(false)
     , m_drawTextOptions(CanvasDrawTextOptions::Default)
     , m_lineSpacingMode(CanvasLineSpacingMode::Default)
+    , m_generation(++s_nextGeneration)
 {
     SetShadowPropertiesFromDWrite();
 }
@@ -159,6 +164,7 @@ IFACEMETHODIMP CanvasTextFormat::GetNativeResource(ICanvasDevice* device, float
             CheckAndClearOutPointer(value);
             ThrowIfClosed();
             ThrowIfFailed(GetRealizedTextFormat().CopyTo(iid, value));
+            IncrementGeneration();
         });
 }
 
@@ -271,6 +277,18 @@ D2D1_DRAW_TEXT_OPTIONS CanvasTextFormat::GetDrawTextOptions()
 }
 
 
+uint64_t CanvasTextFormat::GetGeneration()
+{
+    return m_generation;
+}
+
+
+void CanvasTextFormat::IncrementGeneration()
+{
+    m_generation = ++s_nextGeneration;
+}
+
+
 void CanvasTextFormat::Unrealize()
 {
     //
@@ -473,6 +491,7 @@ HRESULT __declspec(nothrow) CanvasTextFormat::PropertyPut(T value, TT* dest, FNV
 
             // Set the shadow value
             SetFrom(dest, value);
+            IncrementGeneration();
 
             // Realize the value on the dwrite object, if we can
             auto& textFormat = MaybeGetResource();
@@ -618,6 +637,7 @@ IFACEMETHODIMP CanvasTextFormat::put_FontFamily(HSTRING value)
             m_fontCollection.Reset();
 
             SetFrom(&m_fontFamilyName, value);
+            IncrementGeneration();
 
             //
             // For properties like this that change something, unrealize and 
@@ -1027,6 +1047,7 @@ IFACEMETHODIMP CanvasTextFormat::put_Options(CanvasDrawTextOptions value)
                 ThrowHR(E_INVALIDARG);
 
             m_drawTextOptions = value;
+            IncrementGeneration();
         });
 }
 
@@ -1276,4 +1297,60 @@ IFACEMETHODIMP CanvasTextFormatFactory::GetSystemFontFamiliesFromLocaleList(
 }
 
 
+IFACEMETHODIMP CanvasTextFormatFactory::PrewarmCustomFontsAsync(
+    IVectorView<HSTRING>* fontFamilies,
+    IAsyncAction** action)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(fontFamilies);
+            CheckAndClearOutPointer(action);
+
+            std::shared_ptr<CustomFontManager> customFontManager;
+
+            {
+                Lock lock(m_mutex);
+
+                if (!m_prewarmedFontManager)
+                    m_prewarmedFontManager = CustomFontManager::GetInstance();
+
+                customFontManager = m_prewarmedFontManager;
+            }
+
+            //
+            // Bad URIs are reported straight away, as they would be by
+            // put_FontFamily.  Families without a URI use the system font
+            // collection, so there's nothing to load for them.
+            //
+            uint32_t familyCount;
+            ThrowIfFailed(fontFamilies->get_Size(&familyCount));
+
+            std::vector<WinString> uris;
+            uris.reserve(familyCount);
+
+            for (uint32_t i = 0; i < familyCount; ++i)
+            {
+                WinString fontFamily;
+                ThrowIfFailed(fontFamilies->GetAt(i, fontFamily.GetAddressOf()));
+
+                auto uri = GetUriAndFontFamily(fontFamily).first;
+                customFontManager->ValidateUri(uri);
+
+                if (uri != WinString())
+                    uris.push_back(uri);
+            }
+
+            auto asyncAction = Make<AsyncAction>(
+                [customFontManager, uris]
+                {
+                    customFontManager->PrewarmFontCollections(uris);
+                });
+
+            CheckMakeResult(asyncAction);
+            ThrowIfFailed(asyncAction.CopyTo(action));
+        });
+}
+
+
 ActivatableClassWithFactory(CanvasTextFormat, CanvasTextFormatFactory);
@@ -22,6 +22,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     {
         InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasTextFormat, BaseTrust);
 
+        //
+        // The custom font cache lives in CustomFontManager, which only exists
+        // while something is using it.  Once fonts have been prewarmed the
+        // factory holds on to the manager, so the cache outlives the
+        // PrewarmCustomFontsAsync call.
+        //
+        std::mutex m_mutex;
+        std::shared_ptr<CustomFontManager> m_prewarmedFontManager;
+
     public:
         IFACEMETHOD(ActivateInstance)(IInspectable** obj) override;
 
@@ -33,6 +42,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             IVectorView<HSTRING>* localeList,
             uint32_t* valueCount,
             HSTRING** valueElements) override;
+
+        IFACEMETHOD(PrewarmCustomFontsAsync)(
+            IVectorView<HSTRING>* fontFamilies,
+            IAsyncAction** action) override;
     };
 
 
@@ -47,8 +60,25 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() = 0;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) = 0;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() = 0;
+
+        // Changes whenever a property of the format, or its realized DWrite
+        // format, may have changed.  Values are unique across all formats.
+        virtual uint64_t GetGeneration() = 0;
     };
 
+    //
+    // Returns the DWrite format for use inside Win2D.  Going through
+    // GetWrappedResource would count as handing the format out through
+    // interop, which changes its generation.
+    //
+    inline ComPtr<IDWriteTextFormat> GetRealizedTextFormat(ICanvasTextFormat* textFormat)
+    {
+        if (auto textFormatInternal = MaybeAs<ICanvasTextFormatInternal>(textFormat))
+            return textFormatInternal->GetRealizedTextFormat();
+
+        return GetWrappedResource<IDWriteTextFormat>(textFormat);
+    }
+
 
     //
     // CanvasTextFormat provides a IDWriteTextFormat object.  Since some members
@@ -118,6 +148,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         //
         CanvasLineSpacingMode m_lineSpacingMode;
 
+        //
+        // See GetGeneration().  Bumped by every setter, and whenever the
+        // realized format is handed out through interop (since the caller may
+        // then modify it directly).
+        //
+        std::atomic<uint64_t> m_generation;
+        static std::atomic<uint64_t> s_nextGeneration;
+
     public:
         CanvasTextFormat();
         CanvasTextFormat(IDWriteTextFormat1* format);
@@ -168,6 +206,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() override;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) override;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() override;
+        virtual uint64_t GetGeneration() override;
 
         //
         // ICanvasResourceWrapperNative
@@ -196,6 +235,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         void Unrealize();
 
+        void IncrementGeneration();
+
         void RealizeDirection(IDWriteTextFormat1* textFormat);
         void RealizeIncrementalTabStop(IDWriteTextFormat1* textFormat);
         void RealizeLineSpacing(IDWriteTextFormat1* textFormat);
@@ -61,27 +61,73 @@ ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
     float requestedWidth,
     float requestedHeight)
 {
-    auto customFontManager = CustomFontManager::GetInstance();
-    auto dwriteFactory = customFontManager->GetSharedFactory();
-
     uint32_t textLength;
     auto textBuffer = WindowsGetStringRawBuffer(text, &textLength);
     ThrowIfNullPointer(textBuffer, E_INVALIDARG);
 
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    return CreateNew(device.Get(), textBuffer, textLength, textFormat, requestedWidth, requestedHeight);
+}
+
+
+ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
+    ICanvasDevice* device,
+    wchar_t const* textBuffer,
+    uint32_t textLength,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth,
+    float requestedHeight)
+{
+    auto layoutCache = As<ICanvasDeviceInternal>(device)->GetTextLayoutCache();
+    auto textFormatInternal = MaybeAs<ICanvasTextFormatInternal>(textFormat);
+
+    if (layoutCache->IsEnabled() && textFormatInternal)
+    {
+        CanvasTextLayoutCacheKey key{
+            std::wstring(textBuffer, textLength),
+            textFormatInternal->GetGeneration(),
+            requestedWidth,
+            requestedHeight,
+            GetCurrentThreadId() };
+
+        auto sharedLayout = layoutCache->TryGet(key);
+
+        if (!sharedLayout)
+        {
+            sharedLayout = layoutCache->Add(
+                std::move(key),
+                CreateCachedTextLayout(
+                    device,
+                    textBuffer,
+                    textLength,
+                    textFormat,
+                    textFormatInternal.Get(),
+                    requestedWidth,
+                    requestedHeight));
+        }
+
+        auto textLayout = Make<CanvasTextLayout>(device, sharedLayout, layoutCache);
+        CheckMakeResult(textLayout);
+
+        return textLayout;
+    }
+
+    auto customFontManager = CustomFontManager::GetInstance();
+    auto dwriteFactory = customFontManager->GetSharedFactory();
+
     ComPtr<IDWriteTextLayout> dwriteTextLayout;
     ThrowIfFailed(dwriteFactory->CreateTextLayout(
         textBuffer,
         textLength,
-        GetWrappedResource<IDWriteTextFormat>(textFormat).Get(),
+        GetRealizedTextFormat(textFormat).Get(),
         requestedWidth,
         requestedHeight,
         &dwriteTextLayout));
 
-    ComPtr<ICanvasDevice> device;
-    ThrowIfFailed(resourceCreator->get_Device(&device));
-
     auto textLayout = Make<CanvasTextLayout>(
-        device.Get(),
+        device,
         As<DWriteTextLayoutType>(dwriteTextLayout).Get());
     CheckMakeResult(textLayout);
 
@@ -98,6 +144,78 @@ ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
 }
 
 
+std::shared_ptr<CachedTextLayout> CanvasTextLayout::CreateCachedTextLayout(
+    ICanvasDevice* device,
+    wchar_t const* text,
+    uint32_t textLength,
+    ICanvasTextFormat* textFormat,
+    ICanvasTextFormatInternal* textFormatInternal,
+    float requestedWidth,
+    float requestedHeight)
+{
+    auto cachedLayout = std::make_shared<CachedTextLayout>();
+
+    cachedLayout->OwningThreadId = GetCurrentThreadId();
+    cachedLayout->Text.assign(text, textLength);
+    cachedLayout->RequestedWidth = requestedWidth;
+    cachedLayout->RequestedHeight = requestedHeight;
+
+    //
+    // The text format may change after this, so the layout is created from
+    // a snapshot of it.  The snapshot is kept so that copies of the layout
+    // can be made later on.
+    //
+    CanvasWordWrapping wordWrapping;
+    ThrowIfFailed(textFormat->get_WordWrapping(&wordWrapping));
+    cachedLayout->TextFormat = textFormatInternal->GetRealizedTextFormatClone(wordWrapping);
+
+    ThrowIfFailed(textFormat->get_LineSpacingMode(&cachedLayout->LineSpacingMode));
+    ThrowIfFailed(textFormat->get_TrimmingSign(&cachedLayout->TrimmingSign));
+
+    cachedLayout->Layout = CreateLayoutFromCachedTextLayout(
+        *cachedLayout,
+        device,
+        &cachedLayout->TrimmingSignState);
+
+    //
+    // DWrite lays text out lazily, the first time something asks for the
+    // result.  Doing that now means that the layouts sharing this one only
+    // ever read from it.
+    //
+    DWRITE_TEXT_METRICS1 metrics;
+    ThrowIfFailed(cachedLayout->Layout->GetMetrics(&metrics));
+
+    return cachedLayout;
+}
+
+
+ComPtr<DWriteTextLayoutType> CanvasTextLayout::CreateLayoutFromCachedTextLayout(
+    CachedTextLayout const& source,
+    ICanvasDevice* device,
+    TrimmingSignInformation* trimmingSignInformation)
+{
+    auto dwriteFactory = CustomFontManager::GetInstance()->GetSharedFactory();
+
+    ComPtr<IDWriteTextLayout> dwriteTextLayout;
+    ThrowIfFailed(dwriteFactory->CreateTextLayout(
+        source.Text.c_str(),
+        static_cast<uint32_t>(source.Text.size()),
+        source.TextFormat.Get(),
+        source.RequestedWidth,
+        source.RequestedHeight,
+        &dwriteTextLayout));
+
+    auto layout = As<DWriteTextLayoutType>(dwriteTextLayout);
+
+    *trimmingSignInformation = TrimmingSignInformation();
+    trimmingSignInformation->SetTrimmingSignOnResource(source.TrimmingSign, layout.Get());
+
+    EnsureCustomTrimmingSignDevice(layout.Get(), device);
+
+    return layout;
+}
+
+
 //
 // CanvasTextLayoutFactory implementation
 //
@@ -154,6 +272,81 @@ IFACEMETHODIMP CanvasTextLayoutFactory::GetGlyphOrientationTransform(
 }
 
 
+std::shared_ptr<CanvasTextLayoutCache> CanvasTextLayoutFactory::GetLayoutCache(ICanvasResourceCreator* resourceCreator)
+{
+    CheckInPointer(resourceCreator);
+
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    return As<ICanvasDeviceInternal>(device)->GetTextLayoutCache();
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::GetCacheMaximumEntryCount(
+    ICanvasResourceCreator* resourceCreator,
+    int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            *value = static_cast<int32_t>(GetLayoutCache(resourceCreator)->GetMaximumEntryCount());
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::SetCacheMaximumEntryCount(
+    ICanvasResourceCreator* resourceCreator,
+    int32_t value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            ThrowIfNegative(value);
+
+            GetLayoutCache(resourceCreator)->SetMaximumEntryCount(static_cast<uint32_t>(value));
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::GetCacheStatistics(
+    ICanvasResourceCreator* resourceCreator,
+    CanvasTextLayoutCacheStatistics* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            *value = GetLayoutCache(resourceCreator)->GetStatistics();
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::ResetCacheStatistics(
+    ICanvasResourceCreator* resourceCreator)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            GetLayoutCache(resourceCreator)->ResetStatistics();
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::ClearCache(
+    ICanvasResourceCreator* resourceCreator)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            GetLayoutCache(resourceCreator)->Clear();
+        });
+}
+
+
 CanvasTextLayout::CanvasTextLayout(
     ICanvasDevice* device,
     DWriteTextLayoutType* layout)
@@ -162,10 +355,122 @@ CanvasTextLayout::CanvasTextLayout(
     , m_device(device)
     , m_customFontManager(CustomFontManager::GetInstance())
     , m_lineSpacingMode(CanvasLineSpacingMode::Default)
+    , m_hitTestIndexIsValid(false)
+    , m_nativeResourceWasExposed(false)
 {
     EnsureCustomTrimmingSignDevice(layout, device);
 }
 
+CanvasTextLayout::CanvasTextLayout(
+    ICanvasDevice* device,
+    std::shared_ptr<CachedTextLayout> const& sharedLayout,
+    std::shared_ptr<CanvasTextLayoutCache> const& layoutCache)
+    : ResourceWrapper(nullptr)
+    , m_drawTextOptions(CanvasDrawTextOptions::Default)
+    , m_device(device)
+    , m_customFontManager(CustomFontManager::GetInstance())
+    , m_lineSpacingMode(sharedLayout->LineSpacingMode)
+    , m_trimmingSignInformation(sharedLayout->TrimmingSignState)
+    , m_sharedLayout(sharedLayout)
+    , m_layoutCache(layoutCache)
+    , m_hitTestIndexIsValid(false)
+    , m_nativeResourceWasExposed(false)
+{
+}
+
+ComPtr<DWriteTextLayoutType> const& CanvasTextLayout::GetResource()
+{
+    if (m_sharedLayout)
+    {
+        // Another thread may be using the shared layout at the same time.
+        if (m_sharedLayout->OwningThreadId != GetCurrentThreadId())
+            return GetMutableResource();
+
+        return m_sharedLayout->Layout;
+    }
+
+    return ResourceWrapper::GetResource();
+}
+
+ComPtr<DWriteTextLayoutType> const& CanvasTextLayout::GetMutableResource()
+{
+    InvalidateMetrics();
+
+    if (m_sharedLayout)
+    {
+        //
+        // Other CanvasTextLayouts may be using the shared layout, so it is
+        // copied before being changed.  DWrite can't clone a layout, so the
+        // copy is made from the same inputs as the original.
+        //
+        auto layout = CreateLayoutFromCachedTextLayout(
+            *m_sharedLayout,
+            m_device.EnsureNotClosed().Get(),
+            &m_trimmingSignInformation);
+
+        SetResource(layout.Get());
+        m_sharedLayout.reset();
+
+        m_layoutCache->RecordCopy();
+    }
+
+    return ResourceWrapper::GetResource();
+}
+
+ComPtr<DWriteTextLayoutType> CanvasTextLayout::GetReadOnlyResource()
+{
+    return GetResource();
+}
+
+void CanvasTextLayout::GetReadOnlyLineMetrics(uint32_t* count, CanvasLineMetrics const** elements)
+{
+    auto& lineMetrics = GetMetricsSnapshot().GetLineMetrics(GetResource().Get());
+
+    *count = static_cast<uint32_t>(lineMetrics.size());
+    *elements = lineMetrics.data();
+}
+
+void CanvasTextLayout::GetReadOnlyClusterMetrics(uint32_t* count, CanvasClusterMetrics const** elements)
+{
+    auto& clusterMetrics = GetMetricsSnapshot().GetClusterMetrics(GetResource().Get());
+
+    *count = static_cast<uint32_t>(clusterMetrics.size());
+    *elements = clusterMetrics.data();
+}
+
+TextLayoutMetricsSnapshot& CanvasTextLayout::GetMetricsSnapshot()
+{
+    //
+    // Once the layout has been handed out through interop it may be changed
+    // without us knowing, so nothing read from it can be kept.
+    //
+    if (m_nativeResourceWasExposed)
+        m_metricsSnapshot.Invalidate();
+
+    return m_metricsSnapshot;
+}
+
+TextLayoutHitTestIndex const* CanvasTextLayout::GetHitTestIndex()
+{
+    if (m_nativeResourceWasExposed)
+        return nullptr;
+
+    if (!m_hitTestIndexIsValid)
+    {
+        m_hitTestIndex = TextLayoutHitTestIndex::TryCreate(GetResource().Get(), &m_metricsSnapshot);
+        m_hitTestIndexIsValid = true;
+    }
+
+    return m_hitTestIndex.get();
+}
+
+void CanvasTextLayout::InvalidateMetrics()
+{
+    m_metricsSnapshot.Invalidate();
+    m_hitTestIndex.reset();
+    m_hitTestIndexIsValid = false;
+}
+
 IFACEMETHODIMP CanvasTextLayout::GetFormatChangeIndices(
     uint32_t* positionCount,
     int32_t** positions)
@@ -235,7 +540,7 @@ IFACEMETHODIMP CanvasTextLayout::##name(valueType value)            \
     return ExceptionBoundary(                                       \
         [&]                                                         \
         {                                                           \
-            auto& resource = GetResource();                         \
+            auto& resource = GetMutableResource();                  \
                                                                     \
             ThrowIfInvalid(value);                                  \
             resource->dwriteMethod(conversionFunc(value));          \
@@ -298,7 +603,7 @@ IFACEMETHODIMP CanvasTextLayout::put_Direction(CanvasTextDirection value)
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
             auto entry = DWriteToCanvasTextDirection::Lookup(value);
             ThrowIfFailed(resource->SetReadingDirection(entry->ReadingDirection));
             ThrowIfFailed(resource->SetFlowDirection(entry->FlowDirection));
@@ -342,7 +647,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacing(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWriteLineSpacing originalSpacing(resource.Get());
 
@@ -387,7 +692,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacingBaseline(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             //
             // The Win10 IDWriteTextLayout3 interface definition omits a 'using' while
@@ -428,7 +733,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacingMode(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             DWriteLineSpacing originalSpacing(resource.Get());
 
@@ -467,7 +772,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingGranularity(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -506,7 +811,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingDelimiter(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -547,7 +852,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingDelimiterCount(
         [&]
         {
             ThrowIfNegative(value);
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -607,7 +912,7 @@ IFACEMETHODIMP CanvasTextLayout::put_RequestedSize(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetMaxWidth(value.Width));
             ThrowIfFailed(resource->SetMaxHeight(value.Height));
@@ -804,7 +1109,7 @@ IFACEMETHODIMP CanvasTextLayout::SetColor(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto textRange = ToDWriteTextRange(characterIndex, characterCount);
 
@@ -838,7 +1143,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontFamily(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto uriAndFontFamily = GetUriAndFontFamily(WinString(fontFamilyName));
             auto const& uri = uriAndFontFamily.first;
@@ -861,7 +1166,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontSize(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontSize(fontSize, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -875,7 +1180,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontStretch(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontStretch(ToFontStretch(fontStretch), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -889,7 +1194,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontStyle(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontStyle(ToFontStyle(fontStyle), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -903,7 +1208,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontWeight(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontWeight(ToFontWeight(fontWeight), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -917,7 +1222,7 @@ IFACEMETHODIMP CanvasTextLayout::SetLocaleName(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             const wchar_t* localeNameBuffer = WindowsGetStringRawBuffer(name, nullptr);
 
@@ -933,7 +1238,7 @@ IFACEMETHODIMP CanvasTextLayout::SetStrikethrough(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetStrikethrough(hasStrikethrough, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -947,7 +1252,7 @@ IFACEMETHODIMP CanvasTextLayout::SetUnderline(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetUnderline(hasUnderline, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -981,7 +1286,7 @@ IFACEMETHODIMP CanvasTextLayout::SetPairKerning(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetPairKerning(hasPairKerning, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -1057,7 +1362,7 @@ IFACEMETHODIMP CanvasTextLayout::SetCharacterSpacing(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetCharacterSpacing(
                 leadingSpacing, 
@@ -1087,7 +1392,7 @@ IFACEMETHODIMP CanvasTextLayout::put_VerticalGlyphOrientation(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetVerticalGlyphOrientation(ToVerticalGlyphOrientation(value)));
 
@@ -1115,7 +1420,7 @@ IFACEMETHODIMP CanvasTextLayout::put_OpticalAlignment(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetOpticalAlignment(ToOpticalAlignment(value)));
 
@@ -1144,7 +1449,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LastLineWrapping(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetLastLineWrapping(value));
 
@@ -1172,7 +1477,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingSign(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             m_trimmingSignInformation.SetTrimmingSignOnResource(value, resource.Get());
         });
@@ -1204,7 +1509,7 @@ IFACEMETHODIMP CanvasTextLayout::put_CustomTrimmingSign(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto dwriteInlineObject = Make<InternalDWriteInlineObject>(value, m_device.EnsureNotClosed());
             CheckMakeResult(dwriteInlineObject);
@@ -1225,8 +1530,7 @@ IFACEMETHODIMP CanvasTextLayout::get_LayoutBounds(Rect* value)
             CheckInPointer(value);
             auto& resource = GetResource();
 
-            DWRITE_TEXT_METRICS1 dwriteMetrics;
-            ThrowIfFailed(resource->GetMetrics(&dwriteMetrics));
+            auto& dwriteMetrics = GetMetricsSnapshot().GetTextMetrics(resource.Get());
 
             Rect rect{ dwriteMetrics.left, dwriteMetrics.top, dwriteMetrics.width, dwriteMetrics.height };
 
@@ -1269,8 +1573,7 @@ IFACEMETHODIMP CanvasTextLayout::get_LayoutBoundsIncludingTrailingWhitespace(Rec
             CheckInPointer(value);
             auto& resource = GetResource();
 
-            DWRITE_TEXT_METRICS1 dwriteMetrics;
-            ThrowIfFailed(resource->GetMetrics(&dwriteMetrics));
+            auto& dwriteMetrics = GetMetricsSnapshot().GetTextMetrics(resource.Get());
 
             Rect rect{ dwriteMetrics.left, dwriteMetrics.top, dwriteMetrics.widthIncludingTrailingWhitespace, dwriteMetrics.heightIncludingTrailingWhitespace };
 
@@ -1286,8 +1589,7 @@ IFACEMETHODIMP CanvasTextLayout::get_LineCount(int32_t* lineCount)
             CheckInPointer(lineCount);
             auto& resource = GetResource();
 
-            DWRITE_TEXT_METRICS1 dwriteMetrics;
-            ThrowIfFailed(resource->GetMetrics(&dwriteMetrics));
+            auto& dwriteMetrics = GetMetricsSnapshot().GetTextMetrics(resource.Get());
 
             *lineCount = dwriteMetrics.lineCount;
         });
@@ -1301,20 +1603,7 @@ IFACEMETHODIMP CanvasTextLayout::get_DrawBounds(Rect* value)
             CheckInPointer(value);
             auto& resource = GetResource();
 
-            DWRITE_OVERHANG_METRICS dwriteOverhangMetrics;
-            ThrowIfFailed(resource->GetOverhangMetrics(&dwriteOverhangMetrics));      
-
-            const float left = -dwriteOverhangMetrics.left;
-            const float right = dwriteOverhangMetrics.right + resource->GetMaxWidth();
-            const float width = right - left;
-
-            const float top = -dwriteOverhangMetrics.top;
-            const float bottom = dwriteOverhangMetrics.bottom + resource->GetMaxHeight();
-            const float height = bottom - top;
-
-            Rect rect{ left, top, width, height };
-
-            *value = rect;
+            *value = GetMetricsSnapshot().GetDrawBounds(resource.Get());
         });
 }
 
@@ -1326,8 +1615,7 @@ IFACEMETHODIMP CanvasTextLayout::get_MaximumBidiReorderingDepth(int32_t* value)
             CheckInPointer(value);
             auto& resource = GetResource();
 
-            DWRITE_TEXT_METRICS1 dwriteMetrics;
-            ThrowIfFailed(resource->GetMetrics(&dwriteMetrics));
+            auto& dwriteMetrics = GetMetricsSnapshot().GetTextMetrics(resource.Get());
 
             assert(dwriteMetrics.maxBidiReorderingDepth >= 0);
 
@@ -1501,6 +1789,99 @@ IFACEMETHODIMP CanvasTextLayout::GetCharacterRegions(
 }
 
 
+IFACEMETHODIMP CanvasTextLayout::HitTestPoints(
+    uint32_t pointCount,
+    Vector2* points,
+    uint32_t* resultCount,
+    CanvasTextLayoutHitTestResult** results)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resultCount);
+            CheckAndClearOutPointer(results);
+            if (pointCount > 0)
+                CheckInPointer(points);
+
+            auto& resource = GetResource();
+            auto index = (pointCount > 0) ? GetHitTestIndex() : nullptr;
+
+            ComArray<CanvasTextLayoutHitTestResult> array(pointCount);
+
+            for (uint32_t i = 0; i < pointCount; ++i)
+            {
+                BOOL isTrailingHit;
+                BOOL isInside;
+                DWRITE_HIT_TEST_METRICS hitTestMetrics;
+
+                if (index)
+                    index->HitTestPoint(points[i].X, points[i].Y, &isTrailingHit, &isInside, &hitTestMetrics);
+                else
+                    ThrowIfFailed(resource->HitTestPoint(points[i].X, points[i].Y, &isTrailingHit, &isInside, &hitTestMetrics));
+
+                array[i].Region = ToHitTestDescription(hitTestMetrics);
+                array[i].TrailingSideOfCharacter = !!isTrailingHit;
+                array[i].IsHit = !!isInside;
+            }
+
+            array.Detach(resultCount, results);
+        });
+}
+
+IFACEMETHODIMP CanvasTextLayout::GetCaretPositions(
+    uint32_t characterIndexCount,
+    int32_t* characterIndices,
+    boolean trailingSideOfCharacter,
+    uint32_t* locationCount,
+    Vector2** locations)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(locationCount);
+            CheckAndClearOutPointer(locations);
+            if (characterIndexCount > 0)
+                CheckInPointer(characterIndices);
+
+            for (uint32_t i = 0; i < characterIndexCount; ++i)
+            {
+                ThrowIfNegative(characterIndices[i]);
+            }
+
+            auto& resource = GetResource();
+            auto index = (characterIndexCount > 0) ? GetHitTestIndex() : nullptr;
+
+            ComArray<Vector2> array(characterIndexCount);
+
+            for (uint32_t i = 0; i < characterIndexCount; ++i)
+            {
+                DWRITE_HIT_TEST_METRICS hitTestMetrics;
+
+                if (index)
+                {
+                    index->HitTestTextPosition(
+                        characterIndices[i],
+                        trailingSideOfCharacter,
+                        &array[i].X,
+                        &array[i].Y,
+                        &hitTestMetrics);
+                }
+                else
+                {
+                    ThrowIfFailed(resource->HitTestTextPosition(
+                        characterIndices[i],
+                        trailingSideOfCharacter,
+                        &array[i].X,
+                        &array[i].Y,
+                        &hitTestMetrics));
+                }
+            }
+
+            array.Detach(locationCount, locations);
+        });
+}
+
+
 IFACEMETHODIMP CanvasTextLayout::DrawToTextRenderer(
     ICanvasTextRenderer* textRenderer,
     Vector2 position)
@@ -1546,7 +1927,7 @@ IFACEMETHODIMP CanvasTextLayout::SetInlineObject(
             ThrowIfNegative(characterIndex);
             ThrowIfNegative(characterCount);
 
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ComPtr<IDWriteInlineObject> dwriteInlineObject;
             if (inlineObject)
@@ -1593,32 +1974,9 @@ IFACEMETHODIMP CanvasTextLayout::get_LineMetrics(
 
             auto& resource = GetResource();
 
-            uint32_t lineCount;
-            HRESULT hr = resource->GetLineMetrics(static_cast<DWriteMetricsType*>(nullptr), 0, &lineCount);
-
-            assert(hr == E_NOT_SUFFICIENT_BUFFER);
-            if (hr != E_NOT_SUFFICIENT_BUFFER)
-                ThrowHR(E_UNEXPECTED);
-
-            std::vector<DWriteMetricsType> dwriteMetrics(lineCount);
-            ThrowIfFailed(resource->GetLineMetrics(dwriteMetrics.data(), lineCount, &lineCount));
-
-            auto returnedMetrics = TransformToComArray<CanvasLineMetrics>(
-                dwriteMetrics.begin(), 
-                dwriteMetrics.end(),
-                [](DWriteMetricsType const& dwriteMetrics)
-                {                
-                    CanvasLineMetrics metrics{};
-                    metrics.CharacterCount = dwriteMetrics.length;
-                    metrics.TrailingWhitespaceCount = dwriteMetrics.trailingWhitespaceLength;
-                    metrics.TerminalNewlineCount = dwriteMetrics.newlineLength;
-                    metrics.Height = dwriteMetrics.height;
-                    metrics.Baseline = dwriteMetrics.baseline;
-                    metrics.IsTrimmed = !!dwriteMetrics.isTrimmed;
-                    metrics.LeadingWhitespaceBefore = dwriteMetrics.leadingBefore;
-                    metrics.LeadingWhitespaceAfter = dwriteMetrics.leadingAfter;
-                    return metrics;
-                });
+            auto& lineMetrics = GetMetricsSnapshot().GetLineMetrics(resource.Get());
+
+            ComArray<CanvasLineMetrics> returnedMetrics(lineMetrics.begin(), lineMetrics.end());
 
             returnedMetrics.Detach(valueCount, valueElements);
         });
@@ -1636,48 +1994,9 @@ IFACEMETHODIMP CanvasTextLayout::get_ClusterMetrics(
 
             auto& resource = GetResource();
 
-            uint32_t clusterCount;
-            HRESULT hr = resource->GetClusterMetrics(nullptr, 0, &clusterCount);
-
-            //
-            // GetClusterMetrics can return S_OK here, since it's valid for a 
-            // text layout to contain no clusters.
-            //
-
-            if (FAILED(hr) && hr != E_NOT_SUFFICIENT_BUFFER)
-                ThrowHR(E_UNEXPECTED);
-
-            std::vector<DWRITE_CLUSTER_METRICS> dwriteMetrics(clusterCount);
-
-            if (clusterCount > 0)
-                ThrowIfFailed(resource->GetClusterMetrics(dwriteMetrics.data(), clusterCount, &clusterCount));
-
-            auto returnedMetrics = TransformToComArray<CanvasClusterMetrics>(
-                dwriteMetrics.begin(), 
-                dwriteMetrics.end(),
-                [](DWRITE_CLUSTER_METRICS const& dwriteMetrics)
-                {                
-                    CanvasClusterMetrics metrics{};
-                    metrics.CharacterCount = dwriteMetrics.length;
-                    metrics.Width = dwriteMetrics.width;
-
-                    if (dwriteMetrics.canWrapLineAfter)
-                        metrics.Properties |= CanvasClusterProperties::CanWrapLineAfter;
+            auto& clusterMetrics = GetMetricsSnapshot().GetClusterMetrics(resource.Get());
 
-                    if (dwriteMetrics.isWhitespace)
-                        metrics.Properties |= CanvasClusterProperties::Whitespace;
-
-                    if (dwriteMetrics.isNewline) 
-                        metrics.Properties |= CanvasClusterProperties::Newline;
-
-                    if (dwriteMetrics.isSoftHyphen)
-                        metrics.Properties |= CanvasClusterProperties::SoftHyphen;
-
-                    if (dwriteMetrics.isRightToLeft)
-                        metrics.Properties |= CanvasClusterProperties::RightToLeft;
-
-                    return metrics;
-                });
+            ComArray<CanvasClusterMetrics> returnedMetrics(clusterMetrics.begin(), clusterMetrics.end());
 
             returnedMetrics.Detach(valueCount, valueElements);
         });
@@ -1738,7 +2057,7 @@ void CanvasTextLayout::SetCustomBrushInternal(
     int32_t characterCount, 
     IInspectable* brush)
 {
-    auto& resource = GetResource();
+    auto& resource = GetMutableResource();
 
     auto textRange = ToDWriteTextRange(characterIndex, characterCount);
 
@@ -1809,7 +2128,7 @@ IFACEMETHODIMP CanvasTextLayout::SetTypography(
             ThrowIfNegative(characterIndex);
             ThrowIfNegative(characterCount);
 
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ComPtr<IDWriteTypography> dwriteTypography;
 
@@ -1822,6 +2141,8 @@ IFACEMETHODIMP CanvasTextLayout::SetTypography(
 
 IFACEMETHODIMP CanvasTextLayout::Close()
 {
+    m_sharedLayout.reset();
+    InvalidateMetrics();
     m_device.Close();
 
     return ResourceWrapper::Close();
@@ -1838,6 +2159,30 @@ IFACEMETHODIMP CanvasTextLayout::get_Device(ICanvasDevice** device)
         });
 }
 
+IFACEMETHODIMP CanvasTextLayout::GetNativeResource(ICanvasDevice* device, float dpi, REFIID iid, void** resource)
+{
+    //
+    // Interop callers are free to modify the layout they get back, so a
+    // layout shared through the cache is copied first.
+    //
+    if (m_sharedLayout)
+    {
+        HRESULT hr = ExceptionBoundary(
+            [&]
+            {
+                GetMutableResource();
+            });
+
+        if (FAILED(hr))
+            return hr;
+    }
+
+    m_nativeResourceWasExposed = true;
+    InvalidateMetrics();
+
+    return ResourceWrapper::GetNativeResource(device, dpi, iid, resource);
+}
+
 void CanvasTextLayout::SetLineSpacingModeInternal(CanvasLineSpacingMode lineSpacingMode)
 {
     m_lineSpacingMode = lineSpacingMode;
@@ -1845,7 +2190,7 @@ void CanvasTextLayout::SetLineSpacingModeInternal(CanvasLineSpacingMode lineSpac
 
 void CanvasTextLayout::SetTrimmingSignInternal(CanvasTrimmingSign trimmingSign)
 {
-    m_trimmingSignInformation.SetTrimmingSignOnResource(trimmingSign, GetResource().Get());
+    m_trimmingSignInformation.SetTrimmingSignOnResource(trimmingSign, GetMutableResource().Get());
 }
 
 
@@ -6,6 +6,9 @@
 
 #include "CustomFontManager.h"
 #include "TrimmingSignInformation.h"
+#include "CanvasTextLayoutCache.h"
+#include "TextLayoutMetricsSnapshot.h"
+#include "TextLayoutHitTestIndex.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
@@ -14,11 +17,37 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     typedef IDWriteTextLayout3 DWriteTextLayoutType;
     typedef DWRITE_LINE_METRICS1 DWriteMetricsType;
 
+    //
+    // ICanvasTextLayoutInternal
+    //
+
+    class __declspec(uuid("6C0D6F1B-3A7E-4B84-9E55-2F1D07C7A3B2"))
+    ICanvasTextLayoutInternal : public IUnknown
+    {
+    public:
+        //
+        // Returns the DWrite layout for read-only use, such as drawing it.
+        // Unlike GetNativeResource, this doesn't make a private copy of a
+        // layout that is shared through the device's layout cache.
+        //
+        virtual ComPtr<DWriteTextLayoutType> GetReadOnlyResource() = 0;
+
+        //
+        // Return the layout's line and cluster metrics without copying them,
+        // for callers that query them repeatedly.  The arrays belong to the
+        // layout, and are only valid until the layout is next changed.
+        //
+        virtual void GetReadOnlyLineMetrics(uint32_t* count, CanvasLineMetrics const** elements) = 0;
+        virtual void GetReadOnlyClusterMetrics(uint32_t* count, CanvasClusterMetrics const** elements) = 0;
+    };
+
+
     class CanvasTextLayout : RESOURCE_WRAPPER_RUNTIME_CLASS(
         DWriteTextLayoutType,
         CanvasTextLayout,
         ICanvasTextLayout,
-        CloakedIid<ICanvasResourceWrapperWithDevice>)
+        CloakedIid<ICanvasResourceWrapperWithDevice>,
+        CloakedIid<ICanvasTextLayoutInternal>)
     {
         InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Text_CanvasTextLayout, BaseTrust);
 
@@ -32,6 +61,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         TrimmingSignInformation m_trimmingSignInformation;
 
+        // Set while this layout is sharing a DWrite layout from the cache,
+        // in which case the ResourceWrapper itself holds no resource.
+        std::shared_ptr<CachedTextLayout> m_sharedLayout;
+        std::shared_ptr<CanvasTextLayoutCache> m_layoutCache;
+
+        // Both of these are filled in on demand, and discarded when the
+        // layout changes.  See GetMetricsSnapshot and GetHitTestIndex.
+        TextLayoutMetricsSnapshot m_metricsSnapshot;
+        std::unique_ptr<TextLayoutHitTestIndex> m_hitTestIndex;
+        bool m_hitTestIndexIsValid;
+
+        // Set once the DWrite layout has been handed out through interop,
+        // since it may then be changed without this class knowing.
+        bool m_nativeResourceWasExposed;
+
     public:
         static ComPtr<CanvasTextLayout> CreateNew(
             ICanvasResourceCreator* resourceCreator,
@@ -40,10 +84,34 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             float requestedWidth,
             float requestedHeight);
 
+        static ComPtr<CanvasTextLayout> CreateNew(
+            ICanvasDevice* device,
+            wchar_t const* text,
+            uint32_t textLength,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth,
+            float requestedHeight);
+
         CanvasTextLayout(
             ICanvasDevice* device,
             DWriteTextLayoutType* layout);
 
+        CanvasTextLayout(
+            ICanvasDevice* device,
+            std::shared_ptr<CachedTextLayout> const& sharedLayout,
+            std::shared_ptr<CanvasTextLayoutCache> const& layoutCache);
+
+        // Hides ResourceWrapper::GetResource, so that reads see the shared
+        // layout when there is one, unless this is not the thread the shared
+        // layout belongs to, in which case a private copy is made first.
+        // Anything that modifies the layout must use GetMutableResource
+        // instead.
+        ComPtr<DWriteTextLayoutType> const& GetResource();
+
+        ComPtr<DWriteTextLayoutType> const& GetMutableResource();
+
+        bool IsSharingCachedLayout() const { return static_cast<bool>(m_sharedLayout); }
+
         IFACEMETHOD(GetFormatChangeIndices)(
             uint32_t* positionCount,
             int32_t** positions) override;
@@ -354,6 +422,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             uint32_t* descriptionCount,
             CanvasTextLayoutRegion** descriptions)) override;
 
+        IFACEMETHOD(HitTestPoints)(
+            uint32_t pointCount,
+            Vector2* points,
+            uint32_t* resultCount,
+            CanvasTextLayoutHitTestResult** results) override;
+
+        IFACEMETHOD(GetCaretPositions)(
+            uint32_t characterIndexCount,
+            int32_t* characterIndices,
+            boolean trailingSideOfCharacter,
+            uint32_t* locationCount,
+            Vector2** locations) override;
+
         IFACEMETHOD(DrawToTextRenderer(
             ICanvasTextRenderer* textRenderer,
             Vector2 position)) override;
@@ -406,6 +487,20 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         IFACEMETHOD(get_Device)(ICanvasDevice** device) override;
 
+        //
+        // ICanvasResourceWrapperNative
+        //
+
+        IFACEMETHOD(GetNativeResource)(ICanvasDevice* device, float dpi, REFIID iid, void** resource) override;
+
+        //
+        // ICanvasTextLayoutInternal
+        //
+
+        virtual ComPtr<DWriteTextLayoutType> GetReadOnlyResource() override;
+        virtual void GetReadOnlyLineMetrics(uint32_t* count, CanvasLineMetrics const** elements) override;
+        virtual void GetReadOnlyClusterMetrics(uint32_t* count, CanvasClusterMetrics const** elements) override;
+
         //
         // Internal
         //
@@ -413,9 +508,30 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         void SetTrimmingSignInternal(CanvasTrimmingSign trimmingSign);
 
-        void EnsureCustomTrimmingSignDevice(IDWriteTextLayout2* layout, ICanvasDevice* device);
+        static void EnsureCustomTrimmingSignDevice(IDWriteTextLayout2* layout, ICanvasDevice* device);
 
     private:
+        static std::shared_ptr<CachedTextLayout> CreateCachedTextLayout(
+            ICanvasDevice* device,
+            wchar_t const* text,
+            uint32_t textLength,
+            ICanvasTextFormat* textFormat,
+            ICanvasTextFormatInternal* textFormatInternal,
+            float requestedWidth,
+            float requestedHeight);
+
+        static ComPtr<DWriteTextLayoutType> CreateLayoutFromCachedTextLayout(
+            CachedTextLayout const& source,
+            ICanvasDevice* device,
+            TrimmingSignInformation* trimmingSignInformation);
+
+        TextLayoutMetricsSnapshot& GetMetricsSnapshot();
+
+        // Returns null if the layout can't be indexed.
+        TextLayoutHitTestIndex const* GetHitTestIndex();
+
+        void InvalidateMetrics();
+
         ComPtr<IInspectable> GetCustomBrushInternal(int32_t characterIndex);
 
         void SetCustomBrushInternal(
@@ -449,5 +565,26 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             boolean isSideways,
             Vector2 position,
             Matrix3x2* transform) override;
+
+        IFACEMETHOD(GetCacheMaximumEntryCount)(
+            ICanvasResourceCreator* resourceCreator,
+            int32_t* value) override;
+
+        IFACEMETHOD(SetCacheMaximumEntryCount)(
+            ICanvasResourceCreator* resourceCreator,
+            int32_t value) override;
+
+        IFACEMETHOD(GetCacheStatistics)(
+            ICanvasResourceCreator* resourceCreator,
+            CanvasTextLayoutCacheStatistics* value) override;
+
+        IFACEMETHOD(ResetCacheStatistics)(
+            ICanvasResourceCreator* resourceCreator) override;
+
+        IFACEMETHOD(ClearCache)(
+            ICanvasResourceCreator* resourceCreator) override;
+
+    private:
+        static std::shared_ptr<CanvasTextLayoutCache> GetLayoutCache(ICanvasResourceCreator* resourceCreator);
     };
 }}}}}
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasTextLayoutCache.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+bool CanvasTextLayoutCacheKey::operator==(CanvasTextLayoutCacheKey const& other) const
+{
+    return FormatGeneration == other.FormatGeneration
+        && ThreadId == other.ThreadId
+        && RequestedWidth == other.RequestedWidth
+        && RequestedHeight == other.RequestedHeight
+        && Text == other.Text;
+}
+
+
+template<typename T>
+static void HashCombine(size_t* hash, T const& value)
+{
+    *hash ^= std::hash<T>()(value) + 0x9e3779b9 + (*hash << 6) + (*hash >> 2);
+}
+
+
+size_t CanvasTextLayoutCacheKeyHash::operator()(CanvasTextLayoutCacheKey const& key) const
+{
+    size_t hash = std::hash<std::wstring>()(key.Text);
+
+    HashCombine(&hash, key.FormatGeneration);
+    HashCombine(&hash, key.RequestedWidth);
+    HashCombine(&hash, key.RequestedHeight);
+    HashCombine(&hash, key.ThreadId);
+
+    return hash;
+}
+
+
+CanvasTextLayoutCache::CanvasTextLayoutCache()
+    : m_maximumEntryCount(0)
+    , m_hitCount(0)
+    , m_missCount(0)
+    , m_evictionCount(0)
+    , m_copyCount(0)
+{
+}
+
+
+uint32_t CanvasTextLayoutCache::GetMaximumEntryCount()
+{
+    Lock lock(m_mutex);
+    return m_maximumEntryCount;
+}
+
+
+void CanvasTextLayoutCache::SetMaximumEntryCount(uint32_t value)
+{
+    Lock lock(m_mutex);
+
+    m_maximumEntryCount = value;
+
+    TrimToMaximumEntryCount(lock);
+}
+
+
+bool CanvasTextLayoutCache::IsEnabled()
+{
+    Lock lock(m_mutex);
+    return m_maximumEntryCount > 0;
+}
+
+
+CanvasTextLayoutCacheStatistics CanvasTextLayoutCache::GetStatistics()
+{
+    Lock lock(m_mutex);
+
+    CanvasTextLayoutCacheStatistics statistics{};
+    statistics.HitCount = m_hitCount;
+    statistics.MissCount = m_missCount;
+    statistics.EvictionCount = m_evictionCount;
+    statistics.CopyCount = m_copyCount;
+    statistics.EntryCount = static_cast<int32_t>(m_entries.size());
+
+    return statistics;
+}
+
+
+void CanvasTextLayoutCache::ResetStatistics()
+{
+    Lock lock(m_mutex);
+
+    m_hitCount = 0;
+    m_missCount = 0;
+    m_evictionCount = 0;
+    m_copyCount = 0;
+}
+
+
+void CanvasTextLayoutCache::Clear()
+{
+    Lock lock(m_mutex);
+
+    m_index.clear();
+    m_entries.clear();
+}
+
+
+std::shared_ptr<CachedTextLayout> CanvasTextLayoutCache::TryGet(CanvasTextLayoutCacheKey const& key)
+{
+    Lock lock(m_mutex);
+
+    auto it = m_index.find(key);
+
+    if (it == m_index.end())
+    {
+        m_missCount++;
+        return nullptr;
+    }
+
+    m_hitCount++;
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+    return it->second->second;
+}
+
+
+std::shared_ptr<CachedTextLayout> CanvasTextLayoutCache::Add(
+    CanvasTextLayoutCacheKey&& key,
+    std::shared_ptr<CachedTextLayout> const& value)
+{
+    Lock lock(m_mutex);
+
+    if (m_maximumEntryCount == 0)
+        return value;
+
+    auto it = m_index.find(key);
+
+    if (it != m_index.end())
+    {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->second;
+    }
+
+    m_entries.emplace_front(std::move(key), value);
+    m_index.emplace(m_entries.front().first, m_entries.begin());
+
+    TrimToMaximumEntryCount(lock);
+
+    return value;
+}
+
+
+void CanvasTextLayoutCache::RecordCopy()
+{
+    Lock lock(m_mutex);
+    m_copyCount++;
+}
+
+
+void CanvasTextLayoutCache::TrimToMaximumEntryCount(Lock const&)
+{
+    while (m_entries.size() > m_maximumEntryCount)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+        m_evictionCount++;
+    }
+}
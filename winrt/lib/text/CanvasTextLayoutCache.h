@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "TrimmingSignInformation.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // A fully configured DWrite text layout that may be shared between
+    // several CanvasTextLayouts.  Nothing may modify Layout once it has been
+    // added to the cache; the remaining fields are what is needed to create a
+    // private copy of it for a CanvasTextLayout that is about to be changed.
+    //
+    // DWrite layouts are not safe to use from several threads at once, even
+    // just for reading, so Layout is only ever used on OwningThreadId.
+    //
+    struct CachedTextLayout
+    {
+        ComPtr<IDWriteTextLayout3> Layout;
+        DWORD OwningThreadId;
+
+        std::wstring Text;
+        ComPtr<IDWriteTextFormat> TextFormat;
+        float RequestedWidth;
+        float RequestedHeight;
+        CanvasLineSpacingMode LineSpacingMode;
+        CanvasTrimmingSign TrimmingSign;
+
+        // The trimming sign state that goes with Layout.
+        TrimmingSignInformation TrimmingSignState;
+    };
+
+
+    struct CanvasTextLayoutCacheKey
+    {
+        std::wstring Text;
+
+        // See ICanvasTextFormatInternal::GetGeneration.  Generations are
+        // unique across formats, so this identifies the format as well as its
+        // state.
+        uint64_t FormatGeneration;
+
+        float RequestedWidth;
+        float RequestedHeight;
+
+        // Layouts are only shared between CanvasTextLayouts created on the
+        // same thread.  See CachedTextLayout.
+        DWORD ThreadId;
+
+        bool operator==(CanvasTextLayoutCacheKey const& other) const;
+    };
+
+    struct CanvasTextLayoutCacheKeyHash
+    {
+        size_t operator()(CanvasTextLayoutCacheKey const& key) const;
+    };
+
+
+    //
+    // Per-device cache of the DWrite layouts created by CanvasTextLayout.
+    //
+    // Apps that virtualize lists tend to create the same layouts over and
+    // over as items scroll in and out of view.  When the cache is enabled,
+    // CanvasTextLayout.Create looks for an existing layout made from the same
+    // text, format and size, and if it finds one the new CanvasTextLayout
+    // shares it.  A CanvasTextLayout that is changed after creation, or used
+    // from a different thread than the one that created it, first makes its
+    // own copy (see CanvasTextLayout::GetMutableResource).
+    //
+    // The cache is disabled until MaximumEntryCount is set.  Entries are
+    // evicted least recently used first.  This class is thread-safe.
+    //
+    class CanvasTextLayoutCache
+    {
+        typedef std::list<std::pair<CanvasTextLayoutCacheKey, std::shared_ptr<CachedTextLayout>>> EntryList;
+
+        std::mutex m_mutex;
+
+        // Most recently used first.
+        EntryList m_entries;
+        std::unordered_map<CanvasTextLayoutCacheKey, EntryList::iterator, CanvasTextLayoutCacheKeyHash> m_index;
+
+        uint32_t m_maximumEntryCount;
+
+        int64_t m_hitCount;
+        int64_t m_missCount;
+        int64_t m_evictionCount;
+        int64_t m_copyCount;
+
+    public:
+        CanvasTextLayoutCache();
+
+        uint32_t GetMaximumEntryCount();
+        void SetMaximumEntryCount(uint32_t value);
+
+        bool IsEnabled();
+
+        CanvasTextLayoutCacheStatistics GetStatistics();
+        void ResetStatistics();
+
+        void Clear();
+
+        // Returns null, and counts a miss, if there's no entry for this key.
+        std::shared_ptr<CachedTextLayout> TryGet(CanvasTextLayoutCacheKey const& key);
+
+        // Adds a newly created layout.  If another thread got there first,
+        // its entry is kept and returned instead.
+        std::shared_ptr<CachedTextLayout> Add(CanvasTextLayoutCacheKey&& key, std::shared_ptr<CachedTextLayout> const& value);
+
+        // Called when a CanvasTextLayout copies a shared layout.
+        void RecordCopy();
+
+    private:
+        void TrimToMaximumEntryCount(Lock const& lock);
+    };
+}}}}}
@@ -185,19 +185,86 @@ ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromUri(WinStr
         return nullptr;
     }
 
+    std::wstring uriKey(static_cast<wchar_t const*>(uri));
+
+    {
+        SharedLock lock(m_fontCollectionCacheMutex);
+
+        auto it = m_fontCollectionsByUri.find(uriKey);
+
+        if (it != m_fontCollectionsByUri.end())
+            return it->second.FontCollection;
+    }
+
     auto path = GetAbsolutePathFromUri(uri);
+    auto collection = GetCachedFontCollectionFromPath(path);
+
+    ExclusiveLock lock(m_fontCollectionCacheMutex);
 
-    return GetFontCollectionFromPath(path);
+    auto result = m_fontCollectionsByUri.emplace(uriKey, ResolvedFontUri{ path, collection });
+
+    return result.first->second.FontCollection;
 }
 
 ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromUri(IUriRuntimeClass* uri)
 {
+    //
+    // Uri objects aren't cached by URI, but collections loaded through them
+    // are still shared with anything else that resolves to the same file.
+    //
     auto path = GetAbsolutePathFromUri(uri);
 
-    return GetFontCollectionFromPath(path);
+    return GetCachedFontCollectionFromPath(path);
+}
+
+void CustomFontManager::PrewarmFontCollections(std::vector<WinString> const& uris)
+{
+    //
+    // Every URI is attempted, even if an earlier one fails, and the first
+    // failure is reported at the end.
+    //
+    HRESULT firstError = S_OK;
+
+    for (auto const& uri : uris)
+    {
+        HRESULT hr = ExceptionBoundary(
+            [&]
+            {
+                GetFontCollectionFromUri(uri);
+            });
+
+        if (FAILED(hr) && SUCCEEDED(firstError))
+            firstError = hr;
+    }
+
+    ThrowIfFailed(firstError);
+}
+
+ComPtr<IDWriteFontCollection> CustomFontManager::GetCachedFontCollectionFromPath(WinString const& path)
+{
+    std::wstring pathKey(static_cast<wchar_t const*>(path));
+
+    {
+        SharedLock lock(m_fontCollectionCacheMutex);
+
+        auto it = m_fontCollectionsByPath.find(pathKey);
+
+        if (it != m_fontCollectionsByPath.end())
+            return it->second;
+    }
+
+    auto collection = GetFontCollectionFromPath(path);
+
+    ExclusiveLock lock(m_fontCollectionCacheMutex);
+
+    // Another thread may have got here first, in which case its collection
+    // is used so that every caller sees the same one.
+    auto result = m_fontCollectionsByPath.emplace(pathKey, collection);
+
+    return result.first->second;
 }
 
-ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromPath(WinString& path)
+ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromPath(WinString const& path)
 {
     auto pathBegin = begin(path);
     auto pathEnd = end(path);
@@ -41,6 +41,23 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<IDWriteTextAnalyzer2> m_textAnalyzer;
         ComPtr<IDWriteFontFallback> m_systemFontFallback;
 
+        //
+        // Custom font collections are cached, keyed both by the URI they were
+        // requested with and by the path that URI resolved to.  Resolving a
+        // URI waits for StorageFile, so that and loading the collection are
+        // done without holding the lock; if two threads miss on the same URI
+        // at once they both do the work, and the first result stored is kept.
+        //
+        struct ResolvedFontUri
+        {
+            WinString Path;
+            ComPtr<IDWriteFontCollection> FontCollection;
+        };
+
+        std::shared_timed_mutex m_fontCollectionCacheMutex;
+        std::unordered_map<std::wstring, ResolvedFontUri> m_fontCollectionsByUri;
+        std::unordered_map<std::wstring, ComPtr<IDWriteFontCollection>> m_fontCollectionsByPath;
+
     public:
         CustomFontManager();
 
@@ -50,6 +67,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         void ValidateUri(WinString const& uriString);
 
+        // Loads and caches the font collections for a list of URIs, so that
+        // text formats using them later don't have to wait.
+        void PrewarmFontCollections(std::vector<WinString> const& uris);
+
         ComPtr<IDWriteFactory> const& GetSharedFactory();
 
         ComPtr<IDWriteTextAnalyzer2> const& GetTextAnalyzer();
@@ -63,7 +84,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         WinString GetAbsolutePathFromUri(IUriRuntimeClass* uri);
 
-        ComPtr<IDWriteFontCollection> GetFontCollectionFromPath(WinString& path);
+        ComPtr<IDWriteFontCollection> GetCachedFontCollectionFromPath(WinString const& path);
+
+        ComPtr<IDWriteFontCollection> GetFontCollectionFromPath(WinString const& path);
 
     };
 }}}}}
@@ -2,13 +2,13 @@
 //
 // Licensed under the MIT License. See LICENSE.txt in the project root for license information.
 
-#pragma once
-
 #include "pch.h"
 
 #include "DrawGlyphRunHelper.h"
 #include "CanvasFontFace.h"
 
+using namespace DirectX;
+
 DrawGlyphRunHelper::DrawGlyphRunHelper(
     ICanvasFontFace* fontFace,
     float fontSize,
@@ -52,55 +52,97 @@ DrawGlyphRunHelper::DrawGlyphRunHelper(
     ComPtr<ID2D1DeviceContext> const& deviceContext)
     : DWriteGlyphRun{}
     , DWriteGlyphRunDescription{}
+    , ClusterMapElements(clusterMapIndices ? clusterMapIndicesCount : 0)
+    , GlyphAdvances(glyphCount)
+    , GlyphIndices(glyphCount)
+    , GlyphOffsets(glyphCount)
 {
-    DWriteGlyphRun.bidiLevel = bidiLevel;
-    DWriteGlyphRun.fontEmSize = fontSize;
-    DWriteGlyphRun.fontFace = As<ICanvasFontFaceInternal>(fontFace)->GetRealizedFontFace().Get();
-
-    GlyphAdvances.reserve(glyphCount);
-    GlyphIndices.reserve(glyphCount);
-    GlyphOffsets.reserve(glyphCount);
-    for (uint32_t i = 0; i < glyphCount; ++i)
-    {
-        GlyphAdvances.push_back(glyphs[i].Advance);
+    DeinterleaveGlyphs(glyphCount, glyphs, GlyphIndices.GetData(), GlyphAdvances.GetData(), GlyphOffsets.GetData());
 
-        GlyphIndices.push_back(CheckCastAsUShort(glyphs[i].Index));
+    InitializeGlyphRun(
+        fontFace,
+        fontSize,
+        glyphCount,
+        GlyphIndices.GetData(),
+        GlyphAdvances.GetData(),
+        GlyphOffsets.GetData(),
+        isSideways,
+        bidiLevel,
+        brush,
+        ToDWriteMeasuringMode(textMeasuringMode),
+        deviceContext);
 
-        DWRITE_GLYPH_OFFSET offset;
-        offset.advanceOffset = glyphs[i].AdvanceOffset;
-        offset.ascenderOffset = glyphs[i].AscenderOffset;
-        GlyphOffsets.push_back(offset);
+    if (clusterMapIndices)
+    {
+        NarrowClusterMap(clusterMapIndicesCount, clusterMapIndices, ClusterMapElements.GetData());
+        DWriteGlyphRunDescription.clusterMap = ClusterMapElements.GetData();
     }
-    DWriteGlyphRun.glyphCount = glyphCount;
-    DWriteGlyphRun.glyphAdvances = GlyphAdvances.data();
-    DWriteGlyphRun.glyphIndices = GlyphIndices.data();
-    DWriteGlyphRun.glyphOffsets = GlyphOffsets.data();
-    DWriteGlyphRun.isSideways = isSideways;
 
     uint32_t textStringLength;
     wchar_t const* textString = WindowsGetStringRawBuffer(text, &textStringLength);
 
-    ClusterMapElements.reserve(textStringLength);
-
-    if (clusterMapIndices)
-    {
-        for (uint32_t i = 0; i < clusterMapIndicesCount; ++i)
-        {
-            ClusterMapElements.push_back(CheckCastAsUShort(clusterMapIndices[i]));
-        }
-    }
-    DWriteGlyphRunDescription.clusterMap = ClusterMapElements.data();
-
     // This helper structure isn't intended to outlive the arguments used to create it.
     DWriteGlyphRunDescription.localeName = WindowsGetStringRawBuffer(localeName, nullptr);
     DWriteGlyphRunDescription.string = textString;
     DWriteGlyphRunDescription.stringLength = textStringLength;
 
     DWriteGlyphRunDescription.textPosition = textPosition;
+}
+
+DrawGlyphRunHelper::DrawGlyphRunHelper(
+    ICanvasFontFace* fontFace,
+    float fontSize,
+    uint32_t glyphCount,
+    uint16_t const* glyphIndices,
+    float const* glyphAdvances,
+    DWRITE_GLYPH_OFFSET const* glyphOffsets,
+    boolean isSideways,
+    uint32_t bidiLevel,
+    IInspectable* brush,
+    DWRITE_MEASURING_MODE measuringMode,
+    ComPtr<ID2D1DeviceContext> const& deviceContext)
+    : DWriteGlyphRun{}
+    , DWriteGlyphRunDescription{}
+{
+    InitializeGlyphRun(
+        fontFace,
+        fontSize,
+        glyphCount,
+        glyphIndices,
+        glyphAdvances,
+        glyphOffsets,
+        isSideways,
+        bidiLevel,
+        brush,
+        measuringMode,
+        deviceContext);
+}
+
+void DrawGlyphRunHelper::InitializeGlyphRun(
+    ICanvasFontFace* fontFace,
+    float fontSize,
+    uint32_t glyphCount,
+    uint16_t const* glyphIndices,
+    float const* glyphAdvances,
+    DWRITE_GLYPH_OFFSET const* glyphOffsets,
+    boolean isSideways,
+    uint32_t bidiLevel,
+    IInspectable* brush,
+    DWRITE_MEASURING_MODE measuringMode,
+    ComPtr<ID2D1DeviceContext> const& deviceContext)
+{
+    DWriteGlyphRun.bidiLevel = bidiLevel;
+    DWriteGlyphRun.fontEmSize = fontSize;
+    DWriteGlyphRun.fontFace = As<ICanvasFontFaceInternal>(fontFace)->GetRealizedFontFace().Get();
+    DWriteGlyphRun.glyphCount = glyphCount;
+    DWriteGlyphRun.glyphAdvances = glyphAdvances;
+    DWriteGlyphRun.glyphIndices = glyphIndices;
+    DWriteGlyphRun.glyphOffsets = glyphOffsets;
+    DWriteGlyphRun.isSideways = isSideways;
 
     ClientDrawingEffect = GetClientDrawingEffect(brush, deviceContext);
 
-    MeasuringMode = ToDWriteMeasuringMode(textMeasuringMode);
+    MeasuringMode = measuringMode;
 }
 
 ComPtr<IUnknown> DrawGlyphRunHelper::GetClientDrawingEffect(
@@ -117,4 +159,112 @@ ComPtr<IUnknown> DrawGlyphRunHelper::GetClientDrawingEffect(
         }
     }
     return result;
-}
\ No newline at end of file
+}
+
+//
+// Glyph indices and cluster map entries arrive as int, but DWrite wants
+// UINT16.  Rather than range checking each value as it is converted, the
+// kernels below OR together the top 16 bits of every value (which are also
+// set for negative values), and check the result once at the end.
+//
+// The data is only moved around, never interpreted as floats, so everything
+// is loaded and stored with the integer variants of the DirectXMath
+// functions to keep the bit patterns intact.
+//
+
+static XMVECTOR GetOutOfRangeBits(FXMVECTOR values)
+{
+    return XMVectorAndInt(values, XMVectorReplicateInt(0xFFFF0000));
+}
+
+static void ThrowIfAnyOutOfRange(FXMVECTOR outOfRangeBits)
+{
+    if (!XMVector4EqualInt(outOfRangeBits, XMVectorZero()))
+        ThrowHR(E_INVALIDARG);
+}
+
+static void StoreAsUShort4(uint16_t* destination, FXMVECTOR values)
+{
+    uint32_t lanes[4];
+    XMStoreInt4(lanes, values);
+
+    destination[0] = static_cast<uint16_t>(lanes[0]);
+    destination[1] = static_cast<uint16_t>(lanes[1]);
+    destination[2] = static_cast<uint16_t>(lanes[2]);
+    destination[3] = static_cast<uint16_t>(lanes[3]);
+}
+
+void DrawGlyphRunHelper::DeinterleaveGlyphs(
+    uint32_t glyphCount,
+    CanvasGlyph const* glyphs,
+    uint16_t* glyphIndices,
+    float* glyphAdvances,
+    DWRITE_GLYPH_OFFSET* glyphOffsets)
+{
+    static_assert(sizeof(CanvasGlyph) == 4 * sizeof(uint32_t), "CanvasGlyph is expected to be four 32 bit fields");
+    static_assert(sizeof(DWRITE_GLYPH_OFFSET) == 2 * sizeof(uint32_t), "DWRITE_GLYPH_OFFSET is expected to be two 32 bit fields");
+
+    auto source = reinterpret_cast<uint32_t const*>(glyphs);
+    auto advances = reinterpret_cast<uint32_t*>(glyphAdvances);
+    auto offsets = reinterpret_cast<uint32_t*>(glyphOffsets);
+
+    XMVECTOR outOfRange = XMVectorZero();
+    uint32_t i = 0;
+
+    // Four glyphs at a time.  Each glyph loads as one (Index, Advance,
+    // AdvanceOffset, AscenderOffset) vector; these are transposed into one
+    // vector of indices, one of advances and two of offset pairs.
+    for (; i + 4 <= glyphCount; i += 4)
+    {
+        XMVECTOR g0 = XMLoadInt4(source + i * 4);
+        XMVECTOR g1 = XMLoadInt4(source + i * 4 + 4);
+        XMVECTOR g2 = XMLoadInt4(source + i * 4 + 8);
+        XMVECTOR g3 = XMLoadInt4(source + i * 4 + 12);
+
+        XMStoreInt4(offsets + i * 2, XMVectorPermute<2, 3, 6, 7>(g0, g1));
+        XMStoreInt4(offsets + i * 2 + 4, XMVectorPermute<2, 3, 6, 7>(g2, g3));
+
+        XMVECTOR indexAndAdvance01 = XMVectorPermute<0, 1, 4, 5>(g0, g1);
+        XMVECTOR indexAndAdvance23 = XMVectorPermute<0, 1, 4, 5>(g2, g3);
+
+        XMStoreInt4(advances + i, XMVectorPermute<1, 3, 5, 7>(indexAndAdvance01, indexAndAdvance23));
+
+        XMVECTOR indices = XMVectorPermute<0, 2, 4, 6>(indexAndAdvance01, indexAndAdvance23);
+        outOfRange = XMVectorOrInt(outOfRange, GetOutOfRangeBits(indices));
+        StoreAsUShort4(glyphIndices + i, indices);
+    }
+
+    for (; i < glyphCount; ++i)
+    {
+        glyphIndices[i] = CheckCastAsUShort(glyphs[i].Index);
+        glyphAdvances[i] = glyphs[i].Advance;
+        glyphOffsets[i] = DWRITE_GLYPH_OFFSET{ glyphs[i].AdvanceOffset, glyphs[i].AscenderOffset };
+    }
+
+    ThrowIfAnyOutOfRange(outOfRange);
+}
+
+void DrawGlyphRunHelper::NarrowClusterMap(
+    uint32_t count,
+    int const* clusterMapIndices,
+    uint16_t* clusterMap)
+{
+    auto source = reinterpret_cast<uint32_t const*>(clusterMapIndices);
+
+    XMVECTOR outOfRange = XMVectorZero();
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        XMVECTOR values = XMLoadInt4(source + i);
+        outOfRange = XMVectorOrInt(outOfRange, GetOutOfRangeBits(values));
+        StoreAsUShort4(clusterMap + i, values);
+    }
+
+    for (; i < count; ++i)
+    {
+        clusterMap[i] = CheckCastAsUShort(clusterMapIndices[i]);
+    }
+
+    ThrowIfAnyOutOfRange(outOfRange);
+}
@@ -4,16 +4,26 @@
 
 #pragma once
 
+#include "utils/ScratchBuffer.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
+    //
+    // Converts the Canvas description of a glyph run into the DWRITE_GLYPH_RUN
+    // (and optionally DWRITE_GLYPH_RUN_DESCRIPTION) that D2D and DWrite want.
+    //
+    // The converted arrays live in thread-local scratch buffers, so helpers
+    // must be stack locals, and must not outlive the arguments used to create
+    // them.
+    //
     struct DrawGlyphRunHelper
     {
         DWRITE_GLYPH_RUN DWriteGlyphRun;
         DWRITE_GLYPH_RUN_DESCRIPTION DWriteGlyphRunDescription;
-        std::vector<unsigned short> ClusterMapElements;
-        std::vector<float> GlyphAdvances;
-        std::vector<unsigned short> GlyphIndices;
-        std::vector<DWRITE_GLYPH_OFFSET> GlyphOffsets;
+        ScratchBuffer<uint16_t> ClusterMapElements;
+        ScratchBuffer<float> GlyphAdvances;
+        ScratchBuffer<uint16_t> GlyphIndices;
+        ScratchBuffer<DWRITE_GLYPH_OFFSET> GlyphOffsets;
         ComPtr<IUnknown> ClientDrawingEffect;
         DWRITE_MEASURING_MODE MeasuringMode;
 
@@ -42,9 +52,63 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             uint32_t bidiLevel,
             CanvasTextMeasuringMode textMeasuringMode);
 
+        //
+        // For callers that already have their glyphs in DWrite's layout.  The
+        // run refers directly to the caller's arrays, so nothing is copied or
+        // converted.  As with DWRITE_GLYPH_RUN, glyphAdvances and glyphOffsets
+        // may be null.
+        //
+        DrawGlyphRunHelper(
+            ICanvasFontFace* fontFace,
+            float fontSize,
+            uint32_t glyphCount,
+            uint16_t const* glyphIndices,
+            float const* glyphAdvances,
+            DWRITE_GLYPH_OFFSET const* glyphOffsets,
+            boolean isSideways,
+            uint32_t bidiLevel,
+            IInspectable* brush,
+            DWRITE_MEASURING_MODE measuringMode,
+            ComPtr<ID2D1DeviceContext> const& deviceContext);
+
         static ComPtr<IUnknown> GetClientDrawingEffect(
             ComPtr<IInspectable> const& inspectable,
             ComPtr<ID2D1DeviceContext> const& deviceContext);
+
+        //
+        // Splits glyphs into DWrite's separate index, advance and offset
+        // arrays, each of which must have room for glyphCount elements.
+        // Throws E_INVALIDARG if any glyph index doesn't fit in a UINT16.
+        //
+        static void DeinterleaveGlyphs(
+            uint32_t glyphCount,
+            CanvasGlyph const* glyphs,
+            uint16_t* glyphIndices,
+            float* glyphAdvances,
+            DWRITE_GLYPH_OFFSET* glyphOffsets);
+
+        //
+        // Converts a cluster map to UINT16, throwing E_INVALIDARG if any
+        // element is out of range.
+        //
+        static void NarrowClusterMap(
+            uint32_t count,
+            int const* clusterMapIndices,
+            uint16_t* clusterMap);
+
+    private:
+        void InitializeGlyphRun(
+            ICanvasFontFace* fontFace,
+            float fontSize,
+            uint32_t glyphCount,
+            uint16_t const* glyphIndices,
+            float const* glyphAdvances,
+            DWRITE_GLYPH_OFFSET const* glyphOffsets,
+            boolean isSideways,
+            uint32_t bidiLevel,
+            IInspectable* brush,
+            DWRITE_MEASURING_MODE measuringMode,
+            ComPtr<ID2D1DeviceContext> const& deviceContext);
     };
 
 }}}}}
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextCacheAtlas.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+static uint32_t RoundUpShelfHeight(uint32_t height)
+{
+    auto g = TextCacheAtlas::ShelfHeightGranularity;
+    return (height + g - 1) / g * g;
+}
+
+
+TextCacheAtlas::TextCacheAtlas(uint32_t pageSize, uint32_t maximumPageCount)
+    : m_pageSize(pageSize)
+    , m_maximumPageCount(maximumPageCount)
+    , m_clock(0)
+{
+    assert(pageSize > 0);
+    assert(maximumPageCount > 0);
+}
+
+
+uint32_t TextCacheAtlas::GetPageSize() const
+{
+    return m_pageSize;
+}
+
+
+uint32_t TextCacheAtlas::GetPageCount() const
+{
+    return static_cast<uint32_t>(m_pages.size());
+}
+
+
+uint32_t TextCacheAtlas::GetMaximumPageCount() const
+{
+    return m_maximumPageCount;
+}
+
+
+bool TextCacheAtlas::SetMaximumPageCount(uint32_t value)
+{
+    assert(value > 0);
+
+    m_maximumPageCount = value;
+
+    if (m_pages.size() <= value)
+        return false;
+
+    Clear();
+    return true;
+}
+
+
+bool TextCacheAtlas::Allocate(uint32_t width, uint32_t height, Allocation* allocation, uint32_t* evictedPage)
+{
+    *evictedPage = NoPage;
+
+    if (width == 0 || height == 0 || width > m_pageSize || height > m_pageSize)
+        return false;
+
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        if (TryAllocateFromPage(i, width, height, allocation))
+            return true;
+    }
+
+    uint32_t pageIndex;
+
+    if (m_pages.size() < m_maximumPageCount)
+    {
+        pageIndex = static_cast<uint32_t>(m_pages.size());
+        m_pages.push_back(Page{ {}, 0, 0, 0 });
+    }
+    else
+    {
+        pageIndex = FindLeastRecentlyUsedPage();
+
+        if (pageIndex == NoPage)
+            return false;
+
+        auto& page = m_pages[pageIndex];
+        page.Shelves.clear();
+        page.Height = 0;
+
+        *evictedPage = pageIndex;
+    }
+
+    bool allocated = TryAllocateFromPage(pageIndex, width, height, allocation);
+    assert(allocated);
+    return allocated;
+}
+
+
+bool TextCacheAtlas::TryAllocateFromPage(uint32_t pageIndex, uint32_t width, uint32_t height, Allocation* allocation)
+{
+    auto& page = m_pages[pageIndex];
+    auto shelfHeight = std::min(RoundUpShelfHeight(height), m_pageSize);
+
+    //
+    // Look for the existing shelf with the least wasted height.  Shelves up
+    // to one step taller than needed are considered, so that a string with a
+    // descender can share with one that doesn't.
+    //
+
+    Shelf* bestShelf = nullptr;
+
+    for (auto& shelf : page.Shelves)
+    {
+        if (shelf.Height < height || shelf.Height > shelfHeight + ShelfHeightGranularity)
+            continue;
+
+        if (m_pageSize - shelf.Width < width)
+            continue;
+
+        if (!bestShelf || shelf.Height < bestShelf->Height)
+            bestShelf = &shelf;
+    }
+
+    if (!bestShelf)
+    {
+        if (m_pageSize - page.Height < shelfHeight)
+            return false;
+
+        page.Shelves.push_back(Shelf{ page.Height, shelfHeight, 0 });
+        page.Height += shelfHeight;
+        bestShelf = &page.Shelves.back();
+    }
+
+    allocation->Page = pageIndex;
+    allocation->Rect = D2D1_RECT_U{ bestShelf->Width, bestShelf->Top, bestShelf->Width + width, bestShelf->Top + height };
+
+    bestShelf->Width += width;
+
+    Touch(pageIndex);
+
+    return true;
+}
+
+
+uint32_t TextCacheAtlas::FindLeastRecentlyUsedPage() const
+{
+    uint32_t oldest = NoPage;
+
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        if (m_pages[i].PinCount > 0)
+            continue;
+
+        if (oldest == NoPage || m_pages[i].LastUsed < m_pages[oldest].LastUsed)
+            oldest = i;
+    }
+
+    return oldest;
+}
+
+
+void TextCacheAtlas::Touch(uint32_t page)
+{
+    assert(page < m_pages.size());
+
+    m_pages[page].LastUsed = ++m_clock;
+}
+
+
+void TextCacheAtlas::Pin(uint32_t page)
+{
+    assert(page < m_pages.size());
+
+    m_pages[page].PinCount++;
+}
+
+
+void TextCacheAtlas::Unpin(uint32_t page)
+{
+    assert(page < m_pages.size());
+    assert(m_pages[page].PinCount > 0);
+
+    m_pages[page].PinCount--;
+}
+
+
+void TextCacheAtlas::Clear()
+{
+    m_pages.clear();
+}
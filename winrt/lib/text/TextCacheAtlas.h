@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // Decides where CanvasTextCache places each rasterized string.
+    //
+    // Space is handed out from square pages using shelf packing: each page is
+    // divided into horizontal shelves, and rectangles are placed left to right
+    // along the shelf whose height fits them best.  Shelf heights are rounded
+    // up so that strings drawn with the same format share shelves.
+    //
+    // Pages are the unit of eviction.  Once MaximumPageCount pages exist, the
+    // least recently used page is emptied to make room, and the caller is told
+    // which page that was so that it can forget the entries stored there.
+    // Pinned pages are never chosen; the caller pins pages that still have
+    // draws pending against them.
+    //
+    // This class only does the bookkeeping; it knows nothing about bitmaps.
+    // It is not thread-safe.
+    //
+    class TextCacheAtlas
+    {
+    public:
+        static uint32_t const NoPage = UINT32_MAX;
+        static uint32_t const ShelfHeightGranularity = 4;
+
+        struct Allocation
+        {
+            uint32_t Page;
+            D2D1_RECT_U Rect;
+        };
+
+        TextCacheAtlas(uint32_t pageSize, uint32_t maximumPageCount);
+
+        uint32_t GetPageSize() const;
+        uint32_t GetPageCount() const;
+
+        uint32_t GetMaximumPageCount() const;
+
+        // Returns true if existing pages had to be discarded, in which case
+        // the atlas is now empty.
+        bool SetMaximumPageCount(uint32_t value);
+
+        // Returns false if the rectangle can never fit (it is larger than a
+        // page), or if there is no room for it and every page is pinned.
+        // Otherwise allocation is filled in, and evictedPage is set to the
+        // page that was emptied to make room, or NoPage.
+        bool Allocate(uint32_t width, uint32_t height, Allocation* allocation, uint32_t* evictedPage);
+
+        // Marks a page as used, for the purposes of choosing which page to evict.
+        void Touch(uint32_t page);
+
+        // Pins nest; a page can be evicted again once every Pin has been
+        // matched by an Unpin.  Clear() and SetMaximumPageCount() drop pins
+        // along with the pages.
+        void Pin(uint32_t page);
+        void Unpin(uint32_t page);
+
+        void Clear();
+
+    private:
+        struct Shelf
+        {
+            uint32_t Top;
+            uint32_t Height;
+            uint32_t Width;     // How much of the shelf is in use
+        };
+
+        struct Page
+        {
+            std::vector<Shelf> Shelves;
+            uint32_t Height;    // How much of the page is covered by shelves
+            uint64_t LastUsed;
+            uint32_t PinCount;
+        };
+
+        uint32_t m_pageSize;
+        uint32_t m_maximumPageCount;
+        std::vector<Page> m_pages;
+        uint64_t m_clock;
+
+        bool TryAllocateFromPage(uint32_t pageIndex, uint32_t width, uint32_t height, Allocation* allocation);
+        uint32_t FindLeastRecentlyUsedPage() const;
+    };
+}}}}}
@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextLayoutHitTestIndex.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+TextLayoutHitTestIndex::TextLayoutHitTestIndex()
+    : m_textLength(0)
+{
+}
+
+
+std::unique_ptr<TextLayoutHitTestIndex> TextLayoutHitTestIndex::TryCreate(
+    IDWriteTextLayout3* layout,
+    TextLayoutMetricsSnapshot* metricsSnapshot)
+{
+    if (layout->GetFlowDirection() != DWRITE_FLOW_DIRECTION_TOP_TO_BOTTOM ||
+        layout->GetReadingDirection() != DWRITE_READING_DIRECTION_LEFT_TO_RIGHT ||
+        layout->GetTextAlignment() == DWRITE_TEXT_ALIGNMENT_JUSTIFIED)
+    {
+        return nullptr;
+    }
+
+    DWRITE_TRIMMING trimming;
+    ComPtr<IDWriteInlineObject> trimmingSign;
+    ThrowIfFailed(layout->GetTrimming(&trimming, &trimmingSign));
+
+    if (trimming.granularity != DWRITE_TRIMMING_GRANULARITY_NONE)
+        return nullptr;
+
+    auto& clusterMetrics = metricsSnapshot->GetClusterMetrics(layout);
+    auto clusterCount = static_cast<uint32_t>(clusterMetrics.size());
+
+    if (clusterCount == 0)
+        return nullptr;
+
+    for (auto const& metrics : clusterMetrics)
+    {
+        if ((metrics.Properties & CanvasClusterProperties::RightToLeft) != CanvasClusterProperties::None)
+            return nullptr;
+    }
+
+    auto& lineMetrics = metricsSnapshot->GetLineMetrics(layout);
+    auto lineCount = static_cast<uint32_t>(lineMetrics.size());
+
+    std::unique_ptr<TextLayoutHitTestIndex> index(new TextLayoutHitTestIndex());
+
+    index->m_lines.reserve(lineCount);
+    index->m_clusters.reserve(clusterCount);
+
+    uint32_t clusterIndex = 0;
+    uint32_t textPosition = 0;
+
+    for (uint32_t lineIndex = 0; lineIndex < lineCount; ++lineIndex)
+    {
+        Line line{};
+        line.FirstCluster = clusterIndex;
+        line.FirstCharacter = textPosition;
+        line.Height = lineMetrics[lineIndex].Height;
+
+        //
+        // Where each line starts depends on the text alignment and the
+        // width of the line, so that's left to DWrite.
+        //
+        DWRITE_HIT_TEST_METRICS lineStartMetrics;
+        ThrowIfFailed(layout->HitTestTextPosition(textPosition, FALSE, &line.Left, &line.Top, &lineStartMetrics));
+
+        auto lineEnd = textPosition + static_cast<uint32_t>(lineMetrics[lineIndex].CharacterCount);
+        auto x = line.Left;
+
+        while (clusterIndex < clusterCount && textPosition < lineEnd)
+        {
+            auto const& metrics = clusterMetrics[clusterIndex];
+
+            Cluster cluster;
+            cluster.TextPosition = textPosition;
+            cluster.Length = static_cast<uint32_t>(metrics.CharacterCount);
+            cluster.Left = x;
+            cluster.Width = metrics.Width;
+            cluster.Line = lineIndex;
+            cluster.IsNewline = (metrics.Properties & CanvasClusterProperties::Newline) != CanvasClusterProperties::None;
+
+            index->m_clusters.push_back(cluster);
+
+            x += metrics.Width;
+            textPosition += cluster.Length;
+            ++clusterIndex;
+        }
+
+        line.EndCluster = clusterIndex;
+        line.Right = x;
+
+        index->m_lines.push_back(line);
+    }
+
+    index->m_textLength = textPosition;
+
+    return index;
+}
+
+
+DWRITE_HIT_TEST_METRICS TextLayoutHitTestIndex::GetClusterHitTestMetrics(Cluster const& cluster) const
+{
+    auto const& line = m_lines[cluster.Line];
+
+    DWRITE_HIT_TEST_METRICS metrics{};
+    metrics.textPosition = cluster.TextPosition;
+    metrics.length = cluster.Length;
+    metrics.left = cluster.Left;
+    metrics.top = line.Top;
+    metrics.width = cluster.Width;
+    metrics.height = line.Height;
+    metrics.isText = TRUE;
+    return metrics;
+}
+
+
+DWRITE_HIT_TEST_METRICS TextLayoutHitTestIndex::GetEmptyLineHitTestMetrics(Line const& line) const
+{
+    DWRITE_HIT_TEST_METRICS metrics{};
+    metrics.textPosition = line.FirstCharacter;
+    metrics.left = line.Left;
+    metrics.top = line.Top;
+    metrics.height = line.Height;
+    return metrics;
+}
+
+
+void TextLayoutHitTestIndex::HitTestPoint(
+    float pointX,
+    float pointY,
+    BOOL* isTrailingHit,
+    BOOL* isInside,
+    DWRITE_HIT_TEST_METRICS* hitTestMetrics) const
+{
+    auto lineIt = std::upper_bound(
+        m_lines.begin(),
+        m_lines.end(),
+        pointY,
+        [](float y, Line const& line) { return y < line.Top; });
+
+    if (lineIt != m_lines.begin())
+        --lineIt;
+
+    auto const& line = *lineIt;
+
+    bool isInsideVertically =
+        pointY >= m_lines.front().Top &&
+        pointY < m_lines.back().Top + m_lines.back().Height;
+
+    //
+    // The newline at the end of a line can't be hit; points past the end of
+    // the line hit the trailing side of the last cluster before it.
+    //
+    auto firstCluster = m_clusters.begin() + line.FirstCluster;
+    auto endCluster = m_clusters.begin() + line.EndCluster;
+
+    while (endCluster != firstCluster && std::prev(endCluster)->IsNewline)
+    {
+        --endCluster;
+    }
+
+    if (endCluster == firstCluster)
+    {
+        // An empty line, or one holding nothing but a newline.
+        *hitTestMetrics = (line.FirstCluster == line.EndCluster)
+            ? GetEmptyLineHitTestMetrics(line)
+            : GetClusterHitTestMetrics(*firstCluster);
+        *isTrailingHit = FALSE;
+        *isInside = FALSE;
+        return;
+    }
+
+    auto right = std::prev(endCluster)->Left + std::prev(endCluster)->Width;
+
+    *isInside = isInsideVertically && pointX >= line.Left && pointX < right;
+
+    if (pointX < line.Left)
+    {
+        *hitTestMetrics = GetClusterHitTestMetrics(*firstCluster);
+        *isTrailingHit = FALSE;
+        return;
+    }
+
+    if (pointX >= right)
+    {
+        *hitTestMetrics = GetClusterHitTestMetrics(*std::prev(endCluster));
+        *isTrailingHit = TRUE;
+        return;
+    }
+
+    auto clusterIt = std::upper_bound(
+        firstCluster,
+        endCluster,
+        pointX,
+        [](float x, Cluster const& cluster) { return x < cluster.Left; });
+
+    auto const& cluster = *std::prev(clusterIt);
+
+    *hitTestMetrics = GetClusterHitTestMetrics(cluster);
+    *isTrailingHit = (pointX >= cluster.Left + cluster.Width / 2) ? TRUE : FALSE;
+}
+
+
+void TextLayoutHitTestIndex::HitTestTextPosition(
+    uint32_t textPosition,
+    BOOL isTrailingHit,
+    float* pointX,
+    float* pointY,
+    DWRITE_HIT_TEST_METRICS* hitTestMetrics) const
+{
+    if (textPosition >= m_textLength)
+    {
+        //
+        // Past the end of the text.  Text ending in a newline has an empty
+        // final line, and the caret goes at its start; otherwise it goes
+        // after the last cluster.
+        //
+        auto const& lastLine = m_lines.back();
+
+        if (lastLine.FirstCluster == lastLine.EndCluster)
+        {
+            *hitTestMetrics = GetEmptyLineHitTestMetrics(lastLine);
+            *pointX = lastLine.Left;
+            *pointY = lastLine.Top;
+        }
+        else
+        {
+            *hitTestMetrics = GetClusterHitTestMetrics(m_clusters.back());
+            *pointX = lastLine.Right;
+            *pointY = lastLine.Top;
+        }
+        return;
+    }
+
+    auto clusterIt = std::upper_bound(
+        m_clusters.begin(),
+        m_clusters.end(),
+        textPosition,
+        [](uint32_t position, Cluster const& cluster) { return position < cluster.TextPosition; });
+
+    auto const& cluster = *std::prev(clusterIt);
+
+    *hitTestMetrics = GetClusterHitTestMetrics(cluster);
+    *pointX = isTrailingHit ? cluster.Left + cluster.Width : cluster.Left;
+    *pointY = m_lines[cluster.Line].Top;
+}
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "TextLayoutMetricsSnapshot.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // Answers HitTestPoint and HitTestTextPosition queries for a DWrite text
+    // layout without going back to DWrite for each one.
+    //
+    // The index is built from the line and cluster metrics held in the
+    // layout's metrics snapshot, plus one HitTestTextPosition call per line
+    // to find where the line starts.
+    // Within a line, cluster positions are prefix sums of the cluster
+    // widths, so a query is a binary search over the lines followed by one
+    // over the clusters.
+    //
+    // Clusters are only laid out in order of their advance widths for
+    // horizontal, left-to-right text that isn't justified or trimmed, so
+    // TryCreate returns null for any other layout.
+    //
+    class TextLayoutHitTestIndex
+    {
+        struct Line
+        {
+            uint32_t FirstCluster;
+            uint32_t EndCluster;
+            uint32_t FirstCharacter;
+            float Left;
+            float Right;
+            float Top;
+            float Height;
+        };
+
+        struct Cluster
+        {
+            uint32_t TextPosition;
+            uint32_t Length;
+            float Left;
+            float Width;
+            uint32_t Line;
+            bool IsNewline;
+        };
+
+        std::vector<Line> m_lines;
+        std::vector<Cluster> m_clusters;
+        uint32_t m_textLength;
+
+    public:
+        static std::unique_ptr<TextLayoutHitTestIndex> TryCreate(
+            IDWriteTextLayout3* layout,
+            TextLayoutMetricsSnapshot* metricsSnapshot);
+
+        // These match the IDWriteTextLayout methods of the same name.
+
+        void HitTestPoint(
+            float pointX,
+            float pointY,
+            BOOL* isTrailingHit,
+            BOOL* isInside,
+            DWRITE_HIT_TEST_METRICS* hitTestMetrics) const;
+
+        void HitTestTextPosition(
+            uint32_t textPosition,
+            BOOL isTrailingHit,
+            float* pointX,
+            float* pointY,
+            DWRITE_HIT_TEST_METRICS* hitTestMetrics) const;
+
+    private:
+        TextLayoutHitTestIndex();
+
+        DWRITE_HIT_TEST_METRICS GetClusterHitTestMetrics(Cluster const& cluster) const;
+        DWRITE_HIT_TEST_METRICS GetEmptyLineHitTestMetrics(Line const& line) const;
+    };
+}}}}}
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextLayoutMetricsSnapshot.h"
+#include "utils/ScratchBuffer.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+
+static CanvasLineMetrics ToCanvasLineMetrics(DWRITE_LINE_METRICS1 const& dwriteMetrics)
+{
+    CanvasLineMetrics metrics{};
+    metrics.CharacterCount = dwriteMetrics.length;
+    metrics.TrailingWhitespaceCount = dwriteMetrics.trailingWhitespaceLength;
+    metrics.TerminalNewlineCount = dwriteMetrics.newlineLength;
+    metrics.Height = dwriteMetrics.height;
+    metrics.Baseline = dwriteMetrics.baseline;
+    metrics.IsTrimmed = !!dwriteMetrics.isTrimmed;
+    metrics.LeadingWhitespaceBefore = dwriteMetrics.leadingBefore;
+    metrics.LeadingWhitespaceAfter = dwriteMetrics.leadingAfter;
+    return metrics;
+}
+
+
+static CanvasClusterMetrics ToCanvasClusterMetrics(DWRITE_CLUSTER_METRICS const& dwriteMetrics)
+{
+    CanvasClusterMetrics metrics{};
+    metrics.CharacterCount = dwriteMetrics.length;
+    metrics.Width = dwriteMetrics.width;
+
+    if (dwriteMetrics.canWrapLineAfter)
+        metrics.Properties |= CanvasClusterProperties::CanWrapLineAfter;
+
+    if (dwriteMetrics.isWhitespace)
+        metrics.Properties |= CanvasClusterProperties::Whitespace;
+
+    if (dwriteMetrics.isNewline)
+        metrics.Properties |= CanvasClusterProperties::Newline;
+
+    if (dwriteMetrics.isSoftHyphen)
+        metrics.Properties |= CanvasClusterProperties::SoftHyphen;
+
+    if (dwriteMetrics.isRightToLeft)
+        metrics.Properties |= CanvasClusterProperties::RightToLeft;
+
+    return metrics;
+}
+
+
+TextLayoutMetricsSnapshot::TextLayoutMetricsSnapshot()
+    : m_textMetrics{}
+    , m_hasTextMetrics(false)
+    , m_drawBounds{}
+    , m_hasDrawBounds(false)
+    , m_hasLineMetrics(false)
+    , m_hasClusterMetrics(false)
+{
+}
+
+
+DWRITE_TEXT_METRICS1 const& TextLayoutMetricsSnapshot::GetTextMetrics(IDWriteTextLayout3* layout)
+{
+    if (!m_hasTextMetrics)
+    {
+        ThrowIfFailed(layout->GetMetrics(&m_textMetrics));
+        m_hasTextMetrics = true;
+    }
+
+    return m_textMetrics;
+}
+
+
+Rect const& TextLayoutMetricsSnapshot::GetDrawBounds(IDWriteTextLayout3* layout)
+{
+    if (!m_hasDrawBounds)
+    {
+        DWRITE_OVERHANG_METRICS dwriteOverhangMetrics;
+        ThrowIfFailed(layout->GetOverhangMetrics(&dwriteOverhangMetrics));
+
+        const float left = -dwriteOverhangMetrics.left;
+        const float right = dwriteOverhangMetrics.right + layout->GetMaxWidth();
+        const float width = right - left;
+
+        const float top = -dwriteOverhangMetrics.top;
+        const float bottom = dwriteOverhangMetrics.bottom + layout->GetMaxHeight();
+        const float height = bottom - top;
+
+        m_drawBounds = Rect{ left, top, width, height };
+        m_hasDrawBounds = true;
+    }
+
+    return m_drawBounds;
+}
+
+
+std::vector<CanvasLineMetrics> const& TextLayoutMetricsSnapshot::GetLineMetrics(IDWriteTextLayout3* layout)
+{
+    if (!m_hasLineMetrics)
+    {
+        //
+        // If the text metrics are already known they give the line count,
+        // which saves asking DWrite for it separately.
+        //
+        uint32_t lineCount = m_hasTextMetrics ? m_textMetrics.lineCount : 0;
+
+        ScratchBuffer<DWRITE_LINE_METRICS1> dwriteMetrics(lineCount);
+        HRESULT hr = layout->GetLineMetrics(lineCount ? dwriteMetrics.GetData() : nullptr, lineCount, &lineCount);
+
+        if (hr == E_NOT_SUFFICIENT_BUFFER)
+        {
+            dwriteMetrics.Resize(lineCount);
+            hr = layout->GetLineMetrics(dwriteMetrics.GetData(), lineCount, &lineCount);
+        }
+        else if (SUCCEEDED(hr) && !m_hasTextMetrics)
+        {
+            // A layout always has at least one line.
+            hr = E_UNEXPECTED;
+        }
+
+        ThrowIfFailed(hr);
+
+        m_lineMetrics.resize(lineCount);
+        std::transform(dwriteMetrics.begin(), dwriteMetrics.begin() + lineCount, m_lineMetrics.begin(), ToCanvasLineMetrics);
+        m_hasLineMetrics = true;
+    }
+
+    return m_lineMetrics;
+}
+
+
+std::vector<CanvasClusterMetrics> const& TextLayoutMetricsSnapshot::GetClusterMetrics(IDWriteTextLayout3* layout)
+{
+    if (!m_hasClusterMetrics)
+    {
+        uint32_t clusterCount;
+        HRESULT hr = layout->GetClusterMetrics(nullptr, 0, &clusterCount);
+
+        //
+        // GetClusterMetrics can return S_OK here, since it's valid for a
+        // text layout to contain no clusters.
+        //
+
+        if (FAILED(hr) && hr != E_NOT_SUFFICIENT_BUFFER)
+            ThrowHR(E_UNEXPECTED);
+
+        ScratchBuffer<DWRITE_CLUSTER_METRICS> dwriteMetrics(clusterCount);
+
+        if (clusterCount > 0)
+            ThrowIfFailed(layout->GetClusterMetrics(dwriteMetrics.GetData(), clusterCount, &clusterCount));
+
+        m_clusterMetrics.resize(clusterCount);
+        std::transform(dwriteMetrics.begin(), dwriteMetrics.begin() + clusterCount, m_clusterMetrics.begin(), ToCanvasClusterMetrics);
+        m_hasClusterMetrics = true;
+    }
+
+    return m_clusterMetrics;
+}
+
+
+void TextLayoutMetricsSnapshot::Invalidate()
+{
+    m_hasTextMetrics = false;
+    m_hasDrawBounds = false;
+    m_hasLineMetrics = false;
+    m_hasClusterMetrics = false;
+
+    // The vectors keep their capacity, so refetching after a change
+    // usually doesn't need to allocate.
+    m_lineMetrics.clear();
+    m_clusterMetrics.clear();
+}
@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // Holds the metrics of a DWrite text layout, so that repeatedly reading
+    // them doesn't go back to DWrite, or allocate, each time.
+    //
+    // Each kind of metrics is fetched the first time it's asked for, and
+    // kept until Invalidate is called.  The owner must call Invalidate
+    // whenever the layout changes.
+    //
+    // Line and cluster metrics are stored already converted to their Win2D
+    // types, so they can be copied straight out to callers.
+    //
+    class TextLayoutMetricsSnapshot
+    {
+        DWRITE_TEXT_METRICS1 m_textMetrics;
+        bool m_hasTextMetrics;
+
+        Rect m_drawBounds;
+        bool m_hasDrawBounds;
+
+        std::vector<CanvasLineMetrics> m_lineMetrics;
+        bool m_hasLineMetrics;
+
+        std::vector<CanvasClusterMetrics> m_clusterMetrics;
+        bool m_hasClusterMetrics;
+
+    public:
+        TextLayoutMetricsSnapshot();
+
+        DWRITE_TEXT_METRICS1 const& GetTextMetrics(IDWriteTextLayout3* layout);
+        Rect const& GetDrawBounds(IDWriteTextLayout3* layout);
+        std::vector<CanvasLineMetrics> const& GetLineMetrics(IDWriteTextLayout3* layout);
+        std::vector<CanvasClusterMetrics> const& GetClusterMetrics(IDWriteTextLayout3* layout);
+
+        void Invalidate();
+    };
+}}}}}
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <AllocationTracking.h>
+
+#include "LockUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+//
+// The thread_locals are plain pointers and flags so that they need no
+// dynamic initialization or destruction: operator new can be called at any
+// point in a thread's lifetime.
+//
+
+static thread_local AllocationTracker::Scope* t_currentScope;
+static thread_local bool t_isSuspended;
+
+static std::atomic<uint64_t> s_unattributedAllocationCount;
+static std::atomic<uint64_t> s_unattributedByteCount;
+
+
+namespace
+{
+    struct TableEntry
+    {
+        uint64_t CallCount;
+        uint64_t AllocationCount;
+        uint64_t ByteCount;
+    };
+
+    // The table is keyed on the name pointer, which is cheap to look up when
+    // each outermost scope ends.  Entries that have the same name but came
+    // from different string literals are combined by GetSnapshot.
+    struct Table
+    {
+        std::mutex Mutex;
+        std::unordered_map<char const*, TableEntry> Entries;
+    };
+
+    // Lets LogSnapshotNoLock avoid creating the table during DLL unload,
+    // which would allocate.
+    std::atomic<bool> s_isTableCreated;
+
+    Table& GetTable()
+    {
+        static Table table;
+        s_isTableCreated = true;
+        return table;
+    }
+
+    // The tracker's own allocations are not counted.
+    class SuspendTracking
+    {
+        bool m_wasSuspended;
+
+    public:
+        SuspendTracking()
+            : m_wasSuspended(t_isSuspended)
+        {
+            t_isSuspended = true;
+        }
+
+        ~SuspendTracking()
+        {
+            t_isSuspended = m_wasSuspended;
+        }
+    };
+}
+
+
+char const* const AllocationTracker::UnattributedName = "<unattributed>";
+
+
+AllocationTracker::Scope::Scope(char const* apiName)
+    : m_apiName(apiName)
+    , m_isOutermost(t_currentScope == nullptr)
+    , m_allocationCount(0)
+    , m_byteCount(0)
+{
+    if (m_isOutermost)
+        t_currentScope = this;
+}
+
+
+AllocationTracker::Scope::~Scope()
+{
+    if (!m_isOutermost)
+        return;
+
+    t_currentScope = nullptr;
+
+    AllocationTracker::Merge(*this);
+}
+
+
+void AllocationTracker::RecordAllocation(size_t size)
+{
+    if (t_isSuspended)
+        return;
+
+    if (auto scope = t_currentScope)
+    {
+        scope->m_allocationCount++;
+        scope->m_byteCount += size;
+    }
+    else
+    {
+        s_unattributedAllocationCount++;
+        s_unattributedByteCount += size;
+    }
+}
+
+
+void AllocationTracker::Merge(Scope const& scope)
+{
+    SuspendTracking suspend;
+
+    auto& table = GetTable();
+
+    Lock lock(table.Mutex);
+
+    auto& entry = table.Entries[scope.m_apiName];
+
+    entry.CallCount++;
+    entry.AllocationCount += scope.m_allocationCount;
+    entry.ByteCount += scope.m_byteCount;
+}
+
+
+std::vector<AllocationTracker::Totals> AllocationTracker::GetSnapshot()
+{
+    SuspendTracking suspend;
+
+    std::map<std::string, Totals> totalsByName;
+
+    {
+        auto& table = GetTable();
+
+        Lock lock(table.Mutex);
+
+        for (auto& entry : table.Entries)
+        {
+            auto& totals = totalsByName[entry.first];
+
+            totals.ApiName = entry.first;
+            totals.CallCount += entry.second.CallCount;
+            totals.AllocationCount += entry.second.AllocationCount;
+            totals.ByteCount += entry.second.ByteCount;
+        }
+    }
+
+    std::vector<Totals> snapshot;
+    snapshot.reserve(totalsByName.size() + 1);
+
+    for (auto& totals : totalsByName)
+    {
+        snapshot.push_back(std::move(totals.second));
+    }
+
+    uint64_t unattributedAllocationCount = s_unattributedAllocationCount;
+
+    if (unattributedAllocationCount)
+    {
+        snapshot.push_back(Totals{ UnattributedName, 0, unattributedAllocationCount, s_unattributedByteCount });
+    }
+
+    std::stable_sort(snapshot.begin(), snapshot.end(),
+        [] (Totals const& a, Totals const& b)
+        {
+            return a.AllocationCount > b.AllocationCount;
+        });
+
+    return snapshot;
+}
+
+
+void AllocationTracker::LogSnapshot()
+{
+    auto snapshot = GetSnapshot();
+
+    for (auto& totals : snapshot)
+    {
+        EventWrite_AllocationTracking_ApiTotals(totals.ApiName.c_str(), totals.CallCount, totals.AllocationCount, totals.ByteCount);
+    }
+}
+
+
+void AllocationTracker::LogSnapshotNoLock()
+{
+    if (s_isTableCreated)
+    {
+        for (auto& entry : GetTable().Entries)
+        {
+            EventWrite_AllocationTracking_ApiTotals(entry.first, entry.second.CallCount, entry.second.AllocationCount, entry.second.ByteCount);
+        }
+    }
+
+    uint64_t unattributedAllocationCount = s_unattributedAllocationCount;
+
+    if (unattributedAllocationCount)
+    {
+        EventWrite_AllocationTracking_ApiTotals(UnattributedName, 0, unattributedAllocationCount, s_unattributedByteCount);
+    }
+}
+
+
+void AllocationTracker::Reset()
+{
+    SuspendTracking suspend;
+
+    auto& table = GetTable();
+
+    {
+        Lock lock(table.Mutex);
+        table.Entries.clear();
+    }
+
+    s_unattributedAllocationCount = 0;
+    s_unattributedByteCount = 0;
+}
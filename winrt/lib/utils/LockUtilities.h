@@ -8,6 +8,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     typedef std::unique_lock<std::mutex> Lock;
     typedef std::unique_lock<std::recursive_mutex> RecursiveLock;
+    typedef std::shared_lock<std::shared_timed_mutex> SharedLock;
+    typedef std::unique_lock<std::shared_timed_mutex> ExclusiveLock;
 
     template<typename LOCK>
     inline void MustOwnLock(LOCK const& lock)
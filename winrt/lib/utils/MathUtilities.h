@@ -40,6 +40,113 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    //
+    // Floating point rectangle helpers, used where Win2D computes bounds on
+    // the CPU.  Rectangles with any edge at +/-FLT_MAX (eg. D2D1::InfiniteRect)
+    // are treated as unbounded, and stay that way when transformed.
+    //
+
+    inline bool IsInfiniteRectangle(D2D1_RECT_F const& rect)
+    {
+        return rect.left <= -FLT_MAX || rect.top <= -FLT_MAX ||
+               rect.right >= FLT_MAX || rect.bottom >= FLT_MAX;
+    }
+
+
+    inline bool IsEmptyRectangle(D2D1_RECT_F const& rect)
+    {
+        return !(rect.right > rect.left) || !(rect.bottom > rect.top);
+    }
+
+
+    inline bool RectanglesIntersect(D2D1_RECT_F const& rect1, D2D1_RECT_F const& rect2)
+    {
+        return rect1.left < rect2.right &&
+               rect2.left < rect1.right &&
+               rect1.top < rect2.bottom &&
+               rect2.top < rect1.bottom;
+    }
+
+
+    inline D2D1_RECT_F RectangleUnion(D2D1_RECT_F const& rect1, D2D1_RECT_F const& rect2)
+    {
+        return D2D1_RECT_F
+        {
+            std::min(rect1.left,   rect2.left),
+            std::min(rect1.top,    rect2.top),
+            std::max(rect1.right,  rect2.right),
+            std::max(rect1.bottom, rect2.bottom),
+        };
+    }
+
+
+    inline D2D1_RECT_F RectangleIntersection(D2D1_RECT_F const& rect1, D2D1_RECT_F const& rect2)
+    {
+        return D2D1_RECT_F
+        {
+            std::max(rect1.left,   rect2.left),
+            std::max(rect1.top,    rect2.top),
+            std::min(rect1.right,  rect2.right),
+            std::min(rect1.bottom, rect2.bottom),
+        };
+    }
+
+
+    // True if outer covers every point of inner.
+    inline bool RectangleContains(D2D1_RECT_F const& outer, D2D1_RECT_F const& inner)
+    {
+        return outer.left   <= inner.left &&
+               outer.top    <= inner.top &&
+               outer.right  >= inner.right &&
+               outer.bottom >= inner.bottom;
+    }
+
+
+    inline D2D1_RECT_F InflateRectangle(D2D1_RECT_F const& rect, float amount)
+    {
+        if (IsInfiniteRectangle(rect))
+            return rect;
+
+        return D2D1_RECT_F
+        {
+            rect.left   - amount,
+            rect.top    - amount,
+            rect.right  + amount,
+            rect.bottom + amount,
+        };
+    }
+
+
+    // Returns the axis aligned bounding box of the transformed rectangle.
+    inline D2D1_RECT_F TransformRectangle(D2D1_RECT_F const& rect, D2D1_MATRIX_3X2_F const& transform)
+    {
+        if (IsInfiniteRectangle(rect))
+            return D2D1::InfiniteRect();
+
+        auto& matrix = *D2D1::Matrix3x2F::ReinterpretBaseType(&transform);
+
+        D2D1_POINT_2F corners[] =
+        {
+            matrix.TransformPoint(D2D1::Point2F(rect.left,  rect.top)),
+            matrix.TransformPoint(D2D1::Point2F(rect.right, rect.top)),
+            matrix.TransformPoint(D2D1::Point2F(rect.left,  rect.bottom)),
+            matrix.TransformPoint(D2D1::Point2F(rect.right, rect.bottom)),
+        };
+
+        D2D1_RECT_F result{ corners[0].x, corners[0].y, corners[0].x, corners[0].y };
+
+        for (auto& corner : corners)
+        {
+            result.left   = std::min(result.left,   corner.x);
+            result.top    = std::min(result.top,    corner.y);
+            result.right  = std::max(result.right,  corner.x);
+            result.bottom = std::max(result.bottom, corner.y);
+        }
+
+        return result;
+    }
+
+
     inline Numerics::Matrix3x2 const& Identity3x2()
     {
         static Numerics::Matrix3x2 identity{ 1, 0, 0, 1, 0, 0 };
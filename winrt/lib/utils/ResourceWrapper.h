@@ -71,6 +71,24 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             }
         }
 
+        // Replaces the resource in a single step, so that other threads never
+        // see the wrapper as closed in between.  The old resource is returned
+        // rather than released, so that the caller controls when it goes away.
+        ComPtr<TResource> ExchangeResource(TResource* resource)
+        {
+            assert(resource);
+
+            ResourceManager::RegisterWrapper(resource, GetOuterInspectable());
+
+            ComPtr<TResource> previous = m_resource.UncheckedGet();
+            m_resource = resource;
+
+            if (previous)
+                ResourceManager::UnregisterWrapper(previous.Get());
+
+            return previous;
+        }
+
     public:
         ComPtr<TResource> const& GetResource()
         {
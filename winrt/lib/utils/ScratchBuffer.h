@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Temporary storage for the intermediate arrays that APIs build on the
+    // way to their ComArray result, eg. the DWRITE_*_METRICS that are then
+    // converted to their Canvas equivalents.
+    //
+    // Each thread keeps a small stack of buffers per element type.  A
+    // ScratchBuffer takes the next free one for the duration of the call, so
+    // scratch buffers of the same type can be nested.  The buffers keep
+    // their capacity between calls, so after the first call at a given size
+    // no further allocations are needed.  Buffers that grew larger than
+    // MaxRetainedBytes are freed when released, rather than being held on to
+    // for the lifetime of the thread.
+    //
+    // Only plain-old-data is supported; Resize value-initializes any new
+    // elements, but the contents are otherwise unspecified.
+    //
+    template<typename T>
+    class ScratchBuffer
+    {
+        static_assert(std::is_pod<T>::value, "T must be plain-old-data");
+
+        struct Pool
+        {
+            std::vector<std::unique_ptr<std::vector<T>>> Buffers;
+            size_t InUseCount = 0;
+        };
+
+        static Pool& GetPool()
+        {
+            static thread_local Pool pool;
+            return pool;
+        }
+
+        Pool& m_pool;
+        std::vector<T>* m_buffer;
+
+    public:
+        static size_t const MaxRetainedBytes = 256 * 1024;
+
+        explicit ScratchBuffer(size_t size = 0)
+            : m_pool(GetPool())
+        {
+            if (m_pool.InUseCount == m_pool.Buffers.size())
+                m_pool.Buffers.push_back(std::make_unique<std::vector<T>>());
+
+            m_buffer = m_pool.Buffers[m_pool.InUseCount].get();
+            m_pool.InUseCount++;
+
+            m_buffer->clear();
+            m_buffer->resize(size);
+        }
+
+        ~ScratchBuffer()
+        {
+            assert(m_pool.InUseCount > 0 && m_pool.Buffers[m_pool.InUseCount - 1].get() == m_buffer);
+
+            if (m_buffer->capacity() * sizeof(T) > MaxRetainedBytes)
+                std::vector<T>().swap(*m_buffer);
+
+            m_pool.InUseCount--;
+        }
+
+        ScratchBuffer(ScratchBuffer const&) = delete;
+        ScratchBuffer& operator=(ScratchBuffer const&) = delete;
+
+        void Resize(size_t size)
+        {
+            m_buffer->resize(size);
+        }
+
+        T* GetData()
+        {
+            return m_buffer->data();
+        }
+
+        uint32_t GetSize() const
+        {
+            return static_cast<uint32_t>(m_buffer->size());
+        }
+
+        size_t GetCapacity() const
+        {
+            return m_buffer->capacity();
+        }
+
+        T& operator[](size_t index)
+        {
+            assert(index < m_buffer->size());
+            return (*m_buffer)[index];
+        }
+
+        T* begin() { return m_buffer->data(); }
+        T* end() { return m_buffer->data() + m_buffer->size(); }
+
+        // Number of buffers of this type currently in use on this thread.
+        static size_t GetInUseCount()
+        {
+            return GetPool().InUseCount;
+        }
+    };
+}}}}
@@ -28,6 +28,7 @@ STRING(CreateDrawingSessionCalledBeforeRegionsInvalidated, L"CreateDrawingSessio
 STRING(CustomEffectBadFeatureLevel, L"This shader requires a higher Direct3D feature level than is supported by the device. Check PixelShaderEffect.IsSupported before using it.")
 STRING(CustomEffectBadShader, L"Unable to load the specified shader. This should be a Direct3D pixel shader compiled for shader model 4.")
 STRING(CustomEffectBadPropertyType, L"Shader property '%S' is an unsupported type.")
+STRING(CustomEffectInvalidPropertyHandle, L"Invalid shader property handle. Use PixelShaderEffect.GetPropertyHandle to look one up.")
 STRING(CustomEffectMaxOffsetWithoutOffsetMapping, L"When PixelShaderEffect.MaxSamplerOffset is set, at least one source should be using SamplerCoordinateMapping.Offset.")
 STRING(CustomEffectOffsetMappingWithoutMaxOffset, L"When PixelShaderEffect.Source%dMapping is set to Offset, MaxSamplerOffset should also be set.")
 STRING(CustomEffectSourceOutOfRange, L"Source%d must be null when using this pixel shader (shader inputs: %d).")
@@ -35,6 +36,7 @@ STRING(CustomEffectTooManyConstantBuffers, L"Unsupported constant buffer layout.
 STRING(CustomEffectTooManyTextures, L"Shader has too many input textures.")
 STRING(CustomEffectUnknownProperty, L"Shader does not have a property named '%s'.")
 STRING(CustomEffectWrongPropertyArraySize, L"Wrong array size. Shader property '%s' is an array of %d elements.")
+STRING(CustomEffectWrongPropertyHandleType, L"Wrong type. Shader property '%s' cannot be set as %s.")
 STRING(CustomEffectWrongPropertyType, L"Wrong type. Shader property '%s' is of type %s.")
 STRING(CustomEffectWrongPropertyTypeArray, L"Wrong type. Shader property '%s' is an array of %s.")
 STRING(DeviceExpectedToBeLost, L"This API was unexpectedly called when the Direct3D device is not lost.")
@@ -81,6 +83,7 @@ STRING(SvgNotAvailable, L"SVG features are not supported on this version of Wind
 STRING(SvgStrokeDashArrayMismatchingArraySizes, L"The two arrays used for setting CanvasStrokeDashArrayAttribute units and values must be the same size.")
 STRING(SvgTextShouldHaveNonZeroLength, L"The specified SVG string has length zero; a valid SVG string was expected.")
 STRING(SvgViewportSizeNotValid, L"The width and height of an SVG viewport must be positive, and nonzero.")
+STRING(TextCacheDeviceMismatch, L"The CanvasTextCache was created on a different device to this drawing session.")
 STRING(TextRendererNotValid, L"The application called a method on a text renderer, but this text renderer is no longer valid.")
 STRING(TwoBeginFigures, L"A call to CanvasPathBuilder.BeginFigure occurred, when the figure was already begun.")
 STRING(UnrecognizedImageFileExtension, L"When saving a CanvasBitmap without specifying a CanvasBitmapFileFormat, the file name must include a recognized file extension such as '.jpeg' or '.png'.")
@@ -1251,6 +1251,14 @@ bool CanvasAnimatedControl::Tick(
     // To prevent this from happening we call WaitForVerticalBlank to delay the
     // next tick.
     //
+    // Swap chains with a frame latency waitable object are instead waited on
+    // with WaitForNextFrame after every tick that presented, including ones
+    // in fixed time step mode.  Present() doesn't block on these swap chains,
+    // and waiting before the next Update means that it sees the most recent
+    // input, rather than input from a frame or more ago.  The waitable object
+    // is only signaled when a Present completes, so a tick that didn't
+    // present must not wait on it.
+    //
     // Some caveats here:
     //
     //   - software devices do not support WaitForVerticalBlank. In this case
@@ -1259,10 +1267,16 @@ bool CanvasAnimatedControl::Tick(
     //   - if there's no swap chain (eg the window is invisible) then we just
     //     sleep
     //
-    if (!drew || !m_stepTimer.IsFixedTimeStep())
+    bool waitForNextFrame = drew && swapChain && swapChain->HasFrameLatencyWaitableObject();
+
+    if (!drew || !m_stepTimer.IsFixedTimeStep() || waitForNextFrame)
     {
         EventWrite_CanvasAnimatedControl_WaitForVerticalBlank_Start();
-        if (swapChain)
+        if (waitForNextFrame)
+        {
+            ThrowIfFailed(swapChain->WaitForNextFrame());
+        }
+        else if (swapChain)
         {
             ThrowIfFailed(swapChain->WaitForVerticalBlank());
         }
@@ -60,7 +60,7 @@ public:
     {
         ComPtr<ICanvasSwapChain> swapChain;
 
-        ThrowIfFailed(m_canvasSwapChainFactory->CreateWithAllOptions(
+        ThrowIfFailed(m_canvasSwapChainFactory->CreateWithOptions(
             As<ICanvasResourceCreator>(device).Get(),
             width, 
             height, 
@@ -68,6 +68,7 @@ public:
             PIXEL_FORMAT(B8G8R8A8UIntNormalized),
             2, 
             alphaMode,
+            CanvasSwapChainOptions::LowLatency,
             &swapChain));
 
         return static_cast<CanvasSwapChain*>(swapChain.Get());
@@ -30,6 +30,7 @@ namespace ABI
                 using namespace ABI::Windows::Foundation;
 
                 interface ICanvasDevice;
+                interface ICanvasDrawingSession;
                 interface ICanvasResourceCreator;
                 interface ICanvasResourceCreatorWithDpi;
                 interface ICanvasSwapChain;
@@ -151,6 +152,35 @@ namespace ABI
                     Numerics::Matrix3x2 const* transform,
                     Rect* rect) noexcept;
 
+                namespace Brushes
+                {
+                    interface ICanvasBrush;
+                }
+
+                namespace Text
+                {
+                    interface ICanvasFontFace;
+                }
+
+                //
+                // Exported method to draw a glyph run whose glyphs are already in DirectWrite's layout. This
+                // skips the conversion from CanvasGlyph that CanvasDrawingSession.DrawGlyphRun has to do.
+                // As with DWRITE_GLYPH_RUN, glyphAdvances and glyphOffsets may be null.
+                //
+                WIN2DAPI DrawGlyphRunForICanvasDrawingSession(
+                    ICanvasDrawingSession* drawingSession,
+                    Numerics::Vector2 point,
+                    Text::ICanvasFontFace* fontFace,
+                    float fontSize,
+                    uint32_t glyphCount,
+                    uint16_t const* glyphIndices,
+                    float const* glyphAdvances,
+                    DWRITE_GLYPH_OFFSET const* glyphOffsets,
+                    BOOL isSideways,
+                    uint32_t bidiLevel,
+                    Brushes::ICanvasBrush* brush,
+                    DWRITE_MEASURING_MODE measuringMode) noexcept;
+
                 namespace Effects
                 {
                     interface ICanvasEffect;
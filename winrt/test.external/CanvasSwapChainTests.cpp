@@ -391,6 +391,27 @@ TEST_CLASS(CanvasSwapChainTests)
         swapChain->WaitForVerticalBlank();
     }
 
+    TEST_METHOD(CanvasSwapChain_LowLatency)
+    {
+        auto device = ref new CanvasDevice();
+        auto swapChain = ref new CanvasSwapChain(device, 1, 1, DEFAULT_DPI, DirectXPixelFormat::B8G8R8A8UIntNormalized, 2, CanvasAlphaMode::Premultiplied, CanvasSwapChainOptions::LowLatency);
+
+        Assert::IsTrue((swapChain->Options & CanvasSwapChainOptions::LowLatency) == CanvasSwapChainOptions::LowLatency);
+
+        swapChain->MaximumFrameLatency = 2;
+        Assert::AreEqual(2, swapChain->MaximumFrameLatency);
+
+        // Resizing must keep the swap chain's flags, or DXGI fails the call.
+        swapChain->ResizeBuffers(2, 2);
+
+        swapChain->WaitForNextFrame();
+
+        auto drawingSession = swapChain->CreateDrawingSession(Colors::Black);
+        delete drawingSession;
+
+        swapChain->Present();
+    }
+
     TEST_METHOD(CanvasSwapChain_Constructors)
     {
         auto creator = ref new StubResourceCreatorWithDpi(ref new CanvasDevice());
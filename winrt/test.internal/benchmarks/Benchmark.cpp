@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <lib/utils/LockUtilities.h>
+
+#include "Benchmark.h"
+
+#if WIN2D_ALLOCATION_TRACKING
+
+// The test DLL links winrt.lib directly, so it replaces operator new in the
+// same way as winrt.dll does for allocations to reach the tracker.
+void* operator new(size_t size)
+{
+    AllocationTracker::RecordAllocation(size);
+
+    if (auto p = malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+#endif
+
+
+static uint64_t const SmokeTestIterationCount = 4;
+static uint64_t const MinimumMeasuredIterationCount = 16;
+static double const MinimumMeasuredNanoseconds = 200 * 1000 * 1000.0;
+static uint64_t const MaximumMeasuredIterationCount = 1ull << 26;
+
+
+static LARGE_INTEGER GetPerformanceFrequency()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency;
+}
+
+
+BenchmarkMeasurement::BenchmarkMeasurement(char const* name)
+#if WIN2D_ALLOCATION_TRACKING
+    : m_allocationScope(name)
+#endif
+{
+    UNREFERENCED_PARAMETER(name);
+
+    QueryPerformanceCounter(&m_startTime);
+}
+
+
+uint64_t BenchmarkMeasurement::GetAllocationCount() const
+{
+#if WIN2D_ALLOCATION_TRACKING
+    return m_allocationScope.GetAllocationCount();
+#else
+    return 0;
+#endif
+}
+
+
+bool BenchmarkMeasurement::CanCountAllocations()
+{
+    return WIN2D_ALLOCATION_TRACKING != 0;
+}
+
+
+double BenchmarkMeasurement::GetElapsedNanoseconds() const
+{
+    static auto const frequency = GetPerformanceFrequency();
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    return (now.QuadPart - m_startTime.QuadPart) * 1e9 / frequency.QuadPart;
+}
+
+
+BenchmarkRunner::BenchmarkRunner()
+    : m_isMeasuring(false)
+{
+    wchar_t path[MAX_PATH];
+    auto length = GetEnvironmentVariable(L"WIN2D_BENCHMARK_OUTPUT", path, MAX_PATH);
+
+    if (length > 0 && length < MAX_PATH)
+    {
+        m_outputPath = path;
+        m_isMeasuring = true;
+    }
+}
+
+
+BenchmarkRunner& BenchmarkRunner::GetInstance()
+{
+    static BenchmarkRunner instance;
+    return instance;
+}
+
+
+uint64_t BenchmarkRunner::GetInitialIterationCount() const
+{
+    return m_isMeasuring ? MinimumMeasuredIterationCount : SmokeTestIterationCount;
+}
+
+
+bool BenchmarkRunner::IsLongEnough(uint64_t iterations, double elapsedNanoseconds) const
+{
+    if (!m_isMeasuring)
+        return true;
+
+    return elapsedNanoseconds >= MinimumMeasuredNanoseconds || iterations >= MaximumMeasuredIterationCount;
+}
+
+
+void BenchmarkRunner::Report(BenchmarkResult result)
+{
+    if (!m_isMeasuring)
+        return;
+
+    std::wstringstream message;
+    message << result.Name.c_str() << L": " << result.NanosecondsPerOperation << L" ns/op, ";
+
+    if (std::isnan(result.AllocationsPerOperation))
+        message << L"allocs/op not counted";
+    else
+        message << result.AllocationsPerOperation << L" allocs/op";
+
+    Logger::WriteMessage(message.str().c_str());
+
+    Lock lock(m_mutex);
+
+    // Re-running a benchmark replaces its previous result.
+    auto it = std::find_if(m_results.begin(), m_results.end(), [&] (BenchmarkResult const& r) { return r.Name == result.Name; });
+
+    if (it != m_results.end())
+        *it = std::move(result);
+    else
+        m_results.push_back(std::move(result));
+
+    WriteResults();
+}
+
+
+void BenchmarkRunner::WriteResults()
+{
+    // The file is rewritten after every benchmark, so that it is complete
+    // however the test run ends.
+    std::ofstream file(m_outputPath, std::ios::trunc);
+
+    if (!file)
+        Assert::Fail((L"Unable to write " + m_outputPath).c_str());
+
+    file << "{\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < m_results.size(); ++i)
+    {
+        auto& result = m_results[i];
+
+        file << "    { \"name\": \"" << result.Name << "\""
+             << ", \"iterations\": " << result.Iterations
+             << std::fixed
+             << ", \"nsPerOp\": " << std::setprecision(1) << result.NanosecondsPerOperation
+             << ", \"allocsPerOp\": ";
+
+        if (std::isnan(result.AllocationsPerOperation))
+            file << "null";
+        else
+            file << std::setprecision(2) << result.AllocationsPerOperation;
+
+        file << " }" << (i + 1 < m_results.size() ? "," : "") << "\n";
+    }
+
+    file << "  ]\n}\n";
+}
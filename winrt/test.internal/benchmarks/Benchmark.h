@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+//
+// Headless CPU benchmarks for the hot paths of winrt.lib.
+//
+// These drive the real library code through the same mocks and stubs as the
+// unit tests, so they measure Win2D's own overhead (argument validation,
+// wrapping, bookkeeping, allocations) without any time spent in D2D or the
+// GPU.
+//
+// By default each benchmark only runs a handful of iterations, so that they
+// behave as smoke tests alongside the rest of the suite.  To take real
+// measurements, set WIN2D_BENCHMARK_OUTPUT to the path of a JSON file and run
+// just the benchmark category:
+//
+//    set WIN2D_BENCHMARK_OUTPUT=c:\temp\benchmarks.json
+//    vstest.console winrt.test.internal.dll /TestCaseFilter:TestCategory=Benchmark
+//
+// Each benchmark is then run for long enough to get a stable timing, and the
+// file is rewritten with every result gathered so far:
+//
+//    {
+//      "benchmarks": [
+//        { "name": "CanvasDrawingSession_FillRectangleWithColor", "iterations": 65536, "nsPerOp": 84.2, "allocsPerOp": 0.00 },
+//        ...
+//      ]
+//    }
+//
+// Allocations are counted by the allocation tracker (see
+// AllocationTracking.h), in debug and release builds alike: the measured
+// iterations run inside a tracker scope, so everything allocated on the
+// benchmark's thread is charged to it, including CoTaskMemAlloc'd arrays and
+// boxed property values.  Builds without EnableWin2DAllocationTracking report
+// allocsPerOp as null.
+//
+
+#define BENCHMARK_METHOD(METHOD_NAME)                                           \
+    BEGIN_TEST_METHOD_ATTRIBUTE(METHOD_NAME)                                    \
+        TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")                    \
+    END_TEST_METHOD_ATTRIBUTE()                                                 \
+    TEST_METHOD_EX(METHOD_NAME)
+
+
+struct BenchmarkResult
+{
+    std::string Name;
+    uint64_t Iterations;
+    double NanosecondsPerOperation;
+    double AllocationsPerOperation;
+};
+
+
+class BenchmarkMeasurement
+{
+#if WIN2D_ALLOCATION_TRACKING
+    AllocationTracker::Scope m_allocationScope;
+#endif
+
+    LARGE_INTEGER m_startTime;
+
+public:
+    // Starts timing, and counting allocations made on the current thread.
+    // name must outlive the process, eg. a string literal.
+    explicit BenchmarkMeasurement(char const* name);
+
+    BenchmarkMeasurement(BenchmarkMeasurement const&) = delete;
+    BenchmarkMeasurement& operator=(BenchmarkMeasurement const&) = delete;
+
+    double GetElapsedNanoseconds() const;
+    uint64_t GetAllocationCount() const;
+
+    // False if allocations can't be counted in this build.
+    static bool CanCountAllocations();
+};
+
+
+class BenchmarkRunner
+{
+    bool m_isMeasuring;
+    std::wstring m_outputPath;
+    std::vector<BenchmarkResult> m_results;
+    std::mutex m_mutex;
+
+    BenchmarkRunner();
+
+public:
+    static BenchmarkRunner& GetInstance();
+
+    // When not measuring, benchmarks run a fixed, small number of iterations
+    // and nothing is written.
+    bool IsMeasuring() const { return m_isMeasuring; }
+
+    uint64_t GetInitialIterationCount() const;
+    bool IsLongEnough(uint64_t iterations, double elapsedNanoseconds) const;
+
+    void Report(BenchmarkResult result);
+
+    template<typename FN>
+    BenchmarkResult Run(char const* name, FN&& operation)
+    {
+        // The first call is not measured; it realizes anything that is
+        // created lazily, such as cached brushes or D2D effects.
+        operation();
+
+        auto iterations = GetInitialIterationCount();
+
+        for (;;)
+        {
+            double elapsedNanoseconds;
+            uint64_t allocationCount;
+
+            {
+                BenchmarkMeasurement measurement(name);
+
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    operation();
+                }
+
+                elapsedNanoseconds = measurement.GetElapsedNanoseconds();
+                allocationCount = measurement.GetAllocationCount();
+            }
+
+            if (IsLongEnough(iterations, elapsedNanoseconds))
+            {
+                BenchmarkResult result
+                {
+                    name,
+                    iterations,
+                    elapsedNanoseconds / iterations,
+                    BenchmarkMeasurement::CanCountAllocations()
+                        ? static_cast<double>(allocationCount) / iterations
+                        : std::numeric_limits<double>::quiet_NaN()
+                };
+
+                Report(result);
+
+                return result;
+            }
+
+            iterations *= 2;
+        }
+    }
+
+private:
+    void WriteResults();
+};
+
+
+// name must outlive the process, eg. a string literal.
+template<typename FN>
+BenchmarkResult RunBenchmark(char const* name, FN&& operation)
+{
+    return BenchmarkRunner::GetInstance().Run(name, std::forward<FN>(operation));
+}
@@ -0,0 +1,477 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/drawing/CanvasSpriteBatch.h>
+#include <lib/effects/generated/GaussianBlurEffect.h>
+#include <lib/text/CanvasFontFace.h>
+#include <lib/text/DrawGlyphRunHelper.h>
+
+#include "benchmarks/Benchmark.h"
+#include "mocks/MockD2DSpriteBatch.h"
+#include "mocks/MockDWriteFontFace.h"
+#include "stubs/StubCanvasBrush.h"
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+#include "stubs/StubD2DEffect.h"
+#include "stubs/StubDWriteFontFaceReference.h"
+
+TEST_CLASS(CanvasBenchmarks)
+{
+public:
+
+    //
+    // CanvasDrawingSession primitives
+    //
+
+    struct DrawingSessionFixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<StubD2DDeviceContextWithGetFactory> DeviceContext;
+        ComPtr<CanvasDrawingSession> DS;
+        ComPtr<StubCanvasBrush> Brush;
+
+        DrawingSessionFixture()
+            : Device(Make<StubCanvasDevice>())
+            , DeviceContext(Make<StubD2DDeviceContextWithGetFactory>())
+            , Brush(Make<StubCanvasBrush>())
+        {
+            DS = CanvasDrawingSession::CreateNew(DeviceContext.Get(), std::make_shared<StubCanvasDrawingSessionAdapter>(), Device.Get());
+
+            DeviceContext->CreateSolidColorBrushMethod.AllowAnyCall(
+                [] (D2D1_COLOR_F const*, D2D1_BRUSH_PROPERTIES const*, ID2D1SolidColorBrush** solidColorBrush)
+                {
+                    auto brush = Make<MockD2DSolidColorBrush>();
+                    brush->SetColorMethod.AllowAnyCall();
+                    return brush.CopyTo(solidColorBrush);
+                });
+
+            DeviceContext->FillRectangleMethod.AllowAnyCall();
+            DeviceContext->DrawLineMethod.AllowAnyCall();
+            DeviceContext->FillEllipseMethod.AllowAnyCall();
+
+            DeviceContext->GetDpiMethod.AllowAnyCall(
+                [] (float* dpiX, float* dpiY)
+                {
+                    *dpiX = DEFAULT_DPI * 2;
+                    *dpiY = DEFAULT_DPI * 2;
+                });
+        }
+    };
+
+    BENCHMARK_METHOD(CanvasDrawingSession_FillRectangleWithColor)
+    {
+        DrawingSessionFixture f;
+
+        RunBenchmark("CanvasDrawingSession_FillRectangleWithColor",
+            [&]
+            {
+                ThrowIfFailed(f.DS->FillRectangleWithColor(Rect{ 1, 2, 3, 4 }, Color{ 255, 1, 2, 3 }));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasDrawingSession_FillRectangleWithBrush)
+    {
+        DrawingSessionFixture f;
+
+        RunBenchmark("CanvasDrawingSession_FillRectangleWithBrush",
+            [&]
+            {
+                ThrowIfFailed(f.DS->FillRectangleWithBrush(Rect{ 1, 2, 3, 4 }, f.Brush.Get()));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasDrawingSession_DrawLineWithColor)
+    {
+        DrawingSessionFixture f;
+
+        RunBenchmark("CanvasDrawingSession_DrawLineWithColor",
+            [&]
+            {
+                ThrowIfFailed(f.DS->DrawLineWithColor(Vector2{ 1, 2 }, Vector2{ 3, 4 }, Color{ 255, 1, 2, 3 }));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasDrawingSession_FillCircleWithColor)
+    {
+        DrawingSessionFixture f;
+
+        RunBenchmark("CanvasDrawingSession_FillCircleWithColor",
+            [&]
+            {
+                ThrowIfFailed(f.DS->FillCircleWithColor(Vector2{ 1, 2 }, 3, Color{ 255, 1, 2, 3 }));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasDrawingSession_ConvertDipsToPixels)
+    {
+        DrawingSessionFixture f;
+
+        RunBenchmark("CanvasDrawingSession_ConvertDipsToPixels",
+            [&]
+            {
+                int pixels;
+                ThrowIfFailed(f.DS->ConvertDipsToPixels(123.4f, CanvasDpiRounding::Round, &pixels));
+            });
+    }
+
+    //
+    // CanvasSpriteBatch
+    //
+
+    struct SpriteBatchFixture
+    {
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+        ComPtr<MockD2DSpriteBatch> D2DSpriteBatch;
+        ComPtr<CanvasDrawingSession> DrawingSession;
+        ComPtr<ICanvasDeviceInternal> Device;
+        ComPtr<CanvasBitmap> Bitmap;
+
+        SpriteBatchFixture()
+            : DeviceContext(Make<MockD2DDeviceContext>())
+            , D2DSpriteBatch(Make<MockD2DSpriteBatch>())
+            , DrawingSession(Make<CanvasDrawingSession>(DeviceContext.Get()))
+        {
+            auto d2dBitmap = Make<StubD2DBitmap>(D2D1_BITMAP_OPTIONS_NONE, DEFAULT_DPI);
+            d2dBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 100, 100 }; });
+            d2dBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100, 100 }; });
+
+            Bitmap = CreateStubCanvasBitmap(Make<MockCanvasDevice>().Get(), d2dBitmap.Get());
+
+            DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+            DeviceContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_ALIASED; });
+            DeviceContext->CreateSpriteBatchMethod.AllowAnyCall([=] (ID2D1SpriteBatch** value) { return D2DSpriteBatch.CopyTo(value); });
+            DeviceContext->DrawSpriteBatchMethod.AllowAnyCall();
+
+            D2DSpriteBatch->AddSpritesMethod.AllowAnyCall();
+
+            // Close looks up the CanvasDevice for the context's D2D device.
+            // Holding on to it here means that lookup hits the resource
+            // manager's cache, as it would in an app.
+            auto dxgiAdapter = Make<StubDxgiAdapter>();
+            dxgiAdapter->GetDescMethod.AllowAnyCall(
+                [] (DXGI_ADAPTER_DESC* desc)
+                {
+                    *desc = DXGI_ADAPTER_DESC{};
+                    return S_OK;
+                });
+
+            auto d3dDevice = Make<MockD3D11Device>();
+            d3dDevice->GetAdapterMethod.AllowAnyCall([=] (IDXGIAdapter** adapter) { return dxgiAdapter.CopyTo(adapter); });
+            d3dDevice->GetFeatureLevelMethod.AllowAnyCall([] { return D3D_FEATURE_LEVEL_11_1; });
+
+            auto d2dDevice = Make<MockD2DDevice>(d3dDevice.Get());
+            DeviceContext->GetDeviceMethod.AllowAnyCall([=] (ID2D1Device** device) { return d2dDevice.CopyTo(device); });
+
+            Device = ResourceManager::GetOrCreate<ICanvasDeviceInternal>(d2dDevice.Get());
+        }
+    };
+
+    BENCHMARK_METHOD(CanvasSpriteBatch_Draw100SpritesAndClose)
+    {
+        SpriteBatchFixture f;
+
+        RunBenchmark("CanvasSpriteBatch_Draw100SpritesAndClose",
+            [&]
+            {
+                ComPtr<ICanvasSpriteBatch> spriteBatch;
+                ThrowIfFailed(f.DrawingSession->CreateSpriteBatch(&spriteBatch));
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    ThrowIfFailed(spriteBatch->DrawAtOffset(f.Bitmap.Get(), Vector2{ static_cast<float>(i), 0 }));
+                }
+
+                ThrowIfFailed(As<IClosable>(spriteBatch)->Close());
+            });
+    }
+
+    //
+    // CanvasEffect
+    //
+
+    struct EffectFixture
+    {
+        ComPtr<StubD2DDevice> D2DDevice;
+        ComPtr<StubD2DDeviceContextWithGetFactory> DeviceContext;
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasDrawingSession> DS;
+        ComPtr<IGraphicsEffectSource> Source;
+
+        EffectFixture()
+            : D2DDevice(Make<StubD2DDevice>())
+            , DeviceContext(Make<StubD2DDeviceContextWithGetFactory>())
+        {
+            Device = Make<StubCanvasDevice>(D2DDevice);
+
+            DeviceContext->GetDeviceMethod.AllowAnyCallAlwaysCopyValueToParam(D2DDevice);
+            DeviceContext->GetPrimitiveBlendMethod.AllowAnyCall();
+            DeviceContext->GetDpiMethod.AllowAnyCall(
+                [] (float* dpiX, float* dpiY)
+                {
+                    *dpiX = DEFAULT_DPI;
+                    *dpiY = DEFAULT_DPI;
+                });
+            DeviceContext->GetTargetMethod.AllowAnyCall([] (ID2D1Image** target) { *target = nullptr; });
+            DeviceContext->DrawImageMethod.AllowAnyCall();
+            DeviceContext->CreateEffectMethod.AllowAnyCall(
+                [] (IID const& iid, ID2D1Effect** effect)
+                {
+                    return Make<StubD2DEffect>(iid).CopyTo(effect);
+                });
+
+            DS = CanvasDrawingSession::CreateNew(DeviceContext.Get(), std::make_shared<StubCanvasDrawingSessionAdapter>(), Device.Get());
+
+            Source = As<IGraphicsEffectSource>(CreateStubCanvasBitmap(DEFAULT_DPI, Device.Get()));
+        }
+    };
+
+    BENCHMARK_METHOD(CanvasEffect_CreateRealizeAndDraw)
+    {
+        EffectFixture f;
+
+        RunBenchmark("CanvasEffect_CreateRealizeAndDraw",
+            [&]
+            {
+                auto blur = Make<GaussianBlurEffect>();
+                ThrowIfFailed(blur->put_Source(f.Source.Get()));
+                ThrowIfFailed(f.DS->DrawImageAtOrigin(blur.Get()));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasEffect_RefreshPropertyAndDraw)
+    {
+        EffectFixture f;
+
+        auto blur = Make<GaussianBlurEffect>();
+        ThrowIfFailed(blur->put_Source(f.Source.Get()));
+
+        float blurAmount = 1;
+
+        RunBenchmark("CanvasEffect_RefreshPropertyAndDraw",
+            [&]
+            {
+                // Alternate the value so that every draw has a property to push.
+                blurAmount = 3 - blurAmount;
+                ThrowIfFailed(blur->put_BlurAmount(blurAmount));
+                ThrowIfFailed(f.DS->DrawImageAtOrigin(blur.Get()));
+            });
+    }
+
+    BENCHMARK_METHOD(CanvasEffect_UnchangedDraw)
+    {
+        EffectFixture f;
+
+        auto blur = Make<GaussianBlurEffect>();
+        ThrowIfFailed(blur->put_Source(f.Source.Get()));
+
+        RunBenchmark("CanvasEffect_UnchangedDraw",
+            [&]
+            {
+                ThrowIfFailed(f.DS->DrawImageAtOrigin(blur.Get()));
+            });
+    }
+
+    //
+    // ResourceManager
+    //
+
+    struct ResourceManagerFixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<StubD2DBitmap> D2DBitmap;
+
+        ResourceManagerFixture()
+            : Device(Make<StubCanvasDevice>())
+            , D2DBitmap(Make<StubD2DBitmap>(D2D1_BITMAP_OPTIONS_NONE))
+        {
+            CanvasBitmapAdapter::SetInstance(std::make_shared<TestBitmapAdapter>(Make<MockWICFormatConverter>()));
+        }
+    };
+
+    BENCHMARK_METHOD(ResourceManager_GetOrCreate_ExistingWrapper)
+    {
+        ResourceManagerFixture f;
+
+        auto wrapper = ResourceManager::GetOrCreate<ICanvasBitmap>(f.Device.Get(), f.D2DBitmap.Get());
+
+        RunBenchmark("ResourceManager_GetOrCreate_ExistingWrapper",
+            [&]
+            {
+                ResourceManager::GetOrCreate<ICanvasBitmap>(f.Device.Get(), f.D2DBitmap.Get());
+            });
+    }
+
+    BENCHMARK_METHOD(ResourceManager_GetOrCreate_NewWrapper)
+    {
+        ResourceManagerFixture f;
+
+        RunBenchmark("ResourceManager_GetOrCreate_NewWrapper",
+            [&]
+            {
+                // The wrapper is released straight away, so every call creates a new one.
+                ResourceManager::GetOrCreate<ICanvasBitmap>(f.Device.Get(), f.D2DBitmap.Get());
+            });
+    }
+
+    //
+    // CanvasTextLayout
+    //
+
+    BENCHMARK_METHOD(CanvasTextLayout_CreateNew)
+    {
+        auto adapter = std::make_shared<StubCanvasTextLayoutAdapter>();
+        CustomFontManagerAdapter::SetInstance(adapter);
+
+        auto device = Make<StubCanvasDevice>();
+        auto format = Make<CanvasTextFormat>();
+        WinString text(L"The quick brown fox jumps over the lazy dog");
+
+        RunBenchmark("CanvasTextLayout_CreateNew",
+            [&]
+            {
+                CanvasTextLayout::CreateNew(device.Get(), text, format.Get(), 100.0f, 100.0f);
+            });
+    }
+
+    //
+    // Glyph run marshaling
+    //
+
+    static uint32_t const BenchmarkGlyphCount = 256;
+
+    static std::vector<CanvasGlyph> MakeBenchmarkGlyphs()
+    {
+        std::vector<CanvasGlyph> glyphs;
+
+        for (uint32_t i = 0; i < BenchmarkGlyphCount; ++i)
+        {
+            glyphs.push_back(CanvasGlyph{ static_cast<int>(i * 37), 10.5f, 0.25f, -0.5f });
+        }
+
+        return glyphs;
+    }
+
+    BENCHMARK_METHOD(DrawGlyphRunHelper_DeinterleaveGlyphs)
+    {
+        auto glyphs = MakeBenchmarkGlyphs();
+
+        std::vector<uint16_t> indices(BenchmarkGlyphCount);
+        std::vector<float> advances(BenchmarkGlyphCount);
+        std::vector<DWRITE_GLYPH_OFFSET> offsets(BenchmarkGlyphCount);
+
+        RunBenchmark("DrawGlyphRunHelper_DeinterleaveGlyphs",
+            [&]
+            {
+                DrawGlyphRunHelper::DeinterleaveGlyphs(BenchmarkGlyphCount, glyphs.data(), indices.data(), advances.data(), offsets.data());
+            });
+    }
+
+    // The per-glyph conversion that DrawGlyphRunHelper used to do, kept for
+    // comparison with the DeinterleaveGlyphs benchmark.
+    BENCHMARK_METHOD(DrawGlyphRunHelper_DeinterleaveGlyphs_PerGlyphBaseline)
+    {
+        auto glyphs = MakeBenchmarkGlyphs();
+
+        RunBenchmark("DrawGlyphRunHelper_DeinterleaveGlyphs_PerGlyphBaseline",
+            [&]
+            {
+                std::vector<uint16_t> indices;
+                std::vector<float> advances;
+                std::vector<DWRITE_GLYPH_OFFSET> offsets;
+
+                indices.reserve(BenchmarkGlyphCount);
+                advances.reserve(BenchmarkGlyphCount);
+                offsets.reserve(BenchmarkGlyphCount);
+
+                for (auto& glyph : glyphs)
+                {
+                    indices.push_back(CheckCastAsUShort(glyph.Index));
+                    advances.push_back(glyph.Advance);
+                    offsets.push_back(DWRITE_GLYPH_OFFSET{ glyph.AdvanceOffset, glyph.AscenderOffset });
+                }
+            });
+    }
+
+    BENCHMARK_METHOD(DrawGlyphRunHelper_NarrowClusterMap)
+    {
+        std::vector<int> clusterMapIndices;
+
+        for (uint32_t i = 0; i < BenchmarkGlyphCount; ++i)
+        {
+            clusterMapIndices.push_back(static_cast<int>(i / 2));
+        }
+
+        std::vector<uint16_t> clusterMap(BenchmarkGlyphCount);
+
+        RunBenchmark("DrawGlyphRunHelper_NarrowClusterMap",
+            [&]
+            {
+                DrawGlyphRunHelper::NarrowClusterMap(BenchmarkGlyphCount, clusterMapIndices.data(), clusterMap.data());
+            });
+    }
+
+    struct GlyphRunFixture
+    {
+        ComPtr<StubDWriteFontFaceReference> DWriteFontFaceReference;
+        ComPtr<MockDWriteFontFace> RealizedDWriteFontFace;
+        ComPtr<CanvasFontFace> FontFace;
+        std::vector<CanvasGlyph> Glyphs;
+
+        GlyphRunFixture()
+            : DWriteFontFaceReference(Make<StubDWriteFontFaceReference>())
+            , RealizedDWriteFontFace(Make<MockDWriteFontFace>())
+            , Glyphs(MakeBenchmarkGlyphs())
+        {
+            CustomFontManagerAdapter::SetInstance(std::make_shared<StubCanvasTextLayoutAdapter>());
+
+            FontFace = Make<CanvasFontFace>(DWriteFontFaceReference.Get());
+
+            DWriteFontFaceReference->CreateFontFaceMethod.AllowAnyCall(
+                [=] (IDWriteFontFace3** out)
+                {
+                    return RealizedDWriteFontFace.CopyTo(out);
+                });
+        }
+    };
+
+    BENCHMARK_METHOD(DrawGlyphRunHelper_Create)
+    {
+        GlyphRunFixture f;
+
+        RunBenchmark("DrawGlyphRunHelper_Create",
+            [&]
+            {
+                DrawGlyphRunHelper helper(f.FontFace.Get(), 12.0f, BenchmarkGlyphCount, f.Glyphs.data(), false, 0, CanvasTextMeasuringMode::Natural);
+            });
+    }
+
+    //
+    // Pixel conversions
+    //
+
+    BENCHMARK_METHOD(Conversion_DipsToPixelsAndBack)
+    {
+        std::vector<Rect> rects;
+
+        for (int i = 0; i < 64; ++i)
+        {
+            rects.push_back(Rect{ i * 1.5f, i * 0.25f, 10.0f + i, 20.0f - i * 0.1f });
+        }
+
+        size_t index = 0;
+        volatile float sink = 0;
+
+        RunBenchmark("Conversion_DipsToPixelsAndBack",
+            [&]
+            {
+                auto& rect = rects[index++ % rects.size()];
+
+                auto pixels = ToRECT(rect, DEFAULT_DPI * 1.5f);
+                auto dips = ToRect(pixels, DEFAULT_DPI * 1.5f);
+
+                sink = sink + dips.Width + PixelsToDips(SizeDipsToPixels(rect.Height, DEFAULT_DPI * 1.5f), DEFAULT_DPI * 1.5f);
+            });
+    }
+};
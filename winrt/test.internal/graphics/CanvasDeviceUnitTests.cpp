@@ -4,6 +4,12 @@
 
 #include "pch.h"
 
+#include <lib/drawing/CanvasDeviceWarmUpResult.h>
+#include <lib/effects/shader/PixelShaderEffectImpl.h>
+#include <lib/effects/shader/SharedShaderState.h>
+
+#include "../mocks/MockWICFactory.h"
+
 class Fixture
 {
 public:
@@ -421,6 +427,74 @@ public:
         ThrowIfFailed(canvasDevice->put_MaximumCacheSize(someOtherValue));
     }
 
+    TEST_METHOD_EX(CanvasDevice_IsResourceRecreationEnabled)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_IsResourceRecreationEnabled(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->get_ResourceRecreationMemoryUsage(nullptr));
+
+        // Disabled by default.
+        boolean enabled;
+        uint64_t memoryUsage;
+
+        ThrowIfFailed(canvasDevice->get_IsResourceRecreationEnabled(&enabled));
+        Assert::IsFalse(!!enabled);
+        Assert::IsNull(canvasDevice->GetResourceRecreationRegistry().get());
+
+        ThrowIfFailed(canvasDevice->get_ResourceRecreationMemoryUsage(&memoryUsage));
+        Assert::AreEqual<uint64_t>(0, memoryUsage);
+
+        // Enabling it twice keeps the same registry.
+        ThrowIfFailed(canvasDevice->put_IsResourceRecreationEnabled(true));
+        ThrowIfFailed(canvasDevice->get_IsResourceRecreationEnabled(&enabled));
+        Assert::IsTrue(!!enabled);
+
+        auto registry = canvasDevice->GetResourceRecreationRegistry();
+        Assert::IsNotNull(registry.get());
+
+        ThrowIfFailed(canvasDevice->put_IsResourceRecreationEnabled(true));
+        Assert::IsTrue(registry == canvasDevice->GetResourceRecreationRegistry());
+
+        // Disabling it drops the registry.
+        ThrowIfFailed(canvasDevice->put_IsResourceRecreationEnabled(false));
+        ThrowIfFailed(canvasDevice->get_IsResourceRecreationEnabled(&enabled));
+        Assert::IsFalse(!!enabled);
+        Assert::IsNull(canvasDevice->GetResourceRecreationRegistry().get());
+    }
+
+    TEST_METHOD_EX(CanvasDevice_RecreateResourcesAsync_InvalidArgs)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+        auto lostDevice = Make<StubCanvasDevice>();
+
+        ComPtr<IAsyncAction> action;
+
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->RecreateResourcesAsync(nullptr, &action));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->RecreateResourcesAsync(lostDevice.Get(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasDevice->RecreateResourcesAsync(canvasDevice.Get(), &action));
+    }
+
+    TEST_METHOD_EX(CanvasDevice_RecreateResourcesAsync_EnablesResourceRecreationOnNewDevice)
+    {
+        Fixture f;
+
+        auto canvasDevice = Make<CanvasDevice>(Make<MockD2DDevice>().Get());
+        auto lostDevice = Make<StubCanvasDevice>();
+
+        ComPtr<IAsyncAction> action;
+        ThrowIfFailed(canvasDevice->RecreateResourcesAsync(lostDevice.Get(), &action));
+        Assert::IsNotNull(action.Get());
+
+        boolean enabled;
+        ThrowIfFailed(canvasDevice->get_IsResourceRecreationEnabled(&enabled));
+        Assert::IsTrue(!!enabled);
+    }
+
     TEST_METHOD_EX(CanvasDevice_CreateCommandList_ReturnsCommandListFromDeviceContext)
     {
         auto d2dDevice = Make<MockD2DDevice>();
@@ -1168,3 +1242,166 @@ public:
         f.ValidateEnterLeaveCount(1, 1);
     }
 };
+
+TEST_CLASS(CanvasDeviceWarmUpTests)
+{
+public:
+
+    class WarmUpWicAdapter : public WicAdapter
+    {
+        ComPtr<IWICImagingFactory2> m_factory;
+
+    public:
+        CALL_COUNTER(GetFactoryMethod);
+
+        WarmUpWicAdapter()
+            : m_factory(As<IWICImagingFactory2>(Make<MockWICImagingFactory>()))
+        {
+        }
+
+        virtual ComPtr<IWICImagingFactory2> const& GetFactory() override
+        {
+            GetFactoryMethod.WasCalled();
+            return m_factory;
+        }
+    };
+
+    class Fixture
+    {
+    public:
+        ComPtr<MockD2DFactory> Factory;
+        ComPtr<StubCanvasDevice> Device;
+        std::shared_ptr<WarmUpWicAdapter> ImagingAdapter;
+        int RegisterEffectCount;
+
+        Fixture()
+            : Factory(Make<MockD2DFactory>())
+            , ImagingAdapter(std::make_shared<WarmUpWicAdapter>())
+            , RegisterEffectCount(0)
+        {
+            Device = Make<StubCanvasDevice>(Make<StubD2DDevice>(Factory.Get()));
+
+            WicAdapter::SetInstance(ImagingAdapter);
+
+            Factory->MockGetRegisteredEffects = [](CLSID*, UINT32, UINT32* effectsReturned, UINT32* effectsRegistered)
+            {
+                *effectsReturned = *effectsRegistered = 0;
+                return S_OK;
+            };
+
+            Factory->MockRegisterEffectFromString = [this](REFCLSID classId, PCWSTR, CONST D2D1_PROPERTY_BINDING*, UINT32, CONST PD2D1_EFFECT_FACTORY)
+            {
+                Assert::IsTrue(classId == CLSID_PixelShaderEffect);
+                RegisterEffectCount++;
+                return S_OK;
+            };
+
+            Device->LeaseHistogramEffectMethod.AllowAnyCall(
+                [](ID2D1DeviceContext*)
+                {
+                    return CanvasDevice::HistogramAndAtlasEffects{ Make<MockD2DEffect>(), Make<MockD2DEffect>() };
+                });
+
+            Device->ReleaseHistogramEffectMethod.AllowAnyCall();
+        }
+
+        ComPtr<CanvasDeviceWarmUpResult> WarmUp()
+        {
+            return CanvasDeviceWarmUpResult::WarmUp(
+                [=] { return As<ICanvasDevice>(Device); },
+                std::vector<std::vector<BYTE>>());
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDeviceWarmUp_RunsEachStage)
+    {
+        Fixture f;
+
+        f.Device->LeaseHistogramEffectMethod.SetExpectedCalls(1,
+            [](ID2D1DeviceContext*)
+            {
+                return CanvasDevice::HistogramAndAtlasEffects{ Make<MockD2DEffect>(), Make<MockD2DEffect>() };
+            });
+
+        f.Device->ReleaseHistogramEffectMethod.SetExpectedCalls(1,
+            [](CanvasDevice::HistogramAndAtlasEffects effects)
+            {
+                // The effects are handed back to the device, to be reused
+                // by the next ComputeHistogram call.
+                Assert::IsNotNull(effects.HistogramEffect.Get());
+                Assert::IsNotNull(effects.AtlasEffect.Get());
+            });
+
+        f.ImagingAdapter->GetFactoryMethod.SetExpectedCalls(1);
+
+        auto result = f.WarmUp();
+
+        Assert::AreEqual(1, f.RegisterEffectCount);
+
+        ComPtr<ICanvasDevice> device;
+        ThrowIfFailed(result->get_Device(&device));
+        Assert::IsTrue(IsSameInstance(f.Device.Get(), device.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasDeviceWarmUp_ReportsTimeForEachStage)
+    {
+        Fixture f;
+
+        auto result = f.WarmUp();
+
+        TimeSpan times[6];
+
+        ThrowIfFailed(result->get_DeviceCreationTime(&times[0]));
+        ThrowIfFailed(result->get_EffectRegistrationTime(&times[1]));
+        ThrowIfFailed(result->get_TextFactoryCreationTime(&times[2]));
+        ThrowIfFailed(result->get_ImagingFactoryCreationTime(&times[3]));
+        ThrowIfFailed(result->get_HistogramEffectCreationTime(&times[4]));
+        ThrowIfFailed(result->get_ShaderPreloadTime(&times[5]));
+
+        for (auto& time : times)
+        {
+            Assert::IsTrue(time.Duration >= 0);
+        }
+
+        Assert::AreEqual(E_INVALIDARG, result->get_DeviceCreationTime(nullptr));
+        Assert::AreEqual(E_INVALIDARG, result->get_ShaderPreloadTime(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasDeviceWarmUp_ResultKeepsWarmedUpObjectsAlive)
+    {
+        Fixture f;
+
+        Assert::IsNull(Text::CustomFontManager::TryGetInstance().get());
+        Assert::IsNull(PreloadedShaderCache::TryGetInstance().get());
+
+        auto result = f.WarmUp();
+
+        // Only the result is holding on to these now.
+        Assert::IsNotNull(Text::CustomFontManager::TryGetInstance().get());
+        Assert::IsNotNull(PreloadedShaderCache::TryGetInstance().get());
+
+        f.ImagingAdapter.reset();
+        Assert::IsNotNull(WicAdapter::TryGetInstance().get());
+
+        result.Reset();
+
+        Assert::IsNull(Text::CustomFontManager::TryGetInstance().get());
+        Assert::IsNull(PreloadedShaderCache::TryGetInstance().get());
+        Assert::IsNull(WicAdapter::TryGetInstance().get());
+    }
+
+    TEST_METHOD_EX(CanvasDeviceWarmUp_WhenDeviceCannotBeCreated_Fails)
+    {
+        Fixture f;
+
+        ExpectHResultException(E_FAIL,
+            [&]
+            {
+                CanvasDeviceWarmUpResult::WarmUp(
+                    [] () -> ComPtr<ICanvasDevice> { ThrowHR(E_FAIL); },
+                    std::vector<std::vector<BYTE>>());
+            });
+
+        Assert::AreEqual(0, f.RegisterEffectCount);
+    }
+};
@@ -9,11 +9,13 @@
 #include <lib/images/CanvasCommandList.h>
 #include <lib/svg/CanvasSvgDocument.h>
 #include <lib/drawing/CanvasGradientMesh.h>
+#include <lib/text/CanvasTextCache.h>
 
 #include "stubs/StubInkAdapter.h"
 
 #include "mocks/MockD2DGeometryRealization.h"
 #include "mocks/MockD2DRectangleGeometry.h"
+#include "mocks/MockD2DRoundedRectangleGeometry.h"
 #include "mocks/MockDWriteRenderingParams.h"
 #include "mocks/MockGeometryAdapter.h"
 #include "mocks/MockStream.h"
@@ -4769,6 +4771,312 @@ TEST_CLASS(CanvasDrawingSession_DrawTextTests)
             Color{ 1, 2, 3, 4 },
             f.Format.Get()));
     }
+
+    class TextCacheFixture : public Fixture
+    {
+    public:
+        ComPtr<Text::CanvasTextCache> TextCache;
+
+        TextCacheFixture()
+            : TextCache(Make<Text::CanvasTextCache>(CanvasDevice.Get()))
+        {
+            DeviceContext->GetDeviceMethod.AllowAnyCall(
+                [=](ID2D1Device** device)
+                {
+                    CanvasDevice->GetD2DDevice().CopyTo(device);
+                });
+
+            ThrowIfFailed(DS->put_TextCache(TextCache.Get()));
+        }
+
+        void ExpectDrawnNormally(int numCalls)
+        {
+            DeviceContext->DrawTextWMethod.SetExpectedCalls(numCalls);
+
+            ThrowIfFailed(DS->DrawTextAtPointWithBrushAndFormat(WinString(L"label"), Vector2{ 1, 2 }, Brush.Get(), nullptr));
+
+            Text::CanvasTextCacheStatistics statistics;
+            ThrowIfFailed(TextCache->get_Statistics(&statistics));
+            Assert::AreEqual<int64_t>(0, statistics.HitCount);
+            Assert::AreEqual<int64_t>(0, statistics.MissCount);
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_DefaultsToNull)
+    {
+        Fixture f;
+
+        ComPtr<Text::ICanvasTextCache> textCache;
+        ThrowIfFailed(f.DS->get_TextCache(&textCache));
+        Assert::IsNull(textCache.Get());
+
+        Assert::AreEqual(E_INVALIDARG, f.DS->get_TextCache(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_CanBeSetAndCleared)
+    {
+        TextCacheFixture f;
+
+        ComPtr<Text::ICanvasTextCache> textCache;
+        ThrowIfFailed(f.DS->get_TextCache(&textCache));
+        Assert::IsTrue(IsSameInstance(f.TextCache.Get(), textCache.Get()));
+
+        ThrowIfFailed(f.DS->put_TextCache(nullptr));
+        ThrowIfFailed(f.DS->get_TextCache(&textCache));
+        Assert::IsNull(textCache.Get());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_MustBeFromTheSameDevice)
+    {
+        Fixture f;
+
+        auto otherDevice = Make<StubCanvasDevice>();
+        auto textCache = Make<Text::CanvasTextCache>(otherDevice.Get());
+
+        f.DeviceContext->GetDeviceMethod.AllowAnyCall(
+            [=](ID2D1Device** device)
+            {
+                f.CanvasDevice->GetD2DDevice().CopyTo(device);
+            });
+
+        ExpectHResultException(E_INVALIDARG, [&] { ThrowIfFailed(f.DS->put_TextCache(textCache.Get())); });
+        ValidateStoredErrorState(E_INVALIDARG, Strings::TextCacheDeviceMismatch);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_NonSolidColorBrush_IsDrawnNormally)
+    {
+        TextCacheFixture f;
+
+        f.ExpectDrawnNormally(1);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_ClosedTextCache_Fails)
+    {
+        TextCacheFixture f;
+
+        ThrowIfFailed(f.TextCache->Close());
+
+        Assert::AreEqual(RO_E_CLOSED, f.DS->DrawTextAtPointWithColor(WinString(L"label"), Vector2{ 1, 2 }, ArbitraryMarkerColor1));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_RotatedOrFlippedTransform_IsDrawnNormally)
+    {
+        D2D1_MATRIX_3X2_F transforms[]
+        {
+            D2D1::Matrix3x2F::Rotation(45),
+            D2D1::Matrix3x2F::Scale(-1, 1),
+            D2D1::Matrix3x2F::Scale(1, 2),
+            D2D1::Matrix3x2F::Scale(32, 32),
+        };
+
+        for (auto& transform : transforms)
+        {
+            TextCacheFixture f;
+
+            ThrowIfFailed(f.DS->put_TextAntialiasing(CanvasTextAntialiasing::Grayscale));
+
+            f.DeviceContext->GetTransformMethod.AllowAnyCall(
+                [=](D2D1_MATRIX_3X2_F* value)
+                {
+                    *value = transform;
+                });
+
+            f.DeviceContext->DrawTextWMethod.SetExpectedCalls(1);
+
+            ThrowIfFailed(f.DS->DrawTextAtPointWithColor(WinString(L"label"), Vector2{ 1, 2 }, ArbitraryMarkerColor1));
+        }
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_ClearTypeOrAuto_IsDrawnNormally)
+    {
+        // Auto is usually ClearType on opaque targets, which the cache can't
+        // reproduce.
+        for (auto antialiasing : { CanvasTextAntialiasing::ClearType, CanvasTextAntialiasing::Auto })
+        {
+            TextCacheFixture f;
+
+            ThrowIfFailed(f.DS->put_TextAntialiasing(antialiasing));
+
+            f.DeviceContext->DrawTextWMethod.SetExpectedCalls(1);
+
+            ThrowIfFailed(f.DS->DrawTextAtPointWithColor(WinString(L"label"), Vector2{ 1, 2 }, ArbitraryMarkerColor1));
+        }
+    }
+
+    //
+    // Stands in for CanvasTextCache, so that the drawing session's handling
+    // of the pending batch can be tested without rasterizing any text.
+    //
+    class StubTextCache : public RuntimeClass<
+        Text::ICanvasTextCache,
+        IClosable,
+        ICanvasResourceCreator,
+        CloakedIid<Text::ICanvasTextCacheInternal>>
+    {
+        ComPtr<ID2D1Device1> m_d2dDevice;
+
+    public:
+        bool ShouldDrawFromCache;
+        int DrawCount;
+        int FlushCount;
+
+        StubTextCache(ID2D1Device1* d2dDevice)
+            : m_d2dDevice(d2dDevice)
+            , ShouldDrawFromCache(true)
+            , DrawCount(0)
+            , FlushCount(0)
+        {
+        }
+
+        IFACEMETHODIMP get_MaximumPageCount(int32_t*) override { return E_NOTIMPL; }
+        IFACEMETHODIMP put_MaximumPageCount(int32_t) override { return E_NOTIMPL; }
+        IFACEMETHODIMP get_PageSize(int32_t*) override { return E_NOTIMPL; }
+        IFACEMETHODIMP get_Statistics(Text::CanvasTextCacheStatistics*) override { return E_NOTIMPL; }
+        IFACEMETHODIMP ResetStatistics() override { return E_NOTIMPL; }
+        IFACEMETHODIMP Clear() override { return E_NOTIMPL; }
+        IFACEMETHODIMP Close() override { return S_OK; }
+        IFACEMETHODIMP get_Device(ICanvasDevice**) override { return E_NOTIMPL; }
+
+        virtual ComPtr<ID2D1Device1> GetD2DDevice() override
+        {
+            return m_d2dDevice;
+        }
+
+        virtual bool TryDrawText(
+            Text::CanvasTextCacheBatch* batch,
+            ID2D1DeviceContext1* deviceContext,
+            wchar_t const*,
+            uint32_t,
+            D2D1_RECT_F const&,
+            ID2D1Brush*,
+            IDWriteTextFormat*,
+            uint64_t,
+            D2D1_DRAW_TEXT_OPTIONS) override
+        {
+            if (!ShouldDrawFromCache)
+                return false;
+
+            if (!batch->SpriteBatch)
+            {
+                batch->SpriteBatch = Make<CanvasSpriteBatch>(
+                    As<ID2D1DeviceContext3>(deviceContext),
+                    CanvasSpriteSortMode::None,
+                    D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                    D2D1_SPRITE_OPTIONS_CLAMP_TO_SOURCE_RECTANGLE);
+            }
+
+            DrawCount++;
+            return true;
+        }
+
+        virtual void FlushBatch(Text::CanvasTextCacheBatch* batch) override
+        {
+            // Nothing was added to the sprite batch, so closing it draws nothing.
+            Assert::IsNotNull(batch->SpriteBatch.Get());
+            batch->SpriteBatch.Reset();
+            FlushCount++;
+        }
+    };
+
+    class TextCacheBatchFixture : public Fixture
+    {
+    public:
+        ComPtr<StubTextCache> TextCache;
+
+        TextCacheBatchFixture()
+        {
+            DeviceContext->GetDeviceMethod.AllowAnyCall(
+                [=](ID2D1Device** device)
+                {
+                    CanvasDevice->GetD2DDevice().CopyTo(device);
+                });
+
+            TextCache = Make<StubTextCache>(CanvasDevice->GetD2DDevice().Get());
+            ThrowIfFailed(DS->put_TextCache(TextCache.Get()));
+        }
+
+        void DrawText()
+        {
+            ThrowIfFailed(DS->DrawTextAtPointWithColor(WinString(L"label"), Vector2{ 1, 2 }, ArbitraryMarkerColor1));
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_ConsecutiveCachedDraws_ShareOneBatch_FlushedOnClose)
+    {
+        TextCacheBatchFixture f;
+
+        f.DrawText();
+        f.DrawText();
+        f.DrawText();
+
+        Assert::AreEqual(3, f.TextCache->DrawCount);
+        Assert::AreEqual(0, f.TextCache->FlushCount);
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(1, f.TextCache->FlushCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_BatchIsFlushed_BeforeStateChanges)
+    {
+        TextCacheBatchFixture f;
+
+        f.DrawText();
+        f.DrawText();
+
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(1,
+            [&](D2D1_MATRIX_3X2_F const*)
+            {
+                Assert::AreEqual(1, f.TextCache->FlushCount);
+            });
+
+        ThrowIfFailed(f.DS->put_Transform(Matrix3x2{ 2, 0, 0, 2, 0, 0 }));
+
+        // The next cached draw starts a new batch.
+        f.DrawText();
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual(2, f.TextCache->FlushCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_BatchIsFlushed_BeforeTextThatIsDrawnNormally)
+    {
+        TextCacheBatchFixture f;
+
+        f.DrawText();
+
+        f.TextCache->ShouldDrawFromCache = false;
+
+        f.DeviceContext->DrawTextWMethod.SetExpectedCalls(1,
+            [&](wchar_t const*, uint32_t, IDWriteTextFormat*, D2D1_RECT_F const*, ID2D1Brush*, D2D1_DRAW_TEXT_OPTIONS, DWRITE_MEASURING_MODE)
+            {
+                Assert::AreEqual(1, f.TextCache->FlushCount);
+            });
+
+        f.DrawText();
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_BatchIsFlushed_BeforeTheDeviceContextIsHandedOut)
+    {
+        TextCacheBatchFixture f;
+
+        f.DrawText();
+
+        GetWrappedResource<ID2D1DeviceContext1>(f.DS);
+
+        Assert::AreEqual(1, f.TextCache->FlushCount);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_TextCache_BatchIsFlushed_BeforeTheTextCacheChanges)
+    {
+        TextCacheBatchFixture f;
+
+        f.DrawText();
+
+        ThrowIfFailed(f.DS->put_TextCache(nullptr));
+
+        Assert::AreEqual(1, f.TextCache->FlushCount);
+    }
 };
 
 TEST_CLASS(CanvasDrawingSession_CloseTests)
@@ -4947,6 +5255,8 @@ TEST_CLASS(CanvasDrawingSession_CloseTests)
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_Blend(CanvasBlend::SourceOver));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_TextAntialiasing(nullptr));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_TextAntialiasing(CanvasTextAntialiasing::Auto));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_TextCache(nullptr));
+        EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_TextCache(nullptr));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_Transform(nullptr));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->put_Transform(Numerics::Matrix3x2()));
         EXPECT_OBJECT_CLOSED(canvasDrawingSession->get_Units(nullptr));
@@ -5032,6 +5342,35 @@ TEST_CLASS(CanvasDrawingSession_CreateLayerTests)
         Fixture()
         {
             DeviceContext->GetAntialiasModeMethod.AllowAnyCall();
+
+            DeviceContext->GetTransformMethod.AllowAnyCall(
+                [](D2D1_MATRIX_3X2_F* transform)
+                {
+                    *transform = D2D1::Matrix3x2F::Identity();
+                });
+
+            DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+
+            // No target, so the layers are only bounded by each other.
+            DeviceContext->GetTargetMethod.AllowAnyCall();
+        }
+
+        void SetTarget(D2D1_SIZE_U pixelSize, float dpi)
+        {
+            auto targetBitmap = Make<MockD2DBitmap>();
+            targetBitmap->GetPixelSizeMethod.AllowAnyCall([=] { return pixelSize; });
+
+            DeviceContext->GetTargetMethod.AllowAnyCall(
+                [=](ID2D1Image** target)
+                {
+                    targetBitmap.CopyTo(target);
+                });
+
+            DeviceContext->GetDpiMethod.AllowAnyCall(
+                [=](float* dpiX, float* dpiY)
+                {
+                    *dpiX = *dpiY = dpi;
+                });
         }
 
         void ExpectOnePushLayer(float expectedOpacity, bool expectBrush, Rect const* expectedRect, bool expectGeometry, Matrix3x2 const* expectedTransform, CanvasLayerOptions expectedOptions)
@@ -5314,6 +5653,172 @@ TEST_CLASS(CanvasDrawingSession_CreateLayerTests)
         ThrowIfFailed(As<IClosable>(activeLayer)->Close());
     }
 
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_ClipOnlyRectangleGeometry_UsesAxisAlignedClip)
+    {
+        Fixture f;
+
+        auto d2dGeometry = static_cast<MockD2DRectangleGeometry*>(f.Geometry->GetResource().Get());
+        d2dGeometry->GetRectMethod.SetExpectedCalls(1,
+            [](D2D1_RECT_F* rect)
+            {
+                *rect = D2D1_RECT_F{ 1, 2, 4, 6 };
+            });
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1,
+            [](D2D1_RECT_F const* clipRect, D2D1_ANTIALIAS_MODE)
+            {
+                // The geometry transform is applied to the rectangle.
+                Assert::AreEqual(D2D1_RECT_F{ 12, 14, 18, 22 }, *clipRect);
+            });
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipGeometryAndTransform(1.0f, f.Geometry.Get(), Matrix3x2{ 2, 0, 0, 2, 10, 10 }, &activeLayer));
+
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(1);
+        ThrowIfFailed(As<IClosable>(activeLayer)->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_RoundedRectangleGeometry_BoundsTheLayer)
+    {
+        Fixture f;
+
+        auto d2dGeometry = Make<MockD2DRoundedRectangleGeometry>();
+        d2dGeometry->GetRoundedRectMethod.SetExpectedCalls(1,
+            [](D2D1_ROUNDED_RECT* roundedRect)
+            {
+                *roundedRect = D2D1_ROUNDED_RECT{ D2D1_RECT_F{ 1, 2, 4, 6 }, 1, 1 };
+            });
+
+        f.m_geometryAdapter->CreateRoundedRectangleGeometryMethod.SetExpectedCalls(1,
+            [=](D2D1_ROUNDED_RECT const&)
+            {
+                return d2dGeometry;
+            });
+
+        auto geometry = CanvasGeometry::CreateNew(f.CanvasDevice.Get(), Rect{ 1, 2, 3, 4 }, 1, 1);
+
+        f.DeviceContext->PushLayerMethod.SetExpectedCalls(1,
+            [=](D2D1_LAYER_PARAMETERS1 const* parameters, ID2D1Layer*)
+            {
+                // The corners still need the mask.
+                Assert::IsTrue(IsSameInstance(d2dGeometry.Get(), parameters->geometricMask));
+                Assert::AreEqual(D2D1_RECT_F{ 1, 2, 4, 6 }, parameters->contentBounds);
+            });
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipGeometry(1.0f, geometry.Get(), &activeLayer));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_NestedClipThatContainsItsParent_IsElided)
+    {
+        Fixture f;
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1);
+
+        ComPtr<ICanvasActiveLayer> outerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 10, 10 }, &outerLayer));
+
+        ComPtr<ICanvasActiveLayer> innerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ -5, -5, 100, 100 }, &innerLayer));
+
+        // Only the outer layer was pushed, so only it is popped.
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(1);
+        ThrowIfFailed(As<IClosable>(innerLayer)->Close());
+        ThrowIfFailed(As<IClosable>(outerLayer)->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_NestedClipThatIsSmallerThanItsParent_UsesAxisAlignedClip)
+    {
+        Fixture f;
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(2);
+
+        ComPtr<ICanvasActiveLayer> outerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 10, 10 }, &outerLayer));
+
+        ComPtr<ICanvasActiveLayer> innerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 2, 2, 4, 4 }, &innerLayer));
+
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(2);
+        ThrowIfFailed(As<IClosable>(innerLayer)->Close());
+        ThrowIfFailed(As<IClosable>(outerLayer)->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_WhenClipIsOutsideParent_PushesEmptyClipInsteadOfLayer)
+    {
+        Fixture f;
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1);
+
+        ComPtr<ICanvasActiveLayer> outerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 10, 10 }, &outerLayer));
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1,
+            [](D2D1_RECT_F const* clipRect, D2D1_ANTIALIAS_MODE)
+            {
+                Assert::AreEqual(D2D1_RECT_F{ 0, 0, 0, 0 }, *clipRect);
+            });
+
+        // Not clip-only, so this would otherwise need PushLayer.
+        ComPtr<ICanvasActiveLayer> innerLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(0.5f, Rect{ 20, 20, 5, 5 }, &innerLayer));
+
+        f.DeviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(2);
+        ThrowIfFailed(As<IClosable>(innerLayer)->Close());
+        ThrowIfFailed(As<IClosable>(outerLayer)->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_WhenClipIsOutsideTarget_PushesEmptyClipInsteadOfLayer)
+    {
+        Fixture f;
+
+        f.SetTarget(D2D1_SIZE_U{ 100, 100 }, DEFAULT_DPI * 2);
+
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1,
+            [](D2D1_RECT_F const* clipRect, D2D1_ANTIALIAS_MODE)
+            {
+                Assert::AreEqual(D2D1_RECT_F{ 0, 0, 0, 0 }, *clipRect);
+            });
+
+        // The target is 50x50 DIPs.
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(0.5f, Rect{ 60, 0, 10, 10 }, &activeLayer));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_WhenUnitsArePixels_ComparesAgainstTargetSizeInPixels)
+    {
+        Fixture f;
+
+        f.SetTarget(D2D1_SIZE_U{ 100, 100 }, DEFAULT_DPI * 2);
+        f.DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_PIXELS; });
+
+        // The target is 50x50 DIPs, but 100x100 pixels, so this layer is
+        // visible and must still be pushed.
+        const Rect expectedRect{ 60, 0, 10, 10 };
+        f.ExpectOnePushLayer(0.5f, false, &expectedRect, false, nullptr, CanvasLayerOptions::None);
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(0.5f, expectedRect, &activeLayer));
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_CreateLayer_WhenUnitsArePixels_ClipThatDoesNotContainTheTarget_IsNotElided)
+    {
+        Fixture f;
+
+        f.SetTarget(D2D1_SIZE_U{ 100, 100 }, DEFAULT_DPI * 2);
+        f.DeviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_PIXELS; });
+
+        // This contains the target in DIPs, but not in pixels.
+        f.DeviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1,
+            [](D2D1_RECT_F const* clipRect, D2D1_ANTIALIAS_MODE)
+            {
+                Assert::AreEqual(D2D1_RECT_F{ 0, 0, 60, 60 }, *clipRect);
+            });
+
+        ComPtr<ICanvasActiveLayer> activeLayer;
+        ThrowIfFailed(f.DS->CreateLayerWithOpacityAndClipRectangle(1.0f, Rect{ 0, 0, 60, 60 }, &activeLayer));
+    }
+
     TEST_METHOD_EX(CanvasDrawingSession_get_TextRenderingParameters_CallsThrough)
     {
         Fixture f;
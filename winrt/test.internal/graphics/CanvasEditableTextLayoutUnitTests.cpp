@@ -0,0 +1,515 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/text/CanvasEditableTextLayout.h>
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+static float const c_characterWidth = 5.0f;
+static float const c_paragraphHeight = 10.0f;
+
+TEST_CLASS(CanvasEditableTextLayoutTests)
+{
+    //
+    // Each paragraph layout is one line high, with characters laid out at
+    // fixed widths, so hit testing can be checked by position.
+    //
+    struct Fixture
+    {
+        std::shared_ptr<StubCanvasTextLayoutAdapter> Adapter;
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<ICanvasTextFormat> Format;
+        std::vector<std::wstring> LaidOutText;
+        std::vector<ComPtr<StubTextLayout>> CreatedLayouts;
+        std::vector<std::pair<std::wstring, DWRITE_TEXT_RANGE>> FontWeightRanges;
+
+        Fixture()
+            : Adapter(std::make_shared<StubCanvasTextLayoutAdapter>())
+            , Device(Make<StubCanvasDevice>())
+        {
+            CustomFontManagerAdapter::SetInstance(Adapter);
+
+            Format = Make<CanvasTextFormat>();
+
+            Adapter->GetMockDWriteFactory()->CreateTextLayoutMethod.AllowAnyCall(
+                [=](WCHAR const* text, UINT32 textLength, IDWriteTextFormat*, FLOAT, FLOAT maxHeight, IDWriteTextLayout** textLayout)
+                {
+                    Assert::AreEqual(std::numeric_limits<float>::max(), maxHeight);
+
+                    auto layout = Make<StubTextLayout>();
+                    auto length = textLength;
+
+                    layout->GetMetricsMethod.AllowAnyCall(
+                        [=](DWRITE_TEXT_METRICS1* metrics)
+                        {
+                            *metrics = DWRITE_TEXT_METRICS1{};
+                            metrics->width = length * c_characterWidth;
+                            metrics->height = c_paragraphHeight;
+                            metrics->lineCount = 1;
+                            return S_OK;
+                        });
+
+                    layout->HitTestPointMethod.AllowAnyCall(
+                        [=](FLOAT x, FLOAT y, BOOL* isTrailingHit, BOOL* isInside, DWRITE_HIT_TEST_METRICS* hitTestMetrics)
+                        {
+                            *hitTestMetrics = DWRITE_HIT_TEST_METRICS{};
+                            hitTestMetrics->textPosition = static_cast<UINT32>(x / c_characterWidth);
+                            hitTestMetrics->length = 1;
+                            hitTestMetrics->left = hitTestMetrics->textPosition * c_characterWidth;
+                            hitTestMetrics->width = c_characterWidth;
+                            hitTestMetrics->height = c_paragraphHeight;
+                            *isTrailingHit = FALSE;
+                            *isInside = y >= 0 && y < c_paragraphHeight;
+                            return S_OK;
+                        });
+
+                    layout->HitTestTextPositionMethod.AllowAnyCall(
+                        [=](UINT32 textPosition, BOOL isTrailingHit, FLOAT* x, FLOAT* y, DWRITE_HIT_TEST_METRICS* hitTestMetrics)
+                        {
+                            *hitTestMetrics = DWRITE_HIT_TEST_METRICS{};
+                            *x = (textPosition + (isTrailingHit ? 1 : 0)) * c_characterWidth;
+                            *y = 0;
+                            return S_OK;
+                        });
+
+                    layout->HitTestTextRangeMethod.AllowAnyCall(
+                        [=](UINT32 textPosition, UINT32 textLength, FLOAT, FLOAT, DWRITE_HIT_TEST_METRICS* hitTestMetrics, UINT32 maxCount, UINT32* actualCount)
+                        {
+                            *actualCount = 1;
+
+                            if (maxCount < 1)
+                                return E_NOT_SUFFICIENT_BUFFER;
+
+                            hitTestMetrics[0] = DWRITE_HIT_TEST_METRICS{};
+                            hitTestMetrics[0].textPosition = textPosition;
+                            hitTestMetrics[0].length = textLength;
+                            hitTestMetrics[0].left = textPosition * c_characterWidth;
+                            hitTestMetrics[0].width = textLength * c_characterWidth;
+                            hitTestMetrics[0].height = c_paragraphHeight;
+                            return S_OK;
+                        });
+
+                    auto laidOutText = std::wstring(text, textLength);
+
+                    layout->SetFontWeightMethod.AllowAnyCall(
+                        [=](DWRITE_FONT_WEIGHT, DWRITE_TEXT_RANGE range)
+                        {
+                            FontWeightRanges.push_back(std::make_pair(laidOutText, range));
+                            return S_OK;
+                        });
+
+                    layout->SetMaxWidthMethod.AllowAnyCall();
+                    layout->SetMaxHeightMethod.AllowAnyCall();
+
+                    LaidOutText.push_back(std::wstring(text, textLength));
+                    CreatedLayouts.push_back(layout);
+
+                    return layout.CopyTo(textLayout);
+                });
+        }
+
+        ComPtr<CanvasEditableTextLayout> Create(wchar_t const* text)
+        {
+            return CanvasEditableTextLayout::CreateNew(Device.Get(), WinString(text), Format.Get(), 100.0f);
+        }
+
+        void ReplaceText(CanvasEditableTextLayout* layout, int32_t characterIndex, int32_t characterCount, wchar_t const* newText)
+        {
+            LaidOutText.clear();
+            ThrowIfFailed(layout->ReplaceText(characterIndex, characterCount, WinString(newText)));
+        }
+    };
+
+    static std::wstring GetText(CanvasEditableTextLayout* layout)
+    {
+        WinString text;
+        ThrowIfFailed(layout->get_Text(text.GetAddressOf()));
+        return std::wstring(WindowsGetStringRawBuffer(text, nullptr));
+    }
+
+    static int32_t GetParagraphCount(CanvasEditableTextLayout* layout)
+    {
+        int32_t count;
+        ThrowIfFailed(layout->get_ParagraphCount(&count));
+        return count;
+    }
+
+    static CanvasTextLayoutRegion GetParagraphRegion(CanvasEditableTextLayout* layout, int32_t paragraphIndex)
+    {
+        CanvasTextLayoutRegion region;
+        ThrowIfFailed(layout->GetParagraphRegion(paragraphIndex, &region));
+        return region;
+    }
+
+    static void AssertLaidOut(Fixture const& f, std::vector<std::wstring> const& expected)
+    {
+        Assert::AreEqual(expected.size(), f.LaidOutText.size());
+
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            Assert::AreEqual(expected[i], f.LaidOutText[i]);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_Create_SplitsTextAtParagraphSeparators)
+    {
+        Fixture f;
+
+        auto text = L"a\r\nb\nc\rd\x2029" L"e\x0085" L"f\x2028g";
+        auto layout = f.Create(text);
+
+        AssertLaidOut(f, { L"a", L"b", L"c", L"d", L"e", L"f\x2028g" });
+        Assert::AreEqual(6, GetParagraphCount(layout.Get()));
+        Assert::AreEqual(std::wstring(text), GetText(layout.Get()));
+
+        auto region = GetParagraphRegion(layout.Get(), 1);
+        Assert::AreEqual(3, region.CharacterIndex);
+        Assert::AreEqual(1, region.CharacterCount);
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_Create_TrailingSeparatorIsFollowedByAnEmptyParagraph)
+    {
+        Fixture f;
+
+        auto layout = f.Create(L"a\n");
+
+        AssertLaidOut(f, { L"a", L"" });
+        Assert::AreEqual(2, GetParagraphCount(layout.Get()));
+
+        f.LaidOutText.clear();
+        layout = f.Create(L"");
+
+        AssertLaidOut(f, { L"" });
+        Assert::AreEqual(1, GetParagraphCount(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_WithinAParagraph_OnlyLaysOutThatParagraph)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\nbb\ncc");
+
+        f.ReplaceText(layout.Get(), 4, 0, L"X");
+
+        AssertLaidOut(f, { L"bXb" });
+        Assert::AreEqual(std::wstring(L"aa\nbXb\ncc"), GetText(layout.Get()));
+        Assert::AreEqual(3, GetParagraphCount(layout.Get()));
+
+        f.ReplaceText(layout.Get(), 8, 1, L"");
+
+        AssertLaidOut(f, { L"c" });
+        Assert::AreEqual(std::wstring(L"aa\nbXb\nc"), GetText(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_InsertingASeparator_SplitsTheParagraph)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\nbb\ncc");
+
+        f.ReplaceText(layout.Get(), 4, 0, L"\r\n");
+
+        AssertLaidOut(f, { L"b", L"b" });
+        Assert::AreEqual(std::wstring(L"aa\nb\r\nb\ncc"), GetText(layout.Get()));
+        Assert::AreEqual(4, GetParagraphCount(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_DeletingASeparator_JoinsParagraphs)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\nbb\ncc");
+
+        f.ReplaceText(layout.Get(), 2, 1, L"");
+
+        AssertLaidOut(f, { L"aabb" });
+        Assert::AreEqual(std::wstring(L"aabb\ncc"), GetText(layout.Get()));
+        Assert::AreEqual(2, GetParagraphCount(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_AcrossParagraphs)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\nbb\ncc\ndd");
+
+        f.ReplaceText(layout.Get(), 1, 6, L"X\nY");
+
+        AssertLaidOut(f, { L"aX", L"Yc" });
+        Assert::AreEqual(std::wstring(L"aX\nYc\ndd"), GetText(layout.Get()));
+        Assert::AreEqual(3, GetParagraphCount(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_LineFeedAfterALoneCarriageReturn_BecomesOneSeparator)
+    {
+        Fixture f;
+        auto layout = f.Create(L"a\rb");
+
+        f.ReplaceText(layout.Get(), 2, 0, L"\n");
+
+        AssertLaidOut(f, { L"a", L"b" });
+        Assert::AreEqual(std::wstring(L"a\r\nb"), GetText(layout.Get()));
+        Assert::AreEqual(2, GetParagraphCount(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_AtEndOfText)
+    {
+        Fixture f;
+        auto layout = f.Create(L"a\n");
+
+        f.ReplaceText(layout.Get(), 2, 0, L"b");
+
+        AssertLaidOut(f, { L"b" });
+        Assert::AreEqual(std::wstring(L"a\nb"), GetText(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_InvalidRange_Fails)
+    {
+        Fixture f;
+        auto layout = f.Create(L"abc");
+
+        Assert::AreEqual(E_INVALIDARG, layout->ReplaceText(-1, 0, WinString(L"x")));
+        Assert::AreEqual(E_INVALIDARG, layout->ReplaceText(0, -1, WinString(L"x")));
+        Assert::AreEqual(E_INVALIDARG, layout->ReplaceText(4, 0, WinString(L"x")));
+        Assert::AreEqual(E_INVALIDARG, layout->ReplaceText(2, 2, WinString(L"x")));
+
+        Assert::AreEqual(std::wstring(L"abc"), GetText(layout.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_Metrics_AreCombinedAcrossParagraphs)
+    {
+        Fixture f;
+        auto layout = f.Create(L"a\nbbbb\ncc");
+
+        int32_t lineCount;
+        ThrowIfFailed(layout->get_LineCount(&lineCount));
+        Assert::AreEqual(3, lineCount);
+
+        Rect bounds;
+        ThrowIfFailed(layout->get_LayoutBounds(&bounds));
+        Assert::AreEqual(Rect{ 0, 0, 4 * c_characterWidth, 3 * c_paragraphHeight }, bounds);
+
+        Assert::AreEqual(2 * c_paragraphHeight, GetParagraphRegion(layout.Get(), 2).LayoutBounds.Y);
+
+        f.ReplaceText(layout.Get(), 0, 0, L"z\n");
+
+        ThrowIfFailed(layout->get_LineCount(&lineCount));
+        Assert::AreEqual(4, lineCount);
+
+        auto region = GetParagraphRegion(layout.Get(), 3);
+        Assert::AreEqual(3 * c_paragraphHeight, region.LayoutBounds.Y);
+        Assert::AreEqual(9, region.CharacterIndex);
+
+        int32_t paragraphIndex;
+        ThrowIfFailed(layout->GetParagraphIndex(9, &paragraphIndex));
+        Assert::AreEqual(3, paragraphIndex);
+        ThrowIfFailed(layout->GetParagraphIndex(8, &paragraphIndex));
+        Assert::AreEqual(2, paragraphIndex);
+        ThrowIfFailed(layout->GetParagraphIndex(11, &paragraphIndex));
+        Assert::AreEqual(3, paragraphIndex);
+
+        Assert::AreEqual(E_INVALIDARG, layout->GetParagraphIndex(12, &paragraphIndex));
+        Assert::AreEqual(E_BOUNDS, layout->GetParagraphRegion(4, &region));
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_HitTest_FindsTheParagraphAtThePoint)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\nbb\ncc");
+
+        CanvasTextLayoutRegion region;
+        boolean isTrailing;
+        boolean isHit;
+        ThrowIfFailed(layout->HitTest(Vector2{ c_characterWidth * 1.5f, c_paragraphHeight * 2.5f }, &region, &isTrailing, &isHit));
+
+        Assert::IsTrue(!!isHit);
+        Assert::AreEqual(7, region.CharacterIndex);
+        Assert::AreEqual(2 * c_paragraphHeight, region.LayoutBounds.Y);
+
+        ThrowIfFailed(layout->HitTest(Vector2{ 0, c_paragraphHeight * 10 }, &region, &isTrailing, &isHit));
+
+        Assert::IsFalse(!!isHit);
+        Assert::AreEqual(6, region.CharacterIndex);
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_GetCaretPosition_IsRelativeToTheWholeText)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aa\r\nbb");
+
+        Vector2 position;
+
+        ThrowIfFailed(layout->GetCaretPosition(5, false, &position));
+        Assert::AreEqual(Vector2{ c_characterWidth, c_paragraphHeight }, position);
+
+        // The leading side of the separator is the end of the first paragraph...
+        ThrowIfFailed(layout->GetCaretPosition(2, false, &position));
+        Assert::AreEqual(Vector2{ 2 * c_characterWidth, 0 }, position);
+
+        // ...and the trailing side is the start of the second.
+        ThrowIfFailed(layout->GetCaretPosition(3, true, &position));
+        Assert::AreEqual(Vector2{ 0, c_paragraphHeight }, position);
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_GetCharacterRegions_SpansParagraphs)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aaa\nbbb\nccc");
+
+        ComArray<CanvasTextLayoutRegion> regions;
+        ThrowIfFailed(layout->GetCharacterRegions(1, 6, regions.GetAddressOfSize(), regions.GetAddressOfData()));
+
+        Assert::AreEqual(2u, regions.GetSize());
+
+        Assert::AreEqual(1, regions[0].CharacterIndex);
+        Assert::AreEqual(2, regions[0].CharacterCount);
+        Assert::AreEqual(0.0f, regions[0].LayoutBounds.Y);
+
+        Assert::AreEqual(4, regions[1].CharacterIndex);
+        Assert::AreEqual(3, regions[1].CharacterCount);
+        Assert::AreEqual(c_paragraphHeight, regions[1].LayoutBounds.Y);
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_SetFontWeight_AppliesToEachParagraphAndSurvivesEditsElsewhere)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aaa\nbbb\nccc");
+
+        auto first = f.CreatedLayouts[0];
+        auto second = f.CreatedLayouts[1];
+
+        first->SetFontWeightMethod.SetExpectedCalls(1,
+            [](DWRITE_FONT_WEIGHT, DWRITE_TEXT_RANGE range)
+            {
+                Assert::AreEqual(2u, range.startPosition);
+                Assert::AreEqual(1u, range.length);
+                return S_OK;
+            });
+
+        second->SetFontWeightMethod.SetExpectedCalls(1,
+            [](DWRITE_FONT_WEIGHT, DWRITE_TEXT_RANGE range)
+            {
+                Assert::AreEqual(0u, range.startPosition);
+                Assert::AreEqual(2u, range.length);
+                return S_OK;
+            });
+
+        ThrowIfFailed(layout->SetFontWeight(2, 4, ABI::Windows::UI::Text::FontWeight{ 700 }));
+
+        f.ReplaceText(layout.Get(), 9, 0, L"X");
+
+        AssertLaidOut(f, { L"cXcc" });
+        Assert::AreEqual<size_t>(4, f.CreatedLayouts.size());
+    }
+
+    static void AssertFontWeightRanges(Fixture const& f, std::vector<std::tuple<std::wstring, uint32_t, uint32_t>> const& expected)
+    {
+        Assert::AreEqual(expected.size(), f.FontWeightRanges.size());
+
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            Assert::AreEqual(std::get<0>(expected[i]), f.FontWeightRanges[i].first);
+            Assert::AreEqual(std::get<1>(expected[i]), f.FontWeightRanges[i].second.startPosition);
+            Assert::AreEqual(std::get<2>(expected[i]), f.FontWeightRanges[i].second.length);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_SetsFormattingAgainOnTheEditedParagraph)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aaaa\nbbbb");
+
+        ThrowIfFailed(layout->SetFontWeight(1, 2, ABI::Windows::UI::Text::FontWeight{ 700 }));
+        f.FontWeightRanges.clear();
+
+        // Before the formatted text.
+        f.ReplaceText(layout.Get(), 0, 0, L"XY");
+        AssertFontWeightRanges(f, { std::make_tuple(L"XYaaaa", 3u, 2u) });
+
+        // Where it ends: the new text takes on the formatting.
+        f.FontWeightRanges.clear();
+        f.ReplaceText(layout.Get(), 5, 0, L"Z");
+        AssertFontWeightRanges(f, { std::make_tuple(L"XYaaaZa", 3u, 3u) });
+
+        // Where it starts: the new text doesn't.
+        f.FontWeightRanges.clear();
+        f.ReplaceText(layout.Get(), 3, 0, L"W");
+        AssertFontWeightRanges(f, { std::make_tuple(L"XYaWaaZa", 4u, 3u) });
+
+        // Deleting part of it.
+        f.FontWeightRanges.clear();
+        f.ReplaceText(layout.Get(), 4, 2, L"");
+        AssertFontWeightRanges(f, { std::make_tuple(L"XYaWZa", 4u, 1u) });
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_ReplaceText_SplittingAndJoiningParagraphs_KeepsFormatting)
+    {
+        Fixture f;
+        auto layout = f.Create(L"aaaa\nbbbb");
+
+        ThrowIfFailed(layout->SetFontWeight(1, 2, ABI::Windows::UI::Text::FontWeight{ 700 }));
+        ThrowIfFailed(layout->SetFontWeight(6, 2, ABI::Windows::UI::Text::FontWeight{ 700 }));
+        f.FontWeightRanges.clear();
+
+        f.ReplaceText(layout.Get(), 2, 0, L"\n");
+        AssertFontWeightRanges(f, { std::make_tuple(L"aa", 1u, 1u), std::make_tuple(L"aa", 0u, 1u) });
+
+        f.FontWeightRanges.clear();
+        f.ReplaceText(layout.Get(), 5, 1, L"");
+        AssertFontWeightRanges(f, { std::make_tuple(L"aabbbb", 0u, 1u), std::make_tuple(L"aabbbb", 3u, 2u) });
+    }
+
+    class MockDrawingSession : public MockCanvasDrawingSession
+    {
+    public:
+        CALL_COUNTER_WITH_MOCK(DrawTextLayoutWithColorMethod, HRESULT(ICanvasTextLayout*, Vector2, Color));
+
+        IFACEMETHODIMP DrawTextLayoutWithColor(ICanvasTextLayout* textLayout, Vector2 point, Color color) override
+        {
+            return DrawTextLayoutWithColorMethod.WasCalled(textLayout, point, color);
+        }
+    };
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_DrawRegion_OnlyDrawsVisibleParagraphs)
+    {
+        Fixture f;
+        auto layout = f.Create(L"a\nb\nc\nd\ne");
+
+        auto drawingSession = Make<MockDrawingSession>();
+
+        std::vector<float> drawnAt;
+
+        drawingSession->DrawTextLayoutWithColorMethod.AllowAnyCall(
+            [&](ICanvasTextLayout*, Vector2 point, Color)
+            {
+                Assert::AreEqual(100.0f, point.X);
+                drawnAt.push_back(point.Y);
+                return S_OK;
+            });
+
+        ThrowIfFailed(layout->DrawRegion(drawingSession.Get(), Vector2{ 100, 50 }, Rect{ 0, 65, 100, 20 }, Color{}));
+
+        Assert::AreEqual<size_t>(3, drawnAt.size());
+        Assert::AreEqual(50 + 1 * c_paragraphHeight, drawnAt[0]);
+        Assert::AreEqual(50 + 3 * c_paragraphHeight, drawnAt[2]);
+
+        drawnAt.clear();
+        ThrowIfFailed(layout->Draw(drawingSession.Get(), Vector2{ 100, 50 }, Color{}));
+
+        Assert::AreEqual<size_t>(5, drawnAt.size());
+    }
+
+    TEST_METHOD_EX(CanvasEditableTextLayout_Closed)
+    {
+        Fixture f;
+        auto layout = f.Create(L"a\nb");
+
+        Assert::AreEqual(S_OK, layout->Close());
+
+        int32_t count;
+        Vector2 position;
+        Assert::AreEqual(RO_E_CLOSED, layout->get_ParagraphCount(&count));
+        Assert::AreEqual(RO_E_CLOSED, layout->ReplaceText(0, 0, WinString(L"x")));
+        Assert::AreEqual(RO_E_CLOSED, layout->GetCaretPosition(0, false, &position));
+    }
+};
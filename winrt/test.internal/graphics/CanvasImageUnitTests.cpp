@@ -73,6 +73,198 @@ TEST_CLASS(CanvasImageGetBoundsUnitTests)
     }
 };
 
+TEST_CLASS(CanvasImageGetBoundsForImagesUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<CanvasImageFactory> Factory;
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+
+        Fixture()
+            : Factory(Make<CanvasImageFactory>())
+            , Device(Make<StubCanvasDevice>())
+            , DeviceContext(Make<MockD2DDeviceContext>())
+        {
+            Device->GetResourceCreationDeviceContextMethod.AllowAnyCall(
+                [=]
+                {
+                    return DeviceContextLease(DeviceContext);
+                });
+        }
+    };
+
+    TEST_METHOD_EX(CanvasImage_GetBoundsForImages_InvalidArgs)
+    {
+        Fixture f;
+
+        auto image = As<ICanvasImage>(CreateStubCanvasBitmap());
+        ICanvasImage* images[] = { image.Get() };
+        Matrix3x2 transforms[2]{};
+        ComArray<Rect> result;
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->GetBoundsForImages(nullptr, 1, images, 0, nullptr, result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->GetBoundsForImages(f.Device.Get(), 1, nullptr, 0, nullptr, result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->GetBoundsForImages(f.Device.Get(), 1, images, 2, transforms, result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->GetBoundsForImages(f.Device.Get(), 1, images, 0, nullptr, nullptr, result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->GetBoundsForImages(f.Device.Get(), 1, images, 0, nullptr, result.GetAddressOfSize(), nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasImage_GetBoundsForImages_MeasuresAllImagesWithOneDeviceContext)
+    {
+        Fixture f;
+
+        auto d2dBitmap1 = Make<StubD2DBitmap>();
+        auto d2dBitmap2 = Make<StubD2DBitmap>();
+        auto image1 = As<ICanvasImage>(CreateStubCanvasBitmap(f.Device.Get(), d2dBitmap1.Get()));
+        auto image2 = As<ICanvasImage>(CreateStubCanvasBitmap(f.Device.Get(), d2dBitmap2.Get()));
+
+        // image1 appears twice, but is only realized once.
+        ICanvasImage* images[] = { image1.Get(), image2.Get(), image1.Get() };
+        Matrix3x2 transforms[] = { { 1, 0, 0, 1, 0, 0 }, { 1, 0, 0, 1, 10, 0 }, { 2, 0, 0, 2, 0, 0 } };
+
+        f.Device->GetResourceCreationDeviceContextMethod.SetExpectedCalls(1,
+            [&]
+            {
+                return DeviceContextLease(f.DeviceContext);
+            });
+
+        D2D1_MATRIX_3X2_F originalTransform{ 1, 2, 3, 4, 5, 6 };
+        f.DeviceContext->GetTransformMethod.SetExpectedCalls(1,
+            [=] (D2D1_MATRIX_3X2_F* matrix)
+            {
+                *matrix = originalTransform;
+            });
+
+        std::vector<D2D1_MATRIX_3X2_F> setTransforms;
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(4,
+            [&] (D2D1_MATRIX_3X2_F const* matrix)
+            {
+                setTransforms.push_back(*matrix);
+            });
+
+        int callIndex = 0;
+        f.DeviceContext->GetImageWorldBoundsMethod.SetExpectedCalls(3,
+            [&] (ID2D1Image* image, D2D1_RECT_F* bounds)
+            {
+                Assert::IsTrue(IsSameInstance(callIndex == 1 ? d2dBitmap2.Get() : d2dBitmap1.Get(), image));
+
+                float offset = static_cast<float>(callIndex++);
+                *bounds = D2D1_RECT_F{ offset, offset, offset + 1, offset + 1 };
+                return S_OK;
+            });
+
+        ComArray<Rect> result;
+        ThrowIfFailed(f.Factory->GetBoundsForImages(f.Device.Get(), 3, images, 3, transforms, result.GetAddressOfSize(), result.GetAddressOfData()));
+
+        Assert::AreEqual(3u, result.GetSize());
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            float offset = static_cast<float>(i);
+            Assert::AreEqual(Rect{ offset, offset, 1, 1 }, result[i]);
+            Assert::AreEqual(*ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transforms[i]), setTransforms[i]);
+        }
+
+        // The original transform is restored once, at the end of the batch.
+        Assert::AreEqual(originalTransform, setTransforms.back());
+    }
+
+    TEST_METHOD_EX(CanvasImage_GetBoundsForImages_WithNoImages_ReturnsEmptyArray)
+    {
+        Fixture f;
+
+        f.Device->GetResourceCreationDeviceContextMethod.SetExpectedCalls(0);
+
+        ComArray<Rect> result;
+        ThrowIfFailed(f.Factory->GetBoundsForImages(f.Device.Get(), 0, nullptr, 0, nullptr, result.GetAddressOfSize(), result.GetAddressOfData()));
+
+        Assert::AreEqual(0u, result.GetSize());
+    }
+
+    TEST_METHOD_EX(ImageBoundsCache_HitsOnlyForMatchingGenerationDeviceAndTransform)
+    {
+        ImageBoundsCache cache;
+
+        auto device1 = Make<StubD2DDevice>();
+        auto device2 = Make<StubD2DDevice>();
+        Matrix3x2 identity{ 1, 0, 0, 1, 0, 0 };
+        Matrix3x2 translation{ 1, 0, 0, 1, 5, 0 };
+        Rect bounds{ 1, 2, 3, 4 };
+        Rect result{};
+
+        Assert::IsFalse(cache.TryGetBounds(1, device1.Get(), identity, &result));
+
+        cache.StoreBounds(1, device1.Get(), identity, bounds);
+
+        Assert::IsTrue(cache.TryGetBounds(1, device1.Get(), identity, &result));
+        Assert::AreEqual(bounds, result);
+
+        Assert::IsFalse(cache.TryGetBounds(2, device1.Get(), identity, &result));
+        Assert::IsFalse(cache.TryGetBounds(1, device2.Get(), identity, &result));
+        Assert::IsFalse(cache.TryGetBounds(1, device1.Get(), translation, &result));
+    }
+
+    TEST_METHOD_EX(ImageBoundsCache_EntriesHoldAReferenceToTheirDevice)
+    {
+        ImageBoundsCache cache;
+
+        auto device = Make<StubD2DDevice>();
+        Matrix3x2 identity{ 1, 0, 0, 1, 0, 0 };
+
+        cache.StoreBounds(1, device.Get(), identity, Rect{ 0, 0, 1, 1 });
+
+        // One reference from us, one from the cache.
+        device.Get()->AddRef();
+        Assert::AreEqual(2ul, device.Get()->Release());
+
+        // Entries from an older generation are discarded, along with their reference.
+        cache.StoreBounds(2, device.Get(), identity, Rect{ 0, 0, 1, 1 });
+        cache.StoreBounds(3, Make<StubD2DDevice>().Get(), identity, Rect{ 0, 0, 1, 1 });
+
+        device.Get()->AddRef();
+        Assert::AreEqual(1ul, device.Get()->Release());
+    }
+
+    TEST_METHOD_EX(ImageBoundsCache_StoringANewGenerationDiscardsOlderEntries)
+    {
+        ImageBoundsCache cache;
+
+        auto device = Make<StubD2DDevice>();
+        Matrix3x2 identity{ 1, 0, 0, 1, 0, 0 };
+        Matrix3x2 scale{ 2, 0, 0, 2, 0, 0 };
+        Rect result{};
+
+        cache.StoreBounds(1, device.Get(), identity, Rect{ 0, 0, 1, 1 });
+        cache.StoreBounds(2, device.Get(), scale, Rect{ 0, 0, 2, 2 });
+
+        Assert::IsFalse(cache.TryGetBounds(1, device.Get(), identity, &result));
+        Assert::IsTrue(cache.TryGetBounds(2, device.Get(), scale, &result));
+    }
+
+    TEST_METHOD_EX(ImageBoundsCache_EvictsLeastRecentlyUsedEntry)
+    {
+        ImageBoundsCache cache;
+
+        auto device = Make<StubD2DDevice>();
+        Rect result{};
+
+        auto translation = [] (float x) { return Matrix3x2{ 1, 0, 0, 1, x, 0 }; };
+
+        for (int i = 0; i < 4; ++i)
+            cache.StoreBounds(1, device.Get(), translation(static_cast<float>(i)), Rect{});
+
+        // Touch the oldest entry so that the second one becomes least recently used.
+        Assert::IsTrue(cache.TryGetBounds(1, device.Get(), translation(0), &result));
+
+        cache.StoreBounds(1, device.Get(), translation(4), Rect{});
+
+        Assert::IsTrue(cache.TryGetBounds(1, device.Get(), translation(0), &result));
+        Assert::IsFalse(cache.TryGetBounds(1, device.Get(), translation(1), &result));
+        Assert::IsTrue(cache.TryGetBounds(1, device.Get(), translation(4), &result));
+    }
+};
+
 
 class CanvasImageTestAdapter : public CanvasImageAdapter
 {
@@ -20,7 +20,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         {
             m_canvasDevice = Make<StubCanvasDevice>();
             
-            m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+            m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
             {
                 auto dxgiSwapChain = Make<MockDxgiSwapChain>();
                 dxgiSwapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
@@ -48,13 +48,14 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         const int dpiScale = 2;
 
         f.m_canvasDevice->CreateSwapChainForCompositionMethod.SetExpectedCalls(1, 
-            [=](int32_t widthInPixels, int32_t heightInPixels, DirectXPixelFormat format, int32_t bufferCount, CanvasAlphaMode alphaMode)
+            [=](int32_t widthInPixels, int32_t heightInPixels, DirectXPixelFormat format, int32_t bufferCount, CanvasAlphaMode alphaMode, CanvasSwapChainOptions options)
             {
                 Assert::AreEqual(23 * dpiScale, widthInPixels);
                 Assert::AreEqual(45 * dpiScale, heightInPixels);
                 Assert::AreEqual(PIXEL_FORMAT(B8G8R8A8UIntNormalizedSrgb), format);
                 Assert::AreEqual(4, bufferCount);
                 Assert::AreEqual(CanvasAlphaMode::Ignore, alphaMode);
+                Assert::AreEqual(CanvasSwapChainOptions::None, options);
 
                 auto dxgiSwapChain = Make<MockDxgiSwapChain>();
 
@@ -295,6 +296,8 @@ TEST_CLASS(CanvasSwapChainUnitTests)
             dxgiSwapChain.Get(),
             96.0f);
 
+        dxgiSwapChain->GetDesc1Method.AllowAnyCall();
+
         dxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(1,
             [&](
                 UINT bufferCount,
@@ -343,6 +346,8 @@ TEST_CLASS(CanvasSwapChainUnitTests)
             dxgiSwapChain.Get(),
             96.0f);
 
+        dxgiSwapChain->GetDesc1Method.AllowAnyCall();
+
         dxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(1,
             [&] (
                 UINT bufferCount,
@@ -387,6 +392,8 @@ TEST_CLASS(CanvasSwapChainUnitTests)
             dxgiSwapChain.Get(),
             96.0f);
 
+        dxgiSwapChain->GetDesc1Method.AllowAnyCall();
+
         dxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(1,
             [&](
                 UINT bufferCount,
@@ -532,6 +539,12 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->get_Device(&device));
 
         Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->WaitForVerticalBlank());
+
+        CanvasSwapChainOptions options;
+        Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->get_Options(&options));
+        Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->get_MaximumFrameLatency(&i));
+        Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->put_MaximumFrameLatency(1));
+        Assert::AreEqual(RO_E_CLOSED, canvasSwapChain->WaitForNextFrame());
     }
 
 
@@ -549,6 +562,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         Assert::AreEqual(E_INVALIDARG, canvasSwapChain->get_BufferCount(nullptr));
         Assert::AreEqual(E_INVALIDARG, canvasSwapChain->get_AlphaMode(nullptr));
         Assert::AreEqual(E_INVALIDARG, canvasSwapChain->get_Device(nullptr));
+        Assert::AreEqual(E_INVALIDARG, canvasSwapChain->get_Options(nullptr));
     }
 
     void ResetForPropertyTest(ComPtr<MockDxgiSwapChain>& swapChain)
@@ -575,7 +589,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
 
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -627,7 +641,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         auto swapChain = Make<MockDxgiSwapChain>();
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -660,7 +674,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         auto swapChain = Make<MockDxgiSwapChain>();
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -695,7 +709,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         auto swapChain = Make<MockDxgiSwapChain>();
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -736,7 +750,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         auto swapChain = Make<MockDxgiSwapChain>();
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -774,7 +788,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         auto swapChain = Make<MockDxgiSwapChain>();
         swapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return swapChain;
         });
@@ -807,7 +821,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
     {
         StubDeviceFixture f;
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             auto swapChain = Make<StubDxgiSwapChain>();
 
@@ -840,7 +854,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
 
         const float newDpi = DEFAULT_DPI * dpiScaling;
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([&](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([&](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             auto swapChain = Make<StubDxgiSwapChain>();
 
@@ -903,7 +917,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
             const DirectXPixelFormat originalPixelFormat = PIXEL_FORMAT(R16G16B16A16Float);
             const int originalBufferCount = 7;
 
-            f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+            f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
             {
                 auto swapChain = Make<StubDxgiSwapChain>();
 
@@ -963,7 +977,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
     {
         StubDeviceFixture f;
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             auto swapChain = Make<MockDxgiSwapChain>();
 
@@ -997,7 +1011,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
     {
         StubDeviceFixture f;
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             auto swapChain = Make<MockDxgiSwapChain>();
 
@@ -1099,10 +1113,16 @@ TEST_CLASS(CanvasSwapChainUnitTests)
                 return d2dBitmap.CopyTo(value);
             });
 
-        deviceContext->SetTargetMethod.SetExpectedCalls(1,
+        // The target is set when the session starts, and cleared again when
+        // it ends.
+        int setTargetCount = 0;
+        deviceContext->SetTargetMethod.SetExpectedCalls(2,
             [&] (ID2D1Image* target)
             {
-                Assert::AreEqual<ID2D1Image*>(d2dBitmap.Get(), target);
+                if (setTargetCount++ == 0)
+                    Assert::AreEqual<ID2D1Image*>(d2dBitmap.Get(), target);
+                else
+                    Assert::IsNull(target);
             });
 
         deviceContext->BeginDrawMethod.SetExpectedCalls(1);
@@ -1160,10 +1180,14 @@ TEST_CLASS(CanvasSwapChainUnitTests)
                             return S_OK;
                         });
 
-                    m_deviceContext->SetTargetMethod.SetExpectedCalls(1,
-                        [expectedTargetBitmap](ID2D1Image* target)
+                    auto setTargetCount = std::make_shared<int>(0);
+                    m_deviceContext->SetTargetMethod.SetExpectedCalls(2,
+                        [expectedTargetBitmap, setTargetCount](ID2D1Image* target)
                         {
-                            Assert::AreEqual(static_cast<ID2D1Image*>(expectedTargetBitmap.Get()), target);
+                            if ((*setTargetCount)++ == 0)
+                                Assert::AreEqual(static_cast<ID2D1Image*>(expectedTargetBitmap.Get()), target);
+                            else
+                                Assert::IsNull(target);
                         });
 
                     m_deviceContext->BeginDrawMethod.SetExpectedCalls(1,
@@ -1195,7 +1219,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
 
             m_canvasDevice = Make<StubCanvasDevice>(d2dDevice);
             
-            m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+            m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
             {
                 auto swapChain = Make<StubDxgiSwapChain>(expectedBackBufferSurface);
 
@@ -1269,6 +1293,171 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         Assert::AreEqual(E_NOTIMPL, canvasSwapChain->CreateDrawingSession(Color{0, 0, 0, 0}, &drawingSession));
     }
 
+    //
+    // Drawing sessions keep reusing the swap chain's device context and the
+    // bitmap wrapping its back buffer.
+    //
+    struct ReusedDeviceContextFixture : public StubDeviceFixture
+    {
+        ComPtr<MockDxgiSwapChain> DxgiSwapChain;
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+        ComPtr<CanvasSwapChain> SwapChain;
+        std::vector<ComPtr<MockD2DBitmap>> TargetBitmaps;
+        std::vector<ID2D1Image*> Targets;
+
+        ReusedDeviceContextFixture()
+            : DxgiSwapChain(Make<MockDxgiSwapChain>())
+            , DeviceContext(Make<MockD2DDeviceContext>())
+        {
+            SwapChain = Make<CanvasSwapChain>(
+                m_canvasDevice.Get(),
+                DxgiSwapChain.Get(),
+                DEFAULT_DPI,
+                /* isTransformMatrixSupported */ false);
+
+            DxgiSwapChain->GetDesc1Method.AllowAnyCall(
+                [] (DXGI_SWAP_CHAIN_DESC1* desc)
+                {
+                    *desc = DXGI_SWAP_CHAIN_DESC1{};
+                    desc->Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+                    desc->AlphaMode = DXGI_ALPHA_MODE_PREMULTIPLIED;
+                    return S_OK;
+                });
+
+            DxgiSwapChain->GetBufferMethod.AllowAnyCall(
+                [] (UINT buffer, REFIID riid, void** surface)
+                {
+                    Assert::AreEqual(0U, buffer);
+                    return Make<MockDxgiSurface>().CopyTo(riid, surface);
+                });
+
+            m_canvasDevice->CreateDeviceContextForDrawingSessionMethod.SetExpectedCalls(1,
+                [=]
+                {
+                    return DeviceContext;
+                });
+
+            DeviceContext->CreateBitmapFromDxgiSurfaceMethod.AllowAnyCall(
+                [=] (IDXGISurface*, D2D1_BITMAP_PROPERTIES1 const*, ID2D1Bitmap1** value)
+                {
+                    auto bitmap = Make<MockD2DBitmap>();
+                    TargetBitmaps.push_back(bitmap);
+                    return bitmap.CopyTo(value);
+                });
+
+            DeviceContext->SetTargetMethod.AllowAnyCall(
+                [=] (ID2D1Image* target)
+                {
+                    Targets.push_back(target);
+                });
+
+            DeviceContext->BeginDrawMethod.AllowAnyCall();
+            DeviceContext->EndDrawMethod.AllowAnyCall();
+            DeviceContext->ClearMethod.AllowAnyCall();
+            DeviceContext->SetDpiMethod.AllowAnyCall();
+            DeviceContext->SetTextAntialiasModeMethod.AllowAnyCall();
+            DeviceContext->SetTransformMethod.AllowAnyCall();
+            DeviceContext->SetUnitModeMethod.AllowAnyCall();
+            DeviceContext->SetAntialiasModeMethod.AllowAnyCall();
+            DeviceContext->SetPrimitiveBlendMethod.AllowAnyCall();
+            DeviceContext->SetTextRenderingParamsMethod.AllowAnyCall();
+        }
+
+        void DrawFrame()
+        {
+            ComPtr<ICanvasDrawingSession> drawingSession;
+            ThrowIfFailed(SwapChain->CreateDrawingSession(Color{}, &drawingSession));
+            ThrowIfFailed(As<IClosable>(drawingSession)->Close());
+        }
+    };
+
+    TEST_METHOD_EX(CanvasSwapChain_CreateDrawingSession_ReusesDeviceContext)
+    {
+        ReusedDeviceContextFixture f;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            f.DrawFrame();
+        }
+
+        Assert::AreEqual<size_t>(1, f.TargetBitmaps.size());
+
+        // Each session sets the same target and clears it again when it
+        // ends.  Later sessions also reset the context's state, which clears
+        // the target once more.
+        std::vector<ID2D1Image*> expectedTargets
+        {
+            f.TargetBitmaps[0].Get(), nullptr,
+            nullptr, f.TargetBitmaps[0].Get(), nullptr,
+            nullptr, f.TargetBitmaps[0].Get(), nullptr,
+        };
+        Assert::IsTrue(expectedTargets == f.Targets);
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_WhenDrawingSessionIsClosed_OnlyTheSwapChainKeepsTheTargetBitmap)
+    {
+        ReusedDeviceContextFixture f;
+
+        f.DrawFrame();
+
+        Assert::AreEqual<size_t>(1, f.TargetBitmaps.size());
+        Assert::IsNull(f.Targets.back());
+
+        // The test and the swap chain hold the target bitmap; the device
+        // context doesn't.
+        f.TargetBitmaps[0]->AddRef();
+        Assert::AreEqual(2ul, f.TargetBitmaps[0]->Release());
+
+        ThrowIfFailed(f.SwapChain->Close());
+
+        f.TargetBitmaps[0]->AddRef();
+        Assert::AreEqual(1ul, f.TargetBitmaps[0]->Release());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_ResizeBuffers_AfterDrawingSessionIsClosed_Succeeds)
+    {
+        ReusedDeviceContextFixture f;
+
+        f.DrawFrame();
+
+        f.DxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(1,
+            [&] (UINT, UINT, UINT, DXGI_FORMAT, UINT)
+            {
+                // Nothing but the test may refer to the old back buffer at
+                // this point.
+                Assert::IsNull(f.Targets.back());
+
+                f.TargetBitmaps[0]->AddRef();
+                Assert::AreEqual(1ul, f.TargetBitmaps[0]->Release());
+                return S_OK;
+            });
+
+        ThrowIfFailed(f.SwapChain->ResizeBuffersWithWidthAndHeight(2, 2));
+
+        f.DrawFrame();
+
+        Assert::AreEqual<size_t>(2, f.TargetBitmaps.size());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_ResizeBuffers_WhileDrawingSessionActive_LeavesDeviceContextAlone)
+    {
+        ReusedDeviceContextFixture f;
+
+        ComPtr<ICanvasDrawingSession> drawingSession;
+        ThrowIfFailed(f.SwapChain->CreateDrawingSession(Color{}, &drawingSession));
+
+        auto targetCount = f.Targets.size();
+
+        f.DxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(1,
+            [] (UINT, UINT, UINT, DXGI_FORMAT, UINT)
+            {
+                return DXGI_ERROR_INVALID_CALL;
+            });
+
+        Assert::AreEqual(DXGI_ERROR_INVALID_CALL, f.SwapChain->ResizeBuffersWithWidthAndHeight(2, 2));
+        Assert::AreEqual(targetCount, f.Targets.size());
+    }
+
     TEST_METHOD_EX(CanvasSwapChain_ResizeBuffers_DoesNotMessUpTransform)
     {
         struct TestCase
@@ -1365,7 +1554,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         StubDeviceFixture f;
 
         f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
-            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
             {
                 auto dxgiSwapChain = Make<MockDxgiSwapChain>();
                 dxgiSwapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
@@ -1392,7 +1581,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         StubDeviceFixture f;
 
         f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
-            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
             {
                 auto dxgiSwapChain = Make<MockDxgiSwapChain>();
                 dxgiSwapChain->SetMatrixTransformMethod.SetExpectedCalls(1);
@@ -1431,6 +1620,340 @@ TEST_CLASS(CanvasSwapChainUnitTests)
         Assert::IsTrue(sleepCalled);
     }
 
+    TEST_METHOD_EX(CanvasSwapChain_CreateWithLowLatencyOption_UsesFlipDiscardAndWaitableObject)
+    {
+        MockDxgiFixture f;
+
+        auto dxgiSwapChain = Make<StubDxgiSwapChain>();
+
+        f.DxgiFactory->CreateSwapChainForCompositionMethod.SetExpectedCalls(1,
+            [&] (IUnknown*, const DXGI_SWAP_CHAIN_DESC1* desc, IDXGIOutput*, IDXGISwapChain1** swapChain)
+            {
+                Assert::IsTrue(DXGI_SWAP_EFFECT_FLIP_DISCARD == desc->SwapEffect);
+
+                // The mock factory doesn't implement IDXGIFactory5, so tearing
+                // is treated as unsupported and quietly dropped.
+                Assert::AreEqual(static_cast<UINT>(DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT), desc->Flags);
+
+                return dxgiSwapChain.CopyTo(swapChain);
+            });
+
+        CanvasSwapChain::CreateNew(
+            f.Device.Get(),
+            1.0f,
+            1.0f,
+            DEFAULT_DPI,
+            CanvasSwapChain::DefaultPixelFormat,
+            CanvasSwapChain::DefaultBufferCount,
+            CanvasSwapChain::DefaultCompositionAlphaMode,
+            CanvasSwapChainOptions::LowLatency | CanvasSwapChainOptions::AllowTearing);
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_GetOptions_ReflectsSwapChainFlags)
+    {
+        struct TestCase
+        {
+            UINT Flags;
+            CanvasSwapChainOptions ExpectedOptions;
+        } testCases[]
+        {
+            { 0, CanvasSwapChainOptions::None },
+            { DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT, CanvasSwapChainOptions::LowLatency },
+            { DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING, CanvasSwapChainOptions::AllowTearing },
+            { DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING, CanvasSwapChainOptions::LowLatency | CanvasSwapChainOptions::AllowTearing },
+        };
+
+        for (auto testCase : testCases)
+        {
+            StubDeviceFixture f;
+
+            f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+            {
+                auto swapChain = Make<StubDxgiSwapChain>();
+
+                swapChain->GetDesc1Method.AllowAnyCall(
+                    [=](DXGI_SWAP_CHAIN_DESC1* desc)
+                    {
+                        desc->Flags = testCase.Flags;
+                        return S_OK;
+                    });
+
+                return swapChain;
+            });
+
+            auto canvasSwapChain = f.CreateTestSwapChain();
+
+            CanvasSwapChainOptions options;
+            ThrowIfFailed(canvasSwapChain->get_Options(&options));
+            Assert::AreEqual(testCase.ExpectedOptions, options);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_CreateNew_PassesOptionsToDevice)
+    {
+        StubDeviceFixture f;
+
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.SetExpectedCalls(1,
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions options)
+            {
+                Assert::AreEqual(CanvasSwapChainOptions::LowLatency, options);
+                return Make<StubDxgiSwapChain>();
+            });
+
+        CanvasSwapChain::CreateNew(
+            f.m_canvasDevice.Get(),
+            1.0f,
+            1.0f,
+            DEFAULT_DPI,
+            CanvasSwapChain::DefaultPixelFormat,
+            CanvasSwapChain::DefaultBufferCount,
+            CanvasSwapChain::DefaultCompositionAlphaMode,
+            CanvasSwapChainOptions::LowLatency);
+    }
+
+    struct FrameLatencyFixture : public StubDeviceFixture
+    {
+        ComPtr<StubDxgiSwapChain> DxgiSwapChain;
+        std::shared_ptr<CanvasSwapChainTestAdapter> SwapChainAdapter;
+        HANDLE WaitableObject;
+        ComPtr<CanvasSwapChain> SwapChain;
+
+        FrameLatencyFixture()
+            : DxgiSwapChain(Make<StubDxgiSwapChain>())
+            , SwapChainAdapter(std::make_shared<CanvasSwapChainTestAdapter>())
+            , WaitableObject(CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS))
+        {
+            CanvasSwapChainAdapter::SetInstance(SwapChainAdapter);
+
+            // The CanvasSwapChain takes ownership of the handle.
+            DxgiSwapChain->GetFrameLatencyWaitableObjectMethod.SetExpectedCalls(1,
+                [=]
+                {
+                    return WaitableObject;
+                });
+
+            m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
+                [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+                {
+                    return DxgiSwapChain;
+                });
+
+            SwapChain = CreateTestSwapChain();
+        }
+    };
+
+    TEST_METHOD_EX(CanvasSwapChain_WaitForNextFrame_WaitsOnFrameLatencyWaitableObject)
+    {
+        FrameLatencyFixture f;
+
+        f.m_canvasDevice->GetPrimaryDisplayOutputMethod.SetExpectedCalls(0);
+
+        DWORD expectedTimeout = CanvasSwapChain::FrameLatencyWaitTimeoutInMs;
+
+        int waitCount = 0;
+        f.SwapChainAdapter->m_waitFn =
+            [&](HANDLE handle, DWORD timeoutInMs)
+            {
+                Assert::IsTrue(f.WaitableObject == handle);
+                Assert::AreEqual(expectedTimeout, timeoutInMs);
+                ++waitCount;
+                return static_cast<DWORD>(WAIT_OBJECT_0);
+            };
+
+        // The waitable object is only fetched from the DXGI swap chain once.
+        ThrowIfFailed(f.SwapChain->WaitForNextFrame());
+        ThrowIfFailed(f.SwapChain->WaitForNextFrame());
+
+        Assert::AreEqual(2, waitCount);
+        Assert::IsTrue(f.SwapChain->HasFrameLatencyWaitableObject());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_WaitForNextFrame_CloseWhileWaiting_LeavesTheHandleOpen)
+    {
+        FrameLatencyFixture f;
+
+        f.SwapChainAdapter->m_waitFn =
+            [&](HANDLE handle, DWORD)
+            {
+                ThrowIfFailed(f.SwapChain->Close());
+
+                // The event is still unsignaled, rather than closed.
+                Assert::AreEqual(static_cast<DWORD>(WAIT_TIMEOUT), ::WaitForSingleObjectEx(handle, 0, FALSE));
+                return static_cast<DWORD>(WAIT_OBJECT_0);
+            };
+
+        Assert::AreEqual(S_OK, f.SwapChain->WaitForNextFrame());
+        Assert::AreEqual(RO_E_CLOSED, f.SwapChain->WaitForNextFrame());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_WaitForNextFrame_TimeoutIsNotAnError)
+    {
+        FrameLatencyFixture f;
+
+        f.SwapChainAdapter->m_waitFn =
+            [&](HANDLE, DWORD)
+            {
+                return static_cast<DWORD>(WAIT_TIMEOUT);
+            };
+
+        Assert::AreEqual(S_OK, f.SwapChain->WaitForNextFrame());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_WaitForNextFrame_WaitsForVerticalBlankWithoutWaitableObject)
+    {
+        StubDeviceFixture f;
+
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+            {
+                return Make<StubDxgiSwapChain>();
+            });
+
+        auto mockDxgiOutput = Make<MockDxgiOutput>();
+
+        f.m_canvasDevice->GetPrimaryDisplayOutputMethod.SetExpectedCalls(1,
+            [&]
+            {
+                return mockDxgiOutput;
+            });
+
+        mockDxgiOutput->WaitForVBlankMethod.SetExpectedCalls(1);
+
+        auto canvasSwapChain = f.CreateTestSwapChain();
+
+        Assert::IsFalse(canvasSwapChain->HasFrameLatencyWaitableObject());
+        ThrowIfFailed(canvasSwapChain->WaitForNextFrame());
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_MaximumFrameLatency)
+    {
+        StubDeviceFixture f;
+
+        auto dxgiSwapChain = Make<StubDxgiSwapChain>();
+
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+            {
+                return dxgiSwapChain;
+            });
+
+        auto canvasSwapChain = f.CreateTestSwapChain();
+
+        dxgiSwapChain->SetMaximumFrameLatencyMethod.SetExpectedCalls(1,
+            [](UINT value)
+            {
+                Assert::AreEqual(2u, value);
+                return S_OK;
+            });
+
+        ThrowIfFailed(canvasSwapChain->put_MaximumFrameLatency(2));
+
+        dxgiSwapChain->GetMaximumFrameLatencyMethod.SetExpectedCalls(1,
+            [](UINT* value)
+            {
+                *value = 3;
+                return S_OK;
+            });
+
+        int32_t maximumFrameLatency;
+        ThrowIfFailed(canvasSwapChain->get_MaximumFrameLatency(&maximumFrameLatency));
+        Assert::AreEqual(3, maximumFrameLatency);
+
+        Assert::AreEqual(E_INVALIDARG, canvasSwapChain->put_MaximumFrameLatency(0));
+        Assert::AreEqual(E_INVALIDARG, canvasSwapChain->put_MaximumFrameLatency(DXGI_MAX_SWAP_CHAIN_BUFFERS + 1));
+        Assert::AreEqual(E_INVALIDARG, canvasSwapChain->get_MaximumFrameLatency(nullptr));
+
+        // Swap chains without a waitable object don't support this.
+        dxgiSwapChain->SetMaximumFrameLatencyMethod.SetExpectedCalls(1,
+            [](UINT)
+            {
+                return DXGI_ERROR_INVALID_CALL;
+            });
+
+        Assert::AreEqual(DXGI_ERROR_INVALID_CALL, canvasSwapChain->put_MaximumFrameLatency(1));
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_PresentWithSyncIntervalZero_AllowsTearingIfSwapChainDoes)
+    {
+        for (auto allowTearing : { false, true })
+        {
+            StubDeviceFixture f;
+
+            auto dxgiSwapChain = Make<StubDxgiSwapChain>();
+
+            dxgiSwapChain->GetDesc1Method.AllowAnyCall(
+                [=](DXGI_SWAP_CHAIN_DESC1* desc)
+                {
+                    desc->Flags = allowTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+                    return S_OK;
+                });
+
+            f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
+                [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+                {
+                    return dxgiSwapChain;
+                });
+
+            auto canvasSwapChain = f.CreateTestSwapChain();
+
+            dxgiSwapChain->Present1Method.SetExpectedCalls(1,
+                [=](UINT syncInterval, UINT flags, const DXGI_PRESENT_PARAMETERS*)
+                {
+                    Assert::AreEqual(0u, syncInterval);
+                    Assert::AreEqual(allowTearing ? static_cast<UINT>(DXGI_PRESENT_ALLOW_TEARING) : 0u, flags);
+                    return S_OK;
+                });
+
+            ThrowIfFailed(canvasSwapChain->PresentWithSyncInterval(0));
+
+            // Tearing is never requested when waiting for the vertical blank.
+            dxgiSwapChain->Present1Method.SetExpectedCalls(1,
+                [=](UINT, UINT flags, const DXGI_PRESENT_PARAMETERS*)
+                {
+                    Assert::AreEqual(0u, flags);
+                    return S_OK;
+                });
+
+            ThrowIfFailed(canvasSwapChain->Present());
+        }
+    }
+
+    TEST_METHOD_EX(CanvasSwapChain_ResizeBuffers_KeepsSwapChainFlags)
+    {
+        StubDeviceFixture f;
+
+        UINT const swapChainFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+
+        auto dxgiSwapChain = Make<StubDxgiSwapChain>();
+
+        dxgiSwapChain->GetDesc1Method.AllowAnyCall(
+            [=](DXGI_SWAP_CHAIN_DESC1* desc)
+            {
+                desc->Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+                desc->BufferCount = 2;
+                desc->Flags = swapChainFlags;
+                return S_OK;
+            });
+
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall(
+            [=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
+            {
+                return dxgiSwapChain;
+            });
+
+        auto canvasSwapChain = f.CreateTestSwapChain();
+
+        dxgiSwapChain->ResizeBuffersMethod.SetExpectedCalls(2,
+            [=](UINT, UINT, UINT, DXGI_FORMAT, UINT flags)
+            {
+                Assert::AreEqual(swapChainFlags, flags);
+                return S_OK;
+            });
+
+        ThrowIfFailed(canvasSwapChain->ResizeBuffersWithWidthAndHeight(2, 2));
+        ThrowIfFailed(canvasSwapChain->ResizeBuffersWithAllOptions(3, 3, DEFAULT_DPI, CanvasSwapChain::DefaultPixelFormat, 3));
+    }
+
     static void AssertLockCount(int expectedLockCount, MockD2DFactory* factory)
     {
         Assert::AreEqual(expectedLockCount, factory->GetEnterCount());
@@ -1462,7 +1985,7 @@ TEST_CLASS(CanvasSwapChainUnitTests)
             return S_OK; 
         });
 
-        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+        f.m_canvasDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
         {
             return dxgiSwapChain;
         });
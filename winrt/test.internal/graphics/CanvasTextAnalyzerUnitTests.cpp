@@ -2358,6 +2358,157 @@ TEST_CLASS(CanvasTextAnalyzerTests)
         Assert::IsTrue(!!element.IsRightToLeft);
     }
 
+    TEST_METHOD_EX(CanvasTextAnalyzer_Analyze_BadArg)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        uint32_t breakpointCount;
+        CanvasAnalyzedBreakpoint* breakpoints;
+        uint32_t runCount;
+        CanvasAnalyzedRun* runs;
+
+        auto kinds = CanvasTextAnalysisKinds::All;
+
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->Analyze(kinds, nullptr, nullptr, &breakpoints, &runCount, &runs));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->Analyze(kinds, nullptr, &breakpointCount, nullptr, &runCount, &runs));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->Analyze(kinds, nullptr, &breakpointCount, &breakpoints, nullptr, &runs));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->Analyze(kinds, nullptr, &breakpointCount, &breakpoints, &runCount, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->Analyze(static_cast<CanvasTextAnalysisKinds>(0x10), nullptr, &breakpointCount, &breakpoints, &runCount, &runs));
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_Analyze_OnlyRunsRequestedAnalyses)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        f.TextAnalyzer->AnalyzeScriptMethod.SetExpectedCalls(1);
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(0);
+        f.TextAnalyzer->AnalyzeVerticalGlyphOrientationMethod.SetExpectedCalls(0);
+
+        f.TextAnalyzer->AnalyzeLineBreakpointsMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                std::vector<DWRITE_LINE_BREAKPOINT> dwriteLineBreakpoints(textLength);
+
+                for (uint32_t i = 0; i < textLength; ++i)
+                {
+                    dwriteLineBreakpoints[i] = GetTestBreakpoint(i).DWriteBreakpoint;
+                }
+
+                ThrowIfFailed(sink->SetLineBreakpoints(textPosition, textLength, dwriteLineBreakpoints.data()));
+
+                return S_OK;
+            });
+
+        uint32_t breakpointCount;
+        CanvasAnalyzedBreakpoint* breakpoints;
+        uint32_t runCount;
+        CanvasAnalyzedRun* runs;
+        Assert::AreEqual(S_OK, textAnalyzer->Analyze(
+            CanvasTextAnalysisKinds::Script | CanvasTextAnalysisKinds::Breakpoints,
+            nullptr,
+            &breakpointCount,
+            &breakpoints,
+            &runCount,
+            &runs));
+
+        Assert::AreEqual(static_cast<uint32_t>(f.Text.length()), breakpointCount);
+
+        for (uint32_t i = 0; i < breakpointCount; ++i)
+        {
+            auto expected = GetTestBreakpoint(i).Breakpoint;
+            Assert::AreEqual(expected.BreakBefore, breakpoints[i].BreakBefore);
+            Assert::AreEqual(expected.BreakAfter, breakpoints[i].BreakAfter);
+        }
+
+        // The script analyzer didn't report anything, so the whole text is
+        // one run.
+        Assert::AreEqual(1u, runCount);
+        Assert::AreEqual(0, runs[0].CharacterRange.CharacterIndex);
+        Assert::AreEqual(static_cast<int>(f.Text.length()), runs[0].CharacterRange.CharacterCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_Analyze_MergesRunsFromEachAnalysis)
+    {
+        Fixture f;
+        f.Text = L"abcd";
+        auto textAnalyzer = f.Create();
+
+        f.TextAnalyzer->AnalyzeScriptMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                DWRITE_SCRIPT_ANALYSIS scriptAnalysis{};
+                scriptAnalysis.script = 123;
+                ThrowIfFailed(sink->SetScriptAnalysis(textPosition, textLength, &scriptAnalysis));
+                return S_OK;
+            });
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t, uint32_t, IDWriteTextAnalysisSink* sink)
+            {
+                // Reported out of order, which the merge has to cope with.
+                ThrowIfFailed(sink->SetBidiLevel(1, 3, 1, 1));
+                ThrowIfFailed(sink->SetBidiLevel(0, 1, 0, 0));
+                return S_OK;
+            });
+
+        f.TextAnalyzer->AnalyzeVerticalGlyphOrientationMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t, uint32_t, IDWriteTextAnalysisSink1* sink)
+            {
+                // Two runs with the same value, which should be joined.
+                ThrowIfFailed(sink->SetGlyphOrientation(0, 2, DWRITE_GLYPH_ORIENTATION_ANGLE_0_DEGREES, 0, FALSE, FALSE));
+                ThrowIfFailed(sink->SetGlyphOrientation(2, 2, DWRITE_GLYPH_ORIENTATION_ANGLE_0_DEGREES, 0, FALSE, FALSE));
+                return S_OK;
+            });
+
+        uint32_t breakpointCount;
+        CanvasAnalyzedBreakpoint* breakpoints;
+        uint32_t runCount;
+        CanvasAnalyzedRun* runs;
+        Assert::AreEqual(S_OK, textAnalyzer->Analyze(
+            CanvasTextAnalysisKinds::Script | CanvasTextAnalysisKinds::Bidi | CanvasTextAnalysisKinds::GlyphOrientation,
+            nullptr,
+            &breakpointCount,
+            &breakpoints,
+            &runCount,
+            &runs));
+
+        Assert::AreEqual(0u, breakpointCount);
+        Assert::AreEqual(2u, runCount);
+
+        Assert::AreEqual(0, runs[0].CharacterRange.CharacterIndex);
+        Assert::AreEqual(1, runs[0].CharacterRange.CharacterCount);
+        Assert::AreEqual(123, runs[0].Script.ScriptIdentifier);
+        Assert::AreEqual(0u, runs[0].Bidi.ResolvedLevel);
+
+        Assert::AreEqual(1, runs[1].CharacterRange.CharacterIndex);
+        Assert::AreEqual(3, runs[1].CharacterRange.CharacterCount);
+        Assert::AreEqual(123, runs[1].Script.ScriptIdentifier);
+        Assert::AreEqual(1u, runs[1].Bidi.ResolvedLevel);
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_Analyze_SinkRejectsRunsOutsideTheText)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                Assert::AreEqual(E_INVALIDARG, sink->SetBidiLevel(1, textLength, 0, 0));
+                return S_OK;
+            });
+
+        uint32_t breakpointCount;
+        CanvasAnalyzedBreakpoint* breakpoints;
+        uint32_t runCount;
+        CanvasAnalyzedRun* runs;
+        Assert::AreEqual(S_OK, textAnalyzer->Analyze(CanvasTextAnalysisKinds::Bidi, nullptr, &breakpointCount, &breakpoints, &runCount, &runs));
+        Assert::AreEqual(1u, runCount);
+    }
+
     TEST_METHOD_EX(CanvasTextAnalyzer_GetJustificationOpportunities_InvalidArgs)
     {
         Fixture f;
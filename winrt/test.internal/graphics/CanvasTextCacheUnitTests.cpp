@@ -0,0 +1,308 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/text/CanvasTextCache.h>
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+TEST_CLASS(TextCacheAtlasTests)
+{
+    static TextCacheAtlas::Allocation Allocate(TextCacheAtlas& atlas, uint32_t width, uint32_t height, uint32_t expectedEvictedPage = TextCacheAtlas::NoPage)
+    {
+        TextCacheAtlas::Allocation allocation;
+        uint32_t evictedPage;
+
+        Assert::IsTrue(atlas.Allocate(width, height, &allocation, &evictedPage));
+        Assert::AreEqual(expectedEvictedPage, evictedPage);
+
+        Assert::AreEqual(width, allocation.Rect.right - allocation.Rect.left);
+        Assert::AreEqual(height, allocation.Rect.bottom - allocation.Rect.top);
+
+        return allocation;
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_RectanglesOfSimilarHeightShareAShelf)
+    {
+        TextCacheAtlas atlas(100, 1);
+
+        auto a = Allocate(atlas, 30, 10);
+        auto b = Allocate(atlas, 40, 12);
+
+        Assert::AreEqual(0u, a.Page);
+        Assert::AreEqual(0u, b.Page);
+        Assert::AreEqual(D2D1_RECT_U{ 0, 0, 30, 10 }, a.Rect);
+        Assert::AreEqual(D2D1_RECT_U{ 30, 0, 70, 12 }, b.Rect);
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_MuchTallerRectanglesStartANewShelf)
+    {
+        TextCacheAtlas atlas(100, 1);
+
+        Allocate(atlas, 30, 10);
+        auto b = Allocate(atlas, 30, 40);
+        auto c = Allocate(atlas, 30, 8);
+
+        Assert::AreEqual(D2D1_RECT_U{ 0, 12, 30, 52 }, b.Rect);
+        Assert::AreEqual(D2D1_RECT_U{ 30, 0, 60, 8 }, c.Rect);
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_FullShelfStartsANewShelf)
+    {
+        TextCacheAtlas atlas(100, 1);
+
+        Allocate(atlas, 60, 10);
+        auto b = Allocate(atlas, 60, 10);
+
+        Assert::AreEqual(D2D1_RECT_U{ 0, 12, 60, 22 }, b.Rect);
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_RectanglesLargerThanAPageAreRejected)
+    {
+        TextCacheAtlas atlas(100, 1);
+
+        TextCacheAtlas::Allocation allocation;
+        uint32_t evictedPage;
+
+        Assert::IsFalse(atlas.Allocate(101, 1, &allocation, &evictedPage));
+        Assert::IsFalse(atlas.Allocate(1, 101, &allocation, &evictedPage));
+        Assert::IsFalse(atlas.Allocate(0, 1, &allocation, &evictedPage));
+        Assert::AreEqual(0u, atlas.GetPageCount());
+
+        Allocate(atlas, 100, 100);
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_PagesAreAddedUpToTheMaximum_ThenTheLeastRecentlyUsedIsReused)
+    {
+        TextCacheAtlas atlas(100, 2);
+
+        Assert::AreEqual(0u, Allocate(atlas, 100, 100).Page);
+        Assert::AreEqual(1u, Allocate(atlas, 100, 100).Page);
+        Assert::AreEqual(2u, atlas.GetPageCount());
+
+        // Page 0 is the least recently used...
+        Assert::AreEqual(0u, Allocate(atlas, 100, 100, 0).Page);
+
+        // ...and now page 1 is, unless it is touched.
+        atlas.Touch(1);
+        Assert::AreEqual(0u, Allocate(atlas, 50, 50, 0).Page);
+
+        // The reused page starts out empty.
+        Assert::AreEqual(D2D1_RECT_U{ 50, 0, 100, 50 }, Allocate(atlas, 50, 50).Rect);
+
+        Assert::AreEqual(2u, atlas.GetPageCount());
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_PinnedPagesAreNotEvicted)
+    {
+        TextCacheAtlas atlas(100, 2);
+
+        Allocate(atlas, 100, 100);
+        Allocate(atlas, 100, 100);
+
+        // Page 0 is the least recently used, but is pinned.
+        atlas.Pin(0);
+        Assert::AreEqual(1u, Allocate(atlas, 100, 100, 1).Page);
+
+        // With every page pinned there is nowhere to put new rectangles.
+        atlas.Pin(1);
+
+        TextCacheAtlas::Allocation allocation;
+        uint32_t evictedPage;
+        Assert::IsFalse(atlas.Allocate(100, 100, &allocation, &evictedPage));
+
+        // Pins nest.
+        atlas.Pin(0);
+        atlas.Unpin(0);
+        Assert::IsFalse(atlas.Allocate(100, 100, &allocation, &evictedPage));
+
+        atlas.Unpin(0);
+        Assert::AreEqual(0u, Allocate(atlas, 100, 100, 0).Page);
+    }
+
+    TEST_METHOD_EX(TextCacheAtlas_ReducingTheMaximumPageCountBelowThePageCountClears)
+    {
+        TextCacheAtlas atlas(100, 3);
+
+        Allocate(atlas, 100, 100);
+        Allocate(atlas, 100, 100);
+
+        Assert::IsFalse(atlas.SetMaximumPageCount(2));
+        Assert::AreEqual(2u, atlas.GetPageCount());
+
+        Assert::IsTrue(atlas.SetMaximumPageCount(1));
+        Assert::AreEqual(0u, atlas.GetPageCount());
+        Assert::AreEqual(1u, atlas.GetMaximumPageCount());
+    }
+};
+
+TEST_CLASS(CanvasTextCacheTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasTextCache> TextCache;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , TextCache(Make<CanvasTextCache>(Device.Get()))
+        {
+        }
+    };
+
+    TEST_METHOD_EX(CanvasTextCache_Implements_ExpectedInterfaces)
+    {
+        Fixture f;
+
+        ASSERT_IMPLEMENTS_INTERFACE(f.TextCache, ICanvasTextCache);
+        ASSERT_IMPLEMENTS_INTERFACE(f.TextCache, ABI::Windows::Foundation::IClosable);
+        ASSERT_IMPLEMENTS_INTERFACE(f.TextCache, ICanvasResourceCreator);
+        ASSERT_IMPLEMENTS_INTERFACE(f.TextCache, ICanvasTextCacheInternal);
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_Factory_NullArgs)
+    {
+        auto factory = Make<CanvasTextCacheFactory>();
+        auto device = Make<StubCanvasDevice>();
+
+        ComPtr<ICanvasTextCache> textCache;
+        Assert::AreEqual(E_INVALIDARG, factory->Create(nullptr, &textCache));
+        Assert::AreEqual(E_INVALIDARG, factory->Create(device.Get(), nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_Factory_UsesTheResourceCreatorsDevice)
+    {
+        auto factory = Make<CanvasTextCacheFactory>();
+        auto device = Make<StubCanvasDevice>();
+
+        ComPtr<ICanvasTextCache> textCache;
+        ThrowIfFailed(factory->Create(device.Get(), &textCache));
+
+        ComPtr<ICanvasDevice> actualDevice;
+        ThrowIfFailed(As<ICanvasResourceCreator>(textCache)->get_Device(&actualDevice));
+        Assert::IsTrue(IsSameInstance(device.Get(), actualDevice.Get()));
+
+        Assert::IsTrue(IsSameInstance(device->GetD2DDevice().Get(), As<ICanvasTextCacheInternal>(textCache)->GetD2DDevice().Get()));
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_DefaultProperties)
+    {
+        Fixture f;
+
+        int32_t value;
+        ThrowIfFailed(f.TextCache->get_MaximumPageCount(&value));
+        Assert::AreEqual(static_cast<int32_t>(CanvasTextCache::DefaultMaximumPageCount), value);
+
+        ThrowIfFailed(f.TextCache->get_PageSize(&value));
+        Assert::AreEqual(static_cast<int32_t>(CanvasTextCache::PageSize), value);
+
+        CanvasTextCacheStatistics statistics;
+        ThrowIfFailed(f.TextCache->get_Statistics(&statistics));
+        Assert::AreEqual<int64_t>(0, statistics.HitCount);
+        Assert::AreEqual<int64_t>(0, statistics.MissCount);
+        Assert::AreEqual<int64_t>(0, statistics.EvictionCount);
+        Assert::AreEqual(0, statistics.EntryCount);
+        Assert::AreEqual(0, statistics.PageCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_MaximumPageCount_MustBePositive)
+    {
+        Fixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->put_MaximumPageCount(0));
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->put_MaximumPageCount(-1));
+
+        ThrowIfFailed(f.TextCache->put_MaximumPageCount(16));
+
+        int32_t value;
+        ThrowIfFailed(f.TextCache->get_MaximumPageCount(&value));
+        Assert::AreEqual(16, value);
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_NullArgs)
+    {
+        Fixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->get_MaximumPageCount(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->get_PageSize(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->get_Statistics(nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.TextCache->get_Device(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_Closed)
+    {
+        Fixture f;
+
+        Assert::AreEqual(S_OK, f.TextCache->Close());
+        Assert::AreEqual(S_OK, f.TextCache->Close());
+
+        int32_t value;
+        CanvasTextCacheStatistics statistics;
+        ComPtr<ICanvasDevice> device;
+
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->get_MaximumPageCount(&value));
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->put_MaximumPageCount(1));
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->get_Statistics(&statistics));
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->ResetStatistics());
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->Clear());
+        Assert::AreEqual(RO_E_CLOSED, f.TextCache->get_Device(&device));
+
+        ExpectHResultException(RO_E_CLOSED, [&] { f.TextCache->GetD2DDevice(); });
+    }
+
+    TEST_METHOD_EX(CanvasTextCache_GetRasterScale_RoundsToQuarterPowersOfTwo)
+    {
+        Assert::AreEqual(1.0f, CanvasTextCache::GetRasterScale(1.0f));
+        Assert::AreEqual(1.0f, CanvasTextCache::GetRasterScale(1.05f));
+        Assert::AreEqual(2.0f, CanvasTextCache::GetRasterScale(2.0f));
+        Assert::AreEqual(0.5f, CanvasTextCache::GetRasterScale(0.52f));
+        Assert::AreEqual(std::exp2(0.25f), CanvasTextCache::GetRasterScale(1.2f));
+        Assert::AreEqual(std::exp2(-0.25f), CanvasTextCache::GetRasterScale(0.84f));
+    }
+
+    static CanvasTextCacheKey MakeKey()
+    {
+        CanvasTextCacheKey key;
+        key.Text = L"label";
+        key.FormatGeneration = 1;
+        key.WordWrapping = DWRITE_WORD_WRAPPING_NO_WRAP;
+        key.LayoutWidth = 0;
+        key.LayoutHeight = 0;
+        key.Options = D2D1_DRAW_TEXT_OPTIONS_NONE;
+        key.AntialiasMode = D2D1_TEXT_ANTIALIAS_MODE_DEFAULT;
+        key.RasterScale = 1;
+        key.Color = D2D1_COLOR_F{ 0, 0, 0, 0 };
+        return key;
+    }
+
+    TEST_METHOD_EX(CanvasTextCacheKey_EveryFieldParticipatesInEquality)
+    {
+        std::vector<std::function<void(CanvasTextCacheKey*)>> changes
+        {
+            [](CanvasTextCacheKey* k) { k->Text = L"Label"; },
+            [](CanvasTextCacheKey* k) { k->FormatGeneration = 2; },
+            [](CanvasTextCacheKey* k) { k->WordWrapping = DWRITE_WORD_WRAPPING_WRAP; },
+            [](CanvasTextCacheKey* k) { k->LayoutWidth = 10; },
+            [](CanvasTextCacheKey* k) { k->LayoutHeight = 10; },
+            [](CanvasTextCacheKey* k) { k->Options = D2D1_DRAW_TEXT_OPTIONS_CLIP; },
+            [](CanvasTextCacheKey* k) { k->AntialiasMode = D2D1_TEXT_ANTIALIAS_MODE_ALIASED; },
+            [](CanvasTextCacheKey* k) { k->RasterScale = 2; },
+            [](CanvasTextCacheKey* k) { k->Color.g = 1; },
+        };
+
+        CanvasTextCacheKeyHash hash;
+
+        Assert::IsTrue(MakeKey() == MakeKey());
+        Assert::AreEqual(hash(MakeKey()), hash(MakeKey()));
+
+        for (auto& change : changes)
+        {
+            auto key = MakeKey();
+            change(&key);
+
+            Assert::IsFalse(key == MakeKey());
+        }
+    }
+};
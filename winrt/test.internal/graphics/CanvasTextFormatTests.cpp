@@ -234,6 +234,40 @@ namespace canvas
             ASSERT_IMPLEMENTS_INTERFACE(ctf, ICanvasResourceWrapperNative);
         }
 
+        TEST_METHOD_EX(CanvasTextFormat_Generation_ChangesWhenTheFormatMayHaveChanged)
+        {
+            auto ctf1 = Make<CanvasTextFormat>();
+            auto ctf2 = Make<CanvasTextFormat>();
+
+            Assert::AreNotEqual(ctf1->GetGeneration(), ctf2->GetGeneration());
+
+            auto generation = ctf1->GetGeneration();
+
+            // Reading properties, or realizing the format, doesn't change it.
+            float fontSize;
+            ThrowIfFailed(ctf1->get_FontSize(&fontSize));
+            ctf1->GetRealizedTextFormat();
+            Assert::AreEqual(generation, ctf1->GetGeneration());
+
+            // Setters do.
+            ThrowIfFailed(ctf1->put_FontSize(fontSize + 1));
+            Assert::AreNotEqual(generation, ctf1->GetGeneration());
+            generation = ctf1->GetGeneration();
+
+            ThrowIfFailed(ctf1->put_FontFamily(WinString(L"Ariel")));
+            Assert::AreNotEqual(generation, ctf1->GetGeneration());
+            generation = ctf1->GetGeneration();
+
+            ThrowIfFailed(ctf1->put_Options(CanvasDrawTextOptions::Clip));
+            Assert::AreNotEqual(generation, ctf1->GetGeneration());
+            generation = ctf1->GetGeneration();
+
+            // Handing out the DWrite format does too, since it can then be
+            // modified directly.
+            GetWrappedResource<IDWriteTextFormat>(ctf1);
+            Assert::AreNotEqual(generation, ctf1->GetGeneration());
+        }
+
         TEST_METHOD_EX(CanvasTextFormat_Direction_DefaultValue)
         {
             auto ctf = Make<CanvasTextFormat>();
@@ -1229,6 +1263,111 @@ namespace canvas
             ValidateStoredErrorState(E_INVALIDARG, Strings::InvalidFontFamilyUri);
         }
 
+        static ComPtr<IDWriteFontCollection> GetRealizedFontCollection(ComPtr<CanvasTextFormat> const& format)
+        {
+            ComPtr<IDWriteFontCollection> fontCollection;
+            ThrowIfFailed(format->GetRealizedTextFormat()->GetFontCollection(&fontCollection));
+            return fontCollection;
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_CustomFontCollectionIsSharedBetweenTextFormats)
+        {
+            CustomFontFixture f;
+
+            f.ExpectCreateCustomFontCollection(f.AnyPath);
+
+            auto cf1 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf1->put_FontFamily(f.AnyFullFontFamilyName));
+            auto fc1 = GetRealizedFontCollection(cf1);
+
+            f.DontExpectCreateCustomFontCollection();
+            f.Adapter->StorageFileStatics->GetFileFromApplicationUriAsyncMethod.SetExpectedCalls(0);
+
+            auto cf2 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf2->put_FontFamily(f.AnyFullFontFamilyName));
+            auto fc2 = GetRealizedFontCollection(cf2);
+
+            Assert::IsTrue(IsSameInstance(fc1.Get(), fc2.Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_CustomFontCollectionIsSharedBetweenUrisForTheSameFile)
+        {
+            CustomFontFixture f;
+
+            f.ExpectCreateCustomFontCollection(f.AnyPath);
+
+            auto cf1 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf1->put_FontFamily(f.AnyFullFontFamilyName));
+            auto fc1 = GetRealizedFontCollection(cf1);
+
+            f.DontExpectCreateCustomFontCollection();
+
+            auto cf2 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf2->put_FontFamily(WinString(L"ms-appx:///any_uri#any_font_family")));
+            auto fc2 = GetRealizedFontCollection(cf2);
+
+            Assert::IsTrue(IsSameInstance(fc1.Get(), fc2.Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_WhenCustomFontCollectionFailsToLoad_FailureIsNotCached)
+        {
+            CustomFontFixture f;
+
+            f.DontExpectCreateCustomFontCollection();
+            f.Adapter->StorageFileStatics->GetFileFromApplicationUriAsyncMethod.SetExpectedCalls(1,
+                [] (IUriRuntimeClass*, IAsyncOperation<StorageFile*>**)
+                {
+                    return E_INVALIDARG;
+                });
+
+            auto cf1 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf1->put_FontFamily(f.AnyFullFontFamilyName));
+            ExpectHResultException(E_INVALIDARG, [&] { cf1->GetRealizedTextFormat(); });
+
+            f.Adapter->StorageFileStatics = Make<StubStorageFileStatics>();
+            auto expectedCollection = f.ExpectCreateCustomFontCollection(f.AnyPath);
+
+            auto cf2 = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf2->put_FontFamily(f.AnyFullFontFamilyName));
+            Assert::IsTrue(IsSameInstance(expectedCollection.Get(), GetRealizedFontCollection(cf2).Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_PrewarmedFontCollectionsAreUsedByTextFormats)
+        {
+            CustomFontFixture f;
+
+            auto customFontManager = CustomFontManager::GetInstance();
+
+            auto expectedCollection = f.ExpectCreateCustomFontCollection(f.AnyPath);
+            customFontManager->PrewarmFontCollections({ WinString(L"any_uri") });
+
+            f.DontExpectCreateCustomFontCollection();
+
+            auto cf = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf->put_FontFamily(f.AnyFullFontFamilyName));
+            Assert::IsTrue(IsSameInstance(expectedCollection.Get(), GetRealizedFontCollection(cf).Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_PrewarmFontCollections_TriesEveryUriAndReportsFirstFailure)
+        {
+            CustomFontFixture f;
+
+            auto customFontManager = CustomFontManager::GetInstance();
+
+            int callCount = 0;
+            f.Adapter->StorageFileStatics->GetFileFromApplicationUriAsyncMethod.SetExpectedCalls(2,
+                [&] (IUriRuntimeClass*, IAsyncOperation<StorageFile*>**)
+                {
+                    return (callCount++ == 0) ? E_INVALIDARG : E_ACCESSDENIED;
+                });
+
+            ExpectHResultException(E_INVALIDARG,
+                [&]
+                {
+                    customFontManager->PrewarmFontCollections({ WinString(L"any_uri"), WinString(L"any_other_uri") });
+                });
+        }
+
         TEST_METHOD_EX(CanvasTextFormat_PutFontFamily_ValidatesUriSchema)
         {
             auto cf = Make<CanvasTextFormat>();
@@ -1309,6 +1448,21 @@ namespace canvas
             Assert::AreEqual(E_INVALIDARG, factory->GetSystemFontFamiliesFromLocaleList(GetVectorView(localeList).Get(), nullptr, &element));
         }
 
+        TEST_METHOD_EX(CanvasTextFormat_PrewarmCustomFontsAsync_InvalidArgs)
+        {
+            auto factory = Make<CanvasTextFormatFactory>();
+
+            auto fontFamilies = Make<LocaleList>(L"http://foo#anyfamily");
+            ComPtr<IAsyncAction> action;
+
+            Assert::AreEqual(E_INVALIDARG, factory->PrewarmCustomFontsAsync(nullptr, &action));
+            Assert::AreEqual(E_INVALIDARG, factory->PrewarmCustomFontsAsync(GetVectorView(fontFamilies).Get(), nullptr));
+
+            Assert::AreEqual(E_INVALIDARG, factory->PrewarmCustomFontsAsync(GetVectorView(fontFamilies).Get(), &action));
+            ValidateStoredErrorState(E_INVALIDARG, Strings::InvalidFontFamilyUriScheme);
+            Assert::IsNull(action.Get());
+        }
+
         class SystemFontFamiliesFixture
         {
             std::shared_ptr<StubCanvasTextLayoutAdapter> m_adapter;
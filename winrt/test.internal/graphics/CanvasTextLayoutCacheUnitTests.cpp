@@ -0,0 +1,396 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/text/CanvasTextLayoutCache.h>
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+TEST_CLASS(CanvasTextLayoutCacheTests)
+{
+    static CanvasTextLayoutCacheKey MakeKey(wchar_t const* text, uint64_t formatGeneration = 1, float width = 100, float height = 50, DWORD threadId = 1)
+    {
+        return CanvasTextLayoutCacheKey{ text, formatGeneration, width, height, threadId };
+    }
+
+    static std::shared_ptr<CachedTextLayout> Add(CanvasTextLayoutCache& cache, wchar_t const* text)
+    {
+        auto value = std::make_shared<CachedTextLayout>();
+        Assert::IsTrue(value == cache.Add(MakeKey(text), value));
+        return value;
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_IsDisabledByDefault)
+    {
+        CanvasTextLayoutCache cache;
+
+        Assert::AreEqual(0u, cache.GetMaximumEntryCount());
+        Assert::IsFalse(cache.IsEnabled());
+
+        auto value = std::make_shared<CachedTextLayout>();
+        Assert::IsTrue(value == cache.Add(MakeKey(L"a"), value));
+        Assert::IsNull(cache.TryGet(MakeKey(L"a")).get());
+        Assert::AreEqual(0, cache.GetStatistics().EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_TryGet_CountsHitsAndMisses)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(10);
+
+        Assert::IsNull(cache.TryGet(MakeKey(L"a")).get());
+
+        auto a = Add(cache, L"a");
+
+        Assert::IsTrue(a == cache.TryGet(MakeKey(L"a")));
+        Assert::IsTrue(a == cache.TryGet(MakeKey(L"a")));
+
+        auto statistics = cache.GetStatistics();
+        Assert::AreEqual(2LL, statistics.HitCount);
+        Assert::AreEqual(1LL, statistics.MissCount);
+        Assert::AreEqual(0LL, statistics.EvictionCount);
+        Assert::AreEqual(1, statistics.EntryCount);
+
+        cache.ResetStatistics();
+
+        statistics = cache.GetStatistics();
+        Assert::AreEqual(0LL, statistics.HitCount);
+        Assert::AreEqual(0LL, statistics.MissCount);
+        Assert::AreEqual(1, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_EveryPartOfTheKeyIsCompared)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(10);
+
+        Add(cache, L"a");
+
+        Assert::IsNull(cache.TryGet(MakeKey(L"b")).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"a", 2)).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"a", 1, 101)).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"a", 1, 100, 51)).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"a", 1, 100, 50, 2)).get());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).get());
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_Add_WhenKeyAlreadyPresent_ReturnsExistingEntry)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(10);
+
+        auto first = Add(cache, L"a");
+        auto second = std::make_shared<CachedTextLayout>();
+
+        Assert::IsTrue(first == cache.Add(MakeKey(L"a"), second));
+        Assert::AreEqual(1, cache.GetStatistics().EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_EvictsLeastRecentlyUsed)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(2);
+
+        Add(cache, L"a");
+        Add(cache, L"b");
+
+        cache.TryGet(MakeKey(L"a"));
+
+        Add(cache, L"c");
+
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"b")).get());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"c")).get());
+
+        auto statistics = cache.GetStatistics();
+        Assert::AreEqual(1LL, statistics.EvictionCount);
+        Assert::AreEqual(2, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_ReducingMaximumEntryCount_EvictsEntries)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(3);
+
+        Add(cache, L"a");
+        Add(cache, L"b");
+        Add(cache, L"c");
+
+        cache.SetMaximumEntryCount(1);
+
+        Assert::AreEqual(1, cache.GetStatistics().EntryCount);
+        Assert::AreEqual(2LL, cache.GetStatistics().EvictionCount);
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"c")).get());
+
+        cache.SetMaximumEntryCount(0);
+
+        Assert::IsFalse(cache.IsEnabled());
+        Assert::AreEqual(0, cache.GetStatistics().EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutCache_Clear_RemovesEntriesButNotStatistics)
+    {
+        CanvasTextLayoutCache cache;
+        cache.SetMaximumEntryCount(10);
+
+        Add(cache, L"a");
+        cache.TryGet(MakeKey(L"a"));
+        cache.RecordCopy();
+
+        cache.Clear();
+
+        auto statistics = cache.GetStatistics();
+        Assert::AreEqual(0, statistics.EntryCount);
+        Assert::AreEqual(1LL, statistics.HitCount);
+        Assert::AreEqual(1LL, statistics.CopyCount);
+        Assert::AreEqual(0LL, statistics.EvictionCount);
+    }
+};
+
+
+TEST_CLASS(CanvasTextLayoutSharingTests)
+{
+    struct Fixture
+    {
+        std::shared_ptr<StubCanvasTextLayoutAdapter> Adapter;
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<ICanvasTextFormat> Format;
+        std::vector<ComPtr<StubTextLayout>> CreatedLayouts;
+
+        Fixture()
+            : Adapter(std::make_shared<StubCanvasTextLayoutAdapter>())
+            , Device(Make<StubCanvasDevice>())
+        {
+            CustomFontManagerAdapter::SetInstance(Adapter);
+
+            Format = Make<CanvasTextFormat>();
+
+            Adapter->GetMockDWriteFactory()->CreateTextLayoutMethod.AllowAnyCall(
+                [=](WCHAR const*, UINT32, IDWriteTextFormat*, FLOAT, FLOAT, IDWriteTextLayout** textLayout)
+                {
+                    auto layout = Make<StubTextLayout>();
+                    layout->GetMetricsMethod.AllowAnyCall();
+                    layout->SetFontSizeMethod.AllowAnyCall();
+
+                    CreatedLayouts.push_back(layout);
+
+                    return layout.CopyTo(textLayout);
+                });
+        }
+
+        void EnableCache()
+        {
+            Device->GetTextLayoutCache()->SetMaximumEntryCount(10);
+        }
+
+        ComPtr<CanvasTextLayout> CreateTextLayout(wchar_t const* text = L"A string", float width = 100.0f)
+        {
+            return CanvasTextLayout::CreateNew(Device.Get(), WinString(text), Format.Get(), width, 50.0f);
+        }
+
+        CanvasTextLayoutCacheStatistics GetStatistics()
+        {
+            return Device->GetTextLayoutCache()->GetStatistics();
+        }
+    };
+
+    TEST_METHOD_EX(CanvasTextLayout_WhenCacheDisabled_EveryLayoutIsCreated)
+    {
+        Fixture f;
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        Assert::AreEqual<size_t>(2, f.CreatedLayouts.size());
+        Assert::IsFalse(a->IsSharingCachedLayout());
+        Assert::IsFalse(b->IsSharingCachedLayout());
+        Assert::AreEqual(0LL, f.GetStatistics().MissCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_WhenCacheEnabled_IdenticalLayoutsAreShared)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        Assert::AreEqual<size_t>(1, f.CreatedLayouts.size());
+        Assert::IsTrue(a->IsSharingCachedLayout());
+        Assert::IsTrue(b->IsSharingCachedLayout());
+        Assert::IsTrue(IsSameInstance(a->GetReadOnlyResource().Get(), b->GetReadOnlyResource().Get()));
+
+        auto statistics = f.GetStatistics();
+        Assert::AreEqual(1LL, statistics.HitCount);
+        Assert::AreEqual(1LL, statistics.MissCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_WhenCacheEnabled_DifferentInputsAreNotShared)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        f.CreateTextLayout(L"A string");
+        f.CreateTextLayout(L"Another string");
+        f.CreateTextLayout(L"A string", 200.0f);
+
+        ThrowIfFailed(f.Format->put_FontSize(40.0f));
+        f.CreateTextLayout(L"A string");
+
+        Assert::AreEqual<size_t>(4, f.CreatedLayouts.size());
+        Assert::AreEqual(0LL, f.GetStatistics().HitCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_LayoutsCreatedOnDifferentThreadsAreNotShared)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+
+        ComPtr<CanvasTextLayout> b;
+        std::thread([&] { b = f.CreateTextLayout(); }).join();
+
+        Assert::AreEqual<size_t>(2, f.CreatedLayouts.size());
+        Assert::IsTrue(b->IsSharingCachedLayout());
+        Assert::AreEqual(0LL, f.GetStatistics().HitCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_UsingASharedLayoutOnAnotherThread_MakesAPrivateCopy)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        auto sharedResource = a->GetReadOnlyResource();
+
+        ComPtr<DWriteTextLayoutType> resourceSeenByOtherThread;
+        std::thread([&] { resourceSeenByOtherThread = b->GetReadOnlyResource(); }).join();
+
+        Assert::IsFalse(b->IsSharingCachedLayout());
+        Assert::IsTrue(IsSameInstance(f.CreatedLayouts[1].Get(), resourceSeenByOtherThread.Get()));
+        Assert::IsTrue(IsSameInstance(f.CreatedLayouts[1].Get(), b->GetReadOnlyResource().Get()));
+
+        Assert::IsTrue(a->IsSharingCachedLayout());
+        Assert::IsTrue(IsSameInstance(sharedResource.Get(), a->GetReadOnlyResource().Get()));
+
+        Assert::AreEqual(1LL, f.GetStatistics().CopyCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_ModifyingASharedLayout_MakesAPrivateCopy)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        auto sharedResource = b->GetReadOnlyResource();
+
+        Assert::AreEqual(S_OK, a->SetFontSize(0, 1, 20.0f));
+
+        Assert::AreEqual<size_t>(2, f.CreatedLayouts.size());
+        Assert::IsFalse(a->IsSharingCachedLayout());
+        Assert::IsTrue(b->IsSharingCachedLayout());
+
+        Assert::IsTrue(IsSameInstance(f.CreatedLayouts[1].Get(), a->GetReadOnlyResource().Get()));
+        Assert::IsTrue(IsSameInstance(sharedResource.Get(), b->GetReadOnlyResource().Get()));
+
+        Assert::AreEqual(0, f.CreatedLayouts[0]->SetFontSizeMethod.GetCurrentCallCount());
+        Assert::AreEqual(1, f.CreatedLayouts[1]->SetFontSizeMethod.GetCurrentCallCount());
+
+        Assert::AreEqual(1LL, f.GetStatistics().CopyCount);
+
+        // Later layouts still share the unmodified original.
+        auto c = f.CreateTextLayout();
+        Assert::IsTrue(IsSameInstance(sharedResource.Get(), c->GetReadOnlyResource().Get()));
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_GettingTheNativeResourceOfASharedLayout_MakesAPrivateCopy)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        auto nativeResource = GetWrappedResource<IDWriteTextLayout>(a);
+
+        Assert::IsFalse(a->IsSharingCachedLayout());
+        Assert::IsTrue(IsSameInstance(f.CreatedLayouts[1].Get(), nativeResource.Get()));
+        Assert::IsTrue(IsSameInstance(f.CreatedLayouts[0].Get(), b->GetReadOnlyResource().Get()));
+
+        // The copy is a regular wrapped resource, so interop finds the same wrapper.
+        auto wrapper = ResourceManager::GetOrCreate<ICanvasTextLayout>(f.Device.Get(), nativeResource.Get());
+        Assert::IsTrue(IsSameInstance(a.Get(), wrapper.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasTextLayout_ClosingASharedLayout_DoesNotAffectOthers)
+    {
+        Fixture f;
+        f.EnableCache();
+
+        auto a = f.CreateTextLayout();
+        auto b = f.CreateTextLayout();
+
+        Assert::AreEqual(S_OK, a->Close());
+
+        float fontSize;
+        Assert::AreEqual(RO_E_CLOSED, a->get_DefaultFontSize(&fontSize));
+        Assert::AreEqual(RO_E_CLOSED, a->SetFontSize(0, 1, 20.0f));
+
+        Assert::AreEqual(S_OK, b->get_DefaultFontSize(&fontSize));
+        Assert::IsTrue(b->IsSharingCachedLayout());
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutFactory_CacheStatics)
+    {
+        Fixture f;
+        auto factory = Make<CanvasTextLayoutFactory>();
+
+        int32_t maximumEntryCount = -1;
+        Assert::AreEqual(S_OK, factory->GetCacheMaximumEntryCount(f.Device.Get(), &maximumEntryCount));
+        Assert::AreEqual(0, maximumEntryCount);
+
+        Assert::AreEqual(S_OK, factory->SetCacheMaximumEntryCount(f.Device.Get(), 5));
+        Assert::AreEqual(S_OK, factory->GetCacheMaximumEntryCount(f.Device.Get(), &maximumEntryCount));
+        Assert::AreEqual(5, maximumEntryCount);
+
+        f.CreateTextLayout();
+        f.CreateTextLayout();
+
+        CanvasTextLayoutCacheStatistics statistics;
+        Assert::AreEqual(S_OK, factory->GetCacheStatistics(f.Device.Get(), &statistics));
+        Assert::AreEqual(1LL, statistics.HitCount);
+        Assert::AreEqual(1, statistics.EntryCount);
+
+        Assert::AreEqual(S_OK, factory->ClearCache(f.Device.Get()));
+        Assert::AreEqual(S_OK, factory->ResetCacheStatistics(f.Device.Get()));
+        Assert::AreEqual(S_OK, factory->GetCacheStatistics(f.Device.Get(), &statistics));
+        Assert::AreEqual(0LL, statistics.HitCount);
+        Assert::AreEqual(0, statistics.EntryCount);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutFactory_CacheStatics_InvalidArgs)
+    {
+        Fixture f;
+        auto factory = Make<CanvasTextLayoutFactory>();
+
+        int32_t maximumEntryCount;
+        CanvasTextLayoutCacheStatistics statistics;
+
+        Assert::AreEqual(E_INVALIDARG, factory->GetCacheMaximumEntryCount(nullptr, &maximumEntryCount));
+        Assert::AreEqual(E_INVALIDARG, factory->GetCacheMaximumEntryCount(f.Device.Get(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->SetCacheMaximumEntryCount(nullptr, 1));
+        Assert::AreEqual(E_INVALIDARG, factory->SetCacheMaximumEntryCount(f.Device.Get(), -1));
+        Assert::AreEqual(E_INVALIDARG, factory->GetCacheStatistics(nullptr, &statistics));
+        Assert::AreEqual(E_INVALIDARG, factory->GetCacheStatistics(f.Device.Get(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->ResetCacheStatistics(nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->ClearCache(nullptr));
+    }
+};
@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/text/CanvasTextLayout.h>
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Text;
+
+static float const c_clusterWidth = 5.0f;
+static float const c_lineHeight = 10.0f;
+
+TEST_CLASS(CanvasTextLayoutHitTestIndexTests)
+{
+    //
+    // The layout holds "ab\ncd", as two left aligned lines.  Every character
+    // is its own cluster, and all but the newline are the same width.
+    //
+    struct Fixture
+    {
+        std::shared_ptr<StubCanvasTextLayoutAdapter> Adapter;
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<ICanvasTextFormat> Format;
+
+        Fixture()
+            : Adapter(std::make_shared<StubCanvasTextLayoutAdapter>())
+            , Device(Make<StubCanvasDevice>())
+        {
+            CustomFontManagerAdapter::SetInstance(Adapter);
+
+            Format = Make<CanvasTextFormat>();
+
+            auto& layout = Adapter->MockTextLayout;
+
+            layout->GetTextAlignmentMethod.AllowAnyCall([] { return DWRITE_TEXT_ALIGNMENT_LEADING; });
+
+            layout->GetClusterMetricsMethod.AllowAnyCall(
+                [](DWRITE_CLUSTER_METRICS* clusterMetrics, UINT32 maxClusterCount, UINT32* actualClusterCount)
+                {
+                    *actualClusterCount = 5;
+
+                    if (maxClusterCount < 5)
+                        return E_NOT_SUFFICIENT_BUFFER;
+
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        clusterMetrics[i] = DWRITE_CLUSTER_METRICS{};
+                        clusterMetrics[i].length = 1;
+                        clusterMetrics[i].width = (i == 2) ? 0.0f : c_clusterWidth;
+                        clusterMetrics[i].isNewline = (i == 2);
+                    }
+                    return S_OK;
+                });
+
+            layout->GetLineMetricsMethod1.AllowAnyCall(
+                [](DWRITE_LINE_METRICS1* lineMetrics, UINT32 maxLineCount, UINT32* actualLineCount)
+                {
+                    *actualLineCount = 2;
+
+                    if (maxLineCount < 2)
+                        return E_NOT_SUFFICIENT_BUFFER;
+
+                    lineMetrics[0] = DWRITE_LINE_METRICS1{};
+                    lineMetrics[0].length = 3;
+                    lineMetrics[0].newlineLength = 1;
+                    lineMetrics[0].height = c_lineHeight;
+
+                    lineMetrics[1] = DWRITE_LINE_METRICS1{};
+                    lineMetrics[1].length = 2;
+                    lineMetrics[1].height = c_lineHeight;
+                    return S_OK;
+                });
+        }
+
+        // The index asks DWrite where each line starts.
+        void ExpectLineStartQueries(int count)
+        {
+            Adapter->MockTextLayout->HitTestTextPositionMethod.SetExpectedCalls(count,
+                [](UINT32 textPosition, BOOL isTrailingHit, FLOAT* pointX, FLOAT* pointY, DWRITE_HIT_TEST_METRICS* hitTestMetrics)
+                {
+                    Assert::IsFalse(!!isTrailingHit);
+                    Assert::IsTrue(textPosition == 0 || textPosition == 3);
+
+                    *pointX = 0;
+                    *pointY = (textPosition == 0) ? 0 : c_lineHeight;
+                    *hitTestMetrics = DWRITE_HIT_TEST_METRICS{};
+                    return S_OK;
+                });
+        }
+
+        ComPtr<CanvasTextLayout> CreateTextLayout()
+        {
+            return CanvasTextLayout::CreateNew(Device.Get(), WinString(L"ab\ncd"), Format.Get(), 0.0f, 0.0f);
+        }
+    };
+
+    static void VerifyResult(
+        CanvasTextLayoutHitTestResult const& result,
+        int characterIndex,
+        bool trailingSideOfCharacter,
+        bool isHit)
+    {
+        Assert::AreEqual(characterIndex, result.Region.CharacterIndex);
+        Assert::AreEqual(trailingSideOfCharacter, !!result.TrailingSideOfCharacter);
+        Assert::AreEqual(isHit, !!result.IsHit);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_HitTestPoints_UsesIndex)
+    {
+        Fixture f;
+        f.ExpectLineStartQueries(2);
+
+        auto textLayout = f.CreateTextLayout();
+
+        Vector2 points[] =
+        {
+            { 2, 5 },       // leading side of 'a'
+            { 8, 5 },       // trailing side of 'b'
+            { 50, 5 },      // past the end of the first line
+            { -5, 15 },     // before the start of the second line
+            { 7, 15 },      // leading side of 'd'
+            { 3, 100 },     // below the text
+        };
+
+        uint32_t resultCount;
+        CanvasTextLayoutHitTestResult* results;
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(_countof(points), points, &resultCount, &results));
+        Assert::AreEqual<uint32_t>(_countof(points), resultCount);
+
+        VerifyResult(results[0], 0, false, true);
+        VerifyResult(results[1], 1, true, true);
+        VerifyResult(results[2], 1, true, false);
+        VerifyResult(results[3], 3, false, false);
+        VerifyResult(results[4], 4, false, true);
+        VerifyResult(results[5], 3, false, false);
+
+        Assert::AreEqual(Rect{ 5, 0, c_clusterWidth, c_lineHeight }, results[1].Region.LayoutBounds);
+        Assert::AreEqual(Rect{ 5, 10, c_clusterWidth, c_lineHeight }, results[4].Region.LayoutBounds);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_GetCaretPositions_UsesIndex)
+    {
+        Fixture f;
+        f.ExpectLineStartQueries(2);
+
+        auto textLayout = f.CreateTextLayout();
+
+        int32_t characterIndices[] = { 0, 1, 3, 4, 5, 100 };
+
+        uint32_t locationCount;
+        Vector2* locations;
+        Assert::AreEqual(S_OK, textLayout->GetCaretPositions(_countof(characterIndices), characterIndices, false, &locationCount, &locations));
+        Assert::AreEqual<uint32_t>(_countof(characterIndices), locationCount);
+
+        Assert::AreEqual(Vector2{ 0, 0 }, locations[0]);
+        Assert::AreEqual(Vector2{ 5, 0 }, locations[1]);
+        Assert::AreEqual(Vector2{ 0, 10 }, locations[2]);
+        Assert::AreEqual(Vector2{ 5, 10 }, locations[3]);
+        Assert::AreEqual(Vector2{ 10, 10 }, locations[4]);
+        Assert::AreEqual(Vector2{ 10, 10 }, locations[5]);
+
+        Assert::AreEqual(S_OK, textLayout->GetCaretPositions(_countof(characterIndices), characterIndices, true, &locationCount, &locations));
+
+        Assert::AreEqual(Vector2{ 5, 0 }, locations[0]);
+        Assert::AreEqual(Vector2{ 10, 0 }, locations[1]);
+        Assert::AreEqual(Vector2{ 5, 10 }, locations[2]);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_EmptyArrays)
+    {
+        Fixture f;
+        f.ExpectLineStartQueries(0);
+
+        auto textLayout = f.CreateTextLayout();
+
+        uint32_t count = 1;
+        CanvasTextLayoutHitTestResult* results;
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(0, nullptr, &count, &results));
+        Assert::AreEqual(0u, count);
+
+        count = 1;
+        Vector2* locations;
+        Assert::AreEqual(S_OK, textLayout->GetCaretPositions(0, nullptr, false, &count, &locations));
+        Assert::AreEqual(0u, count);
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_IsRebuiltWhenLayoutChanges)
+    {
+        Fixture f;
+        f.ExpectLineStartQueries(2);
+
+        auto textLayout = f.CreateTextLayout();
+
+        Vector2 point{ 2, 5 };
+        uint32_t resultCount;
+        CanvasTextLayoutHitTestResult* results;
+
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(1, &point, &resultCount, &results));
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(1, &point, &resultCount, &results));
+
+        f.Adapter->MockTextLayout->SetMaxWidthMethod.SetExpectedCalls(1);
+        f.Adapter->MockTextLayout->SetMaxHeightMethod.SetExpectedCalls(1);
+        Assert::AreEqual(S_OK, textLayout->put_RequestedSize(Size{ 100, 100 }));
+
+        f.ExpectLineStartQueries(2);
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(1, &point, &resultCount, &results));
+        Assert::AreEqual(S_OK, textLayout->HitTestPoints(1, &point, &resultCount, &results));
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_FallsBackToDWrite_WhenLayoutCantBeIndexed)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            Fixture f;
+            f.ExpectLineStartQueries(0);
+
+            auto& layout = f.Adapter->MockTextLayout;
+
+            switch (i)
+            {
+            case 0:
+                layout->GetReadingDirectionMethod.AllowAnyCall([] { return DWRITE_READING_DIRECTION_RIGHT_TO_LEFT; });
+                break;
+
+            case 1:
+                layout->GetTextAlignmentMethod.AllowAnyCall([] { return DWRITE_TEXT_ALIGNMENT_JUSTIFIED; });
+                break;
+
+            case 2:
+                layout->GetFlowDirectionMethod.AllowAnyCall([] { return DWRITE_FLOW_DIRECTION_LEFT_TO_RIGHT; });
+                break;
+            }
+
+            auto textLayout = f.CreateTextLayout();
+
+            Vector2 points[] = { { 1, 2 }, { 3, 4 } };
+
+            layout->HitTestPointMethod.SetExpectedCalls(2,
+                [](FLOAT x, FLOAT y, BOOL* isTrailingHit, BOOL* isInside, DWRITE_HIT_TEST_METRICS* hitTestMetrics)
+                {
+                    *hitTestMetrics = DWRITE_HIT_TEST_METRICS{};
+                    hitTestMetrics->textPosition = static_cast<UINT32>(x);
+                    *isTrailingHit = TRUE;
+                    *isInside = TRUE;
+                    return S_OK;
+                });
+
+            uint32_t resultCount;
+            CanvasTextLayoutHitTestResult* results;
+            Assert::AreEqual(S_OK, textLayout->HitTestPoints(_countof(points), points, &resultCount, &results));
+            Assert::AreEqual(2u, resultCount);
+
+            VerifyResult(results[0], 1, true, true);
+            VerifyResult(results[1], 3, true, true);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasTextLayoutHitTestIndex_FallsBackToDWrite_AfterInterop)
+    {
+        Fixture f;
+        f.ExpectLineStartQueries(0);
+
+        auto textLayout = f.CreateTextLayout();
+
+        ComPtr<IDWriteTextLayout> dwriteLayout;
+        Assert::AreEqual(S_OK, textLayout->GetNativeResource(nullptr, 0, IID_PPV_ARGS(&dwriteLayout)));
+
+        // The app may now change the layout behind our back, so every
+        // query goes to DWrite.
+        f.Adapter->MockTextLayout->HitTestTextPositionMethod.SetExpectedCalls(1,
+            [](UINT32 textPosition, BOOL, FLOAT* pointX, FLOAT* pointY, DWRITE_HIT_TEST_METRICS* hitTestMetrics)
+            {
+                Assert::AreEqual(4u, textPosition);
+                *pointX = 1;
+                *pointY = 2;
+                *hitTestMetrics = DWRITE_HIT_TEST_METRICS{};
+                return S_OK;
+            });
+
+        int32_t characterIndex = 4;
+        uint32_t locationCount;
+        Vector2* locations;
+        Assert::AreEqual(S_OK, textLayout->GetCaretPositions(1, &characterIndex, false, &locationCount, &locations));
+        Assert::AreEqual(Vector2{ 1, 2 }, locations[0]);
+    }
+};
@@ -147,6 +147,20 @@ namespace canvas
             ASSERT_IMPLEMENTS_INTERFACE(textLayout, ICanvasResourceWrapperNative);
         }
 
+        TEST_METHOD_EX(CanvasTextLayoutTests_CreatingALayout_DoesNotChangeTheFormatGeneration)
+        {
+            Fixture f;
+
+            auto formatInternal = As<ICanvasTextFormatInternal>(f.Format);
+            auto generation = formatInternal->GetGeneration();
+
+            f.CreateSimpleTextLayout();
+
+            // Otherwise every layout would invalidate cached text drawn
+            // with this format.
+            Assert::AreEqual(generation, formatInternal->GetGeneration());
+        }
+
         TEST_METHOD_EX(CanvasTextLayoutTests_Closure)
         {
             Fixture f;
@@ -177,6 +191,8 @@ namespace canvas
             CanvasTextLayoutRegion hitTestDesc{};
             Vector2 pt{};
             CanvasTextLayoutRegion* hitTestDescArr{};
+            CanvasTextLayoutHitTestResult* hitTestResultArr{};
+            Vector2* ptArr{};
             ComPtr<ICanvasBrush> canvasBrush;
             ComPtr<ICanvasDevice> canvasDevice;
             CanvasTrimmingSign ts;
@@ -292,6 +308,8 @@ namespace canvas
             Assert::AreEqual(RO_E_CLOSED, textLayout->GetCaretPosition(0, b, &pt));
             Assert::AreEqual(RO_E_CLOSED, textLayout->GetCaretPositionWithDescription(0, b, &hitTestDesc, &pt));
             Assert::AreEqual(RO_E_CLOSED, textLayout->GetCharacterRegions(0, 0, &u, &hitTestDescArr));
+            Assert::AreEqual(RO_E_CLOSED, textLayout->HitTestPoints(0, nullptr, &u, &hitTestResultArr));
+            Assert::AreEqual(RO_E_CLOSED, textLayout->GetCaretPositions(0, nullptr, b, &u, &ptArr));
 
             Assert::AreEqual(RO_E_CLOSED, textLayout->GetBrush(0, &canvasBrush));
             Assert::AreEqual(RO_E_CLOSED, textLayout->SetBrush(0, 0, Make<StubCanvasBrush>().Get()));
@@ -331,6 +349,8 @@ namespace canvas
             INT32* arr;
             CanvasTextLayoutRegion hitTestDesc{};
             CanvasTextLayoutRegion* hitTestDescArr{};
+            CanvasTextLayoutHitTestResult* hitTestResultArr{};
+            Vector2* ptArr{};
             boolean b{};
             CanvasLineMetrics* lm{};
             CanvasClusterMetrics* cm{};
@@ -379,6 +399,12 @@ namespace canvas
             Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPosition(0, b, nullptr));
             Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPositionWithDescription(0, b, &hitTestDesc, nullptr));
             Assert::AreEqual(E_INVALIDARG, textLayout->GetCharacterRegions(0, 0, nullptr, &hitTestDescArr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->HitTestPoints(0, nullptr, nullptr, &hitTestResultArr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->HitTestPoints(0, nullptr, &u, nullptr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->HitTestPoints(1, nullptr, &u, &hitTestResultArr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPositions(0, nullptr, b, nullptr, &ptArr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPositions(0, nullptr, b, &u, nullptr));
+            Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPositions(1, nullptr, b, &u, &ptArr));
             Assert::AreEqual(E_INVALIDARG, textLayout->GetBrush(0, nullptr));
             Assert::AreEqual(E_INVALIDARG, textLayout->get_Device(nullptr));
             Assert::AreEqual(E_INVALIDARG, textLayout->get_TrimmingSign(nullptr));
@@ -463,6 +489,10 @@ namespace canvas
             Assert::AreEqual(E_INVALIDARG, textLayout->GetCharacterRegions(-1, 0, &u, &hitTestDescArr));
             Assert::AreEqual(E_INVALIDARG, textLayout->GetCharacterRegions(0, -1, &u, &hitTestDescArr));
 
+            int32_t characterIndices[] = { 0, -1 };
+            Vector2* ptArr{};
+            Assert::AreEqual(E_INVALIDARG, textLayout->GetCaretPositions(2, characterIndices, false, &u, &ptArr));
+
             ComPtr<ICanvasBrush> stubBrush = Make<StubCanvasBrush>();
             Assert::AreEqual(E_INVALIDARG, textLayout->GetBrush(-1, &stubBrush));
             Assert::AreEqual(E_INVALIDARG, textLayout->SetBrush(-1, 0, stubBrush.Get()));
@@ -2464,6 +2494,172 @@ namespace canvas
             }
         }
 
+        TEST_METHOD_EX(CanvasTextLayoutTests_TextMetrics_AreFetchedOncePerLayoutChange)
+        {
+            Fixture f;
+
+            auto textLayout = f.CreateSimpleTextLayout();
+
+            auto expectGetMetrics =
+                [&]
+                {
+                    f.Adapter->MockTextLayout->GetMetricsMethod.SetExpectedCalls(1,
+                        [](DWRITE_TEXT_METRICS1* out)
+                        {
+                            *out = DWRITE_TEXT_METRICS1{};
+                            out->lineCount = 3;
+                            return S_OK;
+                        });
+                };
+
+            expectGetMetrics();
+
+            Rect rect;
+            int32_t value;
+            Assert::AreEqual(S_OK, textLayout->get_LayoutBounds(&rect));
+            Assert::AreEqual(S_OK, textLayout->get_LayoutBoundsIncludingTrailingWhitespace(&rect));
+            Assert::AreEqual(S_OK, textLayout->get_MaximumBidiReorderingDepth(&value));
+            Assert::AreEqual(S_OK, textLayout->get_LineCount(&value));
+            Assert::AreEqual(3, value);
+
+            f.Adapter->MockTextLayout->SetMaxWidthMethod.SetExpectedCalls(1);
+            f.Adapter->MockTextLayout->SetMaxHeightMethod.SetExpectedCalls(1);
+            Assert::AreEqual(S_OK, textLayout->put_RequestedSize(Size{ 10, 10 }));
+
+            expectGetMetrics();
+
+            Assert::AreEqual(S_OK, textLayout->get_LineCount(&value));
+            Assert::AreEqual(3, value);
+            Assert::AreEqual(S_OK, textLayout->get_LayoutBounds(&rect));
+        }
+
+        TEST_METHOD_EX(CanvasTextLayoutTests_DrawBounds_AreFetchedOncePerLayoutChange)
+        {
+            Fixture f;
+
+            auto textLayout = f.CreateSimpleTextLayout();
+
+            f.Adapter->MockTextLayout->GetMaxWidthMethod.SetExpectedCalls(1, [] { return 10.0f; });
+            f.Adapter->MockTextLayout->GetMaxHeightMethod.SetExpectedCalls(1, [] { return 20.0f; });
+            f.Adapter->MockTextLayout->GetOverhangMetricsMethod.SetExpectedCalls(1,
+                [](DWRITE_OVERHANG_METRICS* out)
+                {
+                    *out = DWRITE_OVERHANG_METRICS{};
+                    return S_OK;
+                });
+
+            Rect first, second;
+            Assert::AreEqual(S_OK, textLayout->get_DrawBounds(&first));
+            Assert::AreEqual(S_OK, textLayout->get_DrawBounds(&second));
+            Assert::AreEqual(Rect{ 0, 0, 10, 20 }, second);
+        }
+
+        TEST_METHOD_EX(CanvasTextLayoutTests_LineMetrics_UseLineCountFromTextMetrics)
+        {
+            GetLineMetricsFixture f;
+
+            auto textLayout = f.CreateSimpleTextLayout();
+
+            f.Adapter->MockTextLayout->GetMetricsMethod.SetExpectedCalls(1,
+                [](DWRITE_TEXT_METRICS1* out)
+                {
+                    *out = DWRITE_TEXT_METRICS1{};
+                    out->lineCount = 3;
+                    return S_OK;
+                });
+
+            int32_t lineCount;
+            Assert::AreEqual(S_OK, textLayout->get_LineCount(&lineCount));
+
+            // The line count is already known, so the metrics are fetched in one call.
+            f.ExpectGetLineMetrics(1,
+                [&](DWriteMetricsType* lineMetrics, UINT32 maxLineCount, UINT32* actualLineCount)
+                {
+                    Assert::AreEqual(3u, maxLineCount);
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        lineMetrics[i] = f.GetDWriteLineMetrics(i);
+                    }
+                    *actualLineCount = 3;
+                    return S_OK;
+                });
+
+            uint32_t valueCount;
+            CanvasLineMetrics* valueElements;
+            Assert::AreEqual(S_OK, textLayout->get_LineMetrics(&valueCount, &valueElements));
+            Assert::AreEqual(3u, valueCount);
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                CanvasLineMetrics expected = f.GetLineMetrics(i);
+                Assert::AreEqual(0, memcmp(&expected, &valueElements[i], sizeof(expected)));
+            }
+        }
+
+        TEST_METHOD_EX(CanvasTextLayoutTests_ReadOnlyMetrics_DoNotRefetchOrCopy)
+        {
+            GetClusterMetricsFixture f;
+
+            auto textLayout = f.CreateSimpleTextLayout();
+
+            f.Adapter->MockTextLayout->GetClusterMetricsMethod.SetExpectedCalls(2,
+                [&](DWRITE_CLUSTER_METRICS* clusterMetrics, UINT32 maxClusterCount, UINT32* actualClusterCount)
+                {
+                    *actualClusterCount = 2;
+
+                    if (maxClusterCount < 2)
+                        return E_NOT_SUFFICIENT_BUFFER;
+
+                    clusterMetrics[0] = f.GetDWriteClusterMetrics(0);
+                    clusterMetrics[1] = f.GetDWriteClusterMetrics(1);
+                    return S_OK;
+                });
+
+            uint32_t firstCount, secondCount;
+            CanvasClusterMetrics const* firstElements;
+            CanvasClusterMetrics const* secondElements;
+            textLayout->GetReadOnlyClusterMetrics(&firstCount, &firstElements);
+            textLayout->GetReadOnlyClusterMetrics(&secondCount, &secondElements);
+
+            Assert::AreEqual(2u, firstCount);
+            Assert::AreEqual(2u, secondCount);
+            Assert::IsTrue(firstElements == secondElements);
+
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                CanvasClusterMetrics expected = f.GetClusterMetrics(i);
+                Assert::AreEqual(0, memcmp(&expected, &firstElements[i], sizeof(expected)));
+            }
+
+            // The public property is served from the same metrics.
+            uint32_t valueCount;
+            CanvasClusterMetrics* valueElements;
+            Assert::AreEqual(S_OK, textLayout->get_ClusterMetrics(&valueCount, &valueElements));
+            Assert::AreEqual(2u, valueCount);
+            Assert::IsTrue(valueElements != firstElements);
+        }
+
+        TEST_METHOD_EX(CanvasTextLayoutTests_Metrics_AreNotKept_AfterInterop)
+        {
+            Fixture f;
+
+            auto textLayout = f.CreateSimpleTextLayout();
+
+            ComPtr<IDWriteTextLayout> dwriteLayout;
+            Assert::AreEqual(S_OK, textLayout->GetNativeResource(nullptr, 0, IID_PPV_ARGS(&dwriteLayout)));
+
+            // The app may change the layout directly, so each query goes to DWrite.
+            f.Adapter->MockTextLayout->GetMetricsMethod.SetExpectedCalls(2,
+                [](DWRITE_TEXT_METRICS1* out)
+                {
+                    *out = DWRITE_TEXT_METRICS1{};
+                    return S_OK;
+                });
+
+            int32_t lineCount;
+            Assert::AreEqual(S_OK, textLayout->get_LineCount(&lineCount));
+            Assert::AreEqual(S_OK, textLayout->get_LineCount(&lineCount));
+        }
+
         TEST_METHOD_EX(CanvasTextLayoutTests_GetCustomBrush_DefaultIsNull)
         {
             NonStubbedFixture f;
@@ -297,6 +297,170 @@ TEST_CLASS(CanvasVirtualBitmapUnitTest)
         }
     }
 
+    struct CacheControlFixture : public Fixture
+    {
+        ComPtr<MockD2DImageSourceFromWic> ImageSource;
+        ComPtr<CanvasVirtualBitmap> VirtualBitmap;
+
+        CacheControlFixture(Rect localBounds = Rect{ 0, 0, 30, 20 }, D2D1_ORIENTATION orientation = D2D1_ORIENTATION_DEFAULT)
+            : ImageSource(Make<MockD2DImageSourceFromWic>())
+        {
+            VirtualBitmap = Make<CanvasVirtualBitmap>(Device.Get(), ImageSource.Get(), ImageSource.Get(), localBounds, orientation);
+        }
+
+        D2D1_RECT_U ExpectTrimCache(Rect regionToKeep)
+        {
+            D2D1_RECT_U actualRect{};
+
+            ImageSource->TrimCacheMethod.SetExpectedCalls(1,
+                [&] (D2D1_RECT_U const* rect)
+                {
+                    actualRect = *rect;
+                    return S_OK;
+                });
+
+            ThrowIfFailed(VirtualBitmap->TrimCache(regionToKeep));
+
+            return actualRect;
+        }
+    };
+
+    static void WaitForCompletion(ComPtr<IAsyncAction> const& action)
+    {
+        Microsoft::WRL::Wrappers::Event completed(CreateEventEx(NULL, NULL, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS));
+
+        auto completedCallback = Callback<IAsyncActionCompletedHandler>(
+            [&] (IAsyncAction*, AsyncStatus)
+            {
+                SetEvent(completed.Get());
+                return S_OK;
+            });
+
+        ThrowIfFailed(action->put_Completed(completedCallback.Get()));
+
+        Assert::AreEqual(WAIT_OBJECT_0, WaitForSingleObjectEx(completed.Get(), 5000, false));
+
+        ThrowIfFailed(action->GetResults());
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_TrimCache_RegionIsClippedAndRoundedOutToPixels)
+    {
+        CacheControlFixture f(Rect{ 10, 20, 20, 20 });
+
+        Assert::AreEqual(D2D1_RECT_U{ 2, 5, 8, 20 }, f.ExpectTrimCache(Rect{ 12.5f, 25.2f, 5, 100 }));
+        Assert::AreEqual(D2D1_RECT_U{ 0, 0, 20, 20 }, f.ExpectTrimCache(Rect{ 0, 0, 1000, 1000 }));
+
+        // Regions that miss the bitmap entirely trim everything
+        Assert::AreEqual(D2D1_RECT_U{ 0, 0, 0, 0 }, f.ExpectTrimCache(Rect{ 100, 100, 10, 10 }));
+        Assert::AreEqual(D2D1_RECT_U{ 0, 0, 0, 0 }, f.ExpectTrimCache(Rect{ 12, 25, 0, 0 }));
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_TrimCache_RegionIsMappedThroughOrientation)
+    {
+        // The bitmap is displayed as 30x20, and the region to keep is the top
+        // left 10x5 of that.
+        std::pair<D2D1_ORIENTATION, D2D1_RECT_U> testCases[]
+        {
+            { D2D1_ORIENTATION_DEFAULT,                              D2D1_RECT_U{  0,  0, 10,  5 } },
+            { D2D1_ORIENTATION_FLIP_HORIZONTAL,                      D2D1_RECT_U{ 20,  0, 30,  5 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE180,                  D2D1_RECT_U{ 20, 15, 30, 20 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE180_FLIP_HORIZONTAL,  D2D1_RECT_U{  0, 15, 10, 20 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE90_FLIP_HORIZONTAL,   D2D1_RECT_U{  0,  0,  5, 10 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE270,                  D2D1_RECT_U{ 15,  0, 20, 10 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE270_FLIP_HORIZONTAL,  D2D1_RECT_U{ 15, 20, 20, 30 } },
+            { D2D1_ORIENTATION_ROTATE_CLOCKWISE90,                   D2D1_RECT_U{  0, 20,  5, 30 } },
+        };
+
+        for (auto testCase : testCases)
+        {
+            CacheControlFixture f(Rect{ 0, 0, 30, 20 }, testCase.first);
+
+            Assert::AreEqual(testCase.second, f.ExpectTrimCache(Rect{ 0, 0, 10, 5 }));
+        }
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_TrimCache_DoesNothingWhenNotCachedOnDemand)
+    {
+        CacheControlFixture f;
+
+        f.ImageSource->TrimCacheMethod.SetExpectedCalls(1, [] (auto) { return D2DERR_UNSUPPORTED_OPERATION; });
+        Assert::AreEqual(S_OK, f.VirtualBitmap->TrimCache(Rect{ 0, 0, 10, 10 }));
+
+        f.ImageSource->TrimCacheMethod.SetExpectedCalls(1, [] (auto) { return E_OUTOFMEMORY; });
+        Assert::AreEqual(E_OUTOFMEMORY, f.VirtualBitmap->TrimCache(Rect{ 0, 0, 10, 10 }));
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_EnsureCachedAsync_CachesRegionOnBackgroundThread)
+    {
+        CacheControlFixture f;
+
+        D2D1_RECT_U actualRect{};
+        f.ImageSource->EnsureCachedMethod.SetExpectedCalls(1,
+            [&] (D2D1_RECT_U const* rect)
+            {
+                actualRect = *rect;
+                return D2DERR_UNSUPPORTED_OPERATION;
+            });
+
+        ComPtr<IAsyncAction> action;
+        ThrowIfFailed(f.VirtualBitmap->EnsureCachedAsync(Rect{ 1.5f, 2, 10, 10 }, &action));
+        WaitForCompletion(action);
+
+        Assert::AreEqual(D2D1_RECT_U{ 1, 2, 12, 12 }, actualRect);
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_EnsureCachedAsync_EmptyRegionDoesNothing)
+    {
+        CacheControlFixture f;
+
+        ComPtr<IAsyncAction> action;
+        ThrowIfFailed(f.VirtualBitmap->EnsureCachedAsync(Rect{ 100, 100, 10, 10 }, &action));
+        WaitForCompletion(action);
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_PrefetchForPanAsync_CachesVisibleRegionAndWhereItIsMovingTo)
+    {
+        CacheControlFixture f(Rect{ 0, 0, 100, 100 });
+
+        D2D1_RECT_U actualRect{};
+        f.ImageSource->EnsureCachedMethod.SetExpectedCalls(1,
+            [&] (D2D1_RECT_U const* rect)
+            {
+                actualRect = *rect;
+                return S_OK;
+            });
+
+        ComPtr<IAsyncAction> action;
+        ThrowIfFailed(f.VirtualBitmap->PrefetchForPanAsync(Rect{ 10, 10, 20, 20 }, Vector2{ 30, -10 }, 0.5f, &action));
+        WaitForCompletion(action);
+
+        Assert::AreEqual(D2D1_RECT_U{ 10, 5, 45, 30 }, actualRect);
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_CacheControl_InvalidArgs)
+    {
+        CacheControlFixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.VirtualBitmap->EnsureCachedAsync(Rect{}, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.VirtualBitmap->PrefetchForPanAsync(Rect{}, Vector2{}, 0, nullptr));
+
+        ComPtr<IAsyncAction> action;
+        Assert::AreEqual(E_INVALIDARG, f.VirtualBitmap->PrefetchForPanAsync(Rect{}, Vector2{}, -1, &action));
+        Assert::IsNull(action.Get());
+    }
+
+    TEST_METHOD_EX(CanvasVirtualBitmap_CacheControl_WhenClosed_ReturnsRoErrorClosed)
+    {
+        CacheControlFixture f;
+
+        ThrowIfFailed(f.VirtualBitmap->Close());
+
+        ComPtr<IAsyncAction> action;
+        Assert::AreEqual(RO_E_CLOSED, f.VirtualBitmap->EnsureCachedAsync(Rect{}, &action));
+        Assert::AreEqual(RO_E_CLOSED, f.VirtualBitmap->TrimCache(Rect{}));
+        Assert::AreEqual(RO_E_CLOSED, f.VirtualBitmap->PrefetchForPanAsync(Rect{}, Vector2{}, 0, &action));
+    }
+
     //
     // In the interop case, various properties of the interop'd image source
     // need to be obtained by probing the passed in resource.  We don't have
@@ -434,6 +598,9 @@ TEST_CLASS(CanvasVirtualBitmapUnitTest)
         boolean value;
         ComPtr<IAsyncAction> action;
         Assert::AreEqual(E_FAIL, virtualBitmap->get_IsCachedOnDemand(&value));
+        Assert::AreEqual(E_FAIL, virtualBitmap->EnsureCachedAsync(Rect{}, &action));
+        Assert::AreEqual(E_FAIL, virtualBitmap->TrimCache(Rect{}));
+        Assert::AreEqual(E_FAIL, virtualBitmap->PrefetchForPanAsync(Rect{}, Vector2{}, 0, &action));
 
         // The device property is set correctly.
         ComPtr<ICanvasDevice> actualDevice;
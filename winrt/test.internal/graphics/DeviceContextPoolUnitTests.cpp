@@ -122,6 +122,33 @@ public:
         Assert::IsNotNull(lease2.Get());
     }
 
+    TEST_METHOD_EX(DeviceContextPool_LeasesKeepTheContainerAlive)
+    {
+        Fixture f;
+        f.CreateDeviceContextMethod.SetExpectedCalls(1);
+
+        ComPtr<ID2D1Device1> container = Make<MockD2DDevice>();
+        DeviceContextPool pool(f.Device.Get(), false, container.Get());
+
+        auto getReferenceCount = [&]
+        {
+            container->AddRef();
+            return container->Release();
+        };
+
+        auto initialReferenceCount = getReferenceCount();
+
+        {
+            auto lease = pool.TakeLease();
+            Assert::AreEqual(initialReferenceCount + 1, getReferenceCount());
+
+            auto movedLease = std::move(lease);
+            Assert::AreEqual(initialReferenceCount + 1, getReferenceCount());
+        }
+
+        Assert::AreEqual(initialReferenceCount, getReferenceCount());
+    }
+
     TEST_METHOD_EX(DeviceContextPool_SimulataneousLeases_CreateMultipleContexts_ButFinalPoolShrinksToReasonableSize)
     {
         Fixture f;
@@ -166,4 +193,128 @@ public:
 
         ExpectHResultException(RO_E_CLOSED, [&] { f.Pool.TakeLease(); });
     }
+
+    TEST_METHOD_EX(DeviceContextPool_GetStatistics_CountsLeasesAndCreatedContexts)
+    {
+        Fixture f;
+        f.CreateDeviceContextMethod.SetExpectedCalls(2);
+
+        {
+            auto lease1 = f.Pool.TakeLease();
+            auto lease2 = f.Pool.TakeLease();
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            auto lease = f.Pool.TakeLease();
+        }
+
+        auto statistics = f.Pool.GetStatistics();
+
+        Assert::AreEqual<uint64_t>(5, statistics.LeasesTaken);
+        Assert::AreEqual<uint64_t>(2, statistics.ContextsCreated);
+        Assert::AreEqual<uint64_t>(0, statistics.ContextsDiscarded);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_GetStatistics_CountsContextsDiscardedWhenPoolIsFull)
+    {
+        Fixture f;
+
+        f.PopulatePool();
+
+        auto statistics = f.Pool.GetStatistics();
+
+        Assert::AreEqual<uint64_t>(100, statistics.LeasesTaken);
+        Assert::AreEqual<uint64_t>(100, statistics.ContextsCreated);
+        Assert::AreEqual<uint64_t>(100 - std::thread::hardware_concurrency(), statistics.ContextsDiscarded);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_WhenNotResettingState_ReturnedContextIsNotModified)
+    {
+        auto device = Make<MockD2DDevice>();
+        auto deviceContext = Make<MockD2DDeviceContext>();
+
+        device->MockCreateDeviceContext =
+            [=] (D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** value)
+            {
+                deviceContext.CopyTo(value);
+            };
+
+        DeviceContextPool pool(device.Get());
+
+        // MockD2DDeviceContext fails on any unexpected Set* calls.
+        auto lease = pool.TakeLease();
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_WhenResettingState_ReturnedContextIsResetToDefaults)
+    {
+        auto device = Make<MockD2DDevice>();
+        auto deviceContext = Make<MockD2DDeviceContext>();
+
+        device->MockCreateDeviceContext =
+            [=] (D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** value)
+            {
+                deviceContext.CopyTo(value);
+            };
+
+        DeviceContextPool pool(device.Get(), true);
+
+        auto lease = pool.TakeLease();
+        Assert::IsTrue(IsSameInstance(deviceContext.Get(), lease.Get()));
+
+        deviceContext->SetTargetMethod.SetExpectedCalls(1,
+            [] (ID2D1Image* target)
+            {
+                Assert::IsNull(target);
+            });
+
+        deviceContext->SetTransformMethod.SetExpectedCalls(1,
+            [] (D2D1_MATRIX_3X2_F const* transform)
+            {
+                Assert::AreEqual<D2D1_MATRIX_3X2_F>(D2D1::Matrix3x2F::Identity(), *transform);
+            });
+
+        deviceContext->SetUnitModeMethod.SetExpectedCalls(1,
+            [] (D2D1_UNIT_MODE unitMode)
+            {
+                Assert::AreEqual(D2D1_UNIT_MODE_DIPS, unitMode);
+            });
+
+        deviceContext->SetDpiMethod.SetExpectedCalls(1,
+            [] (float dpiX, float dpiY)
+            {
+                Assert::AreEqual(DEFAULT_DPI, dpiX);
+                Assert::AreEqual(DEFAULT_DPI, dpiY);
+            });
+
+        deviceContext->SetAntialiasModeMethod.SetExpectedCalls(1,
+            [] (D2D1_ANTIALIAS_MODE mode)
+            {
+                Assert::AreEqual(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE, mode);
+            });
+
+        deviceContext->SetTextAntialiasModeMethod.SetExpectedCalls(1,
+            [] (D2D1_TEXT_ANTIALIAS_MODE mode)
+            {
+                Assert::AreEqual(D2D1_TEXT_ANTIALIAS_MODE_DEFAULT, mode);
+            });
+
+        deviceContext->SetPrimitiveBlendMethod.SetExpectedCalls(1,
+            [] (D2D1_PRIMITIVE_BLEND blend)
+            {
+                Assert::AreEqual(D2D1_PRIMITIVE_BLEND_SOURCE_OVER, blend);
+            });
+
+        deviceContext->SetTextRenderingParamsMethod.SetExpectedCalls(1,
+            [] (IDWriteRenderingParams* params)
+            {
+                Assert::IsNull(params);
+            });
+
+        lease = DeviceContextLease();
+
+        // The reset context is handed out again
+        auto secondLease = pool.TakeLease();
+        Assert::IsTrue(IsSameInstance(deviceContext.Get(), secondLease.Get()));
+    }
 };
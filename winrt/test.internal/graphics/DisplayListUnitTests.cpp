@@ -0,0 +1,257 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/drawing/DisplayList.h>
+
+TEST_CLASS(DisplayListUnitTests)
+{
+public:
+    static ComPtr<MockD2DDeviceContext> MakeReplayDeviceContext()
+    {
+        auto deviceContext = Make<MockD2DDeviceContext>();
+
+        deviceContext->GetTransformMethod.AllowAnyCall(
+            [] (D2D1_MATRIX_3X2_F* transform)
+            {
+                *transform = D2D1::Matrix3x2F::Identity();
+            });
+
+        deviceContext->GetAntialiasModeMethod.AllowAnyCall();
+        deviceContext->GetTextAntialiasModeMethod.AllowAnyCall();
+        deviceContext->GetPrimitiveBlendMethod.AllowAnyCall();
+        deviceContext->GetUnitModeMethod.AllowAnyCall();
+        deviceContext->GetTextRenderingParamsMethod.AllowAnyCall(
+            [] (IDWriteRenderingParams** value)
+            {
+                *value = nullptr;
+            });
+
+        deviceContext->SetTransformMethod.AllowAnyCall();
+        deviceContext->SetAntialiasModeMethod.AllowAnyCall();
+        deviceContext->SetTextAntialiasModeMethod.AllowAnyCall();
+        deviceContext->SetPrimitiveBlendMethod.AllowAnyCall();
+        deviceContext->SetUnitModeMethod.AllowAnyCall();
+        deviceContext->SetTextRenderingParamsMethod.AllowAnyCall();
+
+        return deviceContext;
+    }
+
+    TEST_METHOD_EX(DisplayList_CommandBoundsIncludeRecordedTransform)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        auto transform = D2D1::Matrix3x2F::Translation(10, 20);
+        D2D1_RECT_F rect{ 0, 0, 5, 5 };
+
+        ThrowIfFailed(recorder->SetTransform(&transform));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        Assert::AreEqual<size_t>(1, displayList->GetCommands().size());
+        Assert::AreEqual(D2D1_RECT_F{ 10, 20, 15, 25 }, displayList->GetCommands()[0].Bounds);
+        Assert::AreEqual(D2D1_RECT_F{ 10, 20, 15, 25 }, displayList->GetBounds());
+    }
+
+    TEST_METHOD_EX(DisplayList_CommandsWithTheSameStateShareAStateEntry)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F rect{ 0, 0, 1, 1 };
+        auto transform = D2D1::Matrix3x2F::Scale(2, 2);
+
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+        ThrowIfFailed(recorder->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+        ThrowIfFailed(recorder->SetTransform(&transform));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        auto& commands = displayList->GetCommands();
+
+        Assert::AreEqual<size_t>(2, displayList->GetStates().size());
+        Assert::AreEqual(0u, commands[0].StateIndex);
+        Assert::AreEqual(0u, commands[1].StateIndex);
+        Assert::AreEqual(1u, commands[2].StateIndex);
+        Assert::AreEqual(1u, commands[3].StateIndex);
+    }
+
+    TEST_METHOD_EX(DisplayList_Replay_SkipsCommandsOutsideViewport)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F visibleRect{ 0, 0, 10, 10 };
+        D2D1_RECT_F hiddenRect{ 100, 100, 110, 110 };
+
+        ThrowIfFailed(recorder->FillRectangle(&visibleRect, nullptr));
+        ThrowIfFailed(recorder->FillRectangle(&hiddenRect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        auto deviceContext = MakeReplayDeviceContext();
+
+        deviceContext->FillRectangleMethod.SetExpectedCalls(1,
+            [&] (D2D1_RECT_F const* rect, ID2D1Brush*)
+            {
+                Assert::AreEqual(visibleRect, *rect);
+            });
+
+        D2D1_RECT_F viewport{ 0, 0, 50, 50 };
+        auto statistics = displayList->Replay(deviceContext.Get(), D2D1::Matrix3x2F::Identity(), &viewport);
+
+        Assert::AreEqual(1u, statistics.CommandsReplayed);
+        Assert::AreEqual(1u, statistics.CommandsCulled);
+    }
+
+    TEST_METHOD_EX(DisplayList_Replay_CullingUsesReplayTransform)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F rect{ 100, 100, 110, 110 };
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        auto deviceContext = MakeReplayDeviceContext();
+        deviceContext->FillRectangleMethod.SetExpectedCalls(1);
+
+        D2D1_RECT_F viewport{ 0, 0, 50, 50 };
+        displayList->Replay(deviceContext.Get(), D2D1::Matrix3x2F::Translation(-80, -80), &viewport);
+    }
+
+    TEST_METHOD_EX(DisplayList_Replay_SkipsClipScopesOutsideViewport)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F clipRect{ 100, 100, 200, 200 };
+        D2D1_RECT_F rect{ 0, 0, 300, 300 };
+
+        ThrowIfFailed(recorder->PushAxisAlignedClip(&clipRect, D2D1_ANTIALIAS_MODE_ALIASED));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+        ThrowIfFailed(recorder->PopAxisAlignedClip());
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        auto deviceContext = MakeReplayDeviceContext();
+
+        // Only the rectangle after the clip scope is drawn.
+        deviceContext->FillRectangleMethod.SetExpectedCalls(1);
+
+        D2D1_RECT_F viewport{ 0, 0, 50, 50 };
+        auto statistics = displayList->Replay(deviceContext.Get(), D2D1::Matrix3x2F::Identity(), &viewport);
+
+        Assert::AreEqual(1u, statistics.CommandsReplayed);
+        Assert::AreEqual(3u, statistics.CommandsCulled);
+    }
+
+    TEST_METHOD_EX(DisplayList_Replay_WithoutViewport_ReplaysEverything)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F clipRect{ 100, 100, 200, 200 };
+        D2D1_RECT_F rect{ 0, 0, 300, 300 };
+
+        ThrowIfFailed(recorder->PushAxisAlignedClip(&clipRect, D2D1_ANTIALIAS_MODE_ALIASED));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+        ThrowIfFailed(recorder->PopAxisAlignedClip());
+
+        auto displayList = recorder->Close();
+
+        auto deviceContext = MakeReplayDeviceContext();
+        deviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(1);
+        deviceContext->FillRectangleMethod.SetExpectedCalls(1);
+        deviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(1);
+
+        displayList->Replay(deviceContext.Get(), D2D1::Matrix3x2F::Identity(), nullptr);
+    }
+
+    TEST_METHOD_EX(DisplayList_Replay_CombinesTransformsAndRestoresState)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+
+        auto recordedTransform = D2D1::Matrix3x2F::Translation(1, 2);
+        D2D1_RECT_F rect{ 0, 0, 1, 1 };
+
+        ThrowIfFailed(recorder->SetTransform(&recordedTransform));
+        ThrowIfFailed(recorder->FillRectangle(&rect, nullptr));
+
+        auto displayList = recorder->Close();
+
+        auto deviceContext = MakeReplayDeviceContext();
+        deviceContext->FillRectangleMethod.AllowAnyCall();
+
+        std::vector<D2D1_MATRIX_3X2_F> transforms;
+        deviceContext->SetTransformMethod.AllowAnyCall(
+            [&] (D2D1_MATRIX_3X2_F const* transform)
+            {
+                transforms.push_back(*transform);
+            });
+
+        displayList->Replay(deviceContext.Get(), D2D1::Matrix3x2F::Scale(2, 2), nullptr);
+
+        Assert::AreEqual<size_t>(2, transforms.size());
+        Assert::AreEqual<D2D1_MATRIX_3X2_F>(recordedTransform * D2D1::Matrix3x2F::Scale(2, 2), transforms[0]);
+        Assert::AreEqual<D2D1_MATRIX_3X2_F>(D2D1::Matrix3x2F::Identity(), transforms[1]);
+    }
+
+    TEST_METHOD_EX(DisplayList_Retarget_RecreatesSolidColorBrushes)
+    {
+        auto oldBrush = Make<MockD2DSolidColorBrush>();
+        D2D1_COLOR_F color{ 1, 0, 0, 1 };
+
+        oldBrush->GetColorMethod.AllowAnyCall([&] { return color; });
+        oldBrush->GetOpacityMethod.AllowAnyCall([] { return 0.5f; });
+        oldBrush->GetTransformMethod.AllowAnyCall(
+            [] (D2D1_MATRIX_3X2_F* transform)
+            {
+                *transform = D2D1::Matrix3x2F::Identity();
+            });
+
+        auto recorder = Make<DisplayListRecorder>();
+
+        D2D1_RECT_F rect{ 0, 0, 1, 1 };
+        ThrowIfFailed(recorder->FillRectangle(&rect, oldBrush.Get()));
+
+        auto displayList = recorder->Close();
+
+        auto newBrush = Make<MockD2DSolidColorBrush>();
+        auto newDeviceContext = Make<MockD2DDeviceContext>();
+
+        newDeviceContext->CreateSolidColorBrushMethod.SetExpectedCalls(1,
+            [&] (D2D1_COLOR_F const* newColor, D2D1_BRUSH_PROPERTIES const* properties, ID2D1SolidColorBrush** value)
+            {
+                Assert::AreEqual(color, *newColor);
+                Assert::AreEqual(0.5f, properties->opacity);
+                return newBrush.CopyTo(value);
+            });
+
+        int mapperCallCount = 0;
+        displayList->Retarget(newDeviceContext.Get(),
+            [&] (IUnknown*)
+            {
+                mapperCallCount++;
+                return nullptr;
+            });
+
+        Assert::AreEqual(0, mapperCallCount);
+
+        auto brushIndex = static_cast<DisplayListPayloads::FillRectangle const*>(displayList->GetCommands()[0].Payload)->Brush;
+        Assert::IsTrue(IsSameInstance(newBrush.Get(), displayList->GetResource(brushIndex)));
+    }
+
+    TEST_METHOD_EX(DisplayList_Recorder_FailsAfterClose)
+    {
+        auto recorder = Make<DisplayListRecorder>();
+        recorder->Close();
+
+        D2D1_RECT_F rect{ 0, 0, 1, 1 };
+        Assert::AreEqual(RO_E_CLOSED, recorder->FillRectangle(&rect, nullptr));
+        ExpectHResultException(RO_E_CLOSED, [&] { recorder->Close(); });
+    }
+};
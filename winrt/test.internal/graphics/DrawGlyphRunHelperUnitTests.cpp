@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "mocks/MockDWriteFontFace.h"
+#include "stubs/StubCanvasBrush.h"
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+#include "stubs/StubDWriteFontFaceReference.h"
+#include <lib/text/CanvasFontFace.h>
+#include <lib/text/DrawGlyphRunHelper.h>
+
+TEST_CLASS(DrawGlyphRunHelperTests)
+{
+    static std::vector<CanvasGlyph> MakeGlyphs(uint32_t glyphCount)
+    {
+        std::vector<CanvasGlyph> glyphs;
+
+        for (uint32_t i = 0; i < glyphCount; ++i)
+        {
+            float f = static_cast<float>(i);
+            glyphs.push_back(CanvasGlyph{ static_cast<int>(i * 1000 + 7), f + 0.5f, -f, f * 2 });
+        }
+
+        return glyphs;
+    }
+
+    static void AssertDeinterleaved(std::vector<CanvasGlyph> const& glyphs, uint16_t const* indices, float const* advances, DWRITE_GLYPH_OFFSET const* offsets)
+    {
+        for (size_t i = 0; i < glyphs.size(); ++i)
+        {
+            Assert::AreEqual(static_cast<uint16_t>(glyphs[i].Index), indices[i]);
+            Assert::AreEqual(glyphs[i].Advance, advances[i]);
+            Assert::AreEqual(glyphs[i].AdvanceOffset, offsets[i].advanceOffset);
+            Assert::AreEqual(glyphs[i].AscenderOffset, offsets[i].ascenderOffset);
+        }
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_DeinterleaveGlyphs_MatchesEachGlyph)
+    {
+        // Covers the vectorized body on its own, the remainder on its own,
+        // and both together.
+        for (uint32_t glyphCount = 0; glyphCount <= 13; ++glyphCount)
+        {
+            auto glyphs = MakeGlyphs(glyphCount);
+
+            // One extra element, to check nothing is written past the end.
+            std::vector<uint16_t> indices(glyphCount + 1, 0xABCD);
+            std::vector<float> advances(glyphCount + 1, 123.0f);
+            std::vector<DWRITE_GLYPH_OFFSET> offsets(glyphCount + 1, DWRITE_GLYPH_OFFSET{ 4, 5 });
+
+            DrawGlyphRunHelper::DeinterleaveGlyphs(glyphCount, glyphs.data(), indices.data(), advances.data(), offsets.data());
+
+            AssertDeinterleaved(glyphs, indices.data(), advances.data(), offsets.data());
+
+            Assert::AreEqual<uint16_t>(0xABCD, indices.back());
+            Assert::AreEqual(123.0f, advances.back());
+            Assert::AreEqual(4.0f, offsets.back().advanceOffset);
+            Assert::AreEqual(5.0f, offsets.back().ascenderOffset);
+        }
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_DeinterleaveGlyphs_PreservesSpecialFloatValues)
+    {
+        float const nan = std::numeric_limits<float>::quiet_NaN();
+        float const infinity = std::numeric_limits<float>::infinity();
+
+        std::vector<CanvasGlyph> glyphs
+        {
+            { 1, nan, -0.0f, infinity },
+            { 2, -infinity, nan, 0 },
+            { 3, 0, 0, 0 },
+            { 4, 0, 0, -0.0f },
+        };
+
+        uint16_t indices[4];
+        float advances[4];
+        DWRITE_GLYPH_OFFSET offsets[4];
+
+        DrawGlyphRunHelper::DeinterleaveGlyphs(4, glyphs.data(), indices, advances, offsets);
+
+        Assert::AreEqual(0, memcmp(&glyphs[0].Advance, &advances[0], sizeof(float)));
+        Assert::AreEqual(0, memcmp(&glyphs[0].AdvanceOffset, &offsets[0].advanceOffset, sizeof(float)));
+        Assert::AreEqual(0, memcmp(&glyphs[1].AdvanceOffset, &offsets[1].advanceOffset, sizeof(float)));
+        Assert::AreEqual(0, memcmp(&glyphs[3].AscenderOffset, &offsets[3].ascenderOffset, sizeof(float)));
+        Assert::AreEqual(-infinity, advances[1]);
+        Assert::AreEqual(infinity, offsets[0].ascenderOffset);
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_DeinterleaveGlyphs_ThrowsForIndicesOutOfRange)
+    {
+        int badIndices[] = { -1, 0x10000, INT_MIN, INT_MAX };
+
+        for (auto badIndex : badIndices)
+        {
+            // Place the bad index in both the vectorized part and the remainder.
+            for (uint32_t position = 0; position < 6; ++position)
+            {
+                auto glyphs = MakeGlyphs(6);
+                glyphs[position].Index = badIndex;
+
+                uint16_t indices[6];
+                float advances[6];
+                DWRITE_GLYPH_OFFSET offsets[6];
+
+                ExpectHResultException(E_INVALIDARG,
+                    [&] { DrawGlyphRunHelper::DeinterleaveGlyphs(6, glyphs.data(), indices, advances, offsets); });
+            }
+        }
+
+        CanvasGlyph largestGlyph{ 0xFFFF, 0, 0, 0 };
+        uint16_t index;
+        float advance;
+        DWRITE_GLYPH_OFFSET offset;
+
+        DrawGlyphRunHelper::DeinterleaveGlyphs(1, &largestGlyph, &index, &advance, &offset);
+        Assert::AreEqual<uint16_t>(0xFFFF, index);
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_NarrowClusterMap)
+    {
+        for (uint32_t count = 0; count <= 9; ++count)
+        {
+            std::vector<int> clusterMapIndices;
+            for (uint32_t i = 0; i < count; ++i)
+                clusterMapIndices.push_back(static_cast<int>(i * 8191));
+
+            std::vector<uint16_t> clusterMap(count);
+            DrawGlyphRunHelper::NarrowClusterMap(count, clusterMapIndices.data(), clusterMap.data());
+
+            for (uint32_t i = 0; i < count; ++i)
+                Assert::AreEqual(static_cast<uint16_t>(clusterMapIndices[i]), clusterMap[i]);
+        }
+
+        for (uint32_t position = 0; position < 5; ++position)
+        {
+            int clusterMapIndices[] = { 0, 1, 2, 3, 4 };
+            clusterMapIndices[position] = -1;
+
+            uint16_t clusterMap[5];
+
+            ExpectHResultException(E_INVALIDARG,
+                [&] { DrawGlyphRunHelper::NarrowClusterMap(5, clusterMapIndices, clusterMap); });
+        }
+    }
+
+    struct Fixture
+    {
+        std::shared_ptr<StubCanvasTextLayoutAdapter> Adapter;
+        ComPtr<StubDWriteFontFaceReference> DWriteFontFaceReference;
+        ComPtr<MockDWriteFontFace> RealizedDWriteFontFace;
+        ComPtr<CanvasFontFace> FontFace;
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+        ComPtr<CanvasDrawingSession> DrawingSession;
+        ComPtr<StubCanvasBrush> Brush;
+
+        Fixture()
+            : Adapter(std::make_shared<StubCanvasTextLayoutAdapter>())
+            , DWriteFontFaceReference(Make<StubDWriteFontFaceReference>())
+            , RealizedDWriteFontFace(Make<MockDWriteFontFace>())
+            , DeviceContext(Make<MockD2DDeviceContext>())
+            , Brush(Make<StubCanvasBrush>())
+        {
+            CustomFontManagerAdapter::SetInstance(Adapter);
+
+            FontFace = Make<CanvasFontFace>(DWriteFontFaceReference.Get());
+
+            DWriteFontFaceReference->CreateFontFaceMethod.AllowAnyCall(
+                [=](IDWriteFontFace3** out)
+                {
+                    return RealizedDWriteFontFace.CopyTo(out);
+                });
+
+            DrawingSession = Make<CanvasDrawingSession>(DeviceContext.Get());
+        }
+    };
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_ConvertsCanvasGlyphs)
+    {
+        Fixture f;
+
+        auto glyphs = MakeGlyphs(7);
+        int clusterMapIndices[] = { 0, 0, 1, 2, 3, 4, 5, 6, 6 };
+
+        WinString text(L"123456789");
+        WinString locale(L"xa-yb");
+
+        DrawGlyphRunHelper helper(
+            f.FontFace.Get(),
+            12.0f,
+            static_cast<uint32_t>(glyphs.size()),
+            glyphs.data(),
+            true,
+            3,
+            nullptr,
+            CanvasTextMeasuringMode::GdiClassic,
+            locale,
+            text,
+            _countof(clusterMapIndices),
+            clusterMapIndices,
+            45,
+            nullptr);
+
+        Assert::IsTrue(IsSameInstance(f.RealizedDWriteFontFace.Get(), helper.DWriteGlyphRun.fontFace));
+        Assert::AreEqual(12.0f, helper.DWriteGlyphRun.fontEmSize);
+        Assert::AreEqual(7u, helper.DWriteGlyphRun.glyphCount);
+        Assert::AreEqual(TRUE, helper.DWriteGlyphRun.isSideways);
+        Assert::AreEqual(3u, helper.DWriteGlyphRun.bidiLevel);
+        Assert::AreEqual(DWRITE_MEASURING_MODE_GDI_CLASSIC, helper.MeasuringMode);
+
+        AssertDeinterleaved(glyphs, helper.DWriteGlyphRun.glyphIndices, helper.DWriteGlyphRun.glyphAdvances, helper.DWriteGlyphRun.glyphOffsets);
+
+        for (int i = 0; i < _countof(clusterMapIndices); ++i)
+            Assert::AreEqual(static_cast<uint16_t>(clusterMapIndices[i]), helper.DWriteGlyphRunDescription.clusterMap[i]);
+
+        Assert::AreEqual(9u, helper.DWriteGlyphRunDescription.stringLength);
+        Assert::AreEqual(L"123456789", helper.DWriteGlyphRunDescription.string);
+        Assert::AreEqual(L"xa-yb", helper.DWriteGlyphRunDescription.localeName);
+        Assert::AreEqual(45u, helper.DWriteGlyphRunDescription.textPosition);
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_WithoutClusterMap_HasNullClusterMap)
+    {
+        Fixture f;
+
+        auto glyphs = MakeGlyphs(2);
+
+        DrawGlyphRunHelper helper(f.FontFace.Get(), 12.0f, 2, glyphs.data(), false, 0, CanvasTextMeasuringMode::Natural);
+
+        Assert::IsNull(helper.DWriteGlyphRunDescription.clusterMap);
+        Assert::AreEqual(0u, helper.DWriteGlyphRunDescription.stringLength);
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_ReusesScratchBuffersBetweenRuns)
+    {
+        Fixture f;
+
+        auto glyphs = MakeGlyphs(100);
+
+        uint16_t const* firstIndices;
+        {
+            DrawGlyphRunHelper helper(f.FontFace.Get(), 12.0f, 100, glyphs.data(), false, 0, CanvasTextMeasuringMode::Natural);
+            firstIndices = helper.DWriteGlyphRun.glyphIndices;
+        }
+
+        DrawGlyphRunHelper helper(f.FontFace.Get(), 12.0f, 50, glyphs.data(), false, 0, CanvasTextMeasuringMode::Natural);
+        Assert::IsTrue(firstIndices == helper.DWriteGlyphRun.glyphIndices);
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunHelper_WithDWriteLayout_RefersToCallersArrays)
+    {
+        Fixture f;
+
+        uint16_t indices[] = { 1, 2, 3 };
+        float advances[] = { 4, 5, 6 };
+        DWRITE_GLYPH_OFFSET offsets[] = { { 7, 8 }, { 9, 10 }, { 11, 12 } };
+
+        DrawGlyphRunHelper helper(
+            f.FontFace.Get(),
+            10.0f,
+            3,
+            indices,
+            advances,
+            offsets,
+            false,
+            1,
+            f.Brush.Get(),
+            DWRITE_MEASURING_MODE_GDI_NATURAL,
+            nullptr);
+
+        Assert::IsTrue(indices == helper.DWriteGlyphRun.glyphIndices);
+        Assert::IsTrue(advances == helper.DWriteGlyphRun.glyphAdvances);
+        Assert::IsTrue(offsets == helper.DWriteGlyphRun.glyphOffsets);
+        Assert::AreEqual(0u, helper.GlyphIndices.GetSize());
+        Assert::AreEqual(DWRITE_MEASURING_MODE_GDI_NATURAL, helper.MeasuringMode);
+        Assert::IsTrue(IsSameInstance(f.Brush->GetD2DBrush(nullptr, GetBrushFlags::None).Get(), helper.ClientDrawingEffect.Get()));
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunForICanvasDrawingSession_PassesArraysToD2D)
+    {
+        Fixture f;
+
+        uint16_t indices[] = { 1, 2 };
+        float advances[] = { 3, 4 };
+
+        f.DeviceContext->DrawGlyphRunMethod.SetExpectedCalls(1,
+            [&](D2D1_POINT_2F point, DWRITE_GLYPH_RUN const* glyphRun, DWRITE_GLYPH_RUN_DESCRIPTION const* description, ID2D1Brush* brush, DWRITE_MEASURING_MODE measuringMode)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 1, 2 }, point);
+                Assert::IsTrue(IsSameInstance(f.RealizedDWriteFontFace.Get(), glyphRun->fontFace));
+                Assert::AreEqual(2u, glyphRun->glyphCount);
+                Assert::IsTrue(indices == glyphRun->glyphIndices);
+                Assert::IsTrue(advances == glyphRun->glyphAdvances);
+                Assert::IsNull(glyphRun->glyphOffsets);
+                Assert::IsNull(description);
+                Assert::IsTrue(IsSameInstance(f.Brush->GetD2DBrush(nullptr, GetBrushFlags::None).Get(), brush));
+                Assert::AreEqual(DWRITE_MEASURING_MODE_NATURAL, measuringMode);
+            });
+
+        ThrowIfFailed(DrawGlyphRunForICanvasDrawingSession(
+            f.DrawingSession.Get(), Vector2{ 1, 2 }, f.FontFace.Get(), 16.0f, 2, indices, advances, nullptr, FALSE, 0, f.Brush.Get(), DWRITE_MEASURING_MODE_NATURAL));
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunForICanvasDrawingSession_NullArgs)
+    {
+        Fixture f;
+
+        uint16_t index = 1;
+
+        Assert::AreEqual(E_INVALIDARG, DrawGlyphRunForICanvasDrawingSession(nullptr, Vector2{}, f.FontFace.Get(), 16.0f, 1, &index, nullptr, nullptr, FALSE, 0, f.Brush.Get(), DWRITE_MEASURING_MODE_NATURAL));
+        Assert::AreEqual(E_INVALIDARG, DrawGlyphRunForICanvasDrawingSession(f.DrawingSession.Get(), Vector2{}, nullptr, 16.0f, 1, &index, nullptr, nullptr, FALSE, 0, f.Brush.Get(), DWRITE_MEASURING_MODE_NATURAL));
+        Assert::AreEqual(E_INVALIDARG, DrawGlyphRunForICanvasDrawingSession(f.DrawingSession.Get(), Vector2{}, f.FontFace.Get(), 16.0f, 1, nullptr, nullptr, nullptr, FALSE, 0, f.Brush.Get(), DWRITE_MEASURING_MODE_NATURAL));
+        Assert::AreEqual(E_INVALIDARG, DrawGlyphRunForICanvasDrawingSession(f.DrawingSession.Get(), Vector2{}, f.FontFace.Get(), 16.0f, 1, &index, nullptr, nullptr, FALSE, 0, nullptr, DWRITE_MEASURING_MODE_NATURAL));
+    }
+
+    TEST_METHOD_EX(DrawGlyphRunForICanvasDrawingSession_Closed)
+    {
+        Fixture f;
+
+        ThrowIfFailed(f.DrawingSession->Close());
+
+        uint16_t index = 1;
+
+        Assert::AreEqual(RO_E_CLOSED, DrawGlyphRunForICanvasDrawingSession(f.DrawingSession.Get(), Vector2{}, f.FontFace.Get(), 16.0f, 1, &index, nullptr, nullptr, FALSE, 0, f.Brush.Get(), DWRITE_MEASURING_MODE_NATURAL));
+    }
+};
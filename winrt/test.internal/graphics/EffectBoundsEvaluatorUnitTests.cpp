@@ -0,0 +1,236 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/effects/EffectBoundsEvaluator.h>
+#include <lib/effects/generated/BorderEffect.h>
+#include <lib/effects/generated/CompositeEffect.h>
+#include <lib/effects/generated/CropEffect.h>
+#include <lib/effects/generated/GaussianBlurEffect.h>
+#include <lib/effects/generated/Transform2DEffect.h>
+
+#include "stubs/TestEffect.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Effects;
+
+TEST_CLASS(EffectBoundsEvaluatorUnitTests)
+{
+public:
+    static ComPtr<IGraphicsEffectSource> MakeBitmap(float width, float height)
+    {
+        auto d2dBitmap = Make<StubD2DBitmap>();
+
+        d2dBitmap->GetSizeMethod.AllowAnyCall(
+            [=]
+            {
+                return D2D1_SIZE_F{ width, height };
+            });
+
+        return As<IGraphicsEffectSource>(CreateStubCanvasBitmap(nullptr, d2dBitmap.Get()));
+    }
+
+    static D2D1_RECT_F GetBounds(IGraphicsEffectSource* source)
+    {
+        EffectBoundsEvaluator evaluator;
+
+        D2D1_RECT_F bounds;
+        Assert::IsTrue(evaluator.TryGetBounds(source, &bounds));
+
+        return bounds;
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_BitmapReportsItsOwnSize)
+    {
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 100, 50 }, GetBounds(MakeBitmap(100, 50).Get()));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_Crop_IntersectsSourceRectangle)
+    {
+        auto crop = Make<CropEffect>();
+        ThrowIfFailed(crop->put_Source(MakeBitmap(100, 50).Get()));
+        ThrowIfFailed(crop->put_SourceRectangle(Rect{ 10, 20, 200, 10 }));
+
+        Assert::AreEqual(D2D1_RECT_F{ 10, 20, 100, 30 }, GetBounds(crop.Get()));
+
+        // The default crop rectangle is infinite.
+        auto defaultCrop = Make<CropEffect>();
+        ThrowIfFailed(defaultCrop->put_Source(MakeBitmap(100, 50).Get()));
+
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 100, 50 }, GetBounds(defaultCrop.Get()));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_Transform2D_TransformsSourceBounds)
+    {
+        auto transform = Make<Transform2DEffect>();
+        ThrowIfFailed(transform->put_Source(MakeBitmap(100, 50).Get()));
+        ThrowIfFailed(transform->put_TransformMatrix(Matrix3x2{ 2, 0, 0, 2, 10, 20 }));
+
+        Assert::AreEqual(D2D1_RECT_F{ 10, 20, 210, 120 }, GetBounds(transform.Get()));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_GaussianBlur_InflatesByThreeStandardDeviations)
+    {
+        auto blur = Make<GaussianBlurEffect>();
+        ThrowIfFailed(blur->put_Source(MakeBitmap(100, 50).Get()));
+        ThrowIfFailed(blur->put_BlurAmount(2));
+
+        Assert::AreEqual(D2D1_RECT_F{ -6, -6, 106, 56 }, GetBounds(blur.Get()));
+
+        ThrowIfFailed(blur->put_BorderMode(EffectBorderMode::Hard));
+
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 100, 50 }, GetBounds(blur.Get()));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_Border_IsInfinite)
+    {
+        auto border = Make<BorderEffect>();
+        ThrowIfFailed(border->put_Source(MakeBitmap(100, 50).Get()));
+
+        Assert::IsTrue(IsInfiniteRectangle(GetBounds(border.Get())));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_Composite_UnionsSources)
+    {
+        auto transform = Make<Transform2DEffect>();
+        ThrowIfFailed(transform->put_Source(MakeBitmap(10, 10).Get()));
+        ThrowIfFailed(transform->put_TransformMatrix(Matrix3x2{ 1, 0, 0, 1, 50, 60 }));
+
+        auto composite = Make<CompositeEffect>();
+
+        ComPtr<IVector<IGraphicsEffectSource*>> sources;
+        ThrowIfFailed(composite->get_Sources(&sources));
+        ThrowIfFailed(sources->Append(MakeBitmap(20, 30).Get()));
+        ThrowIfFailed(sources->Append(As<IGraphicsEffectSource>(transform).Get()));
+
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 60, 70 }, GetBounds(composite.Get()));
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_UnknownEffect_UsesFallbackForThatNodeOnly)
+    {
+        auto unknownEffect = Make<TestEffect>(CLSID_D2D1Morphology);
+
+        auto crop = Make<CropEffect>();
+        ThrowIfFailed(crop->put_Source(As<IGraphicsEffectSource>(unknownEffect).Get()));
+        ThrowIfFailed(crop->put_SourceRectangle(Rect{ 0, 0, 10, 10 }));
+
+        // Without a fallback, the graph can't be measured.
+        EffectBoundsEvaluator withoutFallback;
+        D2D1_RECT_F bounds;
+        Assert::IsFalse(withoutFallback.TryGetBounds(crop.Get(), &bounds));
+
+        std::vector<IGraphicsEffectSource*> fallbackSources;
+
+        EffectBoundsEvaluator withFallback(
+            [&] (IGraphicsEffectSource* source, D2D1_RECT_F* fallbackBounds)
+            {
+                fallbackSources.push_back(source);
+                *fallbackBounds = D2D1_RECT_F{ 5, 5, 20, 20 };
+                return true;
+            });
+
+        Assert::IsTrue(withFallback.TryGetBounds(crop.Get(), &bounds));
+        Assert::AreEqual(D2D1_RECT_F{ 5, 5, 10, 10 }, bounds);
+
+        Assert::AreEqual<size_t>(1, fallbackSources.size());
+        Assert::IsTrue(IsSameInstance(unknownEffect.Get(), fallbackSources[0]));
+        Assert::AreEqual(1u, withFallback.GetStatistics().FallbackCount);
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_SharedNodesAreEvaluatedOnce)
+    {
+        auto bitmap = MakeBitmap(10, 10);
+
+        auto blur = Make<GaussianBlurEffect>();
+        ThrowIfFailed(blur->put_Source(bitmap.Get()));
+
+        auto composite = Make<CompositeEffect>();
+
+        ComPtr<IVector<IGraphicsEffectSource*>> sources;
+        ThrowIfFailed(composite->get_Sources(&sources));
+        ThrowIfFailed(sources->Append(As<IGraphicsEffectSource>(blur).Get()));
+        ThrowIfFailed(sources->Append(As<IGraphicsEffectSource>(blur).Get()));
+        ThrowIfFailed(sources->Append(bitmap.Get()));
+
+        EffectBoundsEvaluator evaluator;
+        D2D1_RECT_F bounds;
+        Assert::IsTrue(evaluator.TryGetBounds(composite.Get(), &bounds));
+
+        // composite, blur and bitmap.
+        Assert::AreEqual(3u, evaluator.GetStatistics().NodesEvaluated);
+    }
+
+    TEST_METHOD_EX(EffectBoundsEvaluator_MissingSource_Fails)
+    {
+        auto crop = Make<CropEffect>();
+
+        EffectBoundsEvaluator evaluator;
+        D2D1_RECT_F bounds;
+        Assert::IsFalse(evaluator.TryGetBounds(crop.Get(), &bounds));
+    }
+
+    TEST_METHOD_EX(CanvasImage_EstimateBounds_WhenEveryNodeHasARule_DoesNotUseD2D)
+    {
+        auto device = Make<StubCanvasDevice>();
+        device->GetResourceCreationDeviceContextMethod.SetExpectedCalls(0);
+
+        auto transform = Make<Transform2DEffect>();
+        ThrowIfFailed(transform->put_Source(MakeBitmap(100, 50).Get()));
+        ThrowIfFailed(transform->put_TransformMatrix(Matrix3x2{ 2, 0, 0, 2, 0, 0 }));
+
+        auto blur = Make<GaussianBlurEffect>();
+        ThrowIfFailed(blur->put_Source(As<IGraphicsEffectSource>(transform).Get()));
+        ThrowIfFailed(blur->put_BlurAmount(1));
+
+        auto factory = Make<CanvasImageFactory>();
+
+        Rect bounds;
+        ThrowIfFailed(factory->EstimateBounds(device.Get(), As<ICanvasImage>(blur).Get(), Identity3x2(), &bounds));
+        Assert::AreEqual(Rect{ -3, -3, 206, 106 }, bounds);
+
+        ThrowIfFailed(factory->EstimateBounds(device.Get(), As<ICanvasImage>(blur).Get(), Matrix3x2{ 1, 0, 0, 1, 10, 20 }, &bounds));
+        Assert::AreEqual(Rect{ 7, 17, 206, 106 }, bounds);
+    }
+
+    TEST_METHOD_EX(CanvasImage_EstimateBounds_NullArguments_Fail)
+    {
+        auto device = Make<StubCanvasDevice>();
+        auto factory = Make<CanvasImageFactory>();
+        auto crop = Make<CropEffect>();
+
+        Rect bounds;
+        Assert::AreEqual(E_INVALIDARG, factory->EstimateBounds(nullptr, As<ICanvasImage>(crop).Get(), Identity3x2(), &bounds));
+        Assert::AreEqual(E_INVALIDARG, factory->EstimateBounds(device.Get(), nullptr, Identity3x2(), &bounds));
+        Assert::AreEqual(E_INVALIDARG, factory->EstimateBounds(device.Get(), As<ICanvasImage>(crop).Get(), Identity3x2(), nullptr));
+    }
+
+    TEST_METHOD_EX(TryGetEffectGraphBounds_WithDrawingSessionUsingPixels_DefersToD2D)
+    {
+        auto device = Make<StubCanvasDevice>();
+        auto deviceContext = Make<StubD2DDeviceContextWithGetFactory>();
+        auto drawingSession = CanvasDrawingSession::CreateNew(deviceContext.Get(), std::make_shared<StubCanvasDrawingSessionAdapter>(), device.Get());
+
+        auto crop = Make<CropEffect>();
+        ThrowIfFailed(crop->put_Source(MakeBitmap(100, 50).Get()));
+
+        Rect bounds;
+
+        deviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+        Assert::IsTrue(TryGetEffectGraphBounds(drawingSession.Get(), crop.Get(), Identity3x2(), &bounds));
+        Assert::AreEqual(Rect{ 0, 0, 100, 50 }, bounds);
+
+        deviceContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_PIXELS; });
+        Assert::IsFalse(TryGetEffectGraphBounds(drawingSession.Get(), crop.Get(), Identity3x2(), &bounds));
+    }
+
+    TEST_METHOD_EX(TryGetEffectGraphBounds_MissingSource_DefersToD2D)
+    {
+        auto device = Make<StubCanvasDevice>();
+
+        auto crop = Make<CropEffect>();
+
+        Rect bounds;
+        Assert::IsFalse(TryGetEffectGraphBounds(device.Get(), crop.Get(), Identity3x2(), &bounds));
+    }
+};
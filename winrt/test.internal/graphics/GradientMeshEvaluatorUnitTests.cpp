@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/drawing/GradientMeshEvaluator.h>
+
+// A patch whose control points are evenly spaced over a rectangle, so that
+// S(u, v) = (left + u * width, top + v * height).
+static D2D1_GRADIENT_MESH_PATCH MakeRectanglePatch(float left, float top, float width, float height)
+{
+    D2D1_GRADIENT_MESH_PATCH patch{};
+
+    D2D1_POINT_2F* points[4][4] =
+    {
+        { &patch.point00, &patch.point01, &patch.point02, &patch.point03 },
+        { &patch.point10, &patch.point11, &patch.point12, &patch.point13 },
+        { &patch.point20, &patch.point21, &patch.point22, &patch.point23 },
+        { &patch.point30, &patch.point31, &patch.point32, &patch.point33 },
+    };
+
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            *points[r][c] = D2D1_POINT_2F{ left + width * c / 3, top + height * r / 3 };
+        }
+    }
+
+    patch.color00 = D2D1_COLOR_F{ 1, 0, 0, 1 };
+    patch.color03 = D2D1_COLOR_F{ 0, 1, 0, 1 };
+    patch.color30 = D2D1_COLOR_F{ 0, 0, 1, 1 };
+    patch.color33 = D2D1_COLOR_F{ 1, 1, 1, 0 };
+
+    return patch;
+}
+
+// The rectangle patch with some of its interior points moved, without
+// folding the surface.
+static D2D1_GRADIENT_MESH_PATCH MakeCurvedPatch()
+{
+    auto patch = MakeRectanglePatch(0, 0, 90, 90);
+
+    patch.point11.x += 20;
+    patch.point12.x += 10;
+    patch.point21.y -= 15;
+
+    return patch;
+}
+
+static void AssertNear(float expected, float actual, float tolerance = 0.001f)
+{
+    Assert::IsTrue(fabsf(expected - actual) <= tolerance);
+}
+
+static void AssertNear(Vector2 expected, Vector2 actual, float tolerance = 0.001f)
+{
+    AssertNear(expected.X, actual.X, tolerance);
+    AssertNear(expected.Y, actual.Y, tolerance);
+}
+
+static void AssertNear(Vector4 expected, Vector4 actual, float tolerance = 0.001f)
+{
+    AssertNear(expected.X, actual.X, tolerance);
+    AssertNear(expected.Y, actual.Y, tolerance);
+    AssertNear(expected.Z, actual.Z, tolerance);
+    AssertNear(expected.W, actual.W, tolerance);
+}
+
+TEST_CLASS(GradientMeshEvaluatorTests)
+{
+    TEST_METHOD_EX(GradientMeshEvaluator_EvaluatePosition_CornersAreCornerPoints)
+    {
+        auto d2dPatch = MakeCurvedPatch();
+        GradientMeshEvaluator evaluator({ d2dPatch });
+
+        Assert::AreEqual(FromD2DPoint(d2dPatch.point00), evaluator.EvaluatePosition(0, 0, 0));
+        Assert::AreEqual(FromD2DPoint(d2dPatch.point03), evaluator.EvaluatePosition(0, 1, 0));
+        Assert::AreEqual(FromD2DPoint(d2dPatch.point30), evaluator.EvaluatePosition(0, 0, 1));
+        Assert::AreEqual(FromD2DPoint(d2dPatch.point33), evaluator.EvaluatePosition(0, 1, 1));
+
+        AssertNear(Vector2{ 25, 50 }, GradientMeshEvaluator({ MakeRectanglePatch(10, 20, 60, 40) }).EvaluatePosition(0, 0.25f, 0.75f));
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_EvaluateRow_MatchesEvaluatePosition)
+    {
+        GradientMeshEvaluator evaluator({ MakeCurvedPatch() });
+
+        // An odd count, to exercise the partial batch at the end.
+        float u[] = { 0, 0.1f, 0.25f, 0.4f, 0.5f, 0.8f, 1 };
+        uint32_t const count = _countof(u);
+
+        Vector2 positions[count];
+        evaluator.EvaluateRow(0, 0.3f, u, count, positions);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            AssertNear(evaluator.EvaluatePosition(0, u[i], 0.3f), positions[i]);
+        }
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_EvaluateColor_InterpolatesCornerColors)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(0, 0, 1, 1) });
+
+        Assert::AreEqual(Vector4{ 1, 0, 0, 1 }, evaluator.EvaluateColor(0, 0, 0));
+        Assert::AreEqual(Vector4{ 1, 1, 1, 0 }, evaluator.EvaluateColor(0, 1, 1));
+        Assert::AreEqual(Vector4{ 0.5f, 0.5f, 0.5f, 0.75f }, evaluator.EvaluateColor(0, 0.5f, 0.5f));
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_GetBounds)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(10, 20, 30, 40), MakeRectanglePatch(-5, 30, 10, 10) });
+
+        Assert::AreEqual(D2D1_RECT_F{ -5, 20, 40, 60 }, evaluator.GetBounds());
+
+        auto transform = D2D1::Matrix3x2F::Scale(2, 3) * D2D1::Matrix3x2F::Translation(1, 1);
+        Assert::AreEqual(D2D1_RECT_F{ -9, 61, 81, 181 }, evaluator.GetBounds(transform));
+
+        // Rotating by 90 degrees maps (x, y) to (-y, x).
+        auto rotation = D2D1::Matrix3x2F(0, 1, -1, 0, 0, 0);
+        Assert::AreEqual(D2D1_RECT_F{ -60, -5, -20, 40 }, evaluator.GetBounds(rotation));
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_GetBounds_WhenNoPatches_ReturnsEmptyBounds)
+    {
+        GradientMeshEvaluator evaluator({});
+
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 0, 0 }, evaluator.GetBounds());
+        Assert::AreEqual(D2D1_RECT_F{ 0, 0, 0, 0 }, evaluator.GetBounds(D2D1::Matrix3x2F::Translation(5, 5)));
+
+        auto tessellation = evaluator.Tessellate(D2D1_DEFAULT_FLATTENING_TOLERANCE);
+        Assert::AreEqual<size_t>(0, tessellation->Vertices.size());
+        Assert::AreEqual<size_t>(1, tessellation->PatchOffsets.size());
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_GetSegmentCounts_DependOnCurvatureAndTolerance)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(0, 0, 1000, 1000), MakeCurvedPatch() });
+
+        uint32_t uSegments, vSegments;
+
+        // Straight edges never need subdividing.
+        evaluator.GetSegmentCounts(0, 0.001f, &uSegments, &vSegments);
+        Assert::AreEqual(1u, uSegments);
+        Assert::AreEqual(1u, vSegments);
+
+        evaluator.GetSegmentCounts(1, 1.0f, &uSegments, &vSegments);
+        uint32_t coarseU = uSegments;
+        uint32_t coarseV = vSegments;
+        Assert::IsTrue(coarseU > 1);
+        Assert::IsTrue(coarseV > 1);
+
+        evaluator.GetSegmentCounts(1, 0.1f, &uSegments, &vSegments);
+        Assert::IsTrue(uSegments > coarseU);
+        Assert::IsTrue(vSegments > coarseV);
+
+        uint32_t maxSegments = GradientMeshEvaluator::MaxSegmentsPerPatch;
+
+        evaluator.GetSegmentCounts(1, 1e-9f, &uSegments, &vSegments);
+        Assert::AreEqual(maxSegments, uSegments);
+        Assert::AreEqual(maxSegments, vSegments);
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_Tessellate_RectanglePatchIsTwoTriangles)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(10, 20, 30, 40) });
+
+        auto tessellation = evaluator.Tessellate(D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tessellation->FlatteningTolerance);
+        Assert::AreEqual<size_t>(6, tessellation->Vertices.size());
+        Assert::AreEqual<size_t>(2, tessellation->PatchOffsets.size());
+        Assert::AreEqual(0u, tessellation->PatchOffsets[0]);
+        Assert::AreEqual(6u, tessellation->PatchOffsets[1]);
+
+        for (auto& vertex : tessellation->Vertices)
+        {
+            auto& uv = vertex.PatchCoordinates;
+
+            AssertNear(Vector2{ 10 + uv.X * 30, 20 + uv.Y * 40 }, vertex.Position);
+            AssertNear(evaluator.EvaluateColor(0, uv.X, uv.Y), vertex.Color);
+        }
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_Tessellate_VerticesAreOnTheSurface)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(0, 0, 10, 10), MakeCurvedPatch() });
+
+        auto tessellation = evaluator.Tessellate(0.5f);
+
+        uint32_t uSegments, vSegments;
+        evaluator.GetSegmentCounts(1, 0.5f, &uSegments, &vSegments);
+
+        Assert::AreEqual<size_t>(3, tessellation->PatchOffsets.size());
+        Assert::AreEqual(6u, tessellation->PatchOffsets[1]);
+        Assert::AreEqual<size_t>(6 + uSegments * vSegments * 6, tessellation->Vertices.size());
+
+        for (uint32_t i = 6; i < tessellation->Vertices.size(); ++i)
+        {
+            auto& vertex = tessellation->Vertices[i];
+            auto& uv = vertex.PatchCoordinates;
+
+            AssertNear(evaluator.EvaluatePosition(1, uv.X, uv.Y), vertex.Position);
+        }
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_HitTest_FindsPatchAndCoordinates)
+    {
+        GradientMeshEvaluator evaluator({ MakeRectanglePatch(0, 0, 100, 100), MakeRectanglePatch(50, 50, 100, 100) });
+        auto tessellation = evaluator.Tessellate(D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        uint32_t patchIndex;
+        Vector2 patchCoordinates;
+
+        Assert::IsTrue(evaluator.HitTest(*tessellation, Vector2{ 25, 75 }, &patchIndex, &patchCoordinates));
+        Assert::AreEqual(0u, patchIndex);
+        AssertNear(Vector2{ 0.25f, 0.75f }, patchCoordinates);
+
+        // Where the patches overlap the later one is on top.
+        Assert::IsTrue(evaluator.HitTest(*tessellation, Vector2{ 75, 60 }, &patchIndex, &patchCoordinates));
+        Assert::AreEqual(1u, patchIndex);
+        AssertNear(Vector2{ 0.25f, 0.1f }, patchCoordinates);
+
+        Assert::IsFalse(evaluator.HitTest(*tessellation, Vector2{ 125, 25 }, &patchIndex, &patchCoordinates));
+        Assert::IsFalse(evaluator.HitTest(*tessellation, Vector2{ -1, 50 }, &patchIndex, &patchCoordinates));
+    }
+
+    TEST_METHOD_EX(GradientMeshEvaluator_HitTest_RefinesCoordinatesOnCurvedPatches)
+    {
+        GradientMeshEvaluator evaluator({ MakeCurvedPatch() });
+
+        // A coarse tessellation is only good enough to find the patch; the
+        // coordinates come from the surface itself.
+        auto tessellation = evaluator.Tessellate(5.0f);
+
+        Vector2 expected[] = { { 0.3f, 0.6f }, { 0.5f, 0.5f }, { 0.9f, 0.15f } };
+
+        for (auto uv : expected)
+        {
+            auto point = evaluator.EvaluatePosition(0, uv.X, uv.Y);
+
+            uint32_t patchIndex;
+            Vector2 patchCoordinates;
+
+            Assert::IsTrue(evaluator.HitTest(*tessellation, point, &patchIndex, &patchCoordinates));
+            Assert::AreEqual(0u, patchIndex);
+            AssertNear(uv, patchCoordinates);
+        }
+    }
+};
@@ -0,0 +1,503 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/drawing/CanvasParallelFrame.h>
+#include <lib/drawing/ParallelFrame.h>
+#include <lib/images/CanvasCommandList.h>
+
+class CompositeTargetDrawingSession : public MockCanvasDrawingSession
+{
+public:
+    std::vector<ComPtr<ID2D1CommandList>> DrawnCommandLists;
+
+    IFACEMETHODIMP DrawImageAtOrigin(ICanvasImage* image) override
+    {
+        DrawnCommandLists.push_back(GetWrappedResource<ID2D1CommandList>(image));
+        return S_OK;
+    }
+};
+
+TEST_CLASS(ParallelFrameUnitTests)
+{
+public:
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+        {
+            Device->CreateCommandListMethod.AllowAnyCall(
+                []
+                {
+                    return Make<MockD2DCommandList>();
+                });
+        }
+    };
+
+    TEST_METHOD_EX(WorkStealingJobQueue_SingleWorkerTakesJobsInOrder)
+    {
+        WorkStealingJobQueue queue(1, 5);
+
+        uint32_t jobIndex;
+
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            Assert::IsTrue(queue.TryTakeJob(0, &jobIndex));
+            Assert::AreEqual(i, jobIndex);
+        }
+
+        Assert::IsFalse(queue.TryTakeJob(0, &jobIndex));
+    }
+
+    TEST_METHOD_EX(WorkStealingJobQueue_IdleWorkerStealsFromEndOfAnotherWorkersRange)
+    {
+        // Worker 0 starts with jobs 0-3, worker 1 with 4-7.
+        WorkStealingJobQueue queue(2, 8);
+
+        uint32_t jobIndex;
+
+        for (uint32_t i = 4; i < 8; ++i)
+        {
+            Assert::IsTrue(queue.TryTakeJob(1, &jobIndex));
+            Assert::AreEqual(i, jobIndex);
+        }
+
+        // Worker 1 has run out, so it takes the back half of worker 0's jobs.
+        Assert::IsTrue(queue.TryTakeJob(1, &jobIndex));
+        Assert::AreEqual(2u, jobIndex);
+
+        Assert::IsTrue(queue.TryTakeJob(0, &jobIndex));
+        Assert::AreEqual(0u, jobIndex);
+        Assert::IsTrue(queue.TryTakeJob(0, &jobIndex));
+        Assert::AreEqual(1u, jobIndex);
+
+        // Worker 0 now steals the last job back from worker 1.
+        Assert::IsTrue(queue.TryTakeJob(0, &jobIndex));
+        Assert::AreEqual(3u, jobIndex);
+
+        Assert::IsFalse(queue.TryTakeJob(0, &jobIndex));
+        Assert::IsFalse(queue.TryTakeJob(1, &jobIndex));
+    }
+
+    TEST_METHOD_EX(RunWorkStealingJobs_RunsEveryJobExactlyOnce)
+    {
+        uint32_t const jobCount = 1000;
+
+        std::vector<std::atomic<int>> runCounts(jobCount);
+
+        RunWorkStealingJobs(4, jobCount,
+            [&] (uint32_t workerIndex, uint32_t jobIndex)
+            {
+                Assert::IsTrue(workerIndex < 4);
+                runCounts[jobIndex]++;
+            });
+
+        for (auto& runCount : runCounts)
+        {
+            Assert::AreEqual(1, runCount.load());
+        }
+    }
+
+    TEST_METHOD_EX(RunWorkStealingJobs_RethrowsExceptionFromJob)
+    {
+        ExpectHResultException(E_ABORT,
+            [&]
+            {
+                RunWorkStealingJobs(4, 100,
+                    [&] (uint32_t, uint32_t jobIndex)
+                    {
+                        if (jobIndex == 42)
+                            ThrowHR(E_ABORT);
+                    });
+            });
+    }
+
+    TEST_METHOD_EX(ParallelFrame_ZeroParts_Fails)
+    {
+        Fixture f;
+
+        ExpectHResultException(E_INVALIDARG, [&] { ParallelFrame frame(f.Device.Get(), 0); });
+    }
+
+    TEST_METHOD_EX(ParallelFrame_EachPartHasItsOwnDeviceContext)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 3);
+
+        Assert::AreEqual(3u, frame.GetPartCount());
+
+        std::set<ID2D1DeviceContext1*> deviceContexts;
+
+        for (uint32_t i = 0; i < frame.GetPartCount(); ++i)
+        {
+            auto deviceContext = GetWrappedResource<ID2D1DeviceContext1>(frame.GetDrawingSession(i));
+            deviceContexts.insert(deviceContext.Get());
+        }
+
+        Assert::AreEqual<size_t>(3, deviceContexts.size());
+
+        ExpectHResultException(E_BOUNDS, [&] { frame.GetDrawingSession(3); });
+    }
+
+    TEST_METHOD_EX(ParallelFrame_RecordLayers_CallsEachLayerWithItsOwnDrawingSession)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 8);
+
+        std::vector<std::atomic<ICanvasDrawingSession*>> sessions(8);
+
+        frame.RecordLayers(
+            [&] (ICanvasDrawingSession* drawingSession, uint32_t layerIndex)
+            {
+                sessions[layerIndex] = drawingSession;
+            },
+            4);
+
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            Assert::IsTrue(IsSameInstance(frame.GetDrawingSession(i), sessions[i].load()));
+        }
+    }
+
+    TEST_METHOD_EX(ParallelFrame_RecordTiles_FailsWithEmptyTileSize)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 2);
+
+        ExpectHResultException(E_INVALIDARG,
+            [&]
+            {
+                frame.RecordTiles(Rect{ 0, 0, 100, 100 }, Size{ 0, 10 }, [] (ICanvasDrawingSession*, Rect const&) {});
+            });
+    }
+
+    TEST_METHOD_EX(ParallelFrame_RecordTiles_FailsWithNonFiniteBounds)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 2);
+
+        auto inf = std::numeric_limits<float>::infinity();
+        auto nan = std::numeric_limits<float>::quiet_NaN();
+
+        Rect badBounds[] =
+        {
+            Rect{ 0, 0, inf, 100 },
+            Rect{ 0, 0, 100, nan },
+            Rect{ -inf, 0, 100, 100 },
+            Rect{ 0, nan, 100, 100 },
+        };
+
+        for (auto& bounds : badBounds)
+        {
+            ExpectHResultException(E_INVALIDARG,
+                [&]
+                {
+                    frame.RecordTiles(bounds, Size{ 10, 10 }, [] (ICanvasDrawingSession*, Rect const&) { Assert::Fail(); });
+                });
+        }
+    }
+
+    TEST_METHOD_EX(ParallelFrame_RecordTiles_FailsWithTooManyTiles)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 2);
+
+        // Large enough that columns * rows would overflow uint32_t.
+        ExpectHResultException(E_INVALIDARG,
+            [&]
+            {
+                frame.RecordTiles(Rect{ 0, 0, 1e6f, 1e6f }, Size{ 0.001f, 0.001f }, [] (ICanvasDrawingSession*, Rect const&) { Assert::Fail(); });
+            });
+
+        // One more tile than is allowed.
+        ExpectHResultException(E_INVALIDARG,
+            [&]
+            {
+                frame.RecordTiles(Rect{ 0, 0, ParallelFrame::MaxTileCount + 1.0f, 1 }, Size{ 1, 1 }, [] (ICanvasDrawingSession*, Rect const&) { Assert::Fail(); });
+            });
+    }
+
+    TEST_METHOD_EX(ParallelFrame_RecordTiles_ClipsEachTileToWholePixels)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 1);
+
+        auto deviceContext = static_cast<MockD2DDeviceContext*>(GetWrappedResource<ID2D1DeviceContext1>(frame.GetDrawingSession(0)).Get());
+
+        std::vector<D2D1_RECT_F> clips;
+        int clipDepth = 0;
+
+        deviceContext->PushAxisAlignedClipMethod.SetExpectedCalls(2,
+            [&] (D2D1_RECT_F const* rect, D2D1_ANTIALIAS_MODE antialiasMode)
+            {
+                Assert::AreEqual(D2D1_ANTIALIAS_MODE_ALIASED, antialiasMode);
+                clips.push_back(*rect);
+                ++clipDepth;
+            });
+
+        deviceContext->PopAxisAlignedClipMethod.SetExpectedCalls(2,
+            [&]
+            {
+                --clipDepth;
+            });
+
+        std::vector<Rect> tiles;
+
+        frame.RecordTiles(Rect{ 0, 0, 20, 10 }, Size{ 10, 10 },
+            [&] (ICanvasDrawingSession*, Rect const& tile)
+            {
+                Assert::AreEqual(1, clipDepth);
+                tiles.push_back(tile);
+            });
+
+        Assert::AreEqual(0, clipDepth);
+        Assert::AreEqual<size_t>(2, tiles.size());
+
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            Assert::AreEqual(ToD2DRect(tiles[i]), clips[i]);
+        }
+    }
+
+    TEST_METHOD_EX(ParallelFrame_Composite_DrawsPartsInOrder)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 4);
+
+        std::vector<ComPtr<ID2D1Image>> expectedCommandLists;
+
+        for (uint32_t i = 0; i < frame.GetPartCount(); ++i)
+        {
+            auto deviceContext = GetWrappedResource<ID2D1DeviceContext1>(frame.GetDrawingSession(i));
+
+            ComPtr<ID2D1Image> target;
+            deviceContext->GetTarget(&target);
+            expectedCommandLists.push_back(target);
+        }
+
+        auto targetDrawingSession = Make<CompositeTargetDrawingSession>();
+
+        frame.Composite(targetDrawingSession.Get());
+
+        Assert::AreEqual<size_t>(4, targetDrawingSession->DrawnCommandLists.size());
+
+        for (size_t i = 0; i < expectedCommandLists.size(); ++i)
+        {
+            Assert::IsTrue(IsSameInstance(expectedCommandLists[i].Get(), targetDrawingSession->DrawnCommandLists[i].Get()));
+        }
+    }
+
+    TEST_METHOD_EX(ParallelFrame_AfterComposite_DrawingSessionsAreClosed)
+    {
+        Fixture f;
+
+        ParallelFrame frame(f.Device.Get(), 2);
+
+        auto targetDrawingSession = Make<CompositeTargetDrawingSession>();
+        frame.Composite(targetDrawingSession.Get());
+
+        ExpectHResultException(RO_E_CLOSED, [&] { frame.GetDrawingSession(0); });
+        ExpectHResultException(RO_E_CLOSED, [&] { frame.Composite(targetDrawingSession.Get()); });
+    }
+};
+
+TEST_CLASS(CanvasParallelFrameUnitTests)
+{
+public:
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasParallelFrameFactory> Factory;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , Factory(Make<CanvasParallelFrameFactory>())
+        {
+            Device->CreateCommandListMethod.AllowAnyCall(
+                []
+                {
+                    return Make<MockD2DCommandList>();
+                });
+        }
+
+        ComPtr<ICanvasParallelFrame> Create(int32_t partCount)
+        {
+            ComPtr<ICanvasParallelFrame> frame;
+            ThrowIfFailed(Factory->Create(Device.Get(), partCount, &frame));
+            return frame;
+        }
+    };
+
+    TEST_METHOD_EX(CanvasParallelFrame_ImplementsExpectedInterfaces)
+    {
+        Fixture f;
+
+        auto frame = f.Create(2);
+
+        ASSERT_IMPLEMENTS_INTERFACE(frame, ICanvasParallelFrame);
+        ASSERT_IMPLEMENTS_INTERFACE(frame, IClosable);
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_Create_WithInvalidArguments_Fails)
+    {
+        Fixture f;
+
+        ComPtr<ICanvasParallelFrame> frame;
+
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(nullptr, 2, &frame));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(f.Device.Get(), 0, &frame));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(f.Device.Get(), -1, &frame));
+        Assert::AreEqual(E_INVALIDARG, f.Factory->Create(f.Device.Get(), 2, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_GetDrawingSession_ReturnsEachPart)
+    {
+        Fixture f;
+
+        auto frame = f.Create(3);
+
+        int32_t partCount;
+        ThrowIfFailed(frame->get_PartCount(&partCount));
+        Assert::AreEqual(3, partCount);
+
+        std::set<ID2D1DeviceContext1*> deviceContexts;
+
+        for (int32_t i = 0; i < partCount; ++i)
+        {
+            ComPtr<ICanvasDrawingSession> drawingSession;
+            ThrowIfFailed(frame->GetDrawingSession(i, &drawingSession));
+
+            deviceContexts.insert(GetWrappedResource<ID2D1DeviceContext1>(drawingSession).Get());
+        }
+
+        Assert::AreEqual<size_t>(3, deviceContexts.size());
+
+        ComPtr<ICanvasDrawingSession> drawingSession;
+        Assert::AreEqual(E_BOUNDS, frame->GetDrawingSession(-1, &drawingSession));
+        Assert::AreEqual(E_BOUNDS, frame->GetDrawingSession(3, &drawingSession));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_RecordLayers_CallsHandlerForEachPart)
+    {
+        Fixture f;
+
+        auto frame = f.Create(4);
+
+        std::vector<std::atomic<ICanvasDrawingSession*>> sessions(4);
+
+        auto handler = Callback<ICanvasParallelFrameLayerHandler>(
+            [&] (ICanvasDrawingSession* drawingSession, int32_t layerIndex)
+            {
+                sessions[layerIndex] = drawingSession;
+                return S_OK;
+            });
+
+        ThrowIfFailed(frame->RecordLayers(handler.Get()));
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            ComPtr<ICanvasDrawingSession> drawingSession;
+            ThrowIfFailed(frame->GetDrawingSession(i, &drawingSession));
+
+            Assert::IsTrue(IsSameInstance(drawingSession.Get(), sessions[i].load()));
+        }
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_RecordLayers_ReturnsErrorFromHandler)
+    {
+        Fixture f;
+
+        auto frame = f.Create(2);
+
+        auto handler = Callback<ICanvasParallelFrameLayerHandler>(
+            [] (ICanvasDrawingSession*, int32_t)
+            {
+                return E_NOTIMPL;
+            });
+
+        Assert::AreEqual(E_NOTIMPL, frame->RecordLayers(handler.Get()));
+        Assert::AreEqual(E_INVALIDARG, frame->RecordLayers(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_RecordTiles_WithInvalidArguments_Fails)
+    {
+        Fixture f;
+
+        auto frame = f.Create(2);
+
+        auto handler = Callback<ICanvasParallelFrameTileHandler>(
+            [] (ICanvasDrawingSession*, Rect)
+            {
+                Assert::Fail();
+                return S_OK;
+            });
+
+        Assert::AreEqual(E_INVALIDARG, frame->RecordTiles(Rect{ 0, 0, 100, 100 }, Size{ 0, 10 }, handler.Get()));
+        Assert::AreEqual(E_INVALIDARG, frame->RecordTiles(Rect{ 0, 0, 100, 100 }, Size{ 10, 10 }, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_Composite_DrawsEachPart)
+    {
+        Fixture f;
+
+        auto frame = f.Create(3);
+
+        auto targetDrawingSession = Make<CompositeTargetDrawingSession>();
+
+        ThrowIfFailed(frame->Composite(targetDrawingSession.Get()));
+
+        Assert::AreEqual<size_t>(3, targetDrawingSession->DrawnCommandLists.size());
+        Assert::AreEqual(E_INVALIDARG, frame->Composite(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_CloseDuringRecordLayers_LetsTheRecordingFinish)
+    {
+        Fixture f;
+
+        auto frame = f.Create(2);
+
+        auto handler = Callback<ICanvasParallelFrameLayerHandler>(
+            [&] (ICanvasDrawingSession* drawingSession, int32_t)
+            {
+                ThrowIfFailed(As<IClosable>(frame)->Close());
+
+                // The frame is still alive, so its drawing sessions haven't
+                // been closed.
+                Assert::IsNotNull(GetWrappedResource<ID2D1DeviceContext1>(drawingSession).Get());
+                return S_OK;
+            });
+
+        ThrowIfFailed(frame->RecordLayers(handler.Get()));
+
+        int32_t partCount;
+        Assert::AreEqual(RO_E_CLOSED, frame->get_PartCount(&partCount));
+    }
+
+    TEST_METHOD_EX(CanvasParallelFrame_Closed_ReturnsRoErrorClosed)
+    {
+        Fixture f;
+
+        auto frame = f.Create(2);
+
+        ThrowIfFailed(As<IClosable>(frame)->Close());
+
+        int32_t partCount;
+        ComPtr<ICanvasDrawingSession> drawingSession;
+        auto targetDrawingSession = Make<CompositeTargetDrawingSession>();
+
+        Assert::AreEqual(RO_E_CLOSED, frame->get_PartCount(&partCount));
+        Assert::AreEqual(RO_E_CLOSED, frame->GetDrawingSession(0, &drawingSession));
+        Assert::AreEqual(RO_E_CLOSED, frame->Composite(targetDrawingSession.Get()));
+    }
+};
@@ -82,9 +82,11 @@ TEST_CLASS(PixelShaderEffectUnitTests)
         ComPtr<MockD2DEffect> MockEffect;
 
         std::vector<std::vector<BYTE>> EffectPropertyValues;
+        int ConstantsSetCount;
 
 
         Fixture()
+            : ConstantsSetCount(0)
         {
             Factory = Make<MockD2DFactory>();
             StubDevice = Make<StubD2DDevice>(Factory.Get());
@@ -115,6 +117,10 @@ TEST_CLASS(PixelShaderEffectUnitTests)
                     EffectPropertyValues.resize(index + 1);
 
                 EffectPropertyValues[index].assign(data, data + dataSize);
+
+                if (index == (int)PixelShaderEffectProperty::Constants)
+                    ConstantsSetCount++;
+
                 return S_OK;
             };
 
@@ -273,6 +279,180 @@ TEST_CLASS(PixelShaderEffectUnitTests)
     }
 
 
+    static ComPtr<PixelShaderEffect> MakeEffectWithTwoIntProperties()
+    {
+        D3D11_SHADER_VARIABLE_DESC variableDescA = { "a", 0, sizeof(int) };
+        D3D11_SHADER_VARIABLE_DESC variableDescB = { "b", sizeof(int), sizeof(int) };
+        D3D11_SHADER_TYPE_DESC variableType = { D3D_SVC_SCALAR, D3D_SVT_INT, 1, 1 };
+
+        ShaderDescription desc;
+        desc.Variables.push_back(ShaderVariable(variableDescA, variableType));
+        desc.Variables.push_back(ShaderVariable(variableDescB, variableType));
+
+        auto sharedState = MakeSharedShaderState(desc, std::vector<BYTE>(sizeof(int) * 2));
+
+        return Make<PixelShaderEffect>(nullptr, nullptr, sharedState.Get());
+    }
+
+
+    TEST_METHOD_EX(PixelShaderEffect_PropertyHandleChangesArePassedThroughToD2D)
+    {
+        Fixture f;
+
+        auto effect = MakeEffectWithTwoIntProperties();
+
+        int handleA, handleB;
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"a").Get(), &handleA));
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"b").Get(), &handleB));
+        Assert::AreNotEqual(handleA, handleB);
+
+        ThrowIfFailed(effect->SetIntProperty(handleB, 3));
+
+        // Realize the effect.
+        effect->GetD2DImage(f.CanvasDevice.Get(), f.DeviceContext.Get(), WIN2D_GET_D2D_IMAGE_FLAGS_NONE, 0, nullptr);
+
+        auto& d2dConstants = f.GetEffectPropertyValue<int[2]>(PixelShaderEffectProperty::Constants);
+        Assert::AreEqual(0, d2dConstants[0]);
+        Assert::AreEqual(3, d2dConstants[1]);
+
+        // Changes made through a handle are passed along to D2D straight away.
+        ThrowIfFailed(effect->SetIntProperty(handleA, 5));
+        Assert::AreEqual(5, d2dConstants[0]);
+
+        // They are also visible through the Properties collection.
+        ComPtr<IMap<HSTRING, IInspectable*>> properties;
+        ThrowIfFailed(effect->get_Properties(&properties));
+
+        ComPtr<IInspectable> value;
+        ThrowIfFailed(properties->Lookup(HStringReference(L"a").Get(), &value));
+
+        int unboxed;
+        ThrowIfFailed(As<IReference<int>>(value)->get_Value(&unboxed));
+        Assert::AreEqual(5, unboxed);
+    }
+
+
+    TEST_METHOD_EX(PixelShaderEffect_PropertyHandleErrors)
+    {
+        auto effect = MakeEffectWithTwoIntProperties();
+
+        int handle;
+        Assert::AreEqual(E_INVALIDARG, effect->GetPropertyHandle(HStringReference(L"c").Get(), &handle));
+        Assert::AreEqual(E_POINTER, effect->GetPropertyHandle(HStringReference(L"a").Get(), nullptr));
+
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"a").Get(), &handle));
+
+        // The value type must match the shader variable.
+        Assert::AreEqual(E_INVALIDARG, effect->SetFloatProperty(handle, 1.0f));
+        Assert::AreEqual(E_INVALIDARG, effect->SetBoolProperty(handle, true));
+        Assert::AreEqual(E_INVALIDARG, effect->SetVector2Property(handle, Vector2{ 1, 2 }));
+
+        // Handles must be in range.
+        Assert::AreEqual(E_INVALIDARG, effect->SetIntProperty(-1, 1));
+        Assert::AreEqual(E_INVALIDARG, effect->SetIntProperty(2, 1));
+
+        effect->Close();
+
+        Assert::AreEqual(RO_E_CLOSED, effect->GetPropertyHandle(HStringReference(L"a").Get(), &handle));
+        Assert::AreEqual(RO_E_CLOSED, effect->SetIntProperty(handle, 1));
+
+        ComPtr<IPixelShaderEffectPropertyUpdateScope> scope;
+        Assert::AreEqual(RO_E_CLOSED, effect->BeginPropertyUpdates(&scope));
+    }
+
+
+    TEST_METHOD_EX(PixelShaderEffect_PropertyUpdateScope_PassesConstantsToD2DOnceWhenClosed)
+    {
+        Fixture f;
+
+        auto effect = MakeEffectWithTwoIntProperties();
+
+        effect->GetD2DImage(f.CanvasDevice.Get(), f.DeviceContext.Get(), WIN2D_GET_D2D_IMAGE_FLAGS_NONE, 0, nullptr);
+
+        int handleA, handleB;
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"a").Get(), &handleA));
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"b").Get(), &handleB));
+
+        ComPtr<IMap<HSTRING, IInspectable*>> properties;
+        ThrowIfFailed(effect->get_Properties(&properties));
+
+        auto setCount = f.ConstantsSetCount;
+
+        ComPtr<IPixelShaderEffectPropertyUpdateScope> outerScope;
+        ComPtr<IPixelShaderEffectPropertyUpdateScope> innerScope;
+        ThrowIfFailed(effect->BeginPropertyUpdates(&outerScope));
+        ThrowIfFailed(effect->BeginPropertyUpdates(&innerScope));
+
+        // Changes made through handles and through the Properties collection are both held back.
+        ThrowIfFailed(effect->SetIntProperty(handleA, 3));
+
+        boolean replaced;
+        ThrowIfFailed(properties->Insert(HStringReference(L"b").Get(), Make<Nullable<int>>(5).Get(), &replaced));
+
+        Assert::AreEqual(setCount, f.ConstantsSetCount);
+
+        // Closing the inner scope doesn't end the update.
+        ThrowIfFailed(As<IClosable>(innerScope)->Close());
+        Assert::AreEqual(setCount, f.ConstantsSetCount);
+
+        // Closing the outer one passes the constants along.
+        ThrowIfFailed(As<IClosable>(outerScope)->Close());
+        Assert::AreEqual(setCount + 1, f.ConstantsSetCount);
+
+        auto& d2dConstants = f.GetEffectPropertyValue<int[2]>(PixelShaderEffectProperty::Constants);
+        Assert::AreEqual(3, d2dConstants[0]);
+        Assert::AreEqual(5, d2dConstants[1]);
+
+        // Closing a scope again does nothing.
+        ThrowIfFailed(As<IClosable>(outerScope)->Close());
+        Assert::AreEqual(setCount + 1, f.ConstantsSetCount);
+
+        // A scope with no changes doesn't pass anything along.
+        ThrowIfFailed(effect->BeginPropertyUpdates(&outerScope));
+        ThrowIfFailed(As<IClosable>(outerScope)->Close());
+        Assert::AreEqual(setCount + 1, f.ConstantsSetCount);
+
+        // Outside a scope, changes go straight through again.
+        ThrowIfFailed(effect->SetIntProperty(handleB, 7));
+        Assert::AreEqual(setCount + 2, f.ConstantsSetCount);
+        Assert::AreEqual(7, d2dConstants[1]);
+    }
+
+
+    TEST_METHOD_EX(PixelShaderEffect_PropertyUpdateScope_ReleasedWithoutClosing_EndsTheUpdate)
+    {
+        Fixture f;
+
+        auto effect = MakeEffectWithTwoIntProperties();
+
+        effect->GetD2DImage(f.CanvasDevice.Get(), f.DeviceContext.Get(), WIN2D_GET_D2D_IMAGE_FLAGS_NONE, 0, nullptr);
+
+        int handleA;
+        ThrowIfFailed(effect->GetPropertyHandle(HStringReference(L"a").Get(), &handleA));
+
+        auto setCount = f.ConstantsSetCount;
+
+        ComPtr<IPixelShaderEffectPropertyUpdateScope> scope;
+        ThrowIfFailed(effect->BeginPropertyUpdates(&scope));
+
+        ThrowIfFailed(effect->SetIntProperty(handleA, 3));
+        Assert::AreEqual(setCount, f.ConstantsSetCount);
+
+        // Dropping the scope, eg. because of a missing using statement, ends
+        // the update just as Close would have.
+        scope.Reset();
+        Assert::AreEqual(setCount + 1, f.ConstantsSetCount);
+
+        auto& d2dConstants = f.GetEffectPropertyValue<int[2]>(PixelShaderEffectProperty::Constants);
+        Assert::AreEqual(3, d2dConstants[0]);
+
+        // Later changes flow straight through again.
+        ThrowIfFailed(effect->SetIntProperty(handleA, 4));
+        Assert::AreEqual(setCount + 2, f.ConstantsSetCount);
+        Assert::AreEqual(4, d2dConstants[0]);
+    }
+
+
     TEST_METHOD_EX(PixelShaderEffect_CoordinateMappingChangesArePassedThroughToD2D)
     {
         Fixture f;
@@ -724,6 +904,13 @@ public:
         mockDrawInfo->SetPixelShaderConstantBufferMethod.SetExpectedCalls(1, validateConstants);
 
         ThrowIfFailed(impl->PrepareForRender(D2D1_CHANGE_TYPE_NONE));
+
+        Expectations::Instance()->Validate();
+
+        // Setting the same constants again, then drawing, should not pass them through a second time.
+        ThrowIfFailed(binding.setFunction(impl.Get(), constants.data(), static_cast<unsigned>(constants.size())));
+
+        ThrowIfFailed(impl->PrepareForRender(D2D1_CHANGE_TYPE_NONE));
     }
 
 
@@ -1037,6 +1224,57 @@ public:
     }
 
 
+    TEST_METHOD_EX(PixelShaderTransform_SetConstants_SkipsUnchangedBuffers)
+    {
+        ShaderDescription desc;
+        auto sharedState = MakeSharedShaderState(desc);
+        auto transform = Make<PixelShaderTransform>(sharedState.Get(), std::make_shared<CoordinateMappingState>());
+
+        auto mockDrawInfo = Make<MockD2DDrawInfo>();
+        mockDrawInfo->SetPixelShaderMethod.AllowAnyCall();
+        mockDrawInfo->SetInstructionCountHintMethod.AllowAnyCall();
+
+        ThrowIfFailed(transform->SetDrawInfo(mockDrawInfo.Get()));
+
+        std::vector<BYTE> keyframe1 = { 1, 2, 3, 4 };
+        std::vector<BYTE> keyframe2 = { 1, 2, 3, 5 };
+
+        // The first buffer is always passed to D2D.
+        mockDrawInfo->SetPixelShaderConstantBufferMethod.SetExpectedCalls(1);
+        transform->SetConstants(keyframe1);
+        Expectations::Instance()->Validate();
+
+        // The same values again are skipped.
+        transform->SetConstants(keyframe1);
+        transform->SetConstants(std::vector<BYTE>(keyframe1));
+
+        Assert::AreEqual(1u, transform->GetConstantUploadCount());
+        Assert::AreEqual(2u, transform->GetSkippedConstantUploadCount());
+
+        // Changes are passed on, including going back to earlier values.
+        mockDrawInfo->SetPixelShaderConstantBufferMethod.SetExpectedCalls(2);
+        transform->SetConstants(keyframe2);
+        transform->SetConstants(keyframe1);
+        Expectations::Instance()->Validate();
+
+        Assert::AreEqual(3u, transform->GetConstantUploadCount());
+        Assert::AreEqual(2u, transform->GetSkippedConstantUploadCount());
+
+        // A new draw info hasn't seen any constants, so the next buffer is passed on even if unchanged.
+        auto otherDrawInfo = Make<MockD2DDrawInfo>();
+        otherDrawInfo->SetPixelShaderMethod.AllowAnyCall();
+        otherDrawInfo->SetInstructionCountHintMethod.AllowAnyCall();
+
+        ThrowIfFailed(transform->SetDrawInfo(otherDrawInfo.Get()));
+
+        otherDrawInfo->SetPixelShaderConstantBufferMethod.SetExpectedCalls(1);
+        transform->SetConstants(keyframe1);
+        Expectations::Instance()->Validate();
+
+        Assert::AreEqual(4u, transform->GetConstantUploadCount());
+    }
+
+
     TEST_METHOD_EX(PixelShaderTransform_MapInputRectsToOutputRect)
     {
         auto transform = Make<PixelShaderTransform>(nullptr, std::make_shared<CoordinateMappingState>());
@@ -1441,6 +1679,53 @@ TEST_CLASS(SharedShaderStateUnitTests)
     };
 
 
+    TEST_METHOD_EX(PreloadedShaderCache_TryClone)
+    {
+        auto cache = PreloadedShaderCache::GetInstance();
+
+        auto preloadedState = Make<SharedShaderState>(compiledShader1.data(), static_cast<unsigned>(compiledShader1.size()));
+        cache->Add(preloadedState.Get());
+
+        auto clone = cache->TryClone(compiledShader1.data(), static_cast<uint32_t>(compiledShader1.size()));
+
+        Assert::IsNotNull(clone.Get());
+        Assert::AreEqual(preloadedState->Shader().Hash, clone->Shader().Hash);
+        Assert::AreNotEqual<void const*>(&preloadedState->Shader(), &clone->Shader());
+        Assert::AreNotEqual<void const*>(&preloadedState->Constants(), &clone->Constants());
+
+        Assert::IsNull(cache->TryClone(compiledShader2.data(), static_cast<uint32_t>(compiledShader2.size())).Get());
+        Assert::IsNull(cache->TryClone(compiledShader1.data(), static_cast<uint32_t>(compiledShader1.size() - 1)).Get());
+    };
+
+
+    TEST_METHOD_EX(PreloadedShaderCache_Add_IgnoresShadersThatAreAlreadyPreloaded)
+    {
+        auto cache = PreloadedShaderCache::GetInstance();
+
+        auto state1a = Make<SharedShaderState>(compiledShader1.data(), static_cast<unsigned>(compiledShader1.size()));
+        auto state1b = Make<SharedShaderState>(compiledShader1.data(), static_cast<unsigned>(compiledShader1.size()));
+        auto state2 = Make<SharedShaderState>(compiledShader2.data(), static_cast<unsigned>(compiledShader2.size()));
+
+        Assert::IsTrue(cache->Add(state1a.Get()));
+        Assert::IsFalse(cache->Add(state1b.Get()));
+        Assert::IsTrue(cache->Add(state2.Get()));
+
+        // The duplicate was not kept.
+        state1b->AddRef();
+        Assert::AreEqual(1ul, state1b->Release());
+    };
+
+
+    TEST_METHOD_EX(PreloadedShaderCache_TryGetInstance_DoesNotCreateTheCache)
+    {
+        Assert::IsNull(PreloadedShaderCache::TryGetInstance().get());
+
+        auto cache = PreloadedShaderCache::GetInstance();
+
+        Assert::AreEqual(cache.get(), PreloadedShaderCache::TryGetInstance().get());
+    };
+
+
     TEST_METHOD_EX(SharedShaderState_ShaderReflection)
     {
         auto state = Make<SharedShaderState>(compiledShader1.data(), static_cast<unsigned>(compiledShader1.size()));
@@ -1616,4 +1901,54 @@ TEST_CLASS(SharedShaderStateUnitTests)
         Assert::AreEqual(4, constants->icols[12]);
         Assert::AreEqual(8, constants->icols[13]);
     };
+
+
+    TEST_METHOD_EX(SharedShaderState_SetPropertyByIndex)
+    {
+        auto state = Make<SharedShaderState>(compiledShader1.data(), static_cast<unsigned>(compiledShader1.size()));
+
+        auto constants = state->Constants().data();
+
+        auto f = state->GetPropertyIndex(HStringReference(L"f").Get());
+        auto i = state->GetPropertyIndex(HStringReference(L"i").Get());
+        auto b = state->GetPropertyIndex(HStringReference(L"b").Get());
+        auto cols = state->GetPropertyIndex(HStringReference(L"cols").Get());
+
+        Assert::AreEqual(L"cols", static_cast<wchar_t const*>(state->Shader().Variables[cols].Name));
+
+        // Scalar properties.
+        state->SetProperty(f, 2.0f);
+        Assert::AreEqual(2.0f, *reinterpret_cast<float const*>(constants));
+
+        state->SetProperty(i, 3);
+        Assert::AreEqual(3, *reinterpret_cast<int const*>(constants + 4));
+
+        state->SetProperty(b, static_cast<boolean>(true));
+        Assert::AreEqual(1, *reinterpret_cast<int const*>(constants + 8));
+
+        // Matrices use the same layout as when set from a boxed value.
+        Matrix4x4 floatMatrix = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+        state->SetProperty(cols, floatMatrix);
+
+        auto colsConstants = reinterpret_cast<float const*>(constants + 80);
+
+        Assert::AreEqual(1.0f, colsConstants[0]);
+        Assert::AreEqual(5.0f, colsConstants[1]);
+        Assert::AreEqual(2.0f, colsConstants[4]);
+        Assert::AreEqual(16.0f, colsConstants[15]);
+
+        // Mismatched types and out of range indices are rejected.
+        ExpectHResultException(E_INVALIDARG, [&] { state->SetProperty(f, 1); });
+        ExpectHResultException(E_INVALIDARG, [&] { state->SetProperty(cols, Vector4{}); });
+        ExpectHResultException(E_INVALIDARG, [&] { state->SetProperty(state->GetPropertyCount(), 1.0f); });
+        ExpectHResultException(E_INVALIDARG, [&] { state->GetPropertyIndex(HStringReference(L"x").Get()); });
+
+        // Clones keep the same variable order.
+        auto clone = state->Clone();
+
+        clone->SetProperty(i, 9);
+        Assert::AreEqual(9, *reinterpret_cast<int const*>(clone->Constants().data() + 4));
+        Assert::AreEqual(3, *reinterpret_cast<int const*>(constants + 4));
+    };
 };
@@ -0,0 +1,474 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/brushes/CanvasLinearGradientBrush.h>
+#include <lib/drawing/ResourceRecreationRegistry.h>
+#include <lib/effects/EffectTransferTable3D.h>
+
+using namespace ABI::Microsoft::Graphics::Canvas::Brushes;
+
+class FakeRecreatableResource : public RuntimeClass<
+    RuntimeClassFlags<WinRtClassicComMix>,
+    ABI::Windows::Foundation::IClosable,
+    CloakedIid<ICanvasResourceRecreatable>>
+{
+    InspectableClass(L"FakeRecreatableResource", BaseTrust);
+
+public:
+    bool IsClosed = false;
+    ComPtr<ICanvasDevice> Device;
+    ComPtr<IUnknown> Resource;
+    std::function<void()> OnSwitchToDevice;
+
+    IFACEMETHODIMP Close() override
+    {
+        IsClosed = true;
+        return S_OK;
+    }
+
+    virtual bool IsRecreatable() override
+    {
+        return !IsClosed;
+    }
+
+    virtual ComPtr<IUnknown> SwitchToDevice(ICanvasDevice* newDevice, IUnknown* newResource) override
+    {
+        if (OnSwitchToDevice)
+            OnSwitchToDevice();
+
+        Device = newDevice;
+
+        auto oldResource = Resource;
+        Resource = newResource;
+        return oldResource;
+    }
+};
+
+// Tracks how many locks are held on a device.
+class FakeCanvasLock : public RuntimeClass<ICanvasLock, ABI::Windows::Foundation::IClosable>
+{
+    InspectableClass(L"FakeCanvasLock", BaseTrust);
+
+    std::shared_ptr<int> m_lockCount;
+
+public:
+    FakeCanvasLock(std::shared_ptr<int> const& lockCount)
+        : m_lockCount(lockCount)
+    {
+        ++*m_lockCount;
+    }
+
+    ~FakeCanvasLock()
+    {
+        Close();
+    }
+
+    IFACEMETHODIMP Close() override
+    {
+        if (m_lockCount)
+        {
+            --*m_lockCount;
+            m_lockCount.reset();
+        }
+
+        return S_OK;
+    }
+};
+
+TEST_CLASS(ResourceRecreationRegistryUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> LostDevice;
+        ComPtr<StubCanvasDevice> NewDevice;
+        std::shared_ptr<int> LostDeviceLockCount;
+        std::shared_ptr<int> NewDeviceLockCount;
+
+        Fixture()
+            : LostDevice(Make<StubCanvasDevice>())
+            , NewDevice(Make<StubCanvasDevice>())
+            , LostDeviceLockCount(std::make_shared<int>())
+            , NewDeviceLockCount(std::make_shared<int>())
+        {
+            LostDevice->EnableResourceRecreation();
+            NewDevice->EnableResourceRecreation();
+
+            AllowLocking(LostDevice.Get(), LostDeviceLockCount);
+            AllowLocking(NewDevice.Get(), NewDeviceLockCount);
+        }
+
+        static void AllowLocking(StubCanvasDevice* device, std::shared_ptr<int> const& lockCount)
+        {
+            device->LockMethod.AllowAnyCall(
+                [=] (ICanvasLock** value)
+                {
+                    return Make<FakeCanvasLock>(lockCount).CopyTo(value);
+                });
+        }
+
+        bool AreBothDevicesLocked()
+        {
+            return *LostDeviceLockCount > 0 && *NewDeviceLockCount > 0;
+        }
+
+        std::shared_ptr<ResourceRecreationRegistry> LostRegistry()
+        {
+            return LostDevice->GetResourceRecreationRegistry();
+        }
+
+        std::shared_ptr<ResourceRecreationRegistry> NewRegistry()
+        {
+            return NewDevice->GetResourceRecreationRegistry();
+        }
+
+        void RecreateResources()
+        {
+            LostRegistry()->RecreateResources(LostDevice.Get(), NewDevice.Get(), NewRegistry().get());
+        }
+    };
+
+    static ComPtr<IUnknown> MakeResource()
+    {
+        return As<IUnknown>(Make<MockD2DBitmap>());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_TracksBackingMemoryOfLiveResources)
+    {
+        ResourceRecreationRegistry registry;
+
+        auto resource1 = Make<FakeRecreatableResource>();
+        auto resource2 = Make<FakeRecreatableResource>();
+
+        registry.Register(resource1.Get(), 100, [] (IUnknown*, ICanvasDevice*) { return MakeResource(); });
+        registry.Register(resource2.Get(), 20, [] (IUnknown*, ICanvasDevice*) { return MakeResource(); });
+
+        Assert::AreEqual(2u, registry.GetResourceCount());
+        Assert::AreEqual<uint64_t>(120, registry.GetBackingMemorySize());
+
+        resource1.Reset();
+
+        Assert::AreEqual(1u, registry.GetResourceCount());
+        Assert::AreEqual<uint64_t>(20, registry.GetBackingMemorySize());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_RecreateResources_SwitchesResourcesToNewDevice)
+    {
+        Fixture f;
+
+        std::vector<ComPtr<FakeRecreatableResource>> resources;
+        std::vector<ComPtr<IUnknown>> newResources;
+
+        auto newDevice = f.NewDevice;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            resources.push_back(Make<FakeRecreatableResource>());
+            newResources.push_back(MakeResource());
+
+            auto newResource = newResources.back();
+            auto wrapper = resources.back();
+
+            f.LostRegistry()->Register(resources.back().Get(), 1,
+                [=] (IUnknown* actualWrapper, ICanvasDevice* actualDevice)
+                {
+                    Assert::IsTrue(IsSameInstance(wrapper.Get(), actualWrapper));
+                    Assert::IsTrue(IsSameInstance(newDevice.Get(), actualDevice));
+                    return newResource;
+                });
+        }
+
+        f.RecreateResources();
+
+        for (size_t i = 0; i < resources.size(); ++i)
+        {
+            Assert::IsTrue(IsSameInstance(f.NewDevice.Get(), resources[i]->Device.Get()));
+            Assert::IsTrue(IsSameInstance(newResources[i].Get(), resources[i]->Resource.Get()));
+        }
+
+        // The entries move across so that the resources can be recovered again.
+        Assert::AreEqual(0u, f.LostRegistry()->GetResourceCount());
+        Assert::AreEqual<uint64_t>(0, f.LostRegistry()->GetBackingMemorySize());
+
+        Assert::AreEqual(10u, f.NewRegistry()->GetResourceCount());
+        Assert::AreEqual<uint64_t>(10, f.NewRegistry()->GetBackingMemorySize());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_RecreateResources_SwitchesUnderBothDeviceLocksAfterCreatingEverything)
+    {
+        Fixture f;
+
+        std::vector<ComPtr<FakeRecreatableResource>> resources;
+        std::atomic<int> createCount(0);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto resource = Make<FakeRecreatableResource>();
+            resource->Resource = MakeResource();
+
+            resource->OnSwitchToDevice =
+                [&]
+                {
+                    Assert::IsTrue(f.AreBothDevicesLocked());
+                    Assert::AreEqual(4, createCount.load());
+                };
+
+            f.LostRegistry()->Register(resource.Get(), 1,
+                [&] (IUnknown*, ICanvasDevice*)
+                {
+                    Assert::IsFalse(f.AreBothDevicesLocked());
+                    ++createCount;
+                    return MakeResource();
+                });
+
+            resources.push_back(resource);
+        }
+
+        f.RecreateResources();
+
+        Assert::AreEqual(0, *f.LostDeviceLockCount);
+        Assert::AreEqual(0, *f.NewDeviceLockCount);
+
+        for (auto& resource : resources)
+        {
+            Assert::IsTrue(IsSameInstance(f.NewDevice.Get(), resource->Device.Get()));
+        }
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_RecreateResources_WhenLostDeviceIsClosed_StillSwitchesResources)
+    {
+        Fixture f;
+
+        f.LostDevice->LockMethod.AllowAnyCall([] (ICanvasLock**) { return RO_E_CLOSED; });
+
+        auto resource = Make<FakeRecreatableResource>();
+        f.LostRegistry()->Register(resource.Get(), 1, [] (IUnknown*, ICanvasDevice*) { return MakeResource(); });
+
+        f.RecreateResources();
+
+        Assert::IsTrue(IsSameInstance(f.NewDevice.Get(), resource->Device.Get()));
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_RecreateResources_SkipsClosedAndReleasedResources)
+    {
+        Fixture f;
+
+        auto closedResource = Make<FakeRecreatableResource>();
+        auto releasedResource = Make<FakeRecreatableResource>();
+
+        auto createNotExpected = [] (IUnknown*, ICanvasDevice*) -> ComPtr<IUnknown>
+        {
+            Assert::Fail(L"Unexpected call to Create");
+            return nullptr;
+        };
+
+        f.LostRegistry()->Register(closedResource.Get(), 1, createNotExpected);
+        f.LostRegistry()->Register(releasedResource.Get(), 1, createNotExpected);
+
+        ThrowIfFailed(closedResource->Close());
+        releasedResource.Reset();
+
+        f.RecreateResources();
+
+        Assert::IsNull(closedResource->Device.Get());
+
+        Assert::AreEqual(0u, f.LostRegistry()->GetResourceCount());
+        Assert::AreEqual(0u, f.NewRegistry()->GetResourceCount());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_RecreateResources_WhenCreateFails_ErrorIsRethrownAndResourceStaysRegistered)
+    {
+        Fixture f;
+
+        auto goodResource = Make<FakeRecreatableResource>();
+        auto badResource = Make<FakeRecreatableResource>();
+
+        f.LostRegistry()->Register(goodResource.Get(), 1, [] (IUnknown*, ICanvasDevice*) { return MakeResource(); });
+        f.LostRegistry()->Register(badResource.Get(), 2, [] (IUnknown*, ICanvasDevice*) -> ComPtr<IUnknown> { ThrowHR(E_OUTOFMEMORY); });
+
+        ExpectHResultException(E_OUTOFMEMORY, [&] { f.RecreateResources(); });
+
+        Assert::IsNull(badResource->Device.Get());
+
+        // Jobs stop being taken once one fails, so the other resource may or
+        // may not have been moved, but it must be registered somewhere.
+        uint32_t expectedMovedCount = goodResource->Device ? 1 : 0;
+
+        Assert::AreEqual(expectedMovedCount, f.NewRegistry()->GetResourceCount());
+        Assert::AreEqual(2u - expectedMovedCount, f.LostRegistry()->GetResourceCount());
+        Assert::AreEqual<uint64_t>(3 - expectedMovedCount, f.LostRegistry()->GetBackingMemorySize());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_BitmapFromBytes_WhenDisabled_IsNotRegistered)
+    {
+        auto canvasDevice = Make<StubCanvasDevice>();
+
+        canvasDevice->CreateBitmapFromBytesMethod.AllowAnyCall(
+            [] (uint8_t*, uint32_t, int32_t, int32_t, float, DirectXPixelFormat, CanvasAlphaMode)
+            {
+                return Make<StubD2DBitmap>();
+            });
+
+        uint8_t bytes[2 * 2 * 4] = {};
+
+        CanvasBitmap::CreateNew(canvasDevice.Get(), _countof(bytes), bytes, 2, 2, DEFAULT_DPI, PIXEL_FORMAT(B8G8R8A8UIntNormalized), CanvasAlphaMode::Premultiplied);
+
+        Assert::IsNull(canvasDevice->GetResourceRecreationRegistry().get());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_BitmapFromBytes_IsRecreatedFromCopyOfBytes)
+    {
+        Fixture f;
+
+        const int32_t width = 3;
+        const int32_t height = 2;
+        const uint32_t pitch = width * 4;
+
+        std::vector<uint8_t> bytes(pitch * height);
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<uint8_t>(i);
+
+        auto originalBytes = bytes;
+
+        f.LostDevice->CreateBitmapFromBytesMethod.SetExpectedCalls(1,
+            [] (uint8_t*, uint32_t, int32_t, int32_t, float, DirectXPixelFormat, CanvasAlphaMode)
+            {
+                return Make<StubD2DBitmap>();
+            });
+
+        auto bitmap = CanvasBitmap::CreateNew(f.LostDevice.Get(), static_cast<uint32_t>(bytes.size()), bytes.data(), width, height, 123.0f, PIXEL_FORMAT(B8G8R8A8UIntNormalized), CanvasAlphaMode::Ignore);
+
+        Assert::AreEqual<uint64_t>(bytes.size(), f.LostRegistry()->GetBackingMemorySize());
+
+        // Changes to the caller's buffer after creation don't affect the copy.
+        std::fill(bytes.begin(), bytes.end(), static_cast<uint8_t>(0xFF));
+
+        auto newD2DBitmap = Make<StubD2DBitmap>();
+
+        f.NewDevice->CreateBitmapFromBytesMethod.SetExpectedCalls(1,
+            [&] (uint8_t* actualBytes, uint32_t actualPitch, int32_t actualWidth, int32_t actualHeight, float dpi, DirectXPixelFormat format, CanvasAlphaMode alphaMode)
+            {
+                Assert::AreEqual(pitch, actualPitch);
+                Assert::AreEqual(width, actualWidth);
+                Assert::AreEqual(height, actualHeight);
+                Assert::AreEqual(123.0f, dpi);
+                Assert::AreEqual(PIXEL_FORMAT(B8G8R8A8UIntNormalized), format);
+                Assert::AreEqual(CanvasAlphaMode::Ignore, alphaMode);
+
+                for (size_t i = 0; i < originalBytes.size(); ++i)
+                    Assert::AreEqual(originalBytes[i], actualBytes[i]);
+
+                return newD2DBitmap;
+            });
+
+        f.RecreateResources();
+
+        ComPtr<ICanvasDevice> actualDevice;
+        ThrowIfFailed(bitmap->get_Device(&actualDevice));
+        Assert::IsTrue(IsSameInstance(f.NewDevice.Get(), actualDevice.Get()));
+
+        Assert::IsTrue(IsSameInstance(newD2DBitmap.Get(), GetWrappedResource<ID2D1Bitmap1>(bitmap).Get()));
+
+        Assert::AreEqual<uint64_t>(bytes.size(), f.NewRegistry()->GetBackingMemorySize());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_EffectTransferTable3D_KeepsCopyOfTable)
+    {
+        Fixture f;
+
+        auto d2dContext = Make<StubD2DDeviceContext>();
+
+        f.LostDevice->GetResourceCreationDeviceContextMethod.AllowAnyCall([&] { return DeviceContextLease(d2dContext); });
+
+        d2dContext->CreateLookupTable3DMethod.SetExpectedCalls(1,
+            [] (D2D1_BUFFER_PRECISION, UINT32 const*, BYTE const*, UINT32, UINT32 const*, ID2D1LookupTable3D** result)
+            {
+                *result = nullptr;
+                return S_OK;
+            });
+
+        std::vector<uint8_t> bytes(2 * 2 * 2 * 4);
+
+        auto table = EffectTransferTable3D::CreateNew(f.LostDevice.Get(), static_cast<uint32_t>(bytes.size()), bytes.data(), 2, 2, 2, PIXEL_FORMAT(R8G8B8A8UIntNormalized));
+
+        Assert::AreEqual(1u, f.LostRegistry()->GetResourceCount());
+        Assert::AreEqual<uint64_t>(bytes.size(), f.LostRegistry()->GetBackingMemorySize());
+
+        table.Reset();
+
+        Assert::AreEqual<uint64_t>(0, f.LostRegistry()->GetBackingMemorySize());
+    }
+
+    TEST_METHOD_EX(ResourceRecreationRegistry_LinearGradientBrush_IsRecreatedFromOldBrush)
+    {
+        Fixture f;
+
+        auto oldStopCollection = Make<MockD2DGradientStopCollection>();
+        auto oldD2DBrush = Make<MockD2DLinearGradientBrush>();
+
+        f.LostDevice->MockCreateLinearGradientBrush = [&] (ID2D1GradientStopCollection1*) { return oldD2DBrush; };
+
+        auto brush = CanvasLinearGradientBrush::CreateNew(f.LostDevice.Get(), oldStopCollection.Get());
+
+        Assert::AreEqual(1u, f.LostRegistry()->GetResourceCount());
+        Assert::AreEqual<uint64_t>(0, f.LostRegistry()->GetBackingMemorySize());
+
+        D2D1_GRADIENT_STOP stops[] = { { 0.0f, { 1, 0, 0, 1 } }, { 1.0f, { 0, 0, 1, 1 } } };
+        D2D1_MATRIX_3X2_F transform = D2D1::Matrix3x2F(1, 2, 3, 4, 5, 6);
+
+        oldD2DBrush->GetGradientStopCollectionMethod.AllowAnyCall([&] (ID2D1GradientStopCollection** value) { ThrowIfFailed(oldStopCollection.CopyTo(value)); });
+        oldD2DBrush->GetStartPointMethod.AllowAnyCall([] { return D2D1_POINT_2F{ 1, 2 }; });
+        oldD2DBrush->GetEndPointMethod.AllowAnyCall([] { return D2D1_POINT_2F{ 3, 4 }; });
+        oldD2DBrush->GetOpacityMethod.AllowAnyCall([] { return 0.5f; });
+        oldD2DBrush->GetTransformMethod.AllowAnyCall([&] (D2D1_MATRIX_3X2_F* value) { *value = transform; });
+
+        oldStopCollection->GetGradientStopCountMethod.AllowAnyCall([&] { return static_cast<UINT32>(_countof(stops)); });
+        oldStopCollection->GetGradientStops1Method.AllowAnyCall([&] (D2D1_GRADIENT_STOP* value, UINT32 count) { std::copy(stops, stops + count, value); });
+        oldStopCollection->GetPreInterpolationSpaceMethod.AllowAnyCall([] { return D2D1_COLOR_SPACE_SCRGB; });
+        oldStopCollection->GetPostInterpolationSpaceMethod.AllowAnyCall([] { return D2D1_COLOR_SPACE_SRGB; });
+        oldStopCollection->GetBufferPrecisionMethod.AllowAnyCall([] { return D2D1_BUFFER_PRECISION_16BPC_FLOAT; });
+        oldStopCollection->GetExtendModeMethod.AllowAnyCall([] { return D2D1_EXTEND_MODE_MIRROR; });
+        oldStopCollection->GetColorInterpolationModeMethod.AllowAnyCall([] { return D2D1_COLOR_INTERPOLATION_MODE_STRAIGHT; });
+
+        auto newStopCollection = Make<MockD2DGradientStopCollection>();
+        auto newD2DBrush = Make<MockD2DLinearGradientBrush>();
+
+        f.NewDevice->MockCreateGradientStopCollection =
+            [&] (std::vector<D2D1_GRADIENT_STOP>&& actualStops, D2D1_COLOR_SPACE preInterpolationSpace, D2D1_COLOR_SPACE postInterpolationSpace, D2D1_BUFFER_PRECISION bufferPrecision, D2D1_EXTEND_MODE extendMode, D2D1_COLOR_INTERPOLATION_MODE interpolationMode)
+            {
+                Assert::AreEqual(_countof(stops), actualStops.size());
+                Assert::AreEqual(stops[1].position, actualStops[1].position);
+                Assert::AreEqual(stops[1].color.b, actualStops[1].color.b);
+
+                Assert::IsTrue(D2D1_COLOR_SPACE_SCRGB == preInterpolationSpace);
+                Assert::IsTrue(D2D1_COLOR_SPACE_SRGB == postInterpolationSpace);
+                Assert::AreEqual(D2D1_BUFFER_PRECISION_16BPC_FLOAT, bufferPrecision);
+                Assert::AreEqual(D2D1_EXTEND_MODE_MIRROR, extendMode);
+                Assert::IsTrue(D2D1_COLOR_INTERPOLATION_MODE_STRAIGHT == interpolationMode);
+
+                return newStopCollection;
+            };
+
+        f.NewDevice->MockCreateLinearGradientBrush =
+            [&] (ID2D1GradientStopCollection1* stopCollection)
+            {
+                Assert::IsTrue(IsSameInstance(newStopCollection.Get(), stopCollection));
+                return newD2DBrush;
+            };
+
+        newD2DBrush->SetStartPointMethod.SetExpectedCalls(1, [] (D2D1_POINT_2F value) { Assert::AreEqual(D2D1_POINT_2F{ 1, 2 }, value); });
+        newD2DBrush->SetEndPointMethod.SetExpectedCalls(1, [] (D2D1_POINT_2F value) { Assert::AreEqual(D2D1_POINT_2F{ 3, 4 }, value); });
+        newD2DBrush->SetOpacityMethod.SetExpectedCalls(1, [] (float value) { Assert::AreEqual(0.5f, value); });
+        newD2DBrush->SetTransformMethod.SetExpectedCalls(1, [&] (D2D1_MATRIX_3X2_F const* value) { Assert::AreEqual(transform, *value); });
+
+        f.RecreateResources();
+
+        ComPtr<ICanvasDevice> actualDevice;
+        ThrowIfFailed(brush->get_Device(&actualDevice));
+        Assert::IsTrue(IsSameInstance(f.NewDevice.Get(), actualDevice.Get()));
+
+        Assert::IsTrue(IsSameInstance(newD2DBrush.Get(), GetWrappedResource<ID2D1LinearGradientBrush>(brush).Get()));
+    }
+};
@@ -116,6 +116,18 @@ public:
         Rect bounds;
         Assert::AreEqual(RO_E_CLOSED, gradientMesh->GetBounds(f.Device.Get(), &bounds));
         Assert::AreEqual(RO_E_CLOSED, gradientMesh->GetBoundsWithTransform(f.Device.Get(), Numerics::Matrix3x2{}, &bounds));
+        Assert::AreEqual(RO_E_CLOSED, gradientMesh->ComputeBounds(&bounds));
+        Assert::AreEqual(RO_E_CLOSED, gradientMesh->ComputeBoundsWithTransform(Numerics::Matrix3x2{}, &bounds));
+
+        int32_t patchIndex;
+        Vector2 patchCoordinates;
+        boolean isHit;
+        Assert::AreEqual(RO_E_CLOSED, gradientMesh->HitTest(Vector2{}, &patchIndex, &patchCoordinates, &isHit));
+
+        uint32_t vertexCount;
+        CanvasGradientMeshVertex* vertices;
+        Assert::AreEqual(RO_E_CLOSED, gradientMesh->Tessellate(&vertexCount, &vertices));
+        Assert::AreEqual(RO_E_CLOSED, gradientMesh->TessellateWithFlatteningTolerance(1, &vertexCount, &vertices));
 
         ComPtr<ICanvasDevice> device;
         Assert::AreEqual(RO_E_CLOSED, gradientMesh->get_Device(&device));
@@ -493,4 +505,122 @@ public:
             Assert::AreEqual(patchElements[i], f.DefaultPatches[i]);
         }
     }
+
+    //
+    // ComputeBounds, HitTest and Tessellate work from a copy of the patches
+    // that is read back from the D2D resource once.
+    //
+
+    static void ExpectPatchesReadOnce(Fixture& f, std::vector<CanvasGradientMeshPatch> const& patches)
+    {
+        f.D2DGradientMesh->GetPatchCountMethod.SetExpectedCalls(1, [=] { return static_cast<uint32_t>(patches.size()); });
+        f.D2DGradientMesh->GetPatchesMethod.SetExpectedCalls(1,
+            [=](uint32_t startIndex, D2D1_GRADIENT_MESH_PATCH* d2dPatches, uint32_t numPatches)
+            {
+                Assert::AreEqual(0u, startIndex);
+                Assert::AreEqual(static_cast<uint32_t>(patches.size()), numPatches);
+                for (uint32_t i = 0; i < numPatches; ++i)
+                {
+                    d2dPatches[i] = CanvasGradientMeshFactory::PatchToD2DPatch(patches[i]);
+                }
+                return S_OK;
+            });
+    }
+
+    // Control points evenly spaced over a square, so that the patch maps
+    // (u, v) to (left + u * size, top + v * size).
+    static CanvasGradientMeshPatch GetSquarePatch(float left, float top, float size)
+    {
+        Vector2 points[16];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            points[i] = Vector2{ left + size * (i % 4) / 3, top + size * (i / 4) / 3 };
+        }
+
+        CanvasGradientMeshPatch patch{};
+        ThrowIfFailed(Make<CanvasGradientMeshFactory>()->CreateTensorPatch(16, points, 4, testColors, 4, testEdges, &patch));
+        return patch;
+    }
+
+    TEST_METHOD_EX(CanvasGradientMesh_ComputeBounds_UsesCachedPatches)
+    {
+        Fixture f;
+
+        ExpectPatchesReadOnce(f, { GetSquarePatch(10, 20, 30), GetSquarePatch(50, 0, 10) });
+
+        auto gradientMesh = CanvasGradientMesh::CreateNew(f.Device.Get(), 0, nullptr);
+
+        Rect bounds;
+        Assert::AreEqual(S_OK, gradientMesh->ComputeBounds(&bounds));
+        Assert::AreEqual(Rect{ 10, 0, 50, 50 }, bounds);
+
+        Assert::AreEqual(S_OK, gradientMesh->ComputeBoundsWithTransform(Matrix3x2{ 2, 0, 0, 2, 5, 5 }, &bounds));
+        Assert::AreEqual(Rect{ 25, 5, 100, 100 }, bounds);
+
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->ComputeBounds(nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGradientMesh_HitTest)
+    {
+        Fixture f;
+
+        ExpectPatchesReadOnce(f, { GetSquarePatch(0, 0, 100), GetSquarePatch(50, 50, 100) });
+
+        auto gradientMesh = CanvasGradientMesh::CreateNew(f.Device.Get(), 0, nullptr);
+
+        int32_t patchIndex;
+        Vector2 patchCoordinates;
+        boolean isHit;
+
+        Assert::AreEqual(S_OK, gradientMesh->HitTest(Vector2{ 75, 100 }, &patchIndex, &patchCoordinates, &isHit));
+        Assert::IsTrue(!!isHit);
+        Assert::AreEqual(1, patchIndex);
+        Assert::IsTrue(fabsf(patchCoordinates.X - 0.25f) < 0.001f);
+        Assert::IsTrue(fabsf(patchCoordinates.Y - 0.5f) < 0.001f);
+
+        Assert::AreEqual(S_OK, gradientMesh->HitTest(Vector2{ 200, 10 }, &patchIndex, &patchCoordinates, &isHit));
+        Assert::IsFalse(!!isHit);
+        Assert::AreEqual(-1, patchIndex);
+
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->HitTest(Vector2{}, nullptr, &patchCoordinates, &isHit));
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->HitTest(Vector2{}, &patchIndex, nullptr, &isHit));
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->HitTest(Vector2{}, &patchIndex, &patchCoordinates, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGradientMesh_Tessellate)
+    {
+        Fixture f;
+
+        ExpectPatchesReadOnce(f, { GetSquarePatch(0, 0, 10) });
+
+        auto gradientMesh = CanvasGradientMesh::CreateNew(f.Device.Get(), 0, nullptr);
+
+        uint32_t vertexCount;
+        CanvasGradientMeshVertex* vertices;
+
+        Assert::AreEqual(S_OK, gradientMesh->Tessellate(&vertexCount, &vertices));
+        Assert::AreEqual(6u, vertexCount);
+
+        // The corners of the square appear with their colors.
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            auto& vertex = vertices[i];
+            Assert::AreEqual(vertex.PatchCoordinates.X * 10, vertex.Position.X);
+            Assert::AreEqual(vertex.PatchCoordinates.Y * 10, vertex.Position.Y);
+
+            int corner = static_cast<int>(vertex.PatchCoordinates.X) + static_cast<int>(vertex.PatchCoordinates.Y) * 2;
+            Assert::AreEqual(testColors[corner], vertex.Color);
+        }
+
+        CoTaskMemFree(vertices);
+
+        Assert::AreEqual(S_OK, gradientMesh->TessellateWithFlatteningTolerance(0.01f, &vertexCount, &vertices));
+        Assert::AreEqual(6u, vertexCount);
+        CoTaskMemFree(vertices);
+
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->TessellateWithFlatteningTolerance(0, &vertexCount, &vertices));
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->TessellateWithFlatteningTolerance(-1, &vertexCount, &vertices));
+        Assert::AreEqual(E_INVALIDARG, gradientMesh->Tessellate(nullptr, &vertices));
+    }
 };
@@ -39,10 +39,11 @@ namespace canvas
         CALL_COUNTER_WITH_MOCK(TrimMethod, HRESULT());
         CALL_COUNTER_WITH_MOCK(GetInterfaceMethod, HRESULT(REFIID,void**));
         CALL_COUNTER_WITH_MOCK(CreateDeviceContextForDrawingSessionMethod, ComPtr<ID2D1DeviceContext1>());
+        CALL_COUNTER_WITH_MOCK(LeaseDeviceContextForDrawingSessionMethod, DeviceContextLease());
         CALL_COUNTER_WITH_MOCK(CreateBitmapFromBytesMethod, ComPtr<ID2D1Bitmap1>(uint8_t*, uint32_t, int32_t, int32_t, float, DirectXPixelFormat, CanvasAlphaMode));
         CALL_COUNTER_WITH_MOCK(CreateBitmapFromSurfaceMethod, ComPtr<ID2D1Bitmap1>(IDirect3DSurface*, float, CanvasAlphaMode));
         CALL_COUNTER_WITH_MOCK(CreateRenderTargetBitmapMethod, ComPtr<ID2D1Bitmap1>(float, float, float, DirectXPixelFormat, CanvasAlphaMode));
-        CALL_COUNTER_WITH_MOCK(CreateSwapChainForCompositionMethod, ComPtr<IDXGISwapChain1>(int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode));
+        CALL_COUNTER_WITH_MOCK(CreateSwapChainForCompositionMethod, ComPtr<IDXGISwapChain1>(int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions));
         CALL_COUNTER_WITH_MOCK(CreateSwapChainForCoreWindowMethod, ComPtr<IDXGISwapChain1>(ICoreWindow*, int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode));
         CALL_COUNTER_WITH_MOCK(CreateSwapChainForHwndMethod, ComPtr<IDXGISwapChain1>(HWND, int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode));
         CALL_COUNTER_WITH_MOCK(CreateCommandListMethod, ComPtr<ID2D1CommandList>());
@@ -79,6 +80,10 @@ namespace canvas
 
         CALL_COUNTER_WITH_MOCK(CreateSvgDocumentMethod, ComPtr<ID2D1SvgDocument>(IStream*));
 
+        CALL_COUNTER_WITH_MOCK(GetTextLayoutCacheMethod, std::shared_ptr<ABI::Microsoft::Graphics::Canvas::Text::CanvasTextLayoutCache>());
+
+        CALL_COUNTER_WITH_MOCK(GetResourceRecreationRegistryMethod, std::shared_ptr<ABI::Microsoft::Graphics::Canvas::ResourceRecreationRegistry>());
+
         //
         // ICanvasDevice
         //
@@ -225,6 +230,11 @@ namespace canvas
             return CreateDeviceContextForDrawingSessionMethod.WasCalled();
         }
 
+        virtual DeviceContextLease LeaseDeviceContextForDrawingSession() override
+        {
+            return LeaseDeviceContextForDrawingSessionMethod.WasCalled();
+        }
+
         virtual ComPtr<ID2D1SolidColorBrush> CreateSolidColorBrush(D2D1_COLOR_F const& color) override
         {
             if (!MockCreateSolidColorBrush)
@@ -353,9 +363,10 @@ namespace canvas
             int32_t heightInPixels,
             DirectXPixelFormat format,
             int32_t bufferCount,
-            CanvasAlphaMode alphaMode) override
+            CanvasAlphaMode alphaMode,
+            CanvasSwapChainOptions options) override
         {
-            return CreateSwapChainForCompositionMethod.WasCalled(widthInPixels, heightInPixels, format, bufferCount, alphaMode);
+            return CreateSwapChainForCompositionMethod.WasCalled(widthInPixels, heightInPixels, format, bufferCount, alphaMode, options);
         }
 
         virtual ComPtr<IDXGISwapChain1> CreateSwapChainForCoreWindow(
@@ -445,6 +456,16 @@ namespace canvas
         {
             return CreateSvgDocumentMethod.WasCalled(inputXmlStream);
         }
+
+        virtual std::shared_ptr<ABI::Microsoft::Graphics::Canvas::Text::CanvasTextLayoutCache> GetTextLayoutCache() override
+        {
+            return GetTextLayoutCacheMethod.WasCalled();
+        }
+
+        virtual std::shared_ptr<ABI::Microsoft::Graphics::Canvas::ResourceRecreationRegistry> GetResourceRecreationRegistry() override
+        {
+            return GetResourceRecreationRegistryMethod.WasCalled();
+        }
     };
 }
 
@@ -223,6 +223,8 @@ namespace canvas
         DONT_EXPECT(put_TextAntialiasing        , CanvasTextAntialiasing);
         DONT_EXPECT(get_TextRenderingParameters , ICanvasTextRenderingParameters**);
         DONT_EXPECT(put_TextRenderingParameters , ICanvasTextRenderingParameters*);
+        DONT_EXPECT(get_TextCache               , ICanvasTextCache**);
+        DONT_EXPECT(put_TextCache               , ICanvasTextCache*);
         DONT_EXPECT(get_Transform               , ABI::Microsoft::Graphics::Canvas::Numerics::Matrix3x2*);
         DONT_EXPECT(put_Transform               , ABI::Microsoft::Graphics::Canvas::Numerics::Matrix3x2);
         DONT_EXPECT(get_Units                   , CanvasUnits*);
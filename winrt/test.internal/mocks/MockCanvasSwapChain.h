@@ -190,6 +190,8 @@ namespace canvas
                     return S_OK;
                 });
 
+            dxgiSwapChain->GetFrameLatencyWaitableObjectMethod.AllowAnyCall();
+
             dxgiSwapChain->GetBufferMethod.AllowAnyCall(
                 [] (UINT index, const IID& iid, void** out)
                 {
@@ -211,5 +213,11 @@ namespace canvas
         {
             if (m_sleepFn) m_sleepFn(timeInMs);
         }
+
+        std::function<DWORD(HANDLE, DWORD)> m_waitFn;
+        virtual DWORD WaitForSingleObject(HANDLE handle, DWORD timeoutInMs) override
+        {
+            return m_waitFn ? m_waitFn(handle, timeoutInMs) : WAIT_OBJECT_0;
+        }
     };
 }
@@ -49,6 +49,7 @@ namespace canvas
         MOCK_METHOD2(FillEllipse                      , void(D2D1_ELLIPSE const*,ID2D1Brush*));
         MOCK_METHOD7(DrawText                         , void(wchar_t const*,uint32_t,IDWriteTextFormat*,D2D1_RECT_F const*,ID2D1Brush*,D2D1_DRAW_TEXT_OPTIONS,DWRITE_MEASURING_MODE));
         MOCK_METHOD5(DrawImage                        , void(ID2D1Image*, D2D1_POINT_2F const*, D2D1_RECT_F const*, D2D1_INTERPOLATION_MODE, D2D1_COMPOSITE_MODE));
+        MOCK_METHOD5(DrawGlyphRun                     , void(D2D1_POINT_2F, DWRITE_GLYPH_RUN const*, DWRITE_GLYPH_RUN_DESCRIPTION const*, ID2D1Brush*, DWRITE_MEASURING_MODE));
         MOCK_METHOD6(DrawBitmap                       , void(ID2D1Bitmap*, D2D1_RECT_F const*, FLOAT, D2D1_INTERPOLATION_MODE, D2D1_RECT_F const*, D2D1_MATRIX_4X4_F const*));
         MOCK_METHOD1_CONST(GetDevice                  , void(ID2D1Device**));
         MOCK_METHOD2(CreateEffect                     , HRESULT(IID const&, ID2D1Effect **));
@@ -288,11 +289,6 @@ namespace canvas
             return E_NOTIMPL;
         }
 
-        IFACEMETHODIMP_(void) DrawGlyphRun(D2D1_POINT_2F,const DWRITE_GLYPH_RUN *,const DWRITE_GLYPH_RUN_DESCRIPTION *,ID2D1Brush *,DWRITE_MEASURING_MODE) override
-        {
-            Assert::Fail(L"Unexpected call to DrawGlyphRun");
-        }
-
         IFACEMETHODIMP_(void) DrawGdiMetafile(ID2D1GdiMetafile *,const D2D1_POINT_2F *) override
         {
             Assert::Fail(L"Unexpected call to DrawGdiMetafile");
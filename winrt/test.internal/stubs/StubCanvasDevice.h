@@ -8,6 +8,7 @@
 #include "mocks/MockD2DGeometryRealization.h"
 #include "mocks/MockD2DGradientMesh.h"
 #include "mocks/MockD2DSvgDocument.h"
+#include <lib/text/CanvasTextLayoutCache.h>
 
 namespace canvas
 {
@@ -21,13 +22,16 @@ namespace canvas
         ComPtr<MockD3D11Device> m_d3dDevice;
         ComPtr<MockEventSource<DeviceLostHandlerType>> m_deviceLostEventSource;
         DeviceContextPool m_deviceContextPool;
+        std::shared_ptr<ABI::Microsoft::Graphics::Canvas::Text::CanvasTextLayoutCache> m_textLayoutCache;
+        std::shared_ptr<ABI::Microsoft::Graphics::Canvas::ResourceRecreationRegistry> m_recreationRegistry;
         
     public:
         StubCanvasDevice(ComPtr<ID2D1Device1> device = Make<StubD2DDevice>(), ComPtr<MockD3D11Device> d3dDevice = nullptr)
             : m_d2DDevice(device)
             , m_d3dDevice(d3dDevice)
             , m_deviceLostEventSource(Make<MockEventSource<DeviceLostHandlerType>>(L"DeviceLost"))
-            , m_deviceContextPool(m_d2DDevice.Get())
+            , m_deviceContextPool(m_d2DDevice.Get(), false, static_cast<ICanvasDevice*>(this))
+            , m_textLayoutCache(std::make_shared<ABI::Microsoft::Graphics::Canvas::Text::CanvasTextLayoutCache>())
         {
             GetInterfaceMethod.AllowAnyCall();
             
@@ -39,6 +43,17 @@ namespace canvas
                     return dc;
                 });
 
+            //
+            // Drawing session leases aren't pooled by the stub, so that tests
+            // can continue to control which device context is used through
+            // CreateDeviceContextForDrawingSessionMethod.
+            //
+            LeaseDeviceContextForDrawingSessionMethod.AllowAnyCall(
+                [=]
+                {
+                    return DeviceContextLease(CreateDeviceContextForDrawingSession());
+                });
+
             CreateFilledGeometryRealizationMethod.AllowAnyCall(
                 [=](ID2D1Geometry*, FLOAT)
                 {
@@ -101,6 +116,23 @@ namespace canvas
                 {
                     return Make<MockD2DSvgDocument>();
                 });
+
+            GetTextLayoutCacheMethod.AllowAnyCall(
+                [=]
+                {
+                    return m_textLayoutCache;
+                });
+
+            GetResourceRecreationRegistryMethod.AllowAnyCall(
+                [=]
+                {
+                    return m_recreationRegistry;
+                });
+        }
+
+        void EnableResourceRecreation()
+        {
+            m_recreationRegistry = std::make_shared<ABI::Microsoft::Graphics::Canvas::ResourceRecreationRegistry>();
         }
 
         void MarkAsLost()
@@ -29,6 +29,12 @@ namespace canvas
                 });
 
             GetCoreWindowMethod.AllowAnyCall();
+
+            // Reports a zero-initialized desc, ie. a swap chain with no flags.
+            GetDesc1Method.AllowAnyCall();
+
+            // Not a low latency swap chain.
+            GetFrameLatencyWaitableObjectMethod.AllowAnyCall();
         }
 
         IFACEMETHODIMP GetMatrixTransform(
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+TEST_CLASS(AllocationTrackingTests)
+{
+    static AllocationTracker::Totals const* Find(std::vector<AllocationTracker::Totals> const& snapshot, char const* apiName)
+    {
+        for (auto& totals : snapshot)
+        {
+            if (totals.ApiName == apiName)
+                return &totals;
+        }
+
+        return nullptr;
+    }
+
+    TEST_METHOD_EX(AllocationTracker_AttributesAllocationsToTheActiveScope)
+    {
+        AllocationTracker::Reset();
+
+        for (int i = 0; i < 2; ++i)
+        {
+            AllocationTracker::Scope scope("Api1");
+            AllocationTracker::RecordAllocation(10);
+            AllocationTracker::RecordAllocation(20);
+        }
+
+        {
+            AllocationTracker::Scope scope("Api2");
+        }
+
+        auto snapshot = AllocationTracker::GetSnapshot();
+
+        auto api1 = Find(snapshot, "Api1");
+        Assert::IsNotNull(api1);
+        Assert::AreEqual<uint64_t>(2, api1->CallCount);
+        Assert::AreEqual<uint64_t>(4, api1->AllocationCount);
+        Assert::AreEqual<uint64_t>(60, api1->ByteCount);
+
+        auto api2 = Find(snapshot, "Api2");
+        Assert::IsNotNull(api2);
+        Assert::AreEqual<uint64_t>(1, api2->CallCount);
+        Assert::AreEqual<uint64_t>(0, api2->AllocationCount);
+
+        // Most allocations first.
+        Assert::AreEqual<std::string>("Api1", snapshot.front().ApiName);
+    }
+
+    TEST_METHOD_EX(AllocationTracker_NestedScopesAreChargedToTheOutermost)
+    {
+        AllocationTracker::Reset();
+
+        {
+            AllocationTracker::Scope outer("Outer");
+            AllocationTracker::RecordAllocation(1);
+
+            {
+                AllocationTracker::Scope inner("Inner");
+                AllocationTracker::RecordAllocation(2);
+            }
+
+            AllocationTracker::RecordAllocation(4);
+        }
+
+        auto snapshot = AllocationTracker::GetSnapshot();
+
+        Assert::IsNull(Find(snapshot, "Inner"));
+
+        auto outer = Find(snapshot, "Outer");
+        Assert::IsNotNull(outer);
+        Assert::AreEqual<uint64_t>(1, outer->CallCount);
+        Assert::AreEqual<uint64_t>(3, outer->AllocationCount);
+        Assert::AreEqual<uint64_t>(7, outer->ByteCount);
+    }
+
+    TEST_METHOD_EX(AllocationTracker_AllocationsOutsideAnyScopeAreUnattributed)
+    {
+        AllocationTracker::Reset();
+
+        Assert::IsNull(Find(AllocationTracker::GetSnapshot(), AllocationTracker::UnattributedName));
+
+        AllocationTracker::RecordAllocation(16);
+
+        auto unattributed = Find(AllocationTracker::GetSnapshot(), AllocationTracker::UnattributedName);
+        Assert::IsNotNull(unattributed);
+        Assert::AreEqual<uint64_t>(1, unattributed->AllocationCount);
+        Assert::AreEqual<uint64_t>(16, unattributed->ByteCount);
+    }
+
+    TEST_METHOD_EX(AllocationTracker_ScopesAreTrackedPerThread)
+    {
+        AllocationTracker::Reset();
+
+        AllocationTracker::Scope scope("MainThread");
+
+        std::thread([] { AllocationTracker::RecordAllocation(8); }).join();
+
+        auto unattributed = Find(AllocationTracker::GetSnapshot(), AllocationTracker::UnattributedName);
+        Assert::IsNotNull(unattributed);
+        Assert::AreEqual<uint64_t>(8, unattributed->ByteCount);
+    }
+
+    TEST_METHOD_EX(AllocationTracker_ComArrayAllocationsAreCounted)
+    {
+        AllocationTracker::Reset();
+
+        {
+            AllocationTracker::Scope scope("ComArray");
+            ComArray<int32_t> array(4);
+        }
+
+        {
+            AllocationTracker::Scope scope("ComArrayBuilder");
+            ComArrayBuilder<int32_t> builder;
+            builder.Reserve(8);
+        }
+
+        auto snapshot = AllocationTracker::GetSnapshot();
+
+        auto comArray = Find(snapshot, "ComArray");
+        Assert::IsNotNull(comArray);
+        Assert::AreEqual<uint64_t>(1, comArray->AllocationCount);
+        Assert::AreEqual<uint64_t>(4 * sizeof(int32_t), comArray->ByteCount);
+
+        auto builder = Find(snapshot, "ComArrayBuilder");
+        Assert::IsNotNull(builder);
+        Assert::AreEqual<uint64_t>(1, builder->AllocationCount);
+        Assert::AreEqual<uint64_t>(8 * sizeof(int32_t), builder->ByteCount);
+    }
+
+    TEST_METHOD_EX(AllocationTracker_ScopesWithTheSameNameAreCombined)
+    {
+        AllocationTracker::Reset();
+
+        // Two different buffers holding the same text, as would happen for
+        // the same method name seen from two translation units.
+        char name1[] = "SameName";
+        char name2[] = "SameName";
+
+        {
+            AllocationTracker::Scope scope(name1);
+            AllocationTracker::RecordAllocation(1);
+        }
+
+        {
+            AllocationTracker::Scope scope(name2);
+            AllocationTracker::RecordAllocation(1);
+        }
+
+        auto snapshot = AllocationTracker::GetSnapshot();
+
+        Assert::AreEqual<size_t>(1, snapshot.size());
+        Assert::AreEqual<uint64_t>(2, snapshot[0].CallCount);
+        Assert::AreEqual<uint64_t>(2, snapshot[0].AllocationCount);
+
+        // The table refers to the names, which are about to go out of scope.
+        AllocationTracker::Reset();
+    }
+};
@@ -20,6 +20,18 @@ TEST_CLASS(ComArrayTests)
             return p;
         }
         
+        static void* CoTaskMemRealloc(void* p, size_t bytes)
+        {
+            if (p)
+            {
+                Assert::AreEqual<size_t>(1U, GetAllocations()->count(p));
+                GetAllocations()->erase(p);
+            }
+            auto newP = ::CoTaskMemRealloc(p, bytes);
+            GetAllocations()->insert(newP);
+            return newP;
+        }
+
         static void CoTaskMemFree(void* p)
         {
             if (p)
@@ -178,6 +190,67 @@ TEST_CLASS(ComArrayTests)
         Assert::AreEqual(4.0, d[2]);
     }
 
+    TEST_METHOD_EX(ComArray_Attach_TakesOwnership)
+    {
+        ComArray<float, Tracker> array(100);
+
+        auto data = static_cast<float*>(Tracker::CoTaskMemAlloc(3 * sizeof(float)));
+        array.Attach(3, data);
+
+        // The original allocation has been freed, and the attached one is
+        // freed when the array goes out of scope.
+        Assert::AreEqual(3U, array.GetSize());
+        Assert::AreEqual(data, array.GetData());
+    }
+
+    TEST_METHOD_EX(ComArrayBuilder_Empty_CompletesToZeroSizedArray)
+    {
+        ComArrayBuilder<float, Tracker> builder;
+
+        auto array = builder.Complete();
+
+        Assert::AreEqual(0U, array.GetSize());
+        Assert::IsNotNull(array.GetData());
+    }
+
+    TEST_METHOD_EX(ComArrayBuilder_Append_GrowsGeometrically)
+    {
+        ComArrayBuilder<int, Tracker> builder(2);
+        Assert::AreEqual(2U, builder.GetCapacity());
+
+        int values[] = { 1, 2, 3 };
+
+        builder.Append(values, 3);
+        Assert::AreEqual(3U, builder.GetSize());
+        Assert::AreEqual(4U, builder.GetCapacity());
+
+        builder.Append(values, 1);
+        Assert::AreEqual(4U, builder.GetSize());
+        Assert::AreEqual(4U, builder.GetCapacity());
+
+        builder.Append(values, 1);
+        Assert::AreEqual(8U, builder.GetCapacity());
+    }
+
+    TEST_METHOD_EX(ComArrayBuilder_Complete_HandsOverElements)
+    {
+        ComArrayBuilder<int, Tracker> builder(4);
+
+        int values[] = { 1, 2, 3, 4 };
+        builder.Append(values, 2);
+        builder.Append(values + 2, 2);
+
+        auto array = builder.Complete();
+
+        Assert::AreEqual(4U, array.GetSize());
+        for (uint32_t i = 0; i < 4; ++i)
+            Assert::AreEqual(values[i], array[i]);
+
+        // The builder no longer owns anything.
+        Assert::AreEqual(0U, builder.GetSize());
+        Assert::AreEqual(0U, builder.GetCapacity());
+    }
+
     TEST_METHOD_EX(ComArray_ReleasesInterfacePointers)
     {
         struct MockInterface
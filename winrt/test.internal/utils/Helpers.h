@@ -250,6 +250,14 @@ namespace Microsoft
                 END_ENUM(CanvasSwapChainRotation);
             }
 
+            ENUM_TO_STRING(CanvasSwapChainOptions)
+            {
+                ENUM_VALUE(CanvasSwapChainOptions::None);
+                ENUM_VALUE(CanvasSwapChainOptions::LowLatency);
+                ENUM_VALUE(CanvasSwapChainOptions::AllowTearing);
+                END_ENUM(CanvasSwapChainOptions);
+            }
+
             ENUM_TO_STRING(ChangeReason)
             {
                 ENUM_VALUE(ChangeReason::Other);
@@ -1816,6 +1824,14 @@ namespace Microsoft
                    a.bottom == b.bottom;
         }
 
+        inline bool operator==(D2D1_RECT_U const& a, D2D1_RECT_U const& b)
+        {
+            return a.left == b.left &&
+                   a.top == b.top &&
+                   a.right == b.right &&
+                   a.bottom == b.bottom;
+        }
+
         inline bool operator==(D2D1_ROUNDED_RECT const& a, D2D1_ROUNDED_RECT const& b)
         {
             return a.rect == b.rect &&
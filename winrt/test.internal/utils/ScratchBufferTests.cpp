@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/utils/ScratchBuffer.h>
+
+TEST_CLASS(ScratchBufferTests)
+{
+    TEST_METHOD_EX(ScratchBuffer_IsSizedAndZeroInitialized)
+    {
+        ScratchBuffer<int> buffer(10);
+
+        Assert::AreEqual(10U, buffer.GetSize());
+        Assert::IsNotNull(buffer.GetData());
+
+        for (auto value : buffer)
+            Assert::AreEqual(0, value);
+    }
+
+    TEST_METHOD_EX(ScratchBuffer_ReusesMemoryFromThePreviousCall)
+    {
+        int* firstData;
+
+        {
+            ScratchBuffer<int> buffer(100);
+            firstData = buffer.GetData();
+        }
+
+        {
+            ScratchBuffer<int> buffer(50);
+            Assert::AreEqual(firstData, buffer.GetData());
+        }
+    }
+
+    TEST_METHOD_EX(ScratchBuffer_NestedBuffersAreDistinct)
+    {
+        ScratchBuffer<int> outer(4);
+        Assert::AreEqual<size_t>(1, ScratchBuffer<int>::GetInUseCount());
+
+        {
+            ScratchBuffer<int> inner(4);
+            Assert::AreEqual<size_t>(2, ScratchBuffer<int>::GetInUseCount());
+
+            Assert::AreNotEqual(outer.GetData(), inner.GetData());
+
+            inner[0] = 1;
+            Assert::AreEqual(0, outer[0]);
+        }
+
+        Assert::AreEqual<size_t>(1, ScratchBuffer<int>::GetInUseCount());
+    }
+
+    TEST_METHOD_EX(ScratchBuffer_EachThreadHasItsOwnBuffers)
+    {
+        ScratchBuffer<int> buffer(4);
+
+        std::thread([]
+        {
+            Assert::AreEqual<size_t>(0, ScratchBuffer<int>::GetInUseCount());
+        }).join();
+    }
+
+    TEST_METHOD_EX(ScratchBuffer_KeepsCapacityFromItsHighWaterMark)
+    {
+        {
+            ScratchBuffer<uint8_t> buffer(1000);
+        }
+
+        ScratchBuffer<uint8_t> buffer(1);
+        Assert::IsTrue(buffer.GetCapacity() >= 1000);
+    }
+
+    TEST_METHOD_EX(ScratchBuffer_LargeBuffersAreNotRetained)
+    {
+        size_t const largeSize = ScratchBuffer<uint8_t>::MaxRetainedBytes + 1;
+
+        {
+            ScratchBuffer<uint8_t> buffer(largeSize);
+        }
+
+        ScratchBuffer<uint8_t> buffer(1);
+        Assert::IsTrue(buffer.GetCapacity() < largeSize);
+    }
+};
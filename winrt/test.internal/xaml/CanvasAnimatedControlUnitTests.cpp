@@ -73,7 +73,7 @@ public:
             {
                 StubCanvasDevice* stubDevice = static_cast<StubCanvasDevice*>(device); // Ensured by test construction
 
-                stubDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+                stubDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
                 {
                     return m_dxgiSwapChain;
                 });
@@ -1944,6 +1944,76 @@ TEST_CLASS(CanvasAnimatedControlTests)
         f.Adapter->Tick();
     }
 
+    class FrameLatencyWaitableObjectFixture : public FixtureWithSwapChainAccess
+    {
+    public:
+        std::shared_ptr<CanvasSwapChainTestAdapter> SwapChainAdapter;
+        int WaitCount;
+
+        FrameLatencyWaitableObjectFixture()
+            : SwapChainAdapter(std::make_shared<CanvasSwapChainTestAdapter>())
+            , WaitCount(0)
+        {
+            CanvasSwapChainAdapter::SetInstance(SwapChainAdapter);
+
+            SwapChainAdapter->m_waitFn =
+                [this](HANDLE, DWORD)
+                {
+                    ++WaitCount;
+                    return static_cast<DWORD>(WAIT_OBJECT_0);
+                };
+
+            m_dxgiSwapChain->GetFrameLatencyWaitableObjectMethod.AllowAnyCall(
+                []
+                {
+                    return CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+                });
+
+            Load();
+            Adapter->DoChanged();
+        }
+    };
+
+    TEST_METHOD_EX(CanvasAnimatedControl_FixedTimeStep_WithFrameLatencyWaitableObject_WaitsEveryTickThatDrew)
+    {
+        FrameLatencyWaitableObjectFixture f;
+
+        f.Device->GetPrimaryDisplayOutputMethod.SetExpectedCalls(0);
+
+        // Unlike waiting for the vblank, the first tick waits even though it
+        // drew, so that the next update sees the most recent input.
+        f.Adapter->Tick();
+        Assert::AreEqual(1, f.WaitCount);
+
+        ThrowIfFailed(f.Control->Invalidate());
+        f.Adapter->Tick();
+        Assert::AreEqual(2, f.WaitCount);
+    }
+
+    TEST_METHOD_EX(CanvasAnimatedControl_FixedTimeStep_WithFrameLatencyWaitableObject_WaitsForVBlank_IfNoDraw)
+    {
+        FrameLatencyWaitableObjectFixture f;
+
+        f.Adapter->Tick();
+        Assert::AreEqual(1, f.WaitCount);
+
+        auto mockDxgiOutput = Make<MockDxgiOutput>();
+
+        // Second tick, because we didn't progress time, doesn't present.  The
+        // waitable object won't be signaled, so the tick must wait for the
+        // vblank instead.
+        f.Device->GetPrimaryDisplayOutputMethod.SetExpectedCalls(1,
+            [&]
+            {
+                return mockDxgiOutput;
+            });
+
+        mockDxgiOutput->WaitForVBlankMethod.SetExpectedCalls(1);
+
+        f.Adapter->Tick();
+        Assert::AreEqual(1, f.WaitCount);
+    }
+
     TEST_METHOD_EX(CanvasAnimatedControl_When_InvalidateCalled_AnyNumberOfTimes_WhileNotPaused_ThenSingleDrawCalled)
     {
         UpdateRenderFixture f;        
@@ -3394,7 +3464,7 @@ TEST_CLASS(CanvasAnimatedControl_DpiScaling)
                 [=](ICanvasDevice* device, float width, float height, float dpi, CanvasAlphaMode alphaMode)
                 {
                     StubCanvasDevice* stubDevice = static_cast<StubCanvasDevice*>(device); // Ensured by test construction
-                    stubDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode)
+                    stubDevice->CreateSwapChainForCompositionMethod.AllowAnyCall([=](int32_t, int32_t, DirectXPixelFormat, int32_t, CanvasAlphaMode, CanvasSwapChainOptions)
                     {
                         return m_dxgiSwapChain;
                     });
@@ -24,7 +24,8 @@ std::shared_ptr<CanvasAnimatedControlTestAdapter> CreateAnimatedControlTestAdapt
         int32_t heightInPixels,
         DirectXPixelFormat format,
         int32_t bufferCount,
-        CanvasAlphaMode alphaMode)
+        CanvasAlphaMode alphaMode,
+        CanvasSwapChainOptions)
         {
             auto dxgiSwapChain = Make<StubDxgiSwapChain>();
 